@@ -12,6 +12,66 @@
  */
 
 #include "BaseApp.h"
+#include "Benchmarks.h"
+
+namespace {
+
+  /**
+   * @brief Separo la lnea de comandos en argumentos (las comillas agrupan rutas con espacios).
+   */
+  std::vector<std::wstring>
+    splitCommandLine(const wchar_t* cmdLine) {
+    std::vector<std::wstring> args;
+    std::wstring current;
+    bool quoted = false;
+    bool pending = false;
+    for (const wchar_t* c = cmdLine ? cmdLine : L""; *c; ++c) {
+      if (*c == L'"') {
+        quoted = !quoted;
+        pending = true;
+      }
+      else if ((*c == L' ' || *c == L'\t') && !quoted) {
+        if (pending) {
+          args.push_back(current);
+          current.clear();
+          pending = false;
+        }
+      }
+      else {
+        current.push_back(*c);
+        pending = true;
+      }
+    }
+    if (pending) {
+      args.push_back(current);
+    }
+    return args;
+  }
+
+  /**
+   * @brief Valor de la opcin en `args[i]`: el siguiente argumento si no es otra opcin.
+   *
+   * @details Si lo toma, avanzo `i` para no leerlo como opcin.
+   */
+  std::wstring
+    optionValue(const std::vector<std::wstring>& args, size_t& i) {
+    if (i + 1 < args.size() && (args[i + 1].empty() || args[i + 1][0] != L'-')) {
+      return args[++i];
+    }
+    return std::wstring();
+  }
+
+  /// @brief Rutas y filtros en ASCII, como los usa el resto del motor.
+  std::string
+    narrow(const std::wstring& text) {
+    std::string out;
+    for (wchar_t c : text) {
+      out.push_back(static_cast<char>(c));
+    }
+    return out;
+  }
+
+} // namespace
 
  /**
   * @brief Punto de entrada principal de una app Windows (versin wide con Unicode).
@@ -34,10 +94,43 @@
 int WINAPI
 wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
 
+  // Los argumentos se separan una vez; cada opcin se reconoce en cualquier posicin
+  const std::vector<std::wstring> args = splitCommandLine(lpCmdLine);
+
+  // Modo benchmark: "-bench [nombre|all]" corre los benchmarks de CPU sin abrir ventana
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == L"-bench") {
+      const std::string name = narrow(optionValue(args, i));
+      return Benchmarks::run(name.empty() ? "all" : name);
+    }
+  }
+
   // Creo mi aplicacin base (el motor).
   // Nota: puedo pasar los parmetros aqu o directamente en run().
   BaseApp app;
 
+  for (size_t i = 0; i < args.size(); ++i) {
+    const std::wstring& option = args[i];
+    // Replay determinista: "-record archivo" graba la simulacin, "-replay archivo" la reproduce
+    if (option == L"-record" || option == L"-replay") {
+      const std::string path = narrow(optionValue(args, i));
+      app.setReplay(option == L"-record" ? REPLAY_RECORD : REPLAY_PLAYBACK,
+                    path.empty() ? "simulation.replay" : path);
+    }
+    // Escena: "-scene archivo" la carga (si no existe, ah se guarda la escena por defecto)
+    else if (option == L"-scene") {
+      const std::string path = narrow(optionValue(args, i));
+      app.setScenePath(path.empty() ? "default.scene" : path);
+    }
+    // Pantalla dividida: "-views N" crea N cmaras, cada una en su parte de la ventana
+    else if (option == L"-views") {
+      app.setNumViews(static_cast<unsigned int>(wcstoul(optionValue(args, i).c_str(), nullptr, 10)));
+    }
+    else {
+      ERROR("Main", "wWinMain", L"Unknown option " << option);
+    }
+  }
+
   // Inicio la app llamando a su ciclo principal
   return app.run(hInstance, nCmdShow);
 }
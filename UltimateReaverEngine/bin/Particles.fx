@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------
+// File: Particles.fx
+//
+// Camera-facing particle quads. Everything comes per instance (position, size and a
+// premultiplied RGBA8 color); the four corners of the strip come from SV_VertexID.
+//--------------------------------------------------------------------------------------
+
+cbuffer cbParticles : register(b6)
+{
+  matrix ViewProjection;
+  float4 CameraRight;
+  float4 CameraUp;
+};
+
+struct VS_INPUT
+{
+  float3 Pos : POSITION;
+  float Size : PSIZE;
+  float4 Color : COLOR0;
+  uint Corner : SV_VertexID;
+};
+
+struct PS_INPUT
+{
+  float4 Pos : SV_POSITION;
+  float2 Tex : TEXCOORD0;
+  float4 Color : COLOR0;
+};
+
+PS_INPUT VS(VS_INPUT input)
+{
+  PS_INPUT output = (PS_INPUT)0;
+  float2 corner = float2(input.Corner & 1, input.Corner >> 1);
+  float2 offset = (corner * 2.0f - 1.0f) * (input.Size * 0.5f);
+  float3 worldPos = input.Pos + CameraRight.xyz * offset.x + CameraUp.xyz * offset.y;
+  output.Pos = mul(float4(worldPos, 1.0f), ViewProjection);
+  output.Tex = corner;
+  output.Color = input.Color;
+  return output;
+}
+
+// Disco suave; el color ya viene premultiplicado (alfa 0 = aditivo)
+float4 PS(PS_INPUT input) : SV_Target
+{
+  float2 d = input.Tex * 2.0f - 1.0f;
+  float fade = saturate(1.0f - dot(d, d));
+  return input.Color * fade;
+}
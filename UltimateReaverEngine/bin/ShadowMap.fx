@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------------------
+// File: ShadowMap.fx
+//
+// Depth-only pass for the cascaded shadow maps. Each draw is instanced: the world
+// matrices of the batch live in cbShadowInstances and are indexed with SV_InstanceID.
+//--------------------------------------------------------------------------------------
+
+#define MAX_SHADOW_INSTANCES 256
+
+cbuffer cbShadowInstances : register(b5)
+{
+  matrix LightViewProj;
+  matrix World[MAX_SHADOW_INSTANCES];
+};
+
+struct VS_INPUT
+{
+  float4 Pos : POSITION;
+  float2 Tex : TEXCOORD0;
+  uint Instance : SV_InstanceID;
+};
+
+struct PS_INPUT
+{
+  float4 Pos : SV_POSITION;
+};
+
+PS_INPUT VS(VS_INPUT input)
+{
+  PS_INPUT output = (PS_INPUT)0;
+  float4 worldPos = mul(float4(input.Pos.xyz, 1.0f), World[input.Instance]);
+  output.Pos = mul(worldPos, LightViewProj);
+  return output;
+}
+
+// No se usa (el pass va sin pixel shader), pero ShaderProgram compila ambos
+float4 PS(PS_INPUT input) : SV_Target
+{
+  return float4(0.0f, 0.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file AnimationClip.h
+ * @brief Aquí defino el AnimationClip: las poses de un esqueleto muestreadas a frame rate fijo.
+ *
+ * @details
+ *  Al importar del FBX evalúo cada hueso a una frecuencia fija (30 Hz por defecto)
+ *  y guardo los frames uno tras otro: `frame * numBones + bone`. Así, para muestrear
+ *  una pose completa solo leo dos bloques contiguos de memoria y los interpolo.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Animation/AnimationMath.h"
+
+ /**
+  * @class AnimationClip
+  * @brief Clip de animación con frames muestreados uniformemente.
+  */
+class
+  AnimationClip {
+public:
+  AnimationClip() = default;
+  ~AnimationClip() = default;
+
+  /**
+   * @brief Preparo el clip para `numFrames` frames de `numBones` huesos.
+   *
+   * @param name       Nombre del clip (el del AnimStack del FBX).
+   * @param numBones   Huesos del esqueleto al que pertenece.
+   * @param numFrames  Frames muestreados (al menos 1).
+   * @param sampleRate Frames por segundo.
+   */
+  void
+    init(const std::string& name,
+         unsigned int numBones,
+         unsigned int numFrames,
+         float sampleRate);
+
+  /**
+   * @brief Acceso editable a la pose de un frame (lo uso al importar).
+   */
+  BoneTransform*
+    getFrame(unsigned int frame) { return &m_frames[static_cast<size_t>(frame) * m_numBones]; }
+
+  /**
+   * @brief Acceso de solo lectura a la pose de un frame.
+   */
+  const BoneTransform*
+    getFrame(unsigned int frame) const { return &m_frames[static_cast<size_t>(frame) * m_numBones]; }
+
+  /**
+   * @brief Muestreo la pose local de todos los huesos en el tiempo indicado.
+   *
+   * @param time     Tiempo en segundos.
+   * @param loop     Si es true, el tiempo se envuelve; si no, se satura al final.
+   * @param outPose  Un BoneTransform por hueso.
+   */
+  void
+    sample(float time, bool loop, BoneTransform* outPose) const;
+
+  const std::string&
+    getName() const { return m_name; }
+
+  float
+    getDuration() const { return m_duration; }
+
+  float
+    getSampleRate() const { return m_sampleRate; }
+
+  unsigned int
+    getNumFrames() const { return m_numFrames; }
+
+  unsigned int
+    getNumBones() const { return m_numBones; }
+
+private:
+  std::string m_name;
+  std::vector<BoneTransform> m_frames;
+  float m_duration = 0.0f;
+  float m_sampleRate = 30.0f;
+  unsigned int m_numFrames = 0;
+  unsigned int m_numBones = 0;
+};
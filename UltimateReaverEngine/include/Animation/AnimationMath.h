@@ -0,0 +1,296 @@
+/**
+ * @file AnimationMath.h
+ * @brief Aquí junto los tipos matemáticos que usa el sistema de animación.
+ *
+ * @details
+ *  Son tipos POD muy simples (cuaterniones, TRS, matrices 3x4 y cuaterniones duales)
+ *  para poder guardarlos en arreglos compactos, copiarlos con memcpy y procesarlos
+ *  con SIMD sin depender de la API gráfica. Así también puedo probarlos headless.
+ *
+ *  Convención: vectores columna, es decir `p' = M * [p, 1]`. Cada fila de
+ *  `Matrix3x4` es (rx, ry, rz, t).
+ */
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+ /**
+  * @struct Quaternion
+  * @brief Rotación como cuaternión unitario (x, y, z, w).
+  */
+struct
+  Quaternion {
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+  float w = 1.0f;
+};
+
+/**
+ * @struct BoneTransform
+ * @brief Transformación local de un hueso: traslación, rotación y escala.
+ */
+struct
+  BoneTransform {
+  float translation[3] = { 0.0f, 0.0f, 0.0f };
+  Quaternion rotation;
+  float scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+/**
+ * @struct Matrix3x4
+ * @brief Matriz afín de 3 filas x 4 columnas (la última fila 0,0,0,1 es implícita).
+ */
+struct
+  Matrix3x4 {
+  float m[3][4] = { { 1.0f, 0.0f, 0.0f, 0.0f },
+                    { 0.0f, 1.0f, 0.0f, 0.0f },
+                    { 0.0f, 0.0f, 1.0f, 0.0f } };
+};
+
+/**
+ * @struct DualQuaternion
+ * @brief Transformación rígida como cuaternión dual (parte real = rotación, dual = traslación).
+ */
+struct
+  DualQuaternion {
+  Quaternion real;
+  Quaternion dual = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+namespace AnimMath {
+
+  /**
+   * @brief Producto de cuaterniones (a * b aplica primero b y luego a).
+   */
+  inline Quaternion
+    mul(const Quaternion& a, const Quaternion& b) {
+    Quaternion r;
+    r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    return r;
+  }
+
+  /**
+   * @brief Producto punto de 4 componentes.
+   */
+  inline float
+    dot(const Quaternion& a, const Quaternion& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+  }
+
+  /**
+   * @brief Conjugado (inverso para cuaterniones unitarios).
+   */
+  inline Quaternion
+    conjugate(const Quaternion& q) {
+    return { -q.x, -q.y, -q.z, q.w };
+  }
+
+  /**
+   * @brief Normalizo el cuaternión (si es degenerado regreso identidad).
+   */
+  inline Quaternion
+    normalize(const Quaternion& q) {
+    float len = std::sqrt(dot(q, q));
+    if (len < 1e-12f) {
+      return Quaternion();
+    }
+    float inv = 1.0f / len;
+    return { q.x * inv, q.y * inv, q.z * inv, q.w * inv };
+  }
+
+  /**
+   * @brief Interpolación lineal normalizada por el camino más corto.
+   *
+   * @details
+   *  Para muestreo a frame rate fijo la diferencia con slerp es despreciable y es mucho más barata.
+   */
+  inline Quaternion
+    nlerp(const Quaternion& a, const Quaternion& b, float t) {
+    float sign = dot(a, b) < 0.0f ? -1.0f : 1.0f;
+    float s0 = 1.0f - t;
+    float s1 = t * sign;
+    Quaternion r = { a.x * s0 + b.x * s1,
+                     a.y * s0 + b.y * s1,
+                     a.z * s0 + b.z * s1,
+                     a.w * s0 + b.w * s1 };
+    return normalize(r);
+  }
+
+  /**
+   * @brief Interpolo dos transformaciones de hueso (lerp en T/S, nlerp en R).
+   */
+  inline BoneTransform
+    lerp(const BoneTransform& a, const BoneTransform& b, float t) {
+    BoneTransform r;
+    for (int i = 0; i < 3; ++i) {
+      r.translation[i] = a.translation[i] + (b.translation[i] - a.translation[i]) * t;
+      r.scale[i] = a.scale[i] + (b.scale[i] - a.scale[i]) * t;
+    }
+    r.rotation = nlerp(a.rotation, b.rotation, t);
+    return r;
+  }
+
+  /**
+   * @brief Matriz de rotación a partir de un cuaternión unitario.
+   */
+  inline Matrix3x4
+    toMatrix(const BoneTransform& bt) {
+    const Quaternion& q = bt.rotation;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    Matrix3x4 r;
+    r.m[0][0] = (1.0f - 2.0f * (yy + zz)) * bt.scale[0];
+    r.m[0][1] = (2.0f * (xy - wz)) * bt.scale[1];
+    r.m[0][2] = (2.0f * (xz + wy)) * bt.scale[2];
+    r.m[0][3] = bt.translation[0];
+
+    r.m[1][0] = (2.0f * (xy + wz)) * bt.scale[0];
+    r.m[1][1] = (1.0f - 2.0f * (xx + zz)) * bt.scale[1];
+    r.m[1][2] = (2.0f * (yz - wx)) * bt.scale[2];
+    r.m[1][3] = bt.translation[1];
+
+    r.m[2][0] = (2.0f * (xz - wy)) * bt.scale[0];
+    r.m[2][1] = (2.0f * (yz + wx)) * bt.scale[1];
+    r.m[2][2] = (1.0f - 2.0f * (xx + yy)) * bt.scale[2];
+    r.m[2][3] = bt.translation[2];
+    return r;
+  }
+
+  /**
+   * @brief Producto de matrices afines (a * b aplica primero b).
+   */
+  inline Matrix3x4
+    mul(const Matrix3x4& a, const Matrix3x4& b) {
+    Matrix3x4 r;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 4; ++col) {
+        r.m[row][col] = a.m[row][0] * b.m[0][col] +
+                        a.m[row][1] * b.m[1][col] +
+                        a.m[row][2] * b.m[2][col];
+      }
+      r.m[row][3] += a.m[row][3];
+    }
+    return r;
+  }
+
+  /**
+   * @brief Transformo un punto (x, y, z, 1).
+   */
+  inline void
+    transformPoint(const Matrix3x4& a, const float p[3], float out[3]) {
+    for (int row = 0; row < 3; ++row) {
+      out[row] = a.m[row][0] * p[0] + a.m[row][1] * p[1] + a.m[row][2] * p[2] + a.m[row][3];
+    }
+  }
+
+  /**
+   * @brief Transformo una dirección (x, y, z, 0): solo la parte 3x3, sin traslación.
+   */
+  inline void
+    transformVector(const Matrix3x4& a, const float v[3], float out[3]) {
+    for (int row = 0; row < 3; ++row) {
+      out[row] = a.m[row][0] * v[0] + a.m[row][1] * v[1] + a.m[row][2] * v[2];
+    }
+  }
+
+  /**
+   * @brief Extraigo la rotación de la parte 3x3 (se asume sin shear; la escala se normaliza).
+   */
+  inline Quaternion
+    rotationFromMatrix(const Matrix3x4& a) {
+    float c[3][3];
+    for (int col = 0; col < 3; ++col) {
+      float len = std::sqrt(a.m[0][col] * a.m[0][col] +
+                            a.m[1][col] * a.m[1][col] +
+                            a.m[2][col] * a.m[2][col]);
+      float inv = len > 1e-12f ? 1.0f / len : 0.0f;
+      for (int row = 0; row < 3; ++row) {
+        c[row][col] = a.m[row][col] * inv;
+      }
+    }
+
+    Quaternion q;
+    float trace = c[0][0] + c[1][1] + c[2][2];
+    if (trace > 0.0f) {
+      float s = std::sqrt(trace + 1.0f) * 2.0f;
+      q.w = 0.25f * s;
+      q.x = (c[2][1] - c[1][2]) / s;
+      q.y = (c[0][2] - c[2][0]) / s;
+      q.z = (c[1][0] - c[0][1]) / s;
+    }
+    else if (c[0][0] > c[1][1] && c[0][0] > c[2][2]) {
+      float s = std::sqrt(1.0f + c[0][0] - c[1][1] - c[2][2]) * 2.0f;
+      q.w = (c[2][1] - c[1][2]) / s;
+      q.x = 0.25f * s;
+      q.y = (c[0][1] + c[1][0]) / s;
+      q.z = (c[0][2] + c[2][0]) / s;
+    }
+    else if (c[1][1] > c[2][2]) {
+      float s = std::sqrt(1.0f + c[1][1] - c[0][0] - c[2][2]) * 2.0f;
+      q.w = (c[0][2] - c[2][0]) / s;
+      q.x = (c[0][1] + c[1][0]) / s;
+      q.y = 0.25f * s;
+      q.z = (c[1][2] + c[2][1]) / s;
+    }
+    else {
+      float s = std::sqrt(1.0f + c[2][2] - c[0][0] - c[1][1]) * 2.0f;
+      q.w = (c[1][0] - c[0][1]) / s;
+      q.x = (c[0][2] + c[2][0]) / s;
+      q.y = (c[1][2] + c[2][1]) / s;
+      q.z = 0.25f * s;
+    }
+    return normalize(q);
+  }
+
+  /**
+   * @brief Descompongo una matriz afín en TRS (se asume sin shear ni escala negativa).
+   */
+  inline BoneTransform
+    decompose(const Matrix3x4& a) {
+    BoneTransform bt;
+    for (int i = 0; i < 3; ++i) {
+      bt.translation[i] = a.m[i][3];
+      bt.scale[i] = std::sqrt(a.m[0][i] * a.m[0][i] +
+                              a.m[1][i] * a.m[1][i] +
+                              a.m[2][i] * a.m[2][i]);
+    }
+    bt.rotation = rotationFromMatrix(a);
+    return bt;
+  }
+
+  /**
+   * @brief Convierto una matriz rígida en cuaternión dual (se ignora la escala).
+   */
+  inline DualQuaternion
+    toDualQuaternion(const Matrix3x4& a) {
+    DualQuaternion dq;
+    dq.real = rotationFromMatrix(a);
+    Quaternion t = { a.m[0][3], a.m[1][3], a.m[2][3], 0.0f };
+    Quaternion d = mul(t, dq.real);
+    dq.dual = { d.x * 0.5f, d.y * 0.5f, d.z * 0.5f, d.w * 0.5f };
+    return dq;
+  }
+
+  /**
+   * @brief Llevo un tiempo al rango [0, duration]: envolviendo si hay loop o saturando si no.
+   */
+  inline float
+    wrapTime(float time, float duration, bool loop) {
+    if (duration <= 0.0f) {
+      return 0.0f;
+    }
+    if (loop) {
+      time = std::fmod(time, duration);
+      return time < 0.0f ? time + duration : time;
+    }
+    return time < 0.0f ? 0.0f : (time > duration ? duration : time);
+  }
+
+} // namespace AnimMath
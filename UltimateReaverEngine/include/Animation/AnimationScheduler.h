@@ -0,0 +1,168 @@
+/**
+ * @file AnimationScheduler.h
+ * @brief Aquí defino el AnimationScheduler: decide qué personajes se animan cada frame.
+ *
+ * @details
+ *  Sin esto, cada Animator muestrea y skinnea todos los frames aunque el personaje
+ *  ocupe dos píxeles o esté detrás de la cámara. El scheduler:
+ *
+ *  - **Salta los invisibles**: si la esfera del actor no toca el frustum, no hago nada;
+ *    el tiempo se acumula y se pone al día cuando vuelve a verse.
+ *  - **LOD por tamaño en pantalla**: según el diámetro proyectado en píxeles elijo un
+ *    nivel con su intervalo de actualización (cada 1, 2, 4... frames) y su profundidad
+ *    máxima de huesos.
+ *  - **Amortiza**: cada actor tiene una fase distinta, así los que se actualizan cada
+ *    N frames se reparten entre frames. En los niveles con interpolación, entre
+ *    actualizaciones mezclo las dos últimas poses muestreadas (un intervalo de retraso).
+ *  - **Presupuesto**: proceso primero los más grandes en pantalla; si se acaba el tiempo
+ *    (ms) los demás se posponen al siguiente frame, y ajusto un sesgo de LOD para que
+ *    el costo total se quede debajo del objetivo.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Frustum.h"
+
+class Animator;
+class Transform;
+class BenchmarkReport;
+
+/**
+ * @struct AnimationLodLevel
+ * @brief Un nivel de LOD de animación.
+ */
+struct
+  AnimationLodLevel {
+  /// @brief Diámetro mínimo en pantalla (píxeles) para usar este nivel.
+  float minScreenSize = 0.0f;
+
+  /// @brief Cada cuántos frames se muestrea la animación.
+  unsigned int updateInterval = 1;
+
+  /// @brief Profundidad máxima de huesos a muestrear (-1 = todos).
+  int maxBoneDepth = -1;
+
+  /// @brief Entre actualizaciones, ¿interpolo y re-skinneo, o congelo la pose?
+  bool interpolate = true;
+};
+
+/**
+ * @struct AnimationSchedulerSettings
+ * @brief Configuración del scheduler.
+ */
+struct
+  AnimationSchedulerSettings {
+  /// @brief Niveles ordenados de mayor a menor `minScreenSize`.
+  std::vector<AnimationLodLevel> levels = {
+    { 200.0f, 1, -1, false },
+    { 80.0f,  2, -1, true  },
+    { 30.0f,  4,  6, true  },
+    { 0.0f,   8,  3, false },
+  };
+
+  /// @brief Presupuesto de CPU por frame para animación (ms).
+  float budgetMs = 2.0f;
+
+  /// @brief Ajustar el sesgo de LOD automáticamente para cumplir el presupuesto.
+  bool adaptiveBias = true;
+};
+
+/**
+ * @struct AnimationSchedulerStats
+ * @brief Estadísticas del último frame.
+ */
+struct
+  AnimationSchedulerStats {
+  unsigned int registered = 0;
+  unsigned int visible = 0;
+  unsigned int evaluated = 0;     ///< Muestreados + skinneados.
+  unsigned int interpolated = 0;  ///< Solo interpolación + skinning.
+  unsigned int held = 0;          ///< Pose congelada (no tocaron la CPU).
+  unsigned int culled = 0;        ///< Invisibles.
+  unsigned int deferred = 0;      ///< Pospuestos por presupuesto.
+  unsigned int perLevel[8] = {};
+  double timeMs = 0.0;
+  float lodBias = 1.0f;
+};
+
+/**
+ * @class AnimationScheduler
+ * @brief Reparte el trabajo de animación según visibilidad, tamaño y presupuesto.
+ */
+class
+  AnimationScheduler {
+public:
+  AnimationScheduler() = default;
+  ~AnimationScheduler() = default;
+
+  void
+    setSettings(const AnimationSchedulerSettings& settings) { m_settings = settings; }
+
+  const AnimationSchedulerSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Registro un Animator. Desde ahora su update() ya no anima solo.
+   *
+   * @param animator   Animator del actor.
+   * @param transform  Transform del actor (posición y escala de la esfera).
+   * @param radius     Radio de la esfera envolvente en espacio local.
+   */
+  void
+    add(Animator* animator, const Transform* transform, float radius);
+
+  /**
+   * @brief Quito un Animator (vuelve a actualizarse solo).
+   */
+  void
+    remove(Animator* animator);
+
+  /**
+   * @brief Ejecuto la animación del frame.
+   *
+   * @param deltaTime       Tiempo del frame en segundos.
+   * @param viewProjection  Matriz view * projection (convención XNA, sin transponer).
+   * @param eyePosition     Posición de la cámara.
+   * @param projScaleY      Elemento _22 de la proyección (cot(fovY / 2)).
+   * @param viewportHeight  Alto del viewport en píxeles.
+   */
+  void
+    update(float deltaTime,
+           const XMFLOAT4X4& viewProjection,
+           const XMFLOAT3& eyePosition,
+           float projScaleY,
+           float viewportHeight);
+
+  const AnimationSchedulerStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark: personajes en una plaza, todos cada frame vs scheduler con presupuesto.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  struct
+    Entry {
+    Animator* animator = nullptr;
+    const Transform* transform = nullptr;
+    float radius = 1.0f;
+    unsigned int phase = 0;
+    unsigned int framesSinceUpdate = 0;
+    float pendingTime = 0.0f;
+    float screenSize = 0.0f;
+    int level = 0;
+    bool hasTarget = false;
+  };
+
+private:
+  AnimationSchedulerSettings m_settings;
+  AnimationSchedulerStats m_stats;
+  std::vector<Entry> m_entries;
+  std::vector<Entry*> m_due;
+  std::vector<Entry*> m_interpolating;
+  uint64_t m_frameIndex = 0;
+  unsigned int m_nextPhase = 0;
+  float m_lodBias = 1.0f;
+};
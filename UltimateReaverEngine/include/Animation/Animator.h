@@ -0,0 +1,255 @@
+/**
+ * @file Animator.h
+ * @brief Aquí defino el componente Animator, que reproduce clips y hace el skinning por CPU.
+ *
+ * @details
+ *  Cada frame el Animator:
+ *  1. Muestrea la pose local del clip activo (y del anterior si hay un crossfade).
+ *  2. Aplica las capas encima (mezcla con máscara o aditivas).
+ *  3. Calcula la paleta de skinning (global * inverse bind) del esqueleto.
+ *  4. Skinnea todas las mallas del actor en paralelo con `SkinningKernel::skinMeshes`.
+ *
+ *  El Actor después sube los vértices resultantes a sus vertex buffers.
+ *  El esqueleto y los clips no son del Animator: vienen del Model3D, que debe vivir más.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/Component.h"
+#include "Animation/Skeleton.h"
+#include "Animation/CompressedAnimationClip.h"
+#include "Animation/SkinningKernel.h"
+
+class DeviceContext;
+
+/**
+ * @class Animator
+ * @brief Componente de animación esquelética con skinning SIMD en CPU.
+ */
+class
+  Animator : public Component {
+public:
+  Animator() : Component(ComponentType::ANIMATOR) {}
+
+  virtual
+    ~Animator() = default;
+
+  void
+    init() override {}
+
+  /**
+   * @brief Avanzo el tiempo, muestreo la pose y skinneo las mallas.
+   *
+   * @details Si el Animator está registrado en un AnimationScheduler no hace nada:
+   *          el scheduler llama a samplePose/applyPose cuando le toca.
+   */
+  void
+    update(float deltaTime) override;
+
+  void
+    render(DeviceContext& deviceContext) override {}
+
+  void
+    destroy() override;
+
+  /**
+   * @brief Preparo el Animator para un esqueleto y las mallas del actor.
+   *
+   * @param skeleton Esqueleto del modelo.
+   * @param meshes   Mallas del actor (en el mismo orden que sus vertex buffers).
+   *
+   * @details Las mallas sin influencias se quedan estáticas.
+   */
+  void
+    setup(const Skeleton* skeleton, const std::vector<MeshComponent>& meshes);
+
+  /**
+   * @brief Empiezo a reproducir un clip desde el inicio.
+   */
+  void
+    play(const CompressedAnimationClip* clip, bool loop = true);
+
+  /**
+   * @brief Cambio al clip nuevo mezclándolo con el actual durante `duration` segundos.
+   */
+  void
+    crossFade(const CompressedAnimationClip* clip, float duration, bool loop = true);
+
+  /**
+   * @brief Agrego una capa encima del clip base.
+   *
+   * @param clip      Clip de la capa (corre con su propio tiempo).
+   * @param weight    Peso de la capa [0, 1].
+   * @param boneMask  Peso por hueso (vacío = todos los huesos). Ver PoseBlend::buildSubtreeMask.
+   * @param additive  true: la capa se suma como diferencia respecto a su primer frame.
+   * @return Índice de la capa.
+   */
+  int
+    addLayer(const CompressedAnimationClip* clip,
+             float weight,
+             const std::vector<float>& boneMask = std::vector<float>(),
+             bool additive = false);
+
+  /**
+   * @brief Cambio el peso de una capa.
+   */
+  void
+    setLayerWeight(int layer, float weight);
+
+  /**
+   * @brief Quito todas las capas.
+   */
+  void
+    clearLayers() { m_layers.clear(); }
+
+  /**
+   * @brief Detengo la reproducción y regreso a la pose de bind.
+   */
+  void
+    stop();
+
+  void
+    setSpeed(float speed) { m_speed = speed; }
+
+  void
+    setSkinningMethod(SkinningMethod method) { m_method = method; }
+
+  SkinningMethod
+    getSkinningMethod() const { return m_method; }
+
+  /**
+   * @brief Activo o desactivo el reparto del skinning entre hilos.
+   */
+  void
+    setMultithreaded(bool enabled) { m_multithreaded = enabled; }
+
+  /**
+   * @brief Indica si la malla `index` tiene skinning.
+   */
+  bool
+    isSkinned(size_t index) const {
+    return index < m_meshData.size() && m_meshData[index].getNumVertices() > 0;
+  }
+
+  /**
+   * @brief Vértices skinneados de la malla `index` (listos para subir al vertex buffer).
+   */
+  const std::vector<SimpleVertex>&
+    getSkinnedVertices(size_t index) const { return m_skinnedVertices[index]; }
+
+  /**
+   * @brief Hay una pose nueva desde la última vez que se subió a la GPU.
+   */
+  bool
+    hasNewPose() const { return m_hasNewPose; }
+
+  void
+    clearNewPose() { m_hasNewPose = false; }
+
+  /**
+   * @brief Tiempo de CPU del último skinning en milisegundos.
+   */
+  double
+    getLastSkinningMs() const { return m_lastSkinningMs; }
+
+  /* Control externo (AnimationScheduler) */
+
+  /**
+   * @brief Marco que el Animator lo actualiza un scheduler y no su propio update().
+   */
+  void
+    setScheduled(bool scheduled) { m_scheduled = scheduled; }
+
+  bool
+    isScheduled() const { return m_scheduled; }
+
+  /**
+   * @brief Avanzo `deltaTime` y muestreo la pose local (clip, crossfade y capas) sin skinnear.
+   */
+  void
+    samplePose(float deltaTime);
+
+  /**
+   * @brief Calculo paleta y skinneo todas las mallas con la pose local actual.
+   */
+  void
+    applyPose();
+
+  /**
+   * @brief LOD de huesos: solo muestreo huesos con profundidad <= maxDepth (-1 = todos).
+   */
+  void
+    setBoneLod(int maxDepth);
+
+  /**
+   * @brief Guardo la pose recién muestreada como destino de interpolación
+   *        (la anterior pasa a ser el origen).
+   */
+  void
+    pushInterpolationTarget();
+
+  /**
+   * @brief Pose local = mezcla entre el origen y el destino de interpolación.
+   */
+  void
+    interpolatePose(float t);
+
+  /**
+   * @brief ¿Tiene clip activo (hay algo que animar)?
+   */
+  bool
+    isPlaying() const { return m_skeleton && m_clip; }
+
+private:
+  /**
+   * @struct Layer
+   * @brief Capa de animación encima de la pose base.
+   */
+  struct
+    Layer {
+    const CompressedAnimationClip* clip = nullptr;
+    float time = 0.0f;
+    float weight = 1.0f;
+    bool additive = false;
+    std::vector<float> boneMask;
+    std::vector<BoneTransform> referencePose;
+    CompressedAnimationClip::SampleCursor cursor;
+  };
+
+private:
+  const Skeleton* m_skeleton = nullptr;
+  const CompressedAnimationClip* m_clip = nullptr;
+  CompressedAnimationClip::SampleCursor m_cursor;
+
+  // Crossfade: clip anterior que se va apagando
+  const CompressedAnimationClip* m_fadeClip = nullptr;
+  CompressedAnimationClip::SampleCursor m_fadeCursor;
+  float m_fadeTime = 0.0f;
+  float m_fadeElapsed = 0.0f;
+  float m_fadeDuration = 0.0f;
+  bool m_fadeLoop = true;
+
+  std::vector<Layer> m_layers;
+
+  float m_time = 0.0f;
+  float m_speed = 1.0f;
+  bool m_loop = true;
+  bool m_multithreaded = true;
+  bool m_hasNewPose = false;
+  bool m_scheduled = false;
+  int m_boneLodDepth = -1;
+  SkinningMethod m_method = SkinningMethod::Linear;
+  double m_lastSkinningMs = 0.0;
+
+  std::vector<BoneTransform> m_localPose;
+  std::vector<BoneTransform> m_scratchPose;
+  std::vector<BoneTransform> m_previousPose;
+  std::vector<BoneTransform> m_targetPose;
+  std::vector<uint8_t> m_boneLodMask;
+  std::vector<Matrix3x4> m_palette;
+  std::vector<DualQuaternion> m_dualQuatPalette;
+
+  std::vector<SkinnedMeshData> m_meshData;
+  std::vector<std::vector<SimpleVertex>> m_skinnedVertices;
+  std::vector<SkinningJob> m_jobs;
+};
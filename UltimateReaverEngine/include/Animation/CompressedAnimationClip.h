@@ -0,0 +1,181 @@
+/**
+ * @file CompressedAnimationClip.h
+ * @brief Aquí defino el formato comprimido de los clips de animación.
+ *
+ * @details
+ *  El AnimationClip crudo guarda un BoneTransform completo (40 bytes) por hueso y por frame.
+ *  Para tener miles de personajes animados eso no escala, así que al importar comprimo:
+ *
+ *  - **Reducción de keyframes por track**: cada hueso tiene 3 tracks (rotación, traslación,
+ *    escala). Quito los keys que se pueden reconstruir interpolando a los vecinos sin pasar
+ *    la tolerancia. Los tracks constantes quedan con un solo key.
+ *  - **Cuantización**: rotaciones con "smallest three" en 48 bits; traslación y escala en
+ *    16 bits por componente normalizados al rango del track.
+ *  - **Muestreo de todos los tracks a la vez**: los keys están ordenados por hueso y por track
+ *    en arreglos contiguos, así una pose completa es un solo recorrido lineal. Con un
+ *    `SampleCursor` por instancia la búsqueda de keys es O(1) cuando el tiempo avanza.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Animation/AnimationClip.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct AnimationCompressionSettings
+ * @brief Tolerancias máximas por track (ya incluyen el error de cuantización).
+ */
+struct
+  AnimationCompressionSettings {
+  /// @brief Error máximo de traslación (unidades de la escena, metros).
+  float translationTolerance = 0.0005f;
+
+  /// @brief Error máximo de rotación en radianes.
+  float rotationTolerance = 0.001f;
+
+  /// @brief Error máximo de escala (absoluto).
+  float scaleTolerance = 0.0005f;
+};
+
+/**
+ * @class CompressedAnimationClip
+ * @brief Clip con keys reducidos y cuantizados.
+ */
+class
+  CompressedAnimationClip {
+public:
+  /**
+   * @struct SampleCursor
+   * @brief Estado por instancia para no buscar los keys desde cero cada frame.
+   */
+  struct
+    SampleCursor {
+    std::vector<uint16_t> keys;
+  };
+
+  CompressedAnimationClip() = default;
+  ~CompressedAnimationClip() = default;
+
+  /**
+   * @brief Comprimo un clip crudo.
+   *
+   * @param clip      Clip muestreado a frame rate fijo.
+   * @param settings  Tolerancias.
+   * @return false si el clip está vacío o es demasiado largo (más de 65535 frames).
+   */
+  bool
+    compress(const AnimationClip& clip,
+             const AnimationCompressionSettings& settings = AnimationCompressionSettings());
+
+  /**
+   * @brief Muestreo la pose local de todos los huesos en un tiempo.
+   *
+   * @param time     Tiempo en segundos.
+   * @param loop     Envolver el tiempo o saturarlo.
+   * @param outPose  Un BoneTransform por hueso.
+   * @param cursor   Opcional: cursor de la instancia para acelerar la búsqueda de keys.
+   * @param boneMask Opcional: 0 = no muestreo ese hueso (se queda con el valor que tenía).
+   */
+  void
+    sample(float time,
+           bool loop,
+           BoneTransform* outPose,
+           SampleCursor* cursor = nullptr,
+           const uint8_t* boneMask = nullptr) const;
+
+  const std::string&
+    getName() const { return m_name; }
+
+  float
+    getDuration() const { return m_duration; }
+
+  float
+    getSampleRate() const { return m_sampleRate; }
+
+  unsigned int
+    getNumFrames() const { return m_numFrames; }
+
+  unsigned int
+    getNumBones() const { return m_numBones; }
+
+  /**
+   * @brief Keys que sobrevivieron a la reducción (todos los tracks).
+   */
+  size_t
+    getNumKeys() const { return m_keyFrames.size(); }
+
+  /**
+   * @brief Memoria que ocupa el clip comprimido.
+   */
+  size_t
+    getSizeInBytes() const;
+
+  /**
+   * @brief Memoria que ocuparía el mismo clip sin comprimir.
+   */
+  size_t
+    getRawSizeInBytes() const {
+    return static_cast<size_t>(m_numFrames) * m_numBones * sizeof(BoneTransform);
+  }
+
+  /**
+   * @brief Benchmark: memoria por clip, error y muestreo de 10k personajes.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Canal de un track.
+   */
+  enum
+    TrackType {
+    TRACK_ROTATION = 0,
+    TRACK_TRANSLATION = 1,
+    TRACK_SCALE = 2,
+    TRACK_COUNT = 3
+  };
+
+  /**
+   * @brief Un track: rango de keys y rango de cuantización.
+   */
+  struct
+    Track {
+    uint32_t firstKey = 0;
+    uint32_t numKeys = 0;
+    float rangeMin[3] = { 0.0f, 0.0f, 0.0f };
+    float rangeExtent[3] = { 0.0f, 0.0f, 0.0f };
+
+    /// @brief rangeExtent / 65535, para decodificar con una multiplicación.
+    float rangeScale[3] = { 0.0f, 0.0f, 0.0f };
+  };
+
+  /**
+   * @brief Encuentro el key de inicio del segmento que contiene `framePos`.
+   */
+  uint32_t
+    findKey(const Track& track, float framePos, uint16_t* hint) const;
+
+  void
+    decodeVector(const Track& track, uint32_t key, float out[3]) const;
+
+  Quaternion
+    decodeRotation(uint32_t key) const;
+
+private:
+  std::string m_name;
+  float m_duration = 0.0f;
+  float m_sampleRate = 30.0f;
+  unsigned int m_numFrames = 0;
+  unsigned int m_numBones = 0;
+
+  /// @brief bone * TRACK_COUNT + tipo.
+  std::vector<Track> m_tracks;
+
+  /// @brief Frame de cada key, agrupados por track.
+  std::vector<uint16_t> m_keyFrames;
+
+  /// @brief 3 valores cuantizados por key, en el mismo orden que m_keyFrames.
+  std::vector<uint16_t> m_keyData;
+};
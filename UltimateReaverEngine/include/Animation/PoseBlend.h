@@ -0,0 +1,82 @@
+/**
+ * @file PoseBlend.h
+ * @brief Aquí junto las operaciones para mezclar y apilar poses (blending y layering).
+ *
+ * @details
+ *  Todas trabajan sobre arreglos de BoneTransform locales (un elemento por hueso):
+ *  - `blend`: mezcla lineal entre dos poses (crossfade, blend trees).
+ *  - `blendMasked`: igual pero con un peso por hueso (por ejemplo, solo el torso).
+ *  - `makeAdditive` / `applyAdditive`: capas aditivas (respirar, apuntar, recoil)
+ *    que se suman encima de la pose base.
+ *
+ *  `out` puede ser el mismo arreglo que cualquiera de las entradas.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Animation/AnimationMath.h"
+
+class Skeleton;
+
+/**
+ * @class PoseBlend
+ * @brief Funciones de mezcla de poses.
+ */
+class
+  PoseBlend {
+public:
+  /**
+   * @brief out = lerp(a, b, weight) para cada hueso.
+   */
+  static void
+    blend(const BoneTransform* a,
+          const BoneTransform* b,
+          float weight,
+          unsigned int numBones,
+          BoneTransform* out);
+
+  /**
+   * @brief out = lerp(a, b, weight * mask[hueso]) para cada hueso.
+   */
+  static void
+    blendMasked(const BoneTransform* a,
+                const BoneTransform* b,
+                float weight,
+                const float* boneMask,
+                unsigned int numBones,
+                BoneTransform* out);
+
+  /**
+   * @brief Convierto una pose en una diferencia respecto a una pose de referencia.
+   *
+   * @details
+   *  Traslación: `p - r`. Rotación: `r^-1 * p`. Escala: `p / r`.
+   */
+  static void
+    makeAdditive(const BoneTransform* pose,
+                 const BoneTransform* reference,
+                 unsigned int numBones,
+                 BoneTransform* outAdditive);
+
+  /**
+   * @brief Sumo una pose aditiva a la base con un peso (y máscara opcional).
+   *
+   * @param boneMask Puede ser nullptr (peso uniforme).
+   */
+  static void
+    applyAdditive(const BoneTransform* base,
+                  const BoneTransform* additive,
+                  float weight,
+                  const float* boneMask,
+                  unsigned int numBones,
+                  BoneTransform* out);
+
+  /**
+   * @brief Máscara que vale `weight` en el subárbol de `rootBone` y 0 en el resto.
+   */
+  static void
+    buildSubtreeMask(const Skeleton& skeleton,
+                     int rootBone,
+                     float weight,
+                     std::vector<float>& outMask);
+};
@@ -0,0 +1,118 @@
+/**
+ * @file Skeleton.h
+ * @brief Aquí defino el Skeleton: la jerarquía de huesos que importo del FBX.
+ *
+ * @details
+ *  Guardo los huesos en un arreglo plano ordenado de padres a hijos
+ *  (el padre siempre tiene un índice menor que el hijo). Así puedo calcular
+ *  la pose global con un solo recorrido lineal, sin recursión.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Animation/AnimationMath.h"
+
+ /**
+  * @struct Bone
+  * @brief Un hueso del esqueleto.
+  */
+struct
+  Bone {
+  /// @brief Nombre del nodo en el FBX (lo uso para mapear clusters y curvas).
+  std::string name;
+
+  /// @brief Índice del hueso padre, o -1 si es raíz.
+  int parent = -1;
+
+  /// @brief Profundidad en la jerarquía (0 = raíz). La calcula addBone; la uso para el LOD de huesos.
+  int depth = 0;
+
+  /// @brief Matriz que lleva de espacio de malla (bind) a espacio del hueso.
+  Matrix3x4 inverseBindPose;
+
+  /// @brief Transformación local en la pose de bind.
+  BoneTransform bindLocal;
+};
+
+/**
+ * @class Skeleton
+ * @brief Jerarquía de huesos con utilidades para calcular poses y paletas de skinning.
+ */
+class
+  Skeleton {
+public:
+  Skeleton() = default;
+  ~Skeleton() = default;
+
+  /**
+   * @brief Agrego un hueso al final. El padre ya debe existir (índice menor).
+   * @return Índice del nuevo hueso.
+   */
+  int
+    addBone(const Bone& bone);
+
+  /**
+   * @brief Busco un hueso por nombre.
+   * @return Índice del hueso o -1 si no existe.
+   */
+  int
+    findBone(const std::string& name) const;
+
+  /**
+   * @brief Número de huesos.
+   */
+  unsigned int
+    getBoneCount() const { return static_cast<unsigned int>(m_bones.size()); }
+
+  /**
+   * @brief Acceso a los huesos.
+   */
+  const std::vector<Bone>&
+    getBones() const { return m_bones; }
+
+  /**
+   * @brief Acceso editable a un hueso (lo uso durante la importación).
+   */
+  Bone&
+    getBone(unsigned int index) { return m_bones[index]; }
+
+  /**
+   * @brief Pose local de bind de todos los huesos (útil como pose por defecto).
+   */
+  void
+    getBindPose(BoneTransform* outLocal) const;
+
+  /**
+   * @brief Convierto una pose local en matrices globales (espacio del modelo).
+   *
+   * @param local      Un BoneTransform por hueso.
+   * @param outGlobal  Una matriz por hueso.
+   */
+  void
+    computeGlobalPose(const BoneTransform* local, Matrix3x4* outGlobal) const;
+
+  /**
+   * @brief Paleta de skinning: global * inverseBindPose por hueso.
+   */
+  void
+    computeSkinningPalette(const Matrix3x4* global, Matrix3x4* outPalette) const;
+
+  /**
+   * @brief Atajo: pose local -> paleta de skinning.
+   */
+  void
+    computeSkinningPaletteFromLocal(const BoneTransform* local, Matrix3x4* outPalette) const;
+
+  /**
+   * @brief Borro todos los huesos.
+   */
+  void
+    clear() { m_bones.clear(); m_nameLookup.clear(); }
+
+private:
+  std::vector<Bone> m_bones;
+  std::unordered_map<std::string, int> m_nameLookup;
+
+  /// @brief Buffer temporal para no pedir memoria cada frame.
+  mutable std::vector<Matrix3x4> m_scratchGlobal;
+};
@@ -0,0 +1,167 @@
+/**
+ * @file SkinningKernel.h
+ * @brief Aquí defino el skinning por CPU con SIMD (linear blend y dual quaternion).
+ *
+ * @details
+ *  Para que el skinning sea rápido convierto los vértices a estructura de arreglos (SoA):
+ *  posiciones, normales y tangentes con X, Y, Z en arreglos separados y las 4 influencias
+ *  (hueso + peso) también
+ *  separadas. Así proceso 4 vértices a la vez con SSE2 (u 8 con AVX2 si el CPU lo
+ *  soporta; lo detecto con CPUID al arrancar) sin shuffles por vértice.
+ *
+ *  - Linear blend skinning: `p' = sum(w_i * M_i * p)`; la normal y la tangente van con la
+ *    parte 3x3 de la misma mezcla y se renormalizan.
+ *  - Dual quaternion skinning: mezclo cuaterniones duales y transformo con el resultado
+ *    normalizado (la normal y la tangente solo con su rotación); evita el efecto
+ *    "candy wrapper" pero ignora la escala de los huesos.
+ *
+ *  Todo esto es CPU puro: no toca D3D, así que se puede medir y verificar headless.
+ *  `skinReference()` es la versión escalar que uso para validar la versión SIMD.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+#include "Animation/AnimationMath.h"
+
+class BenchmarkReport;
+
+/**
+ * @enum SkinningMethod
+ * @brief Algoritmo de mezcla de huesos.
+ */
+enum class
+  SkinningMethod {
+  Linear = 0,         ///< Linear blend skinning (matrices).
+  DualQuaternion = 1  ///< Dual quaternion skinning (sin escala).
+};
+
+/**
+ * @class SkinnedMeshData
+ * @brief Copia SoA de las posiciones, normales, tangentes e influencias de una malla lista para el kernel.
+ *
+ * @details
+ *  Los arreglos están rellenados hasta múltiplo de `kPadding` con vértices de peso 0,
+ *  así el kernel nunca necesita un loop de cola.
+ */
+class
+  SkinnedMeshData {
+public:
+  /// @brief Múltiplo al que relleno los arreglos (el ancho SIMD más grande).
+  static const unsigned int kPadding = 8;
+
+  SkinnedMeshData() = default;
+  ~SkinnedMeshData() = default;
+
+  /**
+   * @brief Construyo los arreglos SoA a partir de la malla (necesita `m_skin`).
+   * @return false si la malla no tiene influencias.
+   */
+  bool
+    build(const MeshComponent& mesh);
+
+  /**
+   * @brief Número real de vértices (sin relleno).
+   */
+  unsigned int
+    getNumVertices() const { return m_numVertices; }
+
+  /**
+   * @brief Número de vértices con relleno.
+   */
+  unsigned int
+    getPaddedCount() const { return static_cast<unsigned int>(m_posX.size()); }
+
+public:
+  std::vector<float> m_posX;
+  std::vector<float> m_posY;
+  std::vector<float> m_posZ;
+  std::vector<float> m_normalX;
+  std::vector<float> m_normalY;
+  std::vector<float> m_normalZ;
+  /// @brief Dirección de la tangente; su signo (`Tangent.w`) no cambia con el skinning.
+  std::vector<float> m_tangentX;
+  std::vector<float> m_tangentY;
+  std::vector<float> m_tangentZ;
+
+  /// @brief Índice de hueso por influencia (int32, como los leen los kernels SIMD).
+  std::vector<int> m_bone[4];
+  std::vector<float> m_weight[4];
+
+private:
+  unsigned int m_numVertices = 0;
+};
+
+/**
+ * @struct SkinningJob
+ * @brief Una malla a skinnear con su paleta y su destino.
+ *
+ * @details
+ *  El kernel escribe `Pos`, `Normal` y `Tangent.xyz` en `output`; el resto del vértice
+ *  (UVs y el signo de la tangente) se queda como estaba, así que el destino se inicializa
+ *  una vez con los vértices originales.
+ */
+struct
+  SkinningJob {
+  const SkinnedMeshData* mesh = nullptr;
+  const Matrix3x4* palette = nullptr;
+  const DualQuaternion* dualQuatPalette = nullptr;
+  SkinningMethod method = SkinningMethod::Linear;
+  SimpleVertex* output = nullptr;
+};
+
+/**
+ * @class SkinningKernel
+ * @brief Funciones de skinning (escalar de referencia, SIMD y multihilo).
+ */
+class
+  SkinningKernel {
+public:
+  /**
+   * @brief Paleta de cuaterniones duales a partir de la paleta de matrices.
+   */
+  static void
+    buildDualQuaternionPalette(const Matrix3x4* palette,
+                               unsigned int numBones,
+                               DualQuaternion* outPalette);
+
+  /**
+   * @brief Versión escalar, sin trucos. La uso como referencia para verificar.
+   */
+  static void
+    skinReference(const SkinningJob& job);
+
+  /**
+   * @brief Skinning SIMD de los vértices [begin, end) de un job.
+   *
+   * @details `begin` debe ser múltiplo de `SkinnedMeshData::kPadding`.
+   */
+  static void
+    skinRange(const SkinningJob& job, unsigned int begin, unsigned int end);
+
+  /**
+   * @brief Skinning de varias mallas repartidas entre los hilos del JobSystem.
+   *
+   * @param jobs           Mallas a procesar.
+   * @param count          Número de mallas.
+   * @param multithreaded  false = todo en el hilo que llama.
+   *
+   * @details
+   *  Parto cada malla en bloques de vértices para que también una malla grande
+   *  se reparta entre varios hilos, y no solo mallas distintas.
+   */
+  static void
+    skinMeshes(const SkinningJob* jobs, size_t count, bool multithreaded = true);
+
+  /**
+   * @brief Nombre del camino SIMD que elegí para este CPU ("SSE2" o "AVX2").
+   */
+  static const char*
+    getSimdPathName();
+
+  /**
+   * @brief Benchmark: vértices/ms escalar vs SIMD vs multihilo, y error contra la referencia.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+};
@@ -0,0 +1,37 @@
+/**
+ * @file SyntheticAnimation.h
+ * @brief Aquí genero esqueletos, clips y mallas sintéticas para los benchmarks de animación.
+ *
+ * @details
+ *  Los benchmarks corren sin assets, así que necesito datos con una forma parecida a
+ *  un personaje real: jerarquía de varios niveles, curvas suaves, huesos quietos y
+ *  vértices con 4 influencias.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+#include "Animation/Skeleton.h"
+#include "Animation/AnimationClip.h"
+
+namespace SyntheticAnimation {
+
+  /**
+   * @brief Esqueleto en árbol binario (el hueso i cuelga de (i - 1) / 2).
+   */
+  Skeleton
+    makeSkeleton(unsigned int numBones);
+
+  /**
+   * @brief Clip con la raíz avanzando y rotaciones senoidales (un tercio de los huesos quietos).
+   */
+  AnimationClip
+    makeClip(unsigned int numBones, float seconds, float phase);
+
+  /**
+   * @brief Malla con `numVertices` vértices y 4 influencias normalizadas por vértice.
+   */
+  MeshComponent
+    makeSkinnedMesh(unsigned int numVertices, unsigned int numBones, unsigned int seed);
+
+} // namespace SyntheticAnimation
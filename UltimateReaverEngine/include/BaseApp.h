@@ -25,7 +25,28 @@
 #include "SamplerState.h"
 #include "Model3D.h"
 #include "ECS/Actor.h"
+#include "ECS/Prefab.h"
+#include "ECS/Camera.h"
+#include "Animation/Animator.h"
+#include "Animation/AnimationScheduler.h"
+#include "Lighting/ClusteredLighting.h"
+#include "Lighting/LightClusterBuffers.h"
+#include "Lighting/LightmapBaker.h"
+#include "Shadows/CascadedShadows.h"
+#include "Shadows/ShadowRenderer.h"
+#include "Culling/SoftwareOcclusion.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleRenderer.h"
+#include "Simulation/FixedTimestep.h"
+#include "Simulation/SimulationReplay.h"
+#include "Collision/CollisionWorld.h"
+#include "Scene/SceneFile.h"
+#include "Scene/WorldPartition.h"
+#include "JobSystem.h"
+#include "RenderStateCache.h"
+#include "GeometryPool.h"
 #include "UserInterface.h"
+#include "ViewSystem.h"
 
  /**
   * @class BaseApp
@@ -77,6 +98,34 @@ public:
   int
     run(HINSTANCE hInst, int nCmdShow);
 
+  /**
+   * @brief Pido grabar o reproducir la simulación (antes de `run`).
+   *
+   * @param mode  `REPLAY_RECORD` guarda en `path` al cerrar; `REPLAY_PLAYBACK` lo carga en `init`.
+   * @param path  Archivo de replay.
+   */
+  void
+    setReplay(ReplayMode mode, const std::string& path) {
+    m_replayMode = mode;
+    m_replayPath = path;
+  }
+
+  /**
+   * @brief Archivo de escena a cargar en `init` (antes de `run`).
+   *
+   * @details Si no existe, guardo ahí la escena por defecto para tener de dónde partir.
+   */
+  void
+    setScenePath(const std::string& path) { m_scenePath = path; }
+
+  /**
+   * @brief Número de cámaras activas (antes de `run`): 1 es pantalla completa, más es pantalla dividida.
+   */
+  void
+    setNumViews(unsigned int numViews) {
+    m_numViews = std::max(1u, std::min(numViews, ViewSystem::kMaxViews));
+  }
+
   /**
    * @brief Inicializo todos los sistemas del motor.
    * @return HRESULT  S_OK si todo salió bien.
@@ -92,6 +141,20 @@ public:
   void
     update(float deltaTime);
 
+  /**
+   * @brief Un paso fijo de simulación (input, transforms anteriores, partículas, hash de las partículas).
+   *
+   * @param stepSeconds  Duración del paso, siempre la misma.
+   */
+  void
+    fixedUpdate(float stepSeconds);
+
+  /**
+   * @brief Selecciono en el inspector el actor bajo el mouse (rayo contra los colliders).
+   */
+  void
+    pickActor();
+
   /**
    * @brief Renderizo la escena cada frame.
    */
@@ -122,12 +185,38 @@ private:
   static LRESULT CALLBACK
     wndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
+  /**
+   * @brief Creo los modelos, texturas y actores de una escena cargada.
+   */
+  HRESULT
+    instantiateScene(const SceneFile& scene);
+
+  /**
+   * @brief Armo o suelto los actores cuyas celdas cambiaron en el último paso de streaming.
+   */
+  void
+    applyStreaming();
+
+  /**
+   * @brief Horneado del lightmap: arranco si la UI lo pidió, avanzo con un presupuesto
+   *        por frame, subo la vista previa y guardo el asset al terminar.
+   */
+  void
+    updateLightmapBake();
+
+  void
+    attachEntity(unsigned int entity);
+
+  void
+    detachEntity(unsigned int entity);
+
 private:
   // --- subsistemas base ---
   Window m_window;            ///< Ventana principal
   Device m_device;            ///< Dispositivo DirectX11
   DeviceContext m_deviceContext; ///< Contexto de dispositivo (GPU)
   SwapChain m_swapChain;      ///< Maneja front/back buffer
+  D3D11RenderStateBackend m_stateBackend; ///< Crea los estados de `RenderStateCache`
 
   // --- targets y depth ---
   Texture m_backBuffer;
@@ -145,19 +234,30 @@ private:
   Buffer m_cbNeverChanges;
   Buffer m_cbChangeOnResize;
 
-  // --- textura del modelo principal (avión) ---
-  Texture m_abeBowserAlbedo;
 
-  // --- matrices cámara ---
+  // --- matrices cámara (las de la vista principal) ---
   XMMATRIX m_View;
   XMMATRIX m_Projection;
 
+  // --- cámaras y vistas del frame (culling compartido) ---
+  std::vector<EU::TSharedPointer<Actor>> m_cameras;
+  ViewSystem m_viewSystem;
+  unsigned int m_numViews = 1;
+
   // --- actores de la escena ---
   std::vector<EU::TSharedPointer<Actor>> m_actors;
-  EU::TSharedPointer<Actor> m_abeBowser;
 
-  // --- modelo cargado ---
-  Model3D* m_model;
+  // --- escena y streaming (un modelo o textura por recurso del archivo) ---
+  std::string m_scenePath;
+  SceneFile m_scene;
+  WorldPartition m_worldPartition;
+  std::vector<Model3D*> m_models;
+  std::vector<Texture> m_sceneTextures;
+
+  // --- prefabs: uno por par modelo/textura, vivo mientras alguna entidad cargada lo use ---
+  std::vector<EU::TSharedPointer<Prefab>> m_prefabs;
+  std::vector<unsigned int> m_prefabUsers;
+  std::vector<unsigned int> m_entityPrefab;
 
   // --- data para constant buffers ---
   CBChangeOnResize cbChangesOnResize;
@@ -165,4 +265,45 @@ private:
 
   // --- interfaz gráfica ---
   UserInterface m_userInterface;
+
+  // --- animación (LOD y presupuesto) ---
+  AnimationScheduler m_animationScheduler;
+
+  // --- luces dinámicas (clustered forward) ---
+  std::vector<Light> m_lights;
+  ClusteredLighting m_clusteredLighting;
+  LightClusterBuffers m_lightClusterBuffers;
+
+  // --- lightmap (horneado en CPU con vista previa en la UI) ---
+  LightmapBaker m_lightmapBaker;
+  Texture m_lightmapTexture;
+  Texture m_lightmapView;
+  unsigned int m_lightmapPreviewVersion = 0;
+
+  // --- sombras en cascada ---
+  CascadedShadows m_cascadedShadows;
+  ShadowRenderer m_shadowRenderer;
+  std::vector<ShadowCaster> m_shadowCasters;
+
+  // --- culling por oclusión en CPU ---
+  SoftwareOcclusion m_occlusion;
+  std::vector<OccluderInstance> m_occluders;
+  std::vector<OcclusionBounds> m_actorBounds;
+  std::vector<unsigned int> m_boundsActor;   ///< Actor al que pertenece cada caja
+  std::vector<uint8_t> m_boundsVisible;
+  std::vector<uint8_t> m_actorVisible;       ///< 1 si el actor se dibuja este frame
+
+  // --- partículas ---
+  ParticleSystem m_particles;
+  ParticleRenderer m_particleRenderer;
+
+  // --- simulación a paso fijo y replay ---
+  FixedTimestep m_timestep;
+  SimulationReplay m_replay;
+  ReplayMode m_replayMode = REPLAY_OFF;
+  std::string m_replayPath;
+
+  // --- colisiones y picking ---
+  CollisionWorld m_collision;
+  std::vector<unsigned int> m_actorCollider; ///< Collider de cada actor (o kInvalidCollider)
 };
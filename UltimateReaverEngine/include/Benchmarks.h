@@ -0,0 +1,86 @@
+/**
+ * @file Benchmarks.h
+ * @brief Aquí junto los benchmarks de CPU de los subsistemas del motor.
+ *
+ * @details
+ *  Los subsistemas pesados (skinning, culling, etc.) tienen una función estática
+ *  `runBenchmark(BenchmarkReport&)` que genera datos sintéticos, mide con `Timer`
+ *  y escribe los resultados en el reporte. No necesitan ventana ni device de D3D,
+ *  así que se pueden correr sin gráficos:
+ *
+ *  `UltimateReaverEngine.exe -bench`            corre todos (igual que `-bench all`).
+ *  `UltimateReaverEngine.exe -bench skinning`   corre solo el que se llama "skinning".
+ *
+ *  El resultado se manda a la salida de depuración y a `benchmarks.txt`.
+ */
+
+#pragma once
+#include <string>
+
+ /**
+  * @class BenchmarkReport
+  * @brief Acumula el texto de los resultados y lo manda a la salida de depuración.
+  */
+class
+  BenchmarkReport {
+public:
+  BenchmarkReport() = default;
+  ~BenchmarkReport() = default;
+
+  /**
+   * @brief Escribo una línea con formato estilo printf.
+   */
+  void
+    log(const char* format, ...);
+
+  /**
+   * @brief Encabezado de una sección (un benchmark).
+   */
+  void
+    section(const std::string& name);
+
+  /**
+   * @brief Marco que una verificación falló (se refleja en el código de salida).
+   */
+  void
+    fail(const std::string& message);
+
+  /**
+   * @brief Guardo todo el texto acumulado en un archivo.
+   */
+  bool
+    writeToFile(const std::string& path) const;
+
+  const std::string&
+    getText() const { return m_text; }
+
+  unsigned int
+    getFailureCount() const { return m_failures; }
+
+private:
+  std::string m_text;
+  unsigned int m_failures = 0;
+};
+
+/**
+ * @class Benchmarks
+ * @brief Registro de todos los benchmarks del motor.
+ */
+class
+  Benchmarks {
+public:
+  /**
+   * @brief Firma de un benchmark.
+   */
+  using BenchmarkFunc = void(*)(BenchmarkReport& report);
+
+  /**
+   * @brief Corro el benchmark que se llama exactamente `filter`, o todos con "all".
+   *
+   * @param filter     Nombre del benchmark o "all". Un nombre que no existe cuenta como falla.
+   * @param outputPath Archivo donde guardo el reporte.
+   * @return 0 si todo salió bien, 1 si alguna verificación falló.
+   */
+  static int
+    run(const std::string& filter, const std::string& outputPath = "benchmarks.txt");
+};
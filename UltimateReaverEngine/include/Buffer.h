@@ -77,6 +77,20 @@ public:
   HRESULT
     init(Device& device, unsigned int byteWidth);
 
+  /**
+   * @brief Inicializo un vertex o index buffer vaco de `numElements` elementos.
+   *
+   * @param device       Dispositivo de Direct3D que crea el buffer.
+   * @param numElements  Cuntos vrtices o ndices caben.
+   * @param stride       Tamao de un elemento en bytes.
+   * @param bindFlag     `D3D11_BIND_VERTEX_BUFFER` o `D3D11_BIND_INDEX_BUFFER`.
+   *
+   * @details
+   *  Lo uso para los buffers grandes del `GeometryPool`: se llenan por rangos con `update()`.
+   */
+  HRESULT
+    init(Device& device, unsigned int numElements, unsigned int stride, unsigned int bindFlag);
+
   /**
    * @brief Actualizo los datos de un buffer existente.
    *
@@ -108,7 +122,7 @@ public:
    * @param StartSlot      Slot donde se va a asignar el buffer.
    * @param NumBuffers     Nmero de buffers a activar.
    * @param setPixelShader Si es true, el buffer se vincula al pixel shader (en lugar del vertex shader).
-   * @param format         Formato de los ndices (solo si es un index buffer).
+   * @param format         Formato de los ndices (solo si es un index buffer; `UNKNOWN` = el del buffer).
    *
    * @details
    *  Aqu le digo a la GPU: usa este buffer para dibujar.
@@ -149,6 +163,14 @@ public:
       D3D11_BUFFER_DESC& desc,
       D3D11_SUBRESOURCE_DATA* initData);
 
+  /// @brief Buffer de Direct3D (nullptr si no se ha creado).
+  ID3D11Buffer*
+    getBuffer() const { return m_buffer; }
+
+  /// @brief Formato de los ndices (`R16_UINT` o `R32_UINT`) si es un index buffer.
+  DXGI_FORMAT
+    getIndexFormat() const { return m_format; }
+
 private:
 
   /// @brief Puntero al buffer de Direct3D (ya sea de vrtices, ndices o constantes).
@@ -162,4 +184,7 @@ private:
 
   /// @brief Tipo de buffer segn Direct3D (por ejemplo, `D3D11_BIND_VERTEX_BUFFER`).
   unsigned int m_bindFlag = 0;
+
+  /// @brief Formato de los ndices; `render()` lo usa si no le piden otro.
+  DXGI_FORMAT m_format = DXGI_FORMAT_UNKNOWN;
 };
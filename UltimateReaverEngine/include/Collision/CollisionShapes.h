@@ -0,0 +1,127 @@
+/**
+ * @file CollisionShapes.h
+ * @brief Aquí defino las formas de colisión y las pruebas exactas entre ellas.
+ *
+ * @details
+ *  Un collider se describe en espacio local (`ColliderDesc`) y cada vez que su actor se
+ *  mueve lo paso a mundo (`WorldShape`). Las pruebas de la narrowphase y los raycasts
+ *  trabajan siempre con la forma en mundo.
+ *
+ *  Formas:
+ *  - **AABB:** caja alineada a los ejes del mundo. Si el actor rota, la caja crece para
+ *    seguir envolviendo (igual que `Actor::getWorldBounds`).
+ *  - **Esfera.**
+ *  - **Cápsula:** segmento sobre el eje Y local con radio.
+ *  - **OBB:** caja orientada con los ejes del actor.
+ *
+ *  Cajas contra cajas van por SAT (15 ejes); lo redondo se reduce a distancia entre
+ *  puntos y segmentos. Caja contra cápsula es aproximada: busco el punto del segmento
+ *  más cercano a la caja con unas iteraciones de punto más cercano alternado.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @enum ShapeType
+ * @brief Tipo de forma de un collider.
+ */
+enum ShapeType {
+  SHAPE_AABB,
+  SHAPE_SPHERE,
+  SHAPE_CAPSULE,
+  SHAPE_OBB
+};
+
+/**
+ * @struct ColliderDesc
+ * @brief Forma de un collider en espacio local del actor.
+ */
+struct
+  ColliderDesc {
+  ShapeType type = SHAPE_AABB;
+  XMFLOAT3 center = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  /// @brief Media extensión de las cajas (AABB/OBB).
+  XMFLOAT3 halfExtents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+  /// @brief Radio de esfera y cápsula.
+  float radius = 0.5f;
+  /// @brief Mitad del segmento de la cápsula (sobre Y local).
+  float halfHeight = 0.5f;
+};
+
+/**
+ * @struct WorldShape
+ * @brief Forma ya transformada a mundo, lista para las pruebas.
+ */
+struct
+  WorldShape {
+  ShapeType type = SHAPE_AABB;
+  XMFLOAT3 center;
+  /// @brief Ejes unitarios de la caja (identidad para AABB).
+  XMFLOAT3 axis[3];
+  XMFLOAT3 halfExtents;
+  float radius = 0.0f;
+  /// @brief Extremos del segmento de la cápsula.
+  XMFLOAT3 segmentA;
+  XMFLOAT3 segmentB;
+};
+
+/**
+ * @struct CollisionContact
+ * @brief Un par que sí se toca; la normal va de `a` hacia `b`.
+ */
+struct
+  CollisionContact {
+  unsigned int a;
+  unsigned int b;
+  XMFLOAT3 normal;
+  float depth;
+};
+
+/**
+ * @class CollisionShapes
+ * @brief Funciones de forma: paso a mundo, cajas envolventes, overlap y raycast.
+ */
+class
+  CollisionShapes {
+public:
+  /**
+   * @brief Paso la forma local a mundo con la matriz del actor (convención fila).
+   *
+   * @details La escala no uniforme se aplica a las cajas; esfera y cápsula usan la mayor.
+   */
+  static WorldShape
+    toWorld(const ColliderDesc& desc, const XMFLOAT4X4& world);
+
+  /**
+   * @brief Caja alineada que envuelve la forma.
+   */
+  static void
+    computeBounds(const WorldShape& shape, float minPoint[3], float maxPoint[3]);
+
+  /**
+   * @brief Prueba exacta entre dos formas.
+   *
+   * @param normal  Dirección para separar `b` de `a`.
+   * @param depth   Penetración a lo largo de `normal`.
+   * @return true si se tocan.
+   */
+  static bool
+    overlap(const WorldShape& a, const WorldShape& b, XMFLOAT3& normal, float& depth);
+
+  /**
+   * @brief Raycast contra la forma.
+   *
+   * @param direction  Unitaria.
+   * @param distance   Distancia al impacto (solo si regresa true).
+   * @param normal     Normal de la superficie en el impacto.
+   * @return true si pega antes de `maxDistance` (desde adentro no cuenta).
+   */
+  static bool
+    raycast(const WorldShape& shape,
+            const XMFLOAT3& origin,
+            const XMFLOAT3& direction,
+            float maxDistance,
+            float& distance,
+            XMFLOAT3& normal);
+};
@@ -0,0 +1,267 @@
+/**
+ * @file CollisionWorld.h
+ * @brief Aquí defino el mundo de colisión: broadphase por franjas con sweep-and-prune, narrowphase y raycasts.
+ *
+ * @details
+ *  Cada collider tiene un proxy con su forma en mundo y su caja envolvente. La broadphase
+ *  es multi-box pruning: parto el mundo en franjas sobre Z y dentro de cada franja hago
+ *  sweep-and-prune sobre X. Un solo SAP sobre X se degrada cuando el mundo es ancho en
+ *  las dos direcciones del piso (cada caja se barre contra todo lo que comparte su X);
+ *  con franjas cada barrido solo ve a los vecinos cercanos. Por frame:
+ *
+ *  1. **Refit incremental:** solo los colliders cuyo transform cambió (`setTransform`
+ *     compara la matriz) recalculan su forma y su caja, en paralelo.
+ *  2. **Orden por franja:** cada collider vive en la franja de su `minZ`, con las cajas
+ *     en SoA ordenadas por `minX`. Entre frames casi no cambia el orden, así que lo
+ *     reacomodo con insertion sort; los que cambiaron de franja se quitan de la vieja y
+ *     se mezclan ordenados en la nueva. Cada franja se procesa en su propio hilo.
+ *  3. **Barrido:** cada caja se compara con las siguientes de su franja mientras `minX`
+ *     no pase su `maxX`, y con las franjas de adelante que aún puede tocar (recortando por
+ *     búsqueda binaria en X). Las pruebas van de 4 en 4 con SSE. Cada par sale una sola
+ *     vez y en el mismo orden sin importar cuántos hilos haya.
+ *  4. **Narrowphase:** prueba exacta de cada par (ver `CollisionShapes`) en paralelo.
+ *
+ *  Los raycasts van en lotes y en paralelo por rayo: recorro solo las franjas que cruza
+ *  el rayo, recorto por X con búsqueda binaria, pruebo las cajas contra el rayo de 4 en 4
+ *  con slabs SSE y solo las que pegan pasan a la prueba exacta.
+ *
+ *  No toca D3D, así que se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Collision/CollisionShapes.h"
+
+class BenchmarkReport;
+
+/// @brief Handle que no apunta a ningún collider.
+const unsigned int kInvalidCollider = 0xFFFFFFFFu;
+
+/**
+ * @struct CollisionRay
+ * @brief Rayo de consulta; `direction` debe ser unitaria.
+ */
+struct
+  CollisionRay {
+  XMFLOAT3 origin;
+  XMFLOAT3 direction;
+  float maxDistance = 1000.0f;
+};
+
+/**
+ * @struct RaycastHit
+ * @brief Resultado de un rayo (`collider == kInvalidCollider` si no pegó).
+ */
+struct
+  RaycastHit {
+  unsigned int collider = kInvalidCollider;
+  float distance = 0.0f;
+  XMFLOAT3 point;
+  XMFLOAT3 normal;
+};
+
+/**
+ * @struct CollisionWorldSettings
+ * @brief Franjas de la broadphase (sobre Z).
+ *
+ * @details Lo que quede fuera del rango cae en la primera o la última franja.
+ */
+struct
+  CollisionWorldSettings {
+  float originZ = -1024.0f;
+  float bandWidth = 32.0f;
+  unsigned int numBands = 64;
+};
+
+/**
+ * @struct CollisionStats
+ * @brief Números del último `update`.
+ */
+struct
+  CollisionStats {
+  unsigned int colliders = 0;
+  /// @brief Colliders que se movieron y se recalcularon.
+  unsigned int refitted = 0;
+  /// @brief Colliders que cambiaron de franja.
+  unsigned int bandChanges = 0;
+  /// @brief Intercambios del insertion sort (mide la coherencia temporal).
+  unsigned long long swaps = 0;
+  unsigned int pairs = 0;
+  unsigned int contacts = 0;
+  double refitMs = 0.0;
+  double sortMs = 0.0;
+  double sweepMs = 0.0;
+  double narrowMs = 0.0;
+};
+
+/**
+ * @class CollisionWorld
+ * @brief Colliders de la escena con broadphase incremental y consultas por lotes.
+ */
+class
+  CollisionWorld {
+public:
+  CollisionWorld() = default;
+  ~CollisionWorld() = default;
+
+  /**
+   * @brief Cambio las franjas; solo con el mundo vacío.
+   */
+  void
+    setSettings(const CollisionWorldSettings& settings);
+
+  const CollisionWorldSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Agrego un collider.
+   *
+   * @param userData  Dato libre (en la app, el índice del actor).
+   * @return Handle del collider (entra a las consultas en el siguiente `update`).
+   */
+  unsigned int
+    addCollider(const ColliderDesc& desc, const XMFLOAT4X4& world, unsigned int userData);
+
+  void
+    removeCollider(unsigned int collider);
+
+  /**
+   * @brief Nuevo transform del collider; si no cambió no cuesta nada en el siguiente `update`.
+   */
+  void
+    setTransform(unsigned int collider, const XMFLOAT4X4& world);
+
+  unsigned int
+    getUserData(unsigned int collider) const { return m_proxies[collider].userData; }
+
+  const WorldShape&
+    getShape(unsigned int collider) const { return m_proxies[collider].shape; }
+
+  unsigned int
+    getNumColliders() const { return m_numColliders; }
+
+  /**
+   * @brief Refit de los que se movieron, reorden por franja, barrido y narrowphase.
+   */
+  void
+    update();
+
+  /// @brief Pares de cajas que se tocan (handle menor primero).
+  const std::vector<std::pair<unsigned int, unsigned int>>&
+    getPairs() const { return m_pairs; }
+
+  /// @brief Pares que sí se tocan con la forma exacta.
+  const std::vector<CollisionContact>&
+    getContacts() const { return m_contacts; }
+
+  /**
+   * @brief Lanzo un lote de rayos en paralelo; `hits[i]` es el impacto más cercano del rayo `i`.
+   */
+  void
+    raycast(const CollisionRay* rays, size_t count, RaycastHit* hits) const;
+
+  /**
+   * @brief Un solo rayo (picking).
+   */
+  bool
+    raycast(const CollisionRay& ray, RaycastHit& hit) const;
+
+  const CollisionStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: 100k colliders moviéndose, pares, contactos y rayos.
+   *
+   * @details
+   *  Verifica pares y rayos contra fuerza bruta en un mundo más chico.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @struct Proxy
+   * @brief Estado de un collider.
+   */
+  struct
+    Proxy {
+    ColliderDesc desc;
+    XMFLOAT4X4 world;
+    WorldShape shape;
+    float minPoint[3];
+    float maxPoint[3];
+    unsigned int userData = 0;
+    /// @brief Franja donde vive (`kInvalidCollider` si está libre).
+    unsigned int band = kInvalidCollider;
+    /// @brief Posición en su franja (`kInvalidCollider` mientras espera entrar).
+    unsigned int slot = kInvalidCollider;
+    /// @brief Franja a la que se muda en este `update`.
+    unsigned int nextBand = kInvalidCollider;
+    bool dirty = false;
+  };
+
+  /**
+   * @struct Band
+   * @brief Cajas de una franja en SoA, ordenadas por `minX`.
+   */
+  struct
+    Band {
+    std::vector<float> minX;
+    std::vector<float> maxX;
+    std::vector<float> minY;
+    std::vector<float> maxY;
+    std::vector<float> minZ;
+    std::vector<float> maxZ;
+    std::vector<unsigned int> proxy;
+    /// @brief Colliders que entran a la franja en este `update`.
+    std::vector<unsigned int> incoming;
+    unsigned long long swaps = 0;
+    float maxWidthX = 0.0f;
+    float maxDepthZ = 0.0f;
+  };
+
+  unsigned int
+    bandOf(float z) const;
+
+  /// @brief Quito los que se fueron, reacomodo con insertion sort y mezclo los que llegan.
+  void
+    sortBand(unsigned int band);
+
+  /// @brief Barrido de los slots `[begin, end)` de una franja contra su franja y las siguientes.
+  void
+    sweepRange(unsigned int band, size_t begin, size_t end,
+               std::vector<std::pair<unsigned int, unsigned int>>& pairs) const;
+
+  /// @brief Escribo la caja de un proxy en su slot.
+  void
+    writeBounds(const Proxy& proxy);
+
+  /// @brief Un rayo con recorte por franja y X, y slabs SSE.
+  void
+    raycastOne(const CollisionRay& ray, RaycastHit& hit) const;
+
+  /// @brief Pares por fuerza bruta (referencia del benchmark).
+  void
+    findPairsReference(std::vector<std::pair<unsigned int, unsigned int>>& pairs) const;
+
+  /// @brief Rayo contra todos sin recortes (referencia del benchmark).
+  void
+    raycastReference(const CollisionRay& ray, RaycastHit& hit) const;
+
+private:
+  CollisionWorldSettings m_settings;
+  std::vector<Proxy> m_proxies;
+  std::vector<unsigned int> m_freeProxies;
+  /// @brief Handles borrados que se liberan al terminar el siguiente `update`.
+  std::vector<unsigned int> m_pendingFree;
+  std::vector<unsigned int> m_dirty;
+  std::vector<Band> m_bands;
+  unsigned int m_numColliders = 0;
+  /// @brief Ancho máximo en X y profundidad máxima en Z de una caja (para los recortes).
+  float m_maxWidthX = 0.0f;
+  float m_maxDepthZ = 0.0f;
+
+  std::vector<std::pair<unsigned int, unsigned int>> m_pairs;
+  std::vector<CollisionContact> m_contacts;
+  CollisionStats m_stats;
+};
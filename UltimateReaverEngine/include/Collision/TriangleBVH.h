@@ -0,0 +1,239 @@
+/**
+ * @file TriangleBVH.h
+ * @brief Aquí defino la BVH de triángulos de una malla para raycasts precisos (picking).
+ *
+ * @details
+ *  El mundo de colisión solo sabe de formas envolventes; para saber qué sub-malla del
+ *  modelo está bajo el mouse necesito rayo contra triángulo, y con millones de
+ *  triángulos eso solo es viable con una jerarquía.
+ *
+ *  - **Construcción:** SAH por bins (16 por eje) sobre los centroides. En cada nodo
+ *    pruebo los 3 ejes y me quedo con el corte más barato; si ningún corte le gana a
+ *    dejarlo como hoja, es hoja. Los hijos quedan juntos en el arreglo de nodos.
+ *  - **Triángulos:** los guardo precalculados (`v0`, `e1`, `e2`) en el orden de las hojas,
+ *    así la prueba Möller–Trumbore no toca los índices ni los vértices de la malla.
+ *  - **Consultas:** closest-hit y any-hit (solo "¿hay algo?", para sombras/visibilidad),
+ *    con un rayo o en paquetes de 4 u 8. El paquete baja por el árbol junto: un nodo se
+ *    visita si algún rayo activo lo toca, y cada caja y triángulo se prueba contra 4 rayos
+ *    a la vez con SSE (el de 8 son dos mitades de 4 que comparten el recorrido).
+ *  - **Caché:** la construcción de una malla grande cuesta; serializo los nodos y el orden de
+ *    los triángulos con un hash de la geometría y van como sección de la caché `.urmesh` del
+ *    modelo. Si el hash no coincide (el modelo cambió) la reconstruyo.
+ *
+ *  No toca D3D, así que se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cfloat>
+
+class BenchmarkReport;
+class MeshComponent;
+
+/// @brief Triángulo que no existe (rayo que no pegó).
+const unsigned int kInvalidTriangle = 0xFFFFFFFFu;
+
+/**
+ * @struct BVHRay
+ * @brief Rayo en el espacio de la malla; `direction` no necesita ser unitaria
+ *        (`distance` se mide en múltiplos de ella).
+ */
+struct
+  BVHRay {
+  XMFLOAT3 origin;
+  XMFLOAT3 direction;
+  float maxDistance = FLT_MAX;
+};
+
+/**
+ * @struct BVHHit
+ * @brief Impacto más cercano: triángulo original (índice en `m_index / 3`) y baricéntricas.
+ */
+struct
+  BVHHit {
+  unsigned int triangle = kInvalidTriangle;
+  float distance = FLT_MAX;
+  float u = 0.0f;
+  float v = 0.0f;
+};
+
+/**
+ * @struct TriangleBVHSettings
+ * @brief Parámetros de la construcción.
+ */
+struct
+  TriangleBVHSettings {
+  /// @brief Triángulos por hoja a partir de los cuales ya no intento cortar.
+  unsigned int minLeafSize = 2;
+  /// @brief Tope de triángulos por hoja aunque al SAH le convenga más.
+  unsigned int maxLeafSize = 16;
+  /// @brief Costo de visitar un nodo relativo a probar un triángulo.
+  float traversalCost = 1.0f;
+};
+
+/**
+ * @class TriangleBVH
+ * @brief BVH de los triángulos de una malla con consultas de rayo simples y por paquetes.
+ */
+class
+  TriangleBVH {
+public:
+  TriangleBVH() = default;
+  ~TriangleBVH() = default;
+
+  /**
+   * @brief Construyo el árbol con SAH por bins.
+   *
+   * @param positions  Posiciones de los vértices.
+   * @param stride     Bytes entre posiciones (para leer directo de `SimpleVertex`).
+   * @param indices    Tres índices por triángulo.
+   */
+  void
+    build(const XMFLOAT3* positions,
+          size_t numVertices,
+          size_t stride,
+          const unsigned int* indices,
+          size_t numIndices,
+          const TriangleBVHSettings& settings = TriangleBVHSettings());
+
+  /**
+   * @brief Construyo la BVH de una malla del modelo.
+   */
+  void
+    build(const std::vector<SimpleVertex>& vertices, const std::vector<unsigned int>& indices);
+
+  bool
+    isEmpty() const { return m_nodes.empty(); }
+
+  unsigned int
+    getNumTriangles() const { return static_cast<unsigned int>(m_triangles.size()); }
+
+  unsigned int
+    getNumNodes() const { return static_cast<unsigned int>(m_nodes.size()); }
+
+  /// @brief Hash de la geometría con la que se construyó (llave de la caché).
+  unsigned long long
+    getGeometryHash() const { return m_geometryHash; }
+
+  /**
+   * @brief Caja de toda la malla (la del nodo raíz).
+   * @return false si está vacía.
+   */
+  bool
+    getBounds(XMFLOAT3& minPoint, XMFLOAT3& maxPoint) const;
+
+  /**
+   * @brief Triángulo más cercano que toca el rayo.
+   */
+  bool
+    intersect(const BVHRay& ray, BVHHit& hit) const;
+
+  /**
+   * @brief ¿El rayo toca algún triángulo antes de `maxDistance`? (se detiene en el primero)
+   */
+  bool
+    occluded(const BVHRay& ray) const;
+
+  /// @brief Closest-hit de 4 rayos recorriendo el árbol juntos.
+  void
+    intersect4(const BVHRay rays[4], BVHHit hits[4]) const;
+
+  /// @brief Closest-hit de 8 rayos recorriendo el árbol juntos.
+  void
+    intersect8(const BVHRay rays[8], BVHHit hits[8]) const;
+
+  /// @brief Any-hit de 4 rayos.
+  void
+    occluded4(const BVHRay rays[4], bool occluded[4]) const;
+
+  /// @brief Any-hit de 8 rayos.
+  void
+    occluded8(const BVHRay rays[8], bool occluded[8]) const;
+
+  /**
+   * @brief Hash de la geometría de una malla (posiciones e índices).
+   */
+  static unsigned long long
+    hashGeometry(const XMFLOAT3* positions,
+                 size_t numVertices,
+                 size_t stride,
+                 const unsigned int* indices,
+                 size_t numIndices);
+
+  /**
+   * @brief Agrego los nodos y el orden de los triángulos (con el hash de la geometría) al final de `out`.
+   */
+  void
+    serialize(std::vector<unsigned char>& out) const;
+
+  /**
+   * @brief Rearmo la BVH de `mesh` desde lo que escribió `serialize`.
+   *
+   * @details
+   *  Los triángulos precalculados se rearman con los vértices de la malla (la sección solo
+   *  trae nodos y orden). Si la malla no coincide con su hash o los nodos se salen de rango
+   *  regreso false y no toco la BVH.
+   */
+  bool
+    deserialize(const MeshComponent& mesh, const unsigned char* data, size_t size);
+
+  /**
+   * @brief Benchmark headless: construcción, serialización y Mrays/s sobre un millón de triángulos.
+   *
+   * @details Verifica closest-hit y any-hit de rayos sueltos y paquetes contra fuerza bruta.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @struct Node
+   * @brief Nodo de 32 bytes: caja, y primer hijo o primer triángulo.
+   *
+   * @details
+   *  En una hoja `count` es el número de triángulos desde `first`. En un nodo interno
+   *  tiene `kInnerFlag` y el eje del corte; los hijos son `first` y `first + 1`.
+   */
+  struct
+    Node {
+    float minPoint[3];
+    unsigned int first;
+    float maxPoint[3];
+    unsigned int count;
+  };
+
+  /**
+   * @struct Triangle
+   * @brief Triángulo listo para Möller–Trumbore.
+   */
+  struct
+    Triangle {
+    float v0[3];
+    float e1[3];
+    float e2[3];
+  };
+
+  static const unsigned int kInnerFlag = 0x80000000u;
+
+  /// @brief Rearmo `m_triangles` en el orden de `m_order`.
+  void
+    buildTriangles(const XMFLOAT3* positions, size_t stride, const unsigned int* indices);
+
+  template<int Groups>
+  void
+    traversePacket(const BVHRay* rays, BVHHit* hits, bool* occluded, bool anyHit) const;
+
+  bool
+    traverse(const BVHRay& ray, BVHHit& hit, bool anyHit) const;
+
+  /// @brief Rayo contra todos los triángulos (referencia del benchmark).
+  bool
+    intersectReference(const BVHRay& ray, BVHHit& hit) const;
+
+private:
+  std::vector<Node> m_nodes;
+  std::vector<Triangle> m_triangles;
+  /// @brief Triángulo original de cada posición de `m_triangles`.
+  std::vector<unsigned int> m_order;
+  unsigned long long m_geometryHash = 0;
+};
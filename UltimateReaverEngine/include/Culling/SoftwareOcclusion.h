@@ -0,0 +1,285 @@
+/**
+ * @file SoftwareOcclusion.h
+ * @brief Aquí defino el culling por oclusión en CPU con un depth buffer pequeño.
+ *
+ * @details
+ *  Rasterizo unos cuantos occluders (cajas o mallas simplificadas que marco a mano) en
+ *  un depth buffer de baja resolución y luego pruebo los AABBs de los actores contra él
+ *  antes de mandarlos a dibujar. Cada frame:
+ *
+ *  1. **Setup:** paso los vértices a clip space con SSE, recorto contra el plano cercano,
+ *     descarto caras traseras y guardo las ecuaciones de arista y de profundidad.
+ *     Reparto los occluders entre los hilos del JobSystem.
+ *  2. **Binning:** meto cada triángulo en los tiles de pantalla que toca su caja.
+ *  3. **Raster:** cada hilo toma tiles completos (nadie escribe el mismo píxel) y
+ *     evalúa 4 píxeles a la vez con SSE, quedándose con la profundidad mínima.
+ *  4. **Jerarquía:** armo una pirámide donde cada texel guarda la profundidad *máxima*
+ *     de los 2x2 de abajo (lo más lejano que tapa esa zona).
+ *  5. **Pruebas:** proyecto las 8 esquinas del AABB (SSE), escojo el nivel en el que el
+ *     rectángulo cubre como mucho 4x4 texels y comparo la profundidad más cercana de la
+ *     caja contra el máximo de esos texels.
+ *
+ *  Uso la misma convención que D3D: profundidad de 0 (cerca) a 1 (lejos) y caras
+ *  frontales en sentido horario. Muestreo en el centro de cada píxel, así que un objeto
+ *  que se asoma menos de un píxel de baja resolución puede desaparecer; los occluders
+ *  deben ser un poco más chicos que su malla real.
+ *
+ *  No toca D3D, así que se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Frustum.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct OcclusionMesh
+ * @brief Geometría de un occluder en espacio local (solo posiciones e índices).
+ */
+struct
+  OcclusionMesh {
+  std::vector<XMFLOAT3> vertices;
+  std::vector<unsigned int> indices;
+};
+
+/**
+ * @struct OccluderInstance
+ * @brief Un occluder colocado en el mundo.
+ */
+struct
+  OccluderInstance {
+  const OcclusionMesh* mesh;
+  /// @brief Matriz de mundo (vectores fila, sin transponer).
+  XMFLOAT4X4 world;
+};
+
+/**
+ * @struct OcclusionBounds
+ * @brief Caja alineada a los ejes en mundo de algo que quiero probar.
+ */
+struct
+  OcclusionBounds {
+  XMFLOAT3 minPoint;
+  XMFLOAT3 maxPoint;
+};
+
+/**
+ * @struct SoftwareOcclusionSettings
+ * @brief Resolución del depth buffer y tamaño de los tiles de raster.
+ */
+struct
+  SoftwareOcclusionSettings {
+  unsigned int width = 256;
+  unsigned int height = 144;
+  /// @brief Ancho de tile; lo redondeo a múltiplo de 4 (un registro SSE).
+  unsigned int tileWidth = 32;
+  unsigned int tileHeight = 16;
+};
+
+/**
+ * @struct SoftwareOcclusionStats
+ * @brief Números del último frame.
+ */
+struct
+  SoftwareOcclusionStats {
+  unsigned int occluders = 0;
+  /// @brief Triángulos de entrada y los que sobrevivieron al recorte y backface.
+  unsigned int triangles = 0;
+  unsigned int rasterizedTriangles = 0;
+  /// @brief Suma de triángulos en todos los tiles (un triángulo grande cuenta varias veces).
+  unsigned int binnedTriangles = 0;
+  unsigned int tested = 0;
+  unsigned int frustumCulled = 0;
+  unsigned int occluded = 0;
+  double setupMs = 0.0;
+  double rasterMs = 0.0;
+  double hierarchyMs = 0.0;
+  double testMs = 0.0;
+};
+
+/**
+ * @class SoftwareOcclusion
+ * @brief Depth buffer de CPU con jerarquía para descartar objetos tapados.
+ */
+class
+  SoftwareOcclusion {
+public:
+  SoftwareOcclusion() = default;
+  ~SoftwareOcclusion() = default;
+
+  void
+    setSettings(const SoftwareOcclusionSettings& settings);
+
+  const SoftwareOcclusionSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Limpio el depth buffer y guardo la cámara del frame.
+   *
+   * @param viewProjection  view * projection (vectores fila, profundidad 0..1).
+   */
+  void
+    beginFrame(const XMFLOAT4X4& viewProjection);
+
+  /**
+   * @brief Rasterizo los occluders en paralelo y armo la jerarquía.
+   */
+  void
+    rasterize(const std::vector<OccluderInstance>& occluders);
+
+  /**
+   * @brief Igual que `rasterize` pero escalar y en un solo hilo, sin tiles.
+   *
+   * @details
+   *  Evalúa exactamente las mismas ecuaciones píxel por píxel, así que el resultado
+   *  tiene que ser idéntico bit a bit al de la versión SSE. Lo uso para verificar.
+   */
+  void
+    rasterizeReference(const std::vector<OccluderInstance>& occluders);
+
+  /**
+   * @brief Pruebo una caja contra el frustum y la jerarquía.
+   *
+   * @return true si hay que dibujarla.
+   */
+  bool
+    isVisible(const OcclusionBounds& bounds) const;
+
+  /**
+   * @brief Pruebo muchas cajas en paralelo y acumulo las stats del frame.
+   *
+   * @param visible  Sale con 1 (dibujar) o 0 (descartado) por caja.
+   */
+  void
+    testBounds(const std::vector<OcclusionBounds>& bounds, std::vector<uint8_t>& visible);
+
+  /**
+   * @brief Prueba exacta contra el depth buffer completo (sin jerarquía), escalar.
+   *
+   * @details
+   *  La jerarquía es conservadora: si `isVisible` dice que algo está tapado, esta prueba
+   *  también tiene que decirlo.
+   */
+  bool
+    isOccludedReference(const OcclusionBounds& bounds) const;
+
+  const std::vector<float>&
+    getDepth() const { return m_depth; }
+
+  /// @brief Separación entre filas de `getDepth()` (el ancho redondeado a 4).
+  unsigned int
+    getStride() const { return m_stride; }
+
+  const SoftwareOcclusionStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: una ciudad con calles y cámara a nivel de piso.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Triángulo listo para rasterizar en pantalla.
+   *
+   * @details
+   *  Las aristas son `A * x + B * y + C >= 0` dentro del triángulo y la profundidad es
+   *  el plano `zA * x + zB * y + zC`, evaluados en el centro de cada píxel.
+   */
+  struct
+    RasterTriangle {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float zA;
+    float zB;
+    float zC;
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+    bool valid;
+  };
+
+  /**
+   * @brief Paso un occluder a triángulos de pantalla (hasta 2 por triángulo tras recortar).
+   */
+  void
+    setupOccluder(const OccluderInstance& occluder,
+                  std::vector<XMFLOAT4>& clip,
+                  RasterTriangle* output) const;
+
+  /**
+   * @brief Recorto, proyecto y armo las ecuaciones de un triángulo en clip space.
+   *
+   * @return Número de triángulos escritos en `output` (0, 1 o 2).
+   */
+  unsigned int
+    setupTriangle(const XMFLOAT4& a, const XMFLOAT4& b, const XMFLOAT4& c, RasterTriangle* output) const;
+
+  /**
+   * @brief Setup de todos los occluders en paralelo (lo comparten ambos rasterizadores).
+   */
+  void
+    setupAll(const std::vector<OccluderInstance>& occluders);
+
+  /**
+   * @brief Rasterizo los triángulos de un tile con SSE.
+   */
+  void
+    rasterizeTile(unsigned int tile);
+
+  /**
+   * @brief Armo la pirámide de profundidad máxima a partir del nivel 0.
+   */
+  void
+    buildHierarchy();
+
+  /**
+   * @brief Resultado de probar una caja.
+   */
+  enum
+    OcclusionResult {
+    VISIBLE = 0,
+    OUTSIDE_FRUSTUM,
+    OCCLUDED
+  };
+
+  OcclusionResult
+    classify(const OcclusionBounds& bounds) const;
+
+  /**
+   * @brief Proyecto la caja y saco su rectángulo en píxeles y su profundidad más cercana.
+   *
+   * @return false si la caja cruza el plano cercano (no puedo decir nada: visible).
+   */
+  bool
+    projectBounds(const OcclusionBounds& bounds,
+                  int& minX, int& minY, int& maxX, int& maxY,
+                  float& minZ) const;
+
+private:
+  SoftwareOcclusionSettings m_settings;
+  unsigned int m_stride = 0;
+  unsigned int m_tilesX = 0;
+  unsigned int m_tilesY = 0;
+
+  XMFLOAT4X4 m_viewProjection;
+  Frustum m_frustum;
+
+  std::vector<float> m_depth;
+  /// @brief Niveles 1..N de la jerarquía, uno detrás de otro.
+  std::vector<float> m_hierarchy;
+  std::vector<unsigned int> m_levelOffset;
+  std::vector<unsigned int> m_levelWidth;
+  std::vector<unsigned int> m_levelHeight;
+
+  std::vector<RasterTriangle> m_triangles;
+  std::vector<unsigned int> m_triangleOffset;
+  std::vector<std::vector<unsigned int>> m_bins;
+  std::vector<uint8_t> m_results;
+
+  SoftwareOcclusionStats m_stats;
+};
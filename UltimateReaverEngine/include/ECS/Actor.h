@@ -17,6 +17,12 @@
 #include "Transform.h"
 #include "SamplerState.h"
 #include "ShaderProgram.h"
+#include "Shadows/CascadedShadows.h"
+#include "Culling/SoftwareOcclusion.h"
+#include "Collision/CollisionShapes.h"
+#include "Materials/MaterialSystem.h"
+#include "Lighting/LightmapBaker.h"
+#include "ECS/Prefab.h"
 
 class Device;
 class DeviceContext;
@@ -49,6 +55,18 @@ public:
    */
   Actor(Device& device);
 
+  /**
+   * @brief Constructor de instancia: nace con lo del prefab y no crea nada en GPU.
+   *
+   * @details
+   *  Solo el Transform es propio (con la posicin, rotacin y escala por default del
+   *  prefab); el nombre y las banderas salen de los defaults y se pueden cambiar. Las
+   *  mallas, texturas, sampler y CB de modelo son los del prefab hasta que la instancia
+   *  los sobreescriba. Se vale un prefab nulo y ponerlo despus con `setPrefab`.
+   */
+  explicit
+    Actor(const EU::TSharedPointer<Prefab>& prefab);
+
   /**
    * @brief Destructor virtual por default (importante por la herencia).
    */
@@ -89,6 +107,18 @@ public:
   void
     render(DeviceContext& deviceContext) override;
 
+  /**
+   * @brief Dibujo el actor en una vista relativa a la cmara.
+   *
+   * @param cameraOrigin Posicin de la cmara en mundo.
+   *
+   * @details
+   *  Subo la matriz de mundo con la posicin de la cmara restada (ver `ViewSystem`)
+   *  antes de dibujar, as el shader nunca recibe coordenadas grandes.
+   */
+  void
+    render(DeviceContext& deviceContext, const XMFLOAT3& cameraOrigin);
+
   /**
    * @brief Libero todos los recursos asociados al Actor.
    */
@@ -103,10 +133,41 @@ public:
    *
    * @details
    *  Aqu convierto cada MeshComponent en vertex/index buffers listos para la GPU.
+   *  En una instancia de prefab estas mallas pasan a ser propias (copy-on-write) y el
+   *  prefab no cambia; lo necesita, por ejemplo, un actor con skinning.
    */
   void
     setMesh(Device& device, std::vector<MeshComponent> meshes);
 
+  /**
+   * @brief Cambio el prefab del actor sin tocar lo que la instancia ya sobreescribi.
+   *
+   * @details
+   *  Las mallas y texturas propias (si las hay) siguen ganndole al prefab. El
+   *  `MeshComponent` del actor pasa a ser el compartido del prefab.
+   */
+  void
+    setPrefab(const EU::TSharedPointer<Prefab>& prefab);
+
+  const EU::TSharedPointer<Prefab>&
+    getPrefab() const { return m_prefab; }
+
+  /**
+   * @brief Bytes de CPU que son solo de este actor (sin contar lo compartido con el prefab).
+   */
+  size_t
+    getOwnedBytes() const;
+
+  /**
+   * @brief Suelto las mallas y sus buffers (el actor sigue existiendo, solo deja de dibujarse).
+   *
+   * @details
+   *  Lo uso cuando el streaming descarga la celda del actor. Las texturas solo las suelto
+   *  de la lista: son del dueo del recurso, no del actor. Tambin suelto el prefab.
+   */
+  void
+    clearMesh();
+
   /**
    * @brief Obtengo el nombre del actor.
    */
@@ -120,10 +181,27 @@ public:
     setName(const std::string& name) { m_name = name; }
 
   /**
-   * @brief Asigno manualmente las texturas de este actor.
+   * @brief Asigno manualmente las texturas de este actor (en una instancia le ganan a las del prefab).
    */
   void
-    setTextures(std::vector<Texture> textures) { m_textures = textures; }
+    setTextures(std::vector<Texture> textures) { m_textures = textures; m_ownTextures = true; }
+
+  /**
+   * @brief Le doy al actor su propio material (un ndice de `MaterialSystem`).
+   *
+   * @details El actor se queda con la referencia: la suelta al cambiarlo o en `destroy`.
+   *          Con `kInvalidMaterial` vuelvo al del prefab (o a las texturas sueltas).
+   */
+  void
+    setMaterial(unsigned int material);
+
+  /**
+   * @brief Material con el que dibujo: el propio, el del prefab o `kInvalidMaterial`.
+   *
+   * @details Si el actor tiene texturas propias (`setTextures`) no uso el del prefab.
+   */
+  unsigned int
+    getMaterial() const;
 
   /**
    * @brief Activo o desactivo la capacidad de generar sombras.
@@ -138,28 +216,159 @@ public:
     canCastShadow() const { return castShadow; }
 
   /**
-   * @brief Renderizo la forma de sombra del actor (shadow pass).
+   * @brief Marco el actor como esttico para las sombras (su capa se cachea).
    *
    * @details
-   *  Aqu uso el shader de sombras, los buffers y las matrices para dibujar
-   *  la silhouette del modelo en un mapa de sombras.
+   *  Si un actor esttico se mueve no pasa nada malo: `CascadedShadows` detecta el
+   *  cambio y redibuja la cach, solo que cuesta ms que si fuera dinmico.
    */
   void
-    renderShadow(DeviceContext& deviceContext);
+    setStaticShadow(bool v) { m_staticShadow = v; }
+
+  bool
+    isStaticShadow() const { return m_staticShadow; }
+
+  /**
+   * @brief Agrego un caster por cada malla del actor a la lista del shadow pass.
+   *
+   * @details
+   *  La esfera envolvente local se calcula en `setMesh`; aqu solo la paso a mundo
+   *  con el Transform actual. El dibujo lo hace `ShadowRenderer` en batches.
+   */
+  void
+    collectShadowCasters(std::vector<ShadowCaster>& casters);
+
+  /**
+   * @brief Marco el actor como occluder para el culling por oclusin en CPU.
+   *
+   * @details
+   *  Conviene usarlo solo en objetos grandes y simples (muros, edificios): todas sus
+   *  mallas se rasterizan en el depth buffer de `SoftwareOcclusion` cada frame.
+   */
+  void
+    setOccluder(bool v) { m_occluder = v; }
+
+  bool
+    isOccluder() const { return m_occluder; }
+
+  /**
+   * @brief Agrego la geometra de oclusin del actor con su matriz de mundo actual.
+   *
+   * @details
+   *  La malla de oclusin (solo posiciones e ndices) se arma la primera vez que se pide.
+   */
+  void
+    collectOccluders(std::vector<OccluderInstance>& occluders);
+
+  /**
+   * @brief Marco el actor como geometra esttica para el lightmap.
+   */
+  void
+    setLightmapped(bool v) { m_lightmapped = v; }
+
+  bool
+    isLightmapped() const { return m_lightmapped; }
+
+  /**
+   * @brief Agrego una instancia por malla para `LightmapBaker` con la matriz de mundo actual.
+   *
+   * @details El albedo es el BaseColor del material (blanco si no tiene). Los punteros
+   *          a las mallas valen mientras no cambien las mallas del actor o del prefab.
+   */
+  void
+    collectLightmapInstances(std::vector<LightmapInstance>& instances);
+
+  /**
+   * @brief Caja en mundo de todas las mallas del actor.
+   *
+   * @return false si el actor no tiene mallas.
+   */
+  bool
+    getWorldBounds(OcclusionBounds& bounds);
+
+  /**
+   * @brief Collider ajustado a la caja local de las mallas.
+   *
+   * @details
+   *  Cajas: la misma caja local. Esfera: la que envuelve la caja. Cpsula: parada sobre
+   *  Y con el radio de la mitad ms ancha en XZ.
+   *
+   * @return false si el actor no tiene mallas.
+   */
+  bool
+    getCollider(ShapeType type, ColliderDesc& desc) const;
+
+  /**
+   * @brief Matriz de mundo actual del Transform (convencin fila).
+   */
+  void
+    getWorldMatrix(XMFLOAT4X4& world);
+
+  /**
+   * @brief Rayo en mundo contra los tringulos de las mallas (con la BVH de cada una).
+   *
+   * @details
+   *  Paso el rayo a espacio local sin normalizar la direccin, as la distancia sale en
+   *  las mismas unidades que en mundo. Las mallas con skinning se prueban en bind pose.
+   *
+   * @param distance   Distancia al impacto ms cercano.
+   * @param meshIndex  Malla que toc.
+   * @return false si no toc nada o ninguna malla tiene BVH.
+   */
+  bool
+    raycastMeshes(const XMFLOAT3& origin,
+                  const XMFLOAT3& direction,
+                  float maxDistance,
+                  float& distance,
+                  int& meshIndex);
+
+  /**
+   * @brief Alguna malla tiene BVH de tringulos?
+   */
+  bool
+    hasTriangleBVH() const;
+
+  /**
+   * @brief Nombre de una de las mallas del actor.
+   */
+  const std::string&
+    getMeshName(int meshIndex) const;
 
 private:
 
-  /// @brief Lista de mallas del actor.
-  std::vector<MeshComponent> m_meshes;
+  /// @brief Mallas con las que dibujo: las propias o las del prefab.
+  MeshRenderData&
+    meshData();
+
+  const MeshRenderData&
+    meshData() const;
+
+  /// @brief Texturas con las que dibujo: las propias o las del prefab.
+  std::vector<Texture>&
+    textures();
+
+private:
+
+  /// @brief Prefab del que sale el actor (nulo si es un actor suelto).
+  EU::TSharedPointer<Prefab> m_prefab;
+
+  /// @brief Mallas propias con sus buffers, sombras, cajas y malla de oclusin.
+  MeshRenderData m_meshData;
 
   /// @brief Texturas asignadas al actor (una o varias).
   std::vector<Texture> m_textures;
 
-  /// @brief Vertex buffers internos, uno por mesh.
-  std::vector<Buffer> m_vertexBuffers;
+  /// @brief Si es true, `m_meshData` le gana a las mallas del prefab.
+  bool m_ownMesh = false;
 
-  /// @brief Index buffers internos, uno por mesh.
-  std::vector<Buffer> m_indexBuffers;
+  /// @brief Si es true, `m_textures` le gana a las texturas del prefab.
+  bool m_ownTextures = false;
+
+  /// @brief Material propio en `MaterialSystem` (kInvalidMaterial = el del prefab).
+  unsigned int m_material = kInvalidMaterial;
+
+  /// @brief Si es true (instancia), uso el sampler y el CB de modelo del prefab.
+  bool m_sharedState = false;
 
   /// @brief Sampler para leer texturas (filtrado, wrapping, etc.).
   SamplerState m_sampler;
@@ -170,21 +379,17 @@ private:
   /// @brief Buffer en GPU para la info del modelo.
   Buffer m_modelBuffer;
 
-  // --------------------------------------------------------------------
-  // Shaders y buffers para el pass de sombras
-  // --------------------------------------------------------------------
-
-  /// @brief Shader especial para el pass de sombras.
-  ShaderProgram m_shaderShadow;
+  /// @brief Si es true, `m_modelBuffer` tiene la matriz relativa a la cmara de la ltima vista.
+  bool m_cbRelative = false;
 
-  /// @brief Buffer de shader (usado para constantes del shadow pass).
-  Buffer m_shaderBuffer;
+  /// @brief Si es true, sus casters van a la capa esttica cacheada.
+  bool m_staticShadow = false;
 
-  /// @brief Datos de transformacin para el pass de sombras.
-  CBChangesEveryFrame m_cbShadow;
+  /// @brief Si es true, el actor tapa a otros en el culling por oclusin.
+  bool m_occluder = false;
 
-  /// @brief Posicin de la luz (la uso para generar sombras).
-  XMFLOAT4 m_LightPos;
+  /// @brief Si es true, sus mallas entran al horneado del lightmap.
+  bool m_lightmapped = false;
 
   /// @brief Nombre del actor (para debug e inspector).
   std::string m_name = "Actor";
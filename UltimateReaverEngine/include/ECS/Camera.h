@@ -0,0 +1,103 @@
+/**
+ * @file Camera.h
+ * @brief Aquí defino el componente Camera: una vista de la escena desde su actor.
+ *
+ * @details
+ *  La cámara no guarda matrices: las calcula con el Transform de su actor (posición y
+ *  rotación pitch/yaw/roll, sin escala) cada vez que el `ViewSystem` arma las vistas del
+ *  frame. Su rectángulo de viewport es normalizado (0..1) respecto al render target, así
+ *  pantalla dividida, viewports del editor y picture-in-picture son solo rectángulos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/Component.h"
+#include "ECS/Transform.h"
+#include "ViewSystem.h"
+
+class DeviceContext;
+
+/**
+ * @class Camera
+ * @brief Componente de cámara con proyección en perspectiva y viewport normalizado.
+ */
+class
+  Camera : public Component {
+public:
+  Camera() : Component(ComponentType::CAMERA) {}
+
+  virtual
+    ~Camera() = default;
+
+  void
+    init() override {}
+
+  void
+    update(float deltaTime) override {}
+
+  void
+    render(DeviceContext& deviceContext) override {}
+
+  void
+    destroy() override {}
+
+  /**
+   * @brief Apunto un Transform desde `eye` hacia `target` (con +Y arriba y sin roll).
+   */
+  static void
+    lookAt(Transform& transform, const EU::Vector3& eye, const EU::Vector3& target);
+
+  /**
+   * @brief Armo la vista de esta cámara para un render target de `targetWidth` x `targetHeight`.
+   */
+  RenderView
+    computeView(const Transform& transform, unsigned int targetWidth, unsigned int targetHeight) const;
+
+  void
+    setPerspective(float fovY, float nearPlane, float farPlane) {
+    m_fovY = fovY;
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+  }
+
+  /**
+   * @brief Rectángulo del viewport, normalizado (0..1) respecto al render target.
+   */
+  void
+    setViewportRect(float x, float y, float width, float height) {
+    m_rect[0] = x;
+    m_rect[1] = y;
+    m_rect[2] = width;
+    m_rect[3] = height;
+  }
+
+  /**
+   * @brief Dibujo con la cámara en el origen (para mundos grandes, ver `ViewSystem`).
+   */
+  void
+    setCameraRelative(bool cameraRelative) { m_cameraRelative = cameraRelative; }
+
+  void
+    setEnabled(bool enabled) { m_enabled = enabled; }
+
+  bool
+    isEnabled() const { return m_enabled; }
+
+  float
+    getFovY() const { return m_fovY; }
+
+  float
+    getNearPlane() const { return m_nearPlane; }
+
+  float
+    getFarPlane() const { return m_farPlane; }
+
+private:
+  float m_fovY = XM_PIDIV4;
+  float m_nearPlane = 0.01f;
+  float m_farPlane = 100.0f;
+  /// @brief x, y, ancho y alto normalizados.
+  float m_rect[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+  bool m_cameraRelative = false;
+  bool m_enabled = true;
+};
@@ -0,0 +1,217 @@
+/**
+ * @file Prefab.h
+ * @brief Aquí defino los prefabs: una plantilla inmutable que comparten muchos actores.
+ *
+ * @details
+ *  Un actor normal (`Actor(Device&)`) crea su propio constant buffer y sampler, y guarda
+ *  su copia de las mallas con sus vertex/index buffers. Para miles de actores iguales eso
+ *  es mucho tiempo de creación y mucha memoria repetida.
+ *
+ *  Un prefab guarda una sola vez lo que es igual para todos:
+ *  - Las mallas, sus vertex/index buffers, la geometría de sombras y las cajas locales.
+ *  - Las texturas (son del dueño del recurso, el prefab no las destruye) y el material
+ *    que las agrupa en `MaterialSystem`.
+ *  - Un sampler y un constant buffer de modelo compartidos: cada instancia sube su matriz
+ *    justo antes de dibujarse, así no hay un buffer por actor.
+ *  - Los componentes por default que no cambian por instancia (el `MeshComponent`).
+ *  - Valores por default del Transform y de las banderas.
+ *
+ *  Las instancias (`Actor(prefab)`) solo guardan lo que sobreescriben: su Transform, su
+ *  nombre y, si hace falta, sus propias mallas o texturas (copy-on-write en
+ *  `Actor::setMesh` / `Actor::setTextures`).
+ *
+ *  Sin dispositivo (`init(nullptr, ...)`) solo armo la parte de CPU, así se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "GeometryPool.h"
+#include "Texture.h"
+#include "SamplerState.h"
+#include "Materials/MaterialSystem.h"
+#include "MeshComponent.h"
+#include "Shadows/CascadedShadows.h"
+#include "Culling/SoftwareOcclusion.h"
+#include <cfloat>
+
+class Device;
+class BenchmarkReport;
+
+/**
+ * @struct MeshRenderData
+ * @brief Mallas con sus buffers de GPU y todo lo que se deriva de ellas (sombras, cajas, oclusión).
+ *
+ * @details
+ *  La usan igual un actor (sus propias mallas) y un prefab (las compartidas).
+ *  Con el `GeometryPool` listo, cada malla es un rango del pool (`geometry`); las mallas
+ *  con skinning (que se reescriben cada frame) tienen sus propios buffers.
+ *  `shadowGeometry` apunta a `vertexBuffers`/`indexBuffers`, así que no la copio después
+ *  de armarla.
+ */
+struct
+  MeshRenderData {
+  std::vector<MeshComponent> meshes;
+  std::vector<Buffer> vertexBuffers;
+  std::vector<Buffer> indexBuffers;
+  /// @brief Rango de cada malla en el `GeometryPool` (vacío si tiene buffers propios).
+  std::vector<GeometryHandle> geometry;
+  /// @brief Geometría de cada mesh para el shadow pass (solo si hay buffers).
+  std::vector<ShadowGeometry> shadowGeometry;
+  /// @brief Esfera envolvente local de cada mesh (x, y, z, radio).
+  std::vector<XMFLOAT4> shadowBounds;
+  /// @brief Caja local de todas las mallas.
+  OcclusionBounds localBounds = { XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX), XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX) };
+  /// @brief Posiciones e índices de todas las mallas juntas (se arma la primera vez que se pide).
+  OcclusionMesh occlusionMesh;
+
+  /**
+   * @brief Copio las mallas, creo sus buffers y calculo cajas y esferas.
+   *
+   * @param device Si es nullptr (o no tiene dispositivo D3D) solo armo la parte de CPU.
+   */
+  void
+    build(Device* device, const std::vector<MeshComponent>& source);
+
+  /**
+   * @brief Libero los buffers (o los rangos del pool) y dejo todo vacío.
+   */
+  void
+    clear();
+
+  /**
+   * @brief Malla de oclusión (la armo la primera vez).
+   */
+  const OcclusionMesh&
+    getOcclusionMesh();
+
+  /// @brief Cada malla tiene su rango del pool o su par de buffers.
+  bool
+    hasGPUGeometry() const {
+    return !meshes.empty() &&
+           (geometry.size() == meshes.size() ||
+            (vertexBuffers.size() == meshes.size() && indexBuffers.size() == meshes.size()));
+  }
+
+  bool
+    hasBounds() const { return !meshes.empty() && localBounds.minPoint.x <= localBounds.maxPoint.x; }
+};
+
+/**
+ * @struct PrefabDefaults
+ * @brief Valores con los que nace cada instancia (luego la instancia los puede cambiar).
+ */
+struct
+  PrefabDefaults {
+  EU::Vector3 position;
+  EU::Vector3 rotation;
+  EU::Vector3 scale = EU::Vector3(1.0f, 1.0f, 1.0f);
+  bool castShadow = true;
+  bool staticShadow = false;
+  bool occluder = false;
+};
+
+/**
+ * @class Prefab
+ * @brief Plantilla compartida de actores: mallas, texturas, sampler, CB de modelo y componentes por default.
+ *
+ * @details
+ *  Se comparte con `EU::TSharedPointer<Prefab>`; después de `init` no cambia (salvo la
+ *  malla de oclusión, que se arma la primera vez que alguien la pide).
+ */
+class
+  Prefab {
+public:
+  Prefab() = default;
+  ~Prefab() { destroy(); }
+
+  Prefab(const Prefab&) = delete;
+  Prefab&
+    operator=(const Prefab&) = delete;
+
+  /**
+   * @brief Armo la plantilla.
+   *
+   * @param device    Dispositivo para los buffers y el sampler (nullptr = solo CPU).
+   * @param name      Nombre por default de las instancias.
+   * @param meshes    Mallas del modelo (las copio una sola vez).
+   * @param textures  Texturas (no las destruyo en `destroy`).
+   * @param meshBuffers Si es false no creo buffers para las mallas (solo la parte de CPU);
+   *                    lo uso con modelos con skinning, donde cada instancia pone los suyos.
+   */
+  HRESULT
+    init(Device* device,
+         const std::string& name,
+         const std::vector<MeshComponent>& meshes,
+         const std::vector<Texture>& textures,
+         bool meshBuffers = true);
+
+  /**
+   * @brief Libero los buffers de GPU y suelto las mallas y texturas.
+   */
+  void
+    destroy();
+
+  bool
+    isReady() const { return m_ready; }
+
+  const std::string&
+    getName() const { return m_name; }
+
+  void
+    setDefaults(const PrefabDefaults& defaults) { m_defaults = defaults; }
+
+  const PrefabDefaults&
+    getDefaults() const { return m_defaults; }
+
+  MeshRenderData&
+    getMeshData() { return m_meshData; }
+
+  std::vector<Texture>&
+    getTextures() { return m_textures; }
+
+  /**
+   * @brief Material de las instancias; el prefab se queda con la referencia y la suelta en `destroy`.
+   */
+  void
+    setMaterial(unsigned int material);
+
+  unsigned int
+    getMaterial() const { return m_material; }
+
+  SamplerState&
+    getSampler() { return m_sampler; }
+
+  /// @brief CB de modelo compartido: cada instancia lo actualiza antes de dibujarse.
+  Buffer&
+    getModelBuffer() { return m_modelBuffer; }
+
+  /// @brief Componente de malla que comparten todas las instancias.
+  const EU::TSharedPointer<MeshComponent>&
+    getMeshComponent() const { return m_meshComponent; }
+
+  /// @brief Objetos de GPU que tiene el prefab (buffers, sampler y CB).
+  unsigned int
+    getNumGPUObjects() const;
+
+  /**
+   * @brief Benchmark headless: 10k instancias contra 10k actores sueltos.
+   *
+   * @details Reporto actores por segundo, bytes por instancia y objetos de GPU evitados,
+   *          y verifico que las instancias vean los datos del prefab y que las
+   *          sobreescrituras no lo toquen.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  std::string m_name;
+  MeshRenderData m_meshData;
+  std::vector<Texture> m_textures;
+  unsigned int m_material = kInvalidMaterial;
+  SamplerState m_sampler;
+  Buffer m_modelBuffer;
+  EU::TSharedPointer<MeshComponent> m_meshComponent = EU::MakeShared<MeshComponent>();
+  PrefabDefaults m_defaults;
+  bool m_ready = false;
+};
@@ -64,10 +64,29 @@ public:
    *  2. Rotacin
    *  3. Translacin
    *  y al final las multiplico para obtener la World Matrix completa.
+   *
+   *  Si la simulacin corre a paso fijo (`beginStep`), mezclo el estado del paso anterior
+   *  con el actual segn `alpha`: lerp en posicin y escala, slerp en la rotacin.
    */
   void
     update(float deltaTime) override {
 
+    if (m_hasPrevious && m_alpha < 1.0f) {
+      XMVECTOR previousRotation = XMQuaternionRotationRollPitchYaw(m_previousRotation.x,
+        m_previousRotation.y,
+        m_previousRotation.z);
+      XMVECTOR currentRotation = XMQuaternionRotationRollPitchYaw(rotation.x,
+        rotation.y,
+        rotation.z);
+      EU::Vector3 s = m_previousScale + (scale - m_previousScale) * m_alpha;
+      EU::Vector3 p = m_previousPosition + (position - m_previousPosition) * m_alpha;
+
+      matrix = XMMatrixScaling(s.x, s.y, s.z) *
+        XMMatrixRotationQuaternion(XMQuaternionSlerp(previousRotation, currentRotation, m_alpha)) *
+        XMMatrixTranslation(p.x, p.y, p.z);
+      return;
+    }
+
     XMMATRIX scaleMatrix = XMMatrixScaling(scale.x,
       scale.y,
       scale.z);
@@ -145,6 +164,23 @@ public:
   void
     translate(const EU::Vector3& translation);
 
+  /**
+   * @brief Inicio de un paso fijo: el estado actual pasa a ser el anterior.
+   */
+  void
+    beginStep() {
+    m_previousPosition = position;
+    m_previousRotation = rotation;
+    m_previousScale = scale;
+    m_hasPrevious = true;
+  }
+
+  /**
+   * @brief Fraccin entre el paso anterior y el actual que se dibuja (1 = el actual).
+   */
+  void
+    setInterpolation(float alpha) { m_alpha = alpha; }
+
 private:
 
   /// @brief Posicin del objeto en el mundo.
@@ -156,6 +192,13 @@ private:
   /// @brief Escala del objeto.
   EU::Vector3 scale;
 
+  /// @brief Estado del paso fijo anterior (para interpolar al dibujar).
+  EU::Vector3 m_previousPosition;
+  EU::Vector3 m_previousRotation;
+  EU::Vector3 m_previousScale;
+  bool m_hasPrevious = false;
+  float m_alpha = 1.0f;
+
 public:
 
   /// @brief Matriz final (World Matrix) lista para enviar al shader.
@@ -0,0 +1,562 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class BenchmarkReport;
+
+namespace EU {
+  /**
+   * @brief Mutex que no hace nada, para la variante de un solo hilo.
+   */
+  struct NullMutex {
+    void lock() {}
+    void unlock() {}
+  };
+
+  /**
+   * @brief Un bloque asignado: su offset (en bytes) y el nodo que lo describe.
+   *
+   * Hay que guardarlo completo para liberarlo en O(1).
+   */
+  struct TLSFAllocation {
+    uint64_t offset = ~0ull;
+    uint32_t block = ~0u;
+
+    bool
+      isValid() const { return block != ~0u; }
+  };
+
+  /**
+   * @brief Ocupación y fragmentación del asignador (en bytes).
+   */
+  struct TLSFStats {
+    uint64_t capacity = 0;
+    uint64_t used = 0;
+    uint64_t free = 0;
+    uint64_t largestFreeBlock = 0;
+    uint32_t allocations = 0;
+    uint32_t freeBlocks = 0;
+    /// 1 - bloque libre más grande / espacio libre (0 = todo lo libre está junto).
+    float fragmentation = 0.0f;
+  };
+
+  /**
+   * @brief Asignador TLSF (two-level segregated fit): asignar y liberar en O(1).
+   *
+   * Los bloques libres se guardan en listas por tamaño en dos niveles: el primero es la
+   * potencia de dos y el segundo divide cada potencia en 16 rangos. Dos bitmaps dicen qué
+   * listas tienen bloques, así que encontrar uno que sirva son dos búsquedas de bits.
+   * Al liberar, el bloque se une con sus vecinos físicos si están libres.
+   *
+   * Los metadatos viven fuera de la memoria administrada, así que sirve para dos cosas:
+   * - **Rangos abstractos** (`init(capacity, granularity)`): solo reparte offsets, por
+   *   ejemplo dentro de un buffer o un heap de GPU que el CPU no puede leer.
+   * - **Memoria real** (`init(memory, bytes)`): `allocateMemory` regresa punteros dentro
+   *   del bloque de memoria, alineados a 16 bytes.
+   *
+   * @tparam MutexType `NullMutex` para un solo hilo o `std::mutex` para compartirlo entre hilos.
+   */
+  template<typename MutexType = NullMutex>
+  class TLSFAllocator {
+  public:
+    TLSFAllocator() = default;
+    ~TLSFAllocator() = default;
+
+    TLSFAllocator(const TLSFAllocator&) = delete;
+    TLSFAllocator&
+      operator=(const TLSFAllocator&) = delete;
+
+    /**
+     * @brief Empiezo a repartir offsets en `[0, capacity)`.
+     *
+     * @param capacity    Bytes (o elementos) a administrar.
+     * @param granularity Unidad mínima; todo tamaño y offset es múltiplo de ella (potencia de dos).
+     */
+    void
+      init(uint64_t capacity, uint64_t granularity = 16) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      reset(capacity, granularity);
+      m_memory = nullptr;
+    }
+
+    /**
+     * @brief Administro un bloque de memoria real (no me adueño de él).
+     */
+    void
+      init(void* memory, size_t bytes) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      // El inicio se alinea a 16 y lo que sobra al final no se usa
+      uintptr_t start = (reinterpret_cast<uintptr_t>(memory) + kHeaderSize - 1) & ~(uintptr_t)(kHeaderSize - 1);
+      size_t skipped = static_cast<size_t>(start - reinterpret_cast<uintptr_t>(memory));
+      reset(bytes > skipped ? bytes - skipped : 0, kHeaderSize);
+      m_memory = reinterpret_cast<unsigned char*>(start);
+    }
+
+    /**
+     * @brief Asigno `size` bytes con el offset alineado a `alignment` (0 = la granularidad).
+     *
+     * @return Asignación inválida si `size` es 0 o no hay un bloque libre suficiente.
+     */
+    TLSFAllocation
+      allocate(uint64_t size, uint64_t alignment = 0) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      return allocateUnlocked(size, alignment);
+    }
+
+    /**
+     * @brief Libero una asignación y la uno con sus vecinos libres.
+     *
+     * @return false si la asignación no es válida o ya estaba libre.
+     */
+    bool
+      free(const TLSFAllocation& allocation) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      return freeUnlocked(allocation);
+    }
+
+    /**
+     * @brief Asigno memoria real (solo después de `init(memory, bytes)`).
+     *
+     * Guardo el nodo en 16 bytes antes del puntero para liberar en O(1).
+     */
+    void*
+      allocateMemory(size_t size) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      if (!m_memory || size == 0) {
+        return nullptr;
+      }
+      TLSFAllocation allocation = allocateUnlocked(size + kHeaderSize, 0);
+      if (!allocation.isValid()) {
+        return nullptr;
+      }
+      unsigned char* header = m_memory + allocation.offset;
+      *reinterpret_cast<uint32_t*>(header) = allocation.block;
+      return header + kHeaderSize;
+    }
+
+    /**
+     * @brief Libero memoria de `allocateMemory`. nullptr no hace nada.
+     */
+    void
+      freeMemory(void* pointer) {
+      if (!pointer) {
+        return;
+      }
+      std::lock_guard<MutexType> lock(m_mutex);
+      unsigned char* header = static_cast<unsigned char*>(pointer) - kHeaderSize;
+      TLSFAllocation allocation;
+      allocation.offset = static_cast<uint64_t>(header - m_memory);
+      allocation.block = *reinterpret_cast<const uint32_t*>(header);
+      freeUnlocked(allocation);
+    }
+
+    uint64_t
+      getCapacity() const { return m_capacity * m_granularity; }
+
+    uint64_t
+      getUsed() const { return m_used * m_granularity; }
+
+    uint64_t
+      getGranularity() const { return m_granularity; }
+
+    TLSFStats
+      getStats() {
+      std::lock_guard<MutexType> lock(m_mutex);
+      TLSFStats stats;
+      stats.capacity = m_capacity * m_granularity;
+      stats.used = m_used * m_granularity;
+      stats.free = stats.capacity - stats.used;
+      stats.allocations = m_numAllocations;
+      stats.freeBlocks = m_numFreeBlocks;
+      // El bloque más grande está en la lista no vacía más alta
+      if (m_flBitmap) {
+        uint32_t fl = findLastSet(m_flBitmap);
+        uint32_t sl = findLastSet(m_slBitmap[fl]);
+        for (uint32_t b = m_heads[fl][sl]; b != kNone; b = m_blocks[b].nextFree) {
+          stats.largestFreeBlock = (std::max)(stats.largestFreeBlock, m_blocks[b].size * m_granularity);
+        }
+      }
+      stats.fragmentation = stats.free > 0 ? 1.0f - static_cast<float>(stats.largestFreeBlock) / stats.free : 0.0f;
+      return stats;
+    }
+
+    /**
+     * @brief Recorro las asignaciones en orden de offset: `func(const TLSFAllocation&, uint64_t size)`.
+     *
+     * Sirve para compactar: ver qué se mueve a dónde.
+     */
+    template<typename Func>
+    void
+      forEachAllocation(Func func) {
+      std::lock_guard<MutexType> lock(m_mutex);
+      for (uint32_t b = m_blocks.empty() ? kNone : 0; b != kNone; b = m_blocks[b].nextPhysical) {
+        const Block& block = m_blocks[b];
+        if (!block.isFree) {
+          TLSFAllocation allocation;
+          allocation.offset = block.offset * m_granularity;
+          allocation.block = b;
+          func(allocation, block.size * m_granularity);
+        }
+      }
+    }
+
+    /**
+     * @brief Benchmark del asignador (ver `Benchmarks`).
+     *
+     * Solo está definido para `TLSFAllocatorST`, en `TLSFAllocator.cpp`; mide también la
+     * variante con candado.
+     */
+    static void
+      runBenchmark(BenchmarkReport& report);
+
+  private:
+    static const uint32_t kNone = ~0u;
+    static const uint32_t kSLLog2 = 4;
+    static const uint32_t kSLCount = 1u << kSLLog2;
+    static const uint32_t kFLCount = 64 - kSLLog2 + 1;
+    static const size_t kHeaderSize = 16;
+
+    /**
+     * @brief Nodo de un bloque (libre o asignado); tamaño y offset en unidades de granularidad.
+     */
+    struct Block {
+      uint64_t offset = 0;
+      uint64_t size = 0;
+      uint32_t prevPhysical = kNone;
+      uint32_t nextPhysical = kNone;
+      uint32_t prevFree = kNone;
+      uint32_t nextFree = kNone;
+      bool isFree = false;
+      bool inUse = false;
+    };
+
+    static uint32_t
+      findFirstSet(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+      unsigned long index;
+      _BitScanForward64(&index, value);
+      return index;
+#elif defined(_MSC_VER)
+      // Win32: dos búsquedas de 32 bits
+      unsigned long index;
+      if (_BitScanForward(&index, static_cast<unsigned long>(value))) {
+        return index;
+      }
+      _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+      return index + 32;
+#else
+      return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    static uint32_t
+      findLastSet(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return index;
+#elif defined(_MSC_VER)
+      unsigned long index;
+      if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) {
+        return index + 32;
+      }
+      _BitScanReverse(&index, static_cast<unsigned long>(value));
+      return index;
+#else
+      return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    /**
+     * @brief Lista a la que pertenece un bloque de `size` unidades.
+     */
+    static void
+      mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+      if (size < kSLCount) {
+        fl = 0;
+        sl = static_cast<uint32_t>(size);
+      }
+      else {
+        uint32_t last = findLastSet(size);
+        fl = last - kSLLog2 + 1;
+        sl = static_cast<uint32_t>(size >> (last - kSLLog2)) ^ kSLCount;
+      }
+    }
+
+    /**
+     * @brief Primera lista donde cualquier bloque sirve para `size` (redondeo hacia arriba).
+     */
+    static void
+      mappingSearch(uint64_t size, uint32_t& fl, uint32_t& sl) {
+      if (size >= kSLCount) {
+        size += (1ull << (findLastSet(size) - kSLLog2)) - 1;
+      }
+      mapping(size, fl, sl);
+    }
+
+    void
+      reset(uint64_t capacity, uint64_t granularity) {
+      m_granularity = granularity > 0 ? granularity : 1;
+      m_capacity = capacity / m_granularity;
+      m_used = 0;
+      m_numAllocations = 0;
+      m_numFreeBlocks = 0;
+      m_flBitmap = 0;
+      for (uint32_t fl = 0; fl < kFLCount; ++fl) {
+        m_slBitmap[fl] = 0;
+        for (uint32_t sl = 0; sl < kSLCount; ++sl) {
+          m_heads[fl][sl] = kNone;
+        }
+      }
+      m_blocks.clear();
+      m_freeNodes.clear();
+      if (m_capacity > 0) {
+        // El nodo 0 siempre es el primer bloque físico (al unir, sobrevive el de la izquierda)
+        uint32_t first = newNode();
+        m_blocks[first].offset = 0;
+        m_blocks[first].size = m_capacity;
+        insertFree(first);
+      }
+    }
+
+    uint32_t
+      newNode() {
+      uint32_t index;
+      if (m_freeNodes.empty()) {
+        index = static_cast<uint32_t>(m_blocks.size());
+        m_blocks.push_back(Block());
+      }
+      else {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_blocks[index] = Block();
+      }
+      m_blocks[index].inUse = true;
+      return index;
+    }
+
+    void
+      releaseNode(uint32_t index) {
+      m_blocks[index].inUse = false;
+      m_freeNodes.push_back(index);
+    }
+
+    void
+      insertFree(uint32_t index) {
+      Block& block = m_blocks[index];
+      uint32_t fl, sl;
+      mapping(block.size, fl, sl);
+      block.isFree = true;
+      block.prevFree = kNone;
+      block.nextFree = m_heads[fl][sl];
+      if (block.nextFree != kNone) {
+        m_blocks[block.nextFree].prevFree = index;
+      }
+      m_heads[fl][sl] = index;
+      m_flBitmap |= 1ull << fl;
+      m_slBitmap[fl] |= 1u << sl;
+      ++m_numFreeBlocks;
+    }
+
+    void
+      removeFree(uint32_t index) {
+      Block& block = m_blocks[index];
+      uint32_t fl, sl;
+      mapping(block.size, fl, sl);
+      if (block.prevFree != kNone) {
+        m_blocks[block.prevFree].nextFree = block.nextFree;
+      }
+      else {
+        m_heads[fl][sl] = block.nextFree;
+        if (block.nextFree == kNone) {
+          m_slBitmap[fl] &= ~(1u << sl);
+          if (!m_slBitmap[fl]) {
+            m_flBitmap &= ~(1ull << fl);
+          }
+        }
+      }
+      if (block.nextFree != kNone) {
+        m_blocks[block.nextFree].prevFree = block.prevFree;
+      }
+      block.isFree = false;
+      block.prevFree = kNone;
+      block.nextFree = kNone;
+      --m_numFreeBlocks;
+    }
+
+    /**
+     * @brief Parto `index` en `[0, size)` (se queda en `index`) y el resto (nodo nuevo, regresado).
+     */
+    uint32_t
+      split(uint32_t index, uint64_t size) {
+      uint32_t rest = newNode();
+      Block& block = m_blocks[index];
+      Block& tail = m_blocks[rest];
+      tail.offset = block.offset + size;
+      tail.size = block.size - size;
+      tail.prevPhysical = index;
+      tail.nextPhysical = block.nextPhysical;
+      if (block.nextPhysical != kNone) {
+        m_blocks[block.nextPhysical].prevPhysical = rest;
+      }
+      block.nextPhysical = rest;
+      block.size = size;
+      return rest;
+    }
+
+    /**
+     * @brief Uno `right` dentro de su vecino izquierdo `left` (ninguno está en las listas libres).
+     */
+    void
+      absorb(uint32_t left, uint32_t right) {
+      Block& block = m_blocks[left];
+      Block& next = m_blocks[right];
+      block.size += next.size;
+      block.nextPhysical = next.nextPhysical;
+      if (next.nextPhysical != kNone) {
+        m_blocks[next.nextPhysical].prevPhysical = left;
+      }
+      releaseNode(right);
+    }
+
+    TLSFAllocation
+      allocateUnlocked(uint64_t size, uint64_t alignment) {
+      TLSFAllocation allocation;
+      if (size == 0 || m_capacity == 0) {
+        return allocation;
+      }
+      uint64_t units = (size + m_granularity - 1) / m_granularity;
+      uint64_t alignUnits = alignment > m_granularity ? (alignment + m_granularity - 1) / m_granularity : 1;
+      // Con alineación pido de más para que quepa el relleno del inicio
+      uint64_t request = units + alignUnits - 1;
+      if (request > m_capacity) {
+        return allocation;
+      }
+
+      uint32_t fl, sl;
+      mappingSearch(request, fl, sl);
+      if (fl >= kFLCount) {
+        return allocation;
+      }
+      uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+      if (!slMap) {
+        uint64_t flMap = fl + 1 < 64 ? m_flBitmap & (~0ull << (fl + 1)) : 0;
+        if (!flMap) {
+          return allocation;
+        }
+        fl = findFirstSet(flMap);
+        slMap = m_slBitmap[fl];
+      }
+      sl = findFirstSet(slMap);
+      uint32_t index = m_heads[fl][sl];
+      removeFree(index);
+
+      // El relleno de alineación se queda libre a la izquierda
+      uint64_t offset = m_blocks[index].offset;
+      uint64_t aligned = (offset + alignUnits - 1) / alignUnits * alignUnits;
+      if (aligned > offset) {
+        uint32_t rest = split(index, aligned - offset);
+        insertFree(index);
+        index = rest;
+      }
+      if (m_blocks[index].size > units) {
+        uint32_t rest = split(index, units);
+        insertFree(rest);
+      }
+
+      m_blocks[index].isFree = false;
+      m_used += units;
+      ++m_numAllocations;
+      allocation.offset = m_blocks[index].offset * m_granularity;
+      allocation.block = index;
+      return allocation;
+    }
+
+    bool
+      freeUnlocked(const TLSFAllocation& allocation) {
+      uint32_t index = allocation.block;
+      if (!allocation.isValid() || index >= m_blocks.size()) {
+        return false;
+      }
+      Block& block = m_blocks[index];
+      if (!block.inUse || block.isFree || block.offset * m_granularity != allocation.offset) {
+        return false;
+      }
+      m_used -= block.size;
+      --m_numAllocations;
+
+      uint32_t next = block.nextPhysical;
+      if (next != kNone && m_blocks[next].isFree) {
+        removeFree(next);
+        absorb(index, next);
+      }
+      uint32_t prev = m_blocks[index].prevPhysical;
+      if (prev != kNone && m_blocks[prev].isFree) {
+        removeFree(prev);
+        absorb(prev, index);
+        index = prev;
+      }
+      insertFree(index);
+      return true;
+    }
+
+  private:
+    MutexType m_mutex;
+    unsigned char* m_memory = nullptr;
+    uint64_t m_granularity = 1;
+    /// Todo en unidades de granularidad.
+    uint64_t m_capacity = 0;
+    uint64_t m_used = 0;
+    uint32_t m_numAllocations = 0;
+    uint32_t m_numFreeBlocks = 0;
+    uint64_t m_flBitmap = 0;
+    uint32_t m_slBitmap[kFLCount] = {};
+    uint32_t m_heads[kFLCount][kSLCount] = {};
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_freeNodes;
+  };
+
+  /// Variante para un solo hilo (sin candados).
+  using TLSFAllocatorST = TLSFAllocator<NullMutex>;
+
+  /// Variante segura entre hilos (un `std::mutex` por asignador).
+  using TLSFAllocatorMT = TLSFAllocator<std::mutex>;
+
+  template<>
+  void
+    TLSFAllocator<NullMutex>::runBenchmark(BenchmarkReport& report);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file FrameProfiler.h
+ * @brief Aquí mido cuánto CPU se lleva cada sección del frame (update, render, UI...).
+ *
+ * @details
+ *  Cada sección junta los milisegundos que se le midieron durante el frame; al empezar el
+ *  siguiente (`beginFrame`) los guardo en un historial circular y calculo el promedio y el
+ *  máximo de los últimos `kHistory` frames. Lo uso desde el hilo principal: las secciones
+ *  que corren en el `JobSystem` se miden desde quien las lanza.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Timer.h"
+
+/**
+ * @struct ProfilerSection
+ * @brief Tiempos de una sección del frame.
+ */
+struct
+  ProfilerSection {
+  static const unsigned int kHistory = 120;
+
+  std::string name;
+  /// @brief Lo que se lleva medido en el frame actual.
+  double currentMs = 0.0;
+  /// @brief Total del último frame completo.
+  double lastMs = 0.0;
+  double averageMs = 0.0;
+  double maxMs = 0.0;
+  double history[kHistory] = {};
+};
+
+/**
+ * @class FrameProfiler
+ * @brief Profiler de CPU por frame del motor (instancia global).
+ */
+class
+  FrameProfiler {
+public:
+  FrameProfiler() = default;
+  ~FrameProfiler() = default;
+
+  FrameProfiler(const FrameProfiler&) = delete;
+  FrameProfiler&
+    operator=(const FrameProfiler&) = delete;
+
+  static FrameProfiler&
+    getInstance() {
+    static FrameProfiler instance;
+    return instance;
+  }
+
+  /**
+   * @class Scope
+   * @brief Mide el tiempo desde que se construye hasta que se destruye y lo suma a una sección.
+   */
+  class
+    Scope {
+  public:
+    explicit Scope(const char* section, FrameProfiler& profiler = FrameProfiler::getInstance())
+      : m_profiler(profiler), m_section(section) {}
+
+    ~Scope() { m_profiler.addSample(m_section, m_timer.elapsedMs()); }
+
+    Scope(const Scope&) = delete;
+    Scope&
+      operator=(const Scope&) = delete;
+
+  private:
+    FrameProfiler& m_profiler;
+    const char* m_section;
+    Timer m_timer;
+  };
+
+  /**
+   * @brief Cierro el frame anterior: paso lo medido al historial de cada sección.
+   */
+  void
+    beginFrame();
+
+  /**
+   * @brief Sumo `ms` a la sección (la creo la primera vez que aparece).
+   */
+  void
+    addSample(const char* section, double ms);
+
+  /**
+   * @brief La sección con ese nombre, o nullptr si nunca se midió.
+   */
+  const ProfilerSection*
+    getSection(const char* section) const;
+
+  const std::vector<ProfilerSection>&
+    getSections() const { return m_sections; }
+
+  /// @brief Frames cerrados desde que arrancó el profiler.
+  unsigned long long
+    getFrameCount() const { return m_frames; }
+
+private:
+  std::vector<ProfilerSection> m_sections;
+  unsigned long long m_frames = 0;
+};
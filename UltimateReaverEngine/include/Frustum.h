@@ -0,0 +1,93 @@
+/**
+ * @file Frustum.h
+ * @brief Aquí defino el Frustum de la cámara para pruebas de visibilidad en CPU.
+ *
+ * @details
+ *  Extraigo los 6 planos directamente de la matriz view * projection (método de
+ *  Gribb/Hartmann). Uso la convención de XNA Math: vectores fila (`clip = v * M`)
+ *  y profundidad de 0 a 1 como en D3D.
+ *
+ *  Solo usa floats, así que funciona igual dentro de los benchmarks headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cmath>
+
+ /**
+  * @class Frustum
+  * @brief Seis planos (normal hacia adentro) para descartar esferas y AABBs.
+  */
+class
+  Frustum {
+public:
+  Frustum() = default;
+
+  /**
+   * @brief Construyo los planos a partir de view * projection.
+   */
+  explicit
+    Frustum(const XMFLOAT4X4& viewProjection) { setViewProjection(viewProjection); }
+
+  /**
+   * @brief Recalculo los planos a partir de view * projection.
+   */
+  void
+    setViewProjection(const XMFLOAT4X4& m) {
+    // Con vectores fila, cada componente de clip es el producto con una columna de M
+    for (int i = 0; i < 4; ++i) {
+      float c0 = m.m[i][0], c1 = m.m[i][1], c2 = m.m[i][2], c3 = m.m[i][3];
+      m_planes[0][i] = c3 + c0; // izquierda
+      m_planes[1][i] = c3 - c0; // derecha
+      m_planes[2][i] = c3 + c1; // abajo
+      m_planes[3][i] = c3 - c1; // arriba
+      m_planes[4][i] = c2;      // cerca (z >= 0)
+      m_planes[5][i] = c3 - c2; // lejos
+    }
+    for (auto& plane : m_planes) {
+      float len = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+      float inv = len > 0.0f ? 1.0f / len : 0.0f;
+      for (float& v : plane) {
+        v *= inv;
+      }
+    }
+  }
+
+  /**
+   * @brief ¿La esfera toca el frustum?
+   */
+  bool
+    intersectsSphere(float x, float y, float z, float radius) const {
+    for (const auto& p : m_planes) {
+      if (p[0] * x + p[1] * y + p[2] * z + p[3] < -radius) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief ¿La caja alineada a los ejes toca el frustum? (prueba del vértice positivo)
+   */
+  bool
+    intersectsAabb(const float minPoint[3], const float maxPoint[3]) const {
+    for (const auto& p : m_planes) {
+      float x = p[0] >= 0.0f ? maxPoint[0] : minPoint[0];
+      float y = p[1] >= 0.0f ? maxPoint[1] : minPoint[1];
+      float z = p[2] >= 0.0f ? maxPoint[2] : minPoint[2];
+      if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Plano `index` como (nx, ny, nz, d).
+   */
+  const float*
+    getPlane(int index) const { return m_planes[index]; }
+
+private:
+  float m_planes[6][4] = {};
+};
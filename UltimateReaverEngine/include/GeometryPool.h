@@ -0,0 +1,411 @@
+/**
+ * @file GeometryPool.h
+ * @brief Aquí defino el pool de geometría: muchas mallas repartidas en pocos vertex/index buffers grandes.
+ *
+ * @details
+ *  Antes cada sub-mesh tenía su vertex buffer y su index buffer, así que un modelo de 200
+ *  partes eran 400 buffers en GPU y 400 cambios del Input Assembler por dibujo.
+ *
+ *  Con el pool:
+ *  - **Páginas:** un vertex buffer y un index buffer grandes. Cada malla ocupa un rango
+ *    de vértices y uno de índices dentro de una página; si no cabe en ninguna, abro otra.
+ *  - **Asignador:** `GeometryAllocator` reparte los rangos con un TLSF (`EU::TLSFAllocator`),
+ *    que asigna y libera en O(1) y junta los huecos vecinos al liberar. No toca D3D, así
+ *    que se prueba headless con sus estadísticas de fragmentación.
+ *  - **Dibujo:** los índices de la malla siguen siendo locales; se dibuja con
+ *    `DrawIndexed(count, startIndex, baseVertex)` y los buffers de la página se vinculan
+ *    una vez para todas las mallas que viven en ella. El pool recuerda la página vinculada
+ *    durante todo el pass, así dos actores seguidos en la misma página no la repiten.
+ *  - **Desfragmentación:** compacto los rangos vivos al inicio de la página copiando en
+ *    GPU (`CopySubresourceRegion`) a buffers nuevos. Por eso nadie guarda offsets: se
+ *    guarda un `GeometryHandle` y se resuelve al dibujar.
+ *
+ *  - **Formato de índices:** cada página es de índices de 16 o de 32 bits y una malla va a
+ *    una página de su formato (`MeshIndexing::chooseFormat`); el formato se devuelve en el
+ *    `GeometryRange` para el draw.
+ *  - **Subida:** escribo los vértices y los índices (ya angostados a 16 bits si la página es
+ *    de 16) directo a la memoria mapeada de un staging buffer y de ahí copio a la página en
+ *    GPU (`CopySubresourceRegion`), sin arreglos temporales. Los staging buffers son un
+ *    anillo: mapeo con `D3D11_MAP_FLAG_DO_NOT_WAIT` y, si la GPU todavía copia desde ese,
+ *    paso al siguiente; solo espero si todo el anillo está ocupado.
+ *
+ *  Las mallas con skinning se reescriben cada frame y se quedan con sus buffers propios.
+ *  El pool usa el contexto inmediato para subir los datos: se usa desde el hilo principal.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "EngineUtilities/Memory/TLSFAllocator.h"
+
+class Device;
+class DeviceContext;
+class BenchmarkReport;
+
+/// @brief Vértices por página si no se pide otra cosa (12 MB con `SimpleVertex`).
+const unsigned int kGeometryPageVertices = 262144;
+
+/// @brief Índices por página si no se pide otra cosa (3 MB con 32 bits, 1.5 MB con 16).
+const unsigned int kGeometryPageIndices = 786432;
+
+/// @brief Tamaño mínimo de cada staging buffer de subida (crece con la malla más grande).
+const unsigned int kGeometryStagingBytes = 4 * 1024 * 1024;
+
+/// @brief Staging buffers en el anillo de subida.
+const unsigned int kGeometryStagingSlots = 4;
+
+/**
+ * @struct GeometryAllocatorStats
+ * @brief Ocupación y fragmentación de un asignador (en elementos, no en bytes).
+ */
+struct
+  GeometryAllocatorStats {
+  unsigned int capacity = 0;
+  unsigned int used = 0;
+  unsigned int free = 0;
+  unsigned int allocations = 0;
+  unsigned int freeBlocks = 0;
+  unsigned int largestFreeBlock = 0;
+  /// @brief 1 - hueco más grande / espacio libre (0 = todo lo libre está junto).
+  float fragmentation = 0.0f;
+};
+
+/**
+ * @struct GeometryMove
+ * @brief Un rango que la compactación movió de `from` a `to`.
+ */
+struct
+  GeometryMove {
+  unsigned int from;
+  unsigned int to;
+  unsigned int size;
+};
+
+/**
+ * @class GeometryAllocator
+ * @brief Reparte rangos de `[0, capacity)` con un TLSF y une huecos vecinos al liberar.
+ *
+ * @details Los rangos se identifican por su offset, que es lo que guarda el pool.
+ */
+class
+  GeometryAllocator {
+public:
+  GeometryAllocator() = default;
+  ~GeometryAllocator() = default;
+
+  /**
+   * @brief Empiezo con todo libre (olvido lo asignado).
+   */
+  void
+    init(unsigned int capacity);
+
+  /**
+   * @brief Tomo el inicio de un hueco donde quepa `size` (good-fit del TLSF).
+   *
+   * @return false si `size` es 0 o no hay hueco suficiente.
+   */
+  bool
+    allocate(unsigned int size, unsigned int& offset);
+
+  /**
+   * @brief Libero el rango que empieza en `offset` y lo junto con los huecos vecinos.
+   *
+   * @return false si en `offset` no empieza ningún rango asignado.
+   */
+  bool
+    free(unsigned int offset);
+
+  /**
+   * @brief Muevo todos los rangos al inicio (en orden) y dejo un solo hueco al final.
+   *
+   * @param moves Todos los rangos vivos con su offset viejo y el nuevo (también los que no se movieron).
+   */
+  void
+    compact(std::vector<GeometryMove>& moves);
+
+  unsigned int
+    getCapacity() const { return static_cast<unsigned int>(m_tlsf.getCapacity()); }
+
+  unsigned int
+    getUsed() const { return static_cast<unsigned int>(m_tlsf.getUsed()); }
+
+  GeometryAllocatorStats
+    getStats();
+
+private:
+  /// @brief En elementos (granularidad 1); el pool se usa desde un solo hilo.
+  EU::TLSFAllocatorST m_tlsf;
+  /// @brief Rangos asignados: offset -> asignación del TLSF.
+  std::unordered_map<unsigned int, EU::TLSFAllocation> m_allocations;
+};
+
+/**
+ * @struct GeometryHandle
+ * @brief Identifica una malla dentro del pool (sigue siendo válido después de desfragmentar).
+ */
+struct
+  GeometryHandle {
+  unsigned int index = 0xFFFFFFFF;
+  unsigned int generation = 0;
+
+  bool
+    isValid() const { return index != 0xFFFFFFFF; }
+};
+
+/**
+ * @struct GeometryRange
+ * @brief Dónde está una malla ahora: buffers de su página y offsets para el draw.
+ */
+struct
+  GeometryRange {
+  unsigned int page = 0;
+  Buffer* vertexBuffer = nullptr;
+  Buffer* indexBuffer = nullptr;
+  DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+  int baseVertex = 0;
+  unsigned int startIndex = 0;
+  unsigned int indexCount = 0;
+};
+
+/**
+ * @struct GeometryPoolStats
+ * @brief Números del pool completo.
+ */
+struct
+  GeometryPoolStats {
+  unsigned int pages = 0;
+  /// @brief Páginas con índices de 16 bits.
+  unsigned int pages16 = 0;
+  unsigned int meshes = 0;
+  GeometryAllocatorStats vertices;
+  GeometryAllocatorStats indices;
+  /// @brief Veces que se vincularon los buffers de una página.
+  unsigned long long binds = 0;
+  /// @brief Binds que me salté porque la página ya estaba vinculada.
+  unsigned long long bindsSkipped = 0;
+  unsigned int defragmentations = 0;
+  unsigned long long movedBytes = 0;
+  /// @brief Subidas que tuvieron que esperar a la GPU porque todo el anillo de staging estaba ocupado.
+  unsigned long long stagingStalls = 0;
+  /// @brief Bytes de índices de las mallas vivas y lo que ahorran los de 16 bits contra 32.
+  unsigned long long indexBytes = 0;
+  unsigned long long indexBytesSaved = 0;
+};
+
+/**
+ * @class GeometryPool
+ * @brief Páginas de vertex/index buffers compartidos de las que se asignan las mallas.
+ *
+ * @details
+ *  El motor usa la instancia global (`getInstance`), que `BaseApp` inicializa con el
+ *  device y el contexto inmediato. Sin device las páginas no tienen buffers: así se
+ *  prueba el reparto headless.
+ */
+class
+  GeometryPool {
+public:
+  GeometryPool() = default;
+  ~GeometryPool() { destroy(); }
+
+  GeometryPool(const GeometryPool&) = delete;
+  GeometryPool&
+    operator=(const GeometryPool&) = delete;
+
+  static GeometryPool&
+    getInstance() {
+    static GeometryPool instance;
+    return instance;
+  }
+
+  /**
+   * @param device          Crea los buffers de las páginas (nullptr = sin GPU).
+   * @param deviceContext   Sube los datos y copia al desfragmentar (nullptr = sin GPU).
+   * @param pageVertices    Vértices por página.
+   * @param pageIndices     Índices por página.
+   */
+  void
+    init(Device* device,
+         DeviceContext* deviceContext,
+         unsigned int pageVertices = kGeometryPageVertices,
+         unsigned int pageIndices = kGeometryPageIndices);
+
+  /**
+   * @brief Libero las páginas. Los handles que sigan vivos quedan inválidos.
+   */
+  void
+    destroy();
+
+  bool
+    isReady() const { return m_ready; }
+
+  /**
+   * @brief Le doy a la malla un rango de vértices y uno de índices y subo sus datos.
+   *
+   * @details Solo la pongo en páginas de su formato de índices. Si no cabe en ninguna abro
+   *          otra (del tamaño de la malla si es más grande que una página normal).
+   */
+  GeometryHandle
+    allocate(const MeshComponent& mesh);
+
+  /**
+   * @brief Devuelvo los rangos de la malla. Un handle inválido o viejo no hace nada.
+   */
+  void
+    free(GeometryHandle& handle);
+
+  /**
+   * @brief Dónde está la malla ahora.
+   *
+   * @return false si el handle no es de una malla viva.
+   */
+  bool
+    resolve(const GeometryHandle& handle, GeometryRange& range);
+
+  /**
+   * @brief Vinculo el vertex y el index buffer de una página al Input Assembler si no es la que ya está.
+   *
+   * @return true si hubo que vincular.
+   */
+  bool
+    bind(DeviceContext& deviceContext, unsigned int page);
+
+  /**
+   * @brief Empiezo un pass: olvido la página vinculada (el pass anterior pudo cambiar el IA).
+   */
+  void
+    beginPass() { m_boundPage = 0xFFFFFFFF; }
+
+  /**
+   * @brief Alguien vinculó otros buffers al IA: el próximo `bind` no se salta.
+   */
+  void
+    invalidateBinding() { m_boundPage = 0xFFFFFFFF; }
+
+  /**
+   * @brief Lo mismo que `bind` sin tocar D3D (para contar binds en los benchmarks).
+   */
+  bool
+    track(unsigned int page);
+
+  /**
+   * @brief Compacto la página más fragmentada si pasa de `minFragmentation`.
+   *
+   * @return Elementos (vértices + índices) que se movieron.
+   */
+  unsigned int
+    defragment(float minFragmentation = 0.5f);
+
+  unsigned int
+    getNumPages() const { return static_cast<unsigned int>(m_pages.size()); }
+
+  GeometryPoolStats
+    getStats();
+
+  /**
+   * @brief Benchmark headless: reparto, fragmentación y desfragmentación del pool.
+   *
+   * @details Reporto mallas por segundo, binds contra buffers sueltos y fragmentación antes
+   *          y después de compactar, y verifico que ningún rango se encime.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @struct Page
+   * @brief Un vertex buffer y un index buffer grandes con sus asignadores.
+   */
+  struct
+    Page {
+    Buffer vertexBuffer;
+    Buffer indexBuffer;
+    GeometryAllocator vertices;
+    GeometryAllocator indices;
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+  };
+
+  /**
+   * @struct Allocation
+   * @brief Rangos de una malla viva.
+   */
+  struct
+    Allocation {
+    unsigned int page = 0;
+    unsigned int vertexOffset = 0;
+    unsigned int vertexCount = 0;
+    unsigned int indexOffset = 0;
+    unsigned int indexCount = 0;
+    unsigned int generation = 0;
+    bool live = false;
+  };
+
+  bool
+    allocateIn(Page& page, unsigned int vertexCount, unsigned int indexCount, Allocation& allocation);
+
+  /**
+   * @struct StagingSlot
+   * @brief Un staging buffer del anillo de subida.
+   */
+  struct
+    StagingSlot {
+    ID3D11Buffer* buffer = nullptr;
+    unsigned int bytes = 0;
+  };
+
+  /**
+   * @brief Subo los datos de la malla a sus rangos de la página a través del anillo de staging.
+   */
+  HRESULT
+    upload(Page& page, const Allocation& allocation, const MeshComponent& mesh);
+
+  /**
+   * @brief Mapeo para escritura un staging buffer del anillo que la GPU ya no esté usando.
+   *
+   * @param bytes   Bytes que necesita la subida.
+   * @param mapped  Memoria mapeada.
+   * @param staging Buffer mapeado (hay que hacerle `Unmap`).
+   */
+  HRESULT
+    mapStaging(unsigned int bytes, D3D11_MAPPED_SUBRESOURCE& mapped, ID3D11Buffer*& staging);
+
+  /**
+   * @brief Me aseguro de que el staging buffer de `slot` tenga al menos `bytes`.
+   */
+  HRESULT
+    reserveStaging(StagingSlot& slot, unsigned int bytes);
+
+  HRESULT
+    createPageBuffers(unsigned int vertexCapacity,
+                      unsigned int indexCapacity,
+                      DXGI_FORMAT indexFormat,
+                      Buffer& vertexBuffer,
+                      Buffer& indexBuffer);
+
+  float
+    getFragmentation(Page& page);
+
+private:
+  Device* m_device = nullptr;
+  DeviceContext* m_deviceContext = nullptr;
+  unsigned int m_pageVertices = kGeometryPageVertices;
+  unsigned int m_pageIndices = kGeometryPageIndices;
+  /// @brief Por puntero: los asignadores no se copian.
+  std::vector<EU::TUniquePtr<Page>> m_pages;
+  /// @brief Anillo de staging buffers (escritura de CPU) por el que pasan las subidas.
+  StagingSlot m_staging[kGeometryStagingSlots];
+  /// @brief Siguiente slot del anillo (el que se usó hace más tiempo).
+  unsigned int m_stagingSlot = 0;
+  unsigned long long m_stagingStalls = 0;
+  std::vector<Allocation> m_allocations;
+  std::vector<unsigned int> m_freeAllocations;
+  unsigned int m_numMeshes = 0;
+  unsigned long long m_binds = 0;
+  unsigned long long m_bindsSkipped = 0;
+  /// @brief Página cuyos buffers están en el IA (0xFFFFFFFF = ninguna que yo sepa).
+  unsigned int m_boundPage = 0xFFFFFFFF;
+  unsigned int m_defragmentations = 0;
+  unsigned long long m_movedBytes = 0;
+  unsigned long long m_indexBytes = 0;
+  unsigned long long m_indexBytesSaved = 0;
+  bool m_ready = false;
+};
@@ -0,0 +1,151 @@
+/**
+ * @file GltfImporter.h
+ * @brief Aquí importo glTF 2.0 (`.gltf` y `.glb`) sin el SDK de FBX.
+ *
+ * @details
+ *  El FBX SDK es pesado, tarda en inicializar y solo existe para Windows. glTF ya guarda la
+ *  geometría como arreglos binarios listos para la GPU, así que el importador casi no hace
+ *  trabajo:
+ *  - **Sin copias:** mapeo el archivo (y los `.bin` externos) y leo los accessors directo de
+ *    la memoria mapeada como arreglos con stride; el JSON se parsea en su lugar (los strings
+ *    y números son rangos del texto) y solo se copia lo que va a la malla.
+ *  - **Escena:** recorro los nodos de la escena, horneo su transformación a los vértices y
+ *    cada primitiva de cada instancia es un `GltfMesh`.
+ *  - **En paralelo:** las primitivas se convierten en jobs (una por job); las que no traen
+ *    normales o tangentes pasan por `generateTangents` en el mismo job.
+ *
+ *  Como con FBX, conservo las coordenadas del archivo e invierto el winding para Direct3D.
+ *  Solo importo geometría estática: skins, morph targets y animaciones se ignoran.
+ *
+ *  El importador no incluye nada del motor (ni Win32 en este header): entrega `GltfMesh` con
+ *  vértices y índices planos y `Model3D` los pasa a `MeshComponent`. Lo que necesita del
+ *  motor (repartir trabajo en hilos y generar tangentes) se lo pasan en `GltfImportSettings`.
+ *  Compila igual en Windows y en Linux (mapeo de archivos Win32 o POSIX).
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+class BenchmarkReport;
+
+struct
+  GltfFloat2 {
+  float x, y;
+};
+
+struct
+  GltfFloat3 {
+  float x, y, z;
+};
+
+struct
+  GltfFloat4 {
+  float x, y, z, w;
+};
+
+/**
+ * @struct GltfVertex
+ * @brief Vértice importado (mismo layout que `SimpleVertex`, así la conversión es una copia).
+ */
+struct
+  GltfVertex {
+  GltfFloat3 position;
+  GltfFloat2 texcoord;
+  GltfFloat3 normal;
+  /// @brief `w` es el handedness de la bitangente (+1 o -1).
+  GltfFloat4 tangent;
+};
+
+/**
+ * @struct GltfMesh
+ * @brief Una primitiva de una instancia de nodo: transformación horneada y winding de Direct3D.
+ */
+struct
+  GltfMesh {
+  std::string name;
+  std::vector<GltfVertex> vertices;
+  std::vector<unsigned int> indices;
+};
+
+/**
+ * @struct GltfImportSettings
+ * @brief Lo que el motor le presta al importador (sin nada corre en un hilo y no genera tangentes).
+ */
+struct
+  GltfImportSettings {
+  /// @brief Corre `body` sobre rangos [begin, end) de `count` primitivas (el motor usa su `JobSystem`).
+  std::function<void(size_t count, const std::function<void(size_t begin, size_t end)>& body)> parallelFor;
+
+  /**
+   * @brief Normales que falten y tangentes de una primitiva que no las trae.
+   *
+   * @details Se llama dentro del job, en el espacio y el winding del archivo (lo que espera un
+   *          normal map horneado), antes de hornear la transformación del nodo.
+   */
+  std::function<void(GltfMesh& mesh)> generateTangents;
+};
+
+/**
+ * @struct GltfImportStats
+ * @brief Qué salió de una importación.
+ */
+struct
+  GltfImportStats {
+  /// @brief Bytes mapeados (el archivo y sus buffers externos).
+  size_t fileBytes = 0;
+  unsigned int nodes = 0;
+  unsigned int primitives = 0;
+  unsigned int vertices = 0;
+  unsigned int triangles = 0;
+  /// @brief Primitivas sin tangentes en el archivo (pasaron por `generateTangents`).
+  unsigned int generatedTangents = 0;
+  /// @brief Primitivas que no son listas de triángulos (las ignoro).
+  unsigned int skippedPrimitives = 0;
+  /// @brief Por qué falló la importación (vacío si salió bien).
+  std::string error;
+};
+
+/**
+ * @class GltfImporter
+ * @brief Importador nativo de glTF 2.0 / GLB a mallas planas.
+ */
+class
+  GltfImporter {
+public:
+  /**
+   * @brief Importo la escena por defecto del archivo.
+   *
+   * @param meshes    Recibe una malla por primitiva de cada nodo (se agregan al final).
+   * @param textures  Recibe la textura base color de cada material usado (sin repetir).
+   * @return false si el archivo no existe, está truncado o un accessor se sale de su buffer
+   *         (el motivo queda en `stats->error`); en ese caso no toco las listas.
+   */
+  static bool
+    load(const std::string& path,
+         std::vector<GltfMesh>& meshes,
+         std::vector<std::string>& textures,
+         const GltfImportSettings& settings = GltfImportSettings(),
+         GltfImportStats* stats = nullptr);
+
+  /**
+   * @brief Escribo las mallas como un `.glb` (un nodo y una primitiva por malla).
+   *
+   * @details Deshago la inversión de winding de `load`, así que importar el archivo devuelve
+   *          las mismas mallas.
+   */
+  static bool
+    writeGlb(const std::string& path, const std::vector<GltfMesh>& meshes);
+
+  /**
+   * @brief Benchmark headless: MB/s y triángulos/s importando un `.glb` generado.
+   *
+   * @details Verifico que la importación reproduzca exactamente lo escrito, que las
+   *          transformaciones de nodos y los accessors con stride se lean bien y que un
+   *          archivo truncado se rechace.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+};
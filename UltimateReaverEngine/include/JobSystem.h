@@ -0,0 +1,137 @@
+/**
+ * @file JobSystem.h
+ * @brief Aquí defino el JobSystem, un pool de hilos sencillo para repartir trabajo de CPU.
+ *
+ * @details
+ *  Lo uso para los sistemas que procesan muchos datos por frame (skinning, culling,
+ *  partículas, etc.). La idea es no crear hilos cada frame, sino tener unos workers
+ *  dormidos que despiertan cuando les mando un `parallelFor`.
+ *
+ *  El hilo que llama también trabaja, así que con N workers uso N + 1 núcleos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+ /**
+  * @class JobSystem
+  * @brief Pool de hilos persistente con un `parallelFor` por rangos.
+  *
+  * @details
+  *  - Solo corre un `parallelFor` a la vez. Si otro hilo (o un job anidado) llama mientras
+  *    el pool está ocupado, el trabajo se ejecuta en línea en ese hilo, así nunca hay deadlock.
+  *  - El rango se parte en bloques de `grainSize` elementos y los hilos los van tomando
+  *    con un contador atómico (balanceo dinámico).
+  */
+class
+  JobSystem {
+public:
+
+  /**
+   * @brief Firma del trabajo: recibe el rango [begin, end) que le tocó al hilo.
+   */
+  using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+  JobSystem() = default;
+
+  /**
+   * @brief Al destruir me aseguro de apagar los workers.
+   */
+  ~JobSystem() { destroy(); }
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /**
+   * @brief Instancia global (igual que el ResourceManager).
+   *
+   * @details
+   *  Si nadie llamó a `init()`, la primera vez que se usa se inicializa solo
+   *  con `hardware_concurrency() - 1` workers.
+   */
+  static JobSystem&
+    getInstance() {
+    static JobSystem instance;
+    return instance;
+  }
+
+  /**
+   * @brief Levanto los workers.
+   *
+   * @param numWorkers Número de hilos extra; 0 = usar `hardware_concurrency() - 1`.
+   */
+  void
+    init(unsigned int numWorkers = 0);
+
+  /**
+   * @brief Apago y junto todos los workers.
+   */
+  void
+    destroy();
+
+  /**
+   * @brief Ejecuto `job` sobre [0, count) repartido entre los hilos.
+   *
+   * @param count      Número total de elementos.
+   * @param grainSize  Elementos por bloque (mínimo 1).
+   * @param job        Función que procesa un rango.
+   *
+   * @details
+   *  Regresa hasta que todos los bloques terminaron.
+   */
+  void
+    parallelFor(size_t count, size_t grainSize, const RangeJob& job);
+
+  /**
+   * @brief Número de workers (sin contar el hilo que llama).
+   */
+  unsigned int
+    getNumWorkers() const { return static_cast<unsigned int>(m_workers.size()); }
+
+  /**
+   * @brief Número total de hilos que participan en un `parallelFor`.
+   */
+  unsigned int
+    getNumThreads() const { return getNumWorkers() + 1; }
+
+private:
+  /**
+   * @brief Loop de cada worker: duerme hasta que hay trabajo nuevo.
+   */
+  void
+    workerLoop();
+
+  /**
+   * @brief Toma bloques del trabajo actual hasta que se acaban.
+   */
+  void
+    runChunks();
+
+private:
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeCondition;
+  std::condition_variable m_doneCondition;
+
+  /// @brief Serializa los parallelFor de nivel superior.
+  std::mutex m_dispatchMutex;
+
+  /// @brief Trabajo actual (válido mientras hay un parallelFor en curso).
+  const RangeJob* m_job = nullptr;
+  size_t m_count = 0;
+  size_t m_grainSize = 1;
+  size_t m_numChunks = 0;
+
+  std::atomic<size_t> m_nextChunk{ 0 };
+
+  /// @brief Se incrementa por cada trabajo nuevo para despertar a los workers.
+  uint64_t m_generation = 0;
+  unsigned int m_activeWorkers = 0;
+  bool m_stop = false;
+  bool m_initialized = false;
+};
@@ -0,0 +1,242 @@
+/**
+ * @file ClusteredLighting.h
+ * @brief Aquí defino el constructor de listas de luces por cluster (clustered forward).
+ *
+ * @details
+ *  Parto el frustum de la cámara en una rejilla 3D: `tilesX x tilesY` tiles en pantalla
+ *  y `slicesZ` rebanadas de profundidad exponenciales. Cada frame:
+ *
+ *  1. Paso las luces a espacio de vista y calculo qué rebanadas toca cada esfera.
+ *  2. Reparto las rebanadas entre los hilos del JobSystem. Cada hilo prueba las esferas
+ *     contra los AABBs de sus clusters con SSE, 4 columnas a la vez.
+ *  3. Compacto el resultado en un arreglo `(offset, count)` por cluster más una lista
+ *     plana de índices, que es lo que se sube a la GPU una sola vez por frame.
+ *
+ *  Como el AABB de un cluster en espacio de vista es el producto de un rango en X
+ *  (depende solo de la columna), uno en Y (solo de la fila) y uno en Z (solo de la
+ *  rebanada), la distancia esfera-AABB se separa en `dx² + dy² + dz²` y casi todo el
+ *  trabajo se reduce a sumar y comparar vectores.
+ *
+ *  No toca D3D: la subida a GPU está en `LightClusterBuffers`, así que esto se puede
+ *  probar headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Lighting/Light.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct ClusterGridSettings
+ * @brief Resolución de la rejilla de clusters.
+ */
+struct
+  ClusterGridSettings {
+  unsigned int tilesX = 16;
+  unsigned int tilesY = 9;
+  unsigned int slicesZ = 24;
+  /// @brief Máximo de luces por cluster; las que sobran se descartan y se cuentan.
+  unsigned int maxLightsPerCluster = 128;
+};
+
+/**
+ * @struct ClusterRange
+ * @brief Rango de la lista de índices que le toca a un cluster (8 bytes, `uint2` en HLSL).
+ */
+struct
+  ClusterRange {
+  unsigned int offset;
+  unsigned int count;
+};
+
+/**
+ * @struct ClusteredLightingStats
+ * @brief Números del último `build`.
+ */
+struct
+  ClusteredLightingStats {
+  unsigned int lights = 0;
+  /// @brief Luces que tocaron al menos una rebanada del frustum.
+  unsigned int visibleLights = 0;
+  unsigned int indices = 0;
+  unsigned int maxPerCluster = 0;
+  unsigned int overflowClusters = 0;
+  double prepareMs = 0.0;
+  double assignMs = 0.0;
+  double compactMs = 0.0;
+  double timeMs = 0.0;
+};
+
+/**
+ * @class ClusteredLighting
+ * @brief Asigna luces a clusters del frustum y produce listas compactas para el shader.
+ */
+class
+  ClusteredLighting {
+public:
+  ClusteredLighting() = default;
+  ~ClusteredLighting() = default;
+
+  /**
+   * @brief Configuro la rejilla para una proyección en perspectiva.
+   *
+   * @param settings  Resolución de la rejilla.
+   * @param fovY      Campo de visión vertical en radianes.
+   * @param aspect    Ancho / alto.
+   * @param nearZ     Plano cercano.
+   * @param farZ      Plano lejano (los clusters terminan aquí).
+   *
+   * @details
+   *  Solo recalcula los AABBs si algo cambió, así que se puede llamar cada frame.
+   */
+  void
+    setProjection(const ClusterGridSettings& settings,
+                  float fovY,
+                  float aspect,
+                  float nearZ,
+                  float farZ);
+
+  /**
+   * @brief Asigno las luces a los clusters.
+   *
+   * @param lights  Luces en espacio de mundo.
+   * @param view    Matriz de vista (vectores fila, como XNA Math).
+   */
+  void
+    build(const std::vector<Light>& lights, const XMFLOAT4X4& view);
+
+  /**
+   * @brief Versión de referencia: prueba cada luz contra cada cluster, sin SIMD ni hilos.
+   *
+   * @details
+   *  Uso la misma aritmética que la versión rápida, así que el resultado debe ser idéntico.
+   *  Solo sirve para verificar en el benchmark.
+   */
+  void
+    buildReference(const std::vector<Light>& lights, const XMFLOAT4X4& view);
+
+  /**
+   * @brief Índice plano del cluster (x, y, z); y = 0 es la fila de arriba de la pantalla.
+   */
+  unsigned int
+    getClusterIndex(unsigned int x, unsigned int y, unsigned int z) const {
+    return (z * m_settings.tilesY + y) * m_settings.tilesX + x;
+  }
+
+  unsigned int
+    getNumClusters() const { return m_settings.tilesX * m_settings.tilesY * m_settings.slicesZ; }
+
+  const ClusterGridSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Escala y sesgo para sacar la rebanada en el shader:
+   *        `slice = floor(log(viewZ) * scale + bias)`.
+   */
+  float
+    getDepthSliceScale() const { return m_sliceScale; }
+
+  float
+    getDepthSliceBias() const { return m_sliceBias; }
+
+  const std::vector<ClusterRange>&
+    getClusterRanges() const { return m_ranges; }
+
+  const std::vector<unsigned int>&
+    getLightIndices() const { return m_indices; }
+
+  /**
+   * @brief Luces empaquetadas para el shader, en el mismo orden que la entrada.
+   */
+  const std::vector<GpuLight>&
+    getGpuLights() const { return m_gpuLights; }
+
+  const ClusteredLightingStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: 1k y 10k luces contra una rejilla de 1080p.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Esfera de una luz ya en espacio de vista, con su rango de rebanadas.
+   */
+  struct
+    ViewSphere {
+    float x, y, z, radius;
+    int firstSlice, lastSlice;
+  };
+
+  /**
+   * @brief Recalculo los rangos X/Y/Z de cada columna, fila y rebanada.
+   */
+  void
+    buildGrid();
+
+  /**
+   * @brief Paso 1: luces a espacio de vista, esferas y lista de luces por rebanada.
+   */
+  void
+    prepareLights(const std::vector<Light>& lights, const XMFLOAT4X4& view);
+
+  /**
+   * @brief Paso 2: asigno las luces de una rebanada a sus clusters (SSE).
+   */
+  void
+    assignSlice(unsigned int slice);
+
+  /**
+   * @brief Paso 3: prefix sum de los conteos y copia a la lista compacta.
+   */
+  void
+    compact();
+
+  /**
+   * @brief Rebanada que contiene la profundidad `z` (sin saturar).
+   */
+  int
+    sliceFromDepth(float z) const;
+
+private:
+  ClusterGridSettings m_settings;
+  float m_fovY = 0.0f;
+  float m_aspect = 0.0f;
+  float m_nearZ = 0.0f;
+  float m_farZ = 0.0f;
+  float m_sliceScale = 0.0f;
+  float m_sliceBias = 0.0f;
+  bool m_gridDirty = true;
+
+  /// @brief Columnas rellenadas a múltiplo de 4 para el loop SSE.
+  unsigned int m_paddedTilesX = 0;
+
+  /// @brief Rangos de la rejilla por rebanada: columnas [slice * paddedX + x], filas [slice * tilesY + y].
+  std::vector<float> m_columnMin;
+  std::vector<float> m_columnMax;
+  std::vector<float> m_rowMin;
+  std::vector<float> m_rowMax;
+  std::vector<float> m_sliceNear;
+  std::vector<float> m_sliceFar;
+
+  /// @brief Esferas en espacio de vista (una por luz).
+  std::vector<ViewSphere> m_spheres;
+
+  /// @brief Luces por rebanada: `m_sliceLights[m_sliceStart[s] .. m_sliceStart[s + 1])`.
+  std::vector<unsigned int> m_sliceStart;
+  std::vector<unsigned int> m_sliceLights;
+
+  /// @brief Salida sin compactar: `maxLightsPerCluster` huecos por cluster.
+  std::vector<unsigned int> m_clusterCounts;
+  std::vector<unsigned int> m_clusterScratch;
+  std::vector<unsigned char> m_clusterOverflow;
+
+  std::vector<ClusterRange> m_ranges;
+  std::vector<unsigned int> m_indices;
+  std::vector<GpuLight> m_gpuLights;
+
+  ClusteredLightingStats m_stats;
+};
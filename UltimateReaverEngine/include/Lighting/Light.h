@@ -0,0 +1,117 @@
+/**
+ * @file Light.h
+ * @brief Aquí defino las luces puntuales y spot que maneja el motor.
+ *
+ * @details
+ *  `Light` es la descripción en CPU (lo que edita el juego) y `GpuLight` es la versión
+ *  empaquetada que subo al structured buffer. Las dos son POD para poder copiarlas
+ *  en bloque y procesarlas headless en los benchmarks.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cmath>
+
+ /**
+  * @enum LightType
+  * @brief Tipo de luz dinámica.
+  */
+enum
+  LightType {
+  POINT_LIGHT = 0,
+  SPOT_LIGHT = 1
+};
+
+/**
+ * @struct Light
+ * @brief Luz puntual o spot en espacio de mundo.
+ */
+struct
+  Light {
+  LightType type = POINT_LIGHT;
+  XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  /// @brief Distancia a la que la atenuación llega a cero.
+  float range = 5.0f;
+  XMFLOAT3 color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+  float intensity = 1.0f;
+  /// @brief Dirección normalizada (solo spot).
+  XMFLOAT3 direction = XMFLOAT3(0.0f, 0.0f, 1.0f);
+  /// @brief Medio ángulo interior y exterior del cono en radianes (solo spot).
+  float innerAngle = 0.4f;
+  float outerAngle = 0.5f;
+};
+
+/**
+ * @struct GpuLight
+ * @brief Luz empaquetada para el shader (48 bytes, múltiplo de 16).
+ *
+ * @details
+ *  Layout en HLSL:
+ *  `struct GpuLight { float3 position; float range; float3 color; uint type;
+ *                     float3 direction; float spotScale; float spotOffset; float3 pad; };`
+ *  Para spots el factor del cono es `saturate(dot(-L, direction) * spotScale + spotOffset)`.
+ */
+struct
+  GpuLight {
+  XMFLOAT3 position;
+  float range;
+  XMFLOAT3 color;
+  unsigned int type;
+  XMFLOAT3 direction;
+  float spotScale;
+  float spotOffset;
+  float padding[3];
+};
+
+namespace LightUtils {
+
+  /**
+   * @brief Esfera envolvente de la luz (para asignarla a clusters).
+   *
+   * @details
+   *  Para un spot con medio ángulo menor a 45° uso la esfera que circunscribe el cono
+   *  (mucho más chica que la de radio `range`); si el cono es más abierto, la de la luz puntual.
+   */
+  inline void
+    boundingSphere(const Light& light, XMFLOAT3& center, float& radius) {
+    center = light.position;
+    radius = light.range;
+    if (light.type != SPOT_LIGHT) {
+      return;
+    }
+    float cosAngle = std::cos(light.outerAngle);
+    if (cosAngle > 0.70710678f) {
+      radius = light.range / (2.0f * cosAngle);
+      center.x += light.direction.x * radius;
+      center.y += light.direction.y * radius;
+      center.z += light.direction.z * radius;
+    }
+  }
+
+  /**
+   * @brief Empaqueto una luz para el shader (color premultiplicado por la intensidad).
+   */
+  inline GpuLight
+    pack(const Light& light) {
+    GpuLight out = {};
+    out.position = light.position;
+    out.range = light.range;
+    out.color = XMFLOAT3(light.color.x * light.intensity,
+                         light.color.y * light.intensity,
+                         light.color.z * light.intensity);
+    out.type = static_cast<unsigned int>(light.type);
+    out.direction = light.direction;
+    if (light.type == SPOT_LIGHT) {
+      float cosInner = std::cos(light.innerAngle);
+      float cosOuter = std::cos(light.outerAngle);
+      out.spotScale = 1.0f / std::max(cosInner - cosOuter, 1e-4f);
+      out.spotOffset = -cosOuter * out.spotScale;
+    }
+    else {
+      out.spotScale = 0.0f;
+      out.spotOffset = 1.0f;
+    }
+    return out;
+  }
+
+} // namespace LightUtils
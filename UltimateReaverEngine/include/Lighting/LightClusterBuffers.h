@@ -0,0 +1,103 @@
+/**
+ * @file LightClusterBuffers.h
+ * @brief Aquí defino los buffers de GPU donde subo el resultado de `ClusteredLighting`.
+ *
+ * @details
+ *  Son tres structured buffers dinámicos más un constant buffer:
+ *
+ *  - `t4` `StructuredBuffer<GpuLight>`   luces empaquetadas.
+ *  - `t5` `StructuredBuffer<uint2>`      (offset, count) por cluster.
+ *  - `t6` `StructuredBuffer<uint>`       lista compacta de índices de luz.
+ *  - `b3` `CBLightClusters`              tamaño de la rejilla y parámetros de profundidad.
+ *
+ *  Los structured buffers se llenan con `Map(WRITE_DISCARD)` una sola vez por frame;
+ *  el driver renombra la memoria, así que no espero a que la GPU termine el frame anterior.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+
+class Device;
+class DeviceContext;
+class ClusteredLighting;
+
+/**
+ * @class LightClusterBuffers
+ * @brief Sube las listas de luces por cluster y las vincula al pixel shader.
+ */
+class
+  LightClusterBuffers {
+public:
+  LightClusterBuffers() = default;
+  ~LightClusterBuffers() = default;
+
+  /**
+   * @brief Creo los buffers con capacidad fija.
+   *
+   * @param device       Dispositivo de Direct3D.
+   * @param maxLights    Máximo de luces que se pueden subir.
+   * @param numClusters  Clusters de la rejilla.
+   * @param maxIndices   Máximo de índices en la lista compacta
+   *                     (`numClusters * maxLightsPerCluster` es el peor caso).
+   */
+  HRESULT
+    init(Device& device,
+         unsigned int maxLights,
+         unsigned int numClusters,
+         unsigned int maxIndices);
+
+  /**
+   * @brief Copio luces, rangos e índices del frame a la GPU.
+   *
+   * @param screenWidth   Ancho del render target en pixeles (para el tamaño de tile).
+   * @param screenHeight  Alto del render target en pixeles.
+   *
+   * @details
+   *  Si algo no cabe se recorta y se reporta con `ERROR` una sola vez.
+   */
+  void
+    update(DeviceContext& deviceContext,
+           const ClusteredLighting& clusters,
+           unsigned int screenWidth,
+           unsigned int screenHeight);
+
+  /**
+   * @brief Vinculo los buffers al pixel shader (`t4..t6` y `b3`).
+   */
+  void
+    render(DeviceContext& deviceContext);
+
+  void
+    destroy();
+
+private:
+  /**
+   * @brief Creo un structured buffer dinámico con su SRV.
+   */
+  HRESULT
+    createStructuredBuffer(Device& device,
+                           unsigned int stride,
+                           unsigned int count,
+                           ID3D11Buffer** buffer,
+                           ID3D11ShaderResourceView** view);
+
+  /**
+   * @brief Copio `bytes` bytes a un buffer dinámico descartando su contenido anterior.
+   */
+  void
+    upload(DeviceContext& deviceContext, ID3D11Buffer* buffer, const void* data, size_t bytes);
+
+private:
+  ID3D11Buffer* m_lightBuffer = nullptr;
+  ID3D11Buffer* m_rangeBuffer = nullptr;
+  ID3D11Buffer* m_indexBuffer = nullptr;
+  ID3D11ShaderResourceView* m_views[3] = { nullptr, nullptr, nullptr };
+  Buffer m_cbLightClusters;
+  CBLightClusters m_params = {};
+
+  unsigned int m_maxLights = 0;
+  unsigned int m_numClusters = 0;
+  unsigned int m_maxIndices = 0;
+  bool m_reportedOverflow = false;
+};
@@ -0,0 +1,370 @@
+/**
+ * @file LightmapBaker.h
+ * @brief Aquí horneo la iluminación global de la geometría estática en un lightmap.
+ *
+ * @details
+ *  Las luces dinámicas se calculan cada frame aunque la geometría no se mueva, y no hay
+ *  luz rebotada. El baker calcula offline la irradiancia de cada texel del atlas:
+ *  - **Escena:** las instancias estáticas se aplanan en mundo en un solo `TriangleBVH`.
+ *    El UV2 sale de `LightmapPacker` (un layout por malla, un cuadrado por instancia).
+ *  - **Path tracer en CPU:** cada texel traza `kLightmapSamplesPerPass` caminos a la vez
+ *    como un paquete de 8 rayos (`intersect8`/`occluded8`, SSE). Las direcciones salen con
+ *    importance sampling de coseno, en cada rebote hago next event estimation contra una
+ *    luz (sol, puntuales y spots) y después del segundo rebote corto con ruleta rusa. Lo
+ *    que se escapa ve el color del cielo. Los texels se reparten en el `JobSystem` y cada
+ *    uno tiene su semilla, así que el resultado no depende del número de hilos.
+ *  - **Progresivo:** `step` avanza lo que quepa en un presupuesto de tiempo; al terminar
+ *    cada pasada se rearma la vista previa (para el panel de ImGui).
+ *  - **Denoise:** filtro à-trous (SVGF sin la parte temporal) sobre el atlas, guiado por la
+ *    posición, la normal y la varianza de cada texel; luego relleno el margen de los charts.
+ *  - **Asset:** la irradiancia se guarda en RGB9E5 (`DXGI_FORMAT_R9G9B9E5_SHAREDEXP`, HDR
+ *    en 4 bytes) y los texels van comprimidos sin pérdida con el codec de `MeshCodec`.
+ *
+ *  La convención del valor guardado es la de las luces del motor: el color final es
+ *  `albedo * lightmap`, o sea lo que da `color * intensidad * N·L * atenuación` de una luz,
+ *  más el cielo y lo rebotado.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Lighting/Light.h"
+#include "Lighting/LightmapPacker.h"
+#include "Collision/TriangleBVH.h"
+#include <atomic>
+
+class BenchmarkReport;
+
+/// @brief Versión actual del archivo de lightmap.
+const unsigned int kLightmapVersion = 1;
+
+/// @brief Primeros bytes de todo archivo de lightmap.
+const char kLightmapMagic[4] = { 'U', 'R', 'L', 'M' };
+
+/// @brief Caminos por texel en cada pasada (un paquete de 8 rayos del BVH).
+const unsigned int kLightmapSamplesPerPass = 8;
+
+/**
+ * @struct LightmapInstance
+ * @brief Una malla estática en su lugar del mundo.
+ */
+struct
+  LightmapInstance {
+  const MeshComponent* mesh = nullptr;
+  XMFLOAT4X4 world;
+  /// @brief Albedo difuso (el BaseColor del material).
+  XMFLOAT3 albedo = XMFLOAT3(0.8f, 0.8f, 0.8f);
+};
+
+/**
+ * @struct LightmapBakeSettings
+ * @brief Atlas, calidad y el cielo de un horneado.
+ */
+struct
+  LightmapBakeSettings {
+  LightmapPackSettings pack;
+  /// @brief Pasadas hasta terminar (`kLightmapSamplesPerPass` muestras por texel cada una).
+  unsigned int passes = 32;
+  /// @brief Rebotes después del texel (1 = solo luz directa en lo que ve).
+  unsigned int maxBounces = 3;
+  XMFLOAT3 skyColor = XMFLOAT3(0.25f, 0.3f, 0.4f);
+  /// @brief Hacia dónde viaja la luz del sol (no tiene que venir normalizada).
+  XMFLOAT3 sunDirection = XMFLOAT3(0.4f, -0.8f, 0.45f);
+  /// @brief Color por intensidad del sol (negro = sin sol).
+  XMFLOAT3 sunColor = XMFLOAT3(1.0f, 0.95f, 0.85f);
+  bool denoise = true;
+  /// @brief Pasos del filtro à-trous (radio 2, 4, 8... texels).
+  unsigned int denoiseIterations = 3;
+};
+
+/**
+ * @struct LightmapBakeStats
+ * @brief Números del último horneado.
+ */
+struct
+  LightmapBakeStats {
+  unsigned int instances = 0;
+  /// @brief Mallas distintas (las instancias de una malla comparten su unwrap).
+  unsigned int meshes = 0;
+  unsigned int charts = 0;
+  unsigned int triangles = 0;
+  /// @brief Texels del atlas cubiertos por algún triángulo.
+  unsigned int texels = 0;
+  unsigned int passes = 0;
+  float texelsPerUnit = 0.0f;
+  /// @brief Rayos trazados (caminos y sombras).
+  unsigned long long rays = 0;
+  double setupMs = 0.0;
+  double traceMs = 0.0;
+  double denoiseMs = 0.0;
+
+  double
+    getRaysPerSecond() const { return traceMs > 0.0 ? rays / (traceMs * 0.001) : 0.0; }
+};
+
+/**
+ * @struct LightmapData
+ * @brief Un lightmap horneado: el atlas en RGB9E5 y dónde quedó cada instancia.
+ */
+struct
+  LightmapData {
+  unsigned int width = 0;
+  unsigned int height = 0;
+  float texelsPerUnit = 0.0f;
+  /// @brief Por instancia: UV2 del atlas = uv * xy + zw.
+  std::vector<XMFLOAT4> scaleOffsets;
+  /// @brief Por instancia: hash de su malla (si cambió, hay que volver a hornear).
+  std::vector<unsigned long long> geometryHashes;
+  /// @brief `width * height` texels en RGB9E5.
+  std::vector<unsigned int> texels;
+};
+
+/**
+ * @class LightmapBaker
+ * @brief Path tracer progresivo de lightmaps con denoise y asset comprimido.
+ */
+class
+  LightmapBaker {
+public:
+  LightmapBaker() = default;
+  ~LightmapBaker() = default;
+
+  /**
+   * @brief Preparo un horneado: unwrap, atlas, BVH de la escena y texels.
+   *
+   * @return E_INVALIDARG sin instancias con triángulos; E_FAIL si no caben en el atlas.
+   */
+  HRESULT
+    begin(const std::vector<LightmapInstance>& instances,
+          const std::vector<Light>& lights,
+          const LightmapBakeSettings& settings);
+
+  /**
+   * @brief Trazo texels hasta gastar el presupuesto (al menos un bloque).
+   *
+   * @return true si el horneado ya terminó (con denoise y asset listos).
+   */
+  bool
+    step(double budgetMs);
+
+  /**
+   * @brief Termino la pasada en curso de un jalón.
+   */
+  void
+    bakePass();
+
+  /**
+   * @brief Filtro, relleno el margen y codifico el resultado (lo llama `step` al llegar a las pasadas).
+   */
+  void
+    finish();
+
+  void
+    cancel();
+
+  bool
+    isBaking() const { return m_state == STATE_BAKING; }
+
+  bool
+    isFinished() const { return m_state == STATE_FINISHED; }
+
+  /**
+   * @brief La UI pide un horneado; quien tiene la escena lo empieza con `takeRequest`.
+   */
+  void
+    requestBake(const LightmapBakeSettings& settings) {
+    m_settings = settings;
+    m_requested = true;
+  }
+
+  bool
+    takeRequest() {
+    const bool requested = m_requested;
+    m_requested = false;
+    return requested;
+  }
+
+  const LightmapBakeSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Fracción del horneado en [0, 1].
+   */
+  float
+    getProgress() const;
+
+  const LightmapAtlas&
+    getAtlas() const { return m_atlas; }
+
+  /**
+   * @brief El unwrap que usa una instancia.
+   */
+  const LightmapUnwrap&
+    getUnwrap(unsigned int instance) const { return m_unwraps[m_instanceUnwrap[instance]]; }
+
+  const LightmapBakeStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Promedio de lo acumulado por pixel del atlas (negro donde no hay texel), sin filtrar.
+   */
+  void
+    getIrradiance(std::vector<XMFLOAT3>& pixels) const;
+
+  /**
+   * @brief El resultado final en float (filtrado y con el margen relleno).
+   */
+  const std::vector<XMFLOAT3>&
+    getResult() const { return m_result; }
+
+  const LightmapData&
+    getData() const { return m_data; }
+
+  /**
+   * @brief Vista previa en RGBA8 (tonemap de Reinhard, gamma 2.2), `width * height` pixeles.
+   */
+  const std::vector<unsigned int>&
+    getPreview() const { return m_preview; }
+
+  /// @brief Cambia cada vez que se rearma la vista previa.
+  unsigned int
+    getPreviewVersion() const { return m_previewVersion; }
+
+  static unsigned int
+    encodeRGB9E5(const XMFLOAT3& color);
+
+  static XMFLOAT3
+    decodeRGB9E5(unsigned int packed);
+
+  static HRESULT
+    saveAsset(const std::string& path, const LightmapData& data);
+
+  /**
+   * @return false si el archivo no existe, no es de esta versión o está corrupto.
+   */
+  static bool
+    loadAsset(const std::string& path, LightmapData& data);
+
+  /**
+   * @brief Benchmark headless: unwrap, casos analíticos, denoise y rayos/s en un nivel de prueba.
+   *
+   * @details Verifico que los charts e instancias no se encimen, que un piso bajo el cielo
+   *          y bajo el sol dé exactamente lo esperado, que una caja le haga sombra, que el
+   *          denoise acerque el resultado a una referencia con muchas muestras, que hornear
+   *          dos veces dé lo mismo y que el asset regrese los mismos texels.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  enum
+    State {
+    STATE_IDLE,
+    STATE_BAKING,
+    STATE_FINISHED
+  };
+
+  struct
+    Texel {
+    /// @brief Ya separada de la superficie por `m_epsilon`.
+    XMFLOAT3 position;
+    /// @brief Normal interpolada (para el coseno y el hemisferio).
+    XMFLOAT3 normal;
+    /// @brief Normal del triángulo (los rayos no pueden cruzarla).
+    XMFLOAT3 geometric;
+    unsigned int pixel;
+  };
+
+  struct
+    Emitter {
+    bool directional = false;
+    XMFLOAT3 position;
+    /// @brief Hacia la luz si es direccional; si es spot, hacia dónde apunta.
+    XMFLOAT3 direction;
+    XMFLOAT3 color;
+    float range = 0.0f;
+    float spotScale = 0.0f;
+    float spotOffset = 1.0f;
+  };
+
+  /**
+   * @brief Texels del atlas: el centro de cada pixel que cae dentro de un triángulo.
+   */
+  void
+    rasterize(const std::vector<LightmapInstance>& instances);
+
+  /**
+   * @brief Trazo los texels [first, last) de la pasada actual.
+   */
+  void
+    traceRange(size_t first, size_t last);
+
+  void
+    traceTexel(size_t texel, unsigned long long& rays);
+
+  /**
+   * @brief Cierro una pasada: vista previa nueva o, si era la última, `finish`.
+   */
+  void
+    completePass();
+
+  /**
+   * @brief Rayo de sombra y lo que aporta una luz en un punto (false si no llega).
+   */
+  bool
+    sampleEmitter(const Emitter& emitter,
+                  const float position[3],
+                  const float normal[3],
+                  BVHRay& shadow,
+                  float color[3]) const;
+
+  /**
+   * @brief Promedio acumulado y, si se pide, filtrado y con el margen relleno.
+   */
+  void
+    resolve(std::vector<XMFLOAT3>& pixels, bool filtered);
+
+  void
+    denoise(std::vector<XMFLOAT3>& pixels, std::vector<float>& variance) const;
+
+  void
+    dilate(std::vector<XMFLOAT3>& pixels) const;
+
+  void
+    updatePreview(const std::vector<XMFLOAT3>& pixels);
+
+private:
+  State m_state = STATE_IDLE;
+  bool m_requested = false;
+  LightmapBakeSettings m_settings;
+  LightmapAtlas m_atlas;
+
+  std::vector<LightmapUnwrap> m_unwraps;
+  std::vector<unsigned int> m_instanceUnwrap;
+
+  /// @brief La escena en mundo: BVH, normal y albedo de cada triángulo.
+  TriangleBVH m_bvh;
+  std::vector<XMFLOAT3> m_triangleNormals;
+  std::vector<XMFLOAT3> m_triangleAlbedo;
+  std::vector<Emitter> m_emitters;
+  XMFLOAT3 m_sky = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  float m_epsilon = 1e-4f;
+
+  std::vector<Texel> m_texels;
+  /// @brief Texel de cada pixel del atlas (`kInvalidTriangle` si ninguno).
+  std::vector<unsigned int> m_pixelTexel;
+  /// @brief Por texel: suma de las muestras, suma de la luminancia al cuadrado y cuántas van.
+  std::vector<XMFLOAT3> m_accum;
+  std::vector<float> m_accumSquared;
+  std::vector<unsigned int> m_samples;
+
+  /// @brief Pasadas completas y siguiente texel de la pasada en curso.
+  unsigned int m_pass = 0;
+  size_t m_cursor = 0;
+  std::atomic<unsigned long long> m_rays{ 0 };
+
+  std::vector<XMFLOAT3> m_result;
+  LightmapData m_data;
+  std::vector<unsigned int> m_preview;
+  unsigned int m_previewVersion = 0;
+  LightmapBakeStats m_stats;
+};
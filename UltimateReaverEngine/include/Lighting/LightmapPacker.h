@@ -0,0 +1,118 @@
+/**
+ * @file LightmapPacker.h
+ * @brief Aquí hago el segundo juego de UVs (UV2) de las mallas estáticas y el atlas del lightmap.
+ *
+ * @details
+ *  Las UVs de textura se repiten y se enciman, así que no sirven para guardar luz. Aquí:
+ *  - **Charts:** junto triángulos vecinos (por arista, soldando posiciones) cuya normal cae
+ *    en la misma cara del cubo que la del triángulo semilla y no se aleja más del umbral.
+ *    Cada chart se proyecta en el plano de ese eje, así que no se dobla sobre sí mismo.
+ *  - **Layout por malla:** los charts se acomodan por repisas (shelf packing) en un cuadrado
+ *    en unidades del objeto, con un margen entre ellos. Los vértices que quedan en la
+ *    costura de dos charts se duplican; la malla original no se toca (`remap` dice de qué
+ *    vértice salió cada uno).
+ *  - **Atlas por escena:** cada instancia es un cuadrado de `tamaño del layout * escala *
+ *    texelsPerUnit` texels. Si no caben todas, bajo la densidad hasta que quepan. La UV2
+ *    de una instancia es `uv * scaleOffset.xy + scaleOffset.zw` (varias instancias de la
+ *    misma malla comparten su layout).
+ *
+ *  Todo es CPU, así que el benchmark corre headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @struct LightmapPackSettings
+ * @brief Tamaño del atlas, densidad y criterio de los charts.
+ */
+struct
+  LightmapPackSettings {
+  /// @brief Lado del atlas en texels.
+  unsigned int atlasSize = 512;
+  /// @brief Densidad que quiero; baja sola si la escena no cabe.
+  float texelsPerUnit = 8.0f;
+  /// @brief Texels libres entre charts (para que el filtrado bilineal no mezcle).
+  unsigned int padding = 2;
+  /// @brief Coseno mínimo entre la normal de un triángulo y la de la semilla de su chart.
+  float chartNormalThreshold = 0.7f;
+};
+
+/**
+ * @struct LightmapUnwrap
+ * @brief UV2 de una malla: vértices (duplicados en las costuras), triángulos y charts.
+ */
+struct
+  LightmapUnwrap {
+  /// @brief Vértice de la malla original de cada vértice del unwrap.
+  std::vector<unsigned int> remap;
+  /// @brief Mismos triángulos y en el mismo orden que la malla, con índices del unwrap.
+  std::vector<unsigned int> indices;
+  /// @brief UV2 en [0, 1] dentro del layout de la malla.
+  std::vector<XMFLOAT2> uv;
+  /// @brief Caja de cada chart en UV2 (minU, minV, maxU, maxV).
+  std::vector<XMFLOAT4> chartRects;
+  /// @brief Lado del layout en unidades del objeto.
+  float size = 0.0f;
+  /// @brief Hash de la geometría de la malla (para saber si el unwrap sigue valiendo).
+  unsigned long long geometryHash = 0;
+};
+
+/**
+ * @struct LightmapRect
+ * @brief Cuadrado de una instancia en el atlas, en texels.
+ */
+struct
+  LightmapRect {
+  unsigned int x = 0;
+  unsigned int y = 0;
+  unsigned int size = 0;
+};
+
+/**
+ * @struct LightmapAtlas
+ * @brief Dónde quedó cada instancia dentro del atlas.
+ */
+struct
+  LightmapAtlas {
+  unsigned int width = 0;
+  unsigned int height = 0;
+  /// @brief Densidad con la que sí cupo todo.
+  float texelsPerUnit = 0.0f;
+  /// @brief Por instancia: UV2 del atlas = uv * xy + zw.
+  std::vector<XMFLOAT4> scaleOffsets;
+  std::vector<LightmapRect> rects;
+};
+
+/**
+ * @class LightmapPacker
+ * @brief Charts, layout de UV2 por malla y atlas de instancias.
+ */
+class
+  LightmapPacker {
+public:
+  /**
+   * @brief Armo los charts de una malla y los acomodo en su layout.
+   *
+   * @details El margen entre charts es `padding / texelsPerUnit` unidades del objeto, o sea
+   *          `padding` texels si la instancia no está escalada y la densidad no baja.
+   */
+  static void
+    unwrap(const MeshComponent& mesh, const LightmapPackSettings& settings, LightmapUnwrap& out);
+
+  /**
+   * @brief Acomodo las instancias en el atlas.
+   *
+   * @param sizes  Lado de cada instancia en unidades de mundo (`unwrap.size * escala`).
+   * @return false si ni con la densidad mínima caben.
+   */
+  static bool
+    pack(const std::vector<float>& sizes, const LightmapPackSettings& settings, LightmapAtlas& out);
+
+  /**
+   * @brief La escala más grande de los ejes de una matriz de mundo.
+   */
+  static float
+    getMaxScale(const XMFLOAT4X4& world);
+};
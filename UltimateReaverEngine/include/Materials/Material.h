@@ -0,0 +1,251 @@
+/**
+ * @file Material.h
+ * @brief Aquí defino el material: parámetros con el layout que declara el shader y sus texturas.
+ *
+ * @details
+ *  Antes el actor tenía un `std::vector<Texture>` suelto, solo vinculaba la primera y el
+ *  color iba fijo en blanco. Ahora:
+ *  - **Layout reflejado:** `MaterialLayout` lee el `cbuffer` del material directo del
+ *    `.fx` (el mismo archivo que compila `ShaderProgram`) y calcula los offsets con las
+ *    reglas de empaquetado de HLSL (nada cruza un límite de 16 bytes). También junta los
+ *    `Texture2D` de los slots de material. No toca D3D, así que se prueba headless.
+ *  - **Material:** un recurso (`ResourceType::Material`) con un bloque de bytes del tamaño
+ *    del layout y una vista por slot de textura. Se arma en código o desde un archivo de
+ *    texto (`shader`, `param` y `texture` por línea).
+ *
+ *  Lo que va a GPU (el arreglo de constantes compartido y las tablas de texturas) lo
+ *  administra `MaterialSystem`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "IResource.h"
+
+/// @brief Slots de textura del material (t0..t3); de t4 en adelante son luces y sombras.
+const unsigned int kMaterialTextureSlots = 4;
+
+/**
+ * @enum MaterialParamType
+ * @brief Tipos escalares y vectores que acepto en el cbuffer del material.
+ */
+enum
+  MaterialParamType {
+  MATERIAL_PARAM_FLOAT = 0,
+  MATERIAL_PARAM_INT = 1,
+  MATERIAL_PARAM_UINT = 2
+};
+
+/**
+ * @struct MaterialParam
+ * @brief Un campo del cbuffer: nombre, tipo, columnas y dónde queda.
+ */
+struct
+  MaterialParam {
+  std::string name;
+  MaterialParamType type = MATERIAL_PARAM_FLOAT;
+  /// @brief 1 a 4 (float, float2, float3, float4).
+  unsigned int columns = 1;
+  /// @brief En bytes desde el inicio del material.
+  unsigned int offset = 0;
+};
+
+/**
+ * @struct MaterialTextureSlot
+ * @brief Un `Texture2D` del material y su registro.
+ */
+struct
+  MaterialTextureSlot {
+  std::string name;
+  unsigned int slot = 0;
+};
+
+/**
+ * @class MaterialLayout
+ * @brief Parámetros y texturas de un material, con offsets de HLSL.
+ */
+class
+  MaterialLayout {
+public:
+  MaterialLayout() = default;
+  ~MaterialLayout() = default;
+
+  /**
+   * @brief Leo el layout de un cbuffer en código HLSL.
+   *
+   * @param source       Código del shader.
+   * @param cbufferName  Nombre del `cbuffer` con los parámetros del material.
+   * @param error        Si falla, por qué (tipo no soportado, cbuffer que no existe...).
+   * @return false si no encontré el cbuffer o tiene algo que no sé empaquetar.
+   *
+   * @details Acepto escalares y vectores de float/int/uint; arreglos, matrices y structs
+   *          no (un material no los necesita y así el empaquetado es simple). Las texturas
+   *          son los `Texture2D` del archivo con `register(tN)` y N < `kMaterialTextureSlots`.
+   */
+  bool
+    reflect(const std::string& source, const std::string& cbufferName, std::string& error);
+
+  /**
+   * @brief Leo el layout de un archivo `.fx`.
+   */
+  bool
+    reflectFile(const std::string& fileName, const std::string& cbufferName, std::string& error);
+
+  /**
+   * @brief Agrego un parámetro al final con las reglas de empaquetado de HLSL.
+   *
+   * @return false si el nombre ya existe o `columns` no es de 1 a 4.
+   */
+  bool
+    addParameter(const std::string& name, MaterialParamType type, unsigned int columns);
+
+  /**
+   * @brief Agrego una textura en un slot de material.
+   */
+  bool
+    addTexture(const std::string& name, unsigned int slot);
+
+  void
+    clear();
+
+  /**
+   * @return El índice del parámetro o -1.
+   */
+  int
+    findParameter(const std::string& name) const;
+
+  /**
+   * @return El slot de la textura o -1.
+   */
+  int
+    findTexture(const std::string& name) const;
+
+  const std::vector<MaterialParam>&
+    getParameters() const { return m_params; }
+
+  const std::vector<MaterialTextureSlot>&
+    getTextures() const { return m_textures; }
+
+  /**
+   * @brief Bytes de un material: el final del último campo redondeado a 16.
+   */
+  unsigned int
+    getSize() const { return (m_end + 15u) & ~15u; }
+
+  /**
+   * @brief Hash de nombres, tipos, offsets y slots (dos layouts iguales dan lo mismo).
+   */
+  unsigned long long
+    getHash() const;
+
+  /**
+   * @brief El layout que uso si el shader no declara el suyo.
+   *
+   * @details BaseColor (float4), Emissive (float3), Roughness, Metallic, UVScale (float2)
+   *          y las texturas Albedo, Normal, MetallicMap y RoughnessMap en t0..t3.
+   */
+  static MaterialLayout
+    getDefault();
+
+private:
+  std::vector<MaterialParam> m_params;
+  std::vector<MaterialTextureSlot> m_textures;
+  /// @brief Fin del último campo (sin redondear).
+  unsigned int m_end = 0;
+};
+
+/**
+ * @class Material
+ * @brief Valores de los parámetros de un layout y las texturas de sus slots.
+ *
+ * @details Las texturas no son del material: guardo la vista y quien la creó la libera.
+ */
+class
+  Material : public IResource {
+public:
+  Material(const std::string& name) : IResource(name) { SetType(ResourceType::Material); }
+
+  Material(const std::string& name, const MaterialLayout& layout) : IResource(name) {
+    SetType(ResourceType::Material);
+    setLayout(layout);
+  }
+
+  ~Material() = default;
+
+  /**
+   * @brief Leo un material de texto.
+   *
+   * @details Una instrucción por línea (`#` es comentario):
+   *          - `shader archivo.fx cbuffer`: refleja el layout (si no, uso el default).
+   *          - `param Nombre v0 [v1 v2 v3]`: valor de un parámetro.
+   *          - `texture Nombre archivo`: ruta de la textura; la carga quien tiene el Device
+   *            (`getTexturePath`) y la asigna con `setTexture`.
+   */
+  bool
+    load(const std::string& fileName) override;
+
+  bool
+    init() override { return true; }
+
+  void
+    unload() override;
+
+  size_t
+    getSizeInBytes() const override;
+
+  /**
+   * @brief Cambio el layout y dejo todos los parámetros en cero y sin texturas.
+   */
+  void
+    setLayout(const MaterialLayout& layout);
+
+  const MaterialLayout&
+    getLayout() const { return m_layout; }
+
+  /**
+   * @brief Escribo un parámetro (tantos valores como columnas; los que falten quedan igual).
+   *
+   * @return false si el layout no tiene ese parámetro.
+   */
+  bool
+    setFloat(const std::string& name, const float* values, unsigned int count);
+
+  bool
+    setVector(const std::string& name, const XMFLOAT4& value);
+
+  bool
+    setUInt(const std::string& name, unsigned int value);
+
+  /**
+   * @brief Leo un parámetro float como vector (lo que no tiene queda en `fallback`).
+   */
+  XMFLOAT4
+    getVector(const std::string& name, const XMFLOAT4& fallback) const;
+
+  bool
+    setTexture(const std::string& name, ID3D11ShaderResourceView* view);
+
+  void
+    setTexture(unsigned int slot, ID3D11ShaderResourceView* view);
+
+  ID3D11ShaderResourceView*
+    getTexture(unsigned int slot) const { return slot < kMaterialTextureSlots ? m_views[slot] : nullptr; }
+
+  const std::string&
+    getTexturePath(unsigned int slot) const { return m_texturePaths[slot % kMaterialTextureSlots]; }
+
+  /// @brief Los bytes tal cual van al cbuffer (tamaño `getLayout().getSize()`).
+  const std::vector<uint8_t>&
+    getConstants() const { return m_constants; }
+
+  /**
+   * @brief Hash del layout, los bytes de los parámetros y las vistas de textura.
+   */
+  unsigned long long
+    getHash() const;
+
+private:
+  MaterialLayout m_layout;
+  std::vector<uint8_t> m_constants;
+  ID3D11ShaderResourceView* m_views[kMaterialTextureSlots] = {};
+  std::string m_texturePaths[kMaterialTextureSlots];
+};
@@ -0,0 +1,238 @@
+/**
+ * @file MaterialSystem.h
+ * @brief Aquí junto los materiales de la escena en un solo constant buffer y tablas de texturas.
+ *
+ * @details
+ *  Cambiar de material era subir un CB y vincular texturas por draw aunque el material
+ *  fuera el mismo que el anterior. Aquí:
+ *  - **Arreglo de constantes:** todos los materiales (mismo layout) viven empaquetados en
+ *    un CB grande (`cbMaterials`, b7) con paso `layout.getSize()`. El draw solo manda el
+ *    índice del material en su CB de objeto (`CBChangesEveryFrame::vMaterial`) y el
+ *    shader lee `Materials[vMaterial.x]`. El CB se sube una vez por frame si algo cambió.
+ *  - **Tablas de texturas:** D3D11 (SM4) no tiene descriptores indexables, así que lo más
+ *    cercano a bindless es una tabla: el juego de vistas de los slots t0..t3 de un
+ *    material, sin repetir. Se vincula con un solo `PSSetShaderResources` y solo cuando
+ *    cambia la tabla.
+ *  - **Deduplicado y orden:** dos materiales con los mismos bytes y texturas son la misma
+ *    entrada (con contador de referencias). `getSortKey` agrupa por tabla y luego por
+ *    material, así al ordenar los draws los que comparten se saltan el rebind.
+ *
+ *  Sin dispositivo (`init(nullptr, ...)`) todo es CPU y se prueba headless.
+ *
+ *  Lo que el shader tiene que declarar (con los campos del layout):
+ *  @code
+ *  struct MaterialData { float4 BaseColor; ... };
+ *  cbuffer cbMaterials : register(b7) { MaterialData Materials[MAX_MATERIALS]; };
+ *  @endcode
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "Materials/Material.h"
+
+class Device;
+class DeviceContext;
+class BenchmarkReport;
+
+/// @brief Índice de material que no existe (el actor dibuja con sus texturas sueltas).
+const unsigned int kInvalidMaterial = 0xFFFFFFFF;
+
+/// @brief Registro del arreglo de materiales (b0..b6 ya tienen dueño).
+const unsigned int kMaterialCBSlot = 7;
+
+/// @brief Tamaño máximo de un constant buffer en D3D11 (4096 float4).
+const unsigned int kMaterialCBBytes = 65536;
+
+/**
+ * @struct MaterialSystemStats
+ * @brief Números del sistema desde `init` (los de binds, desde el último `resetBindStats`).
+ */
+struct
+  MaterialSystemStats {
+  /// @brief Materiales distintos vivos.
+  unsigned int materials = 0;
+  unsigned int textureTables = 0;
+  /// @brief Pedidos a `acquire` y cuántos ya existían.
+  unsigned long long requests = 0;
+  unsigned long long dedupHits = 0;
+  /// @brief Bytes del arreglo que se sube (hasta el último material vivo).
+  unsigned int constantBytes = 0;
+  unsigned int uploads = 0;
+  unsigned long long tableBinds = 0;
+  unsigned long long tableBindsSkipped = 0;
+};
+
+/**
+ * @class MaterialSystem
+ * @brief Materiales empaquetados, tablas de texturas y vinculado sin repetir.
+ */
+class
+  MaterialSystem {
+public:
+  MaterialSystem() = default;
+  ~MaterialSystem() { destroy(); }
+
+  MaterialSystem(const MaterialSystem&) = delete;
+  MaterialSystem&
+    operator=(const MaterialSystem&) = delete;
+
+  static MaterialSystem&
+    getInstance() {
+    static MaterialSystem instance;
+    return instance;
+  }
+
+  /**
+   * @brief Preparo el arreglo para materiales de un layout.
+   *
+   * @param device  nullptr = solo CPU (sin CB en GPU).
+   * @return E_INVALIDARG si el layout está vacío o no cabe ni un material.
+   */
+  HRESULT
+    init(Device* device, const MaterialLayout& layout);
+
+  void
+    destroy();
+
+  bool
+    isReady() const { return m_ready; }
+
+  const MaterialLayout&
+    getLayout() const { return m_layout; }
+
+  /// @brief Materiales que caben en el CB con este layout.
+  unsigned int
+    getCapacity() const { return m_capacity; }
+
+  /**
+   * @brief Doy de alta un material (o le sumo una referencia al igual que ya exista).
+   *
+   * @return Su índice en el arreglo, o `kInvalidMaterial` si el layout no es el del
+   *         sistema o ya no hay lugar.
+   */
+  unsigned int
+    acquire(const Material& material);
+
+  /**
+   * @brief Suelto una referencia; al llegar a cero el lugar y su tabla quedan libres.
+   */
+  void
+    release(unsigned int material);
+
+  unsigned int
+    getTextureTable(unsigned int material) const { return m_entries[material].table; }
+
+  /**
+   * @brief Clave para ordenar draws: tabla de texturas y luego material.
+   */
+  unsigned int
+    getSortKey(unsigned int material) const;
+
+  /**
+   * @brief Los bytes empaquetados de un material.
+   */
+  const uint8_t*
+    getConstants(unsigned int material) const { return &m_constants[material * m_stride]; }
+
+  /**
+   * @brief El parámetro "BaseColor" del material (blanco si el layout no lo tiene).
+   */
+  XMFLOAT4
+    getBaseColor(unsigned int material) const;
+
+  /**
+   * @brief Empiezo un pass: subo el arreglo si cambió, lo vinculo a b7 y olvido la tabla vinculada.
+   */
+  void
+    beginPass(DeviceContext& deviceContext);
+
+  /**
+   * @brief Vinculo la tabla de texturas del material si no es la que ya está.
+   *
+   * @return true si hubo que vincular.
+   */
+  bool
+    bind(DeviceContext& deviceContext, unsigned int material);
+
+  /**
+   * @brief Alguien vinculó otras texturas en t0..t3: el próximo `bind` no se salta.
+   */
+  void
+    invalidateBinding() { m_boundTable = kInvalidMaterial; }
+
+  /**
+   * @brief Lo mismo que `bind` sin tocar D3D (para contar binds en los benchmarks).
+   */
+  bool
+    track(unsigned int material);
+
+  /**
+   * @brief Pongo en cero los contadores de binds y olvido la tabla vinculada.
+   */
+  void
+    resetBindStats();
+
+  MaterialSystemStats
+    getStats() const;
+
+  /**
+   * @brief Benchmark headless: reflexión del layout, empaquetado, deduplicado y binds con y sin ordenar.
+   *
+   * @details Verifico los offsets contra las reglas de HLSL, que los bytes empaquetados sean
+   *          los de cada material y que ordenar por `getSortKey` deje un bind por tabla.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  struct
+    Entry {
+    unsigned long long hash = 0;
+    unsigned int table = 0;
+    unsigned int refs = 0;
+  };
+
+  struct
+    TextureTable {
+    ID3D11ShaderResourceView* views[kMaterialTextureSlots] = {};
+    unsigned long long hash = 0;
+    unsigned int refs = 0;
+  };
+
+  unsigned int
+    acquireTable(const Material& material);
+
+  void
+    releaseTable(unsigned int table);
+
+private:
+  MaterialLayout m_layout;
+  unsigned long long m_layoutHash = 0;
+  unsigned int m_stride = 0;
+  unsigned int m_capacity = 0;
+
+  /// @brief Copia en CPU del CB: `m_capacity * m_stride` bytes.
+  std::vector<uint8_t> m_constants;
+  std::vector<Entry> m_entries;
+  std::vector<unsigned int> m_freeEntries;
+  /// @brief Hash del material -> entrada (verifico los bytes al encontrarlo).
+  std::unordered_map<unsigned long long, unsigned int> m_lookup;
+
+  std::vector<TextureTable> m_tables;
+  std::vector<unsigned int> m_freeTables;
+  std::unordered_map<unsigned long long, unsigned int> m_tableLookup;
+
+  Buffer m_buffer;
+  bool m_dirty = false;
+  unsigned int m_boundTable = kInvalidMaterial;
+  unsigned int m_numMaterials = 0;
+  unsigned int m_numTables = 0;
+
+  unsigned long long m_requests = 0;
+  unsigned long long m_dedupHits = 0;
+  unsigned int m_uploads = 0;
+  unsigned long long m_tableBinds = 0;
+  unsigned long long m_tableBindsSkipped = 0;
+  bool m_ready = false;
+};
@@ -0,0 +1,119 @@
+/**
+ * @file MeshCodec.h
+ * @brief Aquí defino el codec de mallas para disco y la caché de mallas de los modelos.
+ *
+ * @details
+ *  Importar un FBX es lento, y una caché binaria que guarde floats crudos pesa lo mismo que
+ *  la geometría en memoria. El codec comprime los dos buffers sin pérdida:
+ *  - **Índices:** aprovecho la adyacencia. Casi todos los triángulos comparten una arista
+ *    con uno reciente (FIFO de 16 aristas) y su tercer vértice suele ser el siguiente vértice
+ *    nuevo o uno reciente (FIFO de 16 vértices). Cada triángulo es un byte de código y, solo
+ *    si hace falta, un varint. Los triángulos pueden salir rotados (mismo winding).
+ *  - **Vértices:** por bloques de 16 vértices y por cada palabra de 32 bits del vértice:
+ *    delta contra el vértice anterior, zigzag, byte-shuffle (4 planos de bytes) y cada plano
+ *    empacado con el ancho que necesita (0, 2, 4 u 8 bits por byte). Los planos altos casi
+ *    siempre son 0, así que ocupan 2 bits de encabezado.
+ *
+ *  La decodificación de vértices es SSE2 (desempaco, deshago zigzag y hago la suma prefija en
+ *  registros) y escribe directo al destino que me den, y los índices se pueden decodificar a
+ *  16 o 32 bits. La caché decodifica a los arreglos de la malla porque la copia en CPU la
+ *  usan la BVH, el picking y el baker; el `GeometryPool` sube de ahí escribiendo directo a la
+ *  memoria mapeada de su staging buffer.
+ *
+ *  Para ayudar al codec (y al vertex fetch de la GPU) reordeno los vértices por primer uso
+ *  con `optimizeVertexFetch` antes de guardar.
+ *
+ *  Cada malla de la caché lleva además la sección de su `TriangleBVH` (nodos y orden de los
+ *  triángulos), así un modelo cacheado no reconstruye sus BVH al cargar.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+class BenchmarkReport;
+
+/// @brief Versión actual del archivo de caché de mallas.
+const unsigned int kMeshCacheVersion = 2;
+
+/// @brief Primeros bytes de todo archivo de caché de mallas.
+const char kMeshCacheMagic[4] = { 'U', 'R', 'M', 'C' };
+
+/**
+ * @class MeshCodec
+ * @brief Compresión sin pérdida de vertex/index buffers y caché de mallas en disco.
+ */
+class
+  MeshCodec {
+public:
+  /**
+   * @brief Comprimo una lista de triángulos (el número de índices debe ser múltiplo de 3).
+   */
+  static void
+    encodeIndices(const unsigned int* indices, size_t indexCount, std::vector<unsigned char>& out);
+
+  /**
+   * @brief Descomprimo los índices directo al destino.
+   *
+   * @param destination   `indexCount` índices de `indexStride` bytes (2 o 4).
+   * @param vertexCount   Para validar: un índice fuera de rango es un archivo corrupto.
+   * @return false si los datos están truncados o corruptos.
+   */
+  static bool
+    decodeIndices(void* destination,
+                  size_t indexCount,
+                  unsigned int indexStride,
+                  size_t vertexCount,
+                  const unsigned char* data,
+                  size_t size);
+
+  /**
+   * @brief Comprimo `count` vértices de `stride` bytes (múltiplo de 4).
+   */
+  static void
+    encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& out);
+
+  /**
+   * @brief Descomprimo los vértices directo al destino (SSE2).
+   *
+   * @return false si los datos están truncados o corruptos.
+   */
+  static bool
+    decodeVertices(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size);
+
+  /**
+   * @brief Reordeno los vértices en el orden en que los usan los triángulos (quito los que no se usan).
+   */
+  static void
+    optimizeVertexFetch(MeshComponent& mesh);
+
+  /**
+   * @brief Guardo las mallas y texturas de un modelo estático, con la BVH de las mallas que la tengan.
+   *
+   * @param sourceStamp  Identifica la versión del archivo fuente (tamaño y fecha).
+   */
+  static HRESULT
+    saveCache(const std::string& path,
+              unsigned long long sourceStamp,
+              const std::vector<MeshComponent>& meshes,
+              const std::vector<std::string>& textures);
+
+  /**
+   * @brief Cargo la caché si existe, es válida y es de la misma versión del archivo fuente.
+   *
+   * @return false si hay que importar el archivo fuente otra vez (no toca las listas).
+   */
+  static bool
+    loadCache(const std::string& path,
+              unsigned long long sourceStamp,
+              std::vector<MeshComponent>& meshes,
+              std::vector<std::string>& textures);
+
+  /**
+   * @brief Benchmark headless: razón de compresión y velocidad de decodificación en mallas de prueba.
+   *
+   * @details Verifico que decodificar reproduzca exactamente los vértices y los triángulos.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "Prerequisites.h"
 #include "ECS/Component.h"
+#include "Collision/TriangleBVH.h"
 
 // Forward declarations
 class DeviceContext;
@@ -20,6 +21,16 @@ public:
 	virtual
 		~MeshComponent() = default;
 
+	/**
+	 * @brief Copy and move are explicitly defaulted so splitting and importing can move the vertex/index arrays.
+	 */
+	MeshComponent(const MeshComponent&) = default;
+	MeshComponent(MeshComponent&&) = default;
+	MeshComponent&
+		operator=(const MeshComponent&) = default;
+	MeshComponent&
+		operator=(MeshComponent&&) = default;
+
 	/**
 	 * @brief Initializes the mesh component.
 	 * @note Can be used to load mesh data from a file (e.g., .obj, .fbx)
@@ -62,6 +73,12 @@ public:
 	/** @brief The list of indices stored in system memory. */
 	std::vector<unsigned int> m_index;
 
+	/** @brief Optional skinning influences, one per vertex (empty for static meshes). */
+	std::vector<SkinInfluence> m_skin;
+
+	/** @brief Triangle BVH for precise raycasts, built at import (shared by copies of the mesh). */
+	EU::TSharedPointer<TriangleBVH> m_bvh;
+
 	/** @brief Cached count of the number of vertices. */
 	int m_numVertex;
 
@@ -0,0 +1,104 @@
+/**
+ * @file MeshIndexing.h
+ * @brief Aquí decido el formato de los índices de cada malla (16 o 32 bits) y parto las mallas grandes.
+ *
+ * @details
+ *  En CPU las mallas siempre guardan índices de 32 bits (`MeshComponent::m_index`), pero en
+ *  GPU la mayoría cabe en 16 bits: la mitad de memoria y de ancho de banda de índices.
+ *  - **Detección:** un OR de todos los índices con SSE2; si ningún bit alto está prendido,
+ *    todos caben en 16 bits. Es exacto y no necesita saber cuántos vértices hay.
+ *  - **Conversión:** empaco a 16 bits con SSE2 al subir el index buffer.
+ *  - **Partición:** una malla de más de 65535 vértices se puede partir en pedazos que sí
+ *    caben en 16 bits. Los vértices de la frontera se duplican, así que solo la parto si lo
+ *    que ahorro en índices es más que lo que agrego en vértices.
+ *
+ *  El formato viaja con el buffer (`Buffer::getIndexFormat`) o con la página del
+ *  `GeometryPool` hasta el draw.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+class BenchmarkReport;
+
+/// @brief Máximo de vértices de una malla con índices de 16 bits (dejo libre 0xFFFF).
+const unsigned int kMaxVertices16 = 0xFFFF;
+
+/**
+ * @struct MeshSplitStats
+ * @brief Resultado de partir las mallas de un modelo.
+ */
+struct
+  MeshSplitStats {
+  /// @brief Mallas que se partieron.
+  unsigned int splitMeshes = 0;
+  /// @brief Pedazos que salieron de ellas.
+  unsigned int chunks = 0;
+  /// @brief Mallas grandes que no convenía partir.
+  unsigned int keptMeshes = 0;
+  /// @brief Vértices duplicados en las fronteras.
+  unsigned int duplicatedVertices = 0;
+};
+
+/**
+ * @class MeshIndexing
+ * @brief Formato de índices por malla, conversión a 16 bits y partición en pedazos de <64k vértices.
+ */
+class
+  MeshIndexing {
+public:
+  /**
+   * @brief ¿Todos los índices caben en 16 bits? (OR con SSE2 de 16 índices por vuelta).
+   */
+  static bool
+    fitsIn16Bit(const unsigned int* indices, size_t count);
+
+  /**
+   * @brief Formato de index buffer para la malla: `R16_UINT` si cabe, si no `R32_UINT`.
+   */
+  static DXGI_FORMAT
+    chooseFormat(const MeshComponent& mesh);
+
+  /// @brief Bytes por índice del formato.
+  static unsigned int
+    getStride(DXGI_FORMAT format) { return format == DXGI_FORMAT_R16_UINT ? 2 : 4; }
+
+  /**
+   * @brief Copio los índices a 16 bits (deben caber; ver `fitsIn16Bit`).
+   */
+  static void
+    narrow(const unsigned int* indices, size_t count, unsigned short* out);
+
+  /**
+   * @brief Parto la malla en pedazos de a lo más `kMaxVertices16` vértices, en orden de triángulos.
+   *
+   * @return Vértices duplicados en las fronteras. Si la malla ya cabe, `chunks` queda con una copia.
+   */
+  static unsigned int
+    split(const MeshComponent& mesh, std::vector<MeshComponent>& chunks);
+
+  /**
+   * @brief Parto las mallas que no caben en 16 bits, solo si ahorro memoria.
+   *
+   * @details Las mallas partidas se reemplazan por sus pedazos en el mismo lugar de la lista.
+   */
+  static MeshSplitStats
+    splitLargeMeshes(std::vector<MeshComponent>& meshes);
+
+  /**
+   * @brief Bytes de index buffer de las mallas con su formato elegido.
+   *
+   * @param bytes32 Lo que ocuparían todas con 32 bits (opcional).
+   */
+  static size_t
+    getIndexBytes(const std::vector<MeshComponent>& meshes, size_t* bytes32 = nullptr);
+
+  /**
+   * @brief Benchmark headless: velocidad de detección y conversión y memoria ahorrada en una escena.
+   *
+   * @details Verifico que los pedazos tengan los mismos triángulos que la malla original.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+};
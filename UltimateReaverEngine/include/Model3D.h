@@ -2,6 +2,9 @@
 #include "Prerequisites.h"
 #include "IResource.h"
 #include "MeshComponent.h"
+#include "Animation/Skeleton.h"
+#include "Animation/AnimationClip.h"
+#include "Animation/CompressedAnimationClip.h"
 #include "fbxsdk.h"
 
 /**
@@ -11,16 +14,19 @@
 enum 
 ModelType {
 	OBJ, /**< Wavefront OBJ format. */
-	FBX  /**< Autodesk FBX format. */
+	FBX, /**< Autodesk FBX format. */
+	GLTF /**< glTF 2.0 (.gltf or .glb), imported without the FBX SDK. */
 };
 
+class BenchmarkReport;
+
 class 
 Model3D : public IResource {
 public:
 	/**
 	 * @brief Constructor.
 	 * @param name The name of the model resource (also acts as the initial load path).
-	 * @param modelType The format of the model (OBJ or FBX).
+	 * @param modelType The format of the model (OBJ, FBX or GLTF).
 	 */
 	Model3D(const std::string& name, ModelType modelType) : IResource(name), 
 																													m_modelType(modelType), 
@@ -71,6 +77,22 @@ public:
 	const std::vector<MeshComponent>&
 	GetMeshes() const { return m_meshes; }
 
+	/**
+	 * @brief Picks the model type from the file extension (.gltf/.glb are GLTF, anything else FBX).
+	 * @param path The file path to the model.
+	 * @return ModelType The format to load the file with.
+	 */
+	static ModelType
+	GetModelTypeFromPath(const std::string& path);
+
+	/**
+	 * @brief Headless benchmark: loads the same meshes exported as .fbx and as .glb.
+	 * Both go through the full Model3D pipeline (tangents, index split, BVHs).
+	 * @param report Where the timings and failures are written.
+	 */
+	static void
+	runImportBenchmark(BenchmarkReport& report);
+
 	/* FBX MODEL LOADER METHODS */
 
 	/**
@@ -103,6 +125,35 @@ public:
 	void
 	ProcessFBXMesh(FbxNode* node);
 
+	/**
+	 * @brief Builds the skeleton from the scene graph.
+	 * Skeleton nodes and any node used as a skin cluster link become bones,
+	 * stored parents-first so poses can be evaluated in one linear pass.
+	 * @param rootNode The scene root node.
+	 */
+	void
+	ProcessFBXSkeleton(FbxNode* rootNode);
+
+	/**
+	 * @brief Reads the skin deformer of a mesh into per-control-point influences.
+	 * Keeps the four strongest influences and renormalizes their weights.
+	 * Also stores the inverse bind pose of every bone referenced by the skin.
+	 * @param node The FBX node owning the mesh.
+	 * @param mesh The FBX mesh.
+	 * @param outInfluences One entry per control point (left empty if the mesh has no skin).
+	 */
+	void
+	ProcessFBXSkin(FbxNode* node, FbxMesh* mesh, std::vector<SkinInfluence>& outInfluences);
+
+	/**
+	 * @brief Samples every animation stack of the scene and compresses the result.
+	 * The curves are baked at a fixed rate into a temporary AnimationClip, then
+	 * keyframe-reduced and quantized into a CompressedAnimationClip.
+	 * @param sampleRate Frames per second used to bake the curves.
+	 */
+	void
+	ProcessFBXAnimations(float sampleRate = 30.0f);
+
 	/**
 	 * @brief Extracts material and texture information from an FBX material.
 	 * @param material The FBX surface material to process.
@@ -110,6 +161,15 @@ public:
 	void
 	ProcessFBXMaterials(FbxSurfaceMaterial* material);
 
+	/**
+	 * @brief Gives every mesh its triangle BVH for precise raycasts.
+	 * Meshes whose BVH came in the ".urmesh" cache keep it; the rest are built
+	 * here (one mesh per job).
+	 * @return true if any BVH was built, so the cache has to be rewritten.
+	 */
+	bool
+	BuildMeshBVHs();
+
 	/**
 	 * @brief Gets the file names of textures found within the model file.
 	 * @return std::vector<std::string> List of texture filenames.
@@ -117,6 +177,27 @@ public:
 	std::vector<std::string>
 	GetTextureFileNames() const { return textureFileNames; }
 
+	/**
+	 * @brief Gets the skeleton imported from the model (empty if the model is static).
+	 * @return const Skeleton& Reference to the skeleton.
+	 */
+	const Skeleton&
+	GetSkeleton() const { return m_skeleton; }
+
+	/**
+	 * @brief Gets the (compressed) animation clips imported from the model.
+	 * @return const std::vector<CompressedAnimationClip>& Reference to the clips.
+	 */
+	const std::vector<CompressedAnimationClip>&
+	GetAnimations() const { return m_animations; }
+
+	/**
+	 * @brief Tells whether the model has bones and skinned meshes.
+	 * @return bool True if the model can be animated.
+	 */
+	bool
+	HasSkeleton() const { return m_skeleton.getBoneCount() > 0; }
+
 private:
 	/** @brief Pointer to the Autodesk FBX SDK Manager. */
 	FbxManager* lSdkManager;
@@ -127,10 +208,22 @@ private:
 	/** @brief Cached list of texture filenames associated with this model. */
 	std::vector<std::string> textureFileNames;
 
+	/** @brief FBX node of every bone, parallel to the skeleton bones. */
+	std::vector<FbxNode*> m_boneNodes;
+
+	/** @brief Lookup from FBX node to bone index. */
+	std::unordered_map<FbxNode*, int> m_boneLookup;
+
 public:
 	/** @brief The file format type of this model instance. */
 	ModelType m_modelType;
 
 	/** @brief The collection of sub-meshes that make up this model. */
 	std::vector<MeshComponent> m_meshes;
+
+	/** @brief The bone hierarchy used by the skinned meshes. */
+	Skeleton m_skeleton;
+
+	/** @brief The compressed animation clips baked from the FBX animation stacks. */
+	std::vector<CompressedAnimationClip> m_animations;
 };
\ No newline at end of file
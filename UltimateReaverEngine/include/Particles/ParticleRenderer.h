@@ -0,0 +1,83 @@
+/**
+ * @file ParticleRenderer.h
+ * @brief Aquí defino el renderer de partículas: un buffer de instancias dinámico y un draw.
+ *
+ * @details
+ *  Cada frame mapeo el buffer con `WRITE_DISCARD` y dejo que `ParticleSystem` escriba
+ *  las instancias directo en esa memoria (sin copia intermedia). Luego dibujo todo con
+ *  un solo `DrawInstanced(4, n)`: el vertex shader arma el quad con `SV_VertexID` y lo
+ *  orienta a la cámara.
+ *
+ *  La mezcla es de alfa premultiplicado, así que los emisores aditivos (alfa 0) y los de
+ *  mezcla normal van en la misma llamada. No escribe profundidad.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "ShaderProgram.h"
+#include "Particles/ParticleSystem.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @struct CBParticles
+ * @brief Constant buffer del shader de partículas.
+ */
+struct
+  CBParticles {
+  XMMATRIX mViewProjection;
+  XMFLOAT4 vCameraRight;
+  XMFLOAT4 vCameraUp;
+};
+
+/**
+ * @class ParticleRenderer
+ * @brief Sube y dibuja las partículas de un `ParticleSystem`.
+ */
+class
+  ParticleRenderer {
+public:
+  ParticleRenderer() = default;
+  ~ParticleRenderer() = default;
+
+  /**
+   * @brief Creo el buffer de instancias, el shader y los estados.
+   *
+   * @param maxInstances  Partículas que caben por frame (las demás no se dibujan).
+   */
+  HRESULT
+    init(Device& device, unsigned int maxInstances);
+
+  /**
+   * @brief Escribo las instancias en el buffer mapeado y las dibujo.
+   *
+   * @details
+   *  Va después de los objetos opacos: usa el depth buffer que ya está vinculado
+   *  pero sin escribir en él.
+   */
+  void
+    render(DeviceContext& deviceContext,
+           const ParticleSystem& particles,
+           const XMMATRIX& view,
+           const XMMATRIX& projection);
+
+  /// @brief Instancias dibujadas en el último `render`.
+  unsigned int
+    getDrawnCount() const { return m_drawnCount; }
+
+  void
+    destroy();
+
+private:
+  unsigned int m_maxInstances = 0;
+  unsigned int m_drawnCount = 0;
+  ID3D11Buffer* m_instanceBuffer = nullptr;
+  ID3D11BlendState* m_blendState = nullptr;
+  ID3D11DepthStencilState* m_depthState = nullptr;
+  ID3D11RasterizerState* m_rasterizer = nullptr;
+  ShaderProgram m_shader;
+  Buffer m_cbParticles;
+  CBParticles m_params;
+};
@@ -0,0 +1,285 @@
+/**
+ * @file ParticleSystem.h
+ * @brief Aquí defino el sistema de partículas de CPU (datos en SoA y simulación con SSE).
+ *
+ * @details
+ *  Cada emisor guarda sus partículas en arreglos separados por campo (posición,
+ *  velocidad, edad, vida) partidos en bloques fijos de `kParticleBlockSize`. Por frame:
+ *
+ *  1. **Spawn:** cada emisor acumula `spawnRate * dt` y llena los huecos de sus bloques.
+ *  2. **Simulación:** reparto los bloques entre los hilos del JobSystem. El kernel avanza
+ *     4 partículas a la vez con SSE: gravedad, arrastre, integración, choque contra
+ *     planos y edad. Las que mueren se compactan dentro de su mismo bloque, así que no
+ *     hay listas libres ni pasadas globales.
+ *  3. **Orden:** solo si algún emisor vivo es de mezcla alfa. Armo las instancias en
+ *     orden de bloques, cuantizo la profundidad a 16 bits dentro del rango del frame,
+ *     reviso si ya venía ordenado y si no hago un radix sort de 2 pasadas de 8 bits
+ *     (saltando la pasada si todos caen en el mismo dígito).
+ *  4. **Salida:** `writeInstances` escribe directo en la memoria que le pasen (el buffer
+ *     dinámico mapeado de `ParticleRenderer`), con el tamaño y color ya interpolados.
+ *     Si hubo orden solo copia instancias de 20 bytes en el orden final, en lugar de
+ *     saltar entre los arreglos SoA de todos los emisores.
+ *
+ *  Todo se dibuja con una sola mezcla de alfa premultiplicado: los emisores aditivos
+ *  escriben alfa 0 y no necesitan orden.
+ *
+ *  No toca D3D, así que se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class BenchmarkReport;
+class StateHasher;
+
+/// @brief Partículas por bloque (múltiplo de 4 para el kernel SSE).
+const unsigned int kParticleBlockSize = 4096;
+
+/// @brief Máximo de planos de colisión.
+const unsigned int kMaxParticlePlanes = 8;
+
+/**
+ * @struct ParticleInstance
+ * @brief Lo que lee el vertex shader por partícula (20 bytes, una instancia por quad).
+ */
+struct
+  ParticleInstance {
+  XMFLOAT3 position;
+  float size;
+  /// @brief RGBA8 con alfa premultiplicado (R en el byte bajo).
+  unsigned int color;
+};
+
+/**
+ * @struct ParticleEmitterSettings
+ * @brief Parámetros de un emisor.
+ */
+struct
+  ParticleEmitterSettings {
+  XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  /// @brief Dirección central de salida y apertura del cono (radianes).
+  XMFLOAT3 direction = XMFLOAT3(0.0f, 1.0f, 0.0f);
+  float spread = 0.4f;
+  float speedMin = 2.0f;
+  float speedMax = 5.0f;
+  float lifetimeMin = 1.5f;
+  float lifetimeMax = 3.0f;
+  /// @brief Partículas por segundo.
+  float spawnRate = 500.0f;
+  unsigned int maxParticles = 16384;
+  float startSize = 0.2f;
+  float endSize = 0.05f;
+  XMFLOAT4 startColor = XMFLOAT4(1.0f, 0.8f, 0.4f, 1.0f);
+  XMFLOAT4 endColor = XMFLOAT4(0.6f, 0.1f, 0.0f, 0.0f);
+  /// @brief Aditivo: no depende del orden, no obliga a ordenar.
+  bool additive = true;
+};
+
+/**
+ * @struct ParticleStats
+ * @brief Números del último `update`.
+ */
+struct
+  ParticleStats {
+  unsigned int alive = 0;
+  unsigned int spawned = 0;
+  unsigned int died = 0;
+  /// @brief Partículas ordenadas este frame (0 si no hizo falta).
+  unsigned int sorted = 0;
+  /// @brief Pasadas de radix que sí movieron datos.
+  unsigned int radixPasses = 0;
+  double spawnMs = 0.0;
+  double simulateMs = 0.0;
+  double sortMs = 0.0;
+};
+
+/**
+ * @class ParticleSystem
+ * @brief Emisores de partículas simulados en CPU con SSE y varios hilos.
+ */
+class
+  ParticleSystem {
+public:
+  ParticleSystem() = default;
+  ~ParticleSystem() = default;
+
+  /**
+   * @brief Agrego un emisor y reservo sus bloques.
+   * @return Índice del emisor.
+   */
+  unsigned int
+    addEmitter(const ParticleEmitterSettings& settings);
+
+  unsigned int
+    getNumEmitters() const { return static_cast<unsigned int>(m_emitters.size()); }
+
+  /**
+   * @brief Settings del emisor (se pueden cambiar entre frames, menos `maxParticles`).
+   */
+  ParticleEmitterSettings&
+    getEmitterSettings(unsigned int emitter) { return m_emitters[emitter].settings; }
+
+  /**
+   * @brief Lanzo `count` partículas de golpe (hasta llenar el emisor).
+   */
+  void
+    burst(unsigned int emitter, unsigned int count);
+
+  void
+    setGravity(const XMFLOAT3& gravity) { m_gravity = gravity; }
+
+  /// @brief Arrastre lineal: la velocidad pierde `drag * dt` de sí misma por frame.
+  void
+    setDrag(float drag) { m_drag = drag; }
+
+  /**
+   * @brief Agrego un plano de colisión `n·p + d = 0` (normal hacia el lado libre).
+   */
+  void
+    addCollisionPlane(const XMFLOAT4& plane, float restitution);
+
+  void
+    clearCollisionPlanes() { m_numPlanes = 0; }
+
+  /**
+   * @brief Spawn, simulación y (si hace falta) orden de atrás hacia adelante.
+   *
+   * @param deltaTime  Segundos del frame.
+   * @param eye        Posición de la cámara.
+   * @param forward    Dirección de la cámara (para la profundidad del orden).
+   */
+  void
+    update(float deltaTime, const XMFLOAT3& eye, const XMFLOAT3& forward);
+
+  /**
+   * @brief Solo spawn y simulación (un paso fijo); el orden va aparte en `sortByDepth`.
+   */
+  void
+    simulate(float deltaTime);
+
+  /**
+   * @brief Calculo llaves de profundidad y ordeno de atrás hacia adelante si hace falta.
+   *
+   * @details Es de presentación: basta una vez por frame aunque haya varios pasos.
+   */
+  void
+    sortByDepth(const XMFLOAT3& eye, const XMFLOAT3& forward);
+
+  /**
+   * @brief Meto al hash todo el estado simulado (partículas vivas y generadores).
+   */
+  void
+    hashState(StateHasher& hasher) const;
+
+  /**
+   * @brief Escribo las instancias vivas (ordenadas si tocó) en `output`.
+   *
+   * @return Número de instancias escritas (como mucho `capacity`).
+   */
+  unsigned int
+    writeInstances(ParticleInstance* output, unsigned int capacity) const;
+
+  unsigned int
+    getAliveCount() const;
+
+  const ParticleStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: 1M partículas con colisión, orden y escritura de instancias.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Partículas de un emisor en SoA; el bloque `b` ocupa `[b * kParticleBlockSize, ...)`.
+   */
+  struct
+    Emitter {
+    ParticleEmitterSettings settings;
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> velocityZ;
+    std::vector<float> age;
+    std::vector<float> lifetime;
+    /// @brief Partículas vivas al inicio de cada bloque.
+    std::vector<unsigned int> blockCount;
+    float spawnAccumulator = 0.0f;
+    unsigned int random = 1u;
+  };
+
+  /**
+   * @brief Un bloque con trabajo para el kernel.
+   */
+  struct
+    BlockJob {
+    unsigned int emitter;
+    unsigned int block;
+  };
+
+  /**
+   * @brief Creo `count` partículas nuevas en los huecos del emisor.
+   * @return Cuántas cupieron.
+   */
+  unsigned int
+    spawn(Emitter& emitter, unsigned int count);
+
+  /**
+   * @brief Kernel SSE de un bloque: fuerzas, integración, colisión, edad y compactado.
+   * @return Partículas que murieron.
+   */
+  unsigned int
+    simulateBlock(Emitter& emitter, unsigned int block, float deltaTime);
+
+  /**
+   * @brief El mismo kernel en escalar; lo uso para verificar el SSE.
+   */
+  unsigned int
+    simulateBlockReference(Emitter& emitter, unsigned int block, float deltaTime);
+
+  /**
+   * @brief Radix sort LSD de `m_sortKeys` / `m_sortOrder`, repartido entre hilos.
+   */
+  void
+    radixSort();
+
+  /**
+   * @brief Escribo las primeras `count` partículas de un bloque, 4 a la vez con SSE.
+   */
+  static void
+    writeBlock(const Emitter& emitter, unsigned int block, unsigned int count, ParticleInstance* output);
+
+  /**
+   * @brief Bloques no vacíos y el offset de salida de cada uno.
+   */
+  void
+    buildBlockJobs();
+
+private:
+  std::vector<Emitter> m_emitters;
+  XMFLOAT3 m_gravity = XMFLOAT3(0.0f, -9.8f, 0.0f);
+  float m_drag = 0.1f;
+  XMFLOAT4 m_planes[kMaxParticlePlanes];
+  float m_restitution[kMaxParticlePlanes];
+  unsigned int m_numPlanes = 0;
+
+  std::vector<BlockJob> m_jobs;
+  std::vector<unsigned int> m_jobOffset;
+
+  /// @brief Instancias en orden de bloques; `m_sortOrder` indexa aquí. Solo si se ordenó.
+  std::vector<ParticleInstance> m_sortInstances;
+  std::vector<unsigned int> m_sortOrder;
+  std::vector<uint16_t> m_sortKeys;
+  std::vector<unsigned int> m_sortOrderScratch;
+  std::vector<uint16_t> m_sortKeysScratch;
+  /// @brief Cuantización de la profundidad: `key = (maxDepth - depth) * scale`.
+  float m_sortMaxDepth = 0.0f;
+  float m_sortScale = 0.0f;
+  bool m_sorted = false;
+
+  ParticleStats m_stats;
+};
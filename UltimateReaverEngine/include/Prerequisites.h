@@ -4,6 +4,10 @@
 #include <string>
 #include <sstream>
 #include <vector>
+// Sin las macros min/max de windows.h, para poder usar std::min/std::max
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <windows.h>
 #include <xnamath.h>
 #include <thread>
@@ -11,6 +15,7 @@
 #include <memory>
 #include <unordered_map>
 #include <type_traits>
+#include <algorithm>
 
 // Librerias DirectX
 #include <d3d11.h>
@@ -76,13 +81,29 @@
  * @struct SimpleVertex
  * @brief Defines the vertex structure for simple geometry.
  *
- * Contains position and texture coordinates, which is a common layout
- * for textured models.
+ * Contains position, texture coordinates and the tangent frame used by
+ * normal maps. The tangent is MikkTSpace-compatible (see TangentSpace.h):
+ * w holds the handedness and bitangent = w * cross(Normal, Tangent.xyz).
  */
 struct
   SimpleVertex {
   XMFLOAT3 Pos;
   XMFLOAT2 Tex;
+  XMFLOAT3 Normal;
+  XMFLOAT4 Tangent;
+};
+
+/**
+ * @struct SkinInfluence
+ * @brief Per-vertex skinning data: up to four bone influences.
+ *
+ * Weights are normalized so they add up to 1. Unused slots have weight 0
+ * and bone index 0, so they can be processed without branches.
+ */
+struct
+  SkinInfluence {
+  unsigned short BoneIndex[4];
+  float Weight[4];
 };
 
 /**
@@ -112,12 +133,40 @@ struct
  * @struct CBChangesEveryFrame
  * @brief Constant buffer for data that is updated for each object drawn in a frame.
  *
- * Holds per-object data like the world matrix and material color.
+ * Holds per-object data like the world matrix, material color and material index.
  */
 struct
   CBChangesEveryFrame {
   XMMATRIX mWorld;
   XMFLOAT4 vMeshColor;
+  unsigned int vMaterial[4];   ///< material index in cbMaterials, 1 if it has one, unused, unused
+};
+
+/**
+ * @struct CBLightClusters
+ * @brief Constant buffer describing the clustered light grid for the pixel shader.
+ *
+ * A pixel finds its cluster with `tile = SV_Position.xy / vTileSize` and
+ * `slice = floor(log(viewZ) * vDepthParams.x + vDepthParams.y)`.
+ */
+struct
+  CBLightClusters {
+  unsigned int vGridSize[4];   ///< tilesX, tilesY, slicesZ, light count
+  XMFLOAT4 vDepthParams;       ///< slice scale, slice bias, unused, unused
+  XMFLOAT4 vTileSize;          ///< tile width and height in pixels, unused, unused
+};
+
+/**
+ * @struct CBShadowCascades
+ * @brief Constant buffer with the cascaded shadow map matrices for the pixel shader.
+ *
+ * A pixel picks the first cascade whose split distance is beyond its view depth.
+ */
+struct
+  CBShadowCascades {
+  XMMATRIX mCascadeViewProj[4]; ///< light view * projection per cascade (transposed)
+  XMFLOAT4 vSplitFar;           ///< far split distance per cascade
+  XMFLOAT4 vTexelSize;          ///< world-space texel size per cascade
 };
 
 /**
@@ -160,5 +209,7 @@ enum
   NONE = 0,      ///< No component.
   TRANSFORM = 1, ///< Transform component (position, rotation, scale).
   MESH = 2,      ///< Mesh component (geometry data).
-  MATERIAL = 3   ///< Material component (visual appearance).
+  MATERIAL = 3,  ///< Material component (visual appearance).
+  ANIMATOR = 4,  ///< Animator component (skeletal animation and skinning).
+  CAMERA = 5     ///< Camera component (view, projection and viewport).
 };
\ No newline at end of file
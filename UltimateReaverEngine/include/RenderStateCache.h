@@ -0,0 +1,254 @@
+/**
+ * @file RenderStateCache.h
+ * @brief Aquí defino la caché de objetos de estado de la GPU (samplers, rasterizer, blend, depth).
+ *
+ * @details
+ *  Cada `SamplerState` y cada renderer creaba sus propios estados aunque fueran idénticos.
+ *  Con la caché, un estado se crea una sola vez por descriptor y todos lo comparten:
+ *  - **Llave:** el descriptor de D3D11 normalizado (campos que D3D ignora puestos a su
+ *    default y el padding en cero) y su hash. Dos descriptores que dan el mismo estado
+ *    caen en el mismo objeto.
+ *  - **Conteo de referencias:** `acquire*` suma una referencia y `release` la quita; el
+ *    objeto se libera cuando nadie lo usa.
+ *  - **Estadísticas:** pedidos, aciertos, objetos creados y vivos por tipo.
+ *
+ *  Quién crea los objetos lo decide un `RenderStateBackend`: el de D3D11 usa el `Device`
+ *  y el nulo regresa handles falsos, así la parte de hash y deduplicado se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <mutex>
+
+class Device;
+class BenchmarkReport;
+
+/**
+ * @enum RenderStateType
+ * @brief Tipos de objeto de estado que maneja la caché.
+ */
+enum RenderStateType {
+  RENDER_STATE_SAMPLER = 0,
+  RENDER_STATE_RASTERIZER,
+  RENDER_STATE_BLEND,
+  RENDER_STATE_DEPTH_STENCIL,
+  RENDER_STATE_COUNT
+};
+
+/**
+ * @struct RenderStateStats
+ * @brief Números de un tipo de estado.
+ */
+struct
+  RenderStateStats {
+  /// @brief Llamadas a `acquire`.
+  unsigned long long requests = 0;
+  /// @brief Pedidos que encontraron el estado ya creado.
+  unsigned long long hits = 0;
+  /// @brief Objetos que se crearon en el backend.
+  unsigned long long creations = 0;
+  /// @brief Objetos que se liberaron en el backend.
+  unsigned long long destructions = 0;
+  /// @brief Objetos vivos ahora.
+  unsigned int live = 0;
+  /// @brief Referencias vivas ahora (suma de todos los objetos).
+  unsigned int references = 0;
+};
+
+/**
+ * @class RenderStateBackend
+ * @brief Crea y libera los objetos de estado; la caché no sabe de D3D.
+ */
+class
+  RenderStateBackend {
+public:
+  virtual
+    ~RenderStateBackend() = default;
+
+  /**
+   * @param desc   Descriptor de D3D11 del tipo (`D3D11_SAMPLER_DESC`, etc.), ya normalizado.
+   * @param state  Objeto creado.
+   */
+  virtual HRESULT
+    createState(RenderStateType type, const void* desc, void** state) = 0;
+
+  virtual void
+    releaseState(RenderStateType type, void* state) = 0;
+};
+
+/**
+ * @class D3D11RenderStateBackend
+ * @brief Backend real: crea los estados con el `ID3D11Device`.
+ */
+class
+  D3D11RenderStateBackend : public RenderStateBackend {
+public:
+  explicit
+    D3D11RenderStateBackend(Device* device = nullptr) : m_device(device) {}
+
+  HRESULT
+    createState(RenderStateType type, const void* desc, void** state) override;
+
+  void
+    releaseState(RenderStateType type, void* state) override;
+
+private:
+  Device* m_device;
+};
+
+/**
+ * @class NullRenderStateBackend
+ * @brief Backend sin GPU: regresa handles falsos (nunca se desreferencian) y cuenta.
+ */
+class
+  NullRenderStateBackend : public RenderStateBackend {
+public:
+  HRESULT
+    createState(RenderStateType type, const void* desc, void** state) override;
+
+  void
+    releaseState(RenderStateType type, void* state) override;
+
+  unsigned int
+    getNumLive() const { return m_live; }
+
+  unsigned int
+    getNumCreated() const { return m_created; }
+
+private:
+  uintptr_t m_next = 0;
+  unsigned int m_live = 0;
+  unsigned int m_created = 0;
+};
+
+/**
+ * @class RenderStateCache
+ * @brief Estados de GPU compartidos por descriptor, con conteo de referencias.
+ *
+ * @details
+ *  El motor usa la instancia global (`getInstance`), que `BaseApp` conecta al backend de
+ *  D3D11 después de crear el device. Se puede tener una caché propia (por ejemplo con
+ *  el backend nulo en el benchmark). Es segura entre hilos.
+ */
+class
+  RenderStateCache {
+public:
+  RenderStateCache() = default;
+  ~RenderStateCache() = default;
+
+  RenderStateCache(const RenderStateCache&) = delete;
+  RenderStateCache&
+    operator=(const RenderStateCache&) = delete;
+
+  static RenderStateCache&
+    getInstance() {
+    static RenderStateCache instance;
+    return instance;
+  }
+
+  /**
+   * @brief Conecto el backend (no me adueño de él).
+   */
+  void
+    init(RenderStateBackend* backend);
+
+  /**
+   * @brief Libero todos los estados, aunque alguien siga teniendo referencias, y suelto el backend.
+   *
+   * @return Estados que seguían referenciados (fugas de quien no llamó a `release`).
+   */
+  unsigned int
+    destroy();
+
+  bool
+    isReady() const { return m_backend != nullptr; }
+
+  ID3D11SamplerState*
+    acquireSampler(const D3D11_SAMPLER_DESC& desc);
+
+  ID3D11RasterizerState*
+    acquireRasterizer(const D3D11_RASTERIZER_DESC& desc);
+
+  ID3D11BlendState*
+    acquireBlend(const D3D11_BLEND_DESC& desc);
+
+  ID3D11DepthStencilState*
+    acquireDepthStencil(const D3D11_DEPTH_STENCIL_DESC& desc);
+
+  /**
+   * @brief Quito una referencia; con la última libero el objeto. nullptr no hace nada.
+   */
+  void
+    release(const void* state);
+
+  RenderStateStats
+    getStats(RenderStateType type) const;
+
+  /// @brief Objetos vivos de todos los tipos.
+  unsigned int
+    getNumStates() const;
+
+  /**
+   * @brief Benchmark headless con el backend nulo: 10k actores pidiendo sus estados.
+   *
+   * @details Verifica que descriptores equivalentes compartan objeto, que los distintos
+   *          no, y que el conteo de referencias libere justo con la última.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @union StateDesc
+   * @brief Descriptor normalizado de cualquier tipo (lo que no usa el tipo queda en cero).
+   */
+  union
+    StateDesc {
+    D3D11_SAMPLER_DESC sampler;
+    D3D11_RASTERIZER_DESC rasterizer;
+    D3D11_BLEND_DESC blend;
+    D3D11_DEPTH_STENCIL_DESC depthStencil;
+  };
+
+  /**
+   * @struct Entry
+   * @brief Un objeto de estado creado, su descriptor y sus referencias.
+   */
+  struct
+    Entry {
+    RenderStateType type = RENDER_STATE_SAMPLER;
+    StateDesc desc;
+    unsigned long long hash = 0;
+    void* state = nullptr;
+    unsigned int references = 0;
+  };
+
+  static void
+    normalize(const D3D11_SAMPLER_DESC& in, StateDesc& out);
+
+  static void
+    normalize(const D3D11_RASTERIZER_DESC& in, StateDesc& out);
+
+  static void
+    normalize(const D3D11_BLEND_DESC& in, StateDesc& out);
+
+  static void
+    normalize(const D3D11_DEPTH_STENCIL_DESC& in, StateDesc& out);
+
+  /// @brief FNV-1a del tipo y los bytes del descriptor normalizado.
+  static unsigned long long
+    hashDesc(RenderStateType type, const StateDesc& desc);
+
+  void*
+    acquire(RenderStateType type, const StateDesc& desc);
+
+private:
+  RenderStateBackend* m_backend = nullptr;
+  mutable std::mutex m_mutex;
+  std::vector<Entry> m_entries;
+  /// @brief Entradas libres de `m_entries` para reusar.
+  std::vector<unsigned int> m_freeEntries;
+  std::unordered_multimap<unsigned long long, unsigned int> m_byHash;
+  std::unordered_map<const void*, unsigned int> m_byState;
+  RenderStateStats m_stats[RENDER_STATE_COUNT];
+};
@@ -59,6 +59,16 @@ public:
   HRESULT
     init(Device& device);
 
+  /**
+   * @brief Inicializo el sampler con un descriptor propio.
+   *
+   * @details
+   *  El objeto sale de `RenderStateCache`: si otro ya pidi un sampler equivalente, lo
+   *  comparto en lugar de crear otro.
+   */
+  HRESULT
+    init(Device& device, const D3D11_SAMPLER_DESC& desc);
+
   /**
    * @brief Actualizo el estado del sampler.
    *
@@ -90,7 +100,8 @@ public:
    *
    * @details
    *  Cuando ya no lo necesito, libero el objeto `m_sampler` para evitar fugas de memoria en la GPU.
-   *  Siempre llamo a esto antes de cerrar el motor o recargar recursos.
+   *  Siempre llamo a esto antes de cerrar el motor o recargar recursos. Como el objeto es
+   *  compartido, solo suelto mi referencia en la cach.
    */
   void
     destroy();
@@ -0,0 +1,127 @@
+/**
+ * @file SceneFile.h
+ * @brief Aquí defino la carga de un archivo de escena sin copias.
+ *
+ * @details
+ *  Dos formas de cargar, las dos terminan en el mismo blob relocalizado:
+ *  - **Lectura:** una sola lectura del archivo completo a memoria propia.
+ *  - **Mapeo:** mapeo el archivo copy-on-write; los fixups solo ensucian las páginas que
+ *    tienen punteros y el archivo en disco no se toca.
+ *
+ *  Antes de relocalizar valido la cabecera, que cada fixup caiga dentro del blob y apunte
+ *  dentro del blob, y recorro entidades, recursos y componentes: cada puntero tiene que
+ *  estar en la tabla de fixups y su arreglo caber en el blob. Un archivo truncado o
+ *  corrupto se rechaza sin tocar nada.
+ *  Después, entidades, componentes y strings se leen en su lugar.
+ *
+ *  Para poder hacer diff entre versiones de una escena la exporto a JSON.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Scene/SceneFormat.h"
+
+class BenchmarkReport;
+
+/**
+ * @class SceneFile
+ * @brief Escena cargada: el blob relocalizado y acceso directo a su contenido.
+ */
+class
+  SceneFile {
+public:
+  SceneFile() = default;
+  ~SceneFile() { unload(); }
+
+  SceneFile(const SceneFile&) = delete;
+  SceneFile&
+    operator=(const SceneFile&) = delete;
+
+  /**
+   * @brief Leo el archivo completo con una lectura y relocalizo.
+   */
+  HRESULT
+    load(const std::string& path);
+
+  /**
+   * @brief Mapeo el archivo (copy-on-write) y relocalizo en el lugar.
+   */
+  HRESULT
+    map(const std::string& path);
+
+  /**
+   * @brief Tomo un blob ya armado (por ejemplo de `SceneWriter::write`) y lo relocalizo.
+   */
+  HRESULT
+    loadFromMemory(const std::vector<unsigned char>& blob);
+
+  void
+    unload();
+
+  bool
+    isLoaded() const { return m_header != nullptr; }
+
+  unsigned int
+    getNumEntities() const { return m_header ? m_header->numEntities : 0; }
+
+  const SceneEntity&
+    getEntity(unsigned int index) const { return m_header->entities[index]; }
+
+  unsigned int
+    getNumResources() const { return m_header ? m_header->numResources : 0; }
+
+  const SceneResource&
+    getResource(unsigned int index) const { return m_header->resources[index]; }
+
+  /**
+   * @brief Datos del primer componente de ese tipo en la entidad (o nullptr).
+   *
+   * @param minSize  Bytes que necesita quien lo lee; si el componente trae menos, nullptr.
+   */
+  const void*
+    findComponent(const SceneEntity& entity, SceneComponentType type, unsigned int minSize) const;
+
+  /**
+   * @brief El `SceneAnimatorData` de la entidad (nullptr si no tiene o viene incompleto).
+   */
+  const SceneAnimatorData*
+    getAnimator(const SceneEntity& entity) const {
+    return static_cast<const SceneAnimatorData*>(findComponent(entity, SCENE_COMPONENT_ANIMATOR,
+                                                               sizeof(SceneAnimatorData)));
+  }
+
+  /// @brief Bytes del blob.
+  size_t
+    getSize() const { return m_size; }
+
+  /**
+   * @brief Exporto la escena como JSON (un campo por línea, para hacer diff).
+   */
+  void
+    exportJson(std::ostream& out) const;
+
+  HRESULT
+    exportJson(const std::string& path) const;
+
+  /**
+   * @brief Benchmark headless: guardar, cargar, mapear y exportar contra número de entidades.
+   *
+   * @details Verifica que lo cargado sea idéntico a lo escrito y que se rechacen archivos rotos.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /// @brief Valido y aplico los fixups sobre un blob en memoria escribible.
+  HRESULT
+    relocate(unsigned char* base, size_t size);
+
+private:
+  /// @brief Memoria propia (lectura); `unsigned long long` para alinear a 8.
+  std::vector<unsigned long long> m_storage;
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+  void* m_view = nullptr;
+  const SceneHeader* m_header = nullptr;
+  size_t m_size = 0;
+};
@@ -0,0 +1,154 @@
+/**
+ * @file SceneFormat.h
+ * @brief Aquí defino el layout binario de un archivo de escena.
+ *
+ * @details
+ *  El archivo es un blob relocalizable: todo lo que el motor lee al cargar (entidades,
+ *  recursos, componentes, strings) ya está en su forma final, y los "punteros" entre
+ *  partes se guardan como offsets desde el inicio del blob. Al final va una tabla de
+ *  fixups con la posición de cada uno de esos campos; cargar es leer (o mapear) el archivo
+ *  y sumarle la dirección base a cada campo de la tabla. Después de eso el blob se usa en
+ *  su lugar, sin parsear ni copiar nada.
+ *
+ *  Los punteros siempre ocupan 8 bytes (`BlobPtr`) para que el layout sea el mismo en
+ *  32 y 64 bits. El formato es little-endian, igual que todas las plataformas del motor.
+ *
+ *  Orden dentro del blob:
+ *  `SceneHeader | SceneEntity[] | SceneResource[] | SceneComponent[] | datos de componentes | strings | fixups`
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+
+/// @brief Índice de recurso vacío (entidad sin modelo o sin textura).
+const unsigned int kNoSceneResource = 0xFFFFFFFFu;
+
+/// @brief Versión actual del formato.
+const unsigned int kSceneVersion = 1;
+
+/// @brief Primeros bytes de todo archivo de escena.
+const char kSceneMagic[4] = { 'U', 'R', 'S', 'C' };
+
+/**
+ * @struct BlobPtr
+ * @brief Puntero dentro del blob: offset en el archivo, dirección real después de los fixups.
+ */
+template<typename T>
+struct
+  BlobPtr {
+  unsigned long long value = 0;
+
+  T*
+    get() const { return reinterpret_cast<T*>(static_cast<uintptr_t>(value)); }
+
+  T*
+    operator->() const { return get(); }
+
+  T&
+    operator[](size_t index) const { return get()[index]; }
+};
+
+/**
+ * @enum SceneResourceType
+ * @brief Qué tipo de archivo referencia un `SceneResource`.
+ */
+enum SceneResourceType {
+  SCENE_RESOURCE_MODEL,
+  SCENE_RESOURCE_TEXTURE
+};
+
+/**
+ * @enum SceneComponentType
+ * @brief Tipo de los datos de un `SceneComponent` (el Transform va en la entidad).
+ */
+enum SceneComponentType {
+  /// @brief `SceneAnimatorData`: clip del modelo que se reproduce.
+  SCENE_COMPONENT_ANIMATOR
+};
+
+/**
+ * @enum SceneEntityFlags
+ * @brief Bits de `SceneEntity::flags`.
+ */
+enum SceneEntityFlags {
+  SCENE_ENTITY_CAST_SHADOW = 1 << 0,
+  SCENE_ENTITY_STATIC_SHADOW = 1 << 1,
+  SCENE_ENTITY_OCCLUDER = 1 << 2,
+  SCENE_ENTITY_LIGHTMAPPED = 1 << 3
+};
+
+/**
+ * @struct SceneResource
+ * @brief Archivo que usan las entidades (se carga una vez aunque lo usen muchas).
+ */
+struct
+  SceneResource {
+  BlobPtr<const char> path;
+  unsigned int type;
+  /// @brief `ExtensionType` de las texturas (el path va sin extensión).
+  unsigned int extension;
+};
+
+/**
+ * @struct SceneAnimatorData
+ * @brief Datos de `SCENE_COMPONENT_ANIMATOR`.
+ */
+struct
+  SceneAnimatorData {
+  unsigned int clip;
+  unsigned int loop;
+  float speed;
+  unsigned int reserved;
+};
+
+/**
+ * @struct SceneComponent
+ * @brief Un componente de una entidad: tipo y sus datos tal cual.
+ */
+struct
+  SceneComponent {
+  unsigned int type;
+  unsigned int size;
+  BlobPtr<const unsigned char> data;
+};
+
+/**
+ * @struct SceneEntity
+ * @brief Un actor de la escena con su Transform, sus recursos y sus componentes.
+ */
+struct
+  SceneEntity {
+  BlobPtr<const char> name;
+  BlobPtr<const SceneComponent> components;
+  float position[3];
+  float rotation[3];
+  float scale[3];
+  unsigned int model;
+  unsigned int texture;
+  unsigned int flags;
+  unsigned int numComponents;
+  unsigned int reserved;
+};
+
+/**
+ * @struct SceneHeader
+ * @brief Inicio del blob.
+ */
+struct
+  SceneHeader {
+  char magic[4];
+  unsigned int version;
+  unsigned long long size;
+  BlobPtr<const SceneEntity> entities;
+  BlobPtr<const SceneResource> resources;
+  unsigned int numEntities;
+  unsigned int numResources;
+  /// @brief Offset de la tabla de fixups (offsets de 8 bytes, no se relocaliza).
+  unsigned long long fixupOffset;
+  unsigned int numFixups;
+  unsigned int reserved;
+};
+
+static_assert(sizeof(SceneEntity) == 72, "SceneEntity layout changed");
+static_assert(sizeof(SceneHeader) == 56, "SceneHeader layout changed");
@@ -0,0 +1,100 @@
+/**
+ * @file SceneWriter.h
+ * @brief Aquí defino el armado de un archivo de escena.
+ *
+ * @details
+ *  Voy juntando recursos, entidades y componentes, y `write` los acomoda en el layout de
+ *  `SceneFormat.h`, anotando en la tabla de fixups cada campo que es puntero.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Scene/SceneFormat.h"
+
+/**
+ * @class SceneWriter
+ * @brief Arma el blob de una escena y lo guarda.
+ */
+class
+  SceneWriter {
+public:
+  SceneWriter() = default;
+  ~SceneWriter() = default;
+
+  /**
+   * @brief Agrego un recurso (o regreso el que ya estaba con el mismo tipo y path).
+   *
+   * @param extension  `ExtensionType` de las texturas; se ignora en modelos.
+   */
+  unsigned int
+    addResource(SceneResourceType type, const std::string& path, unsigned int extension = 0);
+
+  /**
+   * @brief Agrego una entidad.
+   *
+   * @param model    Recurso del modelo (o `kNoSceneResource`).
+   * @param texture  Recurso de la textura (o `kNoSceneResource`).
+   * @param flags    Bits de `SceneEntityFlags`.
+   * @return Índice de la entidad.
+   */
+  unsigned int
+    addEntity(const std::string& name,
+              const float position[3],
+              const float rotation[3],
+              const float scale[3],
+              unsigned int model,
+              unsigned int texture,
+              unsigned int flags);
+
+  /**
+   * @brief Agrego un componente con sus datos a una entidad.
+   */
+  void
+    addComponent(unsigned int entity, SceneComponentType type, const void* data, unsigned int size);
+
+  /// @brief Atajo para `SCENE_COMPONENT_ANIMATOR`.
+  void
+    addAnimator(unsigned int entity, unsigned int clip, bool loop, float speed = 1.0f);
+
+  unsigned int
+    getNumEntities() const { return static_cast<unsigned int>(m_entities.size()); }
+
+  /**
+   * @brief Acomodo todo en el blob final (offsets y tabla de fixups incluidos).
+   */
+  void
+    write(std::vector<unsigned char>& blob) const;
+
+  /**
+   * @brief Escribo el blob en un archivo.
+   */
+  HRESULT
+    save(const std::string& path) const;
+
+  void
+    clear();
+
+private:
+  /**
+   * @struct PendingComponent
+   * @brief Componente en espera: su entidad y dónde están sus datos en `m_componentData`.
+   */
+  struct
+    PendingComponent {
+    unsigned int entity;
+    unsigned int type;
+    unsigned int offset;
+    unsigned int size;
+  };
+
+  std::vector<SceneEntity> m_entities;
+  /// @brief Nombre de cada entidad (offset en `m_strings`).
+  std::vector<unsigned int> m_entityNames;
+  std::vector<SceneResource> m_resources;
+  std::vector<unsigned int> m_resourcePaths;
+  std::unordered_map<std::string, unsigned int> m_resourceLookup;
+  std::vector<PendingComponent> m_components;
+  std::vector<unsigned char> m_componentData;
+  /// @brief Todos los strings con su '\0'.
+  std::vector<char> m_strings;
+};
@@ -0,0 +1,288 @@
+/**
+ * @file WorldPartition.h
+ * @brief Aquí defino la partición del mundo en celdas que se cargan y descargan según la cámara.
+ *
+ * @details
+ *  Cada entidad vive en la celda de la grilla (en XZ) que contiene su posición. La grilla
+ *  es dispersa: solo existen las celdas que tienen algo. Una celda necesita recursos
+ *  (mallas, texturas) que pueden compartir varias celdas; cada recurso lleva un conteo de
+ *  celdas que lo piden y se carga una sola vez.
+ *
+ *  Por frame (`update`):
+ *  1. **Terminados:** recojo los recursos que terminó el hilo de streaming. Una celda pasa
+ *     a cargada cuando tiene todos sus recursos, y sus entidades se reportan como activadas.
+ *  2. **Descarga con histéresis:** una celda se carga al entrar a `loadRadius` pero solo se
+ *     descarga al salir de `unloadRadius` (más grande), así la cámara que va y viene por un
+ *     borde no la carga y descarga cada frame.
+ *  3. **Carga por prioridad:** las celdas dentro de `loadRadius`, de la más cercana a la más
+ *     lejana, piden sus recursos mientras alcancen el presupuesto de I/O del frame, el de
+ *     cargas en vuelo y el de memoria. Si la memoria no alcanza, primero saco las celdas
+ *     cargadas que ya quedaron fuera de `loadRadius` (las más lejanas primero).
+ *
+ *  Cargar un recurso (leer y decodificar) pasa en un hilo propio de streaming, nunca en el
+ *  hilo del frame; descargarlo pasa en el hilo del frame. Qué significa cargar lo decide
+ *  quien usa la partición con `setLoader`.
+ *
+ *  No toca D3D, así que se prueba headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+class BenchmarkReport;
+
+/**
+ * @struct WorldPartitionSettings
+ * @brief Tamaño de celda, radios y presupuestos.
+ */
+struct
+  WorldPartitionSettings {
+  /// @brief Lado de una celda en metros (fijo después del primer `addEntity`).
+  float cellSize = 256.0f;
+  /// @brief Las celdas a menos de esta distancia de la cámara se cargan.
+  float loadRadius = 768.0f;
+  /// @brief Las celdas a más de esta distancia se descargan (>= `loadRadius`).
+  float unloadRadius = 1024.0f;
+  /// @brief Bytes máximos entre recursos residentes y en vuelo.
+  unsigned long long memoryBudget = 512ull << 20;
+  /// @brief Bytes máximos que se piden por frame (siempre sale al menos una celda).
+  unsigned long long ioBudgetPerFrame = 32ull << 20;
+  /// @brief Recursos máximos en la cola del hilo de streaming.
+  unsigned int maxLoadsInFlight = 32;
+};
+
+/**
+ * @enum CellState
+ * @brief Estado de una celda.
+ */
+enum CellState {
+  CELL_UNLOADED,
+  CELL_LOADING,
+  CELL_LOADED
+};
+
+/**
+ * @struct WorldPartitionStats
+ * @brief Números del último `update` y acumulados.
+ */
+struct
+  WorldPartitionStats {
+  unsigned int numCells = 0;
+  unsigned int loadedCells = 0;
+  unsigned int loadingCells = 0;
+  unsigned long long residentBytes = 0;
+  unsigned long long inFlightBytes = 0;
+  /// @brief Bytes pedidos en este frame.
+  unsigned long long issuedBytes = 0;
+  unsigned int issuedLoads = 0;
+  unsigned int completedLoads = 0;
+  /// @brief Celdas que se sacaron antes de tiempo por falta de memoria en este frame.
+  unsigned int evictions = 0;
+  /// @brief Celdas que querían cargarse y no cupieron en la memoria en este frame.
+  unsigned int budgetDeferrals = 0;
+  double updateMs = 0.0;
+
+  unsigned long long totalBytesStreamed = 0;
+  unsigned int totalCellLoads = 0;
+  unsigned int totalCellUnloads = 0;
+  unsigned int failedLoads = 0;
+};
+
+/**
+ * @class WorldPartition
+ * @brief Grilla de celdas con streaming asíncrono de sus recursos.
+ */
+class
+  WorldPartition {
+public:
+  /**
+   * @brief Carga o descarga de un recurso; regresa false si falló.
+   */
+  using ResourceFunc = std::function<bool(unsigned int resource)>;
+
+  WorldPartition() = default;
+  ~WorldPartition() { shutdown(); }
+
+  WorldPartition(const WorldPartition&) = delete;
+  WorldPartition&
+    operator=(const WorldPartition&) = delete;
+
+  void
+    setSettings(const WorldPartitionSettings& settings);
+
+  const WorldPartitionSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Qué hacer con los recursos.
+   *
+   * @param load    Corre en el hilo de streaming.
+   * @param unload  Corre en el hilo que llama a `update` / `shutdown`.
+   */
+  void
+    setLoader(const ResourceFunc& load, const ResourceFunc& unload);
+
+  /**
+   * @brief Registro un recurso con lo que ocupa en memoria.
+   */
+  unsigned int
+    addResource(unsigned long long bytes);
+
+  /**
+   * @brief Registro una entidad en la celda de su posición con los recursos que usa.
+   */
+  unsigned int
+    addEntity(const XMFLOAT3& position, const unsigned int* resources, unsigned int numResources);
+
+  /**
+   * @brief Paso de streaming para la posición de la cámara.
+   */
+  void
+    update(const XMFLOAT3& camera);
+
+  /**
+   * @brief Espero a que terminen las cargas en vuelo y las aplico (arranque, pantallas de carga).
+   */
+  void
+    flush();
+
+  /**
+   * @brief Detengo el hilo de streaming y descargo todo.
+   */
+  void
+    shutdown();
+
+  bool
+    isEntityLoaded(unsigned int entity) const { return m_cells[m_entityCell[entity]].state == CELL_LOADED; }
+
+  CellState
+    getCellState(const XMFLOAT3& position) const;
+
+  /// @brief Entidades cuya celda terminó de cargar en el último `update`/`flush`.
+  const std::vector<unsigned int>&
+    getActivatedEntities() const { return m_activated; }
+
+  /// @brief Entidades cuya celda se descargó en el último `update`.
+  const std::vector<unsigned int>&
+    getDeactivatedEntities() const { return m_deactivated; }
+
+  unsigned int
+    getNumEntities() const { return static_cast<unsigned int>(m_entityCell.size()); }
+
+  const WorldPartitionStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: vuelo por un mundo sintético de 10 km y cuento los tirones.
+   *
+   * @details Verifica la histéresis, el presupuesto de memoria y que las entidades
+   *          activadas coincidan con las celdas cargadas.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @struct Cell
+   * @brief Celda de la grilla con sus entidades y los recursos que necesitan (sin repetir).
+   */
+  struct
+    Cell {
+    int x = 0;
+    int z = 0;
+    CellState state = CELL_UNLOADED;
+    /// @brief Posición en `m_activeCells` (si no está descargada).
+    unsigned int activeIndex = 0;
+    std::vector<unsigned int> entities;
+    std::vector<unsigned int> resources;
+  };
+
+  /**
+   * @enum ResourceState
+   * @brief Estado de un recurso visto desde el hilo del frame.
+   */
+  enum ResourceState {
+    RESOURCE_NONE,
+    RESOURCE_PENDING,
+    RESOURCE_READY,
+    /// @brief La carga falló: la celda no lo espera, pero no ocupa memoria ni se descarga.
+    RESOURCE_FAILED
+  };
+
+  /**
+   * @struct Resource
+   * @brief Recurso registrado: tamaño, celdas que lo piden y estado.
+   */
+  struct
+    Resource {
+    unsigned long long bytes = 0;
+    unsigned int refs = 0;
+    ResourceState state = RESOURCE_NONE;
+  };
+
+  static unsigned long long
+    cellKey(int x, int z) {
+    return (static_cast<unsigned long long>(static_cast<unsigned int>(x)) << 32) | static_cast<unsigned int>(z);
+  }
+
+  /// @brief Distancia en XZ de la cámara al rectángulo de la celda.
+  float
+    cellDistance(const Cell& cell, const XMFLOAT3& camera) const;
+
+  void
+    startThread();
+
+  void
+    streamLoop();
+
+  /// @brief Aplico lo que terminó el hilo y paso a cargadas las celdas completas.
+  void
+    collectCompleted();
+
+  /// @brief Bytes nuevos que costaría cargar la celda (recursos que nadie tiene).
+  unsigned long long
+    missingBytes(const Cell& cell) const;
+
+  void
+    requestCell(unsigned int cell);
+
+  void
+    releaseCell(unsigned int cell);
+
+  void
+    releaseResource(unsigned int resource);
+
+  void
+    removeActive(unsigned int cell);
+
+private:
+  WorldPartitionSettings m_settings;
+  ResourceFunc m_load;
+  ResourceFunc m_unload;
+
+  std::vector<Cell> m_cells;
+  std::unordered_map<unsigned long long, unsigned int> m_cellLookup;
+  std::vector<Resource> m_resources;
+  std::vector<unsigned int> m_entityCell;
+  /// @brief Celdas cargando o cargadas.
+  std::vector<unsigned int> m_activeCells;
+
+  std::vector<unsigned int> m_activated;
+  std::vector<unsigned int> m_deactivated;
+  WorldPartitionStats m_stats;
+
+  // --- hilo de streaming ---
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wakeCondition;
+  std::condition_variable m_idleCondition;
+  std::deque<unsigned int> m_queue;
+  std::vector<unsigned int> m_completed;
+  std::vector<unsigned int> m_failed;
+  unsigned int m_busy = 0;
+  bool m_stop = false;
+};
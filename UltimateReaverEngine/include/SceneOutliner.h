@@ -0,0 +1,191 @@
+/**
+ * @file SceneOutliner.h
+ * @brief Aquí está la lógica del outliner de escena: tabla de nombres, búsqueda y selección.
+ *
+ * @details
+ *  El outliner tiene que aguantar escenas de 100k actores sin comerse el frame, así que
+ *  separo los datos de ImGui (que solo dibuja las filas visibles con `ImGuiListClipper`):
+ *  - **Tabla de nombres:** todos los nombres en minúsculas en un solo arreglo de chars con
+ *    sus offsets. Buscar es recorrer memoria contigua, sin tocar los actores.
+ *  - **Búsqueda incremental:** si el texto nuevo contiene al anterior (el caso normal al
+ *    escribir), solo reviso los que ya coincidían. El filtro avanza por bloques dentro de un
+ *    presupuesto de milisegundos por frame y sigue en el siguiente si no terminó.
+ *  - **Selección múltiple:** clic, ctrl (alternar) y shift (rango sobre la lista filtrada
+ *    desde el ancla). Los cambios de `Transform` se aplican en lote a toda la selección
+ *    repartida en el `JobSystem`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/Actor.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct TransformEdit
+ * @brief Un cambio relativo de `Transform` que se aplica igual a toda la selección.
+ */
+struct
+  TransformEdit {
+  EU::Vector3 translation = EU::Vector3(0.0f, 0.0f, 0.0f);
+  /// @brief En radianes, se suma a la rotación de cada actor.
+  EU::Vector3 rotation = EU::Vector3(0.0f, 0.0f, 0.0f);
+  /// @brief Factor por eje sobre la escala de cada actor.
+  EU::Vector3 scale = EU::Vector3(1.0f, 1.0f, 1.0f);
+};
+
+/**
+ * @class SceneOutliner
+ * @brief Índice de nombres, filtro y selección de los actores de la escena.
+ *
+ * @details Los actores se identifican por su índice en el arreglo de la escena (el mismo
+ *          que `BaseApp::m_actors`). Si cambia el número de actores hay que reconstruir.
+ */
+class
+  SceneOutliner {
+public:
+  static const unsigned int kInvalid = 0xFFFFFFFFu;
+
+  SceneOutliner() = default;
+  ~SceneOutliner() = default;
+
+  /**
+   * @brief Reconstruyo la tabla de nombres desde los actores (limpia selección y filtro).
+   */
+  void
+    build(const std::vector<EU::TSharedPointer<Actor>>& actors);
+
+  /**
+   * @brief Reconstruyo la tabla desde una lista de nombres (uno por entidad).
+   */
+  void
+    build(const std::vector<std::string>& names);
+
+  unsigned int
+    getNumEntries() const { return static_cast<unsigned int>(m_offsets.empty() ? 0 : m_offsets.size() - 1); }
+
+  /**
+   * @brief Cambio el texto de búsqueda (sin distinguir mayúsculas).
+   *
+   * @details No filtra nada aquí: solo decide de qué candidatos parte el filtro. El trabajo
+   *          lo hace `updateFilter`.
+   */
+  void
+    setQuery(const std::string& query);
+
+  const std::string&
+    getQuery() const { return m_query; }
+
+  /**
+   * @brief Avanzo el filtro hasta terminar o hasta gastar `budgetMs`.
+   *
+   * @return true si el filtro ya terminó.
+   */
+  bool
+    updateFilter(double budgetMs);
+
+  bool
+    isFilterComplete() const { return m_cursor >= m_candidates.size(); }
+
+  /// @brief Fracción de candidatos revisados (1 si ya terminó).
+  float
+    getFilterProgress() const;
+
+  /**
+   * @brief Entidades que coinciden hasta ahora, en orden de escena.
+   */
+  const std::vector<unsigned int>&
+    getResults() const { return m_results; }
+
+  /**
+   * @brief Contador que sube cada vez que cambian la tabla, los resultados o la selección.
+   *
+   * @details La UI retenida lo usa para saber si el outliner se tiene que volver a dibujar.
+   */
+  unsigned long long
+    getVersion() const { return m_version; }
+
+  /**
+   * @brief Clic sobre una fila.
+   *
+   * @param ctrl  Alterna la entidad sin tocar el resto.
+   * @param shift Selecciona el rango de la lista filtrada entre el ancla y la entidad.
+   */
+  void
+    click(unsigned int entity, bool ctrl, bool shift);
+
+  /**
+   * @brief Dejo seleccionada solo esta entidad (por ejemplo, desde el picking).
+   */
+  void
+    select(unsigned int entity);
+
+  /**
+   * @brief Selecciono todo lo que pasó el filtro.
+   */
+  void
+    selectResults();
+
+  void
+    clearSelection();
+
+  bool
+    isSelected(unsigned int entity) const { return entity < m_selected.size() && m_selected[entity] != 0; }
+
+  /**
+   * @brief Entidades seleccionadas en el orden en que se seleccionaron.
+   */
+  const std::vector<unsigned int>&
+    getSelection() const { return m_selection; }
+
+  /**
+   * @brief La última entidad seleccionada (la que muestra el inspector), o `kInvalid`.
+   */
+  unsigned int
+    getPrimary() const { return m_primary; }
+
+  /**
+   * @brief Aplico el cambio a los `Transform` de todos los seleccionados (en paralelo).
+   */
+  void
+    applyEdit(const std::vector<EU::TSharedPointer<Actor>>& actors, const TransformEdit& edit) const;
+
+  /**
+   * @brief Benchmark headless con 100k nombres.
+   *
+   * @details Mido lo que tarda construir la tabla, cada tecla de una búsqueda y el peor
+   *          frame del filtro con presupuesto; verifico contra una búsqueda por fuerza bruta,
+   *          la selección por rango y la edición en lote.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Si el nombre de la entidad contiene el texto de búsqueda.
+   */
+  bool
+    matches(unsigned int entity) const;
+
+  void
+    setPrimaryFromSelection();
+
+  /// @brief Nombres en minúsculas, uno tras otro.
+  std::vector<char> m_names;
+  /// @brief Inicio de cada nombre en `m_names` (uno extra al final).
+  std::vector<unsigned int> m_offsets;
+
+  std::string m_query;
+  /// @brief Entidades que todavía pueden coincidir, en orden de escena.
+  std::vector<unsigned int> m_candidates;
+  /// @brief Siguiente candidato por revisar.
+  size_t m_cursor = 0;
+  std::vector<unsigned int> m_results;
+
+  std::vector<unsigned char> m_selected;
+  std::vector<unsigned int> m_selection;
+  unsigned int m_anchor = kInvalid;
+  unsigned int m_primary = kInvalid;
+
+  unsigned long long m_version = 0;
+};
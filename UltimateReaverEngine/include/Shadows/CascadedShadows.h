@@ -0,0 +1,281 @@
+/**
+ * @file CascadedShadows.h
+ * @brief Aquí defino el ajuste de cascadas y el culling de casters para las sombras direccionales.
+ *
+ * @details
+ *  Esta es la parte de CPU del sistema de sombras (no toca D3D, se prueba headless):
+ *
+ *  - **Ajuste estable:** cada cascada envuelve su rebanada del frustum con una esfera,
+ *    que no cambia de tamaño al girar la cámara. El centro se ancla en espacio de luz
+ *    redondeado a texels, así que el shadow map no "nada" al moverse.
+ *  - **Anclaje con margen:** la esfera se agranda un poco y solo se vuelve a anclar
+ *    cuando la cámara se sale del margen. Mientras no se re-ancle, la matriz de la
+ *    cascada es idéntica frame a frame.
+ *  - **Caché de estáticos:** los casters estáticos se dibujan en una capa aparte que solo
+ *    se redibuja si la cascada se re-ancló, cambió la luz o cambió algún caster estático.
+ *    Cada frame solo se dibujan los dinámicos encima de una copia de esa capa.
+ *  - **Culling por cascada:** paso los casters a espacio de luz una vez (SoA) y pruebo
+ *    contra la caja de cada cascada con SSE, 4 casters a la vez.
+ *  - **Batches:** ordeno los casters visibles por geometría para que el renderer los
+ *    mande con `DrawIndexedInstanced`, una llamada por geometría.
+ *
+ *  Los casters que quedan entre la luz y la cascada no se recortan por el plano cercano:
+ *  el renderer desactiva el depth clip y se "aplastan" en profundidad 0.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "GeometryPool.h"
+
+class BenchmarkReport;
+class Buffer;
+
+/// @brief Máximo de cascadas (lo que cabe en el constant buffer de muestreo).
+const unsigned int kMaxShadowCascades = 4;
+
+/// @brief Máximo de instancias por llamada de dibujo (tamaño del arreglo de matrices en el shader).
+const unsigned int kMaxShadowInstances = 256;
+
+/**
+ * @struct ShadowGeometry
+ * @brief Lo que el renderer necesita para dibujar un caster; se usa también como llave de batch.
+ */
+struct
+  ShadowGeometry {
+  Buffer* vertexBuffer = nullptr;
+  Buffer* indexBuffer = nullptr;
+  /// @brief Si es válido, la geometría vive en el `GeometryPool` (los buffers se resuelven al dibujar).
+  GeometryHandle pooled;
+  unsigned int indexCount = 0;
+  DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+};
+
+/**
+ * @struct ShadowCaster
+ * @brief Un objeto que proyecta sombra: esfera envolvente en mundo, matriz y geometría.
+ */
+struct
+  ShadowCaster {
+  XMFLOAT3 center;
+  float radius;
+  /// @brief Matriz de mundo (vectores fila, sin transponer).
+  XMFLOAT4X4 world;
+  const ShadowGeometry* geometry;
+  bool isStatic;
+};
+
+/**
+ * @struct ShadowDrawBatch
+ * @brief Casters con la misma geometría dentro de una cascada (una llamada instanciada).
+ */
+struct
+  ShadowDrawBatch {
+  const ShadowGeometry* geometry;
+  /// @brief Rango en la lista de casters de la capa (`staticCasters` o `dynamicCasters`).
+  unsigned int first;
+  unsigned int count;
+};
+
+/**
+ * @struct CascadedShadowSettings
+ * @brief Parámetros de las cascadas.
+ */
+struct
+  CascadedShadowSettings {
+  unsigned int numCascades = 4;
+  unsigned int resolution = 2048;
+  /// @brief Hasta dónde hay sombras (se recorta al far de la cámara).
+  float shadowDistance = 100.0f;
+  /// @brief Mezcla entre particiones logarítmicas (1) y uniformes (0).
+  float splitLambda = 0.8f;
+  /// @brief Cuánto se puede mover la rebanada (fracción del radio) antes de re-anclar.
+  float cacheMargin = 0.15f;
+  /// @brief Si es false, los estáticos se redibujan cada frame (para comparar).
+  bool cacheStatic = true;
+};
+
+/**
+ * @struct ShadowCascadeStats
+ * @brief Números de una cascada en el último `update` (más lo que llene el renderer).
+ */
+struct
+  ShadowCascadeStats {
+  unsigned int staticCasters = 0;
+  unsigned int dynamicCasters = 0;
+  /// @brief Llamadas de dibujo emitidas este frame (0 estáticas si la caché sirvió).
+  unsigned int staticDraws = 0;
+  unsigned int dynamicDraws = 0;
+  bool staticRedrawn = false;
+  double cullMs = 0.0;
+  /// @brief Tiempo de CPU del renderer para emitir la cascada.
+  double submitMs = 0.0;
+};
+
+/**
+ * @struct ShadowCascade
+ * @brief Una cascada ya ajustada, con sus listas de casters.
+ */
+struct
+  ShadowCascade {
+  float splitNear = 0.0f;
+  float splitFar = 0.0f;
+  /// @brief Radio de la esfera (ya con margen) y tamaño de texel en mundo.
+  float radius = 0.0f;
+  float texelSize = 0.0f;
+  /// @brief Centro anclado en espacio de luz.
+  float anchor[3] = { 0.0f, 0.0f, 0.0f };
+  bool anchored = false;
+  /// @brief La capa estática se tiene que redibujar este frame.
+  bool staticDirty = true;
+
+  XMFLOAT4X4 projection;
+  XMFLOAT4X4 viewProjection;
+
+  /// @brief Índices a la lista de casters, ordenados por geometría.
+  std::vector<unsigned int> staticCasters;
+  std::vector<unsigned int> dynamicCasters;
+  std::vector<ShadowDrawBatch> staticBatches;
+  std::vector<ShadowDrawBatch> dynamicBatches;
+
+  ShadowCascadeStats stats;
+};
+
+/**
+ * @class CascadedShadows
+ * @brief Ajusta las cascadas de una luz direccional y decide qué se dibuja en cada una.
+ */
+class
+  CascadedShadows {
+public:
+  CascadedShadows() = default;
+  ~CascadedShadows() = default;
+
+  void
+    setSettings(const CascadedShadowSettings& settings);
+
+  const CascadedShadowSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Dirección hacia donde viaja la luz (se normaliza). Cambiarla invalida la caché.
+   */
+  void
+    setLightDirection(const XMFLOAT3& direction);
+
+  /**
+   * @brief Fuerzo que todas las capas estáticas se redibujen el siguiente frame.
+   */
+  void
+    invalidateStatic();
+
+  /**
+   * @brief Ajusto las cascadas a la cámara y hago el culling de casters.
+   *
+   * @param view     Matriz de vista de la cámara (vectores fila).
+   * @param fovY     Campo de visión vertical.
+   * @param aspect   Ancho / alto.
+   * @param nearZ    Plano cercano de la cámara.
+   * @param farZ     Plano lejano de la cámara.
+   * @param casters  Casters de la escena (los índices de las cascadas apuntan aquí).
+   *
+   * @details
+   *  Detecto cambios en los casters estáticos con un hash de sus datos, así que la
+   *  escena no tiene que avisar cuando mueve algo estático.
+   */
+  void
+    update(const XMFLOAT4X4& view,
+           float fovY,
+           float aspect,
+           float nearZ,
+           float farZ,
+           const std::vector<ShadowCaster>& casters);
+
+  /**
+   * @brief El renderer avisa que ya redibujó la capa estática de una cascada.
+   */
+  void
+    markStaticDrawn(unsigned int cascade) { m_cascades[cascade].staticDirty = false; }
+
+  unsigned int
+    getNumCascades() const { return m_settings.numCascades; }
+
+  ShadowCascade&
+    getCascade(unsigned int index) { return m_cascades[index]; }
+
+  const ShadowCascade&
+    getCascade(unsigned int index) const { return m_cascades[index]; }
+
+  /**
+   * @brief Vista de la luz (compartida por todas las cascadas).
+   */
+  const XMFLOAT4X4&
+    getLightView() const { return m_lightView; }
+
+  /**
+   * @brief Tiempo total del último `update` (ajuste + culling + batches).
+   */
+  double
+    getUpdateMs() const { return m_updateMs; }
+
+  /**
+   * @brief Benchmark headless: ciudad con 20k casters y una cámara recorriéndola.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Esfera que envuelve la rebanada [nearZ, farZ] del frustum (centro en espacio de vista).
+   */
+  void
+    fitSlice(float nearZ, float farZ, float tanX, float tanY, float& centerZ, float& radius) const;
+
+  /**
+   * @brief Casters de una capa en espacio de luz (SoA, rellenado a múltiplo de 4).
+   */
+  struct
+    CasterLayer {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+    std::vector<unsigned int> index;
+  };
+
+  /**
+   * @brief Paso todos los casters a espacio de luz y separo estáticos de dinámicos.
+   */
+  void
+    prepareCasters(const std::vector<ShadowCaster>& casters);
+
+  /**
+   * @brief Pruebo una capa de casters contra la caja de la cascada (SSE).
+   */
+  void
+    cullLayer(const ShadowCascade& cascade,
+              const CasterLayer& layer,
+              std::vector<unsigned int>& output) const;
+
+  /**
+   * @brief Ordeno por geometría y armo los batches de una lista.
+   */
+  static void
+    buildBatches(const std::vector<ShadowCaster>& casters,
+                 std::vector<unsigned int>& list,
+                 std::vector<ShadowDrawBatch>& batches);
+
+private:
+  CascadedShadowSettings m_settings;
+  float m_lightDir[3] = { 0.3f, -0.8f, 0.5f };
+  float m_lightRight[3] = { 1.0f, 0.0f, 0.0f };
+  float m_lightUp[3] = { 0.0f, 1.0f, 0.0f };
+  XMFLOAT4X4 m_lightView;
+  bool m_lightChanged = true;
+  double m_updateMs = 0.0;
+
+  ShadowCascade m_cascades[kMaxShadowCascades];
+
+  CasterLayer m_staticLayer;
+  CasterLayer m_dynamicLayer;
+  uint64_t m_staticHash = 0;
+};
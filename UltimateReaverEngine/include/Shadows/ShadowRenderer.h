@@ -0,0 +1,114 @@
+/**
+ * @file ShadowRenderer.h
+ * @brief Aquí defino el renderer del shadow pass para las cascadas de `CascadedShadows`.
+ *
+ * @details
+ *  Uso un solo Texture2DArray de profundidad con `2 * numCascades` capas:
+ *  las primeras `numCascades` son las que lee el pixel shader y las siguientes guardan
+ *  la caché de casters estáticos. Por cascada hago:
+ *
+ *  1. Si la capa estática está sucia, la limpio y dibujo los estáticos ahí.
+ *  2. Copio la capa estática a la final (`CopySubresourceRegion`, sin pasar por el CPU).
+ *  3. Dibujo los dinámicos encima.
+ *
+ *  Cada batch es un `DrawIndexedInstanced` con hasta `kMaxShadowInstances` matrices de
+ *  mundo en un constant buffer que el vertex shader indexa con `SV_InstanceID`.
+ *  El depth clip está desactivado para que los casters entre la luz y la cascada se
+ *  aplasten en el plano cercano en lugar de desaparecer.
+ *
+ *  Slots del pass principal: `t7` mapa de sombras, `s1` sampler de comparación,
+ *  `b4` `CBShadowCascades`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "ShaderProgram.h"
+#include "Shadows/CascadedShadows.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @struct CBShadowInstances
+ * @brief Constant buffer del shadow pass: matriz de la cascada y matrices de mundo del batch.
+ */
+struct
+  CBShadowInstances {
+  XMMATRIX mLightViewProj;
+  XMMATRIX mWorld[kMaxShadowInstances];
+};
+
+/**
+ * @class ShadowRenderer
+ * @brief Dibuja los mapas de sombra en cascada y los vincula al pass principal.
+ */
+class
+  ShadowRenderer {
+public:
+  ShadowRenderer() = default;
+  ~ShadowRenderer() = default;
+
+  /**
+   * @brief Creo el arreglo de profundidad, las vistas, estados y el shader de sombras.
+   *
+   * @param device    Dispositivo de Direct3D.
+   * @param settings  Número de cascadas y resolución.
+   * @param layout    Input layout de los vértices (el mismo que el pass principal).
+   */
+  HRESULT
+    init(Device& device,
+         const CascadedShadowSettings& settings,
+         std::vector<D3D11_INPUT_ELEMENT_DESC> layout);
+
+  /**
+   * @brief Dibujo todas las cascadas y lleno `submitMs` y los conteos de draws en sus stats.
+   *
+   * @details
+   *  Deja sin render target vinculado; el pass principal vuelve a poner el suyo.
+   */
+  void
+    render(DeviceContext& deviceContext,
+           CascadedShadows& shadows,
+           const std::vector<ShadowCaster>& casters);
+
+  /**
+   * @brief Vinculo el mapa de sombras, el sampler y las matrices para el pass principal.
+   *
+   * @param cameraOrigin Si la vista es relativa a la cámara, su posición: las matrices de
+   *                     las cascadas se compensan para recibir posiciones relativas.
+   */
+  void
+    bind(DeviceContext& deviceContext, const XMFLOAT3* cameraOrigin = nullptr);
+
+  void
+    destroy();
+
+private:
+  /**
+   * @brief Mando una lista de batches (una llamada instanciada por batch).
+   */
+  unsigned int
+    drawBatches(DeviceContext& deviceContext,
+                const std::vector<ShadowDrawBatch>& batches,
+                const std::vector<unsigned int>& list,
+                const std::vector<ShadowCaster>& casters);
+
+private:
+  unsigned int m_numCascades = 0;
+  unsigned int m_resolution = 0;
+
+  ID3D11Texture2D* m_depthArray = nullptr;
+  std::vector<ID3D11DepthStencilView*> m_sliceViews;
+  ID3D11ShaderResourceView* m_shadowView = nullptr;
+  ID3D11RasterizerState* m_rasterizer = nullptr;
+  ID3D11SamplerState* m_comparisonSampler = nullptr;
+
+  ShaderProgram m_shaderShadow;
+  Buffer m_cbInstances;
+  Buffer m_cbCascades;
+  CBShadowInstances m_instances;
+  CBShadowCascades m_cascadeData;
+  /// @brief Si es true, `m_cbCascades` tiene las matrices compensadas de una vista relativa.
+  bool m_cascadesRelative = false;
+};
@@ -0,0 +1,118 @@
+/**
+ * @file FixedTimestep.h
+ * @brief Aquí defino el reloj de paso fijo de la simulación (acumulador + interpolación).
+ *
+ * @details
+ *  El frame dura lo que dure, pero la simulación siempre avanza en pasos iguales
+ *  (`stepSeconds`). Cada frame sumo su duración a un acumulador y de ahí saco cuántos
+ *  pasos tocan; lo que sobra se vuelve `alpha`, la fracción del siguiente paso que ya
+ *  pasó, y con eso interpolo los transforms al dibujar.
+ *
+ *  Protección contra la espiral de la muerte: si un frame tarda mucho (breakpoint,
+ *  carga, ventana arrastrada) recorto su duración a `maxFrameSeconds` y nunca corro más
+ *  de `maxStepsPerFrame` pasos; el tiempo que no alcanzo a simular se tira y queda
+ *  contado en las stats. Así un frame lento no provoca otro más lento.
+ *
+ *  El acumulador es `double` para que horas de juego no acumulen error.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct FixedTimestepSettings
+ * @brief Parámetros del paso fijo.
+ */
+struct
+  FixedTimestepSettings {
+  /// @brief Duración de un paso de simulación (60 Hz por defecto).
+  double stepSeconds = 1.0 / 60.0;
+  /// @brief Pasos máximos por frame antes de tirar tiempo.
+  unsigned int maxStepsPerFrame = 8;
+  /// @brief Duración máxima que acepto de un frame.
+  double maxFrameSeconds = 0.25;
+};
+
+/**
+ * @struct FixedTimestepStats
+ * @brief Números del reloj (el último frame y acumulados).
+ */
+struct
+  FixedTimestepStats {
+  /// @brief Pasos que tocaron el último frame.
+  unsigned int steps = 0;
+  /// @brief Frames recortados o que se quedaron sin pasos.
+  unsigned int droppedFrames = 0;
+  /// @brief Segundos tirados en total por la protección.
+  double droppedSeconds = 0.0;
+};
+
+/**
+ * @class FixedTimestep
+ * @brief Convierte el tiempo variable del frame en pasos fijos de simulación.
+ */
+class
+  FixedTimestep {
+public:
+  FixedTimestep() = default;
+  ~FixedTimestep() = default;
+
+  void
+    setSettings(const FixedTimestepSettings& settings);
+
+  const FixedTimestepSettings&
+    getSettings() const { return m_settings; }
+
+  /// @brief Vuelvo al tick 0 con el acumulador vacío.
+  void
+    reset();
+
+  /**
+   * @brief Sumo la duración del frame y regreso cuántos pasos fijos hay que correr.
+   *
+   * @param frameSeconds  Duración real del frame (QPC).
+   * @return Pasos a correr ahora, de `getSettings().stepSeconds` cada uno.
+   */
+  unsigned int
+    advance(double frameSeconds);
+
+  /**
+   * @brief Fracción del siguiente paso ya transcurrida, en `[0, 1)`.
+   *
+   * @details Para dibujar `lerp(estadoAnterior, estadoActual, alpha)`.
+   */
+  float
+    getAlpha() const;
+
+  float
+    getStepSeconds() const { return static_cast<float>(m_settings.stepSeconds); }
+
+  /// @brief Pasos simulados desde `reset` (contando los del último `advance`).
+  unsigned long long
+    getTick() const { return m_tick; }
+
+  /// @brief Tiempo de simulación, siempre múltiplo exacto del paso.
+  double
+    getSimulationTime() const { return static_cast<double>(m_tick) * m_settings.stepSeconds; }
+
+  const FixedTimestepStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: grabación y replay con frames irregulares y tirones.
+   *
+   * @details
+   *  Simula partículas y cuerpos movidos por input a paso fijo, grabo input y hash por
+   *  tick, y reproduzco con otro ritmo de frames: los hashes tienen que salir iguales.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  FixedTimestepSettings m_settings;
+  double m_accumulator = 0.0;
+  unsigned long long m_tick = 0;
+  FixedTimestepStats m_stats;
+};
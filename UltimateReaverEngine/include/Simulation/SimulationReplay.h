@@ -0,0 +1,171 @@
+/**
+ * @file SimulationReplay.h
+ * @brief Aquí defino la grabación y el replay determinista de la simulación.
+ *
+ * @details
+ *  La simulación de paso fijo solo depende de su estado inicial y del input de cada tick.
+ *  Si grabo el input por tick puedo volver a correr exactamente lo mismo, sin importar
+ *  los FPS de la máquina. Para comprobarlo también grabo un hash del estado al final de
+ *  cada tick; en el replay comparo y reporto el primer tick donde algo se desvió.
+ *
+ *  Sirve para medir el costo de la simulación siempre con la misma carga y para pruebas
+ *  de regresión: si un cambio altera la simulación, el hash lo delata.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstring>
+
+/**
+ * @enum SimulationButton
+ * @brief Bits de `SimulationInput::buttons`.
+ */
+enum SimulationButton {
+  SIM_BUTTON_PRIMARY = 1 << 0,
+  SIM_BUTTON_SECONDARY = 1 << 1
+};
+
+/**
+ * @struct SimulationInput
+ * @brief Todo lo que la simulación lee del jugador en un tick.
+ */
+struct
+  SimulationInput {
+  unsigned int buttons = 0;
+  float axisX = 0.0f;
+  float axisY = 0.0f;
+};
+
+/**
+ * @enum ReplayMode
+ * @brief Qué hace el replay con el input y los hashes.
+ */
+enum ReplayMode {
+  REPLAY_OFF,
+  REPLAY_RECORD,
+  REPLAY_PLAYBACK
+};
+
+/**
+ * @class StateHasher
+ * @brief Hash estilo FNV-1a de 64 bits sobre los bytes del estado.
+ *
+ * @details Hasheo los bits exactos de los floats: si difiere un bit, difiere el hash.
+ */
+class
+  StateHasher {
+public:
+  void
+    add(const void* data, size_t bytes) {
+    // De 8 en 8 bytes (el estado son megas de floats); la cola byte a byte
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+      unsigned long long word;
+      memcpy(&word, p + i, 8);
+      m_hash = (m_hash ^ word) * 1099511628211ull;
+    }
+    for (; i < bytes; ++i) {
+      m_hash = (m_hash ^ p[i]) * 1099511628211ull;
+    }
+  }
+
+  template<typename T>
+  void
+    add(const T& value) { add(&value, sizeof(T)); }
+
+  unsigned long long
+    getHash() const { return m_hash; }
+
+private:
+  unsigned long long m_hash = 14695981039346656037ull;
+};
+
+/**
+ * @class SimulationReplay
+ * @brief Graba o reproduce el input por tick y verifica el hash del estado.
+ */
+class
+  SimulationReplay {
+public:
+  SimulationReplay() = default;
+  ~SimulationReplay() = default;
+
+  /// @brief Empiezo a grabar desde el tick 0 (borra lo grabado antes).
+  void
+    startRecording();
+
+  /**
+   * @brief Empiezo a reproducir lo grabado desde el tick 0.
+   * @return false si no hay nada grabado.
+   */
+  bool
+    startPlayback();
+
+  /// @brief Dejo de grabar/reproducir; lo grabado se queda.
+  void
+    stop() { m_mode = REPLAY_OFF; }
+
+  ReplayMode
+    getMode() const { return m_mode; }
+
+  /**
+   * @brief Inicio de un tick: regreso el input que debe usar la simulación.
+   *
+   * @details
+   *  Grabando guardo `live` y lo regreso; reproduciendo regreso el grabado e ignoro
+   *  `live`. Si el replay se acaba paso a `REPLAY_OFF` y sigo con `live`.
+   */
+  SimulationInput
+    beginTick(const SimulationInput& live);
+
+  /**
+   * @brief Fin de un tick con el hash del estado ya simulado.
+   *
+   * @details Grabando lo guardo; reproduciendo lo comparo contra el grabado.
+   */
+  void
+    endTick(unsigned long long stateHash);
+
+  /// @brief Tick actual dentro de la grabación.
+  unsigned int
+    getTick() const { return m_tick; }
+
+  unsigned int
+    getNumTicks() const { return static_cast<unsigned int>(m_inputs.size()); }
+
+  /// @brief Ticks reproducidos cuyo hash no coincidió.
+  unsigned int
+    getMismatches() const { return m_mismatches; }
+
+  /// @brief Primer tick que no coincidió (o `getNumTicks()` si ninguno).
+  unsigned int
+    getFirstMismatch() const { return m_firstMismatch; }
+
+  const std::vector<unsigned long long>&
+    getHashes() const { return m_hashes; }
+
+  /// @brief Cambio el input grabado de un tick (para probar que el hash lo detecta).
+  void
+    setInput(unsigned int tick, const SimulationInput& input) { m_inputs[tick] = input; }
+
+  /**
+   * @brief Guardo input y hashes en binario.
+   */
+  HRESULT
+    saveToFile(const std::string& path) const;
+
+  /**
+   * @brief Cargo una grabación hecha con `saveToFile`.
+   */
+  HRESULT
+    loadFromFile(const std::string& path);
+
+private:
+  ReplayMode m_mode = REPLAY_OFF;
+  unsigned int m_tick = 0;
+  unsigned int m_mismatches = 0;
+  unsigned int m_firstMismatch = 0;
+  std::vector<SimulationInput> m_inputs;
+  std::vector<unsigned long long> m_hashes;
+};
@@ -0,0 +1,94 @@
+/**
+ * @file TangentSpace.h
+ * @brief Aquí genero normales y tangentes (compatibles con MikkTSpace) al importar mallas.
+ *
+ * @details
+ *  Los assets con normal map necesitan la misma base tangente con la que se horneó el
+ *  mapa; casi todos los bakers usan MikkTSpace, así que reproduzco su construcción:
+ *  - **Normales:** solo si la malla no trae (o si se pide). Suavizo entre vértices con la
+ *    misma posición y peso cada cara por área, por ángulo de la esquina o por ambos.
+ *  - **Tangentes:** por triángulo, la dirección de +u en el espacio del triángulo y su
+ *    orientación (signo del área en UV). Por esquina la proyecto al plano de la normal y
+ *    la peso por el ángulo de la esquina; sumo sobre las esquinas del mismo vértice
+ *    soldado (misma posición, normal y UV) con la misma orientación.
+ *  - **Handedness:** `Tangent.w` es +1 o -1 y `bitangente = w * cross(N, T)`. Si un vértice
+ *    lo usan triángulos con las dos orientaciones (UVs en espejo), lo duplico.
+ *
+ *  Todo corre en paralelo con el `JobSystem`: las mallas se reparten entre los hilos y las
+ *  etapas por triángulo de cada malla se parten en rangos. Cada esquina escribe su propia
+ *  contribución y se suman en orden fijo, así que el resultado no depende de los hilos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+class BenchmarkReport;
+
+/**
+ * @enum NormalWeighting
+ * @brief Cómo pesa cada cara en la normal de sus vértices.
+ */
+enum NormalWeighting {
+  NORMAL_WEIGHT_AREA,
+  NORMAL_WEIGHT_ANGLE,
+  NORMAL_WEIGHT_AREA_ANGLE
+};
+
+/**
+ * @struct TangentSpaceSettings
+ * @brief Opciones de la generación.
+ */
+struct
+  TangentSpaceSettings {
+  NormalWeighting weighting = NORMAL_WEIGHT_AREA_ANGLE;
+  /// @brief Recalculo las normales aunque la malla traiga las suyas.
+  bool recomputeNormals = false;
+  /// @brief Triángulos por bloque al repartir una malla entre hilos.
+  size_t grainSize = 8192;
+};
+
+/**
+ * @struct TangentSpaceStats
+ * @brief Qué se hizo en una llamada.
+ */
+struct
+  TangentSpaceStats {
+  unsigned int meshes = 0;
+  unsigned int triangles = 0;
+  /// @brief Vértices a los que les generé la normal.
+  unsigned int generatedNormals = 0;
+  /// @brief Vértices duplicados por tener triángulos con las dos orientaciones.
+  unsigned int splitVertices = 0;
+  /// @brief Triángulos sin área en UV (no aportan tangente).
+  unsigned int degenerateTriangles = 0;
+};
+
+/**
+ * @class TangentSpace
+ * @brief Etapa de importación que llena `SimpleVertex::Normal` y `SimpleVertex::Tangent`.
+ */
+class
+  TangentSpace {
+public:
+  /**
+   * @brief Genero la base tangente de todas las mallas (en paralelo).
+   */
+  static TangentSpaceStats
+    generate(std::vector<MeshComponent>& meshes, const TangentSpaceSettings& settings = TangentSpaceSettings());
+
+  /**
+   * @brief Genero la base tangente de una malla (sus triángulos se reparten entre los hilos).
+   */
+  static TangentSpaceStats
+    generate(MeshComponent& mesh, const TangentSpaceSettings& settings = TangentSpaceSettings());
+
+  /**
+   * @brief Benchmark headless: triángulos por segundo y comparación contra resultados conocidos.
+   *
+   * @details Plano, esfera y una rejilla con UVs en espejo; además verifico que el resultado
+   *          en paralelo sea idéntico al de un solo hilo.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+};
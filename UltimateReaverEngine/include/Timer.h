@@ -0,0 +1,50 @@
+/**
+ * @file Timer.h
+ * @brief Aquí defino un Timer de alta resolución para medir costos de CPU.
+ *
+ * @details
+ *  Lo uso en los benchmarks y en las estadísticas de los sistemas (skinning, culling, etc.)
+ *  para saber cuántos milisegundos se van en cada cosa. Uso `std::chrono::steady_clock`
+ *  para no depender de Win32 y poder medir también en pruebas headless.
+ */
+
+#pragma once
+#include <chrono>
+
+ /**
+  * @class Timer
+  * @brief Cronómetro sencillo: arranca al construirse y regresa el tiempo transcurrido.
+  */
+class
+  Timer {
+public:
+
+  /**
+   * @brief El timer arranca solo al construirse.
+   */
+  Timer() { reset(); }
+
+  /**
+   * @brief Reinicio el punto de partida.
+   */
+  void
+    reset() { m_start = std::chrono::steady_clock::now(); }
+
+  /**
+   * @brief Milisegundos transcurridos desde el último reset.
+   */
+  double
+    elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - m_start).count();
+  }
+
+  /**
+   * @brief Segundos transcurridos desde el último reset.
+   */
+  double
+    elapsedSeconds() const { return elapsedMs() * 0.001; }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
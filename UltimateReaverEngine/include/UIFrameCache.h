@@ -0,0 +1,117 @@
+/**
+ * @file UIFrameCache.h
+ * @brief Aquí decido en qué frames se vuelve a armar la UI y en cuáles reuso la anterior.
+ *
+ * @details
+ *  ImGui es de modo inmediato: cada frame se arman todas las ventanas aunque no cambie
+ *  nada. Los paneles de diagnóstico siempre abiertos no lo necesitan, así que la UI puede
+ *  quedarse "retenida": si no hay input ni cambió ningún dato, no llamo `NewFrame` ni armo
+ *  widgets y vuelvo a mandar el `ImDrawData` del último `ImGui::Render` (sigue válido hasta
+ *  el siguiente `NewFrame`).
+ *
+ *  Cuándo se re-arma:
+ *  - **Input:** en el frame en que llega y unos frames más (`settleFrames`), para que ImGui
+ *    termine hover, clics y animaciones.
+ *  - **Datos:** la UI junta sus contadores en una versión; si cambió, se re-arma, pero a lo
+ *    más `dataRateHz` veces por segundo (los paneles que cambian cada frame se saltan frames).
+ *  - **Refresco:** aunque nada cambie, cada `1 / idleRefreshHz` segundos.
+ *
+ *  La clase solo tiene la política (sin ImGui ni D3D), así se puede probar headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct UIFrameCacheSettings
+ * @brief Frecuencias con las que se re-arma la UI retenida.
+ */
+struct
+  UIFrameCacheSettings {
+  /// @brief false = modo inmediato de siempre (se arma cada frame).
+  bool retained = true;
+  /// @brief Frames que sigo armando después del último input (mínimo 1).
+  unsigned int settleFrames = 3;
+  /// @brief Máximo de re-armados por segundo por cambios de datos (0 = sin límite).
+  float dataRateHz = 10.0f;
+  /// @brief Re-armado periódico aunque nada cambie (0 = nunca).
+  float idleRefreshHz = 1.0f;
+};
+
+/**
+ * @struct UIFrameCacheStats
+ * @brief Cuántos frames se armaron y por qué.
+ */
+struct
+  UIFrameCacheStats {
+  unsigned long long frames = 0;
+  unsigned long long rebuilds = 0;
+  unsigned long long inputRebuilds = 0;
+  unsigned long long dataRebuilds = 0;
+  unsigned long long idleRebuilds = 0;
+  unsigned long long workRebuilds = 0;
+};
+
+/**
+ * @class UIFrameCache
+ * @brief Política de re-armado de la UI retenida.
+ */
+class
+  UIFrameCache {
+public:
+  UIFrameCache() = default;
+  ~UIFrameCache() = default;
+
+  void
+    setSettings(const UIFrameCacheSettings& settings) { m_settings = settings; }
+
+  const UIFrameCacheSettings&
+    getSettings() const { return m_settings; }
+
+  /**
+   * @brief Decido si este frame se arma la UI.
+   *
+   * @param nowSeconds   Tiempo actual (cualquier reloj que solo avance).
+   * @param inputPending Hay eventos de input que ImGui todavía no procesa.
+   * @param dataVersion  Versión de los datos que muestra la UI (cambia si cambian).
+   * @param workPending  Hay trabajo que solo avanza cuando se arma la UI (el filtro del
+   *                     outliner a medias): mientras tanto se arma cada frame.
+   * @return true si hay que llamar `NewFrame`, armar las ventanas y `Render`.
+   */
+  bool
+    beginFrame(double nowSeconds, bool inputPending, unsigned long long dataVersion, bool workPending = false);
+
+  /**
+   * @brief El siguiente frame se arma sí o sí (por ejemplo, al cambiar de escena).
+   */
+  void
+    invalidate() { m_valid = false; }
+
+  const UIFrameCacheStats&
+    getStats() const { return m_stats; }
+
+  void
+    resetStats() { m_stats = UIFrameCacheStats(); }
+
+  /**
+   * @brief Benchmark headless: frames armados contra frames totales en una sesión simulada.
+   *
+   * @details Verifico que todo input se procese en su frame, que los datos respeten su
+   *          frecuencia, que el trabajo a medias termine sin input y que sin cambios solo
+   *          quede el refresco periódico.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  UIFrameCacheSettings m_settings;
+  UIFrameCacheStats m_stats;
+
+  /// @brief Ya hay un frame armado que se puede reusar.
+  bool m_valid = false;
+  unsigned int m_settleLeft = 0;
+  unsigned long long m_builtVersion = 0;
+  double m_lastBuild = 0.0;
+};
@@ -8,6 +8,10 @@
  *  y destruyo todo al final.
  *  Tambin guardo cul Actor est seleccionado para poder editar sus propiedades
  *  directamente desde la UI (como la posicin, rotacin, etc.).
+ *  El outliner de escena lista todos los actores con un `ImGuiListClipper` (solo se
+ *  dibujan las filas visibles) y el trabajo de la UI por frame tiene un presupuesto fijo.
+ *  En modo retenido (`UIFrameCache`) la UI solo se vuelve a armar con input o cuando
+ *  cambian sus datos; los dems frames reenvo el ltimo `ImDrawData`.
  */
 
 #pragma once
@@ -17,6 +21,10 @@
 #include "imgui_impl_dx11.h"
 #include <imgui_internal.h>
 #include "ECS/Actor.h"
+#include "SceneOutliner.h"
+#include "FrameProfiler.h"
+#include "UIFrameCache.h"
+#include "Lighting/LightmapBaker.h"
 
  /**
   * @class UserInterface
@@ -125,15 +133,165 @@ public:
    * @brief Defino qu Actor est seleccionado en el editor.
    *
    * @param actor Puntero al Actor que quiero inspeccionar/editar desde la UI.
+   * @param mesh  Sub-malla que se eligi con el picking (-1 si ninguna).
    *
    * @details
    *  Lo uso para que el panel de inspector sepa qu objeto mostrar y editar.
+   *  Si el actor est en la escena, el outliner lo deja como nica seleccin.
    */
   void
-    setSelectedActor(Actor* actor) { m_selectedActor = actor; }
+    setSelectedActor(Actor* actor, int mesh = -1);
+
+  /**
+   * @brief Le paso al outliner los actores de la escena.
+   *
+   * @param actors Arreglo de actores del motor (nullptr = sin escena).
+   *
+   * @details
+   *  Guardo el puntero al arreglo, no una copia. Si cambia el nmero de actores,
+   *  reconstruyo la tabla de nombres en el siguiente frame.
+   */
+  void
+    setScene(std::vector<EU::TSharedPointer<Actor>>* actors);
+
+  /**
+   * @brief Presupuesto de CPU de la UI por frame, en milisegundos.
+   *
+   * @details La mitad se la doy al filtro del outliner; lo que no alcance sigue en el
+   *          siguiente frame.
+   */
+  void
+    setFrameBudget(double budgetMs) { m_budgetMs = budgetMs; }
+
+  /**
+   * @brief Configuro el modo retenido (frecuencias de re-armado de la UI).
+   */
+  void
+    setRetainedSettings(const UIFrameCacheSettings& settings) { m_frameCache.setSettings(settings); }
+
+  /**
+   * @brief Cuntos frames se armaron y cuntos reusaron la UI anterior.
+   */
+  const UIFrameCacheStats&
+    getRetainedStats() const { return m_frameCache.getStats(); }
+
+  /**
+   * @brief Baker del lightmap que controla el panel (nullptr = sin panel).
+   *
+   * @details La UI solo pide el horneado; quien lo avanza cada frame es `BaseApp`.
+   */
+  void
+    setLightmapBaker(LightmapBaker* baker) {
+    m_lightmapBaker = baker;
+    if (baker) {
+      m_lightmapSettings = baker->getSettings();
+    }
+  }
+
+  /**
+   * @brief Textura con la vista previa del lightmap (nullptr mientras no haya).
+   */
+  void
+    setLightmapPreview(ID3D11ShaderResourceView* preview) { m_lightmapPreview = preview; }
 
 private:
 
+  /**
+   * @brief Si hay input que ImGui tiene que procesar este frame.
+   *
+   * @details Movimientos del mouse fuera de toda ventana de ImGui no cuentan (se quedan en
+   *          la cola hasta el siguiente frame armado); clics, teclas y arrastres s.
+   */
+  bool
+    hasPendingInput() const;
+
+  /**
+   * @brief Junto los contadores de lo que muestra la UI en una sola versin.
+   */
+  unsigned long long
+    computeDataVersion() const;
+
+  /**
+   * @brief Ventana del outliner: bsqueda y lista virtualizada de actores.
+   */
+  void
+    drawOutliner();
+
+  /**
+   * @brief Ventana del inspector del actor seleccionado.
+   */
+  void
+    drawInspector();
+
+  /**
+   * @brief Ventana con los tiempos del `FrameProfiler` y el presupuesto de la UI.
+   */
+  void
+    drawProfiler();
+
+  /**
+   * @brief Ventana del lightmap: ajustes, progreso, rayos por segundo y la vista previa.
+   */
+  void
+    drawLightmaps();
+
+  /**
+   * @brief Reconstruyo la tabla de nombres y vuelvo a seleccionar el actor del inspector.
+   */
+  void
+    rebuildOutliner();
+
+  /**
+   * @brief El inspector muestra lo que qued como seleccin principal del outliner.
+   */
+  void
+    syncInspectorWithOutliner();
+
+  /**
+   * @brief Si los cambios del inspector se tienen que aplicar a varios actores.
+   */
+  bool
+    isEditingSelection() const;
+
   /// @brief Actor actualmente seleccionado en el editor (para mostrar info en la UI).
   Actor* m_selectedActor = nullptr;
+
+  /// @brief Sub-malla del actor seleccionada con el picking (-1 si ninguna).
+  int m_selectedMesh = -1;
+
+  /// @brief Actores de la escena (los de `BaseApp`).
+  std::vector<EU::TSharedPointer<Actor>>* m_scene = nullptr;
+
+  /// @brief Tabla de nombres, filtro y seleccin mltiple del outliner.
+  SceneOutliner m_outliner;
+
+  /// @brief Texto de la caja de bsqueda.
+  char m_search[128] = {};
+
+  /// @brief Presupuesto de CPU de la UI por frame (ms).
+  double m_budgetMs = 2.0;
+
+  /// @brief Ventana de Win32 (para detectar cambios de tamao).
+  HWND m_window = nullptr;
+
+  /// @brief Decide en qu frames se arma la UI.
+  UIFrameCache m_frameCache;
+
+  /// @brief Reloj del modo retenido.
+  Timer m_clock;
+
+  /// @brief Este frame se llam `NewFrame` (si no, se reenva el ltimo `ImDrawData`).
+  bool m_frameBuilt = false;
+
+  /// @brief La ventana del profiler estaba abierta y sin colapsar en el ltimo frame armado.
+  bool m_profilerVisible = true;
+
+  /// @brief Baker del lightmap (de `BaseApp`).
+  LightmapBaker* m_lightmapBaker = nullptr;
+
+  /// @brief Ajustes que edito en el panel y mando con el siguiente "Hornear".
+  LightmapBakeSettings m_lightmapSettings;
+
+  /// @brief Vista previa progresiva (la textura es de `BaseApp`).
+  ID3D11ShaderResourceView* m_lightmapPreview = nullptr;
 };
@@ -0,0 +1,204 @@
+/**
+ * @file ViewSystem.h
+ * @brief Aquí junto las vistas del frame (pantalla dividida, viewports del editor, PiP)
+ *        y hago su culling con un solo recorrido de la escena.
+ *
+ * @details
+ *  Con N cámaras lo ingenuo es recorrer la escena N veces. Aquí:
+ *  - **Un recorrido:** quien llama agrega una vez por frame la caja en mundo de cada cosa
+ *    dibujable (`addItem`); esa caja sirve para todas las vistas.
+ *  - **Culling por vista en paralelo:** los items se reparten en el `JobSystem`; cada job
+ *    prueba su bloque contra los frustums de todas las vistas y deja un bit por vista.
+ *  - **Lista de draws combinada:** una sola lista ordenada por `sortKey` (estado) con la
+ *    máscara de vistas que ven cada item; lo que es por item (subir su CB, skinning) se
+ *    hace una vez aunque lo vean varias vistas.
+ *  - **Render relativo a la cámara:** en mundos grandes las posiciones absolutas en float
+ *    pierden precisión al pasar por world * view en la GPU. Si la vista lo pide, la vista
+ *    queda sin traslación y a cada matriz de mundo le resto la posición de la cámara en CPU.
+ *
+ *  Todo es CPU (sin D3D), así que el benchmark corre headless.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Frustum.h"
+#include "Culling/SoftwareOcclusion.h"
+
+class BenchmarkReport;
+
+/**
+ * @struct RenderView
+ * @brief Una cámara lista para dibujar: matrices, viewport y modo de coordenadas.
+ */
+struct
+  RenderView {
+  /// @brief Posición de la cámara en mundo.
+  XMFLOAT3 eye = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  /// @brief Vista absoluta (vectores fila, sin transponer).
+  XMFLOAT4X4 view;
+  XMFLOAT4X4 projection;
+  /// @brief view * projection absolutos (el culling es en mundo).
+  XMFLOAT4X4 viewProjection;
+  /// @brief Viewport en pixeles del render target.
+  float x = 0.0f;
+  float y = 0.0f;
+  float width = 0.0f;
+  float height = 0.0f;
+  /// @brief Dibujo con la cámara en el origen (ver `getShaderView` y `makeCameraRelative`).
+  bool cameraRelative = false;
+
+  /**
+   * @brief La vista que va al shader: sin traslación si la vista es relativa a la cámara.
+   */
+  XMMATRIX
+    getShaderView() const;
+};
+
+/**
+ * @struct ViewDraw
+ * @brief Un item de la lista combinada y las vistas que lo ven (un bit por vista).
+ */
+struct
+  ViewDraw {
+  unsigned int item;
+  unsigned int viewMask;
+};
+
+/**
+ * @struct ViewSystemStats
+ * @brief Números del último `cull`.
+ */
+struct
+  ViewSystemStats {
+  unsigned int views = 0;
+  unsigned int items = 0;
+  /// @brief Items que ve al menos una vista (entradas de la lista combinada).
+  unsigned int drawnItems = 0;
+  /// @brief Suma sobre las vistas de los items visibles (draws reales).
+  unsigned int viewDraws = 0;
+  double cullMs = 0.0;
+  double mergeMs = 0.0;
+};
+
+/**
+ * @class ViewSystem
+ * @brief Vistas del frame, su culling compartido y la lista de draws combinada.
+ */
+class
+  ViewSystem {
+public:
+  /// @brief Una máscara de 32 bits: hasta 32 vistas por frame.
+  static const unsigned int kMaxViews = 32;
+
+  ViewSystem() = default;
+  ~ViewSystem() = default;
+
+  /**
+   * @brief Armo una vista a partir de sus matrices absolutas.
+   */
+  static RenderView
+    makeView(const XMFLOAT4X4& view,
+             const XMFLOAT4X4& projection,
+             float x, float y, float width, float height,
+             bool cameraRelative = false);
+
+  /**
+   * @brief Resto la posición de la cámara a la traslación de una matriz de mundo.
+   *
+   * @details La resta es entre floats cercanos (exacta o casi), así que lo que llega a la
+   *          GPU son números chicos aunque el mundo sea enorme.
+   */
+  static void
+    makeCameraRelative(const XMFLOAT4X4& world, const XMFLOAT3& eye, XMFLOAT4X4& relative);
+
+  void
+    clearViews() { m_views.clear(); }
+
+  /**
+   * @return El índice de la vista, o -1 si ya hay `kMaxViews`.
+   */
+  int
+    addView(const RenderView& view);
+
+  unsigned int
+    getNumViews() const { return static_cast<unsigned int>(m_views.size()); }
+
+  const RenderView&
+    getView(unsigned int index) const { return m_views[index]; }
+
+  /**
+   * @brief Empiezo el recorrido de la escena del frame (borra los items).
+   */
+  void
+    beginFrame();
+
+  /**
+   * @brief Agrego algo dibujable.
+   *
+   * @param bounds   Caja en mundo; nullptr = siempre visible (sin caja conocida).
+   * @param sortKey  Clave de estado para ordenar la lista (prefab, material...).
+   * @return Índice del item (el que aparece en `ViewDraw::item`).
+   */
+  unsigned int
+    addItem(const OcclusionBounds* bounds, unsigned int sortKey);
+
+  /**
+   * @brief Frustum culling de todos los items contra todas las vistas y lista combinada.
+   */
+  void
+    cull();
+
+  /**
+   * @brief Quito de una vista los items que otra prueba descartó (por ejemplo, oclusión).
+   *
+   * @param visible Un byte por item (0 = no se ve en esa vista). Vuelve a armar la lista.
+   */
+  void
+    applyVisibility(unsigned int view, const std::vector<uint8_t>& visible);
+
+  unsigned int
+    getNumItems() const { return static_cast<unsigned int>(m_keys.size()); }
+
+  /**
+   * @brief Máscara de vistas de un item después de `cull`.
+   */
+  unsigned int
+    getViewMask(unsigned int item) const { return m_masks[item]; }
+
+  /**
+   * @brief Items visibles en alguna vista, ordenados por `sortKey` (y por item).
+   */
+  const std::vector<ViewDraw>&
+    getDrawList() const { return m_drawList; }
+
+  const ViewSystemStats&
+    getStats() const { return m_stats; }
+
+  /**
+   * @brief Benchmark headless: N vistas compartiendo recorrido contra N pasadas independientes.
+   *
+   * @details Verifico que la visibilidad por vista sea idéntica a la de las pasadas
+   *          independientes y mido el error de proyección lejos del origen con y sin render
+   *          relativo a la cámara.
+   */
+  static void
+    runBenchmark(BenchmarkReport& report);
+
+private:
+  /**
+   * @brief Armo la lista combinada con las máscaras actuales.
+   */
+  void
+    merge();
+
+  std::vector<RenderView> m_views;
+  std::vector<Frustum> m_frustums;
+
+  std::vector<OcclusionBounds> m_bounds;
+  /// @brief 1 si el item no tiene caja (siempre visible).
+  std::vector<uint8_t> m_unbounded;
+  std::vector<unsigned int> m_keys;
+  std::vector<unsigned int> m_masks;
+  std::vector<ViewDraw> m_drawList;
+  ViewSystemStats m_stats;
+};
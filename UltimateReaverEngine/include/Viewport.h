@@ -73,6 +73,21 @@ public:
   HRESULT
     init(unsigned int width, unsigned int height);
 
+  /**
+   * @brief Inicializo el viewport con un rectngulo dentro del render target.
+   *
+   * @param x       Esquina superior izquierda en pxeles.
+   * @param y       Esquina superior izquierda en pxeles.
+   * @param width   Ancho del viewport en pxeles.
+   * @param height  Alto del viewport en pxeles.
+   * @return HRESULT `S_OK` si todo sali bien, o `E_INVALIDARG` si el rectngulo est vaco.
+   *
+   * @details
+   *  Es lo que uso para cada vista del `ViewSystem` (pantalla dividida, picture-in-picture).
+   */
+  HRESULT
+    init(float x, float y, float width, float height);
+
   /**
    * @brief Actualizo el estado del viewport si hiciera falta.
    *
@@ -0,0 +1,40 @@
+#include "Animation/AnimationClip.h"
+#include <algorithm>
+
+void
+AnimationClip::init(const std::string& name,
+                    unsigned int numBones,
+                    unsigned int numFrames,
+                    float sampleRate) {
+  m_name = name;
+  m_numBones = numBones;
+  m_numFrames = numFrames > 0 ? numFrames : 1;
+  m_sampleRate = sampleRate > 0.0f ? sampleRate : 30.0f;
+  m_duration = static_cast<float>(m_numFrames - 1) / m_sampleRate;
+  m_frames.assign(static_cast<size_t>(m_numFrames) * m_numBones, BoneTransform());
+}
+
+void
+AnimationClip::sample(float time, bool loop, BoneTransform* outPose) const {
+  if (m_numBones == 0) {
+    return;
+  }
+
+  if (m_numFrames == 1 || m_duration <= 0.0f) {
+    std::copy(m_frames.begin(), m_frames.begin() + m_numBones, outPose);
+    return;
+  }
+
+  float framePos = AnimMath::wrapTime(time, m_duration, loop) * m_sampleRate;
+  unsigned int frame0 = static_cast<unsigned int>(framePos);
+  if (frame0 >= m_numFrames - 1) {
+    frame0 = m_numFrames - 2;
+  }
+  float t = framePos - static_cast<float>(frame0);
+
+  const BoneTransform* a = getFrame(frame0);
+  const BoneTransform* b = getFrame(frame0 + 1);
+  for (unsigned int i = 0; i < m_numBones; ++i) {
+    outPose[i] = AnimMath::lerp(a[i], b[i], t);
+  }
+}
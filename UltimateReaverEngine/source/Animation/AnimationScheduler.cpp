@@ -0,0 +1,275 @@
+#include "Animation/AnimationScheduler.h"
+#include "Animation/Animator.h"
+#include "Animation/SyntheticAnimation.h"
+#include "ECS/Transform.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <algorithm>
+
+void
+AnimationScheduler::add(Animator* animator, const Transform* transform, float radius) {
+  if (!animator || !transform) {
+    ERROR("AnimationScheduler", "add", "Animator and Transform are required");
+    return;
+  }
+
+  Entry entry;
+  entry.animator = animator;
+  entry.transform = transform;
+  entry.radius = radius;
+  // Fases repartidas para que los actores con el mismo intervalo no caigan en el mismo frame
+  entry.phase = m_nextPhase++;
+  // Que se evalúe en cuanto sea visible
+  entry.framesSinceUpdate = 1u << 16;
+  m_entries.push_back(entry);
+  animator->setScheduled(true);
+}
+
+void
+AnimationScheduler::remove(Animator* animator) {
+  auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                         [animator](const Entry& e) { return e.animator == animator; });
+  if (it != m_entries.end()) {
+    it->animator->setScheduled(false);
+    it->animator->setBoneLod(-1);
+    m_entries.erase(it);
+  }
+}
+
+void
+AnimationScheduler::update(float deltaTime,
+                           const XMFLOAT4X4& viewProjection,
+                           const XMFLOAT3& eyePosition,
+                           float projScaleY,
+                           float viewportHeight) {
+  Timer timer;
+  const Frustum frustum(viewProjection);
+  const std::vector<AnimationLodLevel>& levels = m_settings.levels;
+
+  m_stats = AnimationSchedulerStats();
+  m_stats.registered = static_cast<unsigned int>(m_entries.size());
+  m_stats.lodBias = m_lodBias;
+  m_due.clear();
+  m_interpolating.clear();
+  if (levels.empty()) {
+    return;
+  }
+
+  // 1) Visibilidad, tamaño en pantalla y nivel de LOD
+  for (Entry& e : m_entries) {
+    if (!e.animator->isPlaying()) {
+      continue;
+    }
+    e.pendingTime += deltaTime;
+    ++e.framesSinceUpdate;
+
+    const EU::Vector3& p = e.transform->getPosition();
+    const EU::Vector3& s = e.transform->getScale();
+    float radius = e.radius * std::max(std::fabs(s.x), std::max(std::fabs(s.y), std::fabs(s.z)));
+    if (!frustum.intersectsSphere(p.x, p.y, p.z, radius)) {
+      ++m_stats.culled;
+      continue;
+    }
+    ++m_stats.visible;
+
+    float dx = p.x - eyePosition.x, dy = p.y - eyePosition.y, dz = p.z - eyePosition.z;
+    float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), 1e-3f);
+    e.screenSize = radius * projScaleY * viewportHeight / distance;
+
+    float biasedSize = e.screenSize * m_lodBias;
+    int level = static_cast<int>(levels.size()) - 1;
+    for (int i = 0; i < static_cast<int>(levels.size()); ++i) {
+      if (biasedSize >= levels[i].minScreenSize) {
+        level = i;
+        break;
+      }
+    }
+    e.level = level;
+    ++m_stats.perLevel[std::min(level, 7)];
+
+    const AnimationLodLevel& lod = levels[level];
+    unsigned int interval = std::max(1u, lod.updateInterval);
+    bool due = e.framesSinceUpdate >= interval &&
+               ((m_frameIndex + e.phase) % interval == 0 || e.framesSinceUpdate >= 2 * interval);
+    if (due) {
+      m_due.push_back(&e);
+    }
+    else if (lod.interpolate && e.hasTarget) {
+      m_interpolating.push_back(&e);
+    }
+    else {
+      ++m_stats.held;
+    }
+  }
+
+  // 2) Prioridad: tamaño en pantalla, y crece mientras más atrasado esté
+  auto priority = [&levels](const Entry* e) {
+    float interval = static_cast<float>(std::max(1u, levels[e->level].updateInterval));
+    return e->screenSize * (static_cast<float>(e->framesSinceUpdate) / interval);
+  };
+  std::sort(m_due.begin(), m_due.end(),
+            [&priority](const Entry* a, const Entry* b) { return priority(a) > priority(b); });
+
+  // 3) Evaluación por tandas paralelas hasta agotar el presupuesto
+  JobSystem& jobs = JobSystem::getInstance();
+  const size_t batchSize = std::max<size_t>(4, jobs.getNumThreads() * 4);
+
+  size_t processed = 0;
+  while (processed < m_due.size()) {
+    if (processed > 0 && timer.elapsedMs() > m_settings.budgetMs) {
+      m_stats.deferred += static_cast<unsigned int>(m_due.size() - processed);
+      break;
+    }
+    size_t count = std::min(batchSize, m_due.size() - processed);
+    Entry** batch = &m_due[processed];
+    jobs.parallelFor(count, 1, [batch, &levels](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        Entry& e = *batch[i];
+        const AnimationLodLevel& lod = levels[e.level];
+        e.animator->setBoneLod(lod.maxBoneDepth);
+        e.animator->samplePose(e.pendingTime);
+        if (lod.interpolate) {
+          // Muestro la pose anterior y voy hacia la nueva durante el siguiente intervalo
+          e.animator->pushInterpolationTarget();
+          e.animator->interpolatePose(0.0f);
+          e.hasTarget = true;
+        }
+        else {
+          e.hasTarget = false;
+        }
+        e.animator->applyPose();
+        e.pendingTime = 0.0f;
+        e.framesSinceUpdate = 0;
+      }
+    });
+    processed += count;
+  }
+  m_stats.evaluated = static_cast<unsigned int>(processed);
+
+  // 4) Interpolación entre actualizaciones (solo skinning) si queda presupuesto
+  if (!m_interpolating.empty() && timer.elapsedMs() <= m_settings.budgetMs) {
+    jobs.parallelFor(m_interpolating.size(), 4, [this, &levels](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        Entry& e = *m_interpolating[i];
+        float interval = static_cast<float>(std::max(1u, levels[e.level].updateInterval));
+        e.animator->interpolatePose(std::min(1.0f, e.framesSinceUpdate / interval));
+        e.animator->applyPose();
+      }
+    });
+    m_stats.interpolated = static_cast<unsigned int>(m_interpolating.size());
+  }
+  else {
+    m_stats.held += static_cast<unsigned int>(m_interpolating.size());
+  }
+
+  // 5) Sesgo adaptativo: si me paso del presupuesto bajo el detalle, si sobra lo subo poco a poco
+  m_stats.timeMs = timer.elapsedMs();
+  if (m_settings.adaptiveBias) {
+    if (m_stats.timeMs > m_settings.budgetMs) {
+      m_lodBias = std::max(0.1f, m_lodBias * 0.85f);
+    }
+    else if (m_stats.timeMs < m_settings.budgetMs * 0.6f) {
+      m_lodBias = std::min(1.0f, m_lodBias * 1.05f);
+    }
+  }
+  ++m_frameIndex;
+}
+
+void
+AnimationScheduler::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numBones = 48;
+  const unsigned int numCharacters = 400;
+  const unsigned int verticesPerCharacter = 2000;
+  const int numFrames = 120;
+  const float dt = 1.0f / 60.0f;
+  const float viewportHeight = 1080.0f;
+
+  Skeleton skeleton = SyntheticAnimation::makeSkeleton(numBones);
+  CompressedAnimationClip clip;
+  clip.compress(SyntheticAnimation::makeClip(numBones, 3.0f, 0.0f));
+
+  std::vector<MeshComponent> meshes(1);
+  meshes[0] = SyntheticAnimation::makeSkinnedMesh(verticesPerCharacter, numBones, 7);
+
+  // Plaza de 20 x 20 personajes separados 6 m; la cámara mira desde una orilla
+  std::vector<Transform> transforms(numCharacters);
+  std::vector<Animator> animators(numCharacters);
+  for (unsigned int i = 0; i < numCharacters; ++i) {
+    float x = static_cast<float>(i % 20) * 6.0f - 57.0f;
+    float z = static_cast<float>(i / 20) * 6.0f + 2.0f;
+    transforms[i].setTransform(EU::Vector3(x, 0.0f, z),
+                               EU::Vector3(0.0f, 0.0f, 0.0f),
+                               EU::Vector3(1.0f, 1.0f, 1.0f));
+    animators[i].setup(&skeleton, meshes);
+    animators[i].play(&clip, true);
+  }
+
+  XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, -2.0f, 0.0f),
+                                   XMVectorSet(0.0f, 1.0f, 10.0f, 0.0f),
+                                   XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+  XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 500.0f);
+  XMFLOAT4X4 viewProjection;
+  XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, projection));
+  XMFLOAT4X4 projectionValues;
+  XMStoreFloat4x4(&projectionValues, projection);
+  const XMFLOAT3 eye(0.0f, 2.0f, -2.0f);
+
+  report.log("%u characters, %u bones, %u vertices each, %d frames",
+             numCharacters, numBones, verticesPerCharacter, numFrames);
+
+  // Referencia: todos cada frame
+  double worstMs = 0.0;
+  Timer total;
+  for (int f = 0; f < numFrames; ++f) {
+    Timer frame;
+    for (Animator& animator : animators) {
+      animator.update(dt);
+    }
+    worstMs = std::max(worstMs, frame.elapsedMs());
+  }
+  report.log("%-26s avg %8.3f ms/frame, worst %8.3f ms", "every frame", total.elapsedMs() / numFrames, worstMs);
+
+  const float budgets[2] = { 1000.0f, 2.0f };
+  const char* names[2] = { "scheduler (no budget)", "scheduler (2 ms budget)" };
+  for (int b = 0; b < 2; ++b) {
+    AnimationScheduler scheduler;
+    AnimationSchedulerSettings settings;
+    settings.budgetMs = budgets[b];
+    settings.adaptiveBias = budgets[b] < 100.0f;
+    scheduler.setSettings(settings);
+    for (unsigned int i = 0; i < numCharacters; ++i) {
+      scheduler.add(&animators[i], &transforms[i], 1.2f);
+    }
+
+    AnimationSchedulerStats sum;
+    worstMs = 0.0;
+    Timer schedulerTotal;
+    for (int f = 0; f < numFrames; ++f) {
+      scheduler.update(dt, viewProjection, eye, projectionValues._22, viewportHeight);
+      const AnimationSchedulerStats& stats = scheduler.getStats();
+      worstMs = std::max(worstMs, stats.timeMs);
+      sum.visible += stats.visible;
+      sum.culled += stats.culled;
+      sum.evaluated += stats.evaluated;
+      sum.interpolated += stats.interpolated;
+      sum.held += stats.held;
+      sum.deferred += stats.deferred;
+      for (int l = 0; l < 8; ++l) {
+        sum.perLevel[l] += stats.perLevel[l];
+      }
+    }
+    report.log("%-26s avg %8.3f ms/frame, worst %8.3f ms, final LOD bias %.2f",
+               names[b], schedulerTotal.elapsedMs() / numFrames, worstMs, scheduler.getStats().lodBias);
+    report.log("  per frame: visible %u, culled %u, evaluated %u, interpolated %u, held %u, deferred %u",
+               sum.visible / numFrames, sum.culled / numFrames, sum.evaluated / numFrames,
+               sum.interpolated / numFrames, sum.held / numFrames, sum.deferred / numFrames);
+    report.log("  LOD levels: %u / %u / %u / %u",
+               sum.perLevel[0] / numFrames, sum.perLevel[1] / numFrames,
+               sum.perLevel[2] / numFrames, sum.perLevel[3] / numFrames);
+
+    for (unsigned int i = 0; i < numCharacters; ++i) {
+      scheduler.remove(&animators[i]);
+    }
+  }
+}
@@ -0,0 +1,257 @@
+#include "Animation/Animator.h"
+#include "Animation/PoseBlend.h"
+#include "Timer.h"
+
+void
+Animator::setup(const Skeleton* skeleton, const std::vector<MeshComponent>& meshes) {
+  m_skeleton = skeleton;
+  m_clip = nullptr;
+  m_time = 0.0f;
+
+  const unsigned int numBones = skeleton ? skeleton->getBoneCount() : 0;
+  m_localPose.resize(numBones);
+  m_scratchPose.resize(numBones);
+  m_layers.clear();
+  m_fadeClip = nullptr;
+  m_boneLodDepth = -1;
+  m_boneLodMask.clear();
+  m_previousPose.clear();
+  m_targetPose.clear();
+  m_palette.resize(numBones);
+  m_dualQuatPalette.resize(numBones);
+
+  m_meshData.clear();
+  m_meshData.resize(meshes.size());
+  m_skinnedVertices.clear();
+  m_skinnedVertices.resize(meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    if (meshes[i].m_skin.empty()) {
+      continue;
+    }
+    if (m_meshData[i].build(meshes[i])) {
+      // Inicializo con los vértices originales: el kernel solo reescribe la posición
+      m_skinnedVertices[i] = meshes[i].m_vertex;
+    }
+  }
+
+  if (skeleton) {
+    skeleton->getBindPose(m_localPose.data());
+    applyPose();
+  }
+}
+
+void
+Animator::play(const CompressedAnimationClip* clip, bool loop) {
+  if (clip && m_skeleton && clip->getNumBones() != m_skeleton->getBoneCount()) {
+    ERROR("Animator", "play", "Clip does not match the skeleton: " << clip->getName().c_str());
+    return;
+  }
+  m_clip = clip;
+  m_loop = loop;
+  m_time = 0.0f;
+  m_cursor.keys.clear();
+  m_fadeClip = nullptr;
+}
+
+void
+Animator::crossFade(const CompressedAnimationClip* clip, float duration, bool loop) {
+  if (!m_clip || duration <= 0.0f) {
+    play(clip, loop);
+    return;
+  }
+
+  // El clip actual pasa a ser el que se apaga, con su tiempo y su cursor
+  const CompressedAnimationClip* previous = m_clip;
+  float previousTime = m_time;
+  bool previousLoop = m_loop;
+  CompressedAnimationClip::SampleCursor previousCursor = m_cursor;
+
+  play(clip, loop);
+  if (!m_clip) {
+    return;
+  }
+  m_fadeClip = previous;
+  m_fadeTime = previousTime;
+  m_fadeLoop = previousLoop;
+  m_fadeCursor = previousCursor;
+  m_fadeElapsed = 0.0f;
+  m_fadeDuration = duration;
+}
+
+int
+Animator::addLayer(const CompressedAnimationClip* clip,
+                   float weight,
+                   const std::vector<float>& boneMask,
+                   bool additive) {
+  if (!clip || !m_skeleton || clip->getNumBones() != m_skeleton->getBoneCount()) {
+    ERROR("Animator", "addLayer", "Layer clip does not match the skeleton");
+    return -1;
+  }
+
+  Layer layer;
+  layer.clip = clip;
+  layer.weight = weight;
+  layer.additive = additive;
+  layer.boneMask = boneMask;
+  if (additive) {
+    // La referencia de una capa aditiva es su primer frame
+    layer.referencePose.resize(clip->getNumBones());
+    clip->sample(0.0f, false, layer.referencePose.data());
+  }
+  m_layers.push_back(std::move(layer));
+  return static_cast<int>(m_layers.size()) - 1;
+}
+
+void
+Animator::setLayerWeight(int layer, float weight) {
+  if (layer >= 0 && layer < static_cast<int>(m_layers.size())) {
+    m_layers[layer].weight = weight;
+  }
+}
+
+void
+Animator::stop() {
+  m_clip = nullptr;
+  m_fadeClip = nullptr;
+  m_time = 0.0f;
+  if (m_skeleton) {
+    m_skeleton->getBindPose(m_localPose.data());
+    applyPose();
+  }
+}
+
+void
+Animator::update(float deltaTime) {
+  // Si lo maneja el AnimationScheduler, él decide cuándo muestrear y skinnear
+  if (m_scheduled || !m_skeleton || !m_clip) {
+    return;
+  }
+  samplePose(deltaTime);
+  applyPose();
+}
+
+void
+Animator::samplePose(float deltaTime) {
+  if (!m_skeleton || !m_clip) {
+    return;
+  }
+
+  const uint8_t* boneMask = m_boneLodMask.empty() ? nullptr : m_boneLodMask.data();
+  const unsigned int numBones = m_skeleton->getBoneCount();
+  const float step = deltaTime * m_speed;
+  m_time += step;
+  m_clip->sample(m_time, m_loop, m_localPose.data(), &m_cursor, boneMask);
+
+  if (m_fadeClip) {
+    m_fadeTime += step;
+    m_fadeElapsed += deltaTime;
+    float weight = m_fadeElapsed / m_fadeDuration;
+    if (weight >= 1.0f) {
+      m_fadeClip = nullptr;
+    }
+    else {
+      m_fadeClip->sample(m_fadeTime, m_fadeLoop, m_scratchPose.data(), &m_fadeCursor, boneMask);
+      PoseBlend::blend(m_scratchPose.data(), m_localPose.data(), weight, numBones, m_localPose.data());
+    }
+  }
+
+  for (Layer& layer : m_layers) {
+    layer.time += step;
+    if (layer.weight <= 0.0f) {
+      continue;
+    }
+    const float* mask = layer.boneMask.size() == numBones ? layer.boneMask.data() : nullptr;
+    layer.clip->sample(layer.time, true, m_scratchPose.data(), &layer.cursor, boneMask);
+    if (layer.additive) {
+      PoseBlend::makeAdditive(m_scratchPose.data(), layer.referencePose.data(), numBones, m_scratchPose.data());
+      PoseBlend::applyAdditive(m_localPose.data(), m_scratchPose.data(), layer.weight, mask, numBones, m_localPose.data());
+    }
+    else if (mask) {
+      PoseBlend::blendMasked(m_localPose.data(), m_scratchPose.data(), layer.weight, mask, numBones, m_localPose.data());
+    }
+    else {
+      PoseBlend::blend(m_localPose.data(), m_scratchPose.data(), layer.weight, numBones, m_localPose.data());
+    }
+  }
+}
+
+void
+Animator::setBoneLod(int maxDepth) {
+  if (maxDepth == m_boneLodDepth || !m_skeleton) {
+    return;
+  }
+  m_boneLodDepth = maxDepth;
+  if (maxDepth < 0) {
+    m_boneLodMask.clear();
+    return;
+  }
+
+  // Los huesos más profundos (dedos, accesorios) se quedan con su última pose
+  const std::vector<Bone>& bones = m_skeleton->getBones();
+  m_boneLodMask.resize(bones.size());
+  for (size_t i = 0; i < bones.size(); ++i) {
+    m_boneLodMask[i] = bones[i].depth <= maxDepth ? 1 : 0;
+  }
+}
+
+void
+Animator::pushInterpolationTarget() {
+  if (m_targetPose.size() != m_localPose.size()) {
+    m_previousPose = m_localPose;
+    m_targetPose = m_localPose;
+    return;
+  }
+  m_previousPose.swap(m_targetPose);
+  m_targetPose = m_localPose;
+}
+
+void
+Animator::interpolatePose(float t) {
+  if (m_previousPose.size() != m_localPose.size()) {
+    return;
+  }
+  PoseBlend::blend(m_previousPose.data(), m_targetPose.data(), t,
+                   static_cast<unsigned int>(m_localPose.size()), m_localPose.data());
+}
+
+void
+Animator::applyPose() {
+  if (!m_skeleton) {
+    return;
+  }
+  Timer timer;
+  const unsigned int numBones = m_skeleton->getBoneCount();
+  m_skeleton->computeSkinningPaletteFromLocal(m_localPose.data(), m_palette.data());
+  if (m_method == SkinningMethod::DualQuaternion) {
+    SkinningKernel::buildDualQuaternionPalette(m_palette.data(), numBones, m_dualQuatPalette.data());
+  }
+
+  m_jobs.clear();
+  for (size_t i = 0; i < m_meshData.size(); ++i) {
+    if (!isSkinned(i)) {
+      continue;
+    }
+    SkinningJob job;
+    job.mesh = &m_meshData[i];
+    job.palette = m_palette.data();
+    job.dualQuatPalette = m_dualQuatPalette.data();
+    job.method = m_method;
+    job.output = m_skinnedVertices[i].data();
+    m_jobs.push_back(job);
+  }
+
+  SkinningKernel::skinMeshes(m_jobs.data(), m_jobs.size(), m_multithreaded);
+  m_hasNewPose = true;
+  m_lastSkinningMs = timer.elapsedMs();
+}
+
+void
+Animator::destroy() {
+  m_skeleton = nullptr;
+  m_clip = nullptr;
+  m_fadeClip = nullptr;
+  m_layers.clear();
+  m_meshData.clear();
+  m_skinnedVertices.clear();
+  m_jobs.clear();
+}
@@ -0,0 +1,462 @@
+#include "Animation/CompressedAnimationClip.h"
+#include "Animation/PoseBlend.h"
+#include "Animation/SyntheticAnimation.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+
+namespace {
+
+  using Float3 = std::array<float, 3>;
+
+  /// @brief Rango de los tres componentes pequeños de un cuaternión unitario: [-1/sqrt(2), 1/sqrt(2)].
+  const float kSmallestThreeRange = 0.70710678f;
+  const float kMax15 = 32767.0f;
+  const float kMax16 = 65535.0f;
+
+  inline uint16_t
+    quantize(float value, float maxValue) {
+    float v = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint16_t>(v * maxValue + 0.5f);
+  }
+
+  /**
+   * @brief Smallest three: guardo los 3 componentes más pequeños en 15 bits cada uno y
+   *        el índice del mayor en los bits altos de los dos primeros.
+   */
+  void
+    encodeRotation(const Quaternion& q, uint16_t out[3]) {
+    float c[4] = { q.x, q.y, q.z, q.w };
+    int largest = 0;
+    for (int i = 1; i < 4; ++i) {
+      if (std::fabs(c[i]) > std::fabs(c[largest])) {
+        largest = i;
+      }
+    }
+    float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint16_t v[3];
+    for (int i = 0, j = 0; i < 4; ++i) {
+      if (i == largest) {
+        continue;
+      }
+      v[j++] = quantize((c[i] * sign / kSmallestThreeRange) * 0.5f + 0.5f, kMax15);
+    }
+    out[0] = static_cast<uint16_t>(v[0] | ((largest >> 1) << 15));
+    out[1] = static_cast<uint16_t>(v[1] | ((largest & 1) << 15));
+    out[2] = v[2];
+  }
+
+  /**
+   * @brief Inverso de encodeRotation. El resultado ya es unitario salvo el error de cuantización.
+   */
+  inline Quaternion
+    decodeRotationBits(const uint16_t in[3]) {
+    const float scale = 2.0f * kSmallestThreeRange / kMax15;
+    float a = static_cast<float>(in[0] & 0x7FFF) * scale - kSmallestThreeRange;
+    float b = static_cast<float>(in[1] & 0x7FFF) * scale - kSmallestThreeRange;
+    float c = static_cast<float>(in[2] & 0x7FFF) * scale - kSmallestThreeRange;
+    float d = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+
+    switch (((in[0] >> 15) << 1) | (in[1] >> 15)) {
+      case 0:  return { d, a, b, c };
+      case 1:  return { a, d, b, c };
+      case 2:  return { a, b, d, c };
+      default: return { a, b, c, d };
+    }
+  }
+
+  inline float
+    rotationError(const Quaternion& a, const Quaternion& b) {
+    float d = std::min(1.0f, std::fabs(AnimMath::dot(a, b)));
+    return 2.0f * std::acos(d);
+  }
+
+  inline float
+    vectorError(const Float3& a, const Float3& b) {
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+
+  inline Float3
+    lerp3(const Float3& a, const Float3& b, float t) {
+    return { a[0] + (b[0] - a[0]) * t, a[1] + (b[1] - a[1]) * t, a[2] + (b[2] - a[2]) * t };
+  }
+
+  /**
+   * @brief Reducción greedy: desde cada key extiendo el segmento lo más posible mientras
+   *        la interpolación de los valores ya cuantizados siga dentro de la tolerancia.
+   */
+  template<typename T, typename LerpFunc, typename ErrorFunc>
+  void
+    reduceTrack(const std::vector<T>& decoded,
+                const std::vector<T>& raw,
+                float tolerance,
+                LerpFunc lerpFunc,
+                ErrorFunc errorFunc,
+                std::vector<uint16_t>& outKeys) {
+    const unsigned int numFrames = static_cast<unsigned int>(raw.size());
+    outKeys.clear();
+    outKeys.push_back(0);
+
+    // Track constante: un solo key
+    bool constant = true;
+    for (unsigned int f = 1; f < numFrames && constant; ++f) {
+      constant = errorFunc(decoded[0], raw[f]) <= tolerance;
+    }
+    if (constant) {
+      return;
+    }
+
+    auto spanFits = [&](unsigned int a, unsigned int b) {
+      float invSpan = 1.0f / static_cast<float>(b - a);
+      for (unsigned int f = a + 1; f < b; ++f) {
+        T value = lerpFunc(decoded[a], decoded[b], (f - a) * invSpan);
+        if (errorFunc(value, raw[f]) > tolerance) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    unsigned int start = 0;
+    while (start < numFrames - 1) {
+      unsigned int end = start + 1;
+      while (end + 1 < numFrames && spanFits(start, end + 1)) {
+        ++end;
+      }
+      outKeys.push_back(static_cast<uint16_t>(end));
+      start = end;
+    }
+  }
+
+} // namespace
+
+bool
+CompressedAnimationClip::compress(const AnimationClip& clip,
+                                  const AnimationCompressionSettings& settings) {
+  m_tracks.clear();
+  m_keyFrames.clear();
+  m_keyData.clear();
+
+  if (clip.getNumBones() == 0 || clip.getNumFrames() == 0) {
+    ERROR("CompressedAnimationClip", "compress", "Empty clip: " << clip.getName().c_str());
+    return false;
+  }
+  if (clip.getNumFrames() > 65535) {
+    ERROR("CompressedAnimationClip", "compress", "Clip too long: " << clip.getName().c_str());
+    return false;
+  }
+
+  m_name = clip.getName();
+  m_duration = clip.getDuration();
+  m_sampleRate = clip.getSampleRate();
+  m_numFrames = clip.getNumFrames();
+  m_numBones = clip.getNumBones();
+  m_tracks.resize(static_cast<size_t>(m_numBones) * TRACK_COUNT);
+
+  std::vector<Quaternion> rawRot(m_numFrames), decodedRot(m_numFrames);
+  std::vector<Float3> rawVec(m_numFrames), decodedVec(m_numFrames);
+  std::vector<uint16_t> bits(static_cast<size_t>(m_numFrames) * 3);
+  std::vector<uint16_t> keys;
+
+  auto appendKeys = [&](Track& track) {
+    track.firstKey = static_cast<uint32_t>(m_keyFrames.size());
+    track.numKeys = static_cast<uint32_t>(keys.size());
+    for (uint16_t frame : keys) {
+      m_keyFrames.push_back(frame);
+      m_keyData.insert(m_keyData.end(), &bits[frame * 3], &bits[frame * 3] + 3);
+    }
+  };
+
+  for (unsigned int b = 0; b < m_numBones; ++b) {
+    // Rotación
+    for (unsigned int f = 0; f < m_numFrames; ++f) {
+      rawRot[f] = clip.getFrame(f)[b].rotation;
+      encodeRotation(rawRot[f], &bits[f * 3]);
+      decodedRot[f] = decodeRotationBits(&bits[f * 3]);
+    }
+    reduceTrack(decodedRot, rawRot, settings.rotationTolerance,
+                AnimMath::nlerp, rotationError, keys);
+    appendKeys(m_tracks[b * TRACK_COUNT + TRACK_ROTATION]);
+
+    // Traslación y escala: cuantizo al rango del track
+    for (int type = TRACK_TRANSLATION; type <= TRACK_SCALE; ++type) {
+      Track& track = m_tracks[b * TRACK_COUNT + type];
+      float tolerance = type == TRACK_TRANSLATION ? settings.translationTolerance
+                                                  : settings.scaleTolerance;
+      float minValue[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+      float maxValue[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+      for (unsigned int f = 0; f < m_numFrames; ++f) {
+        const BoneTransform& bt = clip.getFrame(f)[b];
+        const float* v = type == TRACK_TRANSLATION ? bt.translation : bt.scale;
+        for (int c = 0; c < 3; ++c) {
+          rawVec[f][c] = v[c];
+          minValue[c] = std::min(minValue[c], v[c]);
+          maxValue[c] = std::max(maxValue[c], v[c]);
+        }
+      }
+      for (int c = 0; c < 3; ++c) {
+        track.rangeMin[c] = minValue[c];
+        track.rangeExtent[c] = maxValue[c] - minValue[c];
+        track.rangeScale[c] = track.rangeExtent[c] / kMax16;
+      }
+      for (unsigned int f = 0; f < m_numFrames; ++f) {
+        for (int c = 0; c < 3; ++c) {
+          float extent = track.rangeExtent[c];
+          float normalized = extent > 0.0f ? (rawVec[f][c] - track.rangeMin[c]) / extent : 0.0f;
+          bits[f * 3 + c] = quantize(normalized, kMax16);
+          decodedVec[f][c] = track.rangeMin[c] + bits[f * 3 + c] * track.rangeScale[c];
+        }
+      }
+      reduceTrack(decodedVec, rawVec, tolerance, lerp3, vectorError, keys);
+      appendKeys(track);
+    }
+  }
+  return true;
+}
+
+uint32_t
+CompressedAnimationClip::findKey(const Track& track, float framePos, uint16_t* hint) const {
+  const uint16_t* frames = &m_keyFrames[track.firstKey];
+  const uint32_t lastSegment = track.numKeys - 2;
+
+  if (hint) {
+    uint32_t k = *hint;
+    // Caso común: el tiempo avanzó un poco, el segmento es el mismo o el siguiente
+    if (k <= lastSegment && frames[k] <= framePos) {
+      while (k < lastSegment && frames[k + 1] <= framePos) {
+        ++k;
+      }
+      *hint = static_cast<uint16_t>(k);
+      return k;
+    }
+  }
+
+  const uint16_t* it = std::upper_bound(frames, frames + track.numKeys, framePos,
+                                        [](float value, uint16_t frame) { return value < frame; });
+  uint32_t k = it == frames ? 0 : static_cast<uint32_t>(it - frames) - 1;
+  k = std::min(k, lastSegment);
+  if (hint) {
+    *hint = static_cast<uint16_t>(k);
+  }
+  return k;
+}
+
+void
+CompressedAnimationClip::decodeVector(const Track& track, uint32_t key, float out[3]) const {
+  const uint16_t* bits = &m_keyData[static_cast<size_t>(key) * 3];
+  for (int c = 0; c < 3; ++c) {
+    out[c] = track.rangeMin[c] + bits[c] * track.rangeScale[c];
+  }
+}
+
+Quaternion
+CompressedAnimationClip::decodeRotation(uint32_t key) const {
+  return decodeRotationBits(&m_keyData[static_cast<size_t>(key) * 3]);
+}
+
+void
+CompressedAnimationClip::sample(float time,
+                                bool loop,
+                                BoneTransform* outPose,
+                                SampleCursor* cursor,
+                                const uint8_t* boneMask) const {
+  if (m_tracks.empty()) {
+    return;
+  }
+
+  float framePos = AnimMath::wrapTime(time, m_duration, loop) * m_sampleRate;
+  framePos = std::min(framePos, static_cast<float>(m_numFrames - 1));
+
+  uint16_t* hints = nullptr;
+  if (cursor) {
+    if (cursor->keys.size() != m_tracks.size()) {
+      cursor->keys.assign(m_tracks.size(), 0);
+    }
+    hints = cursor->keys.data();
+  }
+
+  for (unsigned int b = 0; b < m_numBones; ++b) {
+    if (boneMask && !boneMask[b]) {
+      continue;
+    }
+    BoneTransform& out = outPose[b];
+    for (int type = 0; type < TRACK_COUNT; ++type) {
+      size_t trackIndex = static_cast<size_t>(b) * TRACK_COUNT + type;
+      const Track& track = m_tracks[trackIndex];
+
+      uint32_t key0 = track.firstKey;
+      uint32_t key1 = key0;
+      float t = 0.0f;
+      if (track.numKeys > 1) {
+        uint32_t k = findKey(track, framePos, hints ? &hints[trackIndex] : nullptr);
+        key0 = track.firstKey + k;
+        key1 = key0 + 1;
+        float f0 = m_keyFrames[key0];
+        float f1 = m_keyFrames[key1];
+        t = std::min(1.0f, std::max(0.0f, (framePos - f0) / (f1 - f0)));
+      }
+
+      if (type == TRACK_ROTATION) {
+        Quaternion q0 = decodeRotation(key0);
+        out.rotation = key1 == key0 ? q0 : AnimMath::nlerp(q0, decodeRotation(key1), t);
+      }
+      else {
+        float* dst = type == TRACK_TRANSLATION ? out.translation : out.scale;
+        float v0[3], v1[3];
+        decodeVector(track, key0, v0);
+        if (key1 == key0) {
+          dst[0] = v0[0]; dst[1] = v0[1]; dst[2] = v0[2];
+        }
+        else {
+          decodeVector(track, key1, v1);
+          for (int c = 0; c < 3; ++c) {
+            dst[c] = v0[c] + (v1[c] - v0[c]) * t;
+          }
+        }
+      }
+    }
+  }
+}
+
+size_t
+CompressedAnimationClip::getSizeInBytes() const {
+  return sizeof(*this) +
+         m_name.capacity() +
+         m_tracks.size() * sizeof(Track) +
+         m_keyFrames.size() * sizeof(uint16_t) +
+         m_keyData.size() * sizeof(uint16_t);
+}
+
+void
+CompressedAnimationClip::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numBones = 64;
+  const unsigned int numClips = 8;
+  const unsigned int numCharacters = 10000;
+  const int numFrames = 30;
+  const float dt = 1.0f / 60.0f;
+  const AnimationCompressionSettings settings;
+
+  std::vector<AnimationClip> rawClips;
+  std::vector<CompressedAnimationClip> clips(numClips);
+  size_t rawBytes = 0, compressedBytes = 0;
+  float maxRotError = 0.0f, maxPosError = 0.0f;
+
+  Timer compressTimer;
+  for (unsigned int c = 0; c < numClips; ++c) {
+    rawClips.push_back(SyntheticAnimation::makeClip(numBones, 2.0f + c * 0.5f, c * 0.77f));
+  }
+  for (unsigned int c = 0; c < numClips; ++c) {
+    clips[c].compress(rawClips[c], settings);
+  }
+  double compressMs = compressTimer.elapsedMs();
+
+  std::vector<BoneTransform> rawPose(numBones), pose(numBones);
+  for (unsigned int c = 0; c < numClips; ++c) {
+    rawBytes += clips[c].getRawSizeInBytes();
+    compressedBytes += clips[c].getSizeInBytes();
+
+    // Error medido en frames y a medio frame
+    for (unsigned int f = 0; f + 1 < clips[c].getNumFrames() * 2; ++f) {
+      float time = f * 0.5f / clips[c].getSampleRate();
+      rawClips[c].sample(time, false, rawPose.data());
+      clips[c].sample(time, false, pose.data());
+      for (unsigned int b = 0; b < numBones; ++b) {
+        maxRotError = std::max(maxRotError, rotationError(rawPose[b].rotation, pose[b].rotation));
+        Float3 a = { rawPose[b].translation[0], rawPose[b].translation[1], rawPose[b].translation[2] };
+        Float3 d = { pose[b].translation[0], pose[b].translation[1], pose[b].translation[2] };
+        maxPosError = std::max(maxPosError, vectorError(a, d));
+      }
+    }
+  }
+
+  report.log("%u clips, %u bones, 30 Hz, compressed in %.2f ms", numClips, numBones, compressMs);
+  report.log("memory per clip: raw %.1f KB, compressed %.1f KB (%.1fx smaller)",
+             rawBytes / 1024.0 / numClips, compressedBytes / 1024.0 / numClips,
+             static_cast<double>(rawBytes) / compressedBytes);
+  report.log("max error: rotation %.5f rad, translation %.5f (tolerance %.5f rad / %.5f)",
+             maxRotError, maxPosError, settings.rotationTolerance, settings.translationTolerance);
+  // Entre frames la referencia cruda también interpola, así que dejo margen sobre la tolerancia
+  if (maxRotError > settings.rotationTolerance * 2.0f ||
+      maxPosError > settings.translationTolerance * 2.0f) {
+    report.fail("compressed clip error exceeds tolerance");
+  }
+
+  // 10k personajes con clip y fase distintos, cada uno con su pose y su cursor
+  std::vector<BoneTransform> poses(static_cast<size_t>(numCharacters) * numBones);
+  std::vector<CompressedAnimationClip::SampleCursor> cursors(numCharacters);
+  std::vector<float> times(numCharacters);
+  auto resetTimes = [&]() {
+    for (unsigned int i = 0; i < numCharacters; ++i) {
+      times[i] = i * 0.37f;
+    }
+  };
+
+  report.log("%u characters, %d frames:", numCharacters, numFrames);
+  report.log("%-28s %12s %16s", "variant", "ms/frame", "characters/ms");
+
+  auto measure = [&](const char* name, const std::function<void(size_t, size_t)>& body, bool threaded) {
+    resetTimes();
+    Timer timer;
+    for (int frame = 0; frame < numFrames; ++frame) {
+      if (threaded) {
+        JobSystem::getInstance().parallelFor(numCharacters, 256, body);
+      }
+      else {
+        body(0, numCharacters);
+      }
+    }
+    double ms = timer.elapsedMs() / numFrames;
+    report.log("%-28s %12.3f %16.0f", name, ms, numCharacters / ms);
+  };
+
+  measure("raw clip", [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      times[i] += dt;
+      rawClips[i % numClips].sample(times[i], true, &poses[i * numBones]);
+    }
+  }, false);
+  measure("compressed (search)", [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      times[i] += dt;
+      clips[i % numClips].sample(times[i], true, &poses[i * numBones]);
+    }
+  }, false);
+  measure("compressed (cursor)", [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      times[i] += dt;
+      clips[i % numClips].sample(times[i], true, &poses[i * numBones], &cursors[i]);
+    }
+  }, false);
+  measure("compressed (cursor+threads)", [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      times[i] += dt;
+      clips[i % numClips].sample(times[i], true, &poses[i * numBones], &cursors[i]);
+    }
+  }, true);
+
+  // Mezcla de dos clips por personaje (locomoción + capa de torso)
+  std::vector<BoneTransform> layerPoses(poses.size());
+  std::vector<float> mask(numBones);
+  for (unsigned int b = 0; b < numBones; ++b) {
+    mask[b] = b >= numBones / 2 ? 1.0f : 0.0f;
+  }
+  measure("2 clips + masked blend", [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      times[i] += dt;
+      BoneTransform* base = &poses[i * numBones];
+      BoneTransform* layer = &layerPoses[i * numBones];
+      clips[i % numClips].sample(times[i], true, base, &cursors[i]);
+      clips[(i + 1) % numClips].sample(times[i], true, layer);
+      PoseBlend::blendMasked(base, layer, 0.5f, mask.data(), numBones, base);
+    }
+  }, true);
+
+  size_t instanceBytes = numBones * sizeof(BoneTransform) + numBones * TRACK_COUNT * sizeof(uint16_t);
+  report.log("per-instance state: %zu bytes (pose + cursor), clips shared: %.1f KB total",
+             instanceBytes, compressedBytes / 1024.0);
+}
@@ -0,0 +1,118 @@
+#include "Animation/PoseBlend.h"
+#include "Animation/Skeleton.h"
+#include <algorithm>
+
+namespace {
+
+  /// @brief Transformación identidad (lo que "no suma nada" en una capa aditiva).
+  const BoneTransform kIdentity;
+
+} // namespace
+
+void
+PoseBlend::blend(const BoneTransform* a,
+                 const BoneTransform* b,
+                 float weight,
+                 unsigned int numBones,
+                 BoneTransform* out) {
+  if (weight <= 0.0f) {
+    std::copy(a, a + numBones, out);
+    return;
+  }
+  if (weight >= 1.0f) {
+    std::copy(b, b + numBones, out);
+    return;
+  }
+  for (unsigned int i = 0; i < numBones; ++i) {
+    out[i] = AnimMath::lerp(a[i], b[i], weight);
+  }
+}
+
+void
+PoseBlend::blendMasked(const BoneTransform* a,
+                       const BoneTransform* b,
+                       float weight,
+                       const float* boneMask,
+                       unsigned int numBones,
+                       BoneTransform* out) {
+  for (unsigned int i = 0; i < numBones; ++i) {
+    float w = weight * boneMask[i];
+    if (w <= 0.0f) {
+      out[i] = a[i];
+    }
+    else if (w >= 1.0f) {
+      out[i] = b[i];
+    }
+    else {
+      out[i] = AnimMath::lerp(a[i], b[i], w);
+    }
+  }
+}
+
+void
+PoseBlend::makeAdditive(const BoneTransform* pose,
+                        const BoneTransform* reference,
+                        unsigned int numBones,
+                        BoneTransform* outAdditive) {
+  for (unsigned int i = 0; i < numBones; ++i) {
+    BoneTransform delta;
+    for (int c = 0; c < 3; ++c) {
+      delta.translation[c] = pose[i].translation[c] - reference[i].translation[c];
+      float r = reference[i].scale[c];
+      delta.scale[c] = std::fabs(r) > 1e-8f ? pose[i].scale[c] / r : 1.0f;
+    }
+    delta.rotation = AnimMath::normalize(
+      AnimMath::mul(AnimMath::conjugate(reference[i].rotation), pose[i].rotation));
+    outAdditive[i] = delta;
+  }
+}
+
+void
+PoseBlend::applyAdditive(const BoneTransform* base,
+                         const BoneTransform* additive,
+                         float weight,
+                         const float* boneMask,
+                         unsigned int numBones,
+                         BoneTransform* out) {
+  for (unsigned int i = 0; i < numBones; ++i) {
+    float w = boneMask ? weight * boneMask[i] : weight;
+    if (w <= 0.0f) {
+      out[i] = base[i];
+      continue;
+    }
+
+    // Escalo la capa hacia la identidad según el peso y luego la aplico
+    BoneTransform delta = w >= 1.0f ? additive[i] : AnimMath::lerp(kIdentity, additive[i], w);
+    BoneTransform result;
+    for (int c = 0; c < 3; ++c) {
+      result.translation[c] = base[i].translation[c] + delta.translation[c];
+      result.scale[c] = base[i].scale[c] * delta.scale[c];
+    }
+    result.rotation = AnimMath::normalize(AnimMath::mul(base[i].rotation, delta.rotation));
+    out[i] = result;
+  }
+}
+
+void
+PoseBlend::buildSubtreeMask(const Skeleton& skeleton,
+                            int rootBone,
+                            float weight,
+                            std::vector<float>& outMask) {
+  const std::vector<Bone>& bones = skeleton.getBones();
+  outMask.assign(bones.size(), 0.0f);
+  if (rootBone < 0 || rootBone >= static_cast<int>(bones.size())) {
+    return;
+  }
+
+  // Los padres van antes que los hijos: basta con propagar hacia adelante
+  std::vector<bool> inSubtree(bones.size(), false);
+  inSubtree[rootBone] = true;
+  outMask[rootBone] = weight;
+  for (size_t i = rootBone + 1; i < bones.size(); ++i) {
+    int parent = bones[i].parent;
+    if (parent >= 0 && inSubtree[parent]) {
+      inSubtree[i] = true;
+      outMask[i] = weight;
+    }
+  }
+}
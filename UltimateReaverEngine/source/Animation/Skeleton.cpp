@@ -0,0 +1,51 @@
+#include "Animation/Skeleton.h"
+
+int
+Skeleton::addBone(const Bone& bone) {
+  if (bone.parent >= static_cast<int>(m_bones.size())) {
+    ERROR("Skeleton", "addBone", "Parent bone must be added before its children");
+    return -1;
+  }
+  int index = static_cast<int>(m_bones.size());
+  m_bones.push_back(bone);
+  m_bones.back().depth = bone.parent >= 0 ? m_bones[bone.parent].depth + 1 : 0;
+  m_nameLookup[bone.name] = index;
+  return index;
+}
+
+int
+Skeleton::findBone(const std::string& name) const {
+  auto it = m_nameLookup.find(name);
+  return it != m_nameLookup.end() ? it->second : -1;
+}
+
+void
+Skeleton::getBindPose(BoneTransform* outLocal) const {
+  for (size_t i = 0; i < m_bones.size(); ++i) {
+    outLocal[i] = m_bones[i].bindLocal;
+  }
+}
+
+void
+Skeleton::computeGlobalPose(const BoneTransform* local, Matrix3x4* outGlobal) const {
+  // Los padres siempre van antes que los hijos, así que basta un recorrido lineal
+  for (size_t i = 0; i < m_bones.size(); ++i) {
+    Matrix3x4 localMatrix = AnimMath::toMatrix(local[i]);
+    int parent = m_bones[i].parent;
+    outGlobal[i] = parent >= 0 ? AnimMath::mul(outGlobal[parent], localMatrix) : localMatrix;
+  }
+}
+
+void
+Skeleton::computeSkinningPalette(const Matrix3x4* global, Matrix3x4* outPalette) const {
+  for (size_t i = 0; i < m_bones.size(); ++i) {
+    outPalette[i] = AnimMath::mul(global[i], m_bones[i].inverseBindPose);
+  }
+}
+
+void
+Skeleton::computeSkinningPaletteFromLocal(const BoneTransform* local, Matrix3x4* outPalette) const {
+  m_scratchGlobal.resize(m_bones.size());
+  computeGlobalPose(local, m_scratchGlobal.data());
+  computeSkinningPalette(m_scratchGlobal.data(), outPalette);
+}
@@ -0,0 +1,762 @@
+#include "Animation/SkinningKernel.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <algorithm>
+#include <random>
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// El camino AVX2 se compila siempre y se elige en tiempo de ejecución (el proyecto no usa
+// `/arch:AVX2`). MSVC deja usar los intrínsecos sin bandera; GCC y Clang los piden por función.
+#if defined(_MSC_VER)
+#define SKINNING_TARGET_AVX2
+#else
+#define SKINNING_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace {
+
+  /// @brief Vértices por bloque al repartir entre hilos.
+  const unsigned int kVerticesPerTask = 16 * 1024;
+
+  inline void
+    cross(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  /**
+   * @brief Normalizo una dirección (una de largo 0, como las del relleno, se queda en 0).
+   */
+  inline void
+    normalize(float v[3]) {
+    const float inv = 1.0f / std::sqrt(std::max(v[0] * v[0] + v[1] * v[1] + v[2] * v[2], 1e-12f));
+    v[0] *= inv;
+    v[1] *= inv;
+    v[2] *= inv;
+  }
+
+  /**
+   * @brief Resultado de un bloque de vértices en SoA, antes de escribirlo al arreglo AoS.
+   */
+  struct
+    SkinnedLanes {
+    alignas(32) float pos[3][8];
+    alignas(32) float normal[3][8];
+    alignas(32) float tangent[3][8];
+  };
+
+  /**
+   * @brief Escribo posiciones, normales y tangentes calculadas en el arreglo AoS de salida.
+   */
+  inline void
+    storeVertices(SimpleVertex* output, unsigned int first, unsigned int count, const SkinnedLanes& lanes) {
+    for (unsigned int i = 0; i < count; ++i) {
+      SimpleVertex& vertex = output[first + i];
+      vertex.Pos = XMFLOAT3(lanes.pos[0][i], lanes.pos[1][i], lanes.pos[2][i]);
+      vertex.Normal = XMFLOAT3(lanes.normal[0][i], lanes.normal[1][i], lanes.normal[2][i]);
+      vertex.Tangent.x = lanes.tangent[0][i];
+      vertex.Tangent.y = lanes.tangent[1][i];
+      vertex.Tangent.z = lanes.tangent[2][i];
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  // SSE2: 4 vértices por iteración
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Cargo una fila de la matriz de hueso de cada uno de los 4 vértices y la
+   *        transpongo, así obtengo cada columna como un vector de 4 lanes.
+   */
+  inline void
+    loadRowSoA4(const Matrix3x4* palette,
+                const int* bones,
+                int row,
+                __m128& c0, __m128& c1, __m128& c2, __m128& c3) {
+    c0 = _mm_loadu_ps(palette[bones[0]].m[row]);
+    c1 = _mm_loadu_ps(palette[bones[1]].m[row]);
+    c2 = _mm_loadu_ps(palette[bones[2]].m[row]);
+    c3 = _mm_loadu_ps(palette[bones[3]].m[row]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+  }
+
+  /**
+   * @brief Normalizo 4 direcciones en SoA (igual que `normalize`).
+   */
+  inline void
+    normalizeSoA4(__m128 v[3]) {
+    const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], v[0]), _mm_mul_ps(v[1], v[1])), _mm_mul_ps(v[2], v[2]));
+    const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(len2, _mm_set1_ps(1e-12f))));
+    v[0] = _mm_mul_ps(v[0], inv);
+    v[1] = _mm_mul_ps(v[1], inv);
+    v[2] = _mm_mul_ps(v[2], inv);
+  }
+
+  /**
+   * @brief Roto 4 direcciones con 4 cuaterniones unitarios: v + 2 * r x (r x v + w * v).
+   */
+  inline void
+    rotateSoA4(__m128 rx, __m128 ry, __m128 rz, __m128 rw, __m128 v[3]) {
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 tx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(ry, v[2]), _mm_mul_ps(rz, v[1])), _mm_mul_ps(rw, v[0]));
+    const __m128 ty = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rz, v[0]), _mm_mul_ps(rx, v[2])), _mm_mul_ps(rw, v[1]));
+    const __m128 tz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rx, v[1]), _mm_mul_ps(ry, v[0])), _mm_mul_ps(rw, v[2]));
+    v[0] = _mm_add_ps(v[0], _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(ry, tz), _mm_mul_ps(rz, ty))));
+    v[1] = _mm_add_ps(v[1], _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(rz, tx), _mm_mul_ps(rx, tz))));
+    v[2] = _mm_add_ps(v[2], _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(rx, ty), _mm_mul_ps(ry, tx))));
+  }
+
+  void
+    skinLinearSSE2(const SkinningJob& job, unsigned int begin, unsigned int end) {
+    const SkinnedMeshData& mesh = *job.mesh;
+    const unsigned int numVertices = mesh.getNumVertices();
+    SkinnedLanes lanes;
+
+    for (unsigned int v = begin; v < end; v += 4) {
+      const __m128 px = _mm_loadu_ps(&mesh.m_posX[v]);
+      const __m128 py = _mm_loadu_ps(&mesh.m_posY[v]);
+      const __m128 pz = _mm_loadu_ps(&mesh.m_posZ[v]);
+      const __m128 nx = _mm_loadu_ps(&mesh.m_normalX[v]);
+      const __m128 ny = _mm_loadu_ps(&mesh.m_normalY[v]);
+      const __m128 nz = _mm_loadu_ps(&mesh.m_normalZ[v]);
+      const __m128 tx = _mm_loadu_ps(&mesh.m_tangentX[v]);
+      const __m128 ty = _mm_loadu_ps(&mesh.m_tangentY[v]);
+      const __m128 tz = _mm_loadu_ps(&mesh.m_tangentZ[v]);
+      __m128 accP[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+      __m128 accN[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+      __m128 accT[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+      // Por linealidad, sum(w * M) * p == sum(w * (M * p)): transformo con cada hueso y mezclo
+      for (int k = 0; k < 4; ++k) {
+        const __m128 w = _mm_loadu_ps(&mesh.m_weight[k][v]);
+        const int* bones = &mesh.m_bone[k][v];
+
+        for (int row = 0; row < 3; ++row) {
+          __m128 c0, c1, c2, c3;
+          loadRowSoA4(job.palette, bones, row, c0, c1, c2, c3);
+          const __m128 rp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, px), _mm_mul_ps(c1, py)),
+                                       _mm_add_ps(_mm_mul_ps(c2, pz), c3));
+          const __m128 rn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, nx), _mm_mul_ps(c1, ny)), _mm_mul_ps(c2, nz));
+          const __m128 rt = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, tx), _mm_mul_ps(c1, ty)), _mm_mul_ps(c2, tz));
+          accP[row] = _mm_add_ps(accP[row], _mm_mul_ps(w, rp));
+          accN[row] = _mm_add_ps(accN[row], _mm_mul_ps(w, rn));
+          accT[row] = _mm_add_ps(accT[row], _mm_mul_ps(w, rt));
+        }
+      }
+
+      // La mezcla de rotaciones acorta las direcciones: las renormalizo
+      normalizeSoA4(accN);
+      normalizeSoA4(accT);
+      for (int row = 0; row < 3; ++row) {
+        _mm_store_ps(lanes.pos[row], accP[row]);
+        _mm_store_ps(lanes.normal[row], accN[row]);
+        _mm_store_ps(lanes.tangent[row], accT[row]);
+      }
+      storeVertices(job.output, v, std::min(4u, numVertices - v), lanes);
+    }
+  }
+
+  void
+    skinDualQuatSSE2(const SkinningJob& job, unsigned int begin, unsigned int end) {
+    const SkinnedMeshData& mesh = *job.mesh;
+    const unsigned int numVertices = mesh.getNumVertices();
+    const DualQuaternion* dq = job.dualQuatPalette;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 tiny = _mm_set1_ps(1e-12f);
+    SkinnedLanes lanes;
+
+    for (unsigned int v = begin; v < end; v += 4) {
+      __m128 rx = zero, ry = zero, rz = zero, rw = zero;
+      __m128 dx = zero, dy = zero, dz = zero, dw = zero;
+      __m128 firstX = zero, firstY = zero, firstZ = zero, firstW = zero;
+
+      for (int k = 0; k < 4; ++k) {
+        const int* bones = &mesh.m_bone[k][v];
+        __m128 w = _mm_loadu_ps(&mesh.m_weight[k][v]);
+
+        __m128 qx = _mm_loadu_ps(&dq[bones[0]].real.x);
+        __m128 qy = _mm_loadu_ps(&dq[bones[1]].real.x);
+        __m128 qz = _mm_loadu_ps(&dq[bones[2]].real.x);
+        __m128 qw = _mm_loadu_ps(&dq[bones[3]].real.x);
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+        __m128 ex = _mm_loadu_ps(&dq[bones[0]].dual.x);
+        __m128 ey = _mm_loadu_ps(&dq[bones[1]].dual.x);
+        __m128 ez = _mm_loadu_ps(&dq[bones[2]].dual.x);
+        __m128 ew = _mm_loadu_ps(&dq[bones[3]].dual.x);
+        _MM_TRANSPOSE4_PS(ex, ey, ez, ew);
+
+        if (k == 0) {
+          firstX = qx; firstY = qy; firstZ = qz; firstW = qw;
+        }
+        else {
+          // Camino más corto: si el cuaternión apunta al hemisferio contrario del primero, lo invierto
+          __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, firstX), _mm_mul_ps(qy, firstY)),
+                                _mm_add_ps(_mm_mul_ps(qz, firstZ), _mm_mul_ps(qw, firstW)));
+          __m128 negative = _mm_cmplt_ps(d, zero);
+          w = _mm_sub_ps(w, _mm_and_ps(negative, _mm_add_ps(w, w)));
+        }
+
+        rx = _mm_add_ps(rx, _mm_mul_ps(w, qx));
+        ry = _mm_add_ps(ry, _mm_mul_ps(w, qy));
+        rz = _mm_add_ps(rz, _mm_mul_ps(w, qz));
+        rw = _mm_add_ps(rw, _mm_mul_ps(w, qw));
+        dx = _mm_add_ps(dx, _mm_mul_ps(w, ex));
+        dy = _mm_add_ps(dy, _mm_mul_ps(w, ey));
+        dz = _mm_add_ps(dz, _mm_mul_ps(w, ez));
+        dw = _mm_add_ps(dw, _mm_mul_ps(w, ew));
+      }
+
+      // Normalizo con la norma de la parte real
+      __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+                               _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+      __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(len2, tiny)));
+      rx = _mm_mul_ps(rx, inv); ry = _mm_mul_ps(ry, inv);
+      rz = _mm_mul_ps(rz, inv); rw = _mm_mul_ps(rw, inv);
+      dx = _mm_mul_ps(dx, inv); dy = _mm_mul_ps(dy, inv);
+      dz = _mm_mul_ps(dz, inv); dw = _mm_mul_ps(dw, inv);
+
+      // Rotación de la posición, la normal y la tangente
+      __m128 position[3] = { _mm_loadu_ps(&mesh.m_posX[v]), _mm_loadu_ps(&mesh.m_posY[v]), _mm_loadu_ps(&mesh.m_posZ[v]) };
+      __m128 normal[3] = { _mm_loadu_ps(&mesh.m_normalX[v]), _mm_loadu_ps(&mesh.m_normalY[v]), _mm_loadu_ps(&mesh.m_normalZ[v]) };
+      __m128 tangent[3] = { _mm_loadu_ps(&mesh.m_tangentX[v]), _mm_loadu_ps(&mesh.m_tangentY[v]), _mm_loadu_ps(&mesh.m_tangentZ[v]) };
+      rotateSoA4(rx, ry, rz, rw, position);
+      rotateSoA4(rx, ry, rz, rw, normal);
+      rotateSoA4(rx, ry, rz, rw, tangent);
+
+      // Traslación (solo la posición): 2 * (w_r * d - w_d * r + r x d)
+      __m128 sx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dx), _mm_mul_ps(dw, rx)),
+                             _mm_sub_ps(_mm_mul_ps(ry, dz), _mm_mul_ps(rz, dy)));
+      __m128 sy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dy), _mm_mul_ps(dw, ry)),
+                             _mm_sub_ps(_mm_mul_ps(rz, dx), _mm_mul_ps(rx, dz)));
+      __m128 sz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dz), _mm_mul_ps(dw, rz)),
+                             _mm_sub_ps(_mm_mul_ps(rx, dy), _mm_mul_ps(ry, dx)));
+      position[0] = _mm_add_ps(position[0], _mm_mul_ps(two, sx));
+      position[1] = _mm_add_ps(position[1], _mm_mul_ps(two, sy));
+      position[2] = _mm_add_ps(position[2], _mm_mul_ps(two, sz));
+
+      for (int row = 0; row < 3; ++row) {
+        _mm_store_ps(lanes.pos[row], position[row]);
+        _mm_store_ps(lanes.normal[row], normal[row]);
+        _mm_store_ps(lanes.tangent[row], tangent[row]);
+      }
+      storeVertices(job.output, v, std::min(4u, numVertices - v), lanes);
+    }
+  }
+
+  // ---------------------------------------------------------------------------
+  // AVX2: 8 vértices por iteración
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief ¿El CPU (y el sistema, que debe guardar los registros YMM) soporta AVX2 y FMA?
+   */
+  bool
+    detectAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+      return false;
+    }
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+      return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+  }
+
+  /// @brief Lo detecto una sola vez.
+  const bool g_hasAVX2 = detectAVX2();
+
+  /**
+   * @brief Como `loadRowSoA4` pero con 8 vértices: los vértices 0-3 en la mitad baja y 4-7 en la alta.
+   *
+   * @details Con cargas de 128 bits y la transpuesta por mitad en vez de `_mm256_i32gather_ps`:
+   *          en muchos CPUs (y con la mitigación de GDS en Intel) el gather es más lento que SSE2.
+   */
+  SKINNING_TARGET_AVX2 inline void
+    loadRowSoA8(const Matrix3x4* palette,
+                const int* bones,
+                int row,
+                __m256& c0, __m256& c1, __m256& c2, __m256& c3) {
+    const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(palette[bones[0]].m[row])),
+                                           _mm_loadu_ps(palette[bones[4]].m[row]), 1);
+    const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(palette[bones[1]].m[row])),
+                                           _mm_loadu_ps(palette[bones[5]].m[row]), 1);
+    const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(palette[bones[2]].m[row])),
+                                           _mm_loadu_ps(palette[bones[6]].m[row]), 1);
+    const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(palette[bones[3]].m[row])),
+                                           _mm_loadu_ps(palette[bones[7]].m[row]), 1);
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    c0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    c1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    c2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    c3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  /**
+   * @brief Normalizo 8 direcciones en SoA (igual que `normalize`).
+   */
+  SKINNING_TARGET_AVX2 inline void
+    normalizeSoA8(__m256 v[3]) {
+    const __m256 len2 = _mm256_fmadd_ps(v[0], v[0], _mm256_fmadd_ps(v[1], v[1], _mm256_mul_ps(v[2], v[2])));
+    const __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(len2, _mm256_set1_ps(1e-12f))));
+    v[0] = _mm256_mul_ps(v[0], inv);
+    v[1] = _mm256_mul_ps(v[1], inv);
+    v[2] = _mm256_mul_ps(v[2], inv);
+  }
+
+  SKINNING_TARGET_AVX2 void
+    skinLinearAVX2(const SkinningJob& job, unsigned int begin, unsigned int end) {
+    const SkinnedMeshData& mesh = *job.mesh;
+    const unsigned int numVertices = mesh.getNumVertices();
+    SkinnedLanes lanes;
+
+    for (unsigned int v = begin; v < end; v += 8) {
+      const __m256 px = _mm256_loadu_ps(&mesh.m_posX[v]);
+      const __m256 py = _mm256_loadu_ps(&mesh.m_posY[v]);
+      const __m256 pz = _mm256_loadu_ps(&mesh.m_posZ[v]);
+      const __m256 nx = _mm256_loadu_ps(&mesh.m_normalX[v]);
+      const __m256 ny = _mm256_loadu_ps(&mesh.m_normalY[v]);
+      const __m256 nz = _mm256_loadu_ps(&mesh.m_normalZ[v]);
+      const __m256 tx = _mm256_loadu_ps(&mesh.m_tangentX[v]);
+      const __m256 ty = _mm256_loadu_ps(&mesh.m_tangentY[v]);
+      const __m256 tz = _mm256_loadu_ps(&mesh.m_tangentZ[v]);
+      __m256 accP[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+      __m256 accN[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+      __m256 accT[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+      for (int k = 0; k < 4; ++k) {
+        const __m256 w = _mm256_loadu_ps(&mesh.m_weight[k][v]);
+        const int* bones = &mesh.m_bone[k][v];
+
+        for (int row = 0; row < 3; ++row) {
+          __m256 c0, c1, c2, c3;
+          loadRowSoA8(job.palette, bones, row, c0, c1, c2, c3);
+          const __m256 rp = _mm256_fmadd_ps(c0, px, _mm256_fmadd_ps(c1, py, _mm256_fmadd_ps(c2, pz, c3)));
+          const __m256 rn = _mm256_fmadd_ps(c0, nx, _mm256_fmadd_ps(c1, ny, _mm256_mul_ps(c2, nz)));
+          const __m256 rt = _mm256_fmadd_ps(c0, tx, _mm256_fmadd_ps(c1, ty, _mm256_mul_ps(c2, tz)));
+          accP[row] = _mm256_fmadd_ps(w, rp, accP[row]);
+          accN[row] = _mm256_fmadd_ps(w, rn, accN[row]);
+          accT[row] = _mm256_fmadd_ps(w, rt, accT[row]);
+        }
+      }
+
+      normalizeSoA8(accN);
+      normalizeSoA8(accT);
+      for (int row = 0; row < 3; ++row) {
+        _mm256_store_ps(lanes.pos[row], accP[row]);
+        _mm256_store_ps(lanes.normal[row], accN[row]);
+        _mm256_store_ps(lanes.tangent[row], accT[row]);
+      }
+      storeVertices(job.output, v, std::min(8u, numVertices - v), lanes);
+    }
+  }
+
+} // namespace
+
+bool
+SkinnedMeshData::build(const MeshComponent& mesh) {
+  m_numVertices = static_cast<unsigned int>(mesh.m_vertex.size());
+  if (mesh.m_skin.size() != mesh.m_vertex.size() || m_numVertices == 0) {
+    ERROR("SkinnedMeshData", "build", "Mesh has no skin influences: " << mesh.m_name.c_str());
+    m_numVertices = 0;
+    return false;
+  }
+
+  unsigned int padded = (m_numVertices + kPadding - 1) / kPadding * kPadding;
+  m_posX.assign(padded, 0.0f);
+  m_posY.assign(padded, 0.0f);
+  m_posZ.assign(padded, 0.0f);
+  m_normalX.assign(padded, 0.0f);
+  m_normalY.assign(padded, 0.0f);
+  m_normalZ.assign(padded, 0.0f);
+  m_tangentX.assign(padded, 0.0f);
+  m_tangentY.assign(padded, 0.0f);
+  m_tangentZ.assign(padded, 0.0f);
+  for (int k = 0; k < 4; ++k) {
+    m_bone[k].assign(padded, 0);
+    m_weight[k].assign(padded, 0.0f);
+  }
+
+  for (unsigned int i = 0; i < m_numVertices; ++i) {
+    m_posX[i] = mesh.m_vertex[i].Pos.x;
+    m_posY[i] = mesh.m_vertex[i].Pos.y;
+    m_posZ[i] = mesh.m_vertex[i].Pos.z;
+    m_normalX[i] = mesh.m_vertex[i].Normal.x;
+    m_normalY[i] = mesh.m_vertex[i].Normal.y;
+    m_normalZ[i] = mesh.m_vertex[i].Normal.z;
+    m_tangentX[i] = mesh.m_vertex[i].Tangent.x;
+    m_tangentY[i] = mesh.m_vertex[i].Tangent.y;
+    m_tangentZ[i] = mesh.m_vertex[i].Tangent.z;
+    for (int k = 0; k < 4; ++k) {
+      m_bone[k][i] = mesh.m_skin[i].BoneIndex[k];
+      m_weight[k][i] = mesh.m_skin[i].Weight[k];
+    }
+  }
+  return true;
+}
+
+void
+SkinningKernel::buildDualQuaternionPalette(const Matrix3x4* palette,
+                                           unsigned int numBones,
+                                           DualQuaternion* outPalette) {
+  for (unsigned int i = 0; i < numBones; ++i) {
+    outPalette[i] = AnimMath::toDualQuaternion(palette[i]);
+  }
+}
+
+void
+SkinningKernel::skinReference(const SkinningJob& job) {
+  const SkinnedMeshData& mesh = *job.mesh;
+
+  for (unsigned int v = 0; v < mesh.getNumVertices(); ++v) {
+    float p[3] = { mesh.m_posX[v], mesh.m_posY[v], mesh.m_posZ[v] };
+    float n[3] = { mesh.m_normalX[v], mesh.m_normalY[v], mesh.m_normalZ[v] };
+    float tan[3] = { mesh.m_tangentX[v], mesh.m_tangentY[v], mesh.m_tangentZ[v] };
+    float out[3] = { 0.0f, 0.0f, 0.0f };
+    float outNormal[3] = { 0.0f, 0.0f, 0.0f };
+    float outTangent[3] = { 0.0f, 0.0f, 0.0f };
+
+    if (job.method == SkinningMethod::Linear) {
+      for (int k = 0; k < 4; ++k) {
+        const Matrix3x4& bone = job.palette[mesh.m_bone[k][v]];
+        float w = mesh.m_weight[k][v];
+        float t[3], tn[3], tt[3];
+        AnimMath::transformPoint(bone, p, t);
+        AnimMath::transformVector(bone, n, tn);
+        AnimMath::transformVector(bone, tan, tt);
+        for (int i = 0; i < 3; ++i) {
+          out[i] += w * t[i];
+          outNormal[i] += w * tn[i];
+          outTangent[i] += w * tt[i];
+        }
+      }
+      normalize(outNormal);
+      normalize(outTangent);
+    }
+    else {
+      const DualQuaternion& first = job.dualQuatPalette[mesh.m_bone[0][v]];
+      DualQuaternion blend;
+      blend.real = { 0.0f, 0.0f, 0.0f, 0.0f };
+      for (int k = 0; k < 4; ++k) {
+        const DualQuaternion& dq = job.dualQuatPalette[mesh.m_bone[k][v]];
+        float w = mesh.m_weight[k][v];
+        if (AnimMath::dot(dq.real, first.real) < 0.0f) {
+          w = -w;
+        }
+        blend.real.x += w * dq.real.x; blend.real.y += w * dq.real.y;
+        blend.real.z += w * dq.real.z; blend.real.w += w * dq.real.w;
+        blend.dual.x += w * dq.dual.x; blend.dual.y += w * dq.dual.y;
+        blend.dual.z += w * dq.dual.z; blend.dual.w += w * dq.dual.w;
+      }
+
+      float len = std::sqrt(std::max(AnimMath::dot(blend.real, blend.real), 1e-12f));
+      float inv = 1.0f / len;
+      float r[3] = { blend.real.x * inv, blend.real.y * inv, blend.real.z * inv };
+      float rw = blend.real.w * inv;
+      float d[3] = { blend.dual.x * inv, blend.dual.y * inv, blend.dual.z * inv };
+      float dw = blend.dual.w * inv;
+
+      float t[3], c[3], rd[3];
+      cross(r, p, t);
+      for (int i = 0; i < 3; ++i) {
+        t[i] += rw * p[i];
+      }
+      cross(r, t, c);
+      cross(r, d, rd);
+      for (int i = 0; i < 3; ++i) {
+        out[i] = p[i] + 2.0f * c[i] + 2.0f * (rw * d[i] - dw * r[i] + rd[i]);
+      }
+
+      // La normal y la tangente solo rotan
+      const float* directions[2] = { n, tan };
+      float* rotated[2] = { outNormal, outTangent };
+      for (int j = 0; j < 2; ++j) {
+        cross(r, directions[j], t);
+        for (int i = 0; i < 3; ++i) {
+          t[i] += rw * directions[j][i];
+        }
+        cross(r, t, c);
+        for (int i = 0; i < 3; ++i) {
+          rotated[j][i] = directions[j][i] + 2.0f * c[i];
+        }
+      }
+    }
+
+    SimpleVertex& vertex = job.output[v];
+    vertex.Pos = XMFLOAT3(out[0], out[1], out[2]);
+    vertex.Normal = XMFLOAT3(outNormal[0], outNormal[1], outNormal[2]);
+    vertex.Tangent.x = outTangent[0];
+    vertex.Tangent.y = outTangent[1];
+    vertex.Tangent.z = outTangent[2];
+  }
+}
+
+void
+SkinningKernel::skinRange(const SkinningJob& job, unsigned int begin, unsigned int end) {
+  end = std::min(end, job.mesh->getPaddedCount());
+  if (begin >= end) {
+    return;
+  }
+
+  if (job.method == SkinningMethod::DualQuaternion) {
+    skinDualQuatSSE2(job, begin, end);
+    return;
+  }
+  if (g_hasAVX2) {
+    skinLinearAVX2(job, begin, end);
+  }
+  else {
+    skinLinearSSE2(job, begin, end);
+  }
+}
+
+void
+SkinningKernel::skinMeshes(const SkinningJob* jobs, size_t count, bool multithreaded) {
+  struct Task {
+    const SkinningJob* job;
+    unsigned int begin;
+    unsigned int end;
+  };
+
+  // Parto todas las mallas en bloques del mismo tamaño para balancear mejor
+  std::vector<Task> tasks;
+  for (size_t i = 0; i < count; ++i) {
+    if (!jobs[i].mesh || !jobs[i].output) {
+      continue;
+    }
+    unsigned int padded = jobs[i].mesh->getPaddedCount();
+    for (unsigned int begin = 0; begin < padded; begin += kVerticesPerTask) {
+      tasks.push_back({ &jobs[i], begin, std::min(begin + kVerticesPerTask, padded) });
+    }
+  }
+
+  if (!multithreaded) {
+    for (const Task& task : tasks) {
+      skinRange(*task.job, task.begin, task.end);
+    }
+    return;
+  }
+
+  JobSystem::getInstance().parallelFor(tasks.size(), 1, [&tasks](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      skinRange(*tasks[i].job, tasks[i].begin, tasks[i].end);
+    }
+  });
+}
+
+const char*
+SkinningKernel::getSimdPathName() {
+  return g_hasAVX2 ? "AVX2" : "SSE2";
+}
+
+void
+SkinningKernel::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numBones = 128;
+  const unsigned int numMeshes = 16;
+  const unsigned int verticesPerMesh = 64 * 1024;
+  const int iterations = 5;
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::uniform_int_distribution<int> boneDist(0, numBones - 1);
+
+  // Paleta sintética: rotaciones y traslaciones aleatorias (rígidas para comparar LBS y DQ)
+  std::vector<Matrix3x4> palette(numBones);
+  for (Matrix3x4& m : palette) {
+    BoneTransform bt;
+    bt.rotation = AnimMath::normalize({ unit(rng), unit(rng), unit(rng), unit(rng) });
+    bt.translation[0] = unit(rng);
+    bt.translation[1] = unit(rng);
+    bt.translation[2] = unit(rng);
+    m = AnimMath::toMatrix(bt);
+  }
+  std::vector<DualQuaternion> dqPalette(numBones);
+  buildDualQuaternionPalette(palette.data(), numBones, dqPalette.data());
+
+  std::vector<SkinnedMeshData> meshes(numMeshes);
+  std::vector<std::vector<SimpleVertex>> reference(numMeshes);
+  std::vector<std::vector<SimpleVertex>> output(numMeshes);
+  for (unsigned int i = 0; i < numMeshes; ++i) {
+    MeshComponent mesh;
+    mesh.m_vertex.resize(verticesPerMesh);
+    mesh.m_skin.resize(verticesPerMesh);
+    for (unsigned int v = 0; v < verticesPerMesh; ++v) {
+      mesh.m_vertex[v].Pos = XMFLOAT3(unit(rng) * 10.0f, unit(rng) * 10.0f, unit(rng) * 10.0f);
+      mesh.m_vertex[v].Tex = XMFLOAT2(0.0f, 0.0f);
+      // Normal al azar y una tangente perpendicular a ella (con su signo)
+      float normal[3] = { unit(rng), unit(rng), unit(rng) + 2.0f };
+      float axis[3] = { 1.0f, 0.0f, 0.0f };
+      float tangent[3];
+      normalize(normal);
+      cross(axis, normal, tangent);
+      normalize(tangent);
+      mesh.m_vertex[v].Normal = XMFLOAT3(normal[0], normal[1], normal[2]);
+      mesh.m_vertex[v].Tangent = XMFLOAT4(tangent[0], tangent[1], tangent[2], (v & 1) ? -1.0f : 1.0f);
+      float total = 0.0f;
+      for (int k = 0; k < 4; ++k) {
+        mesh.m_skin[v].BoneIndex[k] = static_cast<unsigned short>(boneDist(rng));
+        mesh.m_skin[v].Weight[k] = unit(rng) * 0.5f + 0.5f;
+        total += mesh.m_skin[v].Weight[k];
+      }
+      for (int k = 0; k < 4; ++k) {
+        mesh.m_skin[v].Weight[k] /= total;
+      }
+    }
+    meshes[i].build(mesh);
+    reference[i] = mesh.m_vertex;
+    output[i] = mesh.m_vertex;
+  }
+
+  const double totalVertices = static_cast<double>(numMeshes) * verticesPerMesh;
+  report.log("%u meshes x %u vertices, %u bones, 4 influences, SIMD path: %s",
+             numMeshes, verticesPerMesh, numBones, getSimdPathName());
+  report.log("%-16s %-14s %12s %14s", "method", "variant", "ms/iter", "vertices/ms");
+
+  const SkinningMethod methods[2] = { SkinningMethod::Linear, SkinningMethod::DualQuaternion };
+  const char* methodNames[2] = { "linear", "dual-quaternion" };
+
+  for (int m = 0; m < 2; ++m) {
+    std::vector<SkinningJob> refJobs(numMeshes);
+    std::vector<SkinningJob> jobs(numMeshes);
+    for (unsigned int i = 0; i < numMeshes; ++i) {
+      refJobs[i] = { &meshes[i], palette.data(), dqPalette.data(), methods[m], reference[i].data() };
+      jobs[i] = { &meshes[i], palette.data(), dqPalette.data(), methods[m], output[i].data() };
+    }
+
+    auto measure = [&](const char* variant, const std::function<void()>& body) {
+      body(); // calentamiento
+      Timer timer;
+      for (int it = 0; it < iterations; ++it) {
+        body();
+      }
+      double ms = timer.elapsedMs() / iterations;
+      report.log("%-16s %-14s %12.3f %14.0f", methodNames[m], variant, ms, totalVertices / ms);
+    };
+
+    measure("scalar", [&]() {
+      for (const SkinningJob& job : refJobs) {
+        skinReference(job);
+      }
+    });
+
+    // Error de la última salida contra la referencia escalar
+    auto maxErrorVsScalar = [&]() {
+      float maxError = 0.0f;
+      for (unsigned int i = 0; i < numMeshes; ++i) {
+        for (unsigned int v = 0; v < verticesPerMesh; ++v) {
+          const SimpleVertex& a = reference[i][v];
+          const SimpleVertex& b = output[i][v];
+          const float errors[10] = {
+            a.Pos.x - b.Pos.x, a.Pos.y - b.Pos.y, a.Pos.z - b.Pos.z,
+            a.Normal.x - b.Normal.x, a.Normal.y - b.Normal.y, a.Normal.z - b.Normal.z,
+            a.Tangent.x - b.Tangent.x, a.Tangent.y - b.Tangent.y, a.Tangent.z - b.Tangent.z,
+            a.Tangent.w - b.Tangent.w
+          };
+          for (float error : errors) {
+            maxError = std::max(maxError, std::fabs(error));
+          }
+        }
+      }
+      return maxError;
+    };
+    auto clearOutput = [&]() {
+      for (std::vector<SimpleVertex>& vertices : output) {
+        for (SimpleVertex& vertex : vertices) {
+          vertex.Pos = XMFLOAT3(0.0f, 0.0f, 0.0f);
+          vertex.Normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+          vertex.Tangent.x = vertex.Tangent.y = vertex.Tangent.z = 0.0f;
+        }
+      }
+    };
+    auto check = [&](const char* path) {
+      const float maxError = maxErrorVsScalar();
+      report.log("%-16s %-14s max error vs scalar: %g", methodNames[m], path, maxError);
+      if (!(maxError < 1e-3f)) {
+        report.fail(std::string(methodNames[m]) + " " + path + " skinning does not match scalar reference");
+      }
+    };
+
+    // Linear tiene dos caminos SIMD: verifico cada uno por separado, no solo el que elige el dispatch
+    if (methods[m] == SkinningMethod::Linear) {
+      clearOutput();
+      measure("sse2", [&]() {
+        for (const SkinningJob& job : jobs) {
+          skinLinearSSE2(job, 0, job.mesh->getPaddedCount());
+        }
+      });
+      check("sse2");
+      if (g_hasAVX2) {
+        clearOutput();
+        measure("avx2", [&]() {
+          for (const SkinningJob& job : jobs) {
+            skinLinearAVX2(job, 0, job.mesh->getPaddedCount());
+          }
+        });
+        check("avx2");
+      }
+      else {
+        report.log("%-16s %-14s not supported by this CPU", methodNames[m], "avx2");
+      }
+    }
+
+    clearOutput();
+    measure("simd", [&]() { skinMeshes(jobs.data(), jobs.size(), false); });
+    measure("simd+threads", [&]() { skinMeshes(jobs.data(), jobs.size(), true); });
+    check(methods[m] == SkinningMethod::Linear ? getSimdPathName() : "SSE2");
+  }
+
+  // Un vértice con un solo hueso: la normal y la tangente rotan con él (sin la traslación)
+  // y el signo de la tangente no cambia, con los dos métodos
+  BoneTransform turn;
+  turn.rotation = AnimMath::normalize({ 0.0f, 0.7071068f, 0.0f, 0.7071068f });
+  turn.translation[0] = 5.0f;
+  const Matrix3x4 bone = AnimMath::toMatrix(turn);
+  DualQuaternion dqBone;
+  buildDualQuaternionPalette(&bone, 1, &dqBone);
+  MeshComponent single;
+  single.m_vertex.resize(1);
+  single.m_skin.resize(1);
+  single.m_vertex[0].Pos = XMFLOAT3(0.0f, 1.0f, 0.0f);
+  single.m_vertex[0].Normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+  single.m_vertex[0].Tangent = XMFLOAT4(0.0f, 0.0f, 1.0f, -1.0f);
+  single.m_skin[0].BoneIndex[0] = 0;
+  single.m_skin[0].Weight[0] = 1.0f;
+  SkinnedMeshData singleData;
+  singleData.build(single);
+  const float normalIn[3] = { 1.0f, 0.0f, 0.0f };
+  const float tangentIn[3] = { 0.0f, 0.0f, 1.0f };
+  float normalOut[3], tangentOut[3];
+  AnimMath::transformVector(bone, normalIn, normalOut);
+  AnimMath::transformVector(bone, tangentIn, tangentOut);
+  for (int m = 0; m < 2; ++m) {
+    SimpleVertex result = single.m_vertex[0];
+    const SkinningJob job = { &singleData, &bone, &dqBone, methods[m], &result };
+    skinMeshes(&job, 1, false);
+    const float error = std::max({ std::fabs(result.Normal.x - normalOut[0]), std::fabs(result.Normal.y - normalOut[1]),
+                                   std::fabs(result.Normal.z - normalOut[2]), std::fabs(result.Tangent.x - tangentOut[0]),
+                                   std::fabs(result.Tangent.y - tangentOut[1]), std::fabs(result.Tangent.z - tangentOut[2]) });
+    if (!(error < 1e-4f) || result.Tangent.w != -1.0f) {
+      report.fail(std::string(methodNames[m]) + " skinning does not rotate the normal and tangent with the bone");
+    }
+  }
+}
@@ -0,0 +1,90 @@
+#include "Animation/SyntheticAnimation.h"
+#include <random>
+
+namespace SyntheticAnimation {
+
+  Skeleton
+    makeSkeleton(unsigned int numBones) {
+    Skeleton skeleton;
+    for (unsigned int i = 0; i < numBones; ++i) {
+      Bone bone;
+      bone.name = "bone" + std::to_string(i);
+      bone.parent = i == 0 ? -1 : static_cast<int>((i - 1) / 2);
+      bone.bindLocal.translation[1] = i == 0 ? 0.0f : 0.2f;
+      skeleton.addBone(bone);
+    }
+
+    // Inverse bind pose = inversa de la pose global de bind (solo traslaciones)
+    std::vector<BoneTransform> bind(numBones);
+    std::vector<Matrix3x4> global(numBones);
+    skeleton.getBindPose(bind.data());
+    skeleton.computeGlobalPose(bind.data(), global.data());
+    for (unsigned int i = 0; i < numBones; ++i) {
+      Matrix3x4& inv = skeleton.getBone(i).inverseBindPose;
+      for (int r = 0; r < 3; ++r) {
+        inv.m[r][3] = -global[i].m[r][3];
+      }
+    }
+    return skeleton;
+  }
+
+  AnimationClip
+    makeClip(unsigned int numBones, float seconds, float phase) {
+    AnimationClip clip;
+    unsigned int numFrames = static_cast<unsigned int>(seconds * 30.0f) + 1;
+    clip.init("synthetic", numBones, numFrames, 30.0f);
+    for (unsigned int f = 0; f < numFrames; ++f) {
+      float t = f / 30.0f;
+      BoneTransform* pose = clip.getFrame(f);
+      for (unsigned int b = 0; b < numBones; ++b) {
+        BoneTransform& bt = pose[b];
+        if (b == 0) {
+          // Raíz: avanza y rebota
+          bt.translation[0] = 0.1f * std::sin(t * 2.0f + phase);
+          bt.translation[1] = 1.0f + 0.05f * std::sin(t * 8.0f + phase);
+          bt.translation[2] = 1.5f * t;
+        }
+        else {
+          bt.translation[1] = 0.2f;
+        }
+        // Un tercio de los huesos (dedos, accesorios) no se mueve
+        if (b % 3 != 2) {
+          float angle = 0.5f * std::sin(t * (1.0f + b * 0.13f) + phase + b);
+          float axis[3] = { std::sin(b * 1.7f), std::cos(b * 0.9f), 0.3f };
+          float len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+          float s = std::sin(angle * 0.5f) / len;
+          bt.rotation = { axis[0] * s, axis[1] * s, axis[2] * s, std::cos(angle * 0.5f) };
+        }
+      }
+    }
+    return clip;
+  }
+
+  MeshComponent
+    makeSkinnedMesh(unsigned int numVertices, unsigned int numBones, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> boneDist(0, static_cast<int>(numBones) - 1);
+
+    MeshComponent mesh;
+    mesh.m_name = "synthetic";
+    mesh.m_vertex.resize(numVertices);
+    mesh.m_skin.resize(numVertices);
+    for (unsigned int v = 0; v < numVertices; ++v) {
+      mesh.m_vertex[v].Pos = XMFLOAT3(unit(rng) * 0.3f, unit(rng) + 1.0f, unit(rng) * 0.3f);
+      mesh.m_vertex[v].Tex = XMFLOAT2(0.0f, 0.0f);
+      float total = 0.0f;
+      for (int k = 0; k < 4; ++k) {
+        mesh.m_skin[v].BoneIndex[k] = static_cast<unsigned short>(boneDist(rng));
+        mesh.m_skin[v].Weight[k] = unit(rng) * 0.5f + 0.5f;
+        total += mesh.m_skin[v].Weight[k];
+      }
+      for (int k = 0; k < 4; ++k) {
+        mesh.m_skin[v].Weight[k] /= total;
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(numVertices);
+    return mesh;
+  }
+
+} // namespace SyntheticAnimation
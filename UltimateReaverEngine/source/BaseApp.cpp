@@ -10,7 +10,9 @@
  */
 
 #include "BaseApp.h"
+#include "Scene/SceneWriter.h"
 #include <ResourceManager.h>
+#include <fstream>
 
  /// @brief WndProc especial que usa ImGui para procesar la entrada de Windows.
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(
@@ -21,6 +23,36 @@ namespace
 {
   /// @brief Bandera para saber si la interfaz de usuario (ImGui/UserInterface) ya está lista.
   bool g_UserInterfaceInitialized = false;
+
+  /// @brief Escena con la que arranca el motor si no le paso un archivo: el avión animado.
+  void
+    buildDefaultScene(SceneWriter& writer) {
+    const unsigned int model = writer.addResource(SCENE_RESOURCE_MODEL, "Aircraft.fbx");
+    // Textura SIN extensión (E_45_col.jpg en /bin)
+    const unsigned int texture = writer.addResource(SCENE_RESOURCE_TEXTURE, "E_45_col", ExtensionType::JPG);
+    const float position[3] = { 0.0f, 0.0f, 10.0f };
+    const float rotation[3] = { 0.0f, 0.0f, 0.0f };
+    const float scale[3] = { 1.0f, 1.0f, 1.0f };
+    const unsigned int aircraft = writer.addEntity("Aircraft_E45", position, rotation, scale, model, texture,
+                                                   SCENE_ENTITY_CAST_SHADOW);
+    writer.addAnimator(aircraft, 0, true);
+  }
+
+  /**
+   * @brief Ajusto la rejilla de clusters al frustum de una vista.
+   *
+   * @details
+   *  Saco fovY, aspecto y planos de la proyección de perspectiva LH de la vista
+   *  (_22 = 1 / tan(fovY / 2), _33 = f / (f - n), _43 = -n * f / (f - n)).
+   */
+  void
+    setClusterProjection(ClusteredLighting& clusters, const RenderView& view) {
+    const XMFLOAT4X4& projection = view.projection;
+    const float fovY = 2.0f * atanf(1.0f / projection._22);
+    const float nearZ = -projection._43 / projection._33;
+    const float farZ = projection._43 / (1.0f - projection._33);
+    clusters.setProjection(ClusterGridSettings(), fovY, view.width / view.height, nearZ, farZ);
+  }
 }
 
 /**
@@ -38,6 +70,7 @@ namespace
  *  - Entro en el loop de mensajes de Windows.
  *  - Cuando no hay mensajes, actualizo (`update`) y dibujo (`render`) la escena.
  *  Uso `QueryPerformanceCounter` para calcular `deltaTime` de forma precisa.
+ *  Cada vuelta abre un frame nuevo en el `FrameProfiler`.
  */
 int
 BaseApp::run(HINSTANCE hInst, int nCmdShow) {
@@ -69,6 +102,7 @@ BaseApp::run(HINSTANCE hInst, int nCmdShow) {
       prev = curr;
 
       // Cuando no hay mensajes de Windows, aprovecho para actualizar lógica y renderizar
+      FrameProfiler::getInstance().beginFrame();
       update(deltaTime);
       render();
     }
@@ -86,7 +120,7 @@ BaseApp::run(HINSTANCE hInst, int nCmdShow) {
  *  - Creo el swap chain y el back buffer.
  *  - Creo el render target view y el depth stencil.
  *  - Configuro el viewport.
- *  - Cargo el modelo (Aircraft.fbx) y su textura.
+ *  - Cargo la escena (la de `setScenePath` o la de por defecto con Aircraft.fbx).
  *  - Creo y configuro el shader program y los constant buffers.
  *  - Configuro la cámara (View) y la proyección (Projection).
  *  - Inicializo la UI (UserInterface/ImGui) y marco que ya está lista.
@@ -104,6 +138,12 @@ BaseApp::init() {
     return hr;
   }
 
+  // Con el device listo, los estados (samplers, blend, etc.) se comparten por la caché
+  m_stateBackend = D3D11RenderStateBackend(&m_device);
+  RenderStateCache::getInstance().init(&m_stateBackend);
+  // Y las mallas estáticas se reparten en los vertex/index buffers grandes del pool
+  GeometryPool::getInstance().init(&m_device, &m_deviceContext);
+
   // Create a render target view
   hr = m_renderTargetView.init(m_device,
     m_backBuffer,
@@ -151,47 +191,30 @@ BaseApp::init() {
   }
 
   // --------------------------------------------------------------------
-  //  Cargar modelo FBX y textura
+  //  Cargar la escena (archivo de escena o la escena por defecto)
   // --------------------------------------------------------------------
-  // Creo un actor usando mi sistema de punteros inteligentes EU::MakeShared
-  m_abeBowser = EU::MakeShared<Actor>(m_device);
-
-  if (!m_abeBowser.isNull()) {
-
-    // Cargar modelo FBX
-    m_model = new Model3D("Aircraft.fbx", ModelType::FBX);
-    std::vector<MeshComponent> abeBowserMeshes = m_model->GetMeshes();
-
-    // Cargar textura (asegúrate de tener E_45_col.jpg en /bin)
-    std::vector<Texture> abeBowserTextures;
-    hr = m_abeBowserAlbedo.init(m_device,
-      "E_45_col",           // nombre del archivo SIN extensión
-      ExtensionType::JPG);  // porque es .jpg
-
+  if (m_scenePath.empty() || FAILED(m_scene.map(m_scenePath))) {
+    SceneWriter writer;
+    buildDefaultScene(writer);
+    std::vector<unsigned char> blob;
+    writer.write(blob);
+    // Si me pidieron un archivo que no existe, le guardo la escena por defecto
+    if (!m_scenePath.empty() && !std::ifstream(m_scenePath)) {
+      writer.save(m_scenePath);
+    }
+    hr = m_scene.loadFromMemory(blob);
     if (FAILED(hr)) {
-      ERROR("Main", "InitDevice",
-        ("Failed to initialize abeBowserAlbedo. HRESULT: " +
-          std::to_string(hr)).c_str());
+      ERROR("Main", "InitDevice", "Failed to load the default scene.");
       return hr;
     }
-
-    abeBowserTextures.push_back(m_abeBowserAlbedo);
-
-    // Asignar mallas y texturas al actor
-    m_abeBowser->setMesh(m_device, abeBowserMeshes);
-    m_abeBowser->setTextures(abeBowserTextures);
-    m_abeBowser->setName("Aircraft_E45");
-    m_actors.push_back(m_abeBowser);
-
-    // Transform del avión (ajusta a tu gusto)
-    m_abeBowser->getComponent<Transform>()->setTransform(
-      EU::Vector3(0.0f, 0.0f, 10.0f),   // posición
-      EU::Vector3(0.0f, 0.0f, 0.0f),    // rotación
-      EU::Vector3(1.0f, 1.0f, 1.0f));   // escala
   }
-  else {
-    ERROR("Main", "InitDevice", "Failed to create Aircraft Actor.");
-    return E_FAIL;
+
+  hr = instantiateScene(m_scene);
+  if (FAILED(hr)) {
+    ERROR("Main", "InitDevice",
+      ("Failed to instantiate the scene. HRESULT: " +
+        std::to_string(hr)).c_str());
+    return hr;
   }
 
   // --------------------------------------------------------------------
@@ -219,6 +242,26 @@ BaseApp::init() {
   texcoord.InstanceDataStepRate = 0;
   layout.push_back(texcoord);
 
+  D3D11_INPUT_ELEMENT_DESC normal;
+  normal.SemanticName = "NORMAL";
+  normal.SemanticIndex = 0;
+  normal.Format = DXGI_FORMAT_R32G32B32_FLOAT; // float3
+  normal.InputSlot = 0;
+  normal.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+  normal.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+  normal.InstanceDataStepRate = 0;
+  layout.push_back(normal);
+
+  D3D11_INPUT_ELEMENT_DESC tangent;
+  tangent.SemanticName = "TANGENT";
+  tangent.SemanticIndex = 0;
+  tangent.Format = DXGI_FORMAT_R32G32B32A32_FLOAT; // float4 (w = handedness)
+  tangent.InputSlot = 0;
+  tangent.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+  tangent.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+  tangent.InstanceDataStepRate = 0;
+  layout.push_back(tangent);
+
   hr = m_shaderProgram.init(m_device, "UltimateReaverEngine.fx", layout);
   if (FAILED(hr)) {
     ERROR("Main", "InitDevice",
@@ -227,6 +270,49 @@ BaseApp::init() {
     return hr;
   }
 
+  // Materiales: el layout sale del cbuffer cbMaterial del shader (o el default si no lo declara)
+  MaterialLayout materialLayout;
+  std::string materialError;
+  if (!materialLayout.reflectFile("UltimateReaverEngine.fx", "cbMaterial", materialError)) {
+    MESSAGE("BaseApp", "init", "Using the default material layout (" << materialError.c_str() << ")");
+    materialLayout = MaterialLayout::getDefault();
+  }
+  hr = MaterialSystem::getInstance().init(&m_device, materialLayout);
+  if (FAILED(hr)) {
+    ERROR("Main", "InitDevice",
+      ("Failed to initialize MaterialSystem. HRESULT: " +
+        std::to_string(hr)).c_str());
+    return hr;
+  }
+
+  // Sombras en cascada (usan el mismo layout de vértices)
+  CascadedShadowSettings shadowSettings;
+  m_cascadedShadows.setSettings(shadowSettings);
+  m_cascadedShadows.setLightDirection(XMFLOAT3(0.4f, -0.8f, 0.45f));
+  hr = m_shadowRenderer.init(m_device, shadowSettings, layout);
+  if (FAILED(hr)) {
+    ERROR("Main", "InitDevice",
+      ("Failed to initialize ShadowRenderer. HRESULT: " +
+        std::to_string(hr)).c_str());
+    return hr;
+  }
+
+  // Culling por oclusión con la resolución por defecto
+  m_occlusion.setSettings(SoftwareOcclusionSettings());
+
+  // Partículas: un emisor de chispas junto al avión que rebotan en el piso
+  hr = m_particleRenderer.init(m_device, 65536);
+  if (FAILED(hr)) {
+    ERROR("Main", "InitDevice",
+      ("Failed to initialize ParticleRenderer. HRESULT: " +
+        std::to_string(hr)).c_str());
+    return hr;
+  }
+  ParticleEmitterSettings sparks;
+  sparks.position = XMFLOAT3(0.0f, 0.0f, 10.0f);
+  m_particles.addEmitter(sparks);
+  m_particles.addCollisionPlane(XMFLOAT4(0.0f, 1.0f, 0.0f, 2.0f), 0.4f);
+
   // Const buffers
   hr = m_cbNeverChanges.init(m_device, sizeof(CBNeverChanges));
   if (FAILED(hr)) {
@@ -244,20 +330,75 @@ BaseApp::init() {
     return hr;
   }
 
-  // View & Projection
-  XMVECTOR Eye = XMVectorSet(0.0f, 3.0f, -6.0f, 0.0f);
-  XMVECTOR At = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-  XMVECTOR Up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-  m_View = XMMatrixLookAtLH(Eye, At, Up);
+  // Luces dinámicas: buffers con capacidad fija para la rejilla por defecto
+  ClusterGridSettings clusterSettings;
+  unsigned int numClusters = clusterSettings.tilesX * clusterSettings.tilesY * clusterSettings.slicesZ;
+  hr = m_lightClusterBuffers.init(m_device, 4096, numClusters,
+    numClusters * clusterSettings.maxLightsPerCluster);
+  if (FAILED(hr)) {
+    ERROR("Main", "InitDevice",
+      ("Failed to initialize LightClusterBuffers. HRESULT: " +
+        std::to_string(hr)).c_str());
+    return hr;
+  }
+
+  // Un par de luces alrededor del avión para que la ruta de datos no vaya vacía
+  Light keyLight;
+  keyLight.position = XMFLOAT3(2.0f, 4.0f, 6.0f);
+  keyLight.range = 15.0f;
+  m_lights.push_back(keyLight);
+
+  Light spotLight;
+  spotLight.type = SPOT_LIGHT;
+  spotLight.position = XMFLOAT3(0.0f, 8.0f, 10.0f);
+  spotLight.direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+  spotLight.range = 12.0f;
+  spotLight.color = XMFLOAT3(1.0f, 0.9f, 0.7f);
+  m_lights.push_back(spotLight);
+
+  // Cámaras: la principal donde estaba la vista fija; las demás orbitan el mismo punto.
+  // Con varias, reparto la ventana en una cuadrícula (pantalla dividida)
+  const EU::Vector3 target(0.0f, 1.0f, 0.0f);
+  const unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(m_numViews))));
+  const unsigned int rows = (m_numViews + columns - 1) / columns;
+  m_cameras.clear();
+  for (unsigned int c = 0; c < m_numViews; ++c) {
+    EU::TSharedPointer<Actor> cameraActor = EU::MakeShared<Actor>(EU::TSharedPointer<Prefab>());
+    cameraActor->setName("Camera " + std::to_string(c));
+    EU::TSharedPointer<Camera> camera = EU::MakeShared<Camera>();
+    camera->setViewportRect(static_cast<float>(c % columns) / columns,
+                            static_cast<float>(c / columns) / rows,
+                            1.0f / columns,
+                            1.0f / rows);
+    cameraActor->addComponent(camera);
 
+    const float angle = XM_2PI * c / m_numViews;
+    const EU::Vector3 eye(6.0f * std::sin(angle), 3.0f, -6.0f * std::cos(angle));
+    Camera::lookAt(*cameraActor->getComponent<Transform>(), eye, target);
+    m_cameras.push_back(cameraActor);
+  }
+
+  // View & Projection (de la cámara principal)
+  const RenderView primaryView = m_cameras[0]->getComponent<Camera>()->computeView(
+    *m_cameras[0]->getComponent<Transform>(), m_window.m_width, m_window.m_height);
+  m_View = XMLoadFloat4x4(&primaryView.view);
+  m_Projection = XMLoadFloat4x4(&primaryView.projection);
   cbNeverChanges.mView = XMMatrixTranspose(m_View);
-  m_Projection = XMMatrixPerspectiveFovLH(
-    XM_PIDIV4,
-    m_window.m_width / (FLOAT)m_window.m_height,
-    0.01f,
-    100.0f);
   cbChangesOnResize.mProjection = XMMatrixTranspose(m_Projection);
 
+  // Streaming: antes del primer frame cargo todo lo que rodea a la cámara (pantalla de carga)
+  XMMATRIX inverseView = XMMatrixInverse(nullptr, m_View);
+  XMFLOAT3 eye(inverseView._41, inverseView._42, inverseView._43);
+  do {
+    m_worldPartition.update(eye);
+    m_worldPartition.flush();
+    applyStreaming();
+  } while (m_worldPartition.getStats().issuedLoads > 0 || m_worldPartition.getStats().loadingCells > 0);
+  const GeometryPoolStats sceneGeometry = GeometryPool::getInstance().getStats();
+  MESSAGE("BaseApp", "init", "Scene index buffers: " << sceneGeometry.indexBytes / 1024 << " KB ("
+    << sceneGeometry.indexBytesSaved / 1024 << " KB saved with 16-bit indices, "
+    << sceneGeometry.pages16 << "/" << sceneGeometry.pages << " pages 16-bit)");
+
   // Inicializar ImGui / UserInterface
   m_userInterface.init(m_window.m_hWnd,
     m_device.m_device,
@@ -265,9 +406,22 @@ BaseApp::init() {
 
   g_UserInterfaceInitialized = true;
 
-  // Actor seleccionado en el inspector
-  if (!m_abeBowser.isNull()) {
-    m_userInterface.setSelectedActor(m_abeBowser.get());
+  // Outliner con todos los actores y el primero seleccionado en el inspector
+  m_userInterface.setScene(&m_actors);
+  m_userInterface.setLightmapBaker(&m_lightmapBaker);
+  if (!m_actors.empty()) {
+    m_userInterface.setSelectedActor(m_actors[0].get());
+  }
+
+  // Simulación a 60 Hz; grabo o reproduzco si me lo pidieron por línea de comandos
+  m_timestep.setSettings(FixedTimestepSettings());
+  if (m_replayMode == REPLAY_RECORD) {
+    m_replay.startRecording();
+  }
+  else if (m_replayMode == REPLAY_PLAYBACK) {
+    if (FAILED(m_replay.loadFromFile(m_replayPath)) || !m_replay.startPlayback()) {
+      ERROR("Main", "InitDevice", "Failed to load replay " << m_replayPath.c_str());
+    }
   }
 
   return S_OK;
@@ -280,49 +434,257 @@ BaseApp::init() {
  *
  * @details
  *  Aquí:
- *  - Actualizo un tiempo local `t` (por si quiero animaciones dependientes de tiempo).
+ *  - Corro los pasos fijos de simulación que toquen (`fixedUpdate`) y paso el `alpha`
+ *    de interpolación a los transforms.
  *  - Actualizo la interfaz de usuario si ya está inicializada.
  *  - Actualizo las matrices de View y Projection y las mando a los constant buffers.
  *  - Recorro todos los actores y llamo su `update`.
  */
 void
 BaseApp::update(float deltaTime) {
-  // Update time
-  static float t = 0.0f;
-  if (m_swapChain.m_driverType == D3D_DRIVER_TYPE_REFERENCE) {
-    t += (float)XM_PI * 0.0125f;
+  FrameProfiler::Scope profile("Update");
+
+  // Simulación: pasos fijos según el acumulador; lo demás va con el tiempo del frame
+  unsigned int steps = m_timestep.advance(deltaTime);
+  for (unsigned int i = 0; i < steps; ++i) {
+    fixedUpdate(m_timestep.getStepSeconds());
   }
-  else {
-    static DWORD dwTimeStart = 0;
-    DWORD dwTimeCur = GetTickCount();
-    if (dwTimeStart == 0)
-      dwTimeStart = dwTimeCur;
-    t = (dwTimeCur - dwTimeStart) / 1000.0f;
+  float alpha = m_timestep.getAlpha();
+  for (auto& actor : m_actors) {
+    EU::TSharedPointer<Transform> transform = actor->getComponent<Transform>();
+    if (transform) {
+      transform->setInterpolation(alpha);
+    }
   }
 
+  // Lightmap antes de la UI: si la vista previa cambia de textura, la UI se re-arma este frame
+  updateLightmapBake();
+
   // UI frame
   if (g_UserInterfaceInitialized) {
     m_userInterface.update();
   }
 
-  // Update view/projection
-  cbNeverChanges.mView = XMMatrixTranspose(m_View);
-  m_cbNeverChanges.update(m_deviceContext, nullptr, 0, nullptr,
-    &cbNeverChanges, 0, 0);
-
-  m_Projection = XMMatrixPerspectiveFovLH(
-    XM_PIDIV4,
-    m_window.m_width / (FLOAT)m_window.m_height,
-    0.01f,
-    100.0f);
-  cbChangesOnResize.mProjection = XMMatrixTranspose(m_Projection);
-  m_cbChangeOnResize.update(m_deviceContext, nullptr, 0, nullptr,
-    &cbChangesOnResize, 0, 0);
+  // Vistas del frame: una por cámara activa. La principal (la primera) manda para el
+  // streaming, la animación, las sombras y la oclusión
+  m_viewSystem.clearViews();
+  Camera* primaryCamera = nullptr;
+  for (auto& cameraActor : m_cameras) {
+    EU::TSharedPointer<Camera> camera = cameraActor->getComponent<Camera>();
+    if (!camera || !camera->isEnabled()) {
+      continue;
+    }
+    if (m_viewSystem.addView(camera->computeView(*cameraActor->getComponent<Transform>(),
+                                                 m_window.m_width, m_window.m_height)) == 0) {
+      primaryCamera = camera.get();
+    }
+  }
+  // Sin cámaras activas sigo usando la primera (la escena necesita una vista principal)
+  if (!primaryCamera && !m_cameras.empty()) {
+    primaryCamera = m_cameras[0]->getComponent<Camera>().get();
+    m_viewSystem.addView(primaryCamera->computeView(*m_cameras[0]->getComponent<Transform>(),
+                                                    m_window.m_width, m_window.m_height));
+  }
+  const RenderView& primaryView = m_viewSystem.getView(0);
+  m_View = XMLoadFloat4x4(&primaryView.view);
+  m_Projection = XMLoadFloat4x4(&primaryView.projection);
+  const float aspect = primaryView.width / primaryView.height;
+
+  // Animación: el scheduler decide quién se muestrea/skinnea este frame
+  XMFLOAT4X4 viewProjection;
+  XMFLOAT4X4 projection;
+  XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(m_View, m_Projection));
+  XMStoreFloat4x4(&projection, m_Projection);
+  XMMATRIX inverseView = XMMatrixInverse(nullptr, m_View);
+  XMFLOAT3 eye = primaryView.eye;
+
+  // Streaming: celdas que entran y salen del radio de la cámara
+  m_worldPartition.update(eye);
+  applyStreaming();
+  // Lo que descargó el streaming deja huecos en el pool: compacto una página si hace falta
+  GeometryPool::getInstance().defragment();
+
+  m_animationScheduler.update(deltaTime, viewProjection, eye, projection._22,
+    primaryView.height);
+
+  // Las luces se asignan a clusters en render(): cada vista tiene su frustum
+  XMFLOAT4X4 view;
+  XMStoreFloat4x4(&view, m_View);
 
   // Update actors
   for (auto& actor : m_actors) {
     actor->update(deltaTime, m_deviceContext);
   }
+
+  // Sombras: junto casters, ajusto cascadas y hago el culling
+  m_shadowCasters.clear();
+  for (auto& actor : m_actors) {
+    actor->collectShadowCasters(m_shadowCasters);
+  }
+  m_cascadedShadows.update(view,
+    primaryCamera->getFovY(),
+    aspect,
+    primaryCamera->getNearPlane(),
+    primaryCamera->getFarPlane(),
+    m_shadowCasters);
+
+  // Un solo recorrido de la escena: la caja de cada actor sirve para el frustum de todas
+  // las vistas y para la oclusión (que solo tengo para la principal)
+  m_occluders.clear();
+  m_actorBounds.clear();
+  m_boundsActor.clear();
+  m_viewSystem.beginFrame();
+  for (unsigned int i = 0; i < m_actors.size(); ++i) {
+    m_actors[i]->collectOccluders(m_occluders);
+    OcclusionBounds bounds;
+    const bool hasBounds = m_actors[i]->getWorldBounds(bounds);
+    if (hasBounds) {
+      m_actorBounds.push_back(bounds);
+      m_boundsActor.push_back(i);
+    }
+    // Ordeno por material: los draws que comparten tabla de texturas quedan juntos
+    m_viewSystem.addItem(hasBounds ? &bounds : nullptr,
+                         MaterialSystem::getInstance().getSortKey(m_actors[i]->getMaterial()));
+  }
+  m_viewSystem.cull();
+
+  m_occlusion.beginFrame(viewProjection);
+  m_occlusion.rasterize(m_occluders);
+  m_occlusion.testBounds(m_actorBounds, m_boundsVisible);
+  m_actorVisible.assign(m_actors.size(), 1);
+  for (size_t i = 0; i < m_boundsActor.size(); ++i) {
+    m_actorVisible[m_boundsActor[i]] = m_boundsVisible[i];
+  }
+  m_viewSystem.applyVisibility(0, m_actorVisible);
+
+  // Colisiones: paso los transforms (los que no cambiaron no cuestan) y hago el picking
+  for (unsigned int i = 0; i < m_actorCollider.size(); ++i) {
+    if (m_actorCollider[i] != kInvalidCollider) {
+      XMFLOAT4X4 world;
+      m_actors[i]->getWorldMatrix(world);
+      m_collision.setTransform(m_actorCollider[i], world);
+    }
+  }
+  m_collision.update();
+  pickActor();
+
+  // Partículas: ya simuladas en fixedUpdate, aquí solo el orden para esta cámara
+  // (la dirección de la cámara es la fila 2 de la inversa de la vista)
+  XMFLOAT3 forward(inverseView._31, inverseView._32, inverseView._33);
+  m_particles.sortByDepth(eye, forward);
+}
+
+/**
+ * @brief Un paso fijo de simulación.
+ *
+ * @param stepSeconds Duración del paso (siempre la misma).
+ *
+ * @details
+ *  Aquí:
+ *  - Leo el input (o el grabado si estoy reproduciendo).
+ *  - Guardo el estado anterior de los transforms para interpolar al dibujar.
+ *  - Simulo las partículas; la barra espaciadora lanza una ráfaga.
+ *  - Si estoy grabando o reproduciendo, hasheo el estado del tick. Solo el que es de la
+ *    simulación (las partículas): los transforms de los actores los mueve el editor
+ *    (gizmo, inspector) fuera del input grabado, y con ellos el replay se desviaría.
+ */
+void
+BaseApp::fixedUpdate(float stepSeconds) {
+  SimulationInput live;
+  if (GetForegroundWindow() == m_window.m_hWnd && (GetAsyncKeyState(VK_SPACE) & 0x8000)) {
+    live.buttons |= SIM_BUTTON_PRIMARY;
+  }
+  SimulationInput input = m_replay.beginTick(live);
+
+  for (auto& actor : m_actors) {
+    EU::TSharedPointer<Transform> transform = actor->getComponent<Transform>();
+    if (transform) {
+      transform->beginStep();
+    }
+  }
+
+  if ((input.buttons & SIM_BUTTON_PRIMARY) && m_particles.getNumEmitters() > 0) {
+    m_particles.burst(0, 256);
+  }
+  m_particles.simulate(stepSeconds);
+
+  if (m_replay.getMode() != REPLAY_OFF) {
+    StateHasher hasher;
+    m_particles.hashState(hasher);
+    m_replay.endTick(hasher.getHash());
+  }
+}
+
+/**
+ * @brief Picking con el mouse.
+ *
+ * @details
+ *  Si ImGui no está usando el mouse y hubo clic izquierdo, paso el punto del mouse a
+ *  NDC, lo desproyecto con la inversa de View * Projection en el plano cercano y el
+ *  lejano, y lanzo ese rayo contra el mundo de colisión. Si los actores tienen BVH de
+ *  triángulos, el rayo contra sus mallas manda: así elijo la sub-malla exacta y no me
+ *  quedo con la caja de un actor que el rayo solo roza.
+ */
+void
+BaseApp::pickActor() {
+  if (!g_UserInterfaceInitialized) {
+    return;
+  }
+  ImGuiIO& io = ImGui::GetIO();
+  if (io.WantCaptureMouse || !ImGui::IsMouseClicked(0) || m_window.m_width == 0 || m_window.m_height == 0) {
+    return;
+  }
+  // Con pantalla dividida, el rayo sale de la vista bajo el mouse
+  // Sin vista bajo el mouse (entre rectángulos o fuera de todos) no hay rayo
+  unsigned int viewIndex = m_viewSystem.getNumViews();
+  for (unsigned int v = 0; v < m_viewSystem.getNumViews(); ++v) {
+    const RenderView& view = m_viewSystem.getView(v);
+    if (io.MousePos.x >= view.x && io.MousePos.x < view.x + view.width &&
+        io.MousePos.y >= view.y && io.MousePos.y < view.y + view.height) {
+      viewIndex = v;
+      break;
+    }
+  }
+  if (viewIndex >= m_viewSystem.getNumViews()) {
+    return;
+  }
+  const RenderView& pickView = m_viewSystem.getView(viewIndex);
+  float ndcX = (io.MousePos.x - pickView.x) / pickView.width * 2.0f - 1.0f;
+  float ndcY = 1.0f - (io.MousePos.y - pickView.y) / pickView.height * 2.0f;
+  XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, XMLoadFloat4x4(&pickView.viewProjection));
+  XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverseViewProjection);
+  XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverseViewProjection);
+
+  CollisionRay ray;
+  XMStoreFloat3(&ray.origin, nearPoint);
+  XMStoreFloat3(&ray.direction, XMVector3Normalize(XMVectorSubtract(farPoint, nearPoint)));
+  ray.maxDistance = XMVectorGetX(XMVector3Length(XMVectorSubtract(farPoint, nearPoint)));
+
+  float best = ray.maxDistance;
+  int bestActor = -1;
+  int bestMesh = -1;
+  for (unsigned int i = 0; i < m_actors.size(); ++i) {
+    float distance;
+    int mesh;
+    if (m_actors[i]->raycastMeshes(ray.origin, ray.direction, best, distance, mesh)) {
+      best = distance;
+      bestActor = static_cast<int>(i);
+      bestMesh = mesh;
+    }
+  }
+  if (bestActor >= 0) {
+    m_userInterface.setSelectedActor(m_actors[bestActor].get(), bestMesh);
+    return;
+  }
+
+  // Actores sin BVH: me quedo con su collider
+  RaycastHit hit;
+  if (m_collision.raycast(ray, hit)) {
+    Actor* actor = m_actors[m_collision.getUserData(hit.collider)].get();
+    if (!actor->hasTriangleBVH()) {
+      m_userInterface.setSelectedActor(actor);
+    }
+  }
 }
 
 /**
@@ -331,26 +693,69 @@ BaseApp::update(float deltaTime) {
  * @details
  *  Aquí:
  *  - Limpio el render target y el depth stencil con un color base.
- *  - Seteo el viewport, la vista de profundidad y los shaders.
- *  - Envío los constant buffers que no cambian mucho (View/Projection).
- *  - Recorro y dibujo todos los actores de la escena.
+ *  - Por cada vista del `ViewSystem`: seteo su viewport, subo su View/Projection, asigno
+ *    las luces a los clusters de su frustum y dibujo los actores de la lista combinada
+ *    que tienen su bit.
+ *  - Si la vista es relativa a la cámara, la vista va sin traslación y cada actor sube su
+ *    matriz de mundo con la posición de la cámara restada.
  *  - Renderizo la UI (ImGui/UserInterface).
  *  - Llamo a `present()` para mostrar el frame en pantalla.
  */
 void
 BaseApp::render() {
+  FrameProfiler::Scope profile("Render");
+
+  // Shadow pass antes del pass principal (deja su propio viewport y estados)
+  m_shadowRenderer.render(m_deviceContext, m_cascadedShadows, m_shadowCasters);
+
   float ClearColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
   m_renderTargetView.render(m_deviceContext, m_depthStencilView, 1, ClearColor);
 
-  m_viewport.render(m_deviceContext);
   m_depthStencilView.render(m_deviceContext);
-  m_shaderProgram.render(m_deviceContext);
 
-  m_cbNeverChanges.render(m_deviceContext, 0, 1);
-  m_cbChangeOnResize.render(m_deviceContext, 1, 1);
+  // Cada vista dibuja su parte de la lista combinada (ordenada por prefab) en su rectángulo
+  const std::vector<ViewDraw>& drawList = m_viewSystem.getDrawList();
+  for (unsigned int v = 0; v < m_viewSystem.getNumViews(); ++v) {
+    const RenderView& view = m_viewSystem.getView(v);
+    const unsigned int viewBit = 1u << v;
+    if (FAILED(m_viewport.init(view.x, view.y, view.width, view.height))) {
+      continue;
+    }
+    m_viewport.render(m_deviceContext);
+    m_shaderProgram.render(m_deviceContext);
+    MaterialSystem::getInstance().beginPass(m_deviceContext);
+    // El shadow pass, las partículas o la vista anterior cambiaron el IA
+    GeometryPool::getInstance().beginPass();
 
-  for (auto& actor : m_actors) {
-    actor->render(m_deviceContext);
+    cbNeverChanges.mView = XMMatrixTranspose(view.getShaderView());
+    m_cbNeverChanges.update(m_deviceContext, nullptr, 0, nullptr, &cbNeverChanges, 0, 0);
+    cbChangesOnResize.mProjection = XMMatrixTranspose(XMLoadFloat4x4(&view.projection));
+    m_cbChangeOnResize.update(m_deviceContext, nullptr, 0, nullptr, &cbChangesOnResize, 0, 0);
+    m_cbNeverChanges.render(m_deviceContext, 0, 1);
+    m_cbChangeOnResize.render(m_deviceContext, 1, 1);
+    // Clusters de esta vista: WRITE_DISCARD deja los draws de la vista anterior con su copia
+    setClusterProjection(m_clusteredLighting, view);
+    m_clusteredLighting.build(m_lights, view.view);
+    m_lightClusterBuffers.update(m_deviceContext, m_clusteredLighting,
+      static_cast<unsigned int>(view.width), static_cast<unsigned int>(view.height));
+    m_lightClusterBuffers.render(m_deviceContext);
+    m_shadowRenderer.bind(m_deviceContext, view.cameraRelative ? &view.eye : nullptr);
+
+    for (const ViewDraw& draw : drawList) {
+      if (!(draw.viewMask & viewBit) || draw.item >= m_actors.size()) {
+        continue;
+      }
+      if (view.cameraRelative) {
+        m_actors[draw.item]->render(m_deviceContext, view.eye);
+      }
+      else {
+        m_actors[draw.item]->render(m_deviceContext);
+      }
+    }
+
+    // Transparentes al final, sobre la profundidad de los opacos
+    m_particleRenderer.render(m_deviceContext, m_particles,
+      XMLoadFloat4x4(&view.view), XMLoadFloat4x4(&view.projection));
   }
 
   if (g_UserInterfaceInitialized) {
@@ -368,7 +773,7 @@ BaseApp::render() {
  *  - Limpio el estado del device context.
  *  - Destruyo la UI si estaba activa.
  *  - Destruyo constant buffers, shaders, depth, RTV, swap chain, etc.
- *  - Libero el modelo cargado si no estoy usando smart pointers.
+ *  - Detengo el streaming, que descarga los modelos y texturas de la escena.
  */
 void
 BaseApp::destroy() {
@@ -382,6 +787,47 @@ BaseApp::destroy() {
 
   m_cbNeverChanges.destroy();
   m_cbChangeOnResize.destroy();
+  m_lightClusterBuffers.destroy();
+  m_shadowRenderer.destroy();
+  m_particleRenderer.destroy();
+  m_lightmapView.destroy();
+  m_lightmapTexture.destroy();
+
+  // Detengo el streaming (descarga modelos y texturas) antes de soltar el device
+  m_worldPartition.shutdown();
+  for (auto& prefab : m_prefabs) {
+    prefab->destroy();
+  }
+  MaterialSystem& materials = MaterialSystem::getInstance();
+  const MaterialSystemStats materialStats = materials.getStats();
+  MESSAGE("BaseApp", "destroy", "Materials: " << materialStats.requests << " requests, "
+    << materialStats.dedupHits << " deduplicated, " << materialStats.uploads << " uploads, "
+    << materialStats.materials << " still referenced");
+  materials.destroy();
+  GeometryPool& geometryPool = GeometryPool::getInstance();
+  const GeometryPoolStats geometryStats = geometryPool.getStats();
+  MESSAGE("BaseApp", "destroy", "Geometry pool: " << geometryStats.pages << " pages, "
+    << geometryStats.binds << " binds, " << geometryStats.defragmentations << " defragmentations, "
+    << geometryStats.meshes << " meshes still allocated");
+  geometryPool.destroy();
+
+  // La grabación se guarda al cerrar (una sola vez)
+  if (m_replay.getMode() == REPLAY_RECORD) {
+    m_replay.saveToFile(m_replayPath);
+  }
+  m_replay.stop();
+
+  // Lo que siga referenciado en la caché de estados se libera antes que el device
+  RenderStateCache& states = RenderStateCache::getInstance();
+  for (int t = 0; t < RENDER_STATE_COUNT; ++t) {
+    const RenderStateStats stats = states.getStats(static_cast<RenderStateType>(t));
+    MESSAGE("BaseApp", "destroy", "Render state type " << t << ": " << stats.requests << " requests, "
+      << stats.hits << " hits, " << stats.creations << " objects created");
+  }
+  const unsigned int leakedStates = states.destroy();
+  if (leakedStates > 0) {
+    MESSAGE("BaseApp", "destroy", leakedStates << " render states were still referenced");
+  }
   m_shaderProgram.destroy();
   m_depthStencil.destroy();
   m_depthStencilView.destroy();
@@ -390,10 +836,306 @@ BaseApp::destroy() {
   m_backBuffer.destroy();
   m_deviceContext.destroy();
   m_device.destroy();
+  JobSystem::getInstance().destroy();
+
+  m_models.clear();
+  m_sceneTextures.clear();
+  m_prefabs.clear();
+  m_prefabUsers.clear();
+  m_entityPrefab.clear();
+  m_scene.unload();
+}
+
+/**
+ * @brief Creo los actores de una escena cargada y registro todo en la partición del mundo.
+ *
+ * @param scene Escena ya relocalizada (leída, mapeada o armada en memoria).
+ * @return HRESULT `S_OK` si todo se creó bien.
+ *
+ * @details
+ *  Aquí no cargo modelos ni texturas: cada recurso se registra en `m_worldPartition` con
+ *  lo que pesa su archivo, y cada actor nace solo con su nombre, Transform y banderas.
+ *  El streaming carga los recursos de las celdas cercanas en su hilo y `attachEntity`
+ *  le pone al actor sus mallas, textura y componentes cuando su celda está completa.
+ *
+ *  Las entidades con el mismo modelo y textura comparten un prefab (mallas, buffers,
+ *  sampler y CB de modelo); el actor de cada una es una instancia sin nada en GPU.
+ */
+HRESULT
+BaseApp::instantiateScene(const SceneFile& scene) {
+  m_models.assign(scene.getNumResources(), nullptr);
+  m_sceneTextures.assign(scene.getNumResources(), Texture());
+  for (unsigned int i = 0; i < scene.getNumResources(); ++i) {
+    const SceneResource& resource = scene.getResource(i);
+    std::string file = resource.path.get();
+    if (resource.type == SCENE_RESOURCE_TEXTURE) {
+      file += resource.extension == ExtensionType::DDS ? ".dds" : resource.extension == ExtensionType::PNG ? ".png" : ".jpg";
+    }
+    std::ifstream stream(file, std::ios::binary | std::ios::ate);
+    const std::streamoff bytes = stream ? static_cast<std::streamoff>(stream.tellg()) : 0;
+    m_worldPartition.addResource(bytes > 0 ? static_cast<unsigned long long>(bytes) : 1);
+  }
+
+  // Cargar corre en el hilo de streaming; descargar, en el hilo del frame
+  m_worldPartition.setLoader(
+    [this](unsigned int r) {
+      const SceneResource& resource = m_scene.getResource(r);
+      if (resource.type == SCENE_RESOURCE_MODEL) {
+        Model3D* model = new Model3D(resource.path.get(), Model3D::GetModelTypeFromPath(resource.path.get()));
+        if (model->GetState() != ResourceState::Loaded) {
+          delete model;
+          return false;
+        }
+        m_models[r] = model;
+        return true;
+      }
+      HRESULT hr = m_sceneTextures[r].init(m_device, resource.path.get(), static_cast<ExtensionType>(resource.extension));
+      if (FAILED(hr)) {
+        ERROR("BaseApp", "instantiateScene",
+          ("Failed to initialize texture " + std::string(resource.path.get()) + ". HRESULT: " +
+            std::to_string(hr)).c_str());
+        return false;
+      }
+      return true;
+    },
+    [this](unsigned int r) {
+      delete m_models[r];
+      m_models[r] = nullptr;
+      m_sceneTextures[r].destroy();
+      m_sceneTextures[r] = Texture();
+      return true;
+    });
+
+  std::unordered_map<unsigned long long, unsigned int> prefabLookup;
+  m_entityPrefab.assign(scene.getNumEntities(), 0);
+  for (unsigned int e = 0; e < scene.getNumEntities(); ++e) {
+    const SceneEntity& entity = scene.getEntity(e);
+    const unsigned long long prefabKey = (static_cast<unsigned long long>(entity.model) << 32) | entity.texture;
+    auto found = prefabLookup.find(prefabKey);
+    if (found == prefabLookup.end()) {
+      found = prefabLookup.emplace(prefabKey, static_cast<unsigned int>(m_prefabs.size())).first;
+      m_prefabs.push_back(EU::MakeShared<Prefab>());
+      m_prefabUsers.push_back(0);
+    }
+    m_entityPrefab[e] = found->second;
+
+    // El prefab se le pone al actor cuando su celda carga (`attachEntity`)
+    EU::TSharedPointer<Actor> actor = EU::MakeShared<Actor>(EU::TSharedPointer<Prefab>());
+    if (actor.isNull()) {
+      ERROR("BaseApp", "instantiateScene", "Failed to create Actor " << entity.name.get());
+      return E_FAIL;
+    }
+    actor->setName(entity.name.get());
+    actor->setCastShadow((entity.flags & SCENE_ENTITY_CAST_SHADOW) != 0);
+    actor->setStaticShadow((entity.flags & SCENE_ENTITY_STATIC_SHADOW) != 0);
+    actor->setOccluder((entity.flags & SCENE_ENTITY_OCCLUDER) != 0);
+    actor->setLightmapped((entity.flags & SCENE_ENTITY_LIGHTMAPPED) != 0);
+    actor->getComponent<Transform>()->setTransform(
+      EU::Vector3(entity.position[0], entity.position[1], entity.position[2]),
+      EU::Vector3(entity.rotation[0], entity.rotation[1], entity.rotation[2]),
+      EU::Vector3(entity.scale[0], entity.scale[1], entity.scale[2]));
+    m_actors.push_back(actor);
+
+    unsigned int resources[2];
+    unsigned int numResources = 0;
+    if (entity.model < scene.getNumResources()) {
+      resources[numResources++] = entity.model;
+    }
+    if (entity.texture < scene.getNumResources()) {
+      resources[numResources++] = entity.texture;
+    }
+    m_worldPartition.addEntity(XMFLOAT3(entity.position[0], entity.position[1], entity.position[2]),
+                               resources, numResources);
+  }
+  m_actorCollider.assign(m_actors.size(), kInvalidCollider);
+  return S_OK;
+}
+
+/**
+ * @brief Aplico lo que cambió en el streaming: primero suelto lo descargado y luego armo lo nuevo.
+ */
+void
+BaseApp::applyStreaming() {
+  for (unsigned int e : m_worldPartition.getDeactivatedEntities()) {
+    detachEntity(e);
+  }
+  for (unsigned int e : m_worldPartition.getActivatedEntities()) {
+    attachEntity(e);
+  }
+}
+
+/**
+ * @brief Avanzo el horneado del lightmap sin congelar el editor.
+ *
+ * @details
+ *  El baker copia la geometría al arrancar, así que el streaming puede soltar mallas
+ *  mientras hornea. Solo entran los actores marcados y cargados en ese momento.
+ */
+void
+BaseApp::updateLightmapBake() {
+  if (m_lightmapBaker.takeRequest()) {
+    std::vector<LightmapInstance> instances;
+    for (auto& actor : m_actors) {
+      actor->collectLightmapInstances(instances);
+    }
+    if (instances.empty()) {
+      ERROR("BaseApp", "updateLightmapBake", "No loaded actor is marked as lightmapped");
+    }
+    else {
+      m_lightmapBaker.begin(instances, m_lights, m_lightmapBaker.getSettings());
+    }
+  }
 
-  // opcional: liberar modelo si no usas smart pointer
-  delete m_model;
-  m_model = nullptr;
+  if (m_lightmapBaker.isBaking()) {
+    // Unos milisegundos por frame: la UI sigue respondiendo y la vista previa se refina
+    m_lightmapBaker.step(8.0);
+    if (m_lightmapBaker.isFinished()) {
+      const LightmapBakeStats& stats = m_lightmapBaker.getStats();
+      const std::string path = (m_scenePath.empty() ? std::string("Scene") : m_scenePath) + ".urlm";
+      if (SUCCEEDED(LightmapBaker::saveAsset(path, m_lightmapBaker.getData()))) {
+        MESSAGE("BaseApp", "updateLightmapBake", "Lightmap " << path.c_str() << ": " << stats.texels
+          << " texels, " << stats.passes << " passes, " << stats.rays << " rays in "
+          << static_cast<unsigned int>(stats.traceMs) << " ms ("
+          << static_cast<unsigned int>(stats.getRaysPerSecond() / 1000.0) << " Krays/s)");
+      }
+    }
+  }
+
+  // La vista previa cambia una vez por pasada: la textura se recrea solo si cambia el tamaño
+  if (m_lightmapBaker.getPreviewVersion() == m_lightmapPreviewVersion) {
+    return;
+  }
+  m_lightmapPreviewVersion = m_lightmapBaker.getPreviewVersion();
+  const LightmapAtlas& atlas = m_lightmapBaker.getAtlas();
+  const std::vector<unsigned int>& preview = m_lightmapBaker.getPreview();
+  if (preview.empty()) {
+    return;
+  }
+  D3D11_TEXTURE2D_DESC desc = {};
+  if (m_lightmapTexture.m_texture) {
+    m_lightmapTexture.m_texture->GetDesc(&desc);
+  }
+  if (!m_lightmapTexture.m_texture || desc.Width != atlas.width || desc.Height != atlas.height) {
+    m_userInterface.setLightmapPreview(nullptr);
+    m_lightmapView.destroy();
+    m_lightmapTexture.destroy();
+    if (FAILED(m_lightmapTexture.init(m_device, atlas.width, atlas.height, DXGI_FORMAT_R8G8B8A8_UNORM,
+                                      D3D11_BIND_SHADER_RESOURCE)) ||
+        FAILED(m_lightmapView.init(m_device, m_lightmapTexture, DXGI_FORMAT_R8G8B8A8_UNORM))) {
+      ERROR("BaseApp", "updateLightmapBake", "Failed to create the lightmap preview texture");
+      return;
+    }
+    m_userInterface.setLightmapPreview(m_lightmapView.m_textureFromImg);
+  }
+  m_deviceContext.UpdateSubresource(m_lightmapTexture.m_texture, 0, nullptr, preview.data(),
+                                    atlas.width * sizeof(unsigned int), 0);
+}
+
+/**
+ * @brief Le pongo a un actor sus recursos ya cargados: mallas, textura, Animator y collider.
+ *
+ * @param entity Índice de la entidad en la escena (el mismo que en `m_actors`).
+ */
+void
+BaseApp::attachEntity(unsigned int entity) {
+  const SceneEntity& data = m_scene.getEntity(entity);
+  EU::TSharedPointer<Actor>& actor = m_actors[entity];
+  Model3D* model = data.model < m_models.size() ? m_models[data.model] : nullptr;
+  std::vector<MeshComponent> meshes;
+  if (model) {
+    meshes = model->GetMeshes();
+  }
+
+  // Con Animator el skinning reescribe los vertex buffers: cada instancia tiene los suyos
+  const SceneAnimatorData* animatorData = m_scene.getAnimator(data);
+  const bool skinned = animatorData && model && model->HasSkeleton();
+
+  // El primero que lo necesita arma el prefab; los demás solo lo comparten.
+  // Sin modelo no hay nada que armar: el prefab se queda sin preparar hasta que cargue
+  const unsigned int prefabIndex = m_entityPrefab[entity];
+  EU::TSharedPointer<Prefab>& prefab = m_prefabs[prefabIndex];
+  if (model && !prefab->isReady()) {
+    std::vector<Texture> textures;
+    if (data.texture < m_scene.getNumResources() &&
+        m_scene.getResource(data.texture).type == SCENE_RESOURCE_TEXTURE) {
+      textures.push_back(m_sceneTextures[data.texture]);
+    }
+    const std::string name = data.model < m_scene.getNumResources() ? m_scene.getResource(data.model).path.get() : "Prefab";
+    // Las mallas con skinning no van al pool compartido: `actor->setMesh` las reemplaza
+    if (FAILED(prefab->init(&m_device, name, meshes, textures, !skinned))) {
+      return;
+    }
+
+    // Su material: la textura de la escena como albedo (los prefabs con la misma comparten entrada)
+    MaterialSystem& materials = MaterialSystem::getInstance();
+    Material material(name, materials.getLayout());
+    material.setVector("BaseColor", XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+    if (!textures.empty()) {
+      material.setTexture(0u, textures[0].m_textureFromImg);
+    }
+    prefab->setMaterial(materials.acquire(material));
+  }
+  ++m_prefabUsers[prefabIndex];
+  actor->setPrefab(prefab);
+
+  // Animator: solo tiene sentido si el modelo trae esqueleto
+  if (skinned) {
+    // El skinning escribe en los vertex buffers: este actor necesita los suyos
+    actor->setMesh(m_device, meshes);
+    EU::TSharedPointer<Animator> animator = actor->getComponent<Animator>();
+    if (animator.isNull()) {
+      animator = EU::MakeShared<Animator>();
+      actor->addComponent(animator);
+    }
+    animator->setup(&model->GetSkeleton(), meshes);
+    if (animatorData->clip < model->GetAnimations().size()) {
+      animator->play(&model->GetAnimations()[animatorData->clip], animatorData->loop != 0);
+    }
+    animator->setSpeed(animatorData->speed);
+
+    // Radio de la esfera envolvente a partir de los vértices del modelo
+    float radius = 0.0f;
+    for (const MeshComponent& mesh : meshes) {
+      for (const SimpleVertex& v : mesh.m_vertex) {
+        radius = std::max(radius, std::sqrt(v.Pos.x * v.Pos.x + v.Pos.y * v.Pos.y + v.Pos.z * v.Pos.z));
+      }
+    }
+    m_animationScheduler.add(animator.get(), actor->getComponent<Transform>().get(), radius);
+  }
+
+  // Colisiones: una OBB ajustada al actor (sirve para el picking)
+  ColliderDesc desc;
+  if (actor->getCollider(SHAPE_OBB, desc)) {
+    XMFLOAT4X4 world;
+    actor->getWorldMatrix(world);
+    m_actorCollider[entity] = m_collision.addCollider(desc, world, entity);
+  }
+}
+
+/**
+ * @brief Le quito a un actor lo que depende de recursos que se van a descargar.
+ *
+ * @param entity Índice de la entidad en la escena (el mismo que en `m_actors`).
+ */
+void
+BaseApp::detachEntity(unsigned int entity) {
+  EU::TSharedPointer<Actor>& actor = m_actors[entity];
+  EU::TSharedPointer<Animator> animator = actor->getComponent<Animator>();
+  if (!animator.isNull()) {
+    m_animationScheduler.remove(animator.get());
+    animator->stop();
+  }
+  if (m_actorCollider[entity] != kInvalidCollider) {
+    m_collision.removeCollider(m_actorCollider[entity]);
+    m_actorCollider[entity] = kInvalidCollider;
+  }
+  actor->clearMesh();
+
+  // Sin entidades cargadas que lo usen, el prefab suelta sus buffers
+  const unsigned int prefabIndex = m_entityPrefab[entity];
+  if (m_prefabUsers[prefabIndex] > 0 && --m_prefabUsers[prefabIndex] == 0) {
+    m_prefabs[prefabIndex]->destroy();
+  }
 }
 
 /**
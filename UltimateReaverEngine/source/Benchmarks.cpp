@@ -0,0 +1,145 @@
+#include "Benchmarks.h"
+#include "Timer.h"
+#include "JobSystem.h"
+#include "Animation/SkinningKernel.h"
+#include "Animation/CompressedAnimationClip.h"
+#include "Animation/AnimationScheduler.h"
+#include "Lighting/ClusteredLighting.h"
+#include "Shadows/CascadedShadows.h"
+#include "Culling/SoftwareOcclusion.h"
+#include "Particles/ParticleSystem.h"
+#include "Simulation/FixedTimestep.h"
+#include "Collision/CollisionWorld.h"
+#include "Collision/TriangleBVH.h"
+#include "Scene/SceneFile.h"
+#include "Scene/WorldPartition.h"
+#include "ECS/Prefab.h"
+#include "RenderStateCache.h"
+#include "GeometryPool.h"
+#include "MeshIndexing.h"
+#include "MeshCodec.h"
+#include "TangentSpace.h"
+#include "GltfImporter.h"
+#include "SceneOutliner.h"
+#include "UIFrameCache.h"
+#include "ViewSystem.h"
+#include "Materials/MaterialSystem.h"
+#include "Lighting/LightmapBaker.h"
+#include "Model3D.h"
+#include "EngineUtilities/Memory/TLSFAllocator.h"
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+  struct
+    BenchmarkEntry {
+    const char* name;
+    Benchmarks::BenchmarkFunc func;
+  };
+
+  // Cada subsistema nuevo con benchmark se registra aquí
+  const BenchmarkEntry g_benchmarks[] = {
+    { "skinning", &SkinningKernel::runBenchmark },
+    { "animation", &CompressedAnimationClip::runBenchmark },
+    { "animation-lod", &AnimationScheduler::runBenchmark },
+    { "lights", &ClusteredLighting::runBenchmark },
+    { "shadows", &CascadedShadows::runBenchmark },
+    { "occlusion", &SoftwareOcclusion::runBenchmark },
+    { "particles", &ParticleSystem::runBenchmark },
+    { "fixed-step", &FixedTimestep::runBenchmark },
+    { "collision", &CollisionWorld::runBenchmark },
+    { "triangle-bvh", &TriangleBVH::runBenchmark },
+    { "scene", &SceneFile::runBenchmark },
+    { "streaming", &WorldPartition::runBenchmark },
+    { "prefab", &Prefab::runBenchmark },
+    { "state-cache", &RenderStateCache::runBenchmark },
+    { "geometry-pool", &GeometryPool::runBenchmark },
+    { "tlsf", &EU::TLSFAllocatorST::runBenchmark },
+    { "index-format", &MeshIndexing::runBenchmark },
+    { "mesh-codec", &MeshCodec::runBenchmark },
+    { "tangent-space", &TangentSpace::runBenchmark },
+    { "gltf", &GltfImporter::runBenchmark },
+    { "gltf-vs-fbx", &Model3D::runImportBenchmark },
+    { "outliner", &SceneOutliner::runBenchmark },
+    { "ui-cache", &UIFrameCache::runBenchmark },
+    { "views", &ViewSystem::runBenchmark },
+    { "materials", &MaterialSystem::runBenchmark },
+    { "lightmap", &LightmapBaker::runBenchmark },
+  };
+
+} // namespace
+
+void
+BenchmarkReport::log(const char* format, ...) {
+  char buffer[1024];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+
+  std::string line = std::string(buffer) + "\n";
+  m_text += line;
+  OutputDebugStringA(line.c_str());
+}
+
+void
+BenchmarkReport::section(const std::string& name) {
+  log("");
+  log("==== %s ====", name.c_str());
+}
+
+void
+BenchmarkReport::fail(const std::string& message) {
+  ++m_failures;
+  log("FAILED: %s", message.c_str());
+}
+
+bool
+BenchmarkReport::writeToFile(const std::string& path) const {
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  if (!file) {
+    ERROR("BenchmarkReport", "writeToFile", "Could not open " << path.c_str());
+    return false;
+  }
+  file << m_text;
+  return true;
+}
+
+int
+Benchmarks::run(const std::string& filter, const std::string& outputPath) {
+  BenchmarkReport report;
+  JobSystem& jobs = JobSystem::getInstance();
+  jobs.init();
+  report.log("UltimateReaverEngine benchmarks (%u threads)", jobs.getNumThreads());
+
+  // Nombre exacto: "gltf" no arrastra a "gltf-vs-fbx"
+  const bool runAll = filter == "all";
+  Timer total;
+  unsigned int count = 0;
+  for (const BenchmarkEntry& entry : g_benchmarks) {
+    if (!runAll && filter != entry.name) {
+      continue;
+    }
+    report.section(entry.name);
+    Timer timer;
+    entry.func(report);
+    report.log("(%s: %.1f ms)", entry.name, timer.elapsedMs());
+    ++count;
+  }
+  if (count == 0) {
+    std::string names;
+    for (const BenchmarkEntry& entry : g_benchmarks) {
+      names += std::string(" ") + entry.name;
+    }
+    report.fail("unknown benchmark \"" + filter + "\"; use all or one of:" + names);
+  }
+
+  report.log("");
+  report.log("%u benchmark(s), %u failure(s), %.1f ms total",
+             count, report.getFailureCount(), total.elapsedMs());
+  report.writeToFile(outputPath);
+  jobs.destroy();
+  return report.getFailureCount() == 0 ? 0 : 1;
+}
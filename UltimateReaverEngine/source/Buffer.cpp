@@ -1,6 +1,7 @@
 #include "Buffer.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "MeshIndexing.h"
 
 HRESULT
 Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
@@ -19,6 +20,7 @@ Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
 
 	D3D11_BUFFER_DESC desc = {};
 	D3D11_SUBRESOURCE_DATA data = {};
+	std::vector<unsigned short> narrowed;
 
 	desc.Usage = D3D11_USAGE_DEFAULT;
 	desc.CPUAccessFlags = 0;
@@ -31,10 +33,19 @@ Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
 		data.pSysMem = mesh.m_vertex.data();
 	}
 	else if (bindFlag & D3D11_BIND_INDEX_BUFFER) {
-		m_stride = sizeof(unsigned int);
+		// En CPU son de 32 bits; si caben, a la GPU van de 16
+		m_format = MeshIndexing::chooseFormat(mesh);
+		m_stride = MeshIndexing::getStride(m_format);
 		desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_index.size());
 		desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
-		data.pSysMem = mesh.m_index.data();
+		if (m_format == DXGI_FORMAT_R16_UINT) {
+			narrowed.resize(mesh.m_index.size());
+			MeshIndexing::narrow(mesh.m_index.data(), mesh.m_index.size(), narrowed.data());
+			data.pSysMem = narrowed.data();
+		}
+		else {
+			data.pSysMem = mesh.m_index.data();
+		}
 	}
 
 	return createBuffer(device, desc, &data);
@@ -61,6 +72,34 @@ Buffer::init(Device& device, unsigned int ByteWidth) {
 	return createBuffer(device, desc, nullptr);
 }
 
+HRESULT
+Buffer::init(Device& device, unsigned int numElements, unsigned int stride, unsigned int bindFlag) {
+	if (!device.m_device) {
+		ERROR("Buffer", "init", "Device is null.");
+		return E_POINTER;
+	}
+	if (numElements == 0 || stride == 0) {
+		ERROR("Buffer", "init", "Buffer size is zero");
+		return E_INVALIDARG;
+	}
+	if (bindFlag != D3D11_BIND_VERTEX_BUFFER && bindFlag != D3D11_BIND_INDEX_BUFFER) {
+		ERROR("Buffer", "init", "Only vertex and index buffers can be created empty");
+		return E_INVALIDARG;
+	}
+	m_stride = stride;
+	m_bindFlag = bindFlag;
+	if (bindFlag == D3D11_BIND_INDEX_BUFFER) {
+		m_format = stride == sizeof(unsigned short) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	}
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.ByteWidth = numElements * stride;
+	desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
+
+	return createBuffer(device, desc, nullptr);
+}
+
 void
 Buffer::update(DeviceContext& deviceContext,
 	ID3D11Resource* pDstResource,
@@ -119,7 +158,9 @@ Buffer::render(DeviceContext& deviceContext,
 		}
 		break;
 	case D3D11_BIND_INDEX_BUFFER:
-		deviceContext.m_deviceContext->IASetIndexBuffer(m_buffer, format, m_offset);
+		deviceContext.m_deviceContext->IASetIndexBuffer(m_buffer,
+			format == DXGI_FORMAT_UNKNOWN ? m_format : format,
+			m_offset);
 		break;
 	default:
 		ERROR("Buffer", "render", "Unsupported BindFlag");
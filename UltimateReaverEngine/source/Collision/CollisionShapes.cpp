@@ -0,0 +1,561 @@
+#include "Collision/CollisionShapes.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+  inline XMFLOAT3
+    add(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x + b.x, a.y + b.y, a.z + b.z); }
+
+  inline XMFLOAT3
+    sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+
+  inline XMFLOAT3
+    scale(const XMFLOAT3& a, float s) { return XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+
+  inline float
+    dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+  inline XMFLOAT3
+    cross(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+  }
+
+  inline float
+    length(const XMFLOAT3& a) { return std::sqrt(dot(a, a)); }
+
+  inline float
+    component(const XMFLOAT3& a, int i) { return i == 0 ? a.x : (i == 1 ? a.y : a.z); }
+
+  inline bool
+    isBox(ShapeType type) { return type == SHAPE_AABB || type == SHAPE_OBB; }
+
+  /// @brief Punto del segmento `[a, b]` más cercano a `p`.
+  XMFLOAT3
+    closestOnSegment(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& p) {
+    XMFLOAT3 ab = sub(b, a);
+    float lengthSq = dot(ab, ab);
+    if (lengthSq <= 1e-12f) {
+      return a;
+    }
+    float t = std::min(std::max(dot(sub(p, a), ab) / lengthSq, 0.0f), 1.0f);
+    return add(a, scale(ab, t));
+  }
+
+  /// @brief Puntos más cercanos entre dos segmentos (Ericson, 5.1.9).
+  void
+    closestSegmentSegment(const XMFLOAT3& p1, const XMFLOAT3& q1,
+                          const XMFLOAT3& p2, const XMFLOAT3& q2,
+                          XMFLOAT3& c1, XMFLOAT3& c2) {
+    XMFLOAT3 d1 = sub(q1, p1);
+    XMFLOAT3 d2 = sub(q2, p2);
+    XMFLOAT3 r = sub(p1, p2);
+    float a = dot(d1, d1);
+    float e = dot(d2, d2);
+    float f = dot(d2, r);
+    float s = 0.0f;
+    float t = 0.0f;
+    if (a <= 1e-12f && e <= 1e-12f) {
+      c1 = p1;
+      c2 = p2;
+      return;
+    }
+    if (a <= 1e-12f) {
+      t = std::min(std::max(f / e, 0.0f), 1.0f);
+    }
+    else {
+      float c = dot(d1, r);
+      if (e <= 1e-12f) {
+        s = std::min(std::max(-c / a, 0.0f), 1.0f);
+      }
+      else {
+        float b = dot(d1, d2);
+        float denom = a * e - b * b;
+        s = denom != 0.0f ? std::min(std::max((b * f - c * e) / denom, 0.0f), 1.0f) : 0.0f;
+        t = (b * s + f) / e;
+        if (t < 0.0f) {
+          t = 0.0f;
+          s = std::min(std::max(-c / a, 0.0f), 1.0f);
+        }
+        else if (t > 1.0f) {
+          t = 1.0f;
+          s = std::min(std::max((b - c) / a, 0.0f), 1.0f);
+        }
+      }
+    }
+    c1 = add(p1, scale(d1, s));
+    c2 = add(p2, scale(d2, t));
+  }
+
+  /// @brief Punto de la caja más cercano a `p`.
+  XMFLOAT3
+    closestOnBox(const WorldShape& box, const XMFLOAT3& p) {
+    XMFLOAT3 d = sub(p, box.center);
+    XMFLOAT3 result = box.center;
+    for (int i = 0; i < 3; ++i) {
+      float h = component(box.halfExtents, i);
+      float t = std::min(std::max(dot(d, box.axis[i]), -h), h);
+      result = add(result, scale(box.axis[i], t));
+    }
+    return result;
+  }
+
+  /// @brief Dos esferas (o puntos engordados); normal de `pa` hacia `pb`.
+  bool
+    spheres(const XMFLOAT3& pa, float ra, const XMFLOAT3& pb, float rb,
+            XMFLOAT3& normal, float& depth) {
+    XMFLOAT3 d = sub(pb, pa);
+    float distSq = dot(d, d);
+    float radius = ra + rb;
+    if (distSq > radius * radius) {
+      return false;
+    }
+    float dist = std::sqrt(distSq);
+    normal = dist > 1e-6f ? scale(d, 1.0f / dist) : XMFLOAT3(0.0f, 1.0f, 0.0f);
+    depth = radius - dist;
+    return true;
+  }
+
+  /// @brief Caja contra esfera; normal de la caja hacia la esfera.
+  bool
+    boxSphere(const WorldShape& box, const XMFLOAT3& p, float r, XMFLOAT3& normal, float& depth) {
+    XMFLOAT3 d = sub(p, box.center);
+    float local[3];
+    bool inside = true;
+    for (int i = 0; i < 3; ++i) {
+      local[i] = dot(d, box.axis[i]);
+      inside = inside && std::fabs(local[i]) <= component(box.halfExtents, i);
+    }
+    if (!inside) {
+      XMFLOAT3 closest = closestOnBox(box, p);
+      return spheres(closest, 0.0f, p, r, normal, depth);
+    }
+    // Centro adentro: salgo por la cara más cercana
+    int face = 0;
+    float best = FLT_MAX;
+    for (int i = 0; i < 3; ++i) {
+      float gap = component(box.halfExtents, i) - std::fabs(local[i]);
+      if (gap < best) {
+        best = gap;
+        face = i;
+      }
+    }
+    normal = scale(box.axis[face], local[face] < 0.0f ? -1.0f : 1.0f);
+    depth = r + best;
+    return true;
+  }
+
+  /// @brief Punto en el espacio de la caja (origen en el centro, ejes de `box.axis`).
+  XMFLOAT3
+    toBoxSpace(const WorldShape& box, const XMFLOAT3& p) {
+    XMFLOAT3 d = sub(p, box.center);
+    return XMFLOAT3(dot(d, box.axis[0]), dot(d, box.axis[1]), dot(d, box.axis[2]));
+  }
+
+  /// @brief Distancia² de un punto (en espacio de la caja) a la caja: clamp por eje.
+  float
+    boxDistanceSq(const XMFLOAT3& half, const XMFLOAT3& local) {
+    float distSq = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+      float excess = std::fabs(component(local, i)) - component(half, i);
+      distSq += excess > 0.0f ? excess * excess : 0.0f;
+    }
+    return distSq;
+  }
+
+  /// @brief Lo que le falta a un punto interior para salir por la cara más cercana.
+  float
+    boxGap(const XMFLOAT3& half, const XMFLOAT3& local) {
+    float gap = FLT_MAX;
+    for (int i = 0; i < 3; ++i) {
+      gap = std::min(gap, component(half, i) - std::fabs(component(local, i)));
+    }
+    return gap;
+  }
+
+  /**
+   * @brief Punto del segmento `[a, b]` (en espacio de la caja) que manda en la prueba contra la caja.
+   *
+   * @details
+   *  Si el segmento cruza la caja (recorte contra las tres losas), regreso su punto más hondo:
+   *  `boxGap` es cóncava y lineal por tramos sobre el tramo interior, así que el máximo está en
+   *  un extremo del tramo, donde una coordenada cruza 0 o donde dos caras empatan. Si no la
+   *  cruza, la distancia mínima está en un extremo del segmento (cara o vértice) o en el par
+   *  más cercano contra una de las 12 aristas.
+   */
+  XMFLOAT3
+    closestSegmentBox(const XMFLOAT3& half, const XMFLOAT3& a, const XMFLOAT3& b) {
+    const XMFLOAT3 d = sub(b, a);
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for (int i = 0; i < 3 && t0 <= t1; ++i) {
+      const float h = component(half, i);
+      const float start = component(a, i);
+      const float delta = component(d, i);
+      if (std::fabs(delta) <= 1e-12f) {
+        if (std::fabs(start) > h) {
+          t1 = -1.0f;
+        }
+        continue;
+      }
+      float enter = (-h - start) / delta;
+      float exit = (h - start) / delta;
+      if (enter > exit) {
+        std::swap(enter, exit);
+      }
+      t0 = std::max(t0, enter);
+      t1 = std::min(t1, exit);
+    }
+
+    if (t0 <= t1) {
+      float bestT = t0;
+      float bestGap = -FLT_MAX;
+      auto tryT = [&](float t) {
+        if (t < t0 || t > t1) {
+          return;
+        }
+        const float gap = boxGap(half, add(a, scale(d, t)));
+        if (gap > bestGap) {
+          bestGap = gap;
+          bestT = t;
+        }
+      };
+      tryT(t0);
+      tryT(t1);
+      for (int i = 0; i < 3; ++i) {
+        const float delta = component(d, i);
+        if (std::fabs(delta) > 1e-12f) {
+          tryT(-component(a, i) / delta);
+        }
+        // h_i - s_i * x_i(t) = h_j - s_j * x_j(t)
+        for (int j = i + 1; j < 3; ++j) {
+          for (int signs = 0; signs < 4; ++signs) {
+            const float si = (signs & 1) ? -1.0f : 1.0f;
+            const float sj = (signs & 2) ? -1.0f : 1.0f;
+            const float denom = si * component(d, i) - sj * component(d, j);
+            if (std::fabs(denom) > 1e-12f) {
+              tryT((component(half, i) - component(half, j) -
+                    si * component(a, i) + sj * component(a, j)) / denom);
+            }
+          }
+        }
+      }
+      return add(a, scale(d, bestT));
+    }
+
+    XMFLOAT3 best = a;
+    float bestDistSq = boxDistanceSq(half, a);
+    auto tryPoint = [&](const XMFLOAT3& p) {
+      const float distSq = boxDistanceSq(half, p);
+      if (distSq < bestDistSq) {
+        bestDistSq = distSq;
+        best = p;
+      }
+    };
+    tryPoint(b);
+    for (int i = 0; i < 3; ++i) {
+      const int j = (i + 1) % 3;
+      const int k = (i + 2) % 3;
+      for (int corner = 0; corner < 4; ++corner) {
+        float from[3];
+        float to[3];
+        from[i] = -component(half, i);
+        to[i] = component(half, i);
+        from[j] = to[j] = (corner & 1) ? component(half, j) : -component(half, j);
+        from[k] = to[k] = (corner & 2) ? component(half, k) : -component(half, k);
+        XMFLOAT3 onSegment;
+        XMFLOAT3 onEdge;
+        closestSegmentSegment(a, b, XMFLOAT3(from[0], from[1], from[2]), XMFLOAT3(to[0], to[1], to[2]),
+                              onSegment, onEdge);
+        tryPoint(onSegment);
+      }
+    }
+    return best;
+  }
+
+  /// @brief Caja contra cápsula: el punto exacto del eje contra la caja, como esfera.
+  bool
+    boxCapsule(const WorldShape& box, const WorldShape& capsule, XMFLOAT3& normal, float& depth) {
+    const XMFLOAT3 local = closestSegmentBox(box.halfExtents,
+                                             toBoxSpace(box, capsule.segmentA),
+                                             toBoxSpace(box, capsule.segmentB));
+    XMFLOAT3 p = box.center;
+    for (int i = 0; i < 3; ++i) {
+      p = add(p, scale(box.axis[i], component(local, i)));
+    }
+    return boxSphere(box, p, capsule.radius, normal, depth);
+  }
+
+  /// @brief SAT con los 15 ejes; la normal es el eje de menor penetración.
+  bool
+    boxBox(const WorldShape& a, const WorldShape& b, XMFLOAT3& normal, float& depth) {
+    XMFLOAT3 t = sub(b.center, a.center);
+    float best = FLT_MAX;
+    XMFLOAT3 bestAxis(0.0f, 1.0f, 0.0f);
+
+    auto testAxis = [&](const XMFLOAT3& axis) {
+      float ra = 0.0f;
+      float rb = 0.0f;
+      for (int k = 0; k < 3; ++k) {
+        ra += component(a.halfExtents, k) * std::fabs(dot(a.axis[k], axis));
+        rb += component(b.halfExtents, k) * std::fabs(dot(b.axis[k], axis));
+      }
+      float dist = dot(t, axis);
+      float overlapDepth = ra + rb - std::fabs(dist);
+      if (overlapDepth < 0.0f) {
+        return false;
+      }
+      if (overlapDepth < best) {
+        best = overlapDepth;
+        bestAxis = dist < 0.0f ? scale(axis, -1.0f) : axis;
+      }
+      return true;
+    };
+
+    for (int i = 0; i < 3; ++i) {
+      if (!testAxis(a.axis[i]) || !testAxis(b.axis[i])) {
+        return false;
+      }
+    }
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        XMFLOAT3 axis = cross(a.axis[i], b.axis[j]);
+        float len = length(axis);
+        // Ejes casi paralelos: ya los cubren las caras
+        if (len > 1e-5f && !testAxis(scale(axis, 1.0f / len))) {
+          return false;
+        }
+      }
+    }
+    normal = bestAxis;
+    depth = best;
+    return true;
+  }
+
+  /// @brief Rayo contra esfera; desde adentro no cuenta.
+  bool
+    raySphere(const XMFLOAT3& center, float radius, const XMFLOAT3& origin, const XMFLOAT3& direction,
+              float maxDistance, float& distance, XMFLOAT3& normal) {
+    XMFLOAT3 m = sub(origin, center);
+    float b = dot(m, direction);
+    float c = dot(m, m) - radius * radius;
+    if (c <= 0.0f || b > 0.0f) {
+      return false;
+    }
+    float disc = b * b - c;
+    if (disc < 0.0f) {
+      return false;
+    }
+    float t = -b - std::sqrt(disc);
+    if (t < 0.0f || t > maxDistance) {
+      return false;
+    }
+    distance = t;
+    normal = scale(add(m, scale(direction, t)), 1.0f / radius);
+    return true;
+  }
+
+} // namespace
+
+WorldShape
+CollisionShapes::toWorld(const ColliderDesc& desc, const XMFLOAT4X4& world) {
+  const XMFLOAT3 rows[3] = {
+    XMFLOAT3(world._11, world._12, world._13),
+    XMFLOAT3(world._21, world._22, world._23),
+    XMFLOAT3(world._31, world._32, world._33)
+  };
+  const float scales[3] = { length(rows[0]), length(rows[1]), length(rows[2]) };
+
+  WorldShape shape;
+  shape.type = desc.type;
+  shape.center = add(add(add(scale(rows[0], desc.center.x), scale(rows[1], desc.center.y)),
+                         scale(rows[2], desc.center.z)),
+                     XMFLOAT3(world._41, world._42, world._43));
+  shape.axis[0] = XMFLOAT3(1.0f, 0.0f, 0.0f);
+  shape.axis[1] = XMFLOAT3(0.0f, 1.0f, 0.0f);
+  shape.axis[2] = XMFLOAT3(0.0f, 0.0f, 1.0f);
+  shape.halfExtents = XMFLOAT3(0.0f, 0.0f, 0.0f);
+  shape.segmentA = shape.center;
+  shape.segmentB = shape.center;
+
+  switch (desc.type) {
+  case SHAPE_AABB: {
+    // La caja rotada vuelve a alinearse: extensión = |M| * extensión local
+    float extent[3];
+    for (int k = 0; k < 3; ++k) {
+      extent[k] = std::fabs(desc.halfExtents.x * component(rows[0], k)) +
+                  std::fabs(desc.halfExtents.y * component(rows[1], k)) +
+                  std::fabs(desc.halfExtents.z * component(rows[2], k));
+    }
+    shape.halfExtents = XMFLOAT3(extent[0], extent[1], extent[2]);
+    break;
+  }
+  case SHAPE_OBB: {
+    float extent[3];
+    for (int i = 0; i < 3; ++i) {
+      if (scales[i] > 1e-12f) {
+        shape.axis[i] = scale(rows[i], 1.0f / scales[i]);
+      }
+      extent[i] = component(desc.halfExtents, i) * scales[i];
+    }
+    shape.halfExtents = XMFLOAT3(extent[0], extent[1], extent[2]);
+    break;
+  }
+  case SHAPE_SPHERE:
+    shape.radius = desc.radius * std::max(scales[0], std::max(scales[1], scales[2]));
+    break;
+  case SHAPE_CAPSULE:
+    shape.radius = desc.radius * std::max(scales[0], scales[2]);
+    shape.segmentA = add(shape.center, scale(rows[1], desc.halfHeight));
+    shape.segmentB = sub(shape.center, scale(rows[1], desc.halfHeight));
+    break;
+  }
+  return shape;
+}
+
+void
+CollisionShapes::computeBounds(const WorldShape& shape, float minPoint[3], float maxPoint[3]) {
+  if (isBox(shape.type)) {
+    for (int k = 0; k < 3; ++k) {
+      float extent = shape.halfExtents.x * std::fabs(component(shape.axis[0], k)) +
+                     shape.halfExtents.y * std::fabs(component(shape.axis[1], k)) +
+                     shape.halfExtents.z * std::fabs(component(shape.axis[2], k));
+      minPoint[k] = component(shape.center, k) - extent;
+      maxPoint[k] = component(shape.center, k) + extent;
+    }
+    return;
+  }
+  for (int k = 0; k < 3; ++k) {
+    float a = component(shape.segmentA, k);
+    float b = component(shape.segmentB, k);
+    minPoint[k] = std::min(a, b) - shape.radius;
+    maxPoint[k] = std::max(a, b) + shape.radius;
+  }
+}
+
+bool
+CollisionShapes::overlap(const WorldShape& a, const WorldShape& b, XMFLOAT3& normal, float& depth) {
+  // Si `a` es redonda y `b` caja, invierto y volteo la normal
+  if (!isBox(a.type) && isBox(b.type)) {
+    if (!overlap(b, a, normal, depth)) {
+      return false;
+    }
+    normal = scale(normal, -1.0f);
+    return true;
+  }
+
+  if (isBox(a.type)) {
+    if (isBox(b.type)) {
+      return boxBox(a, b, normal, depth);
+    }
+    if (b.type == SHAPE_SPHERE) {
+      return boxSphere(a, b.center, b.radius, normal, depth);
+    }
+    return boxCapsule(a, b, normal, depth);
+  }
+
+  // Esferas y cápsulas: distancia entre segmentos (la esfera es un segmento de largo 0)
+  XMFLOAT3 pa;
+  XMFLOAT3 pb;
+  closestSegmentSegment(a.segmentA, a.segmentB, b.segmentA, b.segmentB, pa, pb);
+  return spheres(pa, a.radius, pb, b.radius, normal, depth);
+}
+
+bool
+CollisionShapes::raycast(const WorldShape& shape,
+                         const XMFLOAT3& origin,
+                         const XMFLOAT3& direction,
+                         float maxDistance,
+                         float& distance,
+                         XMFLOAT3& normal) {
+  if (shape.type == SHAPE_SPHERE) {
+    return raySphere(shape.center, shape.radius, origin, direction, maxDistance, distance, normal);
+  }
+
+  if (isBox(shape.type)) {
+    // Slabs en el espacio de la caja
+    XMFLOAT3 m = sub(origin, shape.center);
+    float tEnter = 0.0f;
+    float tExit = maxDistance;
+    int enterAxis = -1;
+    float enterSign = 1.0f;
+    for (int i = 0; i < 3; ++i) {
+      float o = dot(m, shape.axis[i]);
+      float d = dot(direction, shape.axis[i]);
+      float h = component(shape.halfExtents, i);
+      if (std::fabs(d) < 1e-12f) {
+        if (std::fabs(o) > h) {
+          return false;
+        }
+        continue;
+      }
+      float t1 = (-h - o) / d;
+      float t2 = (h - o) / d;
+      float sign = -1.0f;
+      if (t1 > t2) {
+        std::swap(t1, t2);
+        sign = 1.0f;
+      }
+      if (t1 > tEnter) {
+        tEnter = t1;
+        enterAxis = i;
+        enterSign = sign;
+      }
+      tExit = std::min(tExit, t2);
+      if (tEnter > tExit) {
+        return false;
+      }
+    }
+    if (enterAxis < 0) {
+      return false;
+    }
+    distance = tEnter;
+    normal = scale(shape.axis[enterAxis], enterSign);
+    return true;
+  }
+
+  // Cápsula: si arranca adentro no cuenta; si no, lo mejor entre cilindro y tapas
+  XMFLOAT3 closest = closestOnSegment(shape.segmentA, shape.segmentB, origin);
+  XMFLOAT3 fromAxis = sub(origin, closest);
+  if (dot(fromAxis, fromAxis) <= shape.radius * shape.radius) {
+    return false;
+  }
+  bool hit = false;
+  float best = maxDistance;
+  float t;
+  XMFLOAT3 n;
+  if (raySphere(shape.segmentA, shape.radius, origin, direction, best, t, n)) {
+    best = t;
+    normal = n;
+    hit = true;
+  }
+  if (raySphere(shape.segmentB, shape.radius, origin, direction, best, t, n)) {
+    best = t;
+    normal = n;
+    hit = true;
+  }
+  XMFLOAT3 axis = sub(shape.segmentB, shape.segmentA);
+  float axisLength = length(axis);
+  if (axisLength > 1e-6f) {
+    XMFLOAT3 u = scale(axis, 1.0f / axisLength);
+    XMFLOAT3 m = sub(origin, shape.segmentA);
+    XMFLOAT3 dPerp = sub(direction, scale(u, dot(direction, u)));
+    XMFLOAT3 mPerp = sub(m, scale(u, dot(m, u)));
+    float a = dot(dPerp, dPerp);
+    float b = dot(mPerp, dPerp);
+    float c = dot(mPerp, mPerp) - shape.radius * shape.radius;
+    float disc = b * b - a * c;
+    if (a > 1e-12f && disc >= 0.0f) {
+      t = (-b - std::sqrt(disc)) / a;
+      float along = dot(add(m, scale(direction, t)), u);
+      if (t >= 0.0f && t <= best && along >= 0.0f && along <= axisLength) {
+        best = t;
+        normal = scale(add(mPerp, scale(dPerp, t)), 1.0f / shape.radius);
+        hit = true;
+      }
+    }
+  }
+  distance = best;
+  return hit;
+}
@@ -0,0 +1,886 @@
+#include "Collision/TriangleBVH.h"
+#include "MeshComponent.h"
+#include "Simulation/SimulationReplay.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+  /// @brief Bins por eje del SAH.
+  const int kBins = 16;
+
+  /// @brief Profundidad máxima de la pila de recorrido.
+  const int kStackSize = 128;
+
+  /// @brief Determinantes más chicos que esto son triángulos degenerados o rayos paralelos.
+  const float kDetEpsilon = 1e-20f;
+
+  /**
+   * @struct SectionHeader
+   * @brief Inicio de la BVH serializada de una malla; le siguen los nodos y el orden.
+   */
+  struct
+    SectionHeader {
+    unsigned long long geometryHash;
+    unsigned int numNodes;
+    unsigned int numTriangles;
+  };
+
+  /// @brief Inverso seguro para los slabs (sin 0 * inf = NaN).
+  inline float
+    safeInverse(float d) {
+    return 1.0f / (std::fabs(d) < 1e-20f ? (d < 0.0f ? -1e-20f : 1e-20f) : d);
+  }
+
+  inline const XMFLOAT3&
+    positionAt(const XMFLOAT3* positions, size_t stride, unsigned int index) {
+    return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const char*>(positions) + index * stride);
+  }
+
+  /// @brief Mitad del área de una caja (solo importan las proporciones).
+  inline float
+    halfArea(const float minPoint[3], const float maxPoint[3]) {
+    const float dx = maxPoint[0] - minPoint[0];
+    const float dy = maxPoint[1] - minPoint[1];
+    const float dz = maxPoint[2] - minPoint[2];
+    return dx * dy + dy * dz + dz * dx;
+  }
+
+  /**
+   * @struct Bin
+   * @brief Caja y número de triángulos de un bin del SAH.
+   */
+  struct
+    Bin {
+    float minPoint[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float maxPoint[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    unsigned int count = 0;
+
+    void
+      grow(const float* lo, const float* hi) {
+      for (int c = 0; c < 3; ++c) {
+        minPoint[c] = std::min(minPoint[c], lo[c]);
+        maxPoint[c] = std::max(maxPoint[c], hi[c]);
+      }
+    }
+
+    void
+      grow(const Bin& other) { grow(other.minPoint, other.maxPoint); }
+  };
+
+  /**
+   * @brief Möller–Trumbore de un rayo contra un triángulo precalculado.
+   *
+   * @details Mismas operaciones y en el mismo orden que la versión SSE, para que den igual.
+   */
+  inline bool
+    intersectTriangle(const float v0[3], const float e1[3], const float e2[3],
+                      const float o[3], const float d[3], float best,
+                      float& t, float& u, float& v) {
+    const float px = d[1] * e2[2] - d[2] * e2[1];
+    const float py = d[2] * e2[0] - d[0] * e2[2];
+    const float pz = d[0] * e2[1] - d[1] * e2[0];
+    const float det = e1[0] * px + e1[1] * py + e1[2] * pz;
+    if (std::fabs(det) < kDetEpsilon) {
+      return false;
+    }
+    const float inv = 1.0f / det;
+    const float tx = o[0] - v0[0], ty = o[1] - v0[1], tz = o[2] - v0[2];
+    u = (tx * px + ty * py + tz * pz) * inv;
+    if (u < 0.0f || u > 1.0f) {
+      return false;
+    }
+    const float qx = ty * e1[2] - tz * e1[1];
+    const float qy = tz * e1[0] - tx * e1[2];
+    const float qz = tx * e1[1] - ty * e1[0];
+    v = (d[0] * qx + d[1] * qy + d[2] * qz) * inv;
+    if (v < 0.0f || u + v > 1.0f) {
+      return false;
+    }
+    t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inv;
+    return t > 0.0f && t < best;
+  }
+
+  /// @brief Selecciono `a` donde `mask` y `b` donde no.
+  inline __m128
+    select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+
+} // namespace
+
+void
+TriangleBVH::build(const std::vector<SimpleVertex>& vertices, const std::vector<unsigned int>& indices) {
+  build(vertices.empty() ? nullptr : &vertices[0].Pos,
+        vertices.size(),
+        sizeof(SimpleVertex),
+        indices.data(),
+        indices.size());
+}
+
+void
+TriangleBVH::build(const XMFLOAT3* positions,
+                   size_t numVertices,
+                   size_t stride,
+                   const unsigned int* indices,
+                   size_t numIndices,
+                   const TriangleBVHSettings& settings) {
+  m_nodes.clear();
+  m_triangles.clear();
+  m_order.clear();
+  m_geometryHash = hashGeometry(positions, numVertices, stride, indices, numIndices);
+
+  const size_t numTriangles = numIndices / 3;
+  if (numTriangles == 0) {
+    return;
+  }
+  for (size_t i = 0; i < numTriangles * 3; ++i) {
+    if (indices[i] >= numVertices) {
+      ERROR("TriangleBVH", "build", "Index " << indices[i] << " out of range (" << numVertices << " vertices)");
+      return;
+    }
+  }
+
+  // Caja y centroide de cada triángulo
+  std::vector<float> triMin(numTriangles * 3);
+  std::vector<float> triMax(numTriangles * 3);
+  std::vector<float> centroid(numTriangles * 3);
+  JobSystem::getInstance().parallelFor(numTriangles, 4096, [&](size_t begin, size_t end) {
+    for (size_t t = begin; t < end; ++t) {
+      const XMFLOAT3& a = positionAt(positions, stride, indices[t * 3 + 0]);
+      const XMFLOAT3& b = positionAt(positions, stride, indices[t * 3 + 1]);
+      const XMFLOAT3& c = positionAt(positions, stride, indices[t * 3 + 2]);
+      const float pa[3] = { a.x, a.y, a.z }, pb[3] = { b.x, b.y, b.z }, pc[3] = { c.x, c.y, c.z };
+      for (int k = 0; k < 3; ++k) {
+        triMin[t * 3 + k] = std::min(pa[k], std::min(pb[k], pc[k]));
+        triMax[t * 3 + k] = std::max(pa[k], std::max(pb[k], pc[k]));
+        centroid[t * 3 + k] = (triMin[t * 3 + k] + triMax[t * 3 + k]) * 0.5f;
+      }
+    }
+  });
+
+  m_order.resize(numTriangles);
+  for (size_t t = 0; t < numTriangles; ++t) {
+    m_order[t] = static_cast<unsigned int>(t);
+  }
+
+  m_nodes.reserve(numTriangles * 2);
+  Node root;
+  root.first = 0;
+  root.count = static_cast<unsigned int>(numTriangles);
+  m_nodes.push_back(root);
+
+  std::vector<unsigned int> stack;
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const unsigned int nodeIndex = stack.back();
+    stack.pop_back();
+    const unsigned int first = m_nodes[nodeIndex].first;
+    const unsigned int count = m_nodes[nodeIndex].count;
+
+    // Caja del nodo y caja de los centroides
+    Bin nodeBox;
+    float cMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float cMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (unsigned int i = first; i < first + count; ++i) {
+      const unsigned int t = m_order[i];
+      nodeBox.grow(&triMin[t * 3], &triMax[t * 3]);
+      for (int k = 0; k < 3; ++k) {
+        cMin[k] = std::min(cMin[k], centroid[t * 3 + k]);
+        cMax[k] = std::max(cMax[k], centroid[t * 3 + k]);
+      }
+    }
+    Node& node = m_nodes[nodeIndex];
+    memcpy(node.minPoint, nodeBox.minPoint, sizeof(node.minPoint));
+    memcpy(node.maxPoint, nodeBox.maxPoint, sizeof(node.maxPoint));
+    if (count <= settings.minLeafSize) {
+      continue;
+    }
+
+    // SAH por bins en los 3 ejes: costo = recorrer + área relativa * triángulos de cada lado
+    const float nodeArea = std::max(halfArea(nodeBox.minPoint, nodeBox.maxPoint), 1e-30f);
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+      const float extent = cMax[axis] - cMin[axis];
+      if (!(extent > 0.0f)) {
+        continue;
+      }
+      const float scale = kBins / extent;
+      Bin bins[kBins];
+      for (unsigned int i = first; i < first + count; ++i) {
+        const unsigned int t = m_order[i];
+        const int b = std::min(static_cast<int>((centroid[t * 3 + axis] - cMin[axis]) * scale), kBins - 1);
+        bins[b].grow(&triMin[t * 3], &triMax[t * 3]);
+        ++bins[b].count;
+      }
+      float rightArea[kBins];
+      unsigned int rightCount[kBins];
+      Bin right;
+      unsigned int rightSum = 0;
+      for (int b = kBins - 1; b > 0; --b) {
+        right.grow(bins[b]);
+        rightSum += bins[b].count;
+        rightArea[b] = rightSum ? halfArea(right.minPoint, right.maxPoint) : 0.0f;
+        rightCount[b] = rightSum;
+      }
+      Bin left;
+      unsigned int leftSum = 0;
+      for (int split = 1; split < kBins; ++split) {
+        left.grow(bins[split - 1]);
+        leftSum += bins[split - 1].count;
+        if (leftSum == 0 || rightCount[split] == 0) {
+          continue;
+        }
+        const float cost = settings.traversalCost +
+          (halfArea(left.minPoint, left.maxPoint) * leftSum + rightArea[split] * rightCount[split]) / nodeArea;
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestSplit = split;
+        }
+      }
+    }
+
+    // Hoja si cortar no conviene (y cabe), o si no hay forma de separar los centroides
+    unsigned int middle;
+    if (bestAxis >= 0 && (bestCost < static_cast<float>(count) || count > settings.maxLeafSize)) {
+      const float scale = kBins / (cMax[bestAxis] - cMin[bestAxis]);
+      unsigned int* begin = &m_order[first];
+      unsigned int* split = std::partition(begin, begin + count, [&](unsigned int t) {
+        return std::min(static_cast<int>((centroid[t * 3 + bestAxis] - cMin[bestAxis]) * scale), kBins - 1) < bestSplit;
+      });
+      middle = first + static_cast<unsigned int>(split - begin);
+    }
+    else if (bestAxis < 0 && count > settings.maxLeafSize) {
+      // Todos los centroides en el mismo punto: corto a la mitad
+      bestAxis = 0;
+      middle = first + count / 2;
+    }
+    else {
+      continue;
+    }
+
+    const unsigned int children = static_cast<unsigned int>(m_nodes.size());
+    Node leftNode;
+    leftNode.first = first;
+    leftNode.count = middle - first;
+    Node rightNode;
+    rightNode.first = middle;
+    rightNode.count = first + count - middle;
+    m_nodes.push_back(leftNode);
+    m_nodes.push_back(rightNode);
+    m_nodes[nodeIndex].first = children;
+    m_nodes[nodeIndex].count = kInnerFlag | static_cast<unsigned int>(bestAxis);
+    stack.push_back(children + 1);
+    stack.push_back(children);
+  }
+  m_nodes.shrink_to_fit();
+
+  buildTriangles(positions, stride, indices);
+}
+
+void
+TriangleBVH::buildTriangles(const XMFLOAT3* positions, size_t stride, const unsigned int* indices) {
+  m_triangles.resize(m_order.size());
+  JobSystem::getInstance().parallelFor(m_order.size(), 4096, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const unsigned int t = m_order[i];
+      const XMFLOAT3& a = positionAt(positions, stride, indices[t * 3 + 0]);
+      const XMFLOAT3& b = positionAt(positions, stride, indices[t * 3 + 1]);
+      const XMFLOAT3& c = positionAt(positions, stride, indices[t * 3 + 2]);
+      Triangle& tri = m_triangles[i];
+      tri.v0[0] = a.x;       tri.v0[1] = a.y;       tri.v0[2] = a.z;
+      tri.e1[0] = b.x - a.x; tri.e1[1] = b.y - a.y; tri.e1[2] = b.z - a.z;
+      tri.e2[0] = c.x - a.x; tri.e2[1] = c.y - a.y; tri.e2[2] = c.z - a.z;
+    }
+  });
+}
+
+bool
+TriangleBVH::getBounds(XMFLOAT3& minPoint, XMFLOAT3& maxPoint) const {
+  if (m_nodes.empty()) {
+    return false;
+  }
+  minPoint = XMFLOAT3(m_nodes[0].minPoint[0], m_nodes[0].minPoint[1], m_nodes[0].minPoint[2]);
+  maxPoint = XMFLOAT3(m_nodes[0].maxPoint[0], m_nodes[0].maxPoint[1], m_nodes[0].maxPoint[2]);
+  return true;
+}
+
+bool
+TriangleBVH::traverse(const BVHRay& ray, BVHHit& hit, bool anyHit) const {
+  hit = BVHHit();
+  if (m_nodes.empty()) {
+    return false;
+  }
+  const float o[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+  const float d[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+  const float inv[3] = { safeInverse(d[0]), safeInverse(d[1]), safeInverse(d[2]) };
+  float best = ray.maxDistance;
+
+  unsigned int stack[kStackSize];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node& node = m_nodes[stack[--top]];
+    float tEnter = 0.0f;
+    float tExit = best;
+    for (int k = 0; k < 3; ++k) {
+      const float t1 = (node.minPoint[k] - o[k]) * inv[k];
+      const float t2 = (node.maxPoint[k] - o[k]) * inv[k];
+      tEnter = std::max(tEnter, std::min(t1, t2));
+      tExit = std::min(tExit, std::max(t1, t2));
+    }
+    if (tEnter > tExit) {
+      continue;
+    }
+
+    if (!(node.count & kInnerFlag)) {
+      for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+        const Triangle& tri = m_triangles[i];
+        float t, u, v;
+        if (intersectTriangle(tri.v0, tri.e1, tri.e2, o, d, best, t, u, v)) {
+          best = t;
+          hit.triangle = m_order[i];
+          hit.distance = t;
+          hit.u = u;
+          hit.v = v;
+          if (anyHit) {
+            return true;
+          }
+        }
+      }
+      continue;
+    }
+
+    // Primero el hijo del lado de donde viene el rayo
+    const unsigned int axis = node.count & 3u;
+    const unsigned int nearChild = node.first + (d[axis] < 0.0f ? 1u : 0u);
+    stack[top++] = node.first + node.first + 1u - nearChild;
+    stack[top++] = nearChild;
+  }
+  return hit.triangle != kInvalidTriangle;
+}
+
+bool
+TriangleBVH::intersect(const BVHRay& ray, BVHHit& hit) const {
+  return traverse(ray, hit, false);
+}
+
+bool
+TriangleBVH::occluded(const BVHRay& ray) const {
+  BVHHit hit;
+  return traverse(ray, hit, true);
+}
+
+template<int Groups>
+void
+TriangleBVH::traversePacket(const BVHRay* rays, BVHHit* hits, bool* occluded, bool anyHit) const {
+  const int numRays = Groups * 4;
+  if (m_nodes.empty()) {
+    for (int i = 0; i < numRays; ++i) {
+      if (hits) {
+        hits[i] = BVHHit();
+      }
+      if (occluded) {
+        occluded[i] = false;
+      }
+    }
+    return;
+  }
+
+  // SoA: grupo `g`, carril `l` es el rayo `g * 4 + l`
+  __m128 ox[Groups], oy[Groups], oz[Groups];
+  __m128 dx[Groups], dy[Groups], dz[Groups];
+  __m128 ix[Groups], iy[Groups], iz[Groups];
+  __m128 tMax[Groups], hitU[Groups], hitV[Groups], hitTri[Groups], alive[Groups];
+  for (int g = 0; g < Groups; ++g) {
+    const BVHRay* r = rays + g * 4;
+    ox[g] = _mm_setr_ps(r[0].origin.x, r[1].origin.x, r[2].origin.x, r[3].origin.x);
+    oy[g] = _mm_setr_ps(r[0].origin.y, r[1].origin.y, r[2].origin.y, r[3].origin.y);
+    oz[g] = _mm_setr_ps(r[0].origin.z, r[1].origin.z, r[2].origin.z, r[3].origin.z);
+    dx[g] = _mm_setr_ps(r[0].direction.x, r[1].direction.x, r[2].direction.x, r[3].direction.x);
+    dy[g] = _mm_setr_ps(r[0].direction.y, r[1].direction.y, r[2].direction.y, r[3].direction.y);
+    dz[g] = _mm_setr_ps(r[0].direction.z, r[1].direction.z, r[2].direction.z, r[3].direction.z);
+    ix[g] = _mm_setr_ps(safeInverse(r[0].direction.x), safeInverse(r[1].direction.x),
+                        safeInverse(r[2].direction.x), safeInverse(r[3].direction.x));
+    iy[g] = _mm_setr_ps(safeInverse(r[0].direction.y), safeInverse(r[1].direction.y),
+                        safeInverse(r[2].direction.y), safeInverse(r[3].direction.y));
+    iz[g] = _mm_setr_ps(safeInverse(r[0].direction.z), safeInverse(r[1].direction.z),
+                        safeInverse(r[2].direction.z), safeInverse(r[3].direction.z));
+    tMax[g] = _mm_setr_ps(r[0].maxDistance, r[1].maxDistance, r[2].maxDistance, r[3].maxDistance);
+    hitU[g] = _mm_setzero_ps();
+    hitV[g] = _mm_setzero_ps();
+    hitTri[g] = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    alive[g] = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  }
+  const float firstDir[3] = { rays[0].direction.x, rays[0].direction.y, rays[0].direction.z };
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  const __m128 detEpsilon = _mm_set1_ps(kDetEpsilon);
+
+  unsigned int stack[kStackSize];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node& node = m_nodes[stack[--top]];
+
+    // Caja contra los rayos vivos del paquete
+    __m128 boxMask[Groups];
+    int anyBox = 0;
+    const __m128 minX = _mm_set1_ps(node.minPoint[0]), maxX = _mm_set1_ps(node.maxPoint[0]);
+    const __m128 minY = _mm_set1_ps(node.minPoint[1]), maxY = _mm_set1_ps(node.maxPoint[1]);
+    const __m128 minZ = _mm_set1_ps(node.minPoint[2]), maxZ = _mm_set1_ps(node.maxPoint[2]);
+    for (int g = 0; g < Groups; ++g) {
+      __m128 t1 = _mm_mul_ps(_mm_sub_ps(minX, ox[g]), ix[g]);
+      __m128 t2 = _mm_mul_ps(_mm_sub_ps(maxX, ox[g]), ix[g]);
+      __m128 tEnter = _mm_max_ps(zero, _mm_min_ps(t1, t2));
+      __m128 tExit = _mm_min_ps(tMax[g], _mm_max_ps(t1, t2));
+      t1 = _mm_mul_ps(_mm_sub_ps(minY, oy[g]), iy[g]);
+      t2 = _mm_mul_ps(_mm_sub_ps(maxY, oy[g]), iy[g]);
+      tEnter = _mm_max_ps(tEnter, _mm_min_ps(t1, t2));
+      tExit = _mm_min_ps(tExit, _mm_max_ps(t1, t2));
+      t1 = _mm_mul_ps(_mm_sub_ps(minZ, oz[g]), iz[g]);
+      t2 = _mm_mul_ps(_mm_sub_ps(maxZ, oz[g]), iz[g]);
+      tEnter = _mm_max_ps(tEnter, _mm_min_ps(t1, t2));
+      tExit = _mm_min_ps(tExit, _mm_max_ps(t1, t2));
+      boxMask[g] = _mm_and_ps(alive[g], _mm_cmple_ps(tEnter, tExit));
+      anyBox |= _mm_movemask_ps(boxMask[g]);
+    }
+    if (!anyBox) {
+      continue;
+    }
+
+    if (node.count & kInnerFlag) {
+      const unsigned int axis = node.count & 3u;
+      const unsigned int nearChild = node.first + (firstDir[axis] < 0.0f ? 1u : 0u);
+      stack[top++] = node.first + node.first + 1u - nearChild;
+      stack[top++] = nearChild;
+      continue;
+    }
+
+    // Hoja: cada triángulo contra los 4 rayos de cada grupo que tocaron la caja
+    bool done = false;
+    for (unsigned int i = node.first; i < node.first + node.count && !done; ++i) {
+      const Triangle& tri = m_triangles[i];
+      const __m128 v0x = _mm_set1_ps(tri.v0[0]), v0y = _mm_set1_ps(tri.v0[1]), v0z = _mm_set1_ps(tri.v0[2]);
+      const __m128 e1x = _mm_set1_ps(tri.e1[0]), e1y = _mm_set1_ps(tri.e1[1]), e1z = _mm_set1_ps(tri.e1[2]);
+      const __m128 e2x = _mm_set1_ps(tri.e2[0]), e2y = _mm_set1_ps(tri.e2[1]), e2z = _mm_set1_ps(tri.e2[2]);
+      const __m128i triIndex = _mm_set1_epi32(static_cast<int>(m_order[i]));
+      for (int g = 0; g < Groups; ++g) {
+        const __m128 active = _mm_and_ps(boxMask[g], alive[g]);
+        if (!_mm_movemask_ps(active)) {
+          continue;
+        }
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy[g], e2z), _mm_mul_ps(dz[g], e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz[g], e2x), _mm_mul_ps(dx[g], e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx[g], e2y), _mm_mul_ps(dy[g], e2x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 inv = _mm_div_ps(one, det);
+        const __m128 tx = _mm_sub_ps(ox[g], v0x), ty = _mm_sub_ps(oy[g], v0y), tz = _mm_sub_ps(oz[g], v0z);
+        const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)),
+                                               _mm_mul_ps(tz, pz)), inv);
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+        const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx[g], qx), _mm_mul_ps(dy[g], qy)),
+                                               _mm_mul_ps(dz[g], qz)), inv);
+        const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)),
+                                               _mm_mul_ps(e2z, qz)), inv);
+        __m128 mask = _mm_and_ps(active, _mm_cmpge_ps(_mm_and_ps(det, absMask), detEpsilon));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, tMax[g])));
+        if (_mm_movemask_ps(mask)) {
+          tMax[g] = select(mask, t, tMax[g]);
+          hitU[g] = select(mask, u, hitU[g]);
+          hitV[g] = select(mask, v, hitV[g]);
+          hitTri[g] = select(mask, _mm_castsi128_ps(triIndex), hitTri[g]);
+          if (anyHit) {
+            alive[g] = _mm_andnot_ps(mask, alive[g]);
+          }
+        }
+      }
+      if (anyHit) {
+        int anyAlive = 0;
+        for (int g = 0; g < Groups; ++g) {
+          anyAlive |= _mm_movemask_ps(alive[g]);
+        }
+        done = anyAlive == 0;
+      }
+    }
+    if (done) {
+      break;
+    }
+  }
+
+  for (int g = 0; g < Groups; ++g) {
+    float t[4], u[4], v[4];
+    unsigned int tri[4];
+    _mm_storeu_ps(t, tMax[g]);
+    _mm_storeu_ps(u, hitU[g]);
+    _mm_storeu_ps(v, hitV[g]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tri), _mm_castps_si128(hitTri[g]));
+    for (int l = 0; l < 4; ++l) {
+      if (hits) {
+        BVHHit& hit = hits[g * 4 + l];
+        hit = BVHHit();
+        if (tri[l] != kInvalidTriangle) {
+          hit.triangle = tri[l];
+          hit.distance = t[l];
+          hit.u = u[l];
+          hit.v = v[l];
+        }
+      }
+      if (occluded) {
+        occluded[g * 4 + l] = tri[l] != kInvalidTriangle;
+      }
+    }
+  }
+}
+
+void
+TriangleBVH::intersect4(const BVHRay rays[4], BVHHit hits[4]) const {
+  traversePacket<1>(rays, hits, nullptr, false);
+}
+
+void
+TriangleBVH::intersect8(const BVHRay rays[8], BVHHit hits[8]) const {
+  traversePacket<2>(rays, hits, nullptr, false);
+}
+
+void
+TriangleBVH::occluded4(const BVHRay rays[4], bool occluded[4]) const {
+  traversePacket<1>(rays, nullptr, occluded, true);
+}
+
+void
+TriangleBVH::occluded8(const BVHRay rays[8], bool occluded[8]) const {
+  traversePacket<2>(rays, nullptr, occluded, true);
+}
+
+bool
+TriangleBVH::intersectReference(const BVHRay& ray, BVHHit& hit) const {
+  hit = BVHHit();
+  const float o[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+  const float d[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+  float best = ray.maxDistance;
+  for (size_t i = 0; i < m_triangles.size(); ++i) {
+    const Triangle& tri = m_triangles[i];
+    float t, u, v;
+    if (intersectTriangle(tri.v0, tri.e1, tri.e2, o, d, best, t, u, v)) {
+      best = t;
+      hit.triangle = m_order[i];
+      hit.distance = t;
+      hit.u = u;
+      hit.v = v;
+    }
+  }
+  return hit.triangle != kInvalidTriangle;
+}
+
+unsigned long long
+TriangleBVH::hashGeometry(const XMFLOAT3* positions,
+                          size_t numVertices,
+                          size_t stride,
+                          const unsigned int* indices,
+                          size_t numIndices) {
+  StateHasher hasher;
+  hasher.add(static_cast<unsigned long long>(numVertices));
+  hasher.add(static_cast<unsigned long long>(numIndices));
+  if (stride == sizeof(XMFLOAT3)) {
+    hasher.add(positions, numVertices * sizeof(XMFLOAT3));
+  }
+  else {
+    for (size_t i = 0; i < numVertices; ++i) {
+      hasher.add(positionAt(positions, stride, static_cast<unsigned int>(i)));
+    }
+  }
+  hasher.add(indices, numIndices * sizeof(unsigned int));
+  return hasher.getHash();
+}
+
+void
+TriangleBVH::serialize(std::vector<unsigned char>& out) const {
+  SectionHeader header;
+  header.geometryHash = m_geometryHash;
+  header.numNodes = static_cast<unsigned int>(m_nodes.size());
+  header.numTriangles = static_cast<unsigned int>(m_order.size());
+  const size_t nodeBytes = m_nodes.size() * sizeof(Node);
+  const size_t orderBytes = m_order.size() * sizeof(unsigned int);
+  const size_t start = out.size();
+  out.resize(start + sizeof(header) + nodeBytes + orderBytes);
+  memcpy(&out[start], &header, sizeof(header));
+  if (nodeBytes > 0) {
+    memcpy(&out[start + sizeof(header)], m_nodes.data(), nodeBytes);
+  }
+  if (orderBytes > 0) {
+    memcpy(&out[start + sizeof(header) + nodeBytes], m_order.data(), orderBytes);
+  }
+}
+
+bool
+TriangleBVH::deserialize(const MeshComponent& mesh, const unsigned char* data, size_t size) {
+  SectionHeader header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  const size_t nodeBytes = static_cast<size_t>(header.numNodes) * sizeof(Node);
+  const size_t orderBytes = static_cast<size_t>(header.numTriangles) * sizeof(unsigned int);
+  if (header.numTriangles != mesh.m_index.size() / 3 || size != sizeof(header) + nodeBytes + orderBytes ||
+      (header.numTriangles > 0 && header.numNodes == 0)) {
+    return false;
+  }
+  const XMFLOAT3* positions = mesh.m_vertex.empty() ? nullptr : &mesh.m_vertex[0].Pos;
+  const unsigned long long hash = hashGeometry(positions, mesh.m_vertex.size(), sizeof(SimpleVertex),
+                                               mesh.m_index.data(), mesh.m_index.size());
+  if (header.geometryHash != hash) {
+    return false;
+  }
+
+  // Armo todo en una BVH aparte: o entra la sección completa o no toco esta
+  TriangleBVH loaded;
+  loaded.m_geometryHash = hash;
+  loaded.m_nodes.resize(header.numNodes);
+  loaded.m_order.resize(header.numTriangles);
+  if (nodeBytes > 0) {
+    memcpy(loaded.m_nodes.data(), data + sizeof(header), nodeBytes);
+  }
+  if (orderBytes > 0) {
+    memcpy(loaded.m_order.data(), data + sizeof(header) + nodeBytes, orderBytes);
+  }
+  for (unsigned int t : loaded.m_order) {
+    if (t >= header.numTriangles) {
+      return false;
+    }
+  }
+  // Los hijos van después del padre y las hojas dentro del orden: el recorrido no se sale ni cicla
+  for (unsigned int n = 0; n < header.numNodes; ++n) {
+    const Node& node = loaded.m_nodes[n];
+    const bool valid = (node.count & kInnerFlag)
+      ? node.first > n && node.first < header.numNodes - 1
+      : node.first <= header.numTriangles && node.count <= header.numTriangles - node.first;
+    if (!valid) {
+      return false;
+    }
+  }
+  loaded.buildTriangles(positions, sizeof(SimpleVertex), mesh.m_index.data());
+  *this = std::move(loaded);
+  return true;
+}
+
+void
+TriangleBVH::runBenchmark(BenchmarkReport& report) {
+  // Terreno de ~1M triángulos con ondas en dos escalas
+  const unsigned int side = 708;
+  const float size = 1000.0f;
+  MeshComponent mesh;
+  mesh.m_vertex.resize(side * side);
+  for (unsigned int z = 0; z < side; ++z) {
+    for (unsigned int x = 0; x < side; ++x) {
+      const float px = (x / float(side - 1) - 0.5f) * size;
+      const float pz = (z / float(side - 1) - 0.5f) * size;
+      SimpleVertex& v = mesh.m_vertex[z * side + x];
+      v.Pos = XMFLOAT3(px, 20.0f * std::sin(px * 0.05f) * std::cos(pz * 0.043f) + 5.0f * std::sin(px * 0.31f + pz * 0.17f), pz);
+      v.Tex = XMFLOAT2(x / float(side - 1), z / float(side - 1));
+    }
+  }
+  mesh.m_index.reserve((side - 1) * (side - 1) * 6);
+  for (unsigned int z = 0; z + 1 < side; ++z) {
+    for (unsigned int x = 0; x + 1 < side; ++x) {
+      const unsigned int i = z * side + x;
+      const unsigned int quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+      mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+    }
+  }
+
+  Timer timer;
+  TriangleBVH bvh;
+  bvh.build(mesh.m_vertex, mesh.m_index);
+  const double buildMs = timer.elapsedMs();
+  unsigned int leaves = 0;
+  for (const Node& node : bvh.m_nodes) {
+    leaves += (node.count & kInnerFlag) ? 0 : 1;
+  }
+  report.log("%u triangles: build %.1f ms (%u nodes, %.2f triangles per leaf)",
+             bvh.getNumTriangles(), buildMs, bvh.getNumNodes(), bvh.getNumTriangles() / double(leaves));
+
+  // Serializada: ida y vuelta, y que un cambio en la malla la invalide
+  std::vector<unsigned char> section;
+  TriangleBVH cached;
+  timer.reset();
+  bvh.serialize(section);
+  const double saveMs = timer.elapsedMs();
+  timer.reset();
+  const bool loaded = cached.deserialize(mesh, section.data(), section.size());
+  const double loadMs = timer.elapsedMs();
+  if (!loaded || cached.m_nodes.size() != bvh.m_nodes.size() ||
+      memcmp(cached.m_nodes.data(), bvh.m_nodes.data(), bvh.m_nodes.size() * sizeof(Node)) != 0 ||
+      memcmp(cached.m_triangles.data(), bvh.m_triangles.data(), bvh.m_triangles.size() * sizeof(Triangle)) != 0) {
+    report.fail("serialized BVH round trip doesn't match the built tree");
+  }
+  if (cached.deserialize(mesh, section.data(), section.size() - 4)) {
+    report.fail("a truncated BVH section was accepted");
+  }
+  std::vector<unsigned char> corrupt = section;
+  Node root;
+  memcpy(&root, &corrupt[sizeof(SectionHeader)], sizeof(root));
+  root.first = 0;
+  memcpy(&corrupt[sizeof(SectionHeader)], &root, sizeof(root));
+  if (cached.deserialize(mesh, corrupt.data(), corrupt.size())) {
+    report.fail("a BVH section with a cycle was accepted");
+  }
+  MeshComponent modified = mesh;
+  modified.m_vertex[12345].Pos.y += 1.0f;
+  if (cached.deserialize(modified, section.data(), section.size())) {
+    report.fail("serialized BVH accepted a modified mesh");
+  }
+  report.log("serialized: save %.1f ms, load %.1f ms (%.1fx faster than building)", saveMs, loadMs, buildMs / loadMs);
+
+  // Rayos primarios de una cámara, en el orden de los paquetes (bloques de 4x2 píxeles)
+  const unsigned int width = 1024, height = 512;
+  std::vector<BVHRay> rays(width * height);
+  const XMFLOAT3 eye(0.0f, 150.0f, -650.0f);
+  const float tanHalf = std::tan(0.5f);
+  // Mirando hacia el centro: forward = normalize(-eye)
+  const float fLen = std::sqrt(eye.x * eye.x + eye.y * eye.y + eye.z * eye.z);
+  const float fw[3] = { -eye.x / fLen, -eye.y / fLen, -eye.z / fLen };
+  const float rt[3] = { 1.0f, 0.0f, 0.0f };
+  const float up[3] = { fw[1] * rt[2] - fw[2] * rt[1], fw[2] * rt[0] - fw[0] * rt[2], fw[0] * rt[1] - fw[1] * rt[0] };
+  size_t r = 0;
+  for (unsigned int by = 0; by < height; by += 2) {
+    for (unsigned int bx = 0; bx < width; bx += 4) {
+      for (unsigned int y = by; y < by + 2; ++y) {
+        for (unsigned int x = bx; x < bx + 4; ++x) {
+          const float sx = ((x + 0.5f) / width * 2.0f - 1.0f) * tanHalf * (width / float(height));
+          const float sy = (1.0f - (y + 0.5f) / height * 2.0f) * tanHalf;
+          float d[3];
+          for (int k = 0; k < 3; ++k) {
+            d[k] = fw[k] + rt[k] * sx - up[k] * sy;
+          }
+          const float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+          BVHRay& ray = rays[r++];
+          ray.origin = eye;
+          ray.direction = XMFLOAT3(d[0] / len, d[1] / len, d[2] / len);
+          ray.maxDistance = 5000.0f;
+        }
+      }
+    }
+  }
+
+  JobSystem& jobs = JobSystem::getInstance();
+  const size_t numRays = rays.size();
+  std::vector<BVHHit> single(numRays), packet4(numRays), packet8(numRays);
+  timer.reset();
+  jobs.parallelFor(numRays, 1024, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      bvh.intersect(rays[i], single[i]);
+    }
+  });
+  const double singleMs = timer.elapsedMs();
+  timer.reset();
+  jobs.parallelFor(numRays / 4, 256, [&](size_t begin, size_t end) {
+    for (size_t p = begin; p < end; ++p) {
+      bvh.intersect4(&rays[p * 4], &packet4[p * 4]);
+    }
+  });
+  const double packet4Ms = timer.elapsedMs();
+  timer.reset();
+  jobs.parallelFor(numRays / 8, 128, [&](size_t begin, size_t end) {
+    for (size_t p = begin; p < end; ++p) {
+      bvh.intersect8(&rays[p * 8], &packet8[p * 8]);
+    }
+  });
+  const double packet8Ms = timer.elapsedMs();
+
+  unsigned int hitCount = 0;
+  for (size_t i = 0; i < numRays; ++i) {
+    hitCount += single[i].triangle != kInvalidTriangle ? 1 : 0;
+    if (packet4[i].triangle != single[i].triangle || packet4[i].distance != single[i].distance ||
+        packet8[i].triangle != single[i].triangle || packet8[i].distance != single[i].distance) {
+      report.fail("packet closest-hit differs from single ray " + std::to_string(i));
+      break;
+    }
+  }
+  report.log("closest-hit, %zu primary rays (%u hits), %u threads:", numRays, hitCount, jobs.getNumThreads());
+  report.log("  single %.1f ms (%.2f Mrays/s), 4-wide %.1f ms (%.2f Mrays/s), 8-wide %.1f ms (%.2f Mrays/s)",
+             singleMs, numRays / (singleMs * 1000.0), packet4Ms, numRays / (packet4Ms * 1000.0),
+             packet8Ms, numRays / (packet8Ms * 1000.0));
+
+  // Rayos de sombra desde cada impacto hacia el sol (any-hit)
+  std::vector<BVHRay> shadowRays(numRays);
+  const float sun[3] = { 0.45f, 0.35f, 0.82f };
+  const float sunLen = std::sqrt(sun[0] * sun[0] + sun[1] * sun[1] + sun[2] * sun[2]);
+  for (size_t i = 0; i < numRays; ++i) {
+    const float t = single[i].triangle != kInvalidTriangle ? single[i].distance : 0.0f;
+    BVHRay& ray = shadowRays[i];
+    ray.origin = XMFLOAT3(rays[i].origin.x + rays[i].direction.x * t,
+                          rays[i].origin.y + rays[i].direction.y * t + 0.01f,
+                          rays[i].origin.z + rays[i].direction.z * t);
+    ray.direction = XMFLOAT3(sun[0] / sunLen, sun[1] / sunLen, sun[2] / sunLen);
+    ray.maxDistance = 2000.0f;
+  }
+  std::vector<uint8_t> shadowSingle(numRays);
+  timer.reset();
+  jobs.parallelFor(numRays, 1024, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      shadowSingle[i] = bvh.occluded(shadowRays[i]) ? 1 : 0;
+    }
+  });
+  const double shadowSingleMs = timer.elapsedMs();
+  std::unique_ptr<bool[]> shadow8(new bool[numRays]);
+  timer.reset();
+  jobs.parallelFor(numRays / 8, 128, [&](size_t begin, size_t end) {
+    for (size_t p = begin; p < end; ++p) {
+      bvh.occluded8(&shadowRays[p * 8], &shadow8[p * 8]);
+    }
+  });
+  const double shadow8Ms = timer.elapsedMs();
+  unsigned int shadowed = 0;
+  for (size_t i = 0; i < numRays; ++i) {
+    shadowed += shadowSingle[i];
+    if ((shadowSingle[i] != 0) != shadow8[i]) {
+      report.fail("packet any-hit differs from single ray " + std::to_string(i));
+      break;
+    }
+  }
+  report.log("any-hit, %zu shadow rays (%u occluded): single %.1f ms (%.2f Mrays/s), 8-wide %.1f ms (%.2f Mrays/s)",
+             numRays, shadowed, shadowSingleMs, numRays / (shadowSingleMs * 1000.0),
+             shadow8Ms, numRays / (shadow8Ms * 1000.0));
+
+  // Fuerza bruta con rayos en direcciones cualesquiera
+  unsigned int seed = 0x9E3779B9u;
+  auto nextFloat = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+  };
+  const unsigned int numChecks = 96;
+  unsigned int checkHits = 0;
+  for (unsigned int i = 0; i < numChecks; ++i) {
+    BVHRay ray;
+    ray.origin = XMFLOAT3((nextFloat() - 0.5f) * size, 40.0f + nextFloat() * 100.0f, (nextFloat() - 0.5f) * size);
+    float d[3] = { nextFloat() - 0.5f, -nextFloat(), nextFloat() - 0.5f };
+    const float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    ray.direction = XMFLOAT3(d[0] / len, d[1] / len, d[2] / len);
+    BVHHit fast, reference;
+    const bool hitFast = bvh.intersect(ray, fast);
+    const bool hitReference = bvh.intersectReference(ray, reference);
+    checkHits += hitReference ? 1 : 0;
+    // En una arista compartida cualquiera de los dos triángulos vale
+    if (hitFast != hitReference || bvh.occluded(ray) != hitReference ||
+        (hitFast && std::fabs(fast.distance - reference.distance) > 1e-4f * reference.distance)) {
+      report.fail("BVH ray " + std::to_string(i) + " doesn't match brute force");
+      break;
+    }
+  }
+  report.log("verify: %u random rays (%u hits) match brute force", numChecks, checkHits);
+}
@@ -0,0 +1,699 @@
+#include "Culling/SoftwareOcclusion.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+  /// @brief Máximo de vértices tras recortar un triángulo contra el plano cercano.
+  const unsigned int kMaxClippedVertices = 4;
+
+  inline void
+    multiply(const XMFLOAT4X4& a, const XMFLOAT4X4& b, XMFLOAT4X4& out) {
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] +
+                      a.m[r][2] * b.m[2][c] + a.m[r][3] * b.m[3][c];
+      }
+    }
+  }
+
+  inline float
+    horizontalMin(__m128 v) {
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+  }
+
+  inline float
+    horizontalMax(__m128 v) {
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(v);
+  }
+
+  inline XMFLOAT4
+    lerpClip(const XMFLOAT4& a, const XMFLOAT4& b, float t) {
+    return XMFLOAT4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                    a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+  }
+
+} // namespace
+
+void
+SoftwareOcclusion::setSettings(const SoftwareOcclusionSettings& settings) {
+  m_settings = settings;
+  m_settings.width = std::max(m_settings.width, 4u);
+  m_settings.height = std::max(m_settings.height, 1u);
+  m_settings.tileWidth = std::max((m_settings.tileWidth + 3) & ~3u, 4u);
+  m_settings.tileHeight = std::max(m_settings.tileHeight, 1u);
+
+  m_stride = (m_settings.width + 3) & ~3u;
+  m_tilesX = (m_settings.width + m_settings.tileWidth - 1) / m_settings.tileWidth;
+  m_tilesY = (m_settings.height + m_settings.tileHeight - 1) / m_settings.tileHeight;
+  m_depth.assign(m_stride * m_settings.height, 1.0f);
+  m_bins.assign(m_tilesX * m_tilesY, std::vector<unsigned int>());
+
+  // Niveles 1..N hasta llegar a 1x1
+  m_levelOffset.clear();
+  m_levelWidth.assign(1, m_settings.width);
+  m_levelHeight.assign(1, m_settings.height);
+  m_levelOffset.push_back(0);
+  unsigned int total = 0;
+  while (m_levelWidth.back() > 1 || m_levelHeight.back() > 1) {
+    unsigned int w = (m_levelWidth.back() + 1) / 2;
+    unsigned int h = (m_levelHeight.back() + 1) / 2;
+    m_levelOffset.push_back(total);
+    m_levelWidth.push_back(w);
+    m_levelHeight.push_back(h);
+    total += w * h;
+  }
+  m_hierarchy.assign(total, 1.0f);
+}
+
+void
+SoftwareOcclusion::beginFrame(const XMFLOAT4X4& viewProjection) {
+  if (m_depth.empty()) {
+    setSettings(m_settings);
+  }
+  m_viewProjection = viewProjection;
+  m_frustum.setViewProjection(viewProjection);
+  std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+  std::fill(m_hierarchy.begin(), m_hierarchy.end(), 1.0f);
+  m_stats = SoftwareOcclusionStats();
+}
+
+unsigned int
+SoftwareOcclusion::setupTriangle(const XMFLOAT4& a,
+                                 const XMFLOAT4& b,
+                                 const XMFLOAT4& c,
+                                 RasterTriangle* output) const {
+  // Todo el triángulo fuera del mismo plano del frustum
+  if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+      (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+      (a.z > a.w && b.z > b.w && c.z > c.w) || (a.z < 0.0f && b.z < 0.0f && c.z < 0.0f)) {
+    return 0;
+  }
+
+  // Recorto contra z >= 0 (el plano cercano en D3D)
+  XMFLOAT4 polygon[kMaxClippedVertices];
+  unsigned int count = 0;
+  const XMFLOAT4* input[3] = { &a, &b, &c };
+  for (int i = 0; i < 3; ++i) {
+    const XMFLOAT4& p = *input[i];
+    const XMFLOAT4& q = *input[(i + 1) % 3];
+    if (p.z >= 0.0f) {
+      polygon[count++] = p;
+    }
+    if ((p.z >= 0.0f) != (q.z >= 0.0f)) {
+      polygon[count++] = lerpClip(p, q, p.z / (p.z - q.z));
+    }
+  }
+
+  const float width = static_cast<float>(m_settings.width);
+  const float height = static_cast<float>(m_settings.height);
+  float sx[kMaxClippedVertices];
+  float sy[kMaxClippedVertices];
+  float sz[kMaxClippedVertices];
+  for (unsigned int i = 0; i < count; ++i) {
+    if (polygon[i].w <= 1e-6f) {
+      return 0;
+    }
+    float invW = 1.0f / polygon[i].w;
+    sx[i] = (polygon[i].x * invW * 0.5f + 0.5f) * width;
+    sy[i] = (0.5f - polygon[i].y * invW * 0.5f) * height;
+    sz[i] = polygon[i].z * invW;
+  }
+
+  unsigned int written = 0;
+  for (unsigned int i = 1; i + 1 < count; ++i) {
+    const unsigned int v[3] = { 0, i, i + 1 };
+    float x0 = sx[v[0]], y0 = sy[v[0]];
+    float x1 = sx[v[1]], y1 = sy[v[1]];
+    float x2 = sx[v[2]], y2 = sy[v[2]];
+
+    // Con y hacia abajo, los frontales en sentido horario tienen área positiva
+    float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (!(area > 0.0f)) {
+      continue;
+    }
+
+    RasterTriangle& t = output[written];
+    t.minX = static_cast<int>(std::ceil(std::max(std::min(std::min(x0, x1), x2) - 0.5f, 0.0f)));
+    t.minY = static_cast<int>(std::ceil(std::max(std::min(std::min(y0, y1), y2) - 0.5f, 0.0f)));
+    t.maxX = static_cast<int>(std::floor(std::min(std::max(std::max(x0, x1), x2) - 0.5f, width - 1.0f)));
+    t.maxY = static_cast<int>(std::floor(std::min(std::max(std::max(y0, y1), y2) - 0.5f, height - 1.0f)));
+    if (t.minX > t.maxX || t.minY > t.maxY) {
+      continue;
+    }
+
+    // Arista i va del vértice i al siguiente; dentro del triángulo las tres son >= 0
+    const float ex[3] = { x0, x1, x2 };
+    const float ey[3] = { y0, y1, y2 };
+    for (int e = 0; e < 3; ++e) {
+      int n = (e + 1) % 3;
+      t.edgeA[e] = ey[e] - ey[n];
+      t.edgeB[e] = ex[n] - ex[e];
+      t.edgeC[e] = -(t.edgeA[e] * ex[e] + t.edgeB[e] * ey[e]);
+    }
+
+    // Baricéntricas: el vértice k pesa la arista opuesta (k + 1) / área
+    float invArea = 1.0f / area;
+    float z0 = sz[v[0]], z1 = sz[v[1]], z2 = sz[v[2]];
+    t.zA = (z0 * t.edgeA[1] + z1 * t.edgeA[2] + z2 * t.edgeA[0]) * invArea;
+    t.zB = (z0 * t.edgeB[1] + z1 * t.edgeB[2] + z2 * t.edgeB[0]) * invArea;
+    t.zC = (z0 * t.edgeC[1] + z1 * t.edgeC[2] + z2 * t.edgeC[0]) * invArea;
+    t.valid = true;
+    ++written;
+  }
+  return written;
+}
+
+void
+SoftwareOcclusion::setupOccluder(const OccluderInstance& occluder,
+                                 std::vector<XMFLOAT4>& clip,
+                                 RasterTriangle* output) const {
+  const OcclusionMesh& mesh = *occluder.mesh;
+  XMFLOAT4X4 m;
+  multiply(occluder.world, m_viewProjection, m);
+
+  // clip = x * fila0 + y * fila1 + z * fila2 + fila3
+  const __m128 row0 = _mm_loadu_ps(m.m[0]);
+  const __m128 row1 = _mm_loadu_ps(m.m[1]);
+  const __m128 row2 = _mm_loadu_ps(m.m[2]);
+  const __m128 row3 = _mm_loadu_ps(m.m[3]);
+  clip.resize(mesh.vertices.size());
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    const XMFLOAT3& p = mesh.vertices[i];
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), row0),
+                                     _mm_mul_ps(_mm_set1_ps(p.y), row1)),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), row2), row3));
+    _mm_storeu_ps(&clip[i].x, r);
+  }
+
+  const size_t numTriangles = mesh.indices.size() / 3;
+  for (size_t i = 0; i < numTriangles; ++i) {
+    RasterTriangle* slot = output + i * 2;
+    slot[0].valid = false;
+    slot[1].valid = false;
+    setupTriangle(clip[mesh.indices[i * 3]], clip[mesh.indices[i * 3 + 1]],
+                  clip[mesh.indices[i * 3 + 2]], slot);
+  }
+}
+
+void
+SoftwareOcclusion::setupAll(const std::vector<OccluderInstance>& occluders) {
+  Timer timer;
+  // Cada occluder tiene su rango fijo de salida, así que los hilos no se pisan
+  m_triangleOffset.resize(occluders.size() + 1);
+  unsigned int total = 0;
+  for (size_t i = 0; i < occluders.size(); ++i) {
+    m_triangleOffset[i] = total;
+    if (occluders[i].mesh) {
+      total += static_cast<unsigned int>(occluders[i].mesh->indices.size() / 3) * 2;
+    }
+  }
+  m_triangleOffset[occluders.size()] = total;
+  m_triangles.resize(total);
+
+  JobSystem::getInstance().parallelFor(occluders.size(), 4, [&](size_t begin, size_t end) {
+    std::vector<XMFLOAT4> clip;
+    for (size_t i = begin; i < end; ++i) {
+      if (occluders[i].mesh) {
+        setupOccluder(occluders[i], clip, &m_triangles[m_triangleOffset[i]]);
+      }
+    }
+  });
+
+  m_stats.occluders = static_cast<unsigned int>(occluders.size());
+  m_stats.triangles = total / 2;
+  for (const RasterTriangle& t : m_triangles) {
+    m_stats.rasterizedTriangles += t.valid ? 1 : 0;
+  }
+  m_stats.setupMs = timer.elapsedMs();
+}
+
+void
+SoftwareOcclusion::rasterizeTile(unsigned int tile) {
+  const int tileX0 = static_cast<int>((tile % m_tilesX) * m_settings.tileWidth);
+  const int tileY0 = static_cast<int>((tile / m_tilesX) * m_settings.tileHeight);
+  const int tileX1 = std::min(tileX0 + static_cast<int>(m_settings.tileWidth), static_cast<int>(m_settings.width)) - 1;
+  const int tileY1 = std::min(tileY0 + static_cast<int>(m_settings.tileHeight), static_cast<int>(m_settings.height)) - 1;
+
+  const __m128 laneOffset = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 zero = _mm_setzero_ps();
+
+  for (unsigned int index : m_bins[tile]) {
+    const RasterTriangle& t = m_triangles[index];
+    const int minX = std::max(t.minX, tileX0);
+    const int maxX = std::min(t.maxX, tileX1);
+    const int minY = std::max(t.minY, tileY0);
+    const int maxY = std::min(t.maxY, tileY1);
+
+    // El tile empieza en múltiplo de 4, así que el bloque alineado no se sale de él
+    const int startX = minX & ~3;
+    const __m128 boxMin = _mm_set1_ps(static_cast<float>(minX));
+    const __m128 boxMax = _mm_set1_ps(static_cast<float>(maxX));
+    const __m128 a0 = _mm_set1_ps(t.edgeA[0]);
+    const __m128 a1 = _mm_set1_ps(t.edgeA[1]);
+    const __m128 a2 = _mm_set1_ps(t.edgeA[2]);
+    const __m128 za = _mm_set1_ps(t.zA);
+
+    for (int y = minY; y <= maxY; ++y) {
+      const float py = static_cast<float>(y) + 0.5f;
+      const __m128 row0 = _mm_set1_ps(t.edgeB[0] * py + t.edgeC[0]);
+      const __m128 row1 = _mm_set1_ps(t.edgeB[1] * py + t.edgeC[1]);
+      const __m128 row2 = _mm_set1_ps(t.edgeB[2] * py + t.edgeC[2]);
+      const __m128 rowZ = _mm_set1_ps(t.zB * py + t.zC);
+      float* line = &m_depth[y * m_stride];
+
+      for (int x = startX; x <= maxX; x += 4) {
+        const __m128 lane = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset);
+        const __m128 px = _mm_add_ps(lane, half);
+        __m128 mask = _mm_and_ps(_mm_cmpge_ps(lane, boxMin), _mm_cmple_ps(lane, boxMax));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), row0), zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), row1), zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), row2), zero));
+        if (_mm_movemask_ps(mask) == 0) {
+          continue;
+        }
+        const __m128 z = _mm_add_ps(_mm_mul_ps(za, px), rowZ);
+        const __m128 depth = _mm_loadu_ps(line + x);
+        const __m128 closer = _mm_min_ps(depth, z);
+        _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(mask, closer), _mm_andnot_ps(mask, depth)));
+      }
+    }
+  }
+}
+
+void
+SoftwareOcclusion::buildHierarchy() {
+  Timer timer;
+  for (size_t level = 1; level < m_levelWidth.size(); ++level) {
+    const unsigned int srcWidth = m_levelWidth[level - 1];
+    const unsigned int srcHeight = m_levelHeight[level - 1];
+    const float* src = level == 1 ? m_depth.data() : &m_hierarchy[m_levelOffset[level - 1]];
+    const unsigned int srcStride = level == 1 ? m_stride : srcWidth;
+    float* dst = &m_hierarchy[m_levelOffset[level]];
+
+    for (unsigned int y = 0; y < m_levelHeight[level]; ++y) {
+      const unsigned int y0 = y * 2;
+      const unsigned int y1 = std::min(y0 + 1, srcHeight - 1);
+      for (unsigned int x = 0; x < m_levelWidth[level]; ++x) {
+        const unsigned int x0 = x * 2;
+        const unsigned int x1 = std::min(x0 + 1, srcWidth - 1);
+        dst[y * m_levelWidth[level] + x] =
+          std::max(std::max(src[y0 * srcStride + x0], src[y0 * srcStride + x1]),
+                   std::max(src[y1 * srcStride + x0], src[y1 * srcStride + x1]));
+      }
+    }
+  }
+  m_stats.hierarchyMs = timer.elapsedMs();
+}
+
+void
+SoftwareOcclusion::rasterize(const std::vector<OccluderInstance>& occluders) {
+  setupAll(occluders);
+
+  Timer timer;
+  for (std::vector<unsigned int>& bin : m_bins) {
+    bin.clear();
+  }
+  for (unsigned int i = 0; i < m_triangles.size(); ++i) {
+    const RasterTriangle& t = m_triangles[i];
+    if (!t.valid) {
+      continue;
+    }
+    const unsigned int tx0 = t.minX / m_settings.tileWidth;
+    const unsigned int tx1 = t.maxX / m_settings.tileWidth;
+    const unsigned int ty0 = t.minY / m_settings.tileHeight;
+    const unsigned int ty1 = t.maxY / m_settings.tileHeight;
+    for (unsigned int ty = ty0; ty <= ty1; ++ty) {
+      for (unsigned int tx = tx0; tx <= tx1; ++tx) {
+        m_bins[ty * m_tilesX + tx].push_back(i);
+      }
+    }
+    m_stats.binnedTriangles += (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+  }
+
+  JobSystem::getInstance().parallelFor(m_bins.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t tile = begin; tile < end; ++tile) {
+      rasterizeTile(static_cast<unsigned int>(tile));
+    }
+  });
+  m_stats.rasterMs = timer.elapsedMs();
+
+  buildHierarchy();
+}
+
+void
+SoftwareOcclusion::rasterizeReference(const std::vector<OccluderInstance>& occluders) {
+  setupAll(occluders);
+
+  Timer timer;
+  for (const RasterTriangle& t : m_triangles) {
+    if (!t.valid) {
+      continue;
+    }
+    for (int y = t.minY; y <= t.maxY; ++y) {
+      const float py = static_cast<float>(y) + 0.5f;
+      const float row0 = t.edgeB[0] * py + t.edgeC[0];
+      const float row1 = t.edgeB[1] * py + t.edgeC[1];
+      const float row2 = t.edgeB[2] * py + t.edgeC[2];
+      const float rowZ = t.zB * py + t.zC;
+      for (int x = t.minX; x <= t.maxX; ++x) {
+        const float px = static_cast<float>(x) + 0.5f;
+        if (t.edgeA[0] * px + row0 >= 0.0f &&
+            t.edgeA[1] * px + row1 >= 0.0f &&
+            t.edgeA[2] * px + row2 >= 0.0f) {
+          float& depth = m_depth[y * m_stride + x];
+          depth = std::min(depth, t.zA * px + rowZ);
+        }
+      }
+    }
+  }
+  m_stats.rasterMs = timer.elapsedMs();
+
+  buildHierarchy();
+}
+
+bool
+SoftwareOcclusion::projectBounds(const OcclusionBounds& bounds,
+                                 int& minX, int& minY, int& maxX, int& maxY,
+                                 float& minZ) const {
+  const XMFLOAT4X4& m = m_viewProjection;
+  // Las 8 esquinas en dos grupos de 4 (cara z mínima y cara z máxima)
+  const __m128 xs = _mm_setr_ps(bounds.minPoint.x, bounds.maxPoint.x, bounds.minPoint.x, bounds.maxPoint.x);
+  const __m128 ys = _mm_setr_ps(bounds.minPoint.y, bounds.minPoint.y, bounds.maxPoint.y, bounds.maxPoint.y);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 width = _mm_set1_ps(static_cast<float>(m_settings.width));
+  const __m128 height = _mm_set1_ps(static_cast<float>(m_settings.height));
+
+  __m128 sxMin = _mm_set1_ps(FLT_MAX), sxMax = _mm_set1_ps(-FLT_MAX);
+  __m128 syMin = _mm_set1_ps(FLT_MAX), syMax = _mm_set1_ps(-FLT_MAX);
+  __m128 szMin = _mm_set1_ps(FLT_MAX);
+  __m128 behind = _mm_setzero_ps();
+  for (int face = 0; face < 2; ++face) {
+    const __m128 zs = _mm_set1_ps(face == 0 ? bounds.minPoint.z : bounds.maxPoint.z);
+    __m128 clip[4];
+    for (int c = 0; c < 4; ++c) {
+      clip[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, _mm_set1_ps(m.m[0][c])),
+                                      _mm_mul_ps(ys, _mm_set1_ps(m.m[1][c]))),
+                           _mm_add_ps(_mm_mul_ps(zs, _mm_set1_ps(m.m[2][c])),
+                                      _mm_set1_ps(m.m[3][c])));
+    }
+    behind = _mm_or_ps(behind, _mm_cmplt_ps(clip[2], _mm_setzero_ps()));
+    const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), clip[3]);
+    const __m128 sx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[0], invW), half), half), width);
+    const __m128 sy = _mm_mul_ps(_mm_sub_ps(half, _mm_mul_ps(_mm_mul_ps(clip[1], invW), half)), height);
+    sxMin = _mm_min_ps(sxMin, sx);
+    sxMax = _mm_max_ps(sxMax, sx);
+    syMin = _mm_min_ps(syMin, sy);
+    syMax = _mm_max_ps(syMax, sy);
+    szMin = _mm_min_ps(szMin, _mm_mul_ps(clip[2], invW));
+  }
+  if (_mm_movemask_ps(behind) != 0) {
+    return false;
+  }
+
+  // Píxeles que toca el rectángulo, recortados a la pantalla
+  const float w = static_cast<float>(m_settings.width);
+  const float h = static_cast<float>(m_settings.height);
+  minX = static_cast<int>(std::floor(std::max(horizontalMin(sxMin), -1.0f)));
+  minY = static_cast<int>(std::floor(std::max(horizontalMin(syMin), -1.0f)));
+  maxX = static_cast<int>(std::floor(std::min(horizontalMax(sxMax), w)));
+  maxY = static_cast<int>(std::floor(std::min(horizontalMax(syMax), h)));
+  minX = std::max(minX, 0);
+  minY = std::max(minY, 0);
+  maxX = std::min(maxX, static_cast<int>(m_settings.width) - 1);
+  maxY = std::min(maxY, static_cast<int>(m_settings.height) - 1);
+  minZ = horizontalMin(szMin);
+  return true;
+}
+
+SoftwareOcclusion::OcclusionResult
+SoftwareOcclusion::classify(const OcclusionBounds& bounds) const {
+  const float minPoint[3] = { bounds.minPoint.x, bounds.minPoint.y, bounds.minPoint.z };
+  const float maxPoint[3] = { bounds.maxPoint.x, bounds.maxPoint.y, bounds.maxPoint.z };
+  if (!m_frustum.intersectsAabb(minPoint, maxPoint)) {
+    return OUTSIDE_FRUSTUM;
+  }
+
+  int minX, minY, maxX, maxY;
+  float minZ;
+  if (!projectBounds(bounds, minX, minY, maxX, maxY, minZ)) {
+    return VISIBLE;
+  }
+  if (minX > maxX || minY > maxY) {
+    return OUTSIDE_FRUSTUM;
+  }
+
+  // Nivel en el que el rectángulo cubre como mucho 4x4 texels
+  unsigned int level = 0;
+  while (level + 1 < m_levelWidth.size() &&
+         (((maxX >> level) - (minX >> level)) > 3 || ((maxY >> level) - (minY >> level)) > 3)) {
+    ++level;
+  }
+  const float* texels = level == 0 ? m_depth.data() : &m_hierarchy[m_levelOffset[level]];
+  const unsigned int stride = level == 0 ? m_stride : m_levelWidth[level];
+  for (int y = minY >> level; y <= (maxY >> level); ++y) {
+    for (int x = minX >> level; x <= (maxX >> level); ++x) {
+      if (texels[y * stride + x] >= minZ) {
+        return VISIBLE;
+      }
+    }
+  }
+  return OCCLUDED;
+}
+
+bool
+SoftwareOcclusion::isVisible(const OcclusionBounds& bounds) const {
+  return classify(bounds) == VISIBLE;
+}
+
+void
+SoftwareOcclusion::testBounds(const std::vector<OcclusionBounds>& bounds, std::vector<uint8_t>& visible) {
+  Timer timer;
+  m_results.resize(bounds.size());
+  visible.resize(bounds.size());
+  JobSystem::getInstance().parallelFor(bounds.size(), 256, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      OcclusionResult result = classify(bounds[i]);
+      m_results[i] = static_cast<uint8_t>(result);
+      visible[i] = result == VISIBLE ? 1 : 0;
+    }
+  });
+
+  m_stats.tested += static_cast<unsigned int>(bounds.size());
+  for (uint8_t result : m_results) {
+    m_stats.frustumCulled += result == OUTSIDE_FRUSTUM ? 1 : 0;
+    m_stats.occluded += result == OCCLUDED ? 1 : 0;
+  }
+  m_stats.testMs += timer.elapsedMs();
+}
+
+bool
+SoftwareOcclusion::isOccludedReference(const OcclusionBounds& bounds) const {
+  int minX, minY, maxX, maxY;
+  float minZ;
+  if (!projectBounds(bounds, minX, minY, maxX, maxY, minZ) || minX > maxX || minY > maxY) {
+    return false;
+  }
+  for (int y = minY; y <= maxY; ++y) {
+    for (int x = minX; x <= maxX; ++x) {
+      if (m_depth[y * m_stride + x] >= minZ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void
+SoftwareOcclusion::runBenchmark(BenchmarkReport& report) {
+  const unsigned int blocks = 24;
+  const float blockSize = 30.0f;
+  const float streetWidth = 12.0f;
+  const unsigned int propsPerBlock = 32;
+  const unsigned int roofUnitsPerBlock = 4;
+  const float fovY = XM_PIDIV4;
+  const float aspect = 16.0f / 9.0f;
+  const int numFrames = 120;
+  const int verifyEvery = 10;
+
+  unsigned int seed = 4242u;
+  auto random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / 16777216.0f;
+  };
+
+  // Caja unitaria centrada en el origen con caras en sentido horario vistas desde fuera
+  OcclusionMesh box;
+  for (int i = 0; i < 8; ++i) {
+    box.vertices.push_back(XMFLOAT3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+  }
+  const unsigned int faces[6][4] = {
+    { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, // -z, +z
+    { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, // -x, +x
+    { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, // -y, +y
+  };
+  for (const auto& f : faces) {
+    const unsigned int quad[6] = { f[0], f[1], f[2], f[0], f[2], f[3] };
+    box.indices.insert(box.indices.end(), quad, quad + 6);
+  }
+
+  auto boxWorld = [](float cx, float cy, float cz, float sx, float sy, float sz) {
+    XMFLOAT4X4 world;
+    std::memset(&world, 0, sizeof(world));
+    world._11 = sx;
+    world._22 = sy;
+    world._33 = sz;
+    world._41 = cx;
+    world._42 = cy;
+    world._43 = cz;
+    world._44 = 1.0f;
+    return world;
+  };
+  auto boxBounds = [](float cx, float cy, float cz, float sx, float sy, float sz) {
+    OcclusionBounds b;
+    b.minPoint = XMFLOAT3(cx - sx * 0.5f, cy - sy * 0.5f, cz - sz * 0.5f);
+    b.maxPoint = XMFLOAT3(cx + sx * 0.5f, cy + sy * 0.5f, cz + sz * 0.5f);
+    return b;
+  };
+
+  // Edificios (occluder un poco más chico que su caja) y props en banquetas y azoteas
+  std::vector<OccluderInstance> occluders;
+  std::vector<OcclusionBounds> bounds;
+  const float pitch = blockSize + streetWidth;
+  const float half = blocks * pitch * 0.5f;
+  for (unsigned int bz = 0; bz < blocks; ++bz) {
+    for (unsigned int bx = 0; bx < blocks; ++bx) {
+      float cx = bx * pitch - half + pitch * 0.5f;
+      float cz = bz * pitch - half + pitch * 0.5f;
+      float height = 10.0f + random() * 50.0f;
+
+      OccluderInstance occluder;
+      occluder.mesh = &box;
+      occluder.world = boxWorld(cx, height * 0.5f, cz, blockSize * 0.95f, height * 0.95f, blockSize * 0.95f);
+      occluders.push_back(occluder);
+      bounds.push_back(boxBounds(cx, height * 0.5f, cz, blockSize, height, blockSize));
+
+      for (unsigned int p = 0; p < propsPerBlock; ++p) {
+        // Alrededor de la manzana, en la banqueta
+        float side = std::floor(random() * 4.0f);
+        float along = (random() - 0.5f) * blockSize;
+        float offset = blockSize * 0.5f + 1.0f + random() * 2.0f;
+        float px = cx + (side == 0.0f ? along : side == 1.0f ? offset : side == 2.0f ? along : -offset);
+        float pz = cz + (side == 0.0f ? offset : side == 1.0f ? along : side == 2.0f ? -offset : along);
+        float size = 0.5f + random() * 2.0f;
+        bounds.push_back(boxBounds(px, size * 0.5f, pz, size, size, size));
+      }
+      for (unsigned int r = 0; r < roofUnitsPerBlock; ++r) {
+        bounds.push_back(boxBounds(cx + (random() - 0.5f) * blockSize * 0.6f, height + 1.5f,
+                                   cz + (random() - 0.5f) * blockSize * 0.6f, 3.0f, 3.0f, 3.0f));
+      }
+    }
+  }
+
+  XMFLOAT4X4 projection;
+  XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(fovY, aspect, 0.1f, 1000.0f));
+  auto cameraViewProjection = [&projection](float x, float z, float yaw) {
+    XMMATRIX view = XMMatrixLookToLH(XMVectorSet(x, 1.7f, z, 0.0f),
+                                     XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f),
+                                     XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    XMFLOAT4X4 viewProjection;
+    XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, XMLoadFloat4x4(&projection)));
+    return viewProjection;
+  };
+
+  SoftwareOcclusionSettings settings;
+  report.log("%u blocks, %zu occluders (%zu tris), %zu bounds, %ux%u depth, %u threads, %d frames",
+             blocks * blocks, occluders.size(), occluders.size() * box.indices.size() / 3, bounds.size(),
+             settings.width, settings.height, JobSystem::getInstance().getNumThreads(), numFrames);
+
+  SoftwareOcclusion occlusion;
+  occlusion.setSettings(settings);
+  SoftwareOcclusion reference;
+  reference.setSettings(settings);
+
+  SoftwareOcclusionStats sum;
+  double totalMs = 0.0;
+  double referenceRasterMs = 0.0;
+  unsigned int referenceOccluded = 0;
+  unsigned int verifiedFrames = 0;
+  unsigned int depthMismatches = 0;
+  unsigned int falseOcclusions = 0;
+  std::vector<uint8_t> visible;
+
+  for (int f = 0; f < numFrames; ++f) {
+    // Camino por la calle entre dos columnas de manzanas mirando un poco a los lados
+    float time = f / 60.0f;
+    XMFLOAT4X4 viewProjection = cameraViewProjection(-streetWidth * 0.5f, -half * 0.8f + time * 40.0f,
+                                                     std::sin(time * 1.3f) * 0.5f);
+
+    Timer frame;
+    occlusion.beginFrame(viewProjection);
+    occlusion.rasterize(occluders);
+    occlusion.testBounds(bounds, visible);
+    totalMs += frame.elapsedMs();
+
+    const SoftwareOcclusionStats& stats = occlusion.getStats();
+    sum.rasterizedTriangles += stats.rasterizedTriangles;
+    sum.binnedTriangles += stats.binnedTriangles;
+    sum.tested += stats.tested;
+    sum.frustumCulled += stats.frustumCulled;
+    sum.occluded += stats.occluded;
+    sum.setupMs += stats.setupMs;
+    sum.rasterMs += stats.rasterMs;
+    sum.hierarchyMs += stats.hierarchyMs;
+    sum.testMs += stats.testMs;
+
+    if (f % verifyEvery != 0) {
+      continue;
+    }
+    ++verifiedFrames;
+    reference.beginFrame(viewProjection);
+    reference.rasterizeReference(occluders);
+    referenceRasterMs += reference.getStats().setupMs + reference.getStats().rasterMs;
+    if (std::memcmp(reference.getDepth().data(), occlusion.getDepth().data(),
+                    occlusion.getDepth().size() * sizeof(float)) != 0) {
+      ++depthMismatches;
+    }
+    for (size_t i = 0; i < bounds.size(); ++i) {
+      bool exact = reference.isOccludedReference(bounds[i]);
+      referenceOccluded += exact ? 1 : 0;
+      if (occlusion.m_results[i] == OCCLUDED && !exact) {
+        ++falseOcclusions;
+      }
+    }
+  }
+
+  const double tested = static_cast<double>(sum.tested);
+  report.log("frustum culled %.1f%%, occluded %.1f%%, drawn %.1f%% (full-res exact test occludes %.1f%%)",
+             100.0 * sum.frustumCulled / tested, 100.0 * sum.occluded / tested,
+             100.0 * (sum.tested - sum.frustumCulled - sum.occluded) / tested,
+             100.0 * referenceOccluded / (verifiedFrames * static_cast<double>(bounds.size())));
+  report.log("avg per frame: %u tris rasterized (%u tile refs)",
+             sum.rasterizedTriangles / numFrames, sum.binnedTriangles / numFrames);
+  report.log("avg per frame: setup %.3f ms, raster %.3f ms, hierarchy %.3f ms, test %.3f ms, total %.3f ms",
+             sum.setupMs / numFrames, sum.rasterMs / numFrames, sum.hierarchyMs / numFrames,
+             sum.testMs / numFrames, totalMs / numFrames);
+  report.log("scalar single-thread setup + raster: %.3f ms/frame", referenceRasterMs / verifiedFrames);
+
+  if (depthMismatches) {
+    report.fail("SSE depth buffer differs from the scalar reference in " +
+                std::to_string(depthMismatches) + " frames");
+  }
+  if (falseOcclusions) {
+    report.fail(std::to_string(falseOcclusions) +
+                " bounds occluded by the hierarchy but visible in the full-res test");
+  }
+  if (sum.occluded == 0) {
+    report.fail("nothing was occluded in the city block scene");
+  }
+}
@@ -1,7 +1,11 @@
 #include "ECS/Actor.h"
+#include "ECS/Prefab.h"
 #include "MeshComponent.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "Animation/Animator.h"
+#include "ViewSystem.h"
+#include <cfloat>
 
 Actor::Actor(Device& device) {
 	// Setup Default Components
@@ -10,6 +14,10 @@ Actor::Actor(Device& device) {
 	EU::TSharedPointer<MeshComponent> meshComponent = EU::MakeShared<MeshComponent>();
 	addComponent(meshComponent);
 
+	// Headless (sin dispositivo D3D) no hay nada que crear en GPU
+	if (!device.m_device) {
+		return;
+	}
 	HRESULT hr;
 	std::string classNameType = "Actor -> " + m_name;
 	hr = m_modelBuffer.init(device, sizeof(CBChangesEveryFrame));
@@ -21,8 +29,53 @@ Actor::Actor(Device& device) {
 	if (FAILED(hr)) {
 		ERROR("Actor", classNameType.c_str(), "Failed to create new SamplerState");
 	}
+}
 
-	
+Actor::Actor(const EU::TSharedPointer<Prefab>& prefab) : m_sharedState(true) {
+	// Solo el Transform es de la instancia; el resto lo pone el prefab
+	EU::TSharedPointer<Transform> transform = EU::MakeShared<Transform>();
+	addComponent(transform);
+	if (prefab.isNull()) {
+		return;
+	}
+	const PrefabDefaults& defaults = prefab->getDefaults();
+	transform->setTransform(defaults.position, defaults.rotation, defaults.scale);
+	m_name = prefab->getName();
+	castShadow = defaults.castShadow;
+	m_staticShadow = defaults.staticShadow;
+	m_occluder = defaults.occluder;
+	setPrefab(prefab);
+}
+
+void
+Actor::setPrefab(const EU::TSharedPointer<Prefab>& prefab) {
+	m_prefab = prefab;
+
+	// El MeshComponent de la instancia es el del prefab (uno para todas)
+	for (unsigned int i = 0; i < m_components.size(); i++) {
+		if (m_components[i].dynamic_pointer_cast<MeshComponent>()) {
+			m_components.erase(m_components.begin() + i);
+			break;
+		}
+	}
+	if (!m_prefab.isNull()) {
+		addComponent(m_prefab->getMeshComponent());
+	}
+}
+
+MeshRenderData&
+Actor::meshData() {
+	return (!m_prefab.isNull() && !m_ownMesh) ? m_prefab->getMeshData() : m_meshData;
+}
+
+const MeshRenderData&
+Actor::meshData() const {
+	return (!m_prefab.isNull() && !m_ownMesh) ? m_prefab->getMeshData() : m_meshData;
+}
+
+std::vector<Texture>&
+Actor::textures() {
+	return (!m_prefab.isNull() && !m_ownTextures) ? m_prefab->getTextures() : m_textures;
 }
 
 void
@@ -34,38 +87,99 @@ Actor::update(float deltaTime, DeviceContext& deviceContext) {
 		}
 	}
 
+	// Upload the CPU skinned vertices when the animator produced a new pose
+	// (solo a buffers propios: los del prefab los comparten otras instancias)
+	EU::TSharedPointer<Animator> animator = getComponent<Animator>();
+	if (animator && animator->hasNewPose()) {
+		if (m_prefab.isNull() || m_ownMesh) {
+			for (unsigned int i = 0; i < m_meshData.vertexBuffers.size(); i++) {
+				if (animator->isSkinned(i)) {
+					m_meshData.vertexBuffers[i].update(deviceContext, nullptr, 0, nullptr,
+					                                   animator->getSkinnedVertices(i).data(), 0, 0);
+				}
+			}
+		}
+		animator->clearNewPose();
+	}
+
 	// Update the model buffer
 	m_model.mWorld = XMMatrixTranspose(getComponent<Transform>()->matrix);
-	m_model.vMeshColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	// Update the constant buffer
-	m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+	// Color e índice del material (el shader lee sus parámetros en cbMaterials)
+	const unsigned int material = getMaterial();
+	m_model.vMeshColor = MaterialSystem::getInstance().getBaseColor(material);
+	m_model.vMaterial[0] = material != kInvalidMaterial ? material : 0;
+	m_model.vMaterial[1] = material != kInvalidMaterial ? 1u : 0u;
+	m_model.vMaterial[2] = 0;
+	m_model.vMaterial[3] = 0;
+	// Update the constant buffer (las instancias lo suben al CB del prefab en render)
+	if (!m_sharedState) {
+		m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+	}
 }
 
 void
 Actor::render(DeviceContext& deviceContext) {
-	// 1) Proyectar sombra primero (sobre el suelo)
-	//if (canCastShadow()) {
-	//	renderShadow(deviceContext);
-	//}
-	//
-	// 2) Estados de raster, blend y sampler para el modelo
+	// Las sombras se dibujan antes en el shadow pass (ShadowRenderer)
+	// Estados de raster, blend y sampler para el modelo
 	//m_blendstate.render(deviceContext);
 	//m_rasterizer.render(deviceContext);
-	m_sampler.render(deviceContext, 0, 1);
+	MeshRenderData& data = meshData();
+	if (!data.hasGPUGeometry()) {
+		return;
+	}
+	// Las instancias usan el sampler y el CB del prefab: subo mi matriz justo antes de dibujar
+	if (m_sharedState && m_prefab.isNull()) {
+		return;
+	}
+	SamplerState& sampler = m_sharedState ? m_prefab->getSampler() : m_sampler;
+	Buffer& modelBuffer = m_sharedState ? m_prefab->getModelBuffer() : m_modelBuffer;
+	if (m_sharedState) {
+		modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+	}
+	else if (m_cbRelative) {
+		// La vista anterior dejó la matriz relativa en mi CB: vuelvo a subir la absoluta
+		modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+		m_cbRelative = false;
+	}
+	sampler.render(deviceContext, 0, 1);
 
+	// Con material, su tabla de texturas se vincula una vez (y nada si es la que ya estaba)
+	const unsigned int material = getMaterial();
+	if (material != kInvalidMaterial) {
+		MaterialSystem::getInstance().bind(deviceContext, material);
+	}
+	std::vector<Texture>& meshTextures = textures();
 	deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	// Update buffer and render all components
-	for (unsigned int i = 0; i < m_meshes.size(); i++) {
-		m_vertexBuffers[i].render(deviceContext, 0, 1);
-		m_indexBuffers[i].render(deviceContext, 0, 1, false, DXGI_FORMAT_R32_UINT);
+	// (las mallas del pool comparten buffers: el pool se salta el bind si la página ya está,
+	//  también si la vinculó el actor anterior en este pass)
+	GeometryPool& pool = GeometryPool::getInstance();
+	for (unsigned int i = 0; i < data.meshes.size(); i++) {
+		unsigned int startIndex = 0;
+		int baseVertex = 0;
+		if (!data.geometry.empty()) {
+			GeometryRange range;
+			if (!pool.resolve(data.geometry[i], range)) {
+				continue;
+			}
+			pool.bind(deviceContext, range.page);
+			startIndex = range.startIndex;
+			baseVertex = range.baseVertex;
+		}
+		else {
+			data.vertexBuffers[i].render(deviceContext, 0, 1);
+			data.indexBuffers[i].render(deviceContext, 0, 1, false, data.indexBuffers[i].getIndexFormat());
+			pool.invalidateBinding();
+		}
 		// Bind del CB ?normal? (world + color)
-		m_modelBuffer.render(deviceContext, 2, 1, true);
+		modelBuffer.render(deviceContext, 2, 1, true);
 
-		// Render mesh texture
-		if (m_textures.size() > 0) {
-			if (i < m_textures.size()) {
-				if (m_textures.size() >= 1) {
-					m_textures[0].render(deviceContext, 0, 1); // Albedo -> t0
+		// Render mesh texture (sin material: la primera textura suelta)
+		if (material == kInvalidMaterial && meshTextures.size() > 0) {
+			if (i < meshTextures.size()) {
+				if (meshTextures.size() >= 1) {
+					meshTextures[0].render(deviceContext, 0, 1); // Albedo -> t0
+					MaterialSystem::getInstance().invalidateBinding();
 					//m_textures[1].render(deviceContext, 1, 1); // Normal -> t1
 					//m_textures[2].render(deviceContext, 2, 1); // Metallic -> t2
 					//m_textures[3].render(deviceContext, 3, 1); // Roughness -> t3
@@ -73,20 +187,34 @@ Actor::render(DeviceContext& deviceContext) {
 				}
 			}
 		}
-		deviceContext.DrawIndexed(m_meshes[i].m_numIndex, 0, 0);
+		deviceContext.DrawIndexed(data.meshes[i].m_numIndex, startIndex, baseVertex);
 	}
 }
 
 
 void
-Actor::destroy() {
-	for (auto& vertexBuffer : m_vertexBuffers) {
-		vertexBuffer.destroy();
-	}
+Actor::render(DeviceContext& deviceContext, const XMFLOAT3& cameraOrigin) {
+	XMFLOAT4X4 world;
+	XMFLOAT4X4 relative;
+	XMStoreFloat4x4(&world, getComponent<Transform>()->matrix);
+	ViewSystem::makeCameraRelative(world, cameraOrigin, relative);
 
-	for (auto& indexBuffer : m_indexBuffers) {
-		indexBuffer.destroy();
+	// Las instancias suben m_model al CB del prefab dentro de render(); el CB propio lo subo aquí
+	const XMMATRIX absoluteWorld = m_model.mWorld;
+	m_model.mWorld = XMMatrixTranspose(XMLoadFloat4x4(&relative));
+	if (!m_sharedState) {
+		m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+		m_cbRelative = false;
 	}
+	render(deviceContext);
+	m_model.mWorld = absoluteWorld;
+	m_cbRelative = !m_sharedState;
+}
+
+void
+Actor::destroy() {
+	// Solo lo propio: lo del prefab lo libera el prefab
+	m_meshData.clear();
 
 	for (auto& tex : m_textures) {
 		tex.destroy();
@@ -96,31 +224,235 @@ Actor::destroy() {
 	//m_rasterizer.destroy();
 	//m_blendstate.destroy();
 	m_sampler.destroy();
+	setMaterial(kInvalidMaterial);
+	m_prefab.reset();
+}
+
+void
+Actor::setMaterial(unsigned int material) {
+	if (m_material != kInvalidMaterial) {
+		MaterialSystem::getInstance().release(m_material);
+	}
+	m_material = material;
+}
+
+unsigned int
+Actor::getMaterial() const {
+	if (m_material != kInvalidMaterial) {
+		return m_material;
+	}
+	return (!m_prefab.isNull() && !m_ownTextures) ? m_prefab->getMaterial() : kInvalidMaterial;
 }
 
 void
 Actor::setMesh(Device& device, std::vector<MeshComponent> meshes) {
-	m_meshes = meshes;
-	HRESULT hr;
-	for (auto& mesh : m_meshes) {
-		// Crear vertex buffer
-		Buffer vertexBuffer;
-		hr = vertexBuffer.init(device, mesh, D3D11_BIND_VERTEX_BUFFER);
-		if (FAILED(hr)) {
-			ERROR("Actor", "setMesh", "Failed to create new vertexBuffer");
+	// Copy-on-write: si era instancia de un prefab, desde aquí las mallas son propias
+	m_ownMesh = true;
+	m_meshData.build(&device, meshes);
+}
+
+void
+Actor::clearMesh() {
+	m_meshData.clear();
+	m_textures.clear();
+	m_ownMesh = false;
+	m_ownTextures = false;
+	setPrefab(EU::TSharedPointer<Prefab>());
+}
+
+size_t
+Actor::getOwnedBytes() const {
+	size_t bytes = sizeof(Actor) + m_components.capacity() * sizeof(EU::TSharedPointer<Component>);
+	for (const auto& component : m_components) {
+		// Los componentes compartidos (el MeshComponent del prefab) no cuentan
+		if (component.refCount && *component.refCount > 1) {
+			continue;
+		}
+		bytes += sizeof(int);
+		if (component.dynamic_pointer_cast<Transform>()) {
+			bytes += sizeof(Transform);
+		}
+		else if (component.dynamic_pointer_cast<MeshComponent>()) {
+			bytes += sizeof(MeshComponent);
 		}
 		else {
-			m_vertexBuffers.push_back(vertexBuffer);
+			bytes += sizeof(Component);
 		}
+	}
+	if (m_name.capacity() > std::string().capacity()) {
+		bytes += m_name.capacity() + 1;
+	}
+	bytes += m_textures.capacity() * sizeof(Texture);
+	bytes += m_meshData.meshes.capacity() * sizeof(MeshComponent);
+	for (const MeshComponent& mesh : m_meshData.meshes) {
+		bytes += mesh.m_vertex.capacity() * sizeof(SimpleVertex) +
+		         mesh.m_index.capacity() * sizeof(unsigned int) +
+		         mesh.m_skin.capacity() * sizeof(SkinInfluence);
+	}
+	bytes += (m_meshData.vertexBuffers.capacity() + m_meshData.indexBuffers.capacity()) * sizeof(Buffer) +
+	         m_meshData.geometry.capacity() * sizeof(GeometryHandle) +
+	         m_meshData.shadowGeometry.capacity() * sizeof(ShadowGeometry) +
+	         m_meshData.shadowBounds.capacity() * sizeof(XMFLOAT4) +
+	         m_meshData.occlusionMesh.vertices.capacity() * sizeof(XMFLOAT3) +
+	         m_meshData.occlusionMesh.indices.capacity() * sizeof(unsigned int);
+	return bytes;
+}
+
+void
+Actor::collectShadowCasters(std::vector<ShadowCaster>& casters) {
+	MeshRenderData& data = meshData();
+	if (!castShadow || data.shadowGeometry.empty()) {
+		return;
+	}
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, getComponent<Transform>()->matrix);
+
+	// El radio escala con el eje más grande de la matriz
+	float scale = 0.0f;
+	for (int row = 0; row < 3; row++) {
+		scale = std::max(scale, world.m[row][0] * world.m[row][0] +
+		                        world.m[row][1] * world.m[row][1] +
+		                        world.m[row][2] * world.m[row][2]);
+	}
+	scale = std::sqrt(scale);
 
-		// Crear index buffer
-		Buffer indexBuffer;
-		hr = indexBuffer.init(device, mesh, D3D11_BIND_INDEX_BUFFER);
-		if (FAILED(hr)) {
-			ERROR("Actor", "setMesh", "Failed to create new indexBuffer");
+	for (unsigned int i = 0; i < data.shadowGeometry.size(); i++) {
+		const XMFLOAT4& b = data.shadowBounds[i];
+		ShadowCaster caster;
+		caster.center = XMFLOAT3(b.x * world._11 + b.y * world._21 + b.z * world._31 + world._41,
+		                         b.x * world._12 + b.y * world._22 + b.z * world._32 + world._42,
+		                         b.x * world._13 + b.y * world._23 + b.z * world._33 + world._43);
+		caster.radius = b.w * scale;
+		caster.world = world;
+		caster.geometry = &data.shadowGeometry[i];
+		caster.isStatic = m_staticShadow;
+		casters.push_back(caster);
+	}
+}
+void
+Actor::collectOccluders(std::vector<OccluderInstance>& occluders) {
+	MeshRenderData& data = meshData();
+	if (!m_occluder || data.meshes.empty()) {
+		return;
+	}
+
+	OccluderInstance occluder;
+	occluder.mesh = &data.getOcclusionMesh();
+	XMStoreFloat4x4(&occluder.world, getComponent<Transform>()->matrix);
+	occluders.push_back(occluder);
+}
+
+void
+Actor::collectLightmapInstances(std::vector<LightmapInstance>& instances) {
+	const MeshRenderData& data = meshData();
+	if (!m_lightmapped || data.meshes.empty()) {
+		return;
+	}
+
+	LightmapInstance instance;
+	XMStoreFloat4x4(&instance.world, getComponent<Transform>()->matrix);
+	const XMFLOAT4 color = MaterialSystem::getInstance().getBaseColor(getMaterial());
+	instance.albedo = XMFLOAT3(color.x, color.y, color.z);
+	for (const MeshComponent& mesh : data.meshes) {
+		if (!mesh.m_vertex.empty() && !mesh.m_index.empty()) {
+			instance.mesh = &mesh;
+			instances.push_back(instance);
 		}
-		else {
-			m_indexBuffers.push_back(indexBuffer);
+	}
+}
+
+bool
+Actor::getWorldBounds(OcclusionBounds& bounds) {
+	const MeshRenderData& data = meshData();
+	if (!data.hasBounds()) {
+		return false;
+	}
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, getComponent<Transform>()->matrix);
+
+	// Centro y extensión: la extensión en mundo es |M| * extensión local
+	const XMFLOAT3& lo = data.localBounds.minPoint;
+	const XMFLOAT3& hi = data.localBounds.maxPoint;
+	float center[3] = { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+	float extent[3] = { (hi.x - lo.x) * 0.5f, (hi.y - lo.y) * 0.5f, (hi.z - lo.z) * 0.5f };
+	float worldCenter[3];
+	float worldExtent[3];
+	for (int c = 0; c < 3; c++) {
+		worldCenter[c] = center[0] * world.m[0][c] + center[1] * world.m[1][c] + center[2] * world.m[2][c] + world.m[3][c];
+		worldExtent[c] = extent[0] * std::fabs(world.m[0][c]) + extent[1] * std::fabs(world.m[1][c]) + extent[2] * std::fabs(world.m[2][c]);
+	}
+	bounds.minPoint = XMFLOAT3(worldCenter[0] - worldExtent[0], worldCenter[1] - worldExtent[1], worldCenter[2] - worldExtent[2]);
+	bounds.maxPoint = XMFLOAT3(worldCenter[0] + worldExtent[0], worldCenter[1] + worldExtent[1], worldCenter[2] + worldExtent[2]);
+	return true;
+}
+
+bool
+Actor::getCollider(ShapeType type, ColliderDesc& desc) const {
+	const MeshRenderData& data = meshData();
+	if (!data.hasBounds()) {
+		return false;
+	}
+	const XMFLOAT3& lo = data.localBounds.minPoint;
+	const XMFLOAT3& hi = data.localBounds.maxPoint;
+	desc = ColliderDesc();
+	desc.type = type;
+	desc.center = XMFLOAT3((lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f);
+	desc.halfExtents = XMFLOAT3((hi.x - lo.x) * 0.5f, (hi.y - lo.y) * 0.5f, (hi.z - lo.z) * 0.5f);
+	const XMFLOAT3& e = desc.halfExtents;
+	if (type == SHAPE_SPHERE) {
+		desc.radius = std::sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+	}
+	else if (type == SHAPE_CAPSULE) {
+		desc.radius = std::max(e.x, e.z);
+		desc.halfHeight = std::max(e.y - desc.radius, 0.0f);
+	}
+	return true;
+}
+
+void
+Actor::getWorldMatrix(XMFLOAT4X4& world) {
+	XMStoreFloat4x4(&world, getComponent<Transform>()->matrix);
+}
+
+bool
+Actor::raycastMeshes(const XMFLOAT3& origin,
+                     const XMFLOAT3& direction,
+                     float maxDistance,
+                     float& distance,
+                     int& meshIndex) {
+	meshIndex = -1;
+	XMMATRIX inverseWorld = XMMatrixInverse(nullptr, getComponent<Transform>()->matrix);
+	BVHRay ray;
+	XMStoreFloat3(&ray.origin, XMVector3TransformCoord(XMLoadFloat3(&origin), inverseWorld));
+	XMStoreFloat3(&ray.direction, XMVector3TransformNormal(XMLoadFloat3(&direction), inverseWorld));
+	ray.maxDistance = maxDistance;
+
+	const std::vector<MeshComponent>& meshes = meshData().meshes;
+	for (unsigned int i = 0; i < meshes.size(); i++) {
+		if (meshes[i].m_bvh.isNull()) {
+			continue;
+		}
+		BVHHit hit;
+		if (meshes[i].m_bvh->intersect(ray, hit)) {
+			ray.maxDistance = hit.distance;
+			meshIndex = static_cast<int>(i);
+		}
+	}
+	distance = ray.maxDistance;
+	return meshIndex >= 0;
+}
+
+bool
+Actor::hasTriangleBVH() const {
+	for (const MeshComponent& mesh : meshData().meshes) {
+		if (!mesh.m_bvh.isNull()) {
+			return true;
 		}
 	}
-}
\ No newline at end of file
+	return false;
+}
+
+const std::string&
+Actor::getMeshName(int meshIndex) const {
+	return meshData().meshes[meshIndex].m_name;
+}
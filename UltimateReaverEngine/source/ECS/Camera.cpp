@@ -0,0 +1,41 @@
+#include "ECS/Camera.h"
+#include <cmath>
+
+void
+Camera::lookAt(Transform& transform, const EU::Vector3& eye, const EU::Vector3& target) {
+  EU::Vector3 direction = target - eye;
+  const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+  if (length <= 0.0f) {
+    transform.setPosition(eye);
+    return;
+  }
+  direction = direction * (1.0f / length);
+
+  // Con roll-pitch-yaw, +Z termina en (sin(yaw) cos(pitch), -sin(pitch), cos(yaw) cos(pitch))
+  const float pitch = std::asin(std::max(-1.0f, std::min(1.0f, -direction.y)));
+  const float yaw = std::atan2(direction.x, direction.z);
+  transform.setPosition(eye);
+  transform.setRotation(EU::Vector3(pitch, yaw, 0.0f));
+}
+
+RenderView
+Camera::computeView(const Transform& transform, unsigned int targetWidth, unsigned int targetHeight) const {
+  const EU::Vector3& position = transform.getPosition();
+  const EU::Vector3& rotation = transform.getRotation();
+  const XMMATRIX world = XMMatrixMultiply(XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z),
+                                          XMMatrixTranslation(position.x, position.y, position.z));
+  XMFLOAT4X4 view;
+  XMStoreFloat4x4(&view, XMMatrixInverse(nullptr, world));
+
+  const float width = std::max(1.0f, m_rect[2] * targetWidth);
+  const float height = std::max(1.0f, m_rect[3] * targetHeight);
+  XMFLOAT4X4 projection;
+  XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(m_fovY, width / height, m_nearPlane, m_farPlane));
+
+  RenderView result = ViewSystem::makeView(view, projection,
+                                           m_rect[0] * targetWidth, m_rect[1] * targetHeight, width, height,
+                                           m_cameraRelative);
+  // La posición exacta del Transform (la inversa de la vista redondea)
+  result.eye = XMFLOAT3(position.x, position.y, position.z);
+  return result;
+}
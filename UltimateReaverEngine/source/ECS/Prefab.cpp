@@ -0,0 +1,351 @@
+#include "ECS/Prefab.h"
+#include "ECS/Actor.h"
+#include "Device.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cmath>
+
+void
+MeshRenderData::build(Device* device, const std::vector<MeshComponent>& source) {
+  clear();
+  meshes = source;
+
+  // Buffers de GPU solo si hay dispositivo (headless me quedo con la parte de CPU)
+  bool skinned = false;
+  for (const MeshComponent& mesh : meshes) {
+    skinned = skinned || !mesh.m_skin.empty();
+  }
+  GeometryPool& pool = GeometryPool::getInstance();
+  if (device && device->m_device && pool.isReady() && !skinned) {
+    // Rangos en los buffers compartidos del pool
+    for (const MeshComponent& mesh : meshes) {
+      GeometryHandle handle = pool.allocate(mesh);
+      if (!handle.isValid()) {
+        ERROR("MeshRenderData", "build", "Failed to allocate " << mesh.m_name.c_str() << " from the geometry pool");
+        break;
+      }
+      geometry.push_back(handle);
+    }
+  }
+  else if (device && device->m_device) {
+    HRESULT hr;
+    for (const MeshComponent& mesh : meshes) {
+      Buffer vertexBuffer;
+      hr = vertexBuffer.init(*device, mesh, D3D11_BIND_VERTEX_BUFFER);
+      if (FAILED(hr)) {
+        ERROR("MeshRenderData", "build", "Failed to create new vertexBuffer");
+      }
+      else {
+        vertexBuffers.push_back(vertexBuffer);
+      }
+
+      Buffer indexBuffer;
+      hr = indexBuffer.init(*device, mesh, D3D11_BIND_INDEX_BUFFER);
+      if (FAILED(hr)) {
+        ERROR("MeshRenderData", "build", "Failed to create new indexBuffer");
+      }
+      else {
+        indexBuffers.push_back(indexBuffer);
+      }
+    }
+  }
+
+  // Caja local de todas las mallas y esfera local de cada una
+  for (const MeshComponent& mesh : meshes) {
+    XMFLOAT3 minPoint(FLT_MAX, FLT_MAX, FLT_MAX);
+    XMFLOAT3 maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const SimpleVertex& v : mesh.m_vertex) {
+      minPoint = XMFLOAT3(std::min(minPoint.x, v.Pos.x), std::min(minPoint.y, v.Pos.y), std::min(minPoint.z, v.Pos.z));
+      maxPoint = XMFLOAT3(std::max(maxPoint.x, v.Pos.x), std::max(maxPoint.y, v.Pos.y), std::max(maxPoint.z, v.Pos.z));
+    }
+    XMFLOAT3& lo = localBounds.minPoint;
+    XMFLOAT3& hi = localBounds.maxPoint;
+    lo = XMFLOAT3(std::min(lo.x, minPoint.x), std::min(lo.y, minPoint.y), std::min(lo.z, minPoint.z));
+    hi = XMFLOAT3(std::max(hi.x, maxPoint.x), std::max(hi.y, maxPoint.y), std::max(hi.z, maxPoint.z));
+
+    XMFLOAT4 bounds((minPoint.x + maxPoint.x) * 0.5f,
+                    (minPoint.y + maxPoint.y) * 0.5f,
+                    (minPoint.z + maxPoint.z) * 0.5f,
+                    0.0f);
+    for (const SimpleVertex& v : mesh.m_vertex) {
+      float dx = v.Pos.x - bounds.x, dy = v.Pos.y - bounds.y, dz = v.Pos.z - bounds.z;
+      bounds.w = std::max(bounds.w, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.w = std::sqrt(bounds.w);
+    shadowBounds.push_back(bounds);
+  }
+
+  // Geometría para el shadow pass (solo si se crearon todos los buffers)
+  if (!hasGPUGeometry()) {
+    return;
+  }
+  for (unsigned int i = 0; i < meshes.size(); i++) {
+    ShadowGeometry shadow;
+    if (geometry.empty()) {
+      shadow.vertexBuffer = &vertexBuffers[i];
+      shadow.indexBuffer = &indexBuffers[i];
+      shadow.indexFormat = indexBuffers[i].getIndexFormat();
+    }
+    else {
+      shadow.pooled = geometry[i];
+    }
+    shadow.indexCount = meshes[i].m_numIndex;
+    shadowGeometry.push_back(shadow);
+  }
+}
+
+void
+MeshRenderData::clear() {
+  for (auto& vertexBuffer : vertexBuffers) {
+    vertexBuffer.destroy();
+  }
+  for (auto& indexBuffer : indexBuffers) {
+    indexBuffer.destroy();
+  }
+  GeometryPool& pool = GeometryPool::getInstance();
+  for (GeometryHandle& handle : geometry) {
+    pool.free(handle);
+  }
+  vertexBuffers.clear();
+  indexBuffers.clear();
+  geometry.clear();
+  meshes.clear();
+  shadowGeometry.clear();
+  shadowBounds.clear();
+  occlusionMesh.vertices.clear();
+  occlusionMesh.indices.clear();
+  localBounds.minPoint = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+  localBounds.maxPoint = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+}
+
+const OcclusionMesh&
+MeshRenderData::getOcclusionMesh() {
+  if (occlusionMesh.indices.empty()) {
+    for (const MeshComponent& mesh : meshes) {
+      unsigned int base = static_cast<unsigned int>(occlusionMesh.vertices.size());
+      for (const SimpleVertex& v : mesh.m_vertex) {
+        occlusionMesh.vertices.push_back(v.Pos);
+      }
+      for (unsigned int index : mesh.m_index) {
+        occlusionMesh.indices.push_back(base + index);
+      }
+    }
+  }
+  return occlusionMesh;
+}
+
+HRESULT
+Prefab::init(Device* device,
+             const std::string& name,
+             const std::vector<MeshComponent>& meshes,
+             const std::vector<Texture>& textures,
+             bool meshBuffers) {
+  destroy();
+  m_name = name;
+  m_textures = textures;
+  m_meshData.build(meshBuffers ? device : nullptr, meshes);
+
+  if (device && device->m_device) {
+    if (meshBuffers && !m_meshData.hasGPUGeometry()) {
+      ERROR("Prefab", "init", "Failed to create the mesh buffers of " << name.c_str());
+      destroy();
+      return E_FAIL;
+    }
+    HRESULT hr = m_modelBuffer.init(*device, sizeof(CBChangesEveryFrame));
+    if (FAILED(hr)) {
+      ERROR("Prefab", "init", "Failed to create new CBChangesEveryFrame");
+      destroy();
+      return hr;
+    }
+    hr = m_sampler.init(*device);
+    if (FAILED(hr)) {
+      ERROR("Prefab", "init", "Failed to create new SamplerState");
+      destroy();
+      return hr;
+    }
+  }
+  m_ready = true;
+  return S_OK;
+}
+
+void
+Prefab::destroy() {
+  m_meshData.clear();
+  m_textures.clear();
+  setMaterial(kInvalidMaterial);
+  m_modelBuffer.destroy();
+  m_sampler.destroy();
+  m_ready = false;
+}
+
+void
+Prefab::setMaterial(unsigned int material) {
+  if (m_material != kInvalidMaterial) {
+    MaterialSystem::getInstance().release(m_material);
+  }
+  m_material = material;
+}
+
+unsigned int
+Prefab::getNumGPUObjects() const {
+  // Vertex e index buffer por malla (ninguno si viven en el pool), más el sampler y el CB de modelo
+  return (m_meshData.geometry.empty() ? static_cast<unsigned int>(m_meshData.meshes.size()) * 2 : 0) + 2;
+}
+
+namespace {
+
+  /**
+   * @brief Malla de rejilla de `side` x `side` vértices con índices de dos triángulos por celda.
+   */
+  MeshComponent
+    makeGridMesh(const std::string& name, unsigned int side, float offset) {
+    MeshComponent mesh;
+    mesh.m_name = name;
+    for (unsigned int z = 0; z < side; ++z) {
+      for (unsigned int x = 0; x < side; ++x) {
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(static_cast<float>(x) + offset, std::sin(x * 0.3f) * std::cos(z * 0.2f), static_cast<float>(z));
+        v.Tex = XMFLOAT2(static_cast<float>(x) / side, static_cast<float>(z) / side);
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    for (unsigned int z = 0; z + 1 < side; ++z) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = z * side + x;
+        const unsigned int quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  bool
+    sameBounds(const OcclusionBounds& a, const OcclusionBounds& b) {
+    const float e = 1.0e-3f;
+    return std::fabs(a.minPoint.x - b.minPoint.x) < e && std::fabs(a.minPoint.y - b.minPoint.y) < e &&
+           std::fabs(a.minPoint.z - b.minPoint.z) < e && std::fabs(a.maxPoint.x - b.maxPoint.x) < e &&
+           std::fabs(a.maxPoint.y - b.maxPoint.y) < e && std::fabs(a.maxPoint.z - b.maxPoint.z) < e;
+  }
+
+} // namespace
+
+void
+Prefab::runBenchmark(BenchmarkReport& report) {
+  const unsigned int count = 10000;
+  // Los actores sueltos copian las mallas completas: con menos ya se ve la diferencia
+  const unsigned int standaloneCount = count / 10;
+  std::vector<MeshComponent> meshes;
+  for (unsigned int m = 0; m < 4; ++m) {
+    meshes.push_back(makeGridMesh("Part" + std::to_string(m), 32, m * 40.0f));
+  }
+  size_t meshBytes = 0;
+  for (const MeshComponent& mesh : meshes) {
+    meshBytes += mesh.m_vertex.size() * sizeof(SimpleVertex) + mesh.m_index.size() * sizeof(unsigned int);
+  }
+
+  // Dispositivo vacío: nada llega a la GPU, así mido solo el costo de CPU de cada camino
+  Device device;
+  EU::TSharedPointer<Prefab> prefab = EU::MakeShared<Prefab>();
+  PrefabDefaults defaults;
+  defaults.occluder = true;
+  prefab->setDefaults(defaults);
+  Timer timer;
+  prefab->init(nullptr, "Crate", meshes, std::vector<Texture>());
+  const double prefabMs = timer.elapsedMs();
+
+  // --- Camino viejo: cada actor con su CB, sampler y copia de las mallas ---
+  std::vector<EU::TSharedPointer<Actor>> actors;
+  actors.reserve(count);
+  timer.reset();
+  for (unsigned int i = 0; i < standaloneCount; ++i) {
+    EU::TSharedPointer<Actor> actor = EU::MakeShared<Actor>(device);
+    actor->setMesh(device, meshes);
+    actor->setTextures(std::vector<Texture>());
+    actor->getComponent<Transform>()->setTransform(EU::Vector3(i * 2.0f, 0.0f, 0.0f), EU::Vector3(), EU::Vector3(1.0f, 1.0f, 1.0f));
+    actors.push_back(actor);
+  }
+  const double legacyMs = timer.elapsedMs();
+  size_t legacyBytes = 0;
+  for (const EU::TSharedPointer<Actor>& actor : actors) {
+    legacyBytes += actor->getOwnedBytes() + sizeof(int);
+  }
+  timer.reset();
+  actors.clear();
+  const double legacyFreeMs = timer.elapsedMs();
+
+  // --- Instancias del prefab ---
+  timer.reset();
+  for (unsigned int i = 0; i < count; ++i) {
+    EU::TSharedPointer<Actor> actor = EU::MakeShared<Actor>(prefab);
+    actor->getComponent<Transform>()->setTransform(EU::Vector3(i * 2.0f, 0.0f, 0.0f), EU::Vector3(), EU::Vector3(1.0f, 1.0f, 1.0f));
+    actors.push_back(actor);
+  }
+  const double instanceMs = timer.elapsedMs();
+  size_t instanceBytes = 0;
+  for (const EU::TSharedPointer<Actor>& actor : actors) {
+    instanceBytes += actor->getOwnedBytes() + sizeof(int);
+  }
+
+  // Objetos de GPU: el camino viejo crea CB + sampler + VB/IB por actor
+  const unsigned long long legacyGPUObjects = static_cast<unsigned long long>(count) * prefab->getNumGPUObjects();
+  const double legacyGPUMB = count * (meshBytes + sizeof(CBChangesEveryFrame)) / (1024.0 * 1024.0);
+  const double prefabGPUMB = (meshBytes + sizeof(CBChangesEveryFrame)) / (1024.0 * 1024.0);
+  const double legacyUs = legacyMs * 1.0e3 / standaloneCount;
+  const double instanceUs = instanceMs * 1.0e3 / count;
+  report.log("%zu meshes (%.1f KB of vertices/indices) | prefab init %.3f ms", meshes.size(), meshBytes / 1024.0, prefabMs);
+  report.log("  %5u standalone: %8.2f ms (%9.0f actors/s), %9.1f bytes/actor CPU, free %.2f ms",
+             standaloneCount, legacyMs, 1.0e6 / legacyUs, static_cast<double>(legacyBytes) / standaloneCount, legacyFreeMs);
+  report.log("  %5u instances:  %8.2f ms (%9.0f actors/s), %9.1f bytes/actor CPU -> %.0fx faster, %.0fx less memory per actor",
+             count, instanceMs, 1.0e6 / instanceUs, static_cast<double>(instanceBytes) / count,
+             legacyUs / std::max(instanceUs, 1.0e-9),
+             (static_cast<double>(legacyBytes) / standaloneCount) / std::max(static_cast<double>(instanceBytes) / count, 1.0));
+  report.log("  GPU objects for %u actors: %llu standalone (%.1f MB) vs %u with the prefab (%.3f MB)",
+             count, legacyGPUObjects, legacyGPUMB, prefab->getNumGPUObjects(), prefabGPUMB);
+
+  // Las instancias ven los datos del prefab (la matriz del Transform sale de update)
+  for (unsigned int i = 0; i < 3; ++i) {
+    actors[i]->getComponent<Transform>()->update(0.0f);
+  }
+  const MeshRenderData& shared = prefab->getMeshData();
+  OcclusionBounds bounds;
+  Actor& first = *actors[0];
+  if (!first.getWorldBounds(bounds) || !sameBounds(bounds, shared.localBounds) ||
+      first.getMeshName(3) != "Part3" || first.getName() != "Crate" || !first.isOccluder()) {
+    report.fail("instance doesn't see the prefab's meshes, name or defaults");
+  }
+  if (*prefab->getMeshComponent().refCount != static_cast<int>(count) + 1) {
+    report.fail("instances don't share the prefab's MeshComponent");
+  }
+  std::vector<OccluderInstance> occluders;
+  actors[0]->collectOccluders(occluders);
+  actors[1]->collectOccluders(occluders);
+  if (occluders.size() != 2 || occluders[0].mesh != occluders[1].mesh || occluders[0].mesh != &shared.occlusionMesh) {
+    report.fail("instances don't share the prefab's occlusion mesh");
+  }
+
+  // Copy-on-write: la instancia que sobreescribe no toca al prefab ni a las demás
+  actors[1]->setMesh(device, std::vector<MeshComponent>(1, makeGridMesh("Override", 8, -100.0f)));
+  actors[1]->setName("Crate_override");
+  if (shared.meshes.size() != meshes.size() || shared.meshes[0].m_name != "Part0") {
+    report.fail("overriding an instance's meshes changed the prefab");
+  }
+  if (!actors[1]->getWorldBounds(bounds) || bounds.minPoint.x > -90.0f || actors[1]->getMeshName(0) != "Override") {
+    report.fail("instance override isn't used");
+  }
+  if (!actors[2]->getWorldBounds(bounds) || actors[2]->getMeshName(0) != "Part0" || actors[0]->getName() != "Crate") {
+    report.fail("overriding one instance changed another");
+  }
+
+  // Soltar la malla suelta también el prefab
+  actors[2]->clearMesh();
+  if (actors[2]->getWorldBounds(bounds) || !actors[2]->getPrefab().isNull() ||
+      *prefab->getMeshComponent().refCount != static_cast<int>(count)) {
+    report.fail("clearMesh should drop the prefab");
+  }
+  actors.clear();
+  if (*prefab->getMeshComponent().refCount != 1) {
+    report.fail("instances leaked a reference to the prefab");
+  }
+}
@@ -0,0 +1,47 @@
+#include "FrameProfiler.h"
+
+void
+FrameProfiler::beginFrame() {
+  const unsigned int slot = static_cast<unsigned int>(m_frames % ProfilerSection::kHistory);
+  const unsigned int count = static_cast<unsigned int>(
+    std::min<unsigned long long>(m_frames + 1, ProfilerSection::kHistory));
+  for (ProfilerSection& section : m_sections) {
+    section.lastMs = section.currentMs;
+    section.history[slot] = section.currentMs;
+    section.currentMs = 0.0;
+
+    double sum = 0.0;
+    double maxMs = 0.0;
+    for (unsigned int i = 0; i < count; ++i) {
+      sum += section.history[i];
+      maxMs = std::max(maxMs, section.history[i]);
+    }
+    section.averageMs = sum / count;
+    section.maxMs = maxMs;
+  }
+  ++m_frames;
+}
+
+void
+FrameProfiler::addSample(const char* section, double ms) {
+  for (ProfilerSection& existing : m_sections) {
+    if (existing.name == section) {
+      existing.currentMs += ms;
+      return;
+    }
+  }
+  // Pocas secciones: la búsqueda lineal sale más barata que un mapa
+  m_sections.emplace_back();
+  m_sections.back().name = section;
+  m_sections.back().currentMs = ms;
+}
+
+const ProfilerSection*
+FrameProfiler::getSection(const char* section) const {
+  for (const ProfilerSection& existing : m_sections) {
+    if (existing.name == section) {
+      return &existing;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,760 @@
+#include "GeometryPool.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshIndexing.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cstring>
+#include <random>
+#include <tuple>
+
+// ============================================================================
+// GeometryAllocator
+// ============================================================================
+
+void
+GeometryAllocator::init(unsigned int capacity) {
+  m_tlsf.init(capacity, 1);
+  m_allocations.clear();
+}
+
+bool
+GeometryAllocator::allocate(unsigned int size, unsigned int& offset) {
+  EU::TLSFAllocation allocation = m_tlsf.allocate(size);
+  if (!allocation.isValid()) {
+    return false;
+  }
+  offset = static_cast<unsigned int>(allocation.offset);
+  m_allocations[offset] = allocation;
+  return true;
+}
+
+bool
+GeometryAllocator::free(unsigned int offset) {
+  auto allocation = m_allocations.find(offset);
+  if (allocation == m_allocations.end()) {
+    return false;
+  }
+  m_tlsf.free(allocation->second);
+  m_allocations.erase(allocation);
+  return true;
+}
+
+void
+GeometryAllocator::compact(std::vector<GeometryMove>& moves) {
+  moves.clear();
+  moves.reserve(m_allocations.size());
+  unsigned int cursor = 0;
+  m_tlsf.forEachAllocation([&](const EU::TLSFAllocation& allocation, uint64_t size) {
+    moves.push_back({ static_cast<unsigned int>(allocation.offset), cursor, static_cast<unsigned int>(size) });
+    cursor += static_cast<unsigned int>(size);
+  });
+
+  // Con todo libre, el TLSF reparte desde el inicio del único bloque: quedan seguidos
+  init(getCapacity());
+  for (const GeometryMove& move : moves) {
+    unsigned int offset = 0;
+    allocate(move.size, offset);
+  }
+}
+
+GeometryAllocatorStats
+GeometryAllocator::getStats() {
+  const EU::TLSFStats tlsf = m_tlsf.getStats();
+  GeometryAllocatorStats stats;
+  stats.capacity = static_cast<unsigned int>(tlsf.capacity);
+  stats.used = static_cast<unsigned int>(tlsf.used);
+  stats.free = static_cast<unsigned int>(tlsf.free);
+  stats.allocations = tlsf.allocations;
+  stats.freeBlocks = tlsf.freeBlocks;
+  stats.largestFreeBlock = static_cast<unsigned int>(tlsf.largestFreeBlock);
+  stats.fragmentation = tlsf.fragmentation;
+  return stats;
+}
+
+// ============================================================================
+// GeometryPool
+// ============================================================================
+
+void
+GeometryPool::init(Device* device,
+                   DeviceContext* deviceContext,
+                   unsigned int pageVertices,
+                   unsigned int pageIndices) {
+  destroy();
+  m_device = device;
+  m_deviceContext = deviceContext;
+  m_pageVertices = std::max(pageVertices, 1u);
+  m_pageIndices = std::max(pageIndices, 1u);
+  m_ready = true;
+}
+
+void
+GeometryPool::destroy() {
+  for (auto& page : m_pages) {
+    page->vertexBuffer.destroy();
+    page->indexBuffer.destroy();
+  }
+  m_pages.clear();
+  for (StagingSlot& slot : m_staging) {
+    SAFE_RELEASE(slot.buffer);
+    slot.bytes = 0;
+  }
+  m_stagingSlot = 0;
+  m_stagingStalls = 0;
+  m_allocations.clear();
+  m_freeAllocations.clear();
+  m_numMeshes = 0;
+  m_binds = 0;
+  m_bindsSkipped = 0;
+  m_boundPage = 0xFFFFFFFF;
+  m_defragmentations = 0;
+  m_movedBytes = 0;
+  m_indexBytes = 0;
+  m_indexBytesSaved = 0;
+  m_device = nullptr;
+  m_deviceContext = nullptr;
+  m_ready = false;
+}
+
+GeometryHandle
+GeometryPool::allocate(const MeshComponent& mesh) {
+  GeometryHandle handle;
+  if (!m_ready) {
+    ERROR("GeometryPool", "allocate", "The pool is not initialized");
+    return handle;
+  }
+  const unsigned int vertexCount = static_cast<unsigned int>(mesh.m_vertex.size());
+  const unsigned int indexCount = static_cast<unsigned int>(mesh.m_index.size());
+  if (vertexCount == 0 || indexCount == 0) {
+    ERROR("GeometryPool", "allocate", "Mesh " << mesh.m_name.c_str() << " has no vertices or indices");
+    return handle;
+  }
+
+  const DXGI_FORMAT indexFormat = MeshIndexing::chooseFormat(mesh);
+  Allocation allocation;
+  bool placed = false;
+  for (unsigned int p = 0; p < m_pages.size() && !placed; ++p) {
+    if (m_pages[p]->indexFormat == indexFormat && allocateIn(*m_pages[p], vertexCount, indexCount, allocation)) {
+      allocation.page = p;
+      placed = true;
+    }
+  }
+  if (!placed) {
+    // Página nueva; si la malla no cabe en una normal, una a su medida
+    EU::TUniquePtr<Page> page = EU::MakeUnique<Page>();
+    const unsigned int vertexCapacity = std::max(m_pageVertices, vertexCount);
+    const unsigned int indexCapacity = std::max(m_pageIndices, indexCount);
+    HRESULT hr = createPageBuffers(vertexCapacity, indexCapacity, indexFormat, page->vertexBuffer, page->indexBuffer);
+    if (FAILED(hr)) {
+      ERROR("GeometryPool", "allocate", "Failed to create the buffers of a new page");
+      return handle;
+    }
+    page->indexFormat = indexFormat;
+    page->vertices.init(vertexCapacity);
+    page->indices.init(indexCapacity);
+    allocateIn(*page, vertexCount, indexCount, allocation);
+    allocation.page = static_cast<unsigned int>(m_pages.size());
+    m_pages.push_back(std::move(page));
+  }
+
+  if (m_freeAllocations.empty()) {
+    handle.index = static_cast<unsigned int>(m_allocations.size());
+    m_allocations.push_back(Allocation());
+  }
+  else {
+    handle.index = m_freeAllocations.back();
+    m_freeAllocations.pop_back();
+  }
+  allocation.generation = m_allocations[handle.index].generation;
+  allocation.live = true;
+  m_allocations[handle.index] = allocation;
+  handle.generation = allocation.generation;
+  ++m_numMeshes;
+  const unsigned int indexStride = MeshIndexing::getStride(indexFormat);
+  m_indexBytes += static_cast<unsigned long long>(indexCount) * indexStride;
+  m_indexBytesSaved += static_cast<unsigned long long>(indexCount) * (sizeof(unsigned int) - indexStride);
+
+  // Subo los datos a su rango de la página
+  Page& page = *m_pages[allocation.page];
+  if (page.vertexBuffer.getBuffer() && FAILED(upload(page, allocation, mesh))) {
+    ERROR("GeometryPool", "allocate", "Failed to upload mesh " << mesh.m_name.c_str());
+  }
+  return handle;
+}
+
+void
+GeometryPool::free(GeometryHandle& handle) {
+  if (handle.isValid() && handle.index < m_allocations.size()) {
+    Allocation& allocation = m_allocations[handle.index];
+    if (allocation.live && allocation.generation == handle.generation) {
+      Page& page = *m_pages[allocation.page];
+      page.vertices.free(allocation.vertexOffset);
+      page.indices.free(allocation.indexOffset);
+      const unsigned int indexStride = MeshIndexing::getStride(page.indexFormat);
+      m_indexBytes -= static_cast<unsigned long long>(allocation.indexCount) * indexStride;
+      m_indexBytesSaved -= static_cast<unsigned long long>(allocation.indexCount) * (sizeof(unsigned int) - indexStride);
+      allocation.live = false;
+      ++allocation.generation;
+      m_freeAllocations.push_back(handle.index);
+      --m_numMeshes;
+    }
+  }
+  handle = GeometryHandle();
+}
+
+bool
+GeometryPool::resolve(const GeometryHandle& handle, GeometryRange& range) {
+  if (!handle.isValid() || handle.index >= m_allocations.size()) {
+    return false;
+  }
+  const Allocation& allocation = m_allocations[handle.index];
+  if (!allocation.live || allocation.generation != handle.generation) {
+    return false;
+  }
+  Page& page = *m_pages[allocation.page];
+  range.page = allocation.page;
+  range.vertexBuffer = &page.vertexBuffer;
+  range.indexBuffer = &page.indexBuffer;
+  range.indexFormat = page.indexFormat;
+  range.baseVertex = static_cast<int>(allocation.vertexOffset);
+  range.startIndex = allocation.indexOffset;
+  range.indexCount = allocation.indexCount;
+  return true;
+}
+
+bool
+GeometryPool::track(unsigned int page) {
+  if (page >= m_pages.size()) {
+    return false;
+  }
+  if (page == m_boundPage) {
+    ++m_bindsSkipped;
+    return false;
+  }
+  m_boundPage = page;
+  ++m_binds;
+  return true;
+}
+
+bool
+GeometryPool::bind(DeviceContext& deviceContext, unsigned int page) {
+  if (page >= m_pages.size()) {
+    ERROR("GeometryPool", "bind", "Invalid page " << page);
+    return false;
+  }
+  if (!track(page)) {
+    return false;
+  }
+  m_pages[page]->vertexBuffer.render(deviceContext, 0, 1);
+  m_pages[page]->indexBuffer.render(deviceContext, 0, 1, false, m_pages[page]->indexFormat);
+  return true;
+}
+
+unsigned int
+GeometryPool::defragment(float minFragmentation) {
+  if (!m_ready || m_pages.empty()) {
+    return 0;
+  }
+  // Una página por llamada: la más fragmentada, si vale la pena
+  unsigned int target = 0;
+  float worst = -1.0f;
+  for (unsigned int p = 0; p < m_pages.size(); ++p) {
+    const float fragmentation = getFragmentation(*m_pages[p]);
+    if (fragmentation > worst) {
+      worst = fragmentation;
+      target = p;
+    }
+  }
+  if (worst <= 0.0f || worst < minFragmentation) {
+    return 0;
+  }
+
+  Page& page = *m_pages[target];
+  const bool onGPU = page.vertexBuffer.getBuffer() != nullptr;
+  Buffer vertexBuffer;
+  Buffer indexBuffer;
+  if (onGPU) {
+    if (!m_deviceContext || !m_deviceContext->m_deviceContext) {
+      return 0;
+    }
+    // Si no hay memoria para la copia, la página se queda como está
+    HRESULT hr = createPageBuffers(page.vertices.getCapacity(), page.indices.getCapacity(), page.indexFormat,
+                                   vertexBuffer, indexBuffer);
+    if (FAILED(hr)) {
+      ERROR("GeometryPool", "defragment", "Failed to create the buffers to compact page " << target);
+      return 0;
+    }
+  }
+
+  std::vector<GeometryMove> vertexMoves;
+  std::vector<GeometryMove> indexMoves;
+  page.vertices.compact(vertexMoves);
+  page.indices.compact(indexMoves);
+
+  const unsigned int indexStride = MeshIndexing::getStride(page.indexFormat);
+  std::unordered_map<unsigned int, unsigned int> vertexOffsets;
+  std::unordered_map<unsigned int, unsigned int> indexOffsets;
+  unsigned int moved = 0;
+  unsigned long long movedBytes = 0;
+  for (const GeometryMove& move : vertexMoves) {
+    vertexOffsets[move.from] = move.to;
+    if (move.from != move.to) {
+      moved += move.size;
+      movedBytes += static_cast<unsigned long long>(move.size) * sizeof(SimpleVertex);
+    }
+  }
+  for (const GeometryMove& move : indexMoves) {
+    indexOffsets[move.from] = move.to;
+    if (move.from != move.to) {
+      moved += move.size;
+      movedBytes += static_cast<unsigned long long>(move.size) * indexStride;
+    }
+  }
+  for (Allocation& allocation : m_allocations) {
+    if (allocation.live && allocation.page == target) {
+      allocation.vertexOffset = vertexOffsets[allocation.vertexOffset];
+      allocation.indexOffset = indexOffsets[allocation.indexOffset];
+    }
+  }
+
+  if (onGPU) {
+    // Copio todo lo vivo (no solo lo que se movió) a los buffers nuevos
+    ID3D11DeviceContext* context = m_deviceContext->m_deviceContext;
+    auto copyRanges = [context](const std::vector<GeometryMove>& moves, unsigned int stride,
+                                Buffer& source, Buffer& destination) {
+      for (const GeometryMove& move : moves) {
+        D3D11_BOX box = {};
+        box.left = move.from * stride;
+        box.right = (move.from + move.size) * stride;
+        box.bottom = 1;
+        box.back = 1;
+        context->CopySubresourceRegion(destination.getBuffer(), 0, move.to * stride, 0, 0,
+                                       source.getBuffer(), 0, &box);
+      }
+    };
+    copyRanges(vertexMoves, sizeof(SimpleVertex), page.vertexBuffer, vertexBuffer);
+    copyRanges(indexMoves, indexStride, page.indexBuffer, indexBuffer);
+    page.vertexBuffer.destroy();
+    page.indexBuffer.destroy();
+    page.vertexBuffer = vertexBuffer;
+    page.indexBuffer = indexBuffer;
+    // La página ya vive en otros buffers: si era la vinculada hay que volver a vincularla
+    if (target == m_boundPage) {
+      invalidateBinding();
+    }
+  }
+
+  ++m_defragmentations;
+  m_movedBytes += movedBytes;
+  return moved;
+}
+
+GeometryPoolStats
+GeometryPool::getStats() {
+  GeometryPoolStats stats;
+  stats.pages = static_cast<unsigned int>(m_pages.size());
+  stats.meshes = m_numMeshes;
+  stats.binds = m_binds;
+  stats.bindsSkipped = m_bindsSkipped;
+  stats.defragmentations = m_defragmentations;
+  stats.movedBytes = m_movedBytes;
+  stats.stagingStalls = m_stagingStalls;
+  stats.indexBytes = m_indexBytes;
+  stats.indexBytesSaved = m_indexBytesSaved;
+
+  auto accumulate = [](GeometryAllocatorStats& total, const GeometryAllocatorStats& page) {
+    total.capacity += page.capacity;
+    total.used += page.used;
+    total.free += page.free;
+    total.allocations += page.allocations;
+    total.freeBlocks += page.freeBlocks;
+    total.largestFreeBlock = std::max(total.largestFreeBlock, page.largestFreeBlock);
+  };
+  for (auto& page : m_pages) {
+    stats.pages16 += page->indexFormat == DXGI_FORMAT_R16_UINT ? 1 : 0;
+    accumulate(stats.vertices, page->vertices.getStats());
+    accumulate(stats.indices, page->indices.getStats());
+  }
+  for (GeometryAllocatorStats* total : { &stats.vertices, &stats.indices }) {
+    total->fragmentation = total->free > 0 ? 1.0f - static_cast<float>(total->largestFreeBlock) / total->free : 0.0f;
+  }
+  return stats;
+}
+
+bool
+GeometryPool::allocateIn(Page& page, unsigned int vertexCount, unsigned int indexCount, Allocation& allocation) {
+  unsigned int vertexOffset = 0;
+  unsigned int indexOffset = 0;
+  if (!page.vertices.allocate(vertexCount, vertexOffset)) {
+    return false;
+  }
+  if (!page.indices.allocate(indexCount, indexOffset)) {
+    page.vertices.free(vertexOffset);
+    return false;
+  }
+  allocation.vertexOffset = vertexOffset;
+  allocation.vertexCount = vertexCount;
+  allocation.indexOffset = indexOffset;
+  allocation.indexCount = indexCount;
+  return true;
+}
+
+HRESULT
+GeometryPool::upload(Page& page, const Allocation& allocation, const MeshComponent& mesh) {
+  if (!m_deviceContext || !m_deviceContext->m_deviceContext) {
+    return E_FAIL;
+  }
+  const unsigned int indexStride = MeshIndexing::getStride(page.indexFormat);
+  const unsigned int vertexBytes = allocation.vertexCount * sizeof(SimpleVertex);
+  const unsigned int indexBytes = allocation.indexCount * indexStride;
+
+  // Escribo directo a la memoria mapeada: vértices y detrás los índices ya en el formato de la página
+  ID3D11DeviceContext* context = m_deviceContext->m_deviceContext;
+  D3D11_MAPPED_SUBRESOURCE mapped = {};
+  ID3D11Buffer* staging = nullptr;
+  HRESULT hr = mapStaging(vertexBytes + indexBytes, mapped, staging);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  unsigned char* destination = static_cast<unsigned char*>(mapped.pData);
+  memcpy(destination, mesh.m_vertex.data(), vertexBytes);
+  if (page.indexFormat == DXGI_FORMAT_R16_UINT) {
+    MeshIndexing::narrow(mesh.m_index.data(), allocation.indexCount,
+                         reinterpret_cast<unsigned short*>(destination + vertexBytes));
+  }
+  else {
+    memcpy(destination + vertexBytes, mesh.m_index.data(), indexBytes);
+  }
+  context->Unmap(staging, 0);
+
+  D3D11_BOX box = {};
+  box.bottom = 1;
+  box.back = 1;
+  box.left = 0;
+  box.right = vertexBytes;
+  context->CopySubresourceRegion(page.vertexBuffer.getBuffer(), 0, allocation.vertexOffset * sizeof(SimpleVertex),
+                                 0, 0, staging, 0, &box);
+  box.left = vertexBytes;
+  box.right = vertexBytes + indexBytes;
+  context->CopySubresourceRegion(page.indexBuffer.getBuffer(), 0, allocation.indexOffset * indexStride,
+                                 0, 0, staging, 0, &box);
+  return S_OK;
+}
+
+HRESULT
+GeometryPool::mapStaging(unsigned int bytes, D3D11_MAPPED_SUBRESOURCE& mapped, ID3D11Buffer*& staging) {
+  ID3D11DeviceContext* context = m_deviceContext->m_deviceContext;
+
+  // Empiezo por el slot que se usó hace más tiempo; si la GPU sigue copiando desde él, pruebo el siguiente
+  HRESULT hr = S_OK;
+  for (unsigned int i = 0; i < kGeometryStagingSlots; ++i) {
+    const unsigned int index = (m_stagingSlot + i) % kGeometryStagingSlots;
+    StagingSlot& slot = m_staging[index];
+    hr = reserveStaging(slot, bytes);
+    if (FAILED(hr)) {
+      return hr;
+    }
+    hr = context->Map(slot.buffer, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (SUCCEEDED(hr)) {
+      m_stagingSlot = (index + 1) % kGeometryStagingSlots;
+      staging = slot.buffer;
+      return S_OK;
+    }
+    if (hr != DXGI_ERROR_WAS_STILL_DRAWING) {
+      return hr;
+    }
+  }
+
+  // Todo el anillo está en uso: espero al más viejo, que es el primero en quedar libre
+  StagingSlot& slot = m_staging[m_stagingSlot];
+  ++m_stagingStalls;
+  hr = context->Map(slot.buffer, 0, D3D11_MAP_WRITE, 0, &mapped);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  staging = slot.buffer;
+  m_stagingSlot = (m_stagingSlot + 1) % kGeometryStagingSlots;
+  return S_OK;
+}
+
+HRESULT
+GeometryPool::reserveStaging(StagingSlot& slot, unsigned int bytes) {
+  if (slot.buffer && slot.bytes >= bytes) {
+    return S_OK;
+  }
+  // Crece al doble para no recrearlo con cada malla un poco más grande.
+  // El buffer viejo lo suelto ya: D3D lo destruye cuando la GPU termina de copiar desde él
+  D3D11_BUFFER_DESC desc = {};
+  desc.Usage = D3D11_USAGE_STAGING;
+  desc.ByteWidth = std::max(bytes, std::max(slot.bytes * 2, kGeometryStagingBytes));
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+  SAFE_RELEASE(slot.buffer);
+  slot.bytes = 0;
+  HRESULT hr = m_device->CreateBuffer(&desc, nullptr, &slot.buffer);
+  if (FAILED(hr)) {
+    ERROR("GeometryPool", "reserveStaging", "Failed to create a staging buffer of " << desc.ByteWidth << " bytes");
+    return hr;
+  }
+  slot.bytes = desc.ByteWidth;
+  return S_OK;
+}
+
+HRESULT
+GeometryPool::createPageBuffers(unsigned int vertexCapacity,
+                                unsigned int indexCapacity,
+                                DXGI_FORMAT indexFormat,
+                                Buffer& vertexBuffer,
+                                Buffer& indexBuffer) {
+  // Sin device la página solo lleva la cuenta (headless)
+  if (!m_device || !m_device->m_device) {
+    return S_OK;
+  }
+  HRESULT hr = vertexBuffer.init(*m_device, vertexCapacity, sizeof(SimpleVertex), D3D11_BIND_VERTEX_BUFFER);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = indexBuffer.init(*m_device, indexCapacity, MeshIndexing::getStride(indexFormat), D3D11_BIND_INDEX_BUFFER);
+  if (FAILED(hr)) {
+    vertexBuffer.destroy();
+    return hr;
+  }
+  return S_OK;
+}
+
+float
+GeometryPool::getFragmentation(Page& page) {
+  return std::max(page.vertices.getStats().fragmentation, page.indices.getStats().fragmentation);
+}
+
+namespace {
+
+  /**
+   * @brief Malla con `vertices` vértices y `indices` índices (el contenido no importa headless).
+   */
+  MeshComponent
+    makeMesh(unsigned int vertices, unsigned int indices) {
+    MeshComponent mesh;
+    mesh.m_vertex.resize(vertices);
+    mesh.m_index.resize(indices);
+    mesh.m_numVertex = static_cast<int>(vertices);
+    mesh.m_numIndex = static_cast<int>(indices);
+    return mesh;
+  }
+
+  /**
+   * @brief Verifico que los rangos vivos no se encimen ni se salgan de su página.
+   */
+  bool
+    rangesAreDisjoint(GeometryPool& pool, const std::vector<GeometryHandle>& handles,
+                      const std::vector<unsigned int>& vertexCounts, unsigned int pageVertices) {
+    // (página, inicio, fin) de vértices e índices
+    std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> vertexRanges;
+    std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> indexRanges;
+    for (unsigned int i = 0; i < handles.size(); ++i) {
+      if (!handles[i].isValid()) {
+        continue;
+      }
+      GeometryRange range;
+      if (!pool.resolve(handles[i], range)) {
+        return false;
+      }
+      const unsigned int start = static_cast<unsigned int>(range.baseVertex);
+      if (start + vertexCounts[i] > std::max(pageVertices, vertexCounts[i])) {
+        return false;
+      }
+      vertexRanges.emplace_back(range.page, start, start + vertexCounts[i]);
+      indexRanges.emplace_back(range.page, range.startIndex, range.startIndex + range.indexCount);
+    }
+    for (auto* ranges : { &vertexRanges, &indexRanges }) {
+      std::sort(ranges->begin(), ranges->end());
+      for (size_t i = 1; i < ranges->size(); ++i) {
+        const auto& a = (*ranges)[i - 1];
+        const auto& b = (*ranges)[i];
+        if (std::get<0>(a) == std::get<0>(b) && std::get<2>(a) > std::get<1>(b)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+void
+GeometryPool::runBenchmark(BenchmarkReport& report) {
+  const unsigned int pageVertices = kGeometryPageVertices;
+  const unsigned int pageIndices = kGeometryPageIndices;
+  GeometryPool pool;
+  pool.init(nullptr, nullptr, pageVertices, pageIndices);
+
+  // 50 modelos de 200 partes, de 60 a 1200 vértices por parte
+  const unsigned int models = 50;
+  const unsigned int parts = 200;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<unsigned int> partSize(60, 1200);
+  std::vector<MeshComponent> meshes;
+  meshes.reserve(models * parts);
+  for (unsigned int i = 0; i < models * parts; ++i) {
+    const unsigned int vertices = partSize(rng);
+    meshes.push_back(makeMesh(vertices, vertices * 3 / 2));
+  }
+  std::vector<unsigned int> vertexCounts(meshes.size());
+  for (unsigned int i = 0; i < meshes.size(); ++i) {
+    vertexCounts[i] = static_cast<unsigned int>(meshes[i].m_vertex.size());
+  }
+
+  std::vector<GeometryHandle> handles(meshes.size());
+  Timer timer;
+  for (unsigned int i = 0; i < meshes.size(); ++i) {
+    handles[i] = pool.allocate(meshes[i]);
+  }
+  const double allocateMs = timer.elapsedMs();
+  for (const GeometryHandle& handle : handles) {
+    if (!handle.isValid()) {
+      report.fail("a mesh could not be allocated from the pool");
+      break;
+    }
+  }
+
+  // Binds del IA por frame: el pool recuerda la página en todo el pass, así que solo cuenta
+  // cada cambio de página (también entre modelos) contra dos por parte
+  pool.beginPass();
+  unsigned int pooledBinds = 0;
+  unsigned int perModelBinds = 0;
+  for (unsigned int m = 0; m < models; ++m) {
+    unsigned int modelPage = 0xFFFFFFFF;
+    for (unsigned int p = 0; p < parts; ++p) {
+      GeometryRange range;
+      if (!pool.resolve(handles[m * parts + p], range)) {
+        continue;
+      }
+      pooledBinds += pool.track(range.page) ? 1 : 0;
+      if (range.page != modelPage) {
+        modelPage = range.page;
+        ++perModelBinds;
+      }
+    }
+  }
+  GeometryPoolStats stats = pool.getStats();
+  report.log("%u meshes in %u pages: %.2f ms (%.0f ns/mesh), %u GPU buffers instead of %u",
+             stats.meshes, stats.pages, allocateMs, allocateMs * 1.0e6 / meshes.size(),
+             stats.pages * 2, stats.meshes * 2);
+  report.log("IA binds per frame: %u pooled per pass (%u if tracked per model) vs %u with a buffer pair per mesh",
+             pooledBinds * 2, perModelBinds * 2, models * parts * 2);
+  if (pooledBinds > perModelBinds || stats.binds + stats.bindsSkipped != models * parts) {
+    report.fail("tracking the bound page across the pass doesn't skip repeated binds");
+  }
+  // Un pass nuevo vuelve a vincular aunque sea la misma página
+  pool.beginPass();
+  GeometryRange first;
+  if (!pool.resolve(handles[0], first) || !pool.track(first.page) || pool.track(first.page)) {
+    report.fail("beginPass should forget the bound page");
+  }
+  report.log("index data: %.1f MB in %u 16-bit pages, %.1f MB saved against 32-bit",
+             stats.indexBytes / (1024.0 * 1024.0), stats.pages16, stats.indexBytesSaved / (1024.0 * 1024.0));
+  if (!rangesAreDisjoint(pool, handles, vertexCounts, pageVertices)) {
+    report.fail("pooled ranges overlap after allocation");
+  }
+
+  // Churn: libero la mitad al azar y meto mallas de otros tamaños en los huecos
+  std::uniform_int_distribution<unsigned int> coin(0, 1);
+  unsigned int freed = 0;
+  for (GeometryHandle& handle : handles) {
+    if (coin(rng)) {
+      pool.free(handle);
+      ++freed;
+    }
+  }
+  std::uniform_int_distribution<unsigned int> smallSize(30, 400);
+  for (unsigned int i = 0; i < freed / 2; ++i) {
+    const unsigned int vertices = smallSize(rng);
+    meshes.push_back(makeMesh(vertices, vertices * 3 / 2));
+    vertexCounts.push_back(vertices);
+    handles.push_back(pool.allocate(meshes.back()));
+  }
+  stats = pool.getStats();
+  report.log("after freeing %u and adding %u: %u meshes, vertex fragmentation %.2f (%u holes), index fragmentation %.2f (%u holes)",
+             freed, freed / 2, stats.meshes, stats.vertices.fragmentation, stats.vertices.freeBlocks,
+             stats.indices.fragmentation, stats.indices.freeBlocks);
+  if (!rangesAreDisjoint(pool, handles, vertexCounts, pageVertices)) {
+    report.fail("pooled ranges overlap after churn");
+  }
+
+  // Desfragmento todas las páginas
+  timer.reset();
+  unsigned int moved = 0;
+  unsigned int passes = 0;
+  while (passes < stats.pages * 2) {
+    const unsigned int step = pool.defragment(0.0f);
+    if (step == 0) {
+      break;
+    }
+    moved += step;
+    ++passes;
+  }
+  const double defragMs = timer.elapsedMs();
+  const GeometryPoolStats compacted = pool.getStats();
+  report.log("defragment: %u pages in %.2f ms, %u elements moved (%.1f MB on GPU), %u vertex holes left",
+             compacted.defragmentations, defragMs, moved, compacted.movedBytes / (1024.0 * 1024.0),
+             compacted.vertices.freeBlocks);
+  if (compacted.vertices.freeBlocks > compacted.pages || compacted.indices.freeBlocks > compacted.pages) {
+    report.fail("pages still have holes after defragmenting");
+  }
+  if (compacted.meshes != stats.meshes || compacted.vertices.used != stats.vertices.used) {
+    report.fail("defragmenting changed the pooled meshes");
+  }
+  if (!rangesAreDisjoint(pool, handles, vertexCounts, pageVertices)) {
+    report.fail("pooled ranges overlap after defragmenting");
+  }
+
+  // Handles viejos: no resuelven y liberarlos otra vez no hace nada
+  GeometryHandle stale = handles[0];
+  pool.free(handles[0]);
+  GeometryRange range;
+  if (pool.resolve(stale, range)) {
+    report.fail("a freed handle still resolves");
+  }
+  const unsigned int meshesBefore = pool.getStats().meshes;
+  pool.free(stale);
+  if (pool.getStats().meshes != meshesBefore) {
+    report.fail("freeing a stale handle changed the pool");
+  }
+
+  // El asignador solo, con 200k operaciones al azar
+  GeometryAllocator allocator;
+  allocator.init(1u << 20);
+  std::vector<unsigned int> live;
+  std::uniform_int_distribution<unsigned int> opSize(1, 2048);
+  const unsigned int operations = 200000;
+  timer.reset();
+  for (unsigned int i = 0; i < operations; ++i) {
+    if (!live.empty() && (coin(rng) || allocator.getUsed() > (3u << 18))) {
+      const unsigned int victim = rng() % live.size();
+      allocator.free(live[victim]);
+      live[victim] = live.back();
+      live.pop_back();
+    }
+    else {
+      unsigned int offset = 0;
+      if (allocator.allocate(opSize(rng), offset)) {
+        live.push_back(offset);
+      }
+    }
+  }
+  const double churnMs = timer.elapsedMs();
+  const GeometryAllocatorStats allocatorStats = allocator.getStats();
+  report.log("allocator: %u ops in %.2f ms (%.0f ns/op), %u live, fragmentation %.2f (%u holes)",
+             operations, churnMs, churnMs * 1.0e6 / operations, allocatorStats.allocations,
+             allocatorStats.fragmentation, allocatorStats.freeBlocks);
+  if (allocatorStats.used + allocatorStats.free != allocatorStats.capacity ||
+      allocatorStats.allocations != live.size()) {
+    report.fail("allocator bookkeeping is inconsistent");
+  }
+  for (unsigned int offset : live) {
+    allocator.free(offset);
+  }
+  const GeometryAllocatorStats empty = allocator.getStats();
+  if (empty.used != 0 || empty.freeBlocks != 1 || empty.largestFreeBlock != empty.capacity) {
+    report.fail("freeing everything did not merge back into a single block");
+  }
+}
@@ -0,0 +1,1342 @@
+#include "GltfImporter.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+  const unsigned int kGlbMagic = 0x46546C67;      // "glTF"
+  const unsigned int kGlbChunkJson = 0x4E4F534A;  // "JSON"
+  const unsigned int kGlbChunkBin = 0x004E4942;   // "BIN\0"
+  const unsigned int kInvalid = 0xFFFFFFFF;
+
+  enum ComponentType {
+    COMPONENT_BYTE = 5120,
+    COMPONENT_UNSIGNED_BYTE = 5121,
+    COMPONENT_SHORT = 5122,
+    COMPONENT_UNSIGNED_SHORT = 5123,
+    COMPONENT_UNSIGNED_INT = 5125,
+    COMPONENT_FLOAT = 5126
+  };
+
+  /**
+   * @brief Archivo mapeado de solo lectura (se desmapea al destruirse).
+   */
+  class
+    MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile&
+      operator=(const MappedFile&) = delete;
+
+    bool
+      open(const std::string& path) {
+      close();
+#ifdef _WIN32
+      m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+      }
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+      }
+      m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      m_view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+      m_size = static_cast<size_t>(size.QuadPart);
+#else
+      m_file = ::open(path.c_str(), O_RDONLY);
+      if (m_file < 0) {
+        return false;
+      }
+      struct stat info;
+      if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+        close();
+        return false;
+      }
+      m_size = static_cast<size_t>(info.st_size);
+      m_view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+      if (m_view == MAP_FAILED) {
+        m_view = nullptr;
+      }
+#endif
+      if (m_view == nullptr) {
+        close();
+        return false;
+      }
+      return true;
+    }
+
+    void
+      close() {
+#ifdef _WIN32
+      if (m_view) {
+        UnmapViewOfFile(m_view);
+      }
+      if (m_mapping) {
+        CloseHandle(m_mapping);
+      }
+      if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+      }
+      m_mapping = nullptr;
+      m_file = INVALID_HANDLE_VALUE;
+#else
+      if (m_view) {
+        munmap(m_view, m_size);
+      }
+      if (m_file >= 0) {
+        ::close(m_file);
+      }
+      m_file = -1;
+#endif
+      m_view = nullptr;
+      m_size = 0;
+    }
+
+    const unsigned char*
+      data() const { return static_cast<const unsigned char*>(m_view); }
+
+    size_t
+      size() const { return m_size; }
+
+  private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+    void* m_view = nullptr;
+    size_t m_size = 0;
+  };
+
+  /**
+   * @brief Valor de JSON: un rango del texto y sus hijos como lista ligada (índices).
+   */
+  struct
+    JsonValue {
+    enum Type : unsigned char { JSON_NULL, JSON_FALSE, JSON_TRUE, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+    Type type = JSON_NULL;
+    /// @brief Texto del valor (los strings sin comillas ni escapes resueltos).
+    unsigned int begin = 0;
+    unsigned int end = 0;
+    /// @brief Nombre del miembro si el padre es un objeto.
+    unsigned int keyBegin = 0;
+    unsigned int keyEnd = 0;
+    unsigned int firstChild = kInvalid;
+    unsigned int next = kInvalid;
+    unsigned int count = 0;
+  };
+
+  /**
+   * @brief Parser de JSON en su lugar: no copia strings ni números, solo guarda rangos.
+   */
+  class
+    JsonDocument {
+  public:
+    bool
+      parse(const char* text, size_t size) {
+      m_text = text;
+      m_size = size;
+      m_pos = 0;
+      m_ok = size < kInvalid;
+      m_values.clear();
+      m_values.reserve(size / 8 + 16);
+      parseValue(0);
+      skipWhitespace();
+      return m_ok && m_pos == m_size;
+    }
+
+    const JsonValue*
+      root() const { return m_values.empty() ? nullptr : &m_values[0]; }
+
+    /// @brief Miembro de un objeto (o nullptr).
+    const JsonValue*
+      member(const JsonValue* object, const char* key) const {
+      if (!object || object->type != JsonValue::JSON_OBJECT) {
+        return nullptr;
+      }
+      const size_t length = std::strlen(key);
+      for (unsigned int i = object->firstChild; i != kInvalid; i = m_values[i].next) {
+        const JsonValue& value = m_values[i];
+        if (value.keyEnd - value.keyBegin == length && std::memcmp(m_text + value.keyBegin, key, length) == 0) {
+          return &value;
+        }
+      }
+      return nullptr;
+    }
+
+    /// @brief Elementos de un arreglo en orden (vacío si no es arreglo).
+    std::vector<const JsonValue*>
+      items(const JsonValue* array) const {
+      std::vector<const JsonValue*> out;
+      if (array && array->type == JsonValue::JSON_ARRAY) {
+        out.reserve(array->count);
+        for (unsigned int i = array->firstChild; i != kInvalid; i = m_values[i].next) {
+          out.push_back(&m_values[i]);
+        }
+      }
+      return out;
+    }
+
+    double
+      number(const JsonValue* value, double fallback) const {
+      if (!value || value->type != JsonValue::JSON_NUMBER || value->end - value->begin >= 64) {
+        return fallback;
+      }
+      char buffer[64];
+      std::memcpy(buffer, m_text + value->begin, value->end - value->begin);
+      buffer[value->end - value->begin] = '\0';
+      return std::strtod(buffer, nullptr);
+    }
+
+    /// @brief Entero no negativo; `kInvalid` si falta o no es válido.
+    unsigned int
+      index(const JsonValue* value) const {
+      const double n = number(value, -1.0);
+      return (n >= 0.0 && n < kInvalid && n == std::floor(n)) ? static_cast<unsigned int>(n) : kInvalid;
+    }
+
+    size_t
+      size(const JsonValue* value, size_t fallback) const {
+      const double n = number(value, -1.0);
+      return (n >= 0.0 && n == std::floor(n)) ? static_cast<size_t>(n) : fallback;
+    }
+
+    /// @brief Leo `count` números de un arreglo; false si no es un arreglo de ese tamaño.
+    bool
+      numbers(const JsonValue* array, float* out, unsigned int count) const {
+      if (!array || array->type != JsonValue::JSON_ARRAY || array->count != count) {
+        return false;
+      }
+      unsigned int k = 0;
+      for (unsigned int i = array->firstChild; i != kInvalid; i = m_values[i].next) {
+        out[k++] = static_cast<float>(number(&m_values[i], 0.0));
+      }
+      return true;
+    }
+
+    bool
+      boolean(const JsonValue* value) const { return value && value->type == JsonValue::JSON_TRUE; }
+
+    /// @brief String con los escapes resueltos (solo aquí copio texto).
+    std::string
+      string(const JsonValue* value) const {
+      std::string out;
+      if (!value || value->type != JsonValue::JSON_STRING) {
+        return out;
+      }
+      for (unsigned int i = value->begin; i < value->end; ++i) {
+        char c = m_text[i];
+        if (c == '\\' && i + 1 < value->end) {
+          c = m_text[++i];
+          switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u': {
+            // Solo ASCII; lo demás lo dejo como '?' (rutas y nombres casi nunca lo usan)
+            const unsigned long code = (i + 4 < value->end) ? std::strtoul(std::string(m_text + i + 1, 4).c_str(), nullptr, 16) : 0;
+            c = code < 0x80 ? static_cast<char>(code) : '?';
+            i += 4;
+            break;
+          }
+          default: break;
+          }
+        }
+        out.push_back(c);
+      }
+      return out;
+    }
+
+  private:
+    void
+      skipWhitespace() {
+      while (m_pos < m_size && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' ||
+                                m_text[m_pos] == '\t')) {
+        ++m_pos;
+      }
+    }
+
+    bool
+      expect(char c) {
+      skipWhitespace();
+      if (m_pos < m_size && m_text[m_pos] == c) {
+        ++m_pos;
+        return true;
+      }
+      m_ok = false;
+      return false;
+    }
+
+    /// @brief Rango de un string (m_pos apunta a la comilla inicial).
+    bool
+      parseString(unsigned int& begin, unsigned int& end) {
+      if (!expect('"')) {
+        return false;
+      }
+      begin = static_cast<unsigned int>(m_pos);
+      while (m_pos < m_size && m_text[m_pos] != '"') {
+        m_pos += (m_text[m_pos] == '\\') ? 2 : 1;
+      }
+      if (m_pos >= m_size) {
+        m_ok = false;
+        return false;
+      }
+      end = static_cast<unsigned int>(m_pos++);
+      return true;
+    }
+
+    unsigned int
+      parseValue(unsigned int depth) {
+      skipWhitespace();
+      if (!m_ok || m_pos >= m_size || depth > 64) {
+        m_ok = false;
+        return kInvalid;
+      }
+      const unsigned int self = static_cast<unsigned int>(m_values.size());
+      m_values.push_back(JsonValue());
+      const char c = m_text[m_pos];
+      if (c == '{' || c == '[') {
+        const bool isObject = c == '{';
+        m_values[self].type = isObject ? JsonValue::JSON_OBJECT : JsonValue::JSON_ARRAY;
+        ++m_pos;
+        skipWhitespace();
+        if (m_pos < m_size && m_text[m_pos] == (isObject ? '}' : ']')) {
+          ++m_pos;
+          return self;
+        }
+        unsigned int last = kInvalid;
+        for (;;) {
+          unsigned int keyBegin = 0;
+          unsigned int keyEnd = 0;
+          if (isObject && (!parseString(keyBegin, keyEnd) || !expect(':'))) {
+            return kInvalid;
+          }
+          const unsigned int child = parseValue(depth + 1);
+          if (child == kInvalid) {
+            return kInvalid;
+          }
+          m_values[child].keyBegin = keyBegin;
+          m_values[child].keyEnd = keyEnd;
+          if (last == kInvalid) {
+            m_values[self].firstChild = child;
+          }
+          else {
+            m_values[last].next = child;
+          }
+          last = child;
+          ++m_values[self].count;
+          skipWhitespace();
+          if (m_pos < m_size && m_text[m_pos] == ',') {
+            ++m_pos;
+            continue;
+          }
+          if (!expect(isObject ? '}' : ']')) {
+            return kInvalid;
+          }
+          return self;
+        }
+      }
+      if (c == '"') {
+        m_values[self].type = JsonValue::JSON_STRING;
+        unsigned int begin = 0;
+        unsigned int end = 0;
+        if (!parseString(begin, end)) {
+          return kInvalid;
+        }
+        m_values[self].begin = begin;
+        m_values[self].end = end;
+        return self;
+      }
+      const char* literals[3] = { "null", "false", "true" };
+      for (unsigned int i = 0; i < 3; ++i) {
+        const size_t length = std::strlen(literals[i]);
+        if (m_size - m_pos >= length && std::memcmp(m_text + m_pos, literals[i], length) == 0) {
+          m_values[self].type = static_cast<JsonValue::Type>(JsonValue::JSON_NULL + i);
+          m_pos += length;
+          return self;
+        }
+      }
+      m_values[self].type = JsonValue::JSON_NUMBER;
+      m_values[self].begin = static_cast<unsigned int>(m_pos);
+      bool digits = false;
+      while (m_pos < m_size && (std::strchr("+-.eE", m_text[m_pos]) || (m_text[m_pos] >= '0' && m_text[m_pos] <= '9'))) {
+        digits = digits || (m_text[m_pos] >= '0' && m_text[m_pos] <= '9');
+        ++m_pos;
+      }
+      m_values[self].end = static_cast<unsigned int>(m_pos);
+      if (!digits) {
+        m_ok = false;
+        return kInvalid;
+      }
+      return self;
+    }
+
+  private:
+    const char* m_text = nullptr;
+    size_t m_size = 0;
+    size_t m_pos = 0;
+    bool m_ok = false;
+    std::vector<JsonValue> m_values;
+  };
+
+  /**
+   * @brief Vista tipada sobre un arreglo con stride (lee sin copiar el arreglo).
+   */
+  template<typename T>
+  struct
+    StridedSpan {
+    const unsigned char* data = nullptr;
+    size_t count = 0;
+    size_t stride = sizeof(T);
+
+    T
+      operator[](size_t i) const {
+      T value;
+      std::memcpy(&value, data + i * stride, sizeof(T));
+      return value;
+    }
+  };
+
+  /**
+   * @brief Accessor resuelto: dónde empieza en la memoria mapeada, cuántos y cada cuánto.
+   */
+  struct
+    Accessor {
+    const unsigned char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    unsigned int componentType = 0;
+    unsigned int components = 0;
+    bool normalized = false;
+
+    /// @brief La vista directa si el formato es exactamente `T` (o una vacía).
+    template<typename T>
+    StridedSpan<T>
+      as(unsigned int type, unsigned int numComponents) const {
+      StridedSpan<T> span;
+      if (data && componentType == type && components == numComponents) {
+        span.data = data;
+        span.count = count;
+        span.stride = stride;
+      }
+      return span;
+    }
+
+    /// @brief Camino general: convierto `n` componentes del elemento `i` a float.
+    void
+      read(size_t i, float* out, unsigned int n) const {
+      const unsigned char* element = data ? data + i * stride : nullptr;
+      for (unsigned int c = 0; c < n; ++c) {
+        float value = 0.0f;
+        if (element && c < components) {
+          switch (componentType) {
+          case COMPONENT_FLOAT: std::memcpy(&value, element + c * 4, 4); break;
+          case COMPONENT_UNSIGNED_BYTE: value = element[c] * (normalized ? 1.0f / 255.0f : 1.0f); break;
+          case COMPONENT_BYTE: value = normalized ? std::max(static_cast<signed char>(element[c]) / 127.0f, -1.0f)
+                                                  : static_cast<signed char>(element[c]); break;
+          case COMPONENT_UNSIGNED_SHORT: {
+            unsigned short s;
+            std::memcpy(&s, element + c * 2, 2);
+            value = s * (normalized ? 1.0f / 65535.0f : 1.0f);
+            break;
+          }
+          case COMPONENT_SHORT: {
+            short s;
+            std::memcpy(&s, element + c * 2, 2);
+            value = normalized ? std::max(s / 32767.0f, -1.0f) : s;
+            break;
+          }
+          case COMPONENT_UNSIGNED_INT: {
+            unsigned int u;
+            std::memcpy(&u, element + c * 4, 4);
+            value = static_cast<float>(u);
+            break;
+          }
+          default: break;
+          }
+        }
+        out[c] = value;
+      }
+    }
+
+    unsigned int
+      readIndex(size_t i) const {
+      const unsigned char* element = data + i * stride;
+      if (componentType == COMPONENT_UNSIGNED_BYTE) {
+        return element[0];
+      }
+      if (componentType == COMPONENT_UNSIGNED_SHORT) {
+        unsigned short s;
+        std::memcpy(&s, element, 2);
+        return s;
+      }
+      unsigned int u;
+      std::memcpy(&u, element, 4);
+      return u;
+    }
+  };
+
+  struct
+    Primitive {
+    unsigned int position = kInvalid;
+    unsigned int normal = kInvalid;
+    unsigned int texcoord = kInvalid;
+    unsigned int tangent = kInvalid;
+    unsigned int indices = kInvalid;
+    unsigned int material = kInvalid;
+    bool triangles = true;
+  };
+
+  struct
+    Mesh {
+    std::string name;
+    std::vector<Primitive> primitives;
+  };
+
+  /// @brief Matriz 4x4 en columnas, como glTF: `m[column * 4 + row]`.
+  struct
+    Matrix4 {
+    float m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+  };
+
+  Matrix4
+    multiply(const Matrix4& a, const Matrix4& b) {
+    Matrix4 out;
+    for (unsigned int c = 0; c < 4; ++c) {
+      for (unsigned int r = 0; r < 4; ++r) {
+        float sum = 0.0f;
+        for (unsigned int k = 0; k < 4; ++k) {
+          sum += a.m[k * 4 + r] * b.m[c * 4 + k];
+        }
+        out.m[c * 4 + r] = sum;
+      }
+    }
+    return out;
+  }
+
+  /// @brief T * R * S (rotación como cuaternión x, y, z, w).
+  Matrix4
+    composeTRS(const float t[3], const float q[4], const float s[3]) {
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    const float rotation[3][3] = {
+      { 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w) },
+      { 2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w) },
+      { 2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y) }
+    };
+    Matrix4 out;
+    for (unsigned int c = 0; c < 3; ++c) {
+      for (unsigned int r = 0; r < 3; ++r) {
+        out.m[c * 4 + r] = rotation[r][c] * s[c];
+      }
+      out.m[12 + c] = t[c];
+    }
+    return out;
+  }
+
+  bool
+    isIdentity(const Matrix4& matrix) {
+    const Matrix4 identity;
+    return std::memcmp(matrix.m, identity.m, sizeof(identity.m)) == 0;
+  }
+
+  GltfFloat3
+    column(const Matrix4& matrix, unsigned int c) {
+    return { matrix.m[c * 4], matrix.m[c * 4 + 1], matrix.m[c * 4 + 2] };
+  }
+
+  GltfFloat3
+    cross(const GltfFloat3& a, const GltfFloat3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+  }
+
+  GltfFloat3
+    normalize(const GltfFloat3& a) {
+    const float length = std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+    return length > 0.0f ? GltfFloat3{ a.x / length, a.y / length, a.z / length } : a;
+  }
+
+  /// @brief `a * x + b * y + c * z`.
+  GltfFloat3
+    combine(const GltfFloat3& a, const GltfFloat3& b, const GltfFloat3& c, const GltfFloat3& v) {
+    return { a.x * v.x + b.x * v.y + c.x * v.z, a.y * v.x + b.y * v.y + c.y * v.z,
+             a.z * v.x + b.z * v.y + c.z * v.z };
+  }
+
+  /**
+   * @brief Una primitiva de una instancia de nodo, lista para convertirse en un job.
+   */
+  struct
+    PrimitiveJob {
+    const Primitive* primitive = nullptr;
+    std::string name;
+    Matrix4 world;
+  };
+
+  /// @brief Resuelvo los `%XX` de una URI relativa.
+  std::string
+    decodeUri(const std::string& uri) {
+    std::string out;
+    for (size_t i = 0; i < uri.size(); ++i) {
+      if (uri[i] == '%' && i + 2 < uri.size()) {
+        out.push_back(static_cast<char>(std::strtoul(uri.substr(i + 1, 2).c_str(), nullptr, 16)));
+        i += 2;
+      }
+      else {
+        out.push_back(uri[i]);
+      }
+    }
+    return out;
+  }
+
+  bool
+    decodeBase64(const char* text, size_t size, std::vector<unsigned char>& out) {
+    unsigned int accumulator = 0;
+    int bits = 0;
+    out.reserve(size * 3 / 4);
+    for (size_t i = 0; i < size; ++i) {
+      const char c = text[i];
+      int value;
+      if (c >= 'A' && c <= 'Z') value = c - 'A';
+      else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+      else if (c >= '0' && c <= '9') value = c - '0' + 52;
+      else if (c == '+') value = 62;
+      else if (c == '/') value = 63;
+      else if (c == '=') break;
+      else return false;
+      accumulator = (accumulator << 6) | static_cast<unsigned int>(value);
+      bits += 6;
+      if (bits >= 8) {
+        bits -= 8;
+        out.push_back(static_cast<unsigned char>(accumulator >> bits));
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Convierto una primitiva a `GltfMesh` (corre dentro de un job).
+   */
+  bool
+    convertPrimitive(const PrimitiveJob& job,
+                     const std::vector<Accessor>& accessors,
+                     const GltfImportSettings& settings,
+                     GltfMesh& mesh,
+                     bool& generatedTangents) {
+    const Primitive& primitive = *job.primitive;
+    const Accessor& positions = accessors[primitive.position];
+    const size_t count = positions.count;
+    mesh.name = job.name;
+    mesh.vertices.assign(count, GltfVertex());
+
+    // Rápido: si el formato coincide con `GltfVertex` leo directo de la vista con stride
+    const StridedSpan<GltfFloat3> position = positions.as<GltfFloat3>(COMPONENT_FLOAT, 3);
+    for (size_t i = 0; i < count; ++i) {
+      if (position.data) {
+        mesh.vertices[i].position = position[i];
+      }
+      else {
+        positions.read(i, &mesh.vertices[i].position.x, 3);
+      }
+    }
+    const bool hasNormals = primitive.normal != kInvalid && accessors[primitive.normal].count == count;
+    if (hasNormals) {
+      const Accessor& normals = accessors[primitive.normal];
+      const StridedSpan<GltfFloat3> normal = normals.as<GltfFloat3>(COMPONENT_FLOAT, 3);
+      for (size_t i = 0; i < count; ++i) {
+        if (normal.data) {
+          mesh.vertices[i].normal = normal[i];
+        }
+        else {
+          normals.read(i, &mesh.vertices[i].normal.x, 3);
+        }
+      }
+    }
+    if (primitive.texcoord != kInvalid && accessors[primitive.texcoord].count == count) {
+      // glTF ya tiene el origen de UV arriba a la izquierda, como Direct3D
+      const Accessor& texcoords = accessors[primitive.texcoord];
+      const StridedSpan<GltfFloat2> texcoord = texcoords.as<GltfFloat2>(COMPONENT_FLOAT, 2);
+      for (size_t i = 0; i < count; ++i) {
+        if (texcoord.data) {
+          mesh.vertices[i].texcoord = texcoord[i];
+        }
+        else {
+          texcoords.read(i, &mesh.vertices[i].texcoord.x, 2);
+        }
+      }
+    }
+    const bool hasTangents = hasNormals && primitive.tangent != kInvalid && accessors[primitive.tangent].count == count;
+    if (hasTangents) {
+      const Accessor& tangents = accessors[primitive.tangent];
+      const StridedSpan<GltfFloat4> tangent = tangents.as<GltfFloat4>(COMPONENT_FLOAT, 4);
+      for (size_t i = 0; i < count; ++i) {
+        if (tangent.data) {
+          mesh.vertices[i].tangent = tangent[i];
+        }
+        else {
+          tangents.read(i, &mesh.vertices[i].tangent.x, 4);
+        }
+      }
+    }
+
+    // Triángulos en el winding del archivo (sin índices: cada tres vértices)
+    if (primitive.indices != kInvalid) {
+      const Accessor& indices = accessors[primitive.indices];
+      const size_t numIndices = indices.count - indices.count % 3;
+      mesh.indices.resize(numIndices);
+      const StridedSpan<unsigned int> index32 = indices.as<unsigned int>(COMPONENT_UNSIGNED_INT, 1);
+      for (size_t i = 0; i < numIndices; ++i) {
+        const unsigned int index = index32.data ? index32[i] : indices.readIndex(i);
+        if (index >= count) {
+          return false;
+        }
+        mesh.indices[i] = index;
+      }
+    }
+    else {
+      mesh.indices.resize(count - count % 3);
+      for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        mesh.indices[i] = static_cast<unsigned int>(i);
+      }
+    }
+
+    // Base tangente en el espacio y el winding del archivo (lo que espera un normal map horneado)
+    generatedTangents = !hasTangents;
+    if (generatedTangents && settings.generateTangents) {
+      settings.generateTangents(mesh);
+    }
+
+    // Horneo la transformación del nodo; las normales van con la inversa transpuesta
+    bool mirrored = false;
+    if (!isIdentity(job.world)) {
+      const GltfFloat3 a0 = column(job.world, 0), a1 = column(job.world, 1), a2 = column(job.world, 2);
+      const GltfFloat3 translation = column(job.world, 3);
+      const GltfFloat3 c0 = cross(a1, a2), c1 = cross(a2, a0), c2 = cross(a0, a1);
+      const float determinant = a0.x * c0.x + a0.y * c0.y + a0.z * c0.z;
+      mirrored = determinant < 0.0f;
+      const float normalSign = mirrored ? -1.0f : 1.0f;
+      for (GltfVertex& v : mesh.vertices) {
+        const GltfFloat3 p = combine(a0, a1, a2, v.position);
+        v.position = { p.x + translation.x, p.y + translation.y, p.z + translation.z };
+        const GltfFloat3 n = normalize(combine(c0, c1, c2, v.normal));
+        v.normal = { n.x * normalSign, n.y * normalSign, n.z * normalSign };
+        const GltfFloat3 t = normalize(combine(a0, a1, a2, GltfFloat3{ v.tangent.x, v.tangent.y, v.tangent.z }));
+        v.tangent = { t.x, t.y, t.z, v.tangent.w * normalSign };
+      }
+    }
+
+    // Direct3D: igual que con FBX, invierto el winding (un espejo ya lo invirtió)
+    if (!mirrored) {
+      for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+      }
+    }
+    return true;
+  }
+}
+
+bool
+GltfImporter::load(const std::string& path,
+                   std::vector<GltfMesh>& meshes,
+                   std::vector<std::string>& textures,
+                   const GltfImportSettings& settings,
+                   GltfImportStats* stats) {
+  // Sin el log del motor: el motivo se regresa en las estadísticas
+  auto fail = [stats, &path](const std::string& message) {
+    if (stats) {
+      stats->error = message + " (" + path + ")";
+    }
+    return false;
+  };
+  MappedFile file;
+  if (!file.open(path)) {
+    return fail("Can't map the file");
+  }
+  GltfImportStats result;
+  result.fileBytes = file.size();
+
+  // GLB: cabecera de 12 bytes, chunk JSON y chunk BIN opcional. Si no, el archivo es el JSON
+  const char* json = reinterpret_cast<const char*>(file.data());
+  size_t jsonSize = file.size();
+  const unsigned char* binChunk = nullptr;
+  size_t binSize = 0;
+  unsigned int magic = 0;
+  if (file.size() >= 4) {
+    std::memcpy(&magic, file.data(), 4);
+  }
+  if (magic == kGlbMagic) {
+    unsigned int header[5] = {};
+    if (file.size() < sizeof(header)) {
+      return fail("Truncated GLB");
+    }
+    std::memcpy(header, file.data(), sizeof(header));
+    if (header[1] != 2 || header[2] > file.size() || header[4] != kGlbChunkJson || header[3] > header[2] - 20) {
+      return fail("Invalid or truncated GLB");
+    }
+    json = reinterpret_cast<const char*>(file.data() + 20);
+    jsonSize = header[3];
+    size_t offset = (20 + static_cast<size_t>(header[3]) + 3) & ~static_cast<size_t>(3);
+    if (offset + 8 <= header[2]) {
+      unsigned int chunk[2];
+      std::memcpy(chunk, file.data() + offset, sizeof(chunk));
+      if (chunk[1] == kGlbChunkBin && chunk[0] <= header[2] - offset - 8) {
+        binChunk = file.data() + offset + 8;
+        binSize = chunk[0];
+      }
+    }
+  }
+
+  JsonDocument document;
+  if (!document.parse(json, jsonSize)) {
+    return fail("Invalid JSON");
+  }
+  const JsonValue* root = document.root();
+  const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+  // Buffers: el chunk BIN, .bin externos mapeados o URIs base64 (las únicas que copio)
+  struct BufferRange {
+    const unsigned char* data;
+    size_t size;
+  };
+  std::vector<BufferRange> buffers;
+  std::vector<std::unique_ptr<MappedFile>> externalFiles;
+  std::vector<std::vector<unsigned char>> decoded;
+  for (const JsonValue* buffer : document.items(document.member(root, "buffers"))) {
+    const size_t byteLength = document.size(document.member(buffer, "byteLength"), 0);
+    const JsonValue* uriValue = document.member(buffer, "uri");
+    BufferRange range = { nullptr, 0 };
+    if (!uriValue) {
+      range = { binChunk, binSize };
+    }
+    else {
+      const std::string uri = document.string(uriValue);
+      if (uri.compare(0, 5, "data:") == 0) {
+        const size_t comma = uri.find(',');
+        decoded.push_back(std::vector<unsigned char>());
+        if (comma == std::string::npos || !decodeBase64(uri.c_str() + comma + 1, uri.size() - comma - 1, decoded.back())) {
+          return fail("Invalid data URI");
+        }
+        range = { decoded.back().data(), decoded.back().size() };
+      }
+      else {
+        externalFiles.push_back(std::unique_ptr<MappedFile>(new MappedFile()));
+        if (!externalFiles.back()->open(directory + decodeUri(uri))) {
+          return fail("Can't map buffer " + uri);
+        }
+        range = { externalFiles.back()->data(), externalFiles.back()->size() };
+        result.fileBytes += range.size;
+      }
+    }
+    if (range.data == nullptr || range.size < byteLength) {
+      return fail("Buffer " + std::to_string(buffers.size()) + " is missing or truncated");
+    }
+    range.size = byteLength;
+    buffers.push_back(range);
+  }
+
+  // Buffer views y accessors: valido los rangos una vez; después se leen sin checar
+  struct View {
+    const unsigned char* data;
+    size_t size;
+    size_t stride;
+  };
+  std::vector<View> views;
+  for (const JsonValue* view : document.items(document.member(root, "bufferViews"))) {
+    const unsigned int buffer = document.index(document.member(view, "buffer"));
+    const size_t offset = document.size(document.member(view, "byteOffset"), 0);
+    const size_t length = document.size(document.member(view, "byteLength"), 0);
+    if (buffer >= buffers.size() || offset > buffers[buffer].size || length > buffers[buffer].size - offset) {
+      return fail("Buffer view " + std::to_string(views.size()) + " is out of range");
+    }
+    views.push_back({ buffers[buffer].data + offset, length, document.size(document.member(view, "byteStride"), 0) });
+  }
+  std::vector<Accessor> accessors;
+  for (const JsonValue* value : document.items(document.member(root, "accessors"))) {
+    Accessor accessor;
+    accessor.componentType = document.index(document.member(value, "componentType"));
+    accessor.count = document.size(document.member(value, "count"), 0);
+    accessor.normalized = document.boolean(document.member(value, "normalized"));
+    const std::string type = document.string(document.member(value, "type"));
+    accessor.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+    unsigned int componentSize = 0;
+    switch (accessor.componentType) {
+    case COMPONENT_BYTE: case COMPONENT_UNSIGNED_BYTE: componentSize = 1; break;
+    case COMPONENT_SHORT: case COMPONENT_UNSIGNED_SHORT: componentSize = 2; break;
+    case COMPONENT_UNSIGNED_INT: case COMPONENT_FLOAT: componentSize = 4; break;
+    default: break;
+    }
+    if (document.member(value, "sparse")) {
+      return fail("Sparse accessors are not supported");
+    }
+    const size_t elementSize = static_cast<size_t>(componentSize) * accessor.components;
+    const unsigned int viewIndex = document.index(document.member(value, "bufferView"));
+    if (viewIndex != kInvalid && elementSize > 0) {
+      // Sin buffer view el accessor es todo ceros (`data` queda nulo)
+      if (viewIndex >= views.size()) {
+        return fail("Accessor " + std::to_string(accessors.size()) + " has an invalid buffer view");
+      }
+      const View& view = views[viewIndex];
+      const size_t offset = document.size(document.member(value, "byteOffset"), 0);
+      accessor.stride = view.stride ? view.stride : elementSize;
+      const size_t needed = accessor.count == 0 ? 0 : (accessor.count - 1) * accessor.stride + elementSize;
+      if (accessor.stride < elementSize || offset > view.size || needed > view.size - offset) {
+        return fail("Accessor " + std::to_string(accessors.size()) + " is out of range");
+      }
+      accessor.data = view.data + offset;
+    }
+    accessors.push_back(accessor);
+  }
+
+  // Mallas y materiales (textura base color de cada material)
+  std::vector<std::string> materialTextures;
+  {
+    const std::vector<const JsonValue*> textureList = document.items(document.member(root, "textures"));
+    const std::vector<const JsonValue*> images = document.items(document.member(root, "images"));
+    for (const JsonValue* material : document.items(document.member(root, "materials"))) {
+      const JsonValue* pbr = document.member(material, "pbrMetallicRoughness");
+      const unsigned int texture = document.index(document.member(document.member(pbr, "baseColorTexture"), "index"));
+      const unsigned int image = texture < textureList.size() ? document.index(document.member(textureList[texture], "source"))
+                                                              : kInvalid;
+      materialTextures.push_back(image < images.size() ? decodeUri(document.string(document.member(images[image], "uri")))
+                                                       : std::string());
+    }
+  }
+  std::vector<Mesh> meshList;
+  for (const JsonValue* value : document.items(document.member(root, "meshes"))) {
+    Mesh mesh;
+    mesh.name = document.string(document.member(value, "name"));
+    if (mesh.name.empty()) {
+      mesh.name = "mesh" + std::to_string(meshList.size());
+    }
+    for (const JsonValue* primitiveValue : document.items(document.member(value, "primitives"))) {
+      const JsonValue* attributes = document.member(primitiveValue, "attributes");
+      Primitive primitive;
+      primitive.position = document.index(document.member(attributes, "POSITION"));
+      primitive.normal = document.index(document.member(attributes, "NORMAL"));
+      primitive.texcoord = document.index(document.member(attributes, "TEXCOORD_0"));
+      primitive.tangent = document.index(document.member(attributes, "TANGENT"));
+      primitive.indices = document.index(document.member(primitiveValue, "indices"));
+      primitive.material = document.index(document.member(primitiveValue, "material"));
+      const JsonValue* mode = document.member(primitiveValue, "mode");
+      primitive.triangles = !mode || document.index(mode) == 4;
+      const unsigned int used[5] = { primitive.position, primitive.normal, primitive.texcoord, primitive.tangent,
+                                     primitive.indices };
+      for (unsigned int a : used) {
+        if (a != kInvalid && a >= accessors.size()) {
+          return fail("Mesh " + mesh.name + " uses an invalid accessor");
+        }
+      }
+      if (primitive.position == kInvalid ||
+          (primitive.indices != kInvalid && (accessors[primitive.indices].components != 1 ||
+                                             accessors[primitive.indices].data == nullptr ||
+                                             accessors[primitive.indices].componentType == COMPONENT_FLOAT))) {
+        return fail("Mesh " + mesh.name + " has no positions or invalid indices");
+      }
+      mesh.primitives.push_back(primitive);
+    }
+    meshList.push_back(mesh);
+  }
+
+  // Nodos de la escena: recorro el árbol con una pila y acumulo las matrices
+  const std::vector<const JsonValue*> nodes = document.items(document.member(root, "nodes"));
+  std::vector<unsigned int> roots;
+  const std::vector<const JsonValue*> scenes = document.items(document.member(root, "scenes"));
+  if (!scenes.empty()) {
+    unsigned int scene = document.index(document.member(root, "scene"));
+    scene = scene < scenes.size() ? scene : 0;
+    for (const JsonValue* node : document.items(document.member(scenes[scene], "nodes"))) {
+      roots.push_back(document.index(node));
+    }
+  }
+  else {
+    // Sin escenas: todos los nodos que no son hijos de nadie
+    std::vector<unsigned char> isChild(nodes.size(), 0);
+    for (const JsonValue* node : nodes) {
+      for (const JsonValue* child : document.items(document.member(node, "children"))) {
+        const unsigned int c = document.index(child);
+        if (c < nodes.size()) {
+          isChild[c] = 1;
+        }
+      }
+    }
+    for (unsigned int n = 0; n < nodes.size(); ++n) {
+      if (!isChild[n]) {
+        roots.push_back(n);
+      }
+    }
+  }
+  std::vector<PrimitiveJob> jobs;
+  std::vector<std::pair<unsigned int, Matrix4>> stack;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    stack.push_back(std::make_pair(*it, Matrix4()));
+  }
+  while (!stack.empty()) {
+    const unsigned int n = stack.back().first;
+    const Matrix4 parent = stack.back().second;
+    stack.pop_back();
+    // Un nodo visitado más veces que el número de nodos solo puede venir de un ciclo
+    if (n >= nodes.size() || ++result.nodes > nodes.size() * 4 + 16) {
+      return fail("Invalid node hierarchy");
+    }
+    const JsonValue* node = nodes[n];
+    Matrix4 local;
+    if (!document.numbers(document.member(node, "matrix"), local.m, 16)) {
+      float t[3] = { 0, 0, 0 };
+      float q[4] = { 0, 0, 0, 1 };
+      float s[3] = { 1, 1, 1 };
+      document.numbers(document.member(node, "translation"), t, 3);
+      document.numbers(document.member(node, "rotation"), q, 4);
+      document.numbers(document.member(node, "scale"), s, 3);
+      local = composeTRS(t, q, s);
+    }
+    const Matrix4 world = multiply(parent, local);
+    const unsigned int meshIndex = document.index(document.member(node, "mesh"));
+    if (meshIndex < meshList.size()) {
+      const Mesh& mesh = meshList[meshIndex];
+      for (size_t p = 0; p < mesh.primitives.size(); ++p) {
+        if (!mesh.primitives[p].triangles) {
+          ++result.skippedPrimitives;
+          continue;
+        }
+        PrimitiveJob job;
+        job.primitive = &mesh.primitives[p];
+        job.name = mesh.primitives.size() > 1 ? mesh.name + "_" + std::to_string(p) : mesh.name;
+        job.world = world;
+        jobs.push_back(job);
+      }
+    }
+    const std::vector<const JsonValue*> children = document.items(document.member(node, "children"));
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
+      stack.push_back(std::make_pair(document.index(*it), world));
+    }
+  }
+
+  // Una primitiva por job; la memoria mapeada sigue viva hasta que terminan todos
+  std::vector<GltfMesh> converted(jobs.size());
+  std::vector<unsigned char> ok(jobs.size(), 0);
+  std::vector<unsigned char> generated(jobs.size(), 0);
+  auto convertRange = [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      bool generatedTangents = false;
+      ok[j] = convertPrimitive(jobs[j], accessors, settings, converted[j], generatedTangents) ? 1 : 0;
+      generated[j] = generatedTangents ? 1 : 0;
+    }
+  };
+  if (settings.parallelFor) {
+    settings.parallelFor(jobs.size(), convertRange);
+  }
+  else {
+    convertRange(0, jobs.size());
+  }
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    if (!ok[j]) {
+      return fail("Primitive " + jobs[j].name + " has an index out of range");
+    }
+    result.primitives++;
+    result.vertices += static_cast<unsigned int>(converted[j].vertices.size());
+    result.triangles += static_cast<unsigned int>(converted[j].indices.size() / 3);
+    result.generatedTangents += generated[j];
+    const unsigned int material = jobs[j].primitive->material;
+    if (material < materialTextures.size() && !materialTextures[material].empty() &&
+        std::find(textures.begin(), textures.end(), materialTextures[material]) == textures.end()) {
+      textures.push_back(materialTextures[material]);
+    }
+  }
+  meshes.reserve(meshes.size() + converted.size());
+  for (GltfMesh& mesh : converted) {
+    meshes.push_back(std::move(mesh));
+  }
+  if (stats) {
+    *stats = result;
+  }
+  return true;
+}
+
+bool
+GltfImporter::writeGlb(const std::string& path, const std::vector<GltfMesh>& meshes) {
+  // BIN: por malla, los vértices tal cual (`GltfVertex` intercalado) y los índices
+  std::vector<unsigned char> bin;
+  std::ostringstream views;
+  std::ostringstream accessors;
+  std::ostringstream meshList;
+  std::ostringstream nodeList;
+  std::ostringstream sceneNodes;
+  unsigned int viewCount = 0;
+  unsigned int accessorCount = 0;
+  for (size_t m = 0; m < meshes.size(); ++m) {
+    const GltfMesh& mesh = meshes[m];
+    const size_t vertexOffset = bin.size();
+    const size_t vertexBytes = mesh.vertices.size() * sizeof(GltfVertex);
+    bin.resize(vertexOffset + vertexBytes);
+    if (vertexBytes > 0) {
+      std::memcpy(bin.data() + vertexOffset, mesh.vertices.data(), vertexBytes);
+    }
+    // Índices en el winding de glTF (deshago la inversión de `load`), de 16 bits si caben
+    std::vector<unsigned int> indices(mesh.indices.begin(), mesh.indices.end());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      std::swap(indices[i + 1], indices[i + 2]);
+    }
+    const bool narrow = indices.empty() || *std::max_element(indices.begin(), indices.end()) <= 0xFFFF;
+    const size_t indexOffset = bin.size();
+    bin.resize(indexOffset + indices.size() * (narrow ? 2 : 4));
+    if (narrow) {
+      for (size_t i = 0; i < indices.size(); ++i) {
+        const unsigned short index = static_cast<unsigned short>(indices[i]);
+        std::memcpy(bin.data() + indexOffset + i * 2, &index, 2);
+      }
+    }
+    else if (!indices.empty()) {
+      std::memcpy(bin.data() + indexOffset, indices.data(), indices.size() * 4);
+    }
+    bin.resize((bin.size() + 3) & ~static_cast<size_t>(3), 0);
+
+    float minimum[3] = { 0, 0, 0 };
+    float maximum[3] = { 0, 0, 0 };
+    for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+      const float p[3] = { mesh.vertices[v].position.x, mesh.vertices[v].position.y, mesh.vertices[v].position.z };
+      for (unsigned int c = 0; c < 3; ++c) {
+        minimum[c] = v == 0 ? p[c] : std::min(minimum[c], p[c]);
+        maximum[c] = v == 0 ? p[c] : std::max(maximum[c], p[c]);
+      }
+    }
+    views << (viewCount ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << vertexOffset << ",\"byteLength\":" << vertexBytes
+          << ",\"byteStride\":" << sizeof(GltfVertex) << ",\"target\":34962},"
+          << "{\"buffer\":0,\"byteOffset\":" << indexOffset << ",\"byteLength\":" << indices.size() * (narrow ? 2 : 4)
+          << ",\"target\":34963}";
+    const size_t count = mesh.vertices.size();
+    accessors << (accessorCount ? "," : "") << std::setprecision(9)
+              << "{\"bufferView\":" << viewCount << ",\"byteOffset\":" << offsetof(GltfVertex, position)
+              << ",\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\",\"min\":[" << minimum[0] << ","
+              << minimum[1] << "," << minimum[2] << "],\"max\":[" << maximum[0] << "," << maximum[1] << "," << maximum[2]
+              << "]},"
+              << "{\"bufferView\":" << viewCount << ",\"byteOffset\":" << offsetof(GltfVertex, normal)
+              << ",\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+              << "{\"bufferView\":" << viewCount << ",\"byteOffset\":" << offsetof(GltfVertex, texcoord)
+              << ",\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC2\"},"
+              << "{\"bufferView\":" << viewCount << ",\"byteOffset\":" << offsetof(GltfVertex, tangent)
+              << ",\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC4\"},"
+              << "{\"bufferView\":" << viewCount + 1 << ",\"componentType\":" << (narrow ? 5123 : 5125)
+              << ",\"count\":" << indices.size() << ",\"type\":\"SCALAR\"}";
+    // Escapo solo lo necesario del nombre
+    std::string name;
+    for (char c : mesh.name) {
+      if (c == '"' || c == '\\') {
+        name.push_back('\\');
+      }
+      name.push_back(static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+    }
+    meshList << (m ? "," : "") << "{\"name\":\"" << name << "\",\"primitives\":[{\"attributes\":{\"POSITION\":"
+             << accessorCount << ",\"NORMAL\":" << accessorCount + 1 << ",\"TEXCOORD_0\":" << accessorCount + 2
+             << ",\"TANGENT\":" << accessorCount + 3 << "},\"indices\":" << accessorCount + 4 << "}]}";
+    nodeList << (m ? "," : "") << "{\"mesh\":" << m << "}";
+    sceneNodes << (m ? "," : "") << m;
+    viewCount += 2;
+    accessorCount += 5;
+  }
+  std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"UltimateReaverEngine\"},\"scene\":0,"
+                     "\"scenes\":[{\"nodes\":[" + sceneNodes.str() + "]}],\"nodes\":[" + nodeList.str() +
+                     "],\"meshes\":[" + meshList.str() + "],\"accessors\":[" + accessors.str() +
+                     "],\"bufferViews\":[" + views.str() + "],\"buffers\":[{\"byteLength\":" +
+                     std::to_string(bin.size()) + "}]}";
+  json.resize((json.size() + 3) & ~static_cast<size_t>(3), ' ');
+
+  const unsigned int jsonChunk[2] = { static_cast<unsigned int>(json.size()), kGlbChunkJson };
+  const unsigned int binChunk[2] = { static_cast<unsigned int>(bin.size()), kGlbChunkBin };
+  const unsigned int header[3] = { kGlbMagic, 2, static_cast<unsigned int>(12 + 8 + json.size() + 8 + bin.size()) };
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(jsonChunk), sizeof(jsonChunk));
+  file.write(json.data(), json.size());
+  file.write(reinterpret_cast<const char*>(binChunk), sizeof(binChunk));
+  file.write(reinterpret_cast<const char*>(bin.data()), bin.size());
+  return static_cast<bool>(file);
+}
+
+namespace {
+
+  /**
+   * @brief Terreno de prueba con normales y tangentes (como quedaría después de importar).
+   */
+  GltfMesh
+    makeTerrain(unsigned int side, float seed) {
+    GltfMesh mesh;
+    mesh.name = "terrain" + std::to_string(static_cast<int>(seed * 100.0f));
+    for (unsigned int z = 0; z < side; ++z) {
+      for (unsigned int x = 0; x < side; ++x) {
+        // Altura y sus derivadas analíticas: la normal y la tangente (+u = +x) salen de ellas
+        const float dx = std::cos(x * 0.21f + seed) * 0.42f;
+        const float dz = -std::sin(z * 0.17f - seed) * 0.255f;
+        GltfVertex v = {};
+        v.position = { static_cast<float>(x), std::sin(x * 0.21f + seed) * 2.0f + std::cos(z * 0.17f - seed) * 1.5f,
+                       static_cast<float>(z) };
+        v.texcoord = { x / static_cast<float>(side - 1), z / static_cast<float>(side - 1) };
+        v.normal = normalize({ -dx, 1.0f, -dz });
+        const GltfFloat3 tangent = normalize({ 1.0f, dx, 0.0f });
+        v.tangent = { tangent.x, tangent.y, tangent.z, 1.0f };
+        mesh.vertices.push_back(v);
+      }
+    }
+    for (unsigned int z = 0; z + 1 < side; ++z) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = z * side + x;
+        const unsigned int quad[6] = { i, i + 1, i + side, i + 1, i + side + 1, i + side };
+        mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+      }
+    }
+    return mesh;
+  }
+
+  bool
+    near(const GltfFloat3& a, const GltfFloat3& b) {
+    return std::fabs(a.x - b.x) < 1.0e-5f && std::fabs(a.y - b.y) < 1.0e-5f && std::fabs(a.z - b.z) < 1.0e-5f;
+  }
+}
+
+void
+GltfImporter::runBenchmark(BenchmarkReport& report) {
+  // Escena: 48 terrenos de 160x160 (con 16 y 32 bits de índices)
+  std::vector<GltfMesh> scene;
+  for (unsigned int i = 0; i < 48; ++i) {
+    scene.push_back(makeTerrain(i % 8 == 0 ? 320 : 160, i * 0.37f));
+  }
+  const std::string path = "benchmark_scene.glb";
+  Timer timer;
+  if (!writeGlb(path, scene)) {
+    report.fail("can't write " + path);
+    return;
+  }
+  const double writeMs = timer.elapsedMs();
+
+  std::vector<GltfMesh> loaded;
+  std::vector<std::string> textures;
+  GltfImportStats stats;
+  timer.reset();
+  const bool imported = load(path, loaded, textures, GltfImportSettings(), &stats);
+  const double loadMs = timer.elapsedMs();
+  if (!imported || loaded.size() != scene.size()) {
+    report.fail("the written scene didn't load back: " + stats.error);
+    std::remove(path.c_str());
+    return;
+  }
+  bool identical = stats.generatedTangents == 0;
+  for (size_t m = 0; m < scene.size() && identical; ++m) {
+    identical = loaded[m].name == scene[m].name && loaded[m].indices == scene[m].indices &&
+                loaded[m].vertices.size() == scene[m].vertices.size() &&
+                std::memcmp(loaded[m].vertices.data(), scene[m].vertices.data(),
+                            scene[m].vertices.size() * sizeof(GltfVertex)) == 0;
+  }
+  if (!identical) {
+    report.fail("imported meshes differ from the written ones");
+  }
+  report.log("%u primitives, %u vertices, %u tris, %.1f MB: write %.1f ms, import %.1f ms (%.0f MB/s, %.1f Mtris/s, one thread)",
+             stats.primitives, stats.vertices, stats.triangles, stats.fileBytes / (1024.0 * 1024.0), writeMs, loadMs,
+             stats.fileBytes / (1024.0 * 1024.0) / (loadMs * 1e-3), stats.triangles / (loadMs * 1000.0));
+
+  // Archivo truncado: se rechaza sin tocar la lista
+  {
+    std::ifstream source(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    const std::string truncated = "benchmark_truncated.glb";
+    std::ofstream(truncated, std::ios::binary).write(bytes.data(), bytes.size() / 2);
+    std::vector<GltfMesh> rejected;
+    if (load(truncated, rejected, textures) || !rejected.empty()) {
+      report.fail("a truncated GLB was accepted");
+    }
+    std::remove(truncated.c_str());
+  }
+  std::remove(path.c_str());
+
+  // .gltf con el buffer en base64, índices de 8 bits, jerarquía TRS y material con textura:
+  // triángulo (0,0,0) (1,0,0) (0,1,0) con normal +Z, nodo padre T(1,2,3) S(2), hijo rotado 90° en Y
+  const float positions[9] = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  const float normals[9] = { 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+  std::vector<unsigned char> buffer(sizeof(positions) + sizeof(normals) + 4, 0);
+  std::memcpy(buffer.data(), positions, sizeof(positions));
+  std::memcpy(buffer.data() + sizeof(positions), normals, sizeof(normals));
+  buffer[sizeof(positions) + sizeof(normals) + 1] = 1;
+  buffer[sizeof(positions) + sizeof(normals) + 2] = 2;
+  const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string base64;
+  for (size_t i = 0; i < buffer.size(); i += 3) {
+    const unsigned int chunk = (buffer[i] << 16) | ((i + 1 < buffer.size() ? buffer[i + 1] : 0) << 8) |
+                               (i + 2 < buffer.size() ? buffer[i + 2] : 0);
+    base64.push_back(alphabet[(chunk >> 18) & 63]);
+    base64.push_back(alphabet[(chunk >> 12) & 63]);
+    base64.push_back(i + 1 < buffer.size() ? alphabet[(chunk >> 6) & 63] : '=');
+    base64.push_back(i + 2 < buffer.size() ? alphabet[chunk & 63] : '=');
+  }
+  const std::string gltfPath = "benchmark_nodes.gltf";
+  std::ofstream(gltfPath) <<
+    "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\n"
+    " \"nodes\":[{\"translation\":[1,2,3],\"scale\":[2,2,2],\"children\":[1]},\n"
+    "          {\"rotation\":[0,0.70710678,0,0.70710678],\"mesh\":0}],\n"
+    " \"meshes\":[{\"name\":\"tri\",\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1},\"indices\":2,\"material\":0}]}],\n"
+    " \"materials\":[{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":0}}}],\n"
+    " \"textures\":[{\"source\":0}],\"images\":[{\"uri\":\"my%20albedo.png\"}],\n"
+    " \"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"},\n"
+    "              {\"bufferView\":0,\"byteOffset\":36,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"},\n"
+    "              {\"bufferView\":0,\"byteOffset\":72,\"componentType\":5121,\"count\":3,\"type\":\"SCALAR\"}],\n"
+    " \"bufferViews\":[{\"buffer\":0,\"byteLength\":" << buffer.size() << "}],\n"
+    " \"buffers\":[{\"byteLength\":" << buffer.size() << ",\"uri\":\"data:application/octet-stream;base64," << base64 << "\"}]}\n";
+  std::vector<GltfMesh> nodesMesh;
+  std::vector<std::string> nodesTextures;
+  // El hook de tangentes se llama solo para la primitiva sin tangentes, en el espacio del archivo
+  GltfImportSettings settings;
+  unsigned int hookCalls = 0;
+  bool fileSpace = false;
+  settings.generateTangents = [&hookCalls, &fileSpace](GltfMesh& mesh) {
+    ++hookCalls;
+    fileSpace = near(mesh.vertices[1].position, { 1, 0, 0 }) && mesh.indices[1] == 1;
+  };
+  const bool nodesLoaded = load(gltfPath, nodesMesh, nodesTextures, settings) && nodesMesh.size() == 1 &&
+                           nodesMesh[0].vertices.size() == 3 && nodesMesh[0].indices.size() == 3;
+  std::remove(gltfPath.c_str());
+  if (!nodesLoaded) {
+    report.fail("the node hierarchy test file didn't load");
+    return;
+  }
+  const std::vector<GltfVertex>& v = nodesMesh[0].vertices;
+  // Rotar (1,0,0) 90° en Y da (0,0,-1); la normal +Z da +X
+  const bool placed = near(v[0].position, { 1, 2, 3 }) && near(v[1].position, { 1, 2, 1 }) &&
+                      near(v[2].position, { 1, 4, 3 }) && near(v[0].normal, { 1, 0, 0 }) &&
+                      nodesMesh[0].indices[1] == 2 && nodesMesh[0].indices[2] == 1;
+  if (!placed || nodesTextures.size() != 1 || nodesTextures[0] != "my albedo.png") {
+    report.fail("node transforms, winding or material textures were not applied as expected");
+  }
+  if (hookCalls != 1 || !fileSpace) {
+    report.fail("generateTangents wasn't called once in file space before baking the node transform");
+  }
+}
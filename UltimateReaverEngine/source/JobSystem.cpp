@@ -0,0 +1,143 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace {
+  /// @brief True si el hilo actual ya está ejecutando un job (worker o hilo que despachó).
+  thread_local bool t_insideJob = false;
+}
+
+void
+JobSystem::init(unsigned int numWorkers) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_initialized) {
+    return;
+  }
+
+  if (numWorkers == 0) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    numWorkers = hw > 1 ? hw - 1 : 0;
+  }
+
+  m_stop = false;
+  m_workers.reserve(numWorkers);
+  for (unsigned int i = 0; i < numWorkers; ++i) {
+    m_workers.emplace_back(&JobSystem::workerLoop, this);
+  }
+  m_initialized = true;
+}
+
+void
+JobSystem::destroy() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized) {
+      return;
+    }
+    m_stop = true;
+  }
+  m_wakeCondition.notify_all();
+
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  m_workers.clear();
+  m_initialized = false;
+}
+
+void
+JobSystem::parallelFor(size_t count, size_t grainSize, const RangeJob& job) {
+  if (count == 0) {
+    return;
+  }
+  grainSize = std::max<size_t>(1, grainSize);
+
+  // Job anidado: lo corro aquí mismo para no bloquear al pool
+  if (t_insideJob) {
+    job(0, count);
+    return;
+  }
+
+  // Si otro hilo ya está usando el pool, también lo corro en línea
+  std::unique_lock<std::mutex> dispatch(m_dispatchMutex, std::try_to_lock);
+  if (!dispatch.owns_lock()) {
+    job(0, count);
+    return;
+  }
+
+  if (!m_initialized) {
+    init();
+  }
+
+  const size_t numChunks = (count + grainSize - 1) / grainSize;
+  if (numChunks == 1 || m_workers.empty()) {
+    t_insideJob = true;
+    job(0, count);
+    t_insideJob = false;
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_job = &job;
+    m_count = count;
+    m_grainSize = grainSize;
+    m_numChunks = numChunks;
+    m_nextChunk = 0;
+    m_activeWorkers = static_cast<unsigned int>(m_workers.size());
+    ++m_generation;
+  }
+  m_wakeCondition.notify_all();
+
+  // El hilo que despacha también trabaja
+  t_insideJob = true;
+  runChunks();
+  t_insideJob = false;
+
+  // Espero a que todos los workers suelten el job antes de invalidarlo
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_doneCondition.wait(lock, [this]() { return m_activeWorkers == 0; });
+  m_job = nullptr;
+}
+
+void
+JobSystem::workerLoop() {
+  t_insideJob = true;
+  uint64_t seenGeneration = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeCondition.wait(lock, [&]() {
+        return m_stop || m_generation != seenGeneration;
+      });
+      if (m_stop) {
+        return;
+      }
+      seenGeneration = m_generation;
+    }
+
+    runChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_activeWorkers == 0) {
+        m_doneCondition.notify_one();
+      }
+    }
+  }
+}
+
+void
+JobSystem::runChunks() {
+  for (;;) {
+    const size_t chunk = m_nextChunk.fetch_add(1);
+    if (chunk >= m_numChunks) {
+      break;
+    }
+    const size_t begin = chunk * m_grainSize;
+    const size_t end = std::min(m_count, begin + m_grainSize);
+    (*m_job)(begin, end);
+  }
+}
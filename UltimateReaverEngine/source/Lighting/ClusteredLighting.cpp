@@ -0,0 +1,443 @@
+#include "Lighting/ClusteredLighting.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+  /// Límite de columnas para poder guardar las distancias en X en la pila
+  const unsigned int kMaxTilesX = 64;
+
+  inline float
+    axisDistance(float minValue, float maxValue, float center) {
+    return std::max(0.0f, std::max(minValue - center, center - maxValue));
+  }
+
+} // namespace
+
+void
+ClusteredLighting::setProjection(const ClusterGridSettings& settings,
+                                 float fovY,
+                                 float aspect,
+                                 float nearZ,
+                                 float farZ) {
+  ClusterGridSettings clamped = settings;
+  clamped.tilesX = std::min(std::max(clamped.tilesX, 1u), kMaxTilesX);
+  clamped.tilesY = std::max(clamped.tilesY, 1u);
+  clamped.slicesZ = std::max(clamped.slicesZ, 1u);
+  clamped.maxLightsPerCluster = std::max(clamped.maxLightsPerCluster, 1u);
+  nearZ = std::max(nearZ, 1e-4f);
+  farZ = std::max(farZ, nearZ * 1.001f);
+
+  bool changed = m_gridDirty ||
+                 clamped.tilesX != m_settings.tilesX ||
+                 clamped.tilesY != m_settings.tilesY ||
+                 clamped.slicesZ != m_settings.slicesZ ||
+                 clamped.maxLightsPerCluster != m_settings.maxLightsPerCluster ||
+                 fovY != m_fovY || aspect != m_aspect ||
+                 nearZ != m_nearZ || farZ != m_farZ;
+  if (!changed) {
+    return;
+  }
+
+  m_settings = clamped;
+  m_fovY = fovY;
+  m_aspect = aspect;
+  m_nearZ = nearZ;
+  m_farZ = farZ;
+  buildGrid();
+  m_gridDirty = false;
+}
+
+void
+ClusteredLighting::buildGrid() {
+  const unsigned int tilesX = m_settings.tilesX;
+  const unsigned int tilesY = m_settings.tilesY;
+  const unsigned int slices = m_settings.slicesZ;
+  m_paddedTilesX = (tilesX + 3) & ~3u;
+
+  const float tanY = std::tan(m_fovY * 0.5f);
+  const float tanX = tanY * m_aspect;
+  const float logRatio = std::log(m_farZ / m_nearZ);
+  m_sliceScale = static_cast<float>(slices) / logRatio;
+  m_sliceBias = -static_cast<float>(slices) * std::log(m_nearZ) / logRatio;
+
+  m_sliceNear.resize(slices);
+  m_sliceFar.resize(slices);
+  m_columnMin.assign(slices * m_paddedTilesX, FLT_MAX);
+  m_columnMax.assign(slices * m_paddedTilesX, -FLT_MAX);
+  m_rowMin.resize(slices * tilesY);
+  m_rowMax.resize(slices * tilesY);
+
+  for (unsigned int s = 0; s < slices; ++s) {
+    // Rebanadas exponenciales: cada una es igual de "gruesa" en pantalla
+    float z0 = m_nearZ * std::pow(m_farZ / m_nearZ, static_cast<float>(s) / slices);
+    float z1 = m_nearZ * std::pow(m_farZ / m_nearZ, static_cast<float>(s + 1) / slices);
+    m_sliceNear[s] = z0;
+    m_sliceFar[s] = z1;
+
+    // El AABB de la columna cubre los bordes del tile en las dos profundidades
+    for (unsigned int x = 0; x < tilesX; ++x) {
+      float e0 = -1.0f + 2.0f * static_cast<float>(x) / tilesX;
+      float e1 = -1.0f + 2.0f * static_cast<float>(x + 1) / tilesX;
+      m_columnMin[s * m_paddedTilesX + x] = std::min(e0 * z0, e0 * z1) * tanX;
+      m_columnMax[s * m_paddedTilesX + x] = std::max(e1 * z0, e1 * z1) * tanX;
+    }
+    // Fila 0 arriba, igual que SV_Position
+    for (unsigned int y = 0; y < tilesY; ++y) {
+      float top = 1.0f - 2.0f * static_cast<float>(y) / tilesY;
+      float bottom = 1.0f - 2.0f * static_cast<float>(y + 1) / tilesY;
+      m_rowMin[s * tilesY + y] = std::min(bottom * z0, bottom * z1) * tanY;
+      m_rowMax[s * tilesY + y] = std::max(top * z0, top * z1) * tanY;
+    }
+  }
+
+  const unsigned int numClusters = getNumClusters();
+  m_clusterCounts.assign(numClusters, 0);
+  m_clusterOverflow.assign(numClusters, 0);
+  m_clusterScratch.assign(static_cast<size_t>(numClusters) * m_settings.maxLightsPerCluster, 0);
+  m_ranges.assign(numClusters, ClusterRange{ 0, 0 });
+}
+
+int
+ClusteredLighting::sliceFromDepth(float z) const {
+  if (z <= 0.0f) {
+    return -1;
+  }
+  return static_cast<int>(std::floor(std::log(z) * m_sliceScale + m_sliceBias));
+}
+
+void
+ClusteredLighting::prepareLights(const std::vector<Light>& lights, const XMFLOAT4X4& view) {
+  const unsigned int numLights = static_cast<unsigned int>(lights.size());
+  const int lastSlice = static_cast<int>(m_settings.slicesZ) - 1;
+  m_spheres.resize(numLights);
+  m_gpuLights.resize(numLights);
+
+  JobSystem::getInstance().parallelFor(numLights, 1024, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      XMFLOAT3 c;
+      float radius;
+      LightUtils::boundingSphere(lights[i], c, radius);
+
+      ViewSphere& s = m_spheres[i];
+      s.x = c.x * view._11 + c.y * view._21 + c.z * view._31 + view._41;
+      s.y = c.x * view._12 + c.y * view._22 + c.z * view._32 + view._42;
+      s.z = c.x * view._13 + c.y * view._23 + c.z * view._33 + view._43;
+      s.radius = radius;
+
+      if (s.z + radius < m_nearZ || s.z - radius > m_farZ) {
+        s.firstSlice = 1;
+        s.lastSlice = 0;
+      }
+      else {
+        // Una rebanada de margen por si el log redondea distinto que los bordes guardados;
+        // la prueba exacta en Z la hace assignSlice
+        s.firstSlice = std::max(sliceFromDepth(s.z - radius) - 1, 0);
+        s.lastSlice = std::min(sliceFromDepth(s.z + radius) + 1, lastSlice);
+        if (s.z - radius <= 0.0f) {
+          s.firstSlice = 0;
+        }
+      }
+      m_gpuLights[i] = LightUtils::pack(lights[i]);
+    }
+  });
+
+  // Counting sort de las luces por rebanada (conserva el orden de la entrada)
+  const unsigned int slices = m_settings.slicesZ;
+  m_sliceStart.assign(slices + 1, 0);
+  unsigned int visible = 0;
+  for (const ViewSphere& s : m_spheres) {
+    if (s.firstSlice > s.lastSlice) {
+      continue;
+    }
+    ++visible;
+    for (int z = s.firstSlice; z <= s.lastSlice; ++z) {
+      ++m_sliceStart[z + 1];
+    }
+  }
+  for (unsigned int z = 0; z < slices; ++z) {
+    m_sliceStart[z + 1] += m_sliceStart[z];
+  }
+  m_sliceLights.resize(m_sliceStart[slices]);
+  std::vector<unsigned int> cursor(m_sliceStart.begin(), m_sliceStart.end() - 1);
+  for (unsigned int i = 0; i < numLights; ++i) {
+    const ViewSphere& s = m_spheres[i];
+    for (int z = s.firstSlice; z <= s.lastSlice; ++z) {
+      m_sliceLights[cursor[z]++] = i;
+    }
+  }
+  m_stats.visibleLights = visible;
+}
+
+void
+ClusteredLighting::assignSlice(unsigned int slice) {
+  const unsigned int tilesX = m_settings.tilesX;
+  const unsigned int tilesY = m_settings.tilesY;
+  const unsigned int maxPerCluster = m_settings.maxLightsPerCluster;
+  const unsigned int sliceBase = slice * tilesY * tilesX;
+  const float zNear = m_sliceNear[slice];
+  const float zFar = m_sliceFar[slice];
+  const float* columnMin = &m_columnMin[slice * m_paddedTilesX];
+  const float* columnMax = &m_columnMax[slice * m_paddedTilesX];
+  const float* rowMin = &m_rowMin[slice * tilesY];
+  const float* rowMax = &m_rowMax[slice * tilesY];
+
+  std::memset(&m_clusterCounts[sliceBase], 0, tilesX * tilesY * sizeof(unsigned int));
+  std::memset(&m_clusterOverflow[sliceBase], 0, tilesX * tilesY);
+
+  alignas(16) float dx2[kMaxTilesX];
+  const __m128 zero = _mm_setzero_ps();
+
+  for (unsigned int i = m_sliceStart[slice]; i < m_sliceStart[slice + 1]; ++i) {
+    const unsigned int lightIndex = m_sliceLights[i];
+    const ViewSphere& s = m_spheres[lightIndex];
+    const float r2 = s.radius * s.radius;
+
+    float dz = axisDistance(zNear, zFar, s.z);
+    float dz2 = dz * dz;
+    if (dz2 > r2) {
+      continue;
+    }
+
+    // Distancia en X a cada columna, 4 a la vez (las columnas de relleno dan infinito)
+    const __m128 cx = _mm_set1_ps(s.x);
+    for (unsigned int x = 0; x < m_paddedTilesX; x += 4) {
+      __m128 d = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(columnMin + x), cx),
+                                             _mm_sub_ps(cx, _mm_loadu_ps(columnMax + x))));
+      _mm_store_ps(dx2 + x, _mm_mul_ps(d, d));
+    }
+
+    const __m128 radius2 = _mm_set1_ps(r2);
+    for (unsigned int y = 0; y < tilesY; ++y) {
+      float dy = axisDistance(rowMin[y], rowMax[y], s.y);
+      float dyz = dy * dy + dz2;
+      if (dyz > r2) {
+        continue;
+      }
+      const __m128 rowDistance = _mm_set1_ps(dyz);
+      const unsigned int rowBase = sliceBase + y * tilesX;
+      for (unsigned int x = 0; x < m_paddedTilesX; x += 4) {
+        int mask = _mm_movemask_ps(_mm_cmple_ps(_mm_add_ps(_mm_load_ps(dx2 + x), rowDistance), radius2));
+        while (mask) {
+          unsigned int bit = 0;
+          while (!(mask & (1 << bit))) {
+            ++bit;
+          }
+          mask &= mask - 1;
+
+          unsigned int cluster = rowBase + x + bit;
+          unsigned int& count = m_clusterCounts[cluster];
+          if (count < maxPerCluster) {
+            m_clusterScratch[static_cast<size_t>(cluster) * maxPerCluster + count] = lightIndex;
+            ++count;
+          }
+          else {
+            m_clusterOverflow[cluster] = 1;
+          }
+        }
+      }
+    }
+  }
+}
+
+void
+ClusteredLighting::compact() {
+  const unsigned int numClusters = getNumClusters();
+  const unsigned int maxPerCluster = m_settings.maxLightsPerCluster;
+
+  unsigned int total = 0;
+  unsigned int maxCount = 0;
+  unsigned int overflow = 0;
+  for (unsigned int c = 0; c < numClusters; ++c) {
+    m_ranges[c].offset = total;
+    m_ranges[c].count = m_clusterCounts[c];
+    total += m_clusterCounts[c];
+    maxCount = std::max(maxCount, m_clusterCounts[c]);
+    overflow += m_clusterOverflow[c];
+  }
+  m_indices.resize(total);
+
+  const unsigned int clustersPerSlice = m_settings.tilesX * m_settings.tilesY;
+  JobSystem::getInstance().parallelFor(m_settings.slicesZ, 1, [&](size_t begin, size_t end) {
+    for (size_t c = begin * clustersPerSlice; c < end * clustersPerSlice; ++c) {
+      if (m_ranges[c].count) {
+        std::memcpy(&m_indices[m_ranges[c].offset],
+                    &m_clusterScratch[c * maxPerCluster],
+                    m_ranges[c].count * sizeof(unsigned int));
+      }
+    }
+  });
+
+  m_stats.indices = total;
+  m_stats.maxPerCluster = maxCount;
+  m_stats.overflowClusters = overflow;
+}
+
+void
+ClusteredLighting::build(const std::vector<Light>& lights, const XMFLOAT4X4& view) {
+  if (m_gridDirty) {
+    ERROR("ClusteredLighting", "build", "setProjection was not called");
+    return;
+  }
+  Timer total;
+  m_stats = ClusteredLightingStats();
+  m_stats.lights = static_cast<unsigned int>(lights.size());
+
+  Timer step;
+  prepareLights(lights, view);
+  m_stats.prepareMs = step.elapsedMs();
+
+  step.reset();
+  JobSystem::getInstance().parallelFor(m_settings.slicesZ, 1, [&](size_t begin, size_t end) {
+    for (size_t z = begin; z < end; ++z) {
+      assignSlice(static_cast<unsigned int>(z));
+    }
+  });
+  m_stats.assignMs = step.elapsedMs();
+
+  step.reset();
+  compact();
+  m_stats.compactMs = step.elapsedMs();
+  m_stats.timeMs = total.elapsedMs();
+}
+
+void
+ClusteredLighting::buildReference(const std::vector<Light>& lights, const XMFLOAT4X4& view) {
+  if (m_gridDirty) {
+    ERROR("ClusteredLighting", "buildReference", "setProjection was not called");
+    return;
+  }
+  Timer total;
+  m_stats = ClusteredLightingStats();
+  m_stats.lights = static_cast<unsigned int>(lights.size());
+  prepareLights(lights, view);
+
+  const unsigned int tilesX = m_settings.tilesX;
+  const unsigned int tilesY = m_settings.tilesY;
+  const unsigned int maxPerCluster = m_settings.maxLightsPerCluster;
+  for (unsigned int z = 0; z < m_settings.slicesZ; ++z) {
+    for (unsigned int y = 0; y < tilesY; ++y) {
+      for (unsigned int x = 0; x < tilesX; ++x) {
+        unsigned int cluster = getClusterIndex(x, y, z);
+        unsigned int count = 0;
+        unsigned char overflow = 0;
+        for (unsigned int l = 0; l < m_spheres.size(); ++l) {
+          const ViewSphere& s = m_spheres[l];
+          float dx = axisDistance(m_columnMin[z * m_paddedTilesX + x], m_columnMax[z * m_paddedTilesX + x], s.x);
+          float dy = axisDistance(m_rowMin[z * tilesY + y], m_rowMax[z * tilesY + y], s.y);
+          float dz = axisDistance(m_sliceNear[z], m_sliceFar[z], s.z);
+          if (dx * dx + (dy * dy + dz * dz) > s.radius * s.radius) {
+            continue;
+          }
+          if (count < maxPerCluster) {
+            m_clusterScratch[static_cast<size_t>(cluster) * maxPerCluster + count++] = l;
+          }
+          else {
+            overflow = 1;
+          }
+        }
+        m_clusterCounts[cluster] = count;
+        m_clusterOverflow[cluster] = overflow;
+      }
+    }
+  }
+  compact();
+  m_stats.timeMs = total.elapsedMs();
+}
+
+void
+ClusteredLighting::runBenchmark(BenchmarkReport& report) {
+  const float fovY = XM_PIDIV4;
+  const float aspect = 16.0f / 9.0f;
+  const float nearZ = 0.1f;
+  const float farZ = 500.0f;
+
+  XMFLOAT4X4 view;
+  XMStoreFloat4x4(&view, XMMatrixLookAtLH(XMVectorSet(0.0f, 12.0f, -30.0f, 0.0f),
+                                          XMVectorSet(0.0f, 0.0f, 100.0f, 0.0f),
+                                          XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+
+  ClusterGridSettings settings;
+  report.log("grid %ux%ux%u (%u clusters), max %u lights per cluster, %u threads",
+             settings.tilesX, settings.tilesY, settings.slicesZ,
+             settings.tilesX * settings.tilesY * settings.slicesZ,
+             settings.maxLightsPerCluster, JobSystem::getInstance().getNumThreads());
+
+  const unsigned int lightCounts[2] = { 1000, 10000 };
+  for (unsigned int numLights : lightCounts) {
+    // Ciudad de 300 x 320 m con luces de 3 a 12 m de radio; una de cada cuatro es spot
+    std::vector<Light> lights(numLights);
+    unsigned int seed = 12345u;
+    auto random = [&seed]() {
+      seed = seed * 1664525u + 1013904223u;
+      return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (unsigned int i = 0; i < numLights; ++i) {
+      Light& light = lights[i];
+      light.position = XMFLOAT3(random() * 300.0f - 150.0f, random() * 30.0f, random() * 320.0f - 20.0f);
+      light.range = 3.0f + random() * 9.0f;
+      light.color = XMFLOAT3(random(), random(), random());
+      if ((i & 3) == 3) {
+        light.type = SPOT_LIGHT;
+        float yaw = random() * XM_2PI;
+        light.direction = XMFLOAT3(std::cos(yaw) * 0.5f, -0.866f, std::sin(yaw) * 0.5f);
+        light.innerAngle = 0.3f;
+        light.outerAngle = 0.5f;
+      }
+    }
+
+    ClusteredLighting clustered;
+    clustered.setProjection(settings, fovY, aspect, nearZ, farZ);
+
+    const int numFrames = numLights > 5000 ? 20 : 60;
+    clustered.build(lights, view); // calentamiento
+    ClusteredLightingStats sum;
+    double worstMs = 0.0;
+    for (int f = 0; f < numFrames; ++f) {
+      clustered.build(lights, view);
+      const ClusteredLightingStats& stats = clustered.getStats();
+      sum.prepareMs += stats.prepareMs;
+      sum.assignMs += stats.assignMs;
+      sum.compactMs += stats.compactMs;
+      sum.timeMs += stats.timeMs;
+      worstMs = std::max(worstMs, stats.timeMs);
+    }
+    const ClusteredLightingStats& stats = clustered.getStats();
+    unsigned int nonEmpty = 0;
+    for (const ClusterRange& range : clustered.getClusterRanges()) {
+      nonEmpty += range.count ? 1 : 0;
+    }
+
+    report.log("%5u lights: %u visible, %u indices, %u non-empty clusters (avg %.1f, max %u), %u overflowed",
+               numLights, stats.visibleLights, stats.indices, nonEmpty,
+               nonEmpty ? static_cast<double>(stats.indices) / nonEmpty : 0.0,
+               stats.maxPerCluster, stats.overflowClusters);
+    report.log("       assign avg %7.3f ms (prepare %.3f, clusters %.3f, compact %.3f), worst %.3f ms",
+               sum.timeMs / numFrames, sum.prepareMs / numFrames, sum.assignMs / numFrames,
+               sum.compactMs / numFrames, worstMs);
+
+    // Verificación contra la fuerza bruta escalar
+    std::vector<ClusterRange> ranges = clustered.getClusterRanges();
+    std::vector<unsigned int> indices = clustered.getLightIndices();
+    ClusteredLighting reference;
+    reference.setProjection(settings, fovY, aspect, nearZ, farZ);
+    reference.buildReference(lights, view);
+    report.log("       brute force %9.3f ms (%.1fx)", reference.getStats().timeMs,
+               reference.getStats().timeMs / std::max(sum.timeMs / numFrames, 1e-6));
+
+    bool match = indices == reference.getLightIndices() &&
+                 ranges.size() == reference.getClusterRanges().size();
+    for (size_t c = 0; match && c < ranges.size(); ++c) {
+      match = ranges[c].offset == reference.getClusterRanges()[c].offset &&
+              ranges[c].count == reference.getClusterRanges()[c].count;
+    }
+    if (!match) {
+      report.fail("clustered light lists differ from brute force with " + std::to_string(numLights) + " lights");
+    }
+  }
+}
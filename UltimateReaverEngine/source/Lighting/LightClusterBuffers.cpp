@@ -0,0 +1,162 @@
+#include "Lighting/LightClusterBuffers.h"
+#include "Lighting/ClusteredLighting.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+namespace {
+
+  const unsigned int kFirstLightSlot = 4;
+  const unsigned int kLightClustersCBSlot = 3;
+
+} // namespace
+
+HRESULT
+LightClusterBuffers::init(Device& device,
+                          unsigned int maxLights,
+                          unsigned int numClusters,
+                          unsigned int maxIndices) {
+  if (!device.m_device) {
+    ERROR("LightClusterBuffers", "init", "Device is nullptr");
+    return E_POINTER;
+  }
+  if (maxLights == 0 || numClusters == 0 || maxIndices == 0) {
+    ERROR("LightClusterBuffers", "init", "Capacities must be greater than zero");
+    return E_INVALIDARG;
+  }
+  m_maxLights = maxLights;
+  m_numClusters = numClusters;
+  m_maxIndices = maxIndices;
+
+  HRESULT hr = createStructuredBuffer(device, sizeof(GpuLight), maxLights, &m_lightBuffer, &m_views[0]);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = createStructuredBuffer(device, sizeof(ClusterRange), numClusters, &m_rangeBuffer, &m_views[1]);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = createStructuredBuffer(device, sizeof(unsigned int), maxIndices, &m_indexBuffer, &m_views[2]);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = m_cbLightClusters.init(device, sizeof(CBLightClusters));
+  if (FAILED(hr)) {
+    ERROR("LightClusterBuffers", "init", "Failed to create CBLightClusters");
+    return hr;
+  }
+  return S_OK;
+}
+
+HRESULT
+LightClusterBuffers::createStructuredBuffer(Device& device,
+                                            unsigned int stride,
+                                            unsigned int count,
+                                            ID3D11Buffer** buffer,
+                                            ID3D11ShaderResourceView** view) {
+  D3D11_BUFFER_DESC desc = {};
+  desc.Usage = D3D11_USAGE_DYNAMIC;
+  desc.ByteWidth = stride * count;
+  desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+  desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+  desc.StructureByteStride = stride;
+
+  HRESULT hr = device.CreateBuffer(&desc, nullptr, buffer);
+  if (FAILED(hr)) {
+    ERROR("LightClusterBuffers", "createStructuredBuffer", "Failed to create buffer");
+    return hr;
+  }
+
+  D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+  viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+  viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+  viewDesc.Buffer.FirstElement = 0;
+  viewDesc.Buffer.NumElements = count;
+  hr = device.m_device->CreateShaderResourceView(*buffer, &viewDesc, view);
+  if (FAILED(hr)) {
+    ERROR("LightClusterBuffers", "createStructuredBuffer", "Failed to create shader resource view");
+    return hr;
+  }
+  return S_OK;
+}
+
+void
+LightClusterBuffers::upload(DeviceContext& deviceContext,
+                            ID3D11Buffer* buffer,
+                            const void* data,
+                            size_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+  D3D11_MAPPED_SUBRESOURCE mapped = {};
+  HRESULT hr = deviceContext.m_deviceContext->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+  if (FAILED(hr)) {
+    ERROR("LightClusterBuffers", "upload", "Map failed");
+    return;
+  }
+  memcpy(mapped.pData, data, bytes);
+  deviceContext.m_deviceContext->Unmap(buffer, 0);
+}
+
+void
+LightClusterBuffers::update(DeviceContext& deviceContext,
+                            const ClusteredLighting& clusters,
+                            unsigned int screenWidth,
+                            unsigned int screenHeight) {
+  if (!deviceContext.m_deviceContext || !m_lightBuffer) {
+    ERROR("LightClusterBuffers", "update", "Buffers are not initialized");
+    return;
+  }
+
+  const std::vector<GpuLight>& lights = clusters.getGpuLights();
+  const std::vector<ClusterRange>& ranges = clusters.getClusterRanges();
+  const std::vector<unsigned int>& indices = clusters.getLightIndices();
+
+  unsigned int numLights = static_cast<unsigned int>(lights.size());
+  if (numLights > m_maxLights || ranges.size() != m_numClusters || indices.size() > m_maxIndices) {
+    // Recortar rompería los offsets de la lista; prefiero no subir este frame
+    if (!m_reportedOverflow) {
+      ERROR("LightClusterBuffers", "update",
+        "Cluster data does not fit: " << numLights << " lights, " << ranges.size()
+        << " clusters, " << indices.size() << " indices");
+      m_reportedOverflow = true;
+    }
+    return;
+  }
+
+  upload(deviceContext, m_lightBuffer, lights.data(), numLights * sizeof(GpuLight));
+  upload(deviceContext, m_rangeBuffer, ranges.data(), ranges.size() * sizeof(ClusterRange));
+  upload(deviceContext, m_indexBuffer, indices.data(), indices.size() * sizeof(unsigned int));
+
+  const ClusterGridSettings& settings = clusters.getSettings();
+  m_params.vGridSize[0] = settings.tilesX;
+  m_params.vGridSize[1] = settings.tilesY;
+  m_params.vGridSize[2] = settings.slicesZ;
+  m_params.vGridSize[3] = numLights;
+  m_params.vDepthParams = XMFLOAT4(clusters.getDepthSliceScale(), clusters.getDepthSliceBias(), 0.0f, 0.0f);
+  m_params.vTileSize = XMFLOAT4(static_cast<float>(screenWidth) / settings.tilesX,
+                                static_cast<float>(screenHeight) / settings.tilesY,
+                                0.0f, 0.0f);
+  m_cbLightClusters.update(deviceContext, nullptr, 0, nullptr, &m_params, 0, 0);
+}
+
+void
+LightClusterBuffers::render(DeviceContext& deviceContext) {
+  if (!m_lightBuffer) {
+    return;
+  }
+  deviceContext.PSSetShaderResources(kFirstLightSlot, 3, m_views);
+  m_cbLightClusters.render(deviceContext, kLightClustersCBSlot, 1, true);
+}
+
+void
+LightClusterBuffers::destroy() {
+  for (ID3D11ShaderResourceView*& view : m_views) {
+    SAFE_RELEASE(view);
+  }
+  SAFE_RELEASE(m_lightBuffer);
+  SAFE_RELEASE(m_rangeBuffer);
+  SAFE_RELEASE(m_indexBuffer);
+  m_cbLightClusters.destroy();
+  m_reportedOverflow = false;
+}
@@ -0,0 +1,1459 @@
+#include "Lighting/LightmapBaker.h"
+#include "MeshCodec.h"
+#include "JobSystem.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace {
+
+  /**
+   * @struct LightmapFileHeader
+   * @brief Encabezado del archivo de lightmap (después van las instancias y los texels).
+   */
+  struct
+    LightmapFileHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int width;
+    unsigned int height;
+    float texelsPerUnit;
+    unsigned int numInstances;
+    unsigned int dataBytes;
+  };
+
+  /**
+   * @brief Números aleatorios por texel y pasada (xorshift32 con semilla de splitmix64).
+   */
+  struct
+    PathRandom {
+    unsigned int state;
+
+    explicit
+      PathRandom(unsigned long long seed) {
+      seed += 0x9E3779B97F4A7C15ull;
+      seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ull;
+      seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBull;
+      seed ^= seed >> 31;
+      state = static_cast<unsigned int>(seed) | 1u;
+    }
+
+    float
+      next() {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return (state >> 8) * (1.0f / 16777216.0f);
+    }
+  };
+
+  inline float
+  dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+  inline void
+  cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  inline bool
+  normalize3(float v[3]) {
+    const float length = std::sqrt(dot3(v, v));
+    if (length <= 0.0f) {
+      return false;
+    }
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+    return true;
+  }
+
+  inline float
+  luminance(const float c[3]) {
+    return 0.2126f * c[0] + 0.7152f * c[1] + 0.0722f * c[2];
+  }
+
+  /**
+   * @brief Dirección con densidad cos(θ)/π alrededor de `normal` (base de Duff et al.).
+   */
+  void
+  sampleCosine(const float normal[3], float u1, float u2, float out[3]) {
+    const float r = std::sqrt(u1);
+    const float phi = XM_2PI * u2;
+    const float x = r * std::cos(phi);
+    const float y = r * std::sin(phi);
+    const float z = std::sqrt(std::max(0.0f, 1.0f - u1));
+
+    const float sign = normal[2] >= 0.0f ? 1.0f : -1.0f;
+    const float a = -1.0f / (sign + normal[2]);
+    const float b = normal[0] * normal[1] * a;
+    const float tangent[3] = { 1.0f + sign * normal[0] * normal[0] * a, sign * b, -sign * normal[0] };
+    const float bitangent[3] = { b, sign + normal[1] * normal[1] * a, -normal[1] };
+    for (int c = 0; c < 3; ++c) {
+      out[c] = tangent[c] * x + bitangent[c] * y + normal[c] * z;
+    }
+  }
+
+  inline void
+  transformPoint(const XMFLOAT4X4& m, const XMFLOAT3& p, float out[3]) {
+    for (int c = 0; c < 3; ++c) {
+      out[c] = p.x * m.m[0][c] + p.y * m.m[1][c] + p.z * m.m[2][c] + m.m[3][c];
+    }
+  }
+
+  /**
+   * @brief Normal a mundo con la matriz de cofactores (la inversa transpuesta sin dividir).
+   */
+  struct
+    NormalTransform {
+    float rows[3][3];
+
+    explicit
+      NormalTransform(const XMFLOAT4X4& m) {
+      const float r0[3] = { m._11, m._12, m._13 };
+      const float r1[3] = { m._21, m._22, m._23 };
+      const float r2[3] = { m._31, m._32, m._33 };
+      cross3(r1, r2, rows[0]);
+      cross3(r2, r0, rows[1]);
+      cross3(r0, r1, rows[2]);
+      // Con determinante negativo (espejo) el cofactor voltea la normal
+      if (dot3(r0, rows[0]) < 0.0f) {
+        for (int r = 0; r < 3; ++r) {
+          for (int c = 0; c < 3; ++c) {
+            rows[r][c] = -rows[r][c];
+          }
+        }
+      }
+    }
+
+    void
+      apply(const XMFLOAT3& n, float out[3]) const {
+      for (int c = 0; c < 3; ++c) {
+        out[c] = n.x * rows[0][c] + n.y * rows[1][c] + n.z * rows[2][c];
+      }
+    }
+  };
+
+} // namespace
+
+HRESULT
+LightmapBaker::begin(const std::vector<LightmapInstance>& instances,
+                     const std::vector<Light>& lights,
+                     const LightmapBakeSettings& settings) {
+  cancel();
+  m_settings = settings;
+  m_stats = LightmapBakeStats();
+  m_result.clear();
+  m_data = LightmapData();
+  m_preview.clear();
+  Timer timer;
+
+  // Un unwrap por malla: las instancias de un mismo prefab lo comparten
+  std::unordered_map<const MeshComponent*, unsigned int> meshLookup;
+  std::vector<const MeshComponent*> meshes;
+  m_instanceUnwrap.resize(instances.size());
+  size_t numTriangles = 0;
+  for (size_t i = 0; i < instances.size(); ++i) {
+    const MeshComponent* mesh = instances[i].mesh;
+    if (!mesh) {
+      ERROR("LightmapBaker", "begin", "Instance " << i << " has no mesh");
+      return E_INVALIDARG;
+    }
+    auto found = meshLookup.find(mesh);
+    if (found == meshLookup.end()) {
+      found = meshLookup.emplace(mesh, static_cast<unsigned int>(meshes.size())).first;
+      meshes.push_back(mesh);
+    }
+    m_instanceUnwrap[i] = found->second;
+    numTriangles += mesh->m_vertex.empty() ? 0 : mesh->m_index.size() / 3;
+  }
+  if (numTriangles == 0) {
+    ERROR("LightmapBaker", "begin", "There is no static geometry to bake");
+    return E_INVALIDARG;
+  }
+  m_unwraps.assign(meshes.size(), LightmapUnwrap());
+  JobSystem::getInstance().parallelFor(meshes.size(), 1, [&](size_t first, size_t last) {
+    for (size_t m = first; m < last; ++m) {
+      LightmapPacker::unwrap(*meshes[m], settings.pack, m_unwraps[m]);
+    }
+  });
+
+  std::vector<float> sizes(instances.size());
+  for (size_t i = 0; i < instances.size(); ++i) {
+    sizes[i] = m_unwraps[m_instanceUnwrap[i]].size * LightmapPacker::getMaxScale(instances[i].world);
+  }
+  if (!LightmapPacker::pack(sizes, settings.pack, m_atlas)) {
+    ERROR("LightmapBaker", "begin", "The scene does not fit in a " << settings.pack.atlasSize
+          << "x" << settings.pack.atlasSize << " lightmap");
+    return E_FAIL;
+  }
+
+  // La escena en mundo, toda en un BVH
+  std::vector<XMFLOAT3> positions;
+  std::vector<unsigned int> indices;
+  positions.reserve(numTriangles * 3);
+  indices.reserve(numTriangles * 3);
+  m_triangleNormals.clear();
+  m_triangleAlbedo.clear();
+  for (const LightmapInstance& instance : instances) {
+    const MeshComponent& mesh = *instance.mesh;
+    if (mesh.m_vertex.empty()) {
+      continue;
+    }
+    const unsigned int base = static_cast<unsigned int>(positions.size());
+    for (const SimpleVertex& vertex : mesh.m_vertex) {
+      float p[3];
+      transformPoint(instance.world, vertex.Pos, p);
+      positions.push_back(XMFLOAT3(p[0], p[1], p[2]));
+    }
+    for (size_t t = 0; t + 2 < mesh.m_index.size(); t += 3) {
+      const XMFLOAT3& p0 = positions[base + mesh.m_index[t]];
+      const XMFLOAT3& p1 = positions[base + mesh.m_index[t + 1]];
+      const XMFLOAT3& p2 = positions[base + mesh.m_index[t + 2]];
+      const float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+      const float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+      float n[3];
+      cross3(e1, e2, n);
+      normalize3(n);
+      m_triangleNormals.push_back(XMFLOAT3(n[0], n[1], n[2]));
+      m_triangleAlbedo.push_back(instance.albedo);
+      for (int c = 0; c < 3; ++c) {
+        indices.push_back(base + mesh.m_index[t + c]);
+      }
+    }
+  }
+  m_bvh.build(positions.data(), positions.size(), sizeof(XMFLOAT3), indices.data(), indices.size());
+  XMFLOAT3 minPoint, maxPoint;
+  m_bvh.getBounds(minPoint, maxPoint);
+  const float extent[3] = { maxPoint.x - minPoint.x, maxPoint.y - minPoint.y, maxPoint.z - minPoint.z };
+  m_epsilon = std::max(1e-5f, std::sqrt(dot3(extent, extent)) * 1e-4f);
+
+  // Luces: el sol (si tiene color) y las puntuales/spots empaquetadas como para el shader
+  m_emitters.clear();
+  m_sky = settings.skyColor;
+  float sun[3] = { -settings.sunDirection.x, -settings.sunDirection.y, -settings.sunDirection.z };
+  if ((settings.sunColor.x > 0.0f || settings.sunColor.y > 0.0f || settings.sunColor.z > 0.0f) && normalize3(sun)) {
+    Emitter emitter;
+    emitter.directional = true;
+    emitter.direction = XMFLOAT3(sun[0], sun[1], sun[2]);
+    emitter.color = settings.sunColor;
+    m_emitters.push_back(emitter);
+  }
+  for (const Light& light : lights) {
+    const GpuLight packed = LightUtils::pack(light);
+    if (packed.range <= 0.0f || (packed.color.x <= 0.0f && packed.color.y <= 0.0f && packed.color.z <= 0.0f)) {
+      continue;
+    }
+    Emitter emitter;
+    emitter.position = packed.position;
+    emitter.direction = packed.direction;
+    emitter.color = packed.color;
+    emitter.range = packed.range;
+    emitter.spotScale = packed.spotScale;
+    emitter.spotOffset = packed.spotOffset;
+    m_emitters.push_back(emitter);
+  }
+
+  rasterize(instances);
+  m_accum.assign(m_texels.size(), XMFLOAT3(0.0f, 0.0f, 0.0f));
+  m_accumSquared.assign(m_texels.size(), 0.0f);
+  m_samples.assign(m_texels.size(), 0);
+  m_pass = 0;
+  m_cursor = 0;
+  m_rays = 0;
+
+  m_stats.instances = static_cast<unsigned int>(instances.size());
+  m_stats.meshes = static_cast<unsigned int>(meshes.size());
+  for (const LightmapUnwrap& unwrap : m_unwraps) {
+    m_stats.charts += static_cast<unsigned int>(unwrap.chartRects.size());
+  }
+  m_stats.triangles = static_cast<unsigned int>(m_triangleNormals.size());
+  m_stats.texels = static_cast<unsigned int>(m_texels.size());
+  m_stats.texelsPerUnit = m_atlas.texelsPerUnit;
+  m_stats.setupMs = timer.elapsedMs();
+
+  m_state = m_texels.empty() ? STATE_IDLE : STATE_BAKING;
+  if (m_texels.empty()) {
+    ERROR("LightmapBaker", "begin", "No texel of the " << m_atlas.width << "x" << m_atlas.height
+          << " lightmap is covered by the geometry");
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+void
+LightmapBaker::rasterize(const std::vector<LightmapInstance>& instances) {
+  const unsigned int width = m_atlas.width;
+  const unsigned int height = m_atlas.height;
+  std::vector<Texel> candidates(static_cast<size_t>(width) * height);
+  std::vector<unsigned char> covered(candidates.size(), 0);
+
+  for (size_t i = 0; i < instances.size(); ++i) {
+    const LightmapInstance& instance = instances[i];
+    const MeshComponent& mesh = *instance.mesh;
+    const LightmapUnwrap& unwrap = m_unwraps[m_instanceUnwrap[i]];
+    const LightmapRect& rect = m_atlas.rects[i];
+    const NormalTransform normalTransform(instance.world);
+
+    for (size_t t = 0; t + 2 < unwrap.indices.size(); t += 3) {
+      float corner[3][2];
+      float world[3][3];
+      float normal[3][3];
+      for (int c = 0; c < 3; ++c) {
+        const unsigned int v = unwrap.indices[t + c];
+        corner[c][0] = rect.x + unwrap.uv[v].x * rect.size;
+        corner[c][1] = rect.y + unwrap.uv[v].y * rect.size;
+        transformPoint(instance.world, mesh.m_vertex[unwrap.remap[v]].Pos, world[c]);
+        normalTransform.apply(mesh.m_vertex[unwrap.remap[v]].Normal, normal[c]);
+      }
+      const float e1[3] = { world[1][0] - world[0][0], world[1][1] - world[0][1], world[1][2] - world[0][2] };
+      const float e2[3] = { world[2][0] - world[0][0], world[2][1] - world[0][1], world[2][2] - world[0][2] };
+      float geometric[3];
+      cross3(e1, e2, geometric);
+      const float area = (corner[1][0] - corner[0][0]) * (corner[2][1] - corner[0][1]) -
+                         (corner[1][1] - corner[0][1]) * (corner[2][0] - corner[0][0]);
+      if (!normalize3(geometric) || std::fabs(area) < 1e-12f) {
+        continue;
+      }
+
+      // Centros de pixel dentro del triángulo (dentro del cuadrado de la instancia)
+      const int minX = std::max(static_cast<int>(rect.x),
+                                static_cast<int>(std::floor(std::min(corner[0][0], std::min(corner[1][0], corner[2][0])))));
+      const int minY = std::max(static_cast<int>(rect.y),
+                                static_cast<int>(std::floor(std::min(corner[0][1], std::min(corner[1][1], corner[2][1])))));
+      const int maxX = std::min(static_cast<int>(rect.x + rect.size) - 1,
+                                static_cast<int>(std::ceil(std::max(corner[0][0], std::max(corner[1][0], corner[2][0])))));
+      const int maxY = std::min(static_cast<int>(rect.y + rect.size) - 1,
+                                static_cast<int>(std::ceil(std::max(corner[0][1], std::max(corner[1][1], corner[2][1])))));
+      for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+          const size_t pixel = static_cast<size_t>(y) * width + x;
+          if (covered[pixel]) {
+            continue;
+          }
+          const float px = x + 0.5f;
+          const float py = y + 0.5f;
+          const float w0 = ((corner[1][0] - px) * (corner[2][1] - py) - (corner[1][1] - py) * (corner[2][0] - px)) / area;
+          const float w1 = ((corner[2][0] - px) * (corner[0][1] - py) - (corner[2][1] - py) * (corner[0][0] - px)) / area;
+          const float w2 = 1.0f - w0 - w1;
+          if (w0 < -1e-5f || w1 < -1e-5f || w2 < -1e-5f) {
+            continue;
+          }
+          covered[pixel] = 1;
+
+          float n[3];
+          for (int c = 0; c < 3; ++c) {
+            n[c] = normal[0][c] * w0 + normal[1][c] * w1 + normal[2][c] * w2;
+          }
+          if (!normalize3(n)) {
+            std::memcpy(n, geometric, sizeof(n));
+          }
+          // La normal del triángulo del lado de la interpolada (el winding puede venir al revés)
+          const float side = dot3(geometric, n) < 0.0f ? -1.0f : 1.0f;
+          Texel& texel = candidates[pixel];
+          texel.position = XMFLOAT3(world[0][0] * w0 + world[1][0] * w1 + world[2][0] * w2 + geometric[0] * side * m_epsilon,
+                                    world[0][1] * w0 + world[1][1] * w1 + world[2][1] * w2 + geometric[1] * side * m_epsilon,
+                                    world[0][2] * w0 + world[1][2] * w1 + world[2][2] * w2 + geometric[2] * side * m_epsilon);
+          texel.normal = XMFLOAT3(n[0], n[1], n[2]);
+          texel.geometric = XMFLOAT3(geometric[0] * side, geometric[1] * side, geometric[2] * side);
+          texel.pixel = static_cast<unsigned int>(pixel);
+        }
+      }
+    }
+  }
+
+  // En orden de renglón: texels vecinos en el atlas casi siempre son vecinos en el mundo
+  m_texels.clear();
+  m_pixelTexel.assign(candidates.size(), kInvalidTriangle);
+  for (size_t pixel = 0; pixel < candidates.size(); ++pixel) {
+    if (covered[pixel]) {
+      m_pixelTexel[pixel] = static_cast<unsigned int>(m_texels.size());
+      m_texels.push_back(candidates[pixel]);
+    }
+  }
+}
+
+bool
+LightmapBaker::sampleEmitter(const Emitter& emitter,
+                             const float position[3],
+                             const float normal[3],
+                             BVHRay& shadow,
+                             float color[3]) const {
+  float toLight[3];
+  float distance = FLT_MAX;
+  float attenuation = 1.0f;
+  if (emitter.directional) {
+    toLight[0] = emitter.direction.x;
+    toLight[1] = emitter.direction.y;
+    toLight[2] = emitter.direction.z;
+  }
+  else {
+    toLight[0] = emitter.position.x - position[0];
+    toLight[1] = emitter.position.y - position[1];
+    toLight[2] = emitter.position.z - position[2];
+    const float distanceSquared = dot3(toLight, toLight);
+    const float rangeSquared = emitter.range * emitter.range;
+    if (distanceSquared >= rangeSquared || distanceSquared <= 0.0f) {
+      return false;
+    }
+    distance = std::sqrt(distanceSquared);
+    toLight[0] /= distance;
+    toLight[1] /= distance;
+    toLight[2] /= distance;
+    // Ventana que llega a cero en `range` y el cono del spot como en `LightUtils::pack`
+    const float window = 1.0f - distanceSquared / rangeSquared;
+    const float spot[3] = { emitter.direction.x, emitter.direction.y, emitter.direction.z };
+    const float cone = std::min(1.0f, std::max(0.0f, -dot3(toLight, spot) * emitter.spotScale + emitter.spotOffset));
+    attenuation = window * window * cone;
+  }
+  const float cosine = dot3(normal, toLight);
+  if (cosine <= 0.0f || attenuation <= 0.0f) {
+    return false;
+  }
+  color[0] = emitter.color.x * cosine * attenuation;
+  color[1] = emitter.color.y * cosine * attenuation;
+  color[2] = emitter.color.z * cosine * attenuation;
+  shadow.origin = XMFLOAT3(position[0], position[1], position[2]);
+  shadow.direction = XMFLOAT3(toLight[0], toLight[1], toLight[2]);
+  shadow.maxDistance = emitter.directional ? FLT_MAX : distance - m_epsilon;
+  return true;
+}
+
+void
+LightmapBaker::traceTexel(size_t index, unsigned long long& rays) {
+  const unsigned int kLanes = kLightmapSamplesPerPass;
+  const Texel& texel = m_texels[index];
+  PathRandom random(static_cast<unsigned long long>(index) << 32 | m_pass);
+  const float origin[3] = { texel.position.x, texel.position.y, texel.position.z };
+  const float normal[3] = { texel.normal.x, texel.normal.y, texel.normal.z };
+  const float geometric[3] = { texel.geometric.x, texel.geometric.y, texel.geometric.z };
+  const unsigned int numEmitters = static_cast<unsigned int>(m_emitters.size());
+
+  float radiance[kLanes][3] = {};
+  float throughput[kLanes][3];
+  float shadowColor[kLanes][3];
+  bool alive[kLanes];
+  bool occluded[kLanes];
+  BVHRay paths[kLanes];
+  BVHHit hits[kLanes];
+  BVHRay shadows[kLanes];
+  for (unsigned int lane = 0; lane < kLanes; ++lane) {
+    shadows[lane].origin = texel.position;
+    shadows[lane].direction = texel.normal;
+    shadows[lane].maxDistance = 0.0f;
+  }
+
+  // Luz directa del texel: cada carril prueba una luz, repartidas entre carriles y pasadas
+  if (numEmitters > 0) {
+    unsigned int numShadows = 0;
+    for (unsigned int lane = 0; lane < kLanes; ++lane) {
+      const Emitter& emitter = m_emitters[(lane + m_pass * kLanes) % numEmitters];
+      if (sampleEmitter(emitter, origin, normal, shadows[lane], shadowColor[lane])) {
+        ++numShadows;
+      }
+      else {
+        shadows[lane].maxDistance = 0.0f;
+      }
+    }
+    if (numShadows > 0) {
+      m_bvh.occluded8(shadows, occluded);
+      rays += numShadows;
+      for (unsigned int lane = 0; lane < kLanes; ++lane) {
+        if (shadows[lane].maxDistance > 0.0f && !occluded[lane]) {
+          for (int c = 0; c < 3; ++c) {
+            radiance[lane][c] += shadowColor[lane][c] * numEmitters;
+          }
+        }
+      }
+    }
+  }
+
+  // Indirecta: un camino por carril, todos los carriles juntos en cada rebote
+  for (unsigned int lane = 0; lane < kLanes; ++lane) {
+    float direction[3];
+    sampleCosine(normal, random.next(), random.next(), direction);
+    // Con normales interpoladas la muestra puede quedar bajo el triángulo: la reflejo
+    const float below = dot3(direction, geometric);
+    if (below < 0.0f) {
+      for (int c = 0; c < 3; ++c) {
+        direction[c] -= 2.0f * below * geometric[c];
+      }
+    }
+    paths[lane].origin = texel.position;
+    paths[lane].direction = XMFLOAT3(direction[0], direction[1], direction[2]);
+    paths[lane].maxDistance = FLT_MAX;
+    throughput[lane][0] = throughput[lane][1] = throughput[lane][2] = 1.0f;
+    alive[lane] = true;
+  }
+  const unsigned int maxBounces = std::max(1u, m_settings.maxBounces);
+  unsigned int numAlive = kLanes;
+  for (unsigned int bounce = 0; bounce < maxBounces && numAlive > 0; ++bounce) {
+    m_bvh.intersect8(paths, hits);
+    rays += numAlive;
+
+    unsigned int numShadows = 0;
+    for (unsigned int lane = 0; lane < kLanes; ++lane) {
+      shadows[lane].maxDistance = 0.0f;
+      if (!alive[lane]) {
+        continue;
+      }
+      BVHRay& path = paths[lane];
+      if (hits[lane].triangle == kInvalidTriangle) {
+        for (int c = 0; c < 3; ++c) {
+          radiance[lane][c] += throughput[lane][c] * (&m_sky.x)[c];
+        }
+        alive[lane] = false;
+        path.maxDistance = 0.0f;
+        --numAlive;
+        continue;
+      }
+
+      // La normal del triángulo hacia de donde vino el rayo (las caras son de dos lados)
+      const XMFLOAT3& triangleNormal = m_triangleNormals[hits[lane].triangle];
+      const float direction[3] = { path.direction.x, path.direction.y, path.direction.z };
+      float n[3] = { triangleNormal.x, triangleNormal.y, triangleNormal.z };
+      if (dot3(n, direction) > 0.0f) {
+        n[0] = -n[0];
+        n[1] = -n[1];
+        n[2] = -n[2];
+      }
+      const float distance = hits[lane].distance;
+      const float point[3] = { path.origin.x + direction[0] * distance + n[0] * m_epsilon,
+                               path.origin.y + direction[1] * distance + n[1] * m_epsilon,
+                               path.origin.z + direction[2] * distance + n[2] * m_epsilon };
+      const XMFLOAT3& albedo = m_triangleAlbedo[hits[lane].triangle];
+      throughput[lane][0] *= albedo.x;
+      throughput[lane][1] *= albedo.y;
+      throughput[lane][2] *= albedo.z;
+
+      // Next event estimation contra una luz al azar
+      if (numEmitters > 0) {
+        const unsigned int pick = std::min(static_cast<unsigned int>(random.next() * numEmitters), numEmitters - 1);
+        float color[3];
+        if (sampleEmitter(m_emitters[pick], point, n, shadows[lane], color)) {
+          for (int c = 0; c < 3; ++c) {
+            shadowColor[lane][c] = throughput[lane][c] * color[c] * numEmitters;
+          }
+          ++numShadows;
+        }
+        else {
+          shadows[lane].maxDistance = 0.0f;
+        }
+      }
+
+      // Sigue el camino; desde el segundo rebote con ruleta rusa
+      bool continues = bounce + 1 < maxBounces;
+      if (continues && bounce >= 1) {
+        const float survive = std::min(0.95f, std::max(0.05f, std::max(throughput[lane][0],
+                                                                       std::max(throughput[lane][1], throughput[lane][2]))));
+        continues = random.next() < survive;
+        for (int c = 0; c < 3; ++c) {
+          throughput[lane][c] /= survive;
+        }
+      }
+      if (!continues) {
+        alive[lane] = false;
+        path.maxDistance = 0.0f;
+        --numAlive;
+        continue;
+      }
+      float next[3];
+      sampleCosine(n, random.next(), random.next(), next);
+      path.origin = XMFLOAT3(point[0], point[1], point[2]);
+      path.direction = XMFLOAT3(next[0], next[1], next[2]);
+      path.maxDistance = FLT_MAX;
+    }
+
+    if (numShadows > 0) {
+      m_bvh.occluded8(shadows, occluded);
+      rays += numShadows;
+      for (unsigned int lane = 0; lane < kLanes; ++lane) {
+        if (shadows[lane].maxDistance > 0.0f && !occluded[lane]) {
+          for (int c = 0; c < 3; ++c) {
+            radiance[lane][c] += shadowColor[lane][c];
+          }
+        }
+      }
+    }
+  }
+
+  XMFLOAT3& sum = m_accum[index];
+  float squared = 0.0f;
+  for (unsigned int lane = 0; lane < kLanes; ++lane) {
+    sum.x += radiance[lane][0];
+    sum.y += radiance[lane][1];
+    sum.z += radiance[lane][2];
+    const float value = luminance(radiance[lane]);
+    squared += value * value;
+  }
+  m_accumSquared[index] += squared;
+  m_samples[index] += kLanes;
+}
+
+void
+LightmapBaker::traceRange(size_t first, size_t last) {
+  Timer timer;
+  JobSystem::getInstance().parallelFor(last - first, 16, [&](size_t begin, size_t end) {
+    unsigned long long rays = 0;
+    for (size_t i = begin; i < end; ++i) {
+      traceTexel(first + i, rays);
+    }
+    m_rays += rays;
+  });
+  m_stats.traceMs += timer.elapsedMs();
+  m_stats.rays = m_rays;
+}
+
+bool
+LightmapBaker::step(double budgetMs) {
+  if (!isBaking()) {
+    return isFinished();
+  }
+  Timer timer;
+  const size_t chunk = std::max<size_t>(256, JobSystem::getInstance().getNumThreads() * 64);
+  do {
+    const size_t last = std::min(m_texels.size(), m_cursor + chunk);
+    traceRange(m_cursor, last);
+    m_cursor = last;
+    if (m_cursor == m_texels.size()) {
+      completePass();
+    }
+  } while (isBaking() && timer.elapsedMs() < budgetMs);
+  return isFinished();
+}
+
+void
+LightmapBaker::bakePass() {
+  if (!isBaking()) {
+    return;
+  }
+  traceRange(m_cursor, m_texels.size());
+  m_cursor = m_texels.size();
+  completePass();
+}
+
+void
+LightmapBaker::completePass() {
+  ++m_pass;
+  m_cursor = 0;
+  m_stats.passes = m_pass;
+  if (m_pass >= std::max(1u, m_settings.passes)) {
+    finish();
+    return;
+  }
+  std::vector<XMFLOAT3> pixels;
+  resolve(pixels, true);
+  updatePreview(pixels);
+}
+
+void
+LightmapBaker::finish() {
+  if (m_texels.empty()) {
+    return;
+  }
+  Timer timer;
+  resolve(m_result, true);
+  m_stats.denoiseMs = timer.elapsedMs();
+
+  m_data = LightmapData();
+  m_data.width = m_atlas.width;
+  m_data.height = m_atlas.height;
+  m_data.texelsPerUnit = m_atlas.texelsPerUnit;
+  m_data.scaleOffsets = m_atlas.scaleOffsets;
+  for (unsigned int unwrap : m_instanceUnwrap) {
+    m_data.geometryHashes.push_back(m_unwraps[unwrap].geometryHash);
+  }
+  m_data.texels.resize(m_result.size());
+  for (size_t i = 0; i < m_result.size(); ++i) {
+    m_data.texels[i] = encodeRGB9E5(m_result[i]);
+  }
+  updatePreview(m_result);
+  m_state = STATE_FINISHED;
+}
+
+void
+LightmapBaker::cancel() {
+  m_state = STATE_IDLE;
+  m_cursor = 0;
+}
+
+float
+LightmapBaker::getProgress() const {
+  if (isFinished()) {
+    return 1.0f;
+  }
+  if (!isBaking() || m_texels.empty()) {
+    return 0.0f;
+  }
+  const float passes = static_cast<float>(std::max(1u, m_settings.passes));
+  return (m_pass + static_cast<float>(m_cursor) / m_texels.size()) / passes;
+}
+
+void
+LightmapBaker::getIrradiance(std::vector<XMFLOAT3>& pixels) const {
+  pixels.assign(static_cast<size_t>(m_atlas.width) * m_atlas.height, XMFLOAT3(0.0f, 0.0f, 0.0f));
+  for (size_t i = 0; i < m_texels.size(); ++i) {
+    if (m_samples[i] > 0) {
+      const float scale = 1.0f / m_samples[i];
+      pixels[m_texels[i].pixel] = XMFLOAT3(m_accum[i].x * scale, m_accum[i].y * scale, m_accum[i].z * scale);
+    }
+  }
+}
+
+void
+LightmapBaker::resolve(std::vector<XMFLOAT3>& pixels, bool filtered) {
+  getIrradiance(pixels);
+  if (!filtered) {
+    return;
+  }
+  if (m_settings.denoise && m_settings.denoiseIterations > 0) {
+    // Varianza del promedio por texel (la del filtro: entre más muestras, menos se confía en vecinos)
+    std::vector<float> variance(pixels.size(), 0.0f);
+    for (size_t i = 0; i < m_texels.size(); ++i) {
+      if (m_samples[i] > 0) {
+        const float samples = static_cast<float>(m_samples[i]);
+        const float* mean = &pixels[m_texels[i].pixel].x;
+        const float lum = luminance(mean);
+        variance[m_texels[i].pixel] = std::max(0.0f, m_accumSquared[i] / samples - lum * lum) / samples;
+      }
+    }
+    denoise(pixels, variance);
+  }
+  dilate(pixels);
+}
+
+void
+LightmapBaker::denoise(std::vector<XMFLOAT3>& pixels, std::vector<float>& variance) const {
+  const float kKernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+  const int width = static_cast<int>(m_atlas.width);
+  const int height = static_cast<int>(m_atlas.height);
+  // La densidad del atlas es uniforme en mundo: un texel mide lo mismo en todas las instancias
+  const float texelSize = 1.0f / std::max(m_atlas.texelsPerUnit, 1e-6f);
+  std::vector<XMFLOAT3> next(pixels.size());
+  std::vector<float> nextVariance(pixels.size());
+
+  for (unsigned int iteration = 0; iteration < m_settings.denoiseIterations; ++iteration) {
+    const int stepSize = 1 << iteration;
+    const float sigmaPosition = texelSize * stepSize * 2.0f;
+    const float invPosition = 1.0f / (sigmaPosition * sigmaPosition);
+    JobSystem::getInstance().parallelFor(height, 4, [&](size_t firstRow, size_t lastRow) {
+      for (int y = static_cast<int>(firstRow); y < static_cast<int>(lastRow); ++y) {
+        for (int x = 0; x < width; ++x) {
+          const size_t p = static_cast<size_t>(y) * width + x;
+          const unsigned int center = m_pixelTexel[p];
+          if (center == kInvalidTriangle) {
+            next[p] = pixels[p];
+            nextVariance[p] = variance[p];
+            continue;
+          }
+          const Texel& texelP = m_texels[center];
+          const float lumP = luminance(&pixels[p].x);
+          const float sigmaLuminance = 4.0f * std::sqrt(variance[p]) + 1e-4f;
+
+          float sum[3] = { 0.0f, 0.0f, 0.0f };
+          float weightSum = 0.0f;
+          float varianceSum = 0.0f;
+          for (int dy = -2; dy <= 2; ++dy) {
+            const int qy = y + dy * stepSize;
+            if (qy < 0 || qy >= height) {
+              continue;
+            }
+            for (int dx = -2; dx <= 2; ++dx) {
+              const int qx = x + dx * stepSize;
+              if (qx < 0 || qx >= width) {
+                continue;
+              }
+              const size_t q = static_cast<size_t>(qy) * width + qx;
+              const unsigned int other = m_pixelTexel[q];
+              if (other == kInvalidTriangle) {
+                continue;
+              }
+              const Texel& texelQ = m_texels[other];
+              // Normal (coseno^64), distancia en mundo y diferencia de luminancia contra el ruido
+              float normalWeight = std::max(0.0f, texelP.normal.x * texelQ.normal.x +
+                                                  texelP.normal.y * texelQ.normal.y +
+                                                  texelP.normal.z * texelQ.normal.z);
+              for (int s = 0; s < 6; ++s) {
+                normalWeight *= normalWeight;
+              }
+              const float d[3] = { texelP.position.x - texelQ.position.x,
+                                   texelP.position.y - texelQ.position.y,
+                                   texelP.position.z - texelQ.position.z };
+              const float positionWeight = std::exp(-dot3(d, d) * invPosition);
+              const float luminanceWeight = std::exp(-std::fabs(lumP - luminance(&pixels[q].x)) / sigmaLuminance);
+              const float weight = kKernel[dx + 2] * kKernel[dy + 2] * normalWeight * positionWeight * luminanceWeight;
+              sum[0] += pixels[q].x * weight;
+              sum[1] += pixels[q].y * weight;
+              sum[2] += pixels[q].z * weight;
+              weightSum += weight;
+              varianceSum += weight * weight * variance[q];
+            }
+          }
+          // El pixel central siempre se pesa a sí mismo, así que weightSum > 0
+          next[p] = XMFLOAT3(sum[0] / weightSum, sum[1] / weightSum, sum[2] / weightSum);
+          nextVariance[p] = varianceSum / (weightSum * weightSum);
+        }
+      }
+    });
+    pixels.swap(next);
+    variance.swap(nextVariance);
+  }
+}
+
+void
+LightmapBaker::dilate(std::vector<XMFLOAT3>& pixels) const {
+  // Los pixeles del margen toman el promedio de sus vecinos con valor, un anillo por vuelta
+  const int width = static_cast<int>(m_atlas.width);
+  const int height = static_cast<int>(m_atlas.height);
+  std::vector<unsigned char> filled(pixels.size());
+  for (size_t p = 0; p < pixels.size(); ++p) {
+    filled[p] = m_pixelTexel[p] != kInvalidTriangle;
+  }
+  std::vector<unsigned char> nextFilled;
+  std::vector<XMFLOAT3> next;
+  const unsigned int rings = m_settings.pack.padding + 1;
+  for (unsigned int ring = 0; ring < rings; ++ring) {
+    nextFilled = filled;
+    next = pixels;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const size_t p = static_cast<size_t>(y) * width + x;
+        if (filled[p]) {
+          continue;
+        }
+        float sum[3] = { 0.0f, 0.0f, 0.0f };
+        unsigned int count = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+          for (int dx = -1; dx <= 1; ++dx) {
+            const int qx = x + dx;
+            const int qy = y + dy;
+            if (qx < 0 || qy < 0 || qx >= width || qy >= height || !filled[static_cast<size_t>(qy) * width + qx]) {
+              continue;
+            }
+            const XMFLOAT3& value = pixels[static_cast<size_t>(qy) * width + qx];
+            sum[0] += value.x;
+            sum[1] += value.y;
+            sum[2] += value.z;
+            ++count;
+          }
+        }
+        if (count > 0) {
+          next[p] = XMFLOAT3(sum[0] / count, sum[1] / count, sum[2] / count);
+          nextFilled[p] = 1;
+        }
+      }
+    }
+    pixels.swap(next);
+    filled.swap(nextFilled);
+  }
+}
+
+void
+LightmapBaker::updatePreview(const std::vector<XMFLOAT3>& pixels) {
+  m_preview.resize(pixels.size());
+  for (size_t p = 0; p < pixels.size(); ++p) {
+    const float rgb[3] = { pixels[p].x, pixels[p].y, pixels[p].z };
+    unsigned int packed = 0xFF000000u;
+    for (int c = 0; c < 3; ++c) {
+      const float mapped = std::pow(std::max(0.0f, rgb[c]) / (1.0f + std::max(0.0f, rgb[c])), 1.0f / 2.2f);
+      packed |= static_cast<unsigned int>(mapped * 255.0f + 0.5f) << (c * 8);
+    }
+    m_preview[p] = packed;
+  }
+  ++m_previewVersion;
+}
+
+unsigned int
+LightmapBaker::encodeRGB9E5(const XMFLOAT3& color) {
+  // Formato de D3D: 9 bits de mantisa por canal y un exponente compartido de 5 (sesgo 15)
+  const float kMaxValue = 65408.0f;
+  const float r = std::min(kMaxValue, std::max(0.0f, color.x));
+  const float g = std::min(kMaxValue, std::max(0.0f, color.y));
+  const float b = std::min(kMaxValue, std::max(0.0f, color.z));
+  const float maxChannel = std::max(r, std::max(g, b));
+  if (!(maxChannel > 0.0f)) {
+    return 0;
+  }
+  int exponent = 0;
+  std::frexp(maxChannel, &exponent);
+  int shared = std::max(-16, exponent - 1) + 16;
+  float scale = std::ldexp(1.0f, shared - 24);
+  if (std::floor(maxChannel / scale + 0.5f) >= 512.0f) {
+    ++shared;
+    scale *= 2.0f;
+  }
+  const unsigned int red = static_cast<unsigned int>(std::floor(r / scale + 0.5f));
+  const unsigned int green = static_cast<unsigned int>(std::floor(g / scale + 0.5f));
+  const unsigned int blue = static_cast<unsigned int>(std::floor(b / scale + 0.5f));
+  return red | green << 9 | blue << 18 | static_cast<unsigned int>(shared) << 27;
+}
+
+XMFLOAT3
+LightmapBaker::decodeRGB9E5(unsigned int packed) {
+  const float scale = std::ldexp(1.0f, static_cast<int>(packed >> 27) - 24);
+  return XMFLOAT3((packed & 0x1FF) * scale, ((packed >> 9) & 0x1FF) * scale, ((packed >> 18) & 0x1FF) * scale);
+}
+
+HRESULT
+LightmapBaker::saveAsset(const std::string& path, const LightmapData& data) {
+  if (data.texels.size() != static_cast<size_t>(data.width) * data.height ||
+      data.scaleOffsets.size() != data.geometryHashes.size()) {
+    ERROR("LightmapBaker", "saveAsset", "Invalid lightmap data for " << path.c_str());
+    return E_INVALIDARG;
+  }
+  std::vector<unsigned char> encoded;
+  MeshCodec::encodeVertices(data.texels.data(), data.texels.size(), sizeof(unsigned int), encoded);
+
+  LightmapFileHeader header = {};
+  std::memcpy(header.magic, kLightmapMagic, sizeof(header.magic));
+  header.version = kLightmapVersion;
+  header.width = data.width;
+  header.height = data.height;
+  header.texelsPerUnit = data.texelsPerUnit;
+  header.numInstances = static_cast<unsigned int>(data.scaleOffsets.size());
+  header.dataBytes = static_cast<unsigned int>(encoded.size());
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    ERROR("LightmapBaker", "saveAsset", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(data.scaleOffsets.data()), data.scaleOffsets.size() * sizeof(XMFLOAT4));
+  file.write(reinterpret_cast<const char*>(data.geometryHashes.data()),
+             data.geometryHashes.size() * sizeof(unsigned long long));
+  file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+  if (!file) {
+    ERROR("LightmapBaker", "saveAsset", "Failed to write " << path.c_str());
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+bool
+LightmapBaker::loadAsset(const std::string& path, LightmapData& data) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  const unsigned long long fileSize = static_cast<unsigned long long>(file.tellg());
+  file.seekg(0);
+  LightmapFileHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || std::memcmp(header.magic, kLightmapMagic, sizeof(header.magic)) != 0 ||
+      header.version != kLightmapVersion || header.width == 0 || header.height == 0 ||
+      header.width > 16384 || header.height > 16384) {
+    return false;
+  }
+  // Los tamaños del encabezado tienen que cuadrar con el archivo antes de reservar nada
+  const unsigned long long instanceBytes =
+    static_cast<unsigned long long>(header.numInstances) * (sizeof(XMFLOAT4) + sizeof(unsigned long long));
+  if (sizeof(header) + instanceBytes + header.dataBytes != fileSize) {
+    ERROR("LightmapBaker", "loadAsset", "Corrupt lightmap asset " << path.c_str());
+    return false;
+  }
+
+  LightmapData loaded;
+  loaded.width = header.width;
+  loaded.height = header.height;
+  loaded.texelsPerUnit = header.texelsPerUnit;
+  loaded.scaleOffsets.resize(header.numInstances);
+  loaded.geometryHashes.resize(header.numInstances);
+  file.read(reinterpret_cast<char*>(loaded.scaleOffsets.data()), loaded.scaleOffsets.size() * sizeof(XMFLOAT4));
+  file.read(reinterpret_cast<char*>(loaded.geometryHashes.data()),
+            loaded.geometryHashes.size() * sizeof(unsigned long long));
+  std::vector<unsigned char> encoded(header.dataBytes);
+  file.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+  if (!file) {
+    return false;
+  }
+  loaded.texels.resize(static_cast<size_t>(header.width) * header.height);
+  if (!MeshCodec::decodeVertices(loaded.texels.data(), loaded.texels.size(), sizeof(unsigned int),
+                                 encoded.data(), encoded.size())) {
+    return false;
+  }
+  data = std::move(loaded);
+  return true;
+}
+
+namespace {
+
+  void
+  addFace(MeshComponent& mesh, const XMFLOAT3& normal, const XMFLOAT3& u, const XMFLOAT3& v) {
+    const unsigned int base = static_cast<unsigned int>(mesh.m_vertex.size());
+    const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+    for (int c = 0; c < 4; ++c) {
+      SimpleVertex vertex = {};
+      vertex.Pos = XMFLOAT3(0.5f * (normal.x + corners[c][0] * u.x + corners[c][1] * v.x),
+                            0.5f * (normal.y + corners[c][0] * u.y + corners[c][1] * v.y),
+                            0.5f * (normal.z + corners[c][0] * u.z + corners[c][1] * v.z));
+      vertex.Tex = XMFLOAT2(corners[c][0] * 0.5f + 0.5f, corners[c][1] * 0.5f + 0.5f);
+      vertex.Normal = normal;
+      mesh.m_vertex.push_back(vertex);
+    }
+    const unsigned int quad[6] = { 0, 2, 1, 0, 3, 2 };
+    for (unsigned int index : quad) {
+      mesh.m_index.push_back(base + index);
+    }
+  }
+
+  /**
+   * @brief Cubo unitario centrado con 4 vértices por cara.
+   */
+  MeshComponent
+  makeBox() {
+    MeshComponent mesh;
+    mesh.m_name = "box";
+    addFace(mesh, XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f));
+    addFace(mesh, XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(1.0f, 0.0f, 0.0f));
+    addFace(mesh, XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+    addFace(mesh, XMFLOAT3(-1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f));
+    addFace(mesh, XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(1.0f, 0.0f, 0.0f));
+    addFace(mesh, XMFLOAT3(0.0f, 0.0f, -1.0f), XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Piso de 1x1 en XZ (normal +Y) con `cells` x `cells` celdas.
+   */
+  MeshComponent
+  makeFloor(unsigned int cells) {
+    MeshComponent mesh;
+    mesh.m_name = "floor";
+    for (unsigned int z = 0; z <= cells; ++z) {
+      for (unsigned int x = 0; x <= cells; ++x) {
+        SimpleVertex vertex = {};
+        vertex.Pos = XMFLOAT3(static_cast<float>(x) / cells - 0.5f, 0.0f, static_cast<float>(z) / cells - 0.5f);
+        vertex.Tex = XMFLOAT2(static_cast<float>(x) / cells, static_cast<float>(z) / cells);
+        vertex.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+        mesh.m_vertex.push_back(vertex);
+      }
+    }
+    for (unsigned int z = 0; z < cells; ++z) {
+      for (unsigned int x = 0; x < cells; ++x) {
+        const unsigned int a = z * (cells + 1) + x;
+        const unsigned int quad[6] = { a, a + cells + 1, a + 1, a + 1, a + cells + 1, a + cells + 2 };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Esfera de radio 0.5 por anillos (con costura de UV duplicada, como las de los importadores).
+   */
+  MeshComponent
+  makeSphere(unsigned int rings, unsigned int segments) {
+    MeshComponent mesh;
+    mesh.m_name = "sphere";
+    for (unsigned int r = 0; r <= rings; ++r) {
+      const float theta = XM_PI * r / rings;
+      for (unsigned int s = 0; s <= segments; ++s) {
+        const float phi = XM_2PI * s / segments;
+        SimpleVertex vertex = {};
+        vertex.Normal = XMFLOAT3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        vertex.Pos = XMFLOAT3(vertex.Normal.x * 0.5f, vertex.Normal.y * 0.5f, vertex.Normal.z * 0.5f);
+        vertex.Tex = XMFLOAT2(static_cast<float>(s) / segments, static_cast<float>(r) / rings);
+        mesh.m_vertex.push_back(vertex);
+      }
+    }
+    for (unsigned int r = 0; r < rings; ++r) {
+      for (unsigned int s = 0; s < segments; ++s) {
+        const unsigned int a = r * (segments + 1) + s;
+        const unsigned int b = a + segments + 1;
+        const unsigned int quad[6] = { a, a + 1, b, a + 1, b + 1, b };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  LightmapInstance
+  makeInstance(const MeshComponent& mesh,
+               const XMFLOAT3& scale,
+               const XMFLOAT3& position,
+               const XMFLOAT3& albedo = XMFLOAT3(0.8f, 0.8f, 0.8f)) {
+    LightmapInstance instance;
+    instance.mesh = &mesh;
+    XMStoreFloat4x4(&instance.world, XMMatrixMultiply(XMMatrixScaling(scale.x, scale.y, scale.z),
+                                                      XMMatrixTranslation(position.x, position.y, position.z)));
+    instance.albedo = albedo;
+    return instance;
+  }
+
+  bool
+  rectsOverlap(const XMFLOAT4& a, const XMFLOAT4& b) {
+    const float kTolerance = 1e-5f;
+    return a.x < b.z - kTolerance && b.x < a.z - kTolerance && a.y < b.w - kTolerance && b.y < a.w - kTolerance;
+  }
+
+  /**
+   * @brief Error cuadrático medio contra una referencia en los pixeles con texel.
+   */
+  double
+  rmse(const std::vector<XMFLOAT3>& value,
+       const std::vector<XMFLOAT3>& reference,
+       const std::vector<unsigned char>& mask) {
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t p = 0; p < value.size(); ++p) {
+      if (!mask[p]) {
+        continue;
+      }
+      const double d[3] = { value[p].x - reference[p].x, value[p].y - reference[p].y, value[p].z - reference[p].z };
+      sum += d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+      ++count;
+    }
+    return count > 0 ? std::sqrt(sum / count) : 0.0;
+  }
+
+
+  /**
+   * @brief Copio el asset cambiando un campo del encabezado y regreso true si `loadAsset` lo rechaza.
+   */
+  bool
+  corruptAssetRejected(const std::string& path, size_t fieldOffset, unsigned int value) {
+    std::ifstream source(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(LightmapFileHeader)) {
+      return false;
+    }
+    std::memcpy(&bytes[fieldOffset], &value, sizeof(value));
+    const std::string corruptPath = path + ".corrupt";
+    std::ofstream(corruptPath, std::ios::binary).write(bytes.data(), bytes.size());
+    LightmapData data;
+    const bool rejected = !LightmapBaker::loadAsset(corruptPath, data);
+    std::remove(corruptPath.c_str());
+    return rejected;
+  }
+} // namespace
+
+void
+LightmapBaker::runBenchmark(BenchmarkReport& report) {
+  const MeshComponent box = makeBox();
+  const MeshComponent floor = makeFloor(8);
+  const MeshComponent sphere = makeSphere(16, 24);
+
+  // Unwrap: una cara del cubo por chart, el piso en uno solo y nada encimado
+  LightmapPackSettings packSettings;
+  Timer timer;
+  const MeshComponent* meshes[3] = { &box, &floor, &sphere };
+  LightmapUnwrap unwraps[3];
+  for (int m = 0; m < 3; ++m) {
+    LightmapPacker::unwrap(*meshes[m], packSettings, unwraps[m]);
+  }
+  const double unwrapMs = timer.elapsedMs();
+  for (int m = 0; m < 3; ++m) {
+    const MeshComponent& mesh = *meshes[m];
+    const LightmapUnwrap& unwrap = unwraps[m];
+    if (unwrap.indices.size() != mesh.m_index.size() || unwrap.uv.size() != unwrap.remap.size()) {
+      report.fail("unwrap of " + mesh.m_name + " lost triangles or vertices");
+      continue;
+    }
+    bool inside = true;
+    for (const XMFLOAT2& uv : unwrap.uv) {
+      inside = inside && uv.x >= 0.0f && uv.x <= 1.0f && uv.y >= 0.0f && uv.y <= 1.0f;
+    }
+    bool samePositions = true;
+    for (size_t i = 0; i < unwrap.indices.size(); ++i) {
+      samePositions = samePositions &&
+        std::memcmp(&mesh.m_vertex[unwrap.remap[unwrap.indices[i]]].Pos, &mesh.m_vertex[mesh.m_index[i]].Pos,
+                    sizeof(XMFLOAT3)) == 0;
+    }
+    bool overlap = false;
+    for (size_t a = 0; a < unwrap.chartRects.size(); ++a) {
+      for (size_t b = a + 1; b < unwrap.chartRects.size(); ++b) {
+        overlap = overlap || rectsOverlap(unwrap.chartRects[a], unwrap.chartRects[b]);
+      }
+    }
+    if (!inside || !samePositions || overlap) {
+      report.fail("unwrap of " + mesh.m_name + " is invalid (UV outside, wrong triangles or overlapping charts)");
+    }
+  }
+  if (unwraps[0].chartRects.size() != 6 || unwraps[1].chartRects.size() != 1) {
+    report.fail("expected 6 charts on the box and 1 on the floor");
+  }
+  report.log("unwrap: box %u charts, floor %u, sphere %u (%u -> %u vertices) in %.2f ms",
+             static_cast<unsigned int>(unwraps[0].chartRects.size()),
+             static_cast<unsigned int>(unwraps[1].chartRects.size()),
+             static_cast<unsigned int>(unwraps[2].chartRects.size()),
+             static_cast<unsigned int>(sphere.m_vertex.size()), static_cast<unsigned int>(unwraps[2].uv.size()),
+             unwrapMs);
+
+  // Casos analíticos en un piso solo: todo rayo se escapa y la luz directa es exacta
+  {
+    LightmapBakeSettings settings;
+    settings.pack.atlasSize = 64;
+    settings.pack.texelsPerUnit = 4.0f;
+    settings.passes = 1;
+    settings.denoise = false;
+    settings.skyColor = XMFLOAT3(0.5f, 0.6f, 0.7f);
+    settings.sunColor = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    const std::vector<LightmapInstance> instances(1, makeInstance(floor, XMFLOAT3(10.0f, 1.0f, 10.0f),
+                                                                  XMFLOAT3(0.0f, 0.0f, 0.0f)));
+    LightmapBaker baker;
+    float skyError = 1.0f;
+    if (SUCCEEDED(baker.begin(instances, std::vector<Light>(), settings))) {
+      baker.bakePass();
+      skyError = 0.0f;
+      for (size_t i = 0; i < baker.m_texels.size(); ++i) {
+        const float* value = &baker.m_accum[i].x;
+        for (int c = 0; c < 3; ++c) {
+          skyError = std::max(skyError, std::fabs(value[c] / baker.m_samples[i] - (&settings.skyColor.x)[c]));
+        }
+      }
+    }
+
+    // Sol inclinado (N·L = 0.8) más una luz puntual a 2 unidades del piso
+    settings.skyColor = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    settings.sunColor = XMFLOAT3(1.0f, 1.0f, 1.0f);
+    settings.sunDirection = XMFLOAT3(0.6f, -0.8f, 0.0f);
+    Light point;
+    point.position = XMFLOAT3(1.0f, 2.0f, -1.0f);
+    point.range = 4.0f;
+    point.intensity = 2.0f;
+    float lightError = 1.0f;
+    if (SUCCEEDED(baker.begin(instances, std::vector<Light>(1, point), settings))) {
+      baker.bakePass();
+      lightError = 0.0f;
+      for (size_t i = 0; i < baker.m_texels.size(); ++i) {
+        const XMFLOAT3& p = baker.m_texels[i].position;
+        const float d[3] = { point.position.x - p.x, point.position.y - p.y, point.position.z - p.z };
+        const float distanceSquared = dot3(d, d);
+        float expected = 0.8f;
+        if (distanceSquared < point.range * point.range) {
+          const float window = 1.0f - distanceSquared / (point.range * point.range);
+          expected += point.intensity * (d[1] / std::sqrt(distanceSquared)) * window * window;
+        }
+        lightError = std::max(lightError, std::fabs(baker.m_accum[i].y / baker.m_samples[i] - expected));
+      }
+    }
+    if (skyError > 1e-5f || lightError > 1e-4f) {
+      report.fail("a bare floor does not match the analytic sky and direct light");
+    }
+    report.log("analytic floor: max error %.2g under the sky, %.2g under sun + point light", skyError, lightError);
+  }
+
+  // Una caja flotando sobre el piso: sombra, denoise contra referencia y determinismo
+  {
+    LightmapBakeSettings settings;
+    settings.pack.atlasSize = 64;
+    settings.pack.texelsPerUnit = 6.0f;
+    settings.sunDirection = XMFLOAT3(0.0f, -1.0f, 0.0f);
+    settings.denoise = false;
+    std::vector<LightmapInstance> instances;
+    instances.push_back(makeInstance(floor, XMFLOAT3(6.0f, 1.0f, 6.0f), XMFLOAT3(0.0f, 0.0f, 0.0f)));
+    instances.push_back(makeInstance(box, XMFLOAT3(1.5f, 1.5f, 1.5f), XMFLOAT3(0.0f, 1.5f, 0.0f),
+                                     XMFLOAT3(0.9f, 0.3f, 0.2f)));
+
+    settings.passes = 48;
+    LightmapBaker reference;
+    std::vector<XMFLOAT3> referencePixels;
+    if (FAILED(reference.begin(instances, std::vector<Light>(), settings))) {
+      report.fail("could not start the reference bake");
+      return;
+    }
+    while (!reference.step(1e9)) {
+    }
+    reference.getIrradiance(referencePixels);
+
+    // Bajo la caja (|x|, |z| < 0.6) contra lo abierto (|x| o |z| > 2) en el piso
+    double shadowed = 0.0, open = 0.0;
+    unsigned int numShadowed = 0, numOpen = 0;
+    for (size_t i = 0; i < reference.m_texels.size(); ++i) {
+      const XMFLOAT3& p = reference.m_texels[i].position;
+      if (std::fabs(p.y) > 0.01f) {
+        continue;
+      }
+      const float value = luminance(&referencePixels[reference.m_texels[i].pixel].x);
+      if (std::fabs(p.x) < 0.6f && std::fabs(p.z) < 0.6f) {
+        shadowed += value;
+        ++numShadowed;
+      }
+      else if (std::fabs(p.x) > 2.0f || std::fabs(p.z) > 2.0f) {
+        open += value;
+        ++numOpen;
+      }
+    }
+    shadowed /= std::max(1u, numShadowed);
+    open /= std::max(1u, numOpen);
+    if (numShadowed == 0 || numOpen == 0 || shadowed > 0.5 * open) {
+      report.fail("the floating box does not shadow the floor");
+    }
+
+    settings.passes = 2;
+    LightmapBaker noisy;
+    std::vector<XMFLOAT3> noisyPixels;
+    noisy.begin(instances, std::vector<Light>(), settings);
+    while (!noisy.step(1e9)) {
+    }
+    noisy.getIrradiance(noisyPixels);
+
+    settings.denoise = true;
+    LightmapBaker filtered;
+    filtered.begin(instances, std::vector<Light>(), settings);
+    while (!filtered.step(1e9)) {
+    }
+    LightmapBaker again;
+    again.begin(instances, std::vector<Light>(), settings);
+    while (!again.step(1e9)) {
+    }
+
+    std::vector<unsigned char> mask(referencePixels.size());
+    for (size_t p = 0; p < mask.size(); ++p) {
+      mask[p] = reference.m_pixelTexel[p] != kInvalidTriangle;
+    }
+    const double noisyError = rmse(noisyPixels, referencePixels, mask);
+    const double filteredError = rmse(filtered.getResult(), referencePixels, mask);
+    if (filteredError >= noisyError) {
+      report.fail("denoising did not bring 16 spp closer to the reference");
+    }
+    if (filtered.getData().texels != again.getData().texels) {
+      report.fail("baking the same scene twice gave different lightmaps");
+    }
+    report.log("shadow: %.3f under the box vs %.3f in the open; 16 spp RMSE %.4f -> %.4f denoised (ref %u spp)",
+               shadowed, open, noisyError, filteredError, 48 * kLightmapSamplesPerPass);
+  }
+
+  // RGB9E5: error relativo al canal más grande de a lo más media unidad de 9 bits
+  {
+    std::mt19937 rng(75);
+    std::uniform_real_distribution<float> logValue(-8.0f, 12.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float worstError = 0.0f;
+    for (int i = 0; i < 100000; ++i) {
+      const float scale = std::exp2(logValue(rng));
+      const XMFLOAT3 color(unit(rng) * scale, unit(rng) * scale, unit(rng) * scale);
+      const XMFLOAT3 decoded = decodeRGB9E5(encodeRGB9E5(color));
+      const float maxChannel = std::max(color.x, std::max(color.y, color.z));
+      if (maxChannel > 0.0f) {
+        worstError = std::max(worstError, std::max(std::fabs(decoded.x - color.x),
+                                                   std::max(std::fabs(decoded.y - color.y), std::fabs(decoded.z - color.z))) / maxChannel);
+      }
+    }
+    const XMFLOAT3 black = decodeRGB9E5(encodeRGB9E5(XMFLOAT3(-1.0f, 0.0f, 0.0f)));
+    if (worstError > 1.0f / 512.0f + 1e-6f || black.x != 0.0f || black.y != 0.0f || black.z != 0.0f) {
+      report.fail("RGB9E5 round trip is out of tolerance");
+    }
+    report.log("RGB9E5: worst error %.5f of the largest channel", worstError);
+  }
+
+  // Nivel de prueba: cuarto con muros, cajas y esferas que comparten malla, sol, cielo y 3 luces
+  std::vector<LightmapInstance> level;
+  level.push_back(makeInstance(floor, XMFLOAT3(16.0f, 1.0f, 16.0f), XMFLOAT3(0.0f, 0.0f, 0.0f)));
+  level.push_back(makeInstance(box, XMFLOAT3(16.0f, 4.0f, 0.5f), XMFLOAT3(0.0f, 2.0f, 8.0f), XMFLOAT3(0.7f, 0.7f, 0.6f)));
+  level.push_back(makeInstance(box, XMFLOAT3(0.5f, 4.0f, 16.0f), XMFLOAT3(-8.0f, 2.0f, 0.0f), XMFLOAT3(0.8f, 0.2f, 0.2f)));
+  level.push_back(makeInstance(box, XMFLOAT3(0.5f, 4.0f, 16.0f), XMFLOAT3(8.0f, 2.0f, 0.0f), XMFLOAT3(0.2f, 0.7f, 0.3f)));
+  for (int i = 0; i < 6; ++i) {
+    const float size = 1.0f + 0.25f * i;
+    level.push_back(makeInstance(box, XMFLOAT3(size, size, size),
+                                 XMFLOAT3(-5.0f + 2.0f * i, size * 0.5f, -3.0f + (i % 2) * 4.0f)));
+  }
+  for (int i = 0; i < 3; ++i) {
+    level.push_back(makeInstance(sphere, XMFLOAT3(1.5f, 1.5f, 1.5f), XMFLOAT3(-3.0f + 3.0f * i, 0.75f, 3.0f),
+                                 XMFLOAT3(0.9f, 0.9f, 0.9f)));
+  }
+  std::vector<Light> lights(3);
+  lights[0].position = XMFLOAT3(-4.0f, 3.0f, 4.0f);
+  lights[0].range = 8.0f;
+  lights[0].color = XMFLOAT3(1.0f, 0.6f, 0.3f);
+  lights[1].position = XMFLOAT3(4.0f, 3.0f, -4.0f);
+  lights[1].range = 8.0f;
+  lights[1].color = XMFLOAT3(0.3f, 0.5f, 1.0f);
+  lights[2].type = SPOT_LIGHT;
+  lights[2].position = XMFLOAT3(0.0f, 3.8f, 0.0f);
+  lights[2].direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+  lights[2].range = 6.0f;
+  lights[2].intensity = 3.0f;
+
+  LightmapBakeSettings settings;
+  settings.pack.atlasSize = 256;
+  settings.pack.texelsPerUnit = 6.0f;
+  settings.passes = 8;
+  LightmapBaker baker;
+  timer.reset();
+  if (FAILED(baker.begin(level, lights, settings))) {
+    report.fail("could not start the test level bake");
+    return;
+  }
+  // Progresivo como en el editor: presupuesto de 16 ms por llamada
+  unsigned int steps = 1;
+  while (!baker.step(16.0)) {
+    ++steps;
+  }
+  const double bakeMs = timer.elapsedMs();
+  const LightmapBakeStats& stats = baker.getStats();
+  const LightmapAtlas& atlas = baker.getAtlas();
+
+  std::vector<unsigned char> occupied(static_cast<size_t>(atlas.width) * atlas.height, 0);
+  bool atlasValid = atlas.rects.size() == level.size();
+  for (const LightmapRect& rect : atlas.rects) {
+    if (rect.x + rect.size > atlas.width || rect.y + rect.size > atlas.height) {
+      atlasValid = false;
+      continue;
+    }
+    for (unsigned int y = rect.y; y < rect.y + rect.size; ++y) {
+      for (unsigned int x = rect.x; x < rect.x + rect.size; ++x) {
+        atlasValid = atlasValid && !occupied[static_cast<size_t>(y) * atlas.width + x];
+        occupied[static_cast<size_t>(y) * atlas.width + x] = 1;
+      }
+    }
+  }
+  if (!atlasValid) {
+    report.fail("instances overlap or fall outside the lightmap atlas");
+  }
+  if (stats.meshes != 3 || baker.getPreviewVersion() != settings.passes ||
+      baker.getPreview().size() != occupied.size()) {
+    report.fail("the test level did not share unwraps or refresh the preview once per pass");
+  }
+  report.log("test level: %u instances (%u meshes, %u charts, %u triangles), %ux%u atlas at %.2f texels/unit, %u texels",
+             stats.instances, stats.meshes, stats.charts, stats.triangles, atlas.width, atlas.height,
+             stats.texelsPerUnit, stats.texels);
+  report.log("bake: %u passes (%u spp) in %u steps, %.1f ms total (setup %.1f, trace %.1f, denoise %.1f)",
+             stats.passes, stats.passes * kLightmapSamplesPerPass, steps, bakeMs, stats.setupMs, stats.traceMs,
+             stats.denoiseMs);
+  report.log("rays: %llu at %.2f Mrays/s (%u threads)", stats.rays, stats.getRaysPerSecond() * 1e-6,
+             JobSystem::getInstance().getNumThreads());
+
+  // Asset: RGB9E5 comprimido y de regreso
+  const std::string path = "lightmap_benchmark.urlm";
+  LightmapData loaded;
+  LightmapData stale;
+  if (FAILED(saveAsset(path, baker.getData())) || !loadAsset(path, loaded) ||
+      loaded.texels != baker.getData().texels || loaded.geometryHashes != baker.getData().geometryHashes ||
+      loaded.scaleOffsets.size() != level.size() ||
+      std::memcmp(loaded.scaleOffsets.data(), baker.getData().scaleOffsets.data(), level.size() * sizeof(XMFLOAT4)) != 0) {
+    report.fail("the lightmap asset did not round-trip");
+  }
+  else if (loadAsset(path + ".missing", stale)) {
+    report.fail("a missing lightmap asset was accepted");
+  }
+  else if (!corruptAssetRejected(path, offsetof(LightmapFileHeader, numInstances), 0x7FFFFFFFu) ||
+           !corruptAssetRejected(path, offsetof(LightmapFileHeader, dataBytes), 0xFFFFFFF0u)) {
+    report.fail("a lightmap asset with sizes past the end of the file was accepted");
+  }
+  else {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const double fileBytes = static_cast<double>(file.tellg());
+    const double texels = static_cast<double>(loaded.texels.size());
+    report.log("asset: %.1f KB (%.2f bytes/texel; RGB9E5 raw %.0f KB, RGBA16F %.0f KB)",
+               fileBytes / 1024.0, fileBytes / texels, texels * 4.0 / 1024.0, texels * 8.0 / 1024.0);
+  }
+  std::remove(path.c_str());
+}
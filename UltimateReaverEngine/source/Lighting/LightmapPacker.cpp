@@ -0,0 +1,287 @@
+#include "Lighting/LightmapPacker.h"
+#include "Collision/TriangleBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+  /// @brief Lado mínimo de una instancia en el atlas (menos ya no tiene ni un texel adentro).
+  const float kMinInstanceTexels = 4.0f;
+
+  /**
+   * @brief Acomodo rectángulos por repisas, de más alto a más bajo, en un cuadrado de lado `side`.
+   *
+   * @return false si alguno no cupo.
+   */
+  bool
+  shelfPack(const std::vector<float>& widths,
+            const std::vector<float>& heights,
+            float side,
+            std::vector<XMFLOAT2>& positions) {
+    std::vector<unsigned int> order(widths.size());
+    for (unsigned int i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+      return heights[a] != heights[b] ? heights[a] > heights[b] : widths[a] > widths[b];
+    });
+
+    positions.assign(widths.size(), XMFLOAT2(0.0f, 0.0f));
+    float x = 0.0f;
+    float y = 0.0f;
+    float shelfHeight = 0.0f;
+    for (unsigned int i : order) {
+      if (widths[i] > side || heights[i] > side) {
+        return false;
+      }
+      if (x + widths[i] > side) {
+        y += shelfHeight;
+        x = 0.0f;
+        shelfHeight = 0.0f;
+      }
+      if (y + heights[i] > side) {
+        return false;
+      }
+      positions[i] = XMFLOAT2(x, y);
+      x += widths[i];
+      shelfHeight = std::max(shelfHeight, heights[i]);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Cara del cubo hacia la que ve una normal: eje dominante * 2 + (1 si es negativo).
+   */
+  unsigned int
+  cubeFace(const float normal[3]) {
+    unsigned int axis = 0;
+    if (std::fabs(normal[1]) > std::fabs(normal[axis])) {
+      axis = 1;
+    }
+    if (std::fabs(normal[2]) > std::fabs(normal[axis])) {
+      axis = 2;
+    }
+    return axis * 2 + (normal[axis] < 0.0f ? 1 : 0);
+  }
+
+} // namespace
+
+void
+LightmapPacker::unwrap(const MeshComponent& mesh, const LightmapPackSettings& settings, LightmapUnwrap& out) {
+  out = LightmapUnwrap();
+  const std::vector<SimpleVertex>& vertices = mesh.m_vertex;
+  const size_t numIndices = mesh.m_index.size() - mesh.m_index.size() % 3;
+  const size_t numTriangles = numIndices / 3;
+  if (vertices.empty() || numTriangles == 0) {
+    return;
+  }
+  out.geometryHash = TriangleBVH::hashGeometry(&vertices[0].Pos, vertices.size(), sizeof(SimpleVertex),
+                                               mesh.m_index.data(), numIndices);
+
+  // Soldado: los vértices con la misma posición (costuras de UV o de normales) son uno
+  std::vector<unsigned int> sorted(vertices.size());
+  for (unsigned int i = 0; i < sorted.size(); ++i) {
+    sorted[i] = i;
+  }
+  auto positionLess = [&vertices](unsigned int a, unsigned int b) {
+    return std::memcmp(&vertices[a].Pos, &vertices[b].Pos, sizeof(XMFLOAT3)) < 0;
+  };
+  std::sort(sorted.begin(), sorted.end(), positionLess);
+  std::vector<unsigned int> welded(vertices.size());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const bool same = i > 0 && std::memcmp(&vertices[sorted[i]].Pos, &vertices[sorted[i - 1]].Pos, sizeof(XMFLOAT3)) == 0;
+    welded[sorted[i]] = same ? welded[sorted[i - 1]] : sorted[i];
+  }
+
+  // Vecinos por arista: (arista soldada, triángulo) ordenado junta a los que la comparten
+  std::vector<std::pair<unsigned long long, unsigned int>> edges;
+  edges.reserve(numIndices);
+  std::vector<float> normals(numTriangles * 3);
+  std::vector<unsigned char> faces(numTriangles);
+  for (unsigned int t = 0; t < numTriangles; ++t) {
+    const unsigned int* tri = &mesh.m_index[t * 3];
+    for (int c = 0; c < 3; ++c) {
+      unsigned long long a = welded[tri[c]];
+      unsigned long long b = welded[tri[(c + 1) % 3]];
+      if (a != b) {
+        edges.push_back(std::make_pair(std::min(a, b) << 32 | std::max(a, b), t));
+      }
+    }
+    const XMFLOAT3& p0 = vertices[tri[0]].Pos;
+    const XMFLOAT3& p1 = vertices[tri[1]].Pos;
+    const XMFLOAT3& p2 = vertices[tri[2]].Pos;
+    const float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+    const float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+    float* n = &normals[t * 3];
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.0f) {
+      n[0] /= length;
+      n[1] /= length;
+      n[2] /= length;
+    }
+    faces[t] = static_cast<unsigned char>(cubeFace(n));
+  }
+  std::sort(edges.begin(), edges.end());
+  std::vector<std::vector<unsigned int>> neighbors(numTriangles);
+  for (size_t first = 0; first < edges.size();) {
+    size_t last = first + 1;
+    while (last < edges.size() && edges[last].first == edges[first].first) {
+      ++last;
+    }
+    for (size_t i = first; i < last; ++i) {
+      for (size_t j = first; j < last; ++j) {
+        if (i != j) {
+          neighbors[edges[i].second].push_back(edges[j].second);
+        }
+      }
+    }
+    first = last;
+  }
+
+  // Charts: crezco desde una semilla mientras la normal vea a la misma cara del cubo
+  const unsigned int kNoChart = 0xFFFFFFFFu;
+  std::vector<unsigned int> chartOf(numTriangles, kNoChart);
+  std::vector<unsigned int> chartFace;
+  std::vector<unsigned int> queue;
+  for (unsigned int seed = 0; seed < numTriangles; ++seed) {
+    if (chartOf[seed] != kNoChart) {
+      continue;
+    }
+    const unsigned int chart = static_cast<unsigned int>(chartFace.size());
+    chartFace.push_back(faces[seed]);
+    const float* seedNormal = &normals[seed * 3];
+    chartOf[seed] = chart;
+    queue.assign(1, seed);
+    for (size_t head = 0; head < queue.size(); ++head) {
+      for (unsigned int next : neighbors[queue[head]]) {
+        if (chartOf[next] != kNoChart) {
+          continue;
+        }
+        const float* n = &normals[next * 3];
+        const float cosine = n[0] * seedNormal[0] + n[1] * seedNormal[1] + n[2] * seedNormal[2];
+        // Los degenerados (normal cero) se van con cualquier vecino
+        const bool degenerate = n[0] == 0.0f && n[1] == 0.0f && n[2] == 0.0f;
+        if (degenerate || (faces[next] == faces[seed] && cosine >= settings.chartNormalThreshold)) {
+          chartOf[next] = chart;
+          queue.push_back(next);
+        }
+      }
+    }
+  }
+  const unsigned int numCharts = static_cast<unsigned int>(chartFace.size());
+
+  // Proyección al plano del eje de cada chart (volteo u en las caras negativas para no espejear)
+  auto project = [&chartFace, &vertices](unsigned int chart, unsigned int vertex) {
+    const unsigned int axis = chartFace[chart] / 2;
+    const float p[3] = { vertices[vertex].Pos.x, vertices[vertex].Pos.y, vertices[vertex].Pos.z };
+    const float u = p[(axis + 1) % 3];
+    return XMFLOAT2((chartFace[chart] & 1) ? -u : u, p[(axis + 2) % 3]);
+  };
+  std::vector<XMFLOAT4> bounds(numCharts, XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX));
+  for (unsigned int t = 0; t < numTriangles; ++t) {
+    XMFLOAT4& box = bounds[chartOf[t]];
+    for (int c = 0; c < 3; ++c) {
+      const XMFLOAT2 uv = project(chartOf[t], mesh.m_index[t * 3 + c]);
+      box.x = std::min(box.x, uv.x);
+      box.y = std::min(box.y, uv.y);
+      box.z = std::max(box.z, uv.x);
+      box.w = std::max(box.w, uv.y);
+    }
+  }
+
+  // Layout: los charts con su margen en el cuadrado más chico donde quepan
+  const float padding = settings.padding / std::max(settings.texelsPerUnit, 1e-3f);
+  std::vector<float> widths(numCharts);
+  std::vector<float> heights(numCharts);
+  float area = 0.0f;
+  float side = 0.0f;
+  for (unsigned int c = 0; c < numCharts; ++c) {
+    widths[c] = bounds[c].z - bounds[c].x + padding;
+    heights[c] = bounds[c].w - bounds[c].y + padding;
+    area += widths[c] * heights[c];
+    side = std::max(side, std::max(widths[c], heights[c]));
+  }
+  side = std::max(side, std::sqrt(area));
+  std::vector<XMFLOAT2> positions;
+  while (!shelfPack(widths, heights, side, positions)) {
+    side *= 1.05f;
+  }
+  out.size = side;
+
+  out.chartRects.resize(numCharts);
+  for (unsigned int c = 0; c < numCharts; ++c) {
+    const float x = positions[c].x + padding * 0.5f;
+    const float y = positions[c].y + padding * 0.5f;
+    out.chartRects[c] = XMFLOAT4(x / side, y / side,
+                                 (x + bounds[c].z - bounds[c].x) / side,
+                                 (y + bounds[c].w - bounds[c].y) / side);
+  }
+
+  // Vértices del unwrap: uno por (vértice original, chart)
+  std::unordered_map<unsigned long long, unsigned int> split;
+  out.indices.resize(numIndices);
+  for (unsigned int t = 0; t < numTriangles; ++t) {
+    const unsigned int chart = chartOf[t];
+    for (int c = 0; c < 3; ++c) {
+      const unsigned int vertex = mesh.m_index[t * 3 + c];
+      const unsigned long long key = static_cast<unsigned long long>(vertex) << 32 | chart;
+      auto found = split.find(key);
+      if (found == split.end()) {
+        const XMFLOAT2 uv = project(chart, vertex);
+        found = split.emplace(key, static_cast<unsigned int>(out.remap.size())).first;
+        out.remap.push_back(vertex);
+        out.uv.push_back(XMFLOAT2((uv.x - bounds[chart].x + positions[chart].x + padding * 0.5f) / side,
+                                  (uv.y - bounds[chart].y + positions[chart].y + padding * 0.5f) / side));
+      }
+      out.indices[t * 3 + c] = found->second;
+    }
+  }
+}
+
+bool
+LightmapPacker::pack(const std::vector<float>& sizes, const LightmapPackSettings& settings, LightmapAtlas& out) {
+  out = LightmapAtlas();
+  out.width = settings.atlasSize;
+  out.height = settings.atlasSize;
+  const float side = static_cast<float>(settings.atlasSize);
+
+  // Si no cabe todo, bajo la densidad un 10% y vuelvo a intentar
+  float density = settings.texelsPerUnit;
+  std::vector<float> texels(sizes.size());
+  std::vector<XMFLOAT2> positions;
+  for (int attempt = 0; attempt < 64; ++attempt, density *= 0.9f) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      texels[i] = std::max(kMinInstanceTexels, std::ceil(sizes[i] * density));
+    }
+    if (!shelfPack(texels, texels, side, positions)) {
+      continue;
+    }
+    out.texelsPerUnit = density;
+    out.scaleOffsets.resize(sizes.size());
+    out.rects.resize(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      out.rects[i].x = static_cast<unsigned int>(positions[i].x);
+      out.rects[i].y = static_cast<unsigned int>(positions[i].y);
+      out.rects[i].size = static_cast<unsigned int>(texels[i]);
+      out.scaleOffsets[i] = XMFLOAT4(texels[i] / out.width, texels[i] / out.height,
+                                     positions[i].x / out.width, positions[i].y / out.height);
+    }
+    return true;
+  }
+  return false;
+}
+
+float
+LightmapPacker::getMaxScale(const XMFLOAT4X4& world) {
+  float scale = 0.0f;
+  for (int row = 0; row < 3; ++row) {
+    scale = std::max(scale, world.m[row][0] * world.m[row][0] +
+                            world.m[row][1] * world.m[row][1] +
+                            world.m[row][2] * world.m[row][2]);
+  }
+  return std::sqrt(scale);
+}
@@ -0,0 +1,480 @@
+#include "Materials/Material.h"
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+  bool
+    isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+  }
+
+  /**
+   * @brief Quito los comentarios de línea y de bloque (los cambio por espacios).
+   */
+  std::string
+    stripComments(const std::string& source) {
+    std::string out = source;
+    size_t i = 0;
+    while (i < out.size()) {
+      if (out[i] == '/' && i + 1 < out.size() && out[i + 1] == '/') {
+        while (i < out.size() && out[i] != '\n') {
+          out[i++] = ' ';
+        }
+      }
+      else if (out[i] == '/' && i + 1 < out.size() && out[i + 1] == '*') {
+        while (i < out.size() && !(out[i] == '*' && i + 1 < out.size() && out[i + 1] == '/')) {
+          if (out[i] != '\n') {
+            out[i] = ' ';
+          }
+          ++i;
+        }
+        for (int k = 0; k < 2 && i < out.size(); ++k) {
+          out[i++] = ' ';
+        }
+      }
+      else {
+        ++i;
+      }
+    }
+    return out;
+  }
+
+  /**
+   * @brief Busco una palabra completa (no como parte de otro identificador) desde `start`.
+   */
+  size_t
+    findWord(const std::string& text, const std::string& word, size_t start) {
+    size_t at = text.find(word, start);
+    while (at != std::string::npos) {
+      const bool before = at == 0 || !isIdentifierChar(text[at - 1]);
+      const bool after = at + word.size() >= text.size() || !isIdentifierChar(text[at + word.size()]);
+      if (before && after) {
+        return at;
+      }
+      at = text.find(word, at + 1);
+    }
+    return std::string::npos;
+  }
+
+  std::string
+    readIdentifier(const std::string& text, size_t& cursor) {
+    while (cursor < text.size() && std::isspace(static_cast<unsigned char>(text[cursor]))) {
+      ++cursor;
+    }
+    const size_t start = cursor;
+    while (cursor < text.size() && isIdentifierChar(text[cursor])) {
+      ++cursor;
+    }
+    return text.substr(start, cursor - start);
+  }
+
+  /**
+   * @brief `float3` -> FLOAT, 3. Sin dígito es un escalar; `float4x4` no es válido.
+   */
+  bool
+    parseType(const std::string& type, MaterialParamType& baseType, unsigned int& columns) {
+    static const struct { const char* name; MaterialParamType type; } kTypes[] = {
+      { "float", MATERIAL_PARAM_FLOAT },
+      { "uint", MATERIAL_PARAM_UINT },
+      { "int", MATERIAL_PARAM_INT },
+    };
+    for (const auto& candidate : kTypes) {
+      const size_t length = std::strlen(candidate.name);
+      if (type.compare(0, length, candidate.name) != 0) {
+        continue;
+      }
+      if (type.size() == length) {
+        baseType = candidate.type;
+        columns = 1;
+        return true;
+      }
+      if (type.size() == length + 1 && type[length] >= '1' && type[length] <= '4') {
+        baseType = candidate.type;
+        columns = static_cast<unsigned int>(type[length] - '0');
+        return true;
+      }
+    }
+    return false;
+  }
+
+  unsigned long long
+    hashBytes(unsigned long long hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+} // namespace
+
+// ============================================================================
+// MaterialLayout
+// ============================================================================
+
+bool
+MaterialLayout::reflect(const std::string& source, const std::string& cbufferName, std::string& error) {
+  clear();
+  const std::string code = stripComments(source);
+
+  // El cbuffer del material
+  size_t cursor = 0;
+  size_t body = std::string::npos;
+  for (size_t at = findWord(code, "cbuffer", 0); at != std::string::npos; at = findWord(code, "cbuffer", at + 1)) {
+    cursor = at + 7;
+    if (readIdentifier(code, cursor) == cbufferName) {
+      body = code.find('{', cursor);
+      break;
+    }
+  }
+  if (body == std::string::npos) {
+    error = "cbuffer " + cbufferName + " not found";
+    return false;
+  }
+  const size_t bodyEnd = code.find('}', body);
+  if (bodyEnd == std::string::npos) {
+    error = "cbuffer " + cbufferName + " is not closed";
+    return false;
+  }
+
+  // Un campo por ';': "tipo nombre [: packoffset(...)] [= valor]"
+  std::stringstream fields(code.substr(body + 1, bodyEnd - body - 1));
+  std::string field;
+  while (std::getline(fields, field, ';')) {
+    if (field.find("packoffset") != std::string::npos) {
+      error = "packoffset is not supported in material parameters: " + field;
+      clear();
+      return false;
+    }
+    field = field.substr(0, field.find_first_of(":="));
+    if (field.find_first_not_of(" \t\r\n") == std::string::npos) {
+      continue;
+    }
+    if (field.find('[') != std::string::npos) {
+      error = "arrays are not supported in material parameters: " + field;
+      clear();
+      return false;
+    }
+    std::stringstream tokens(field);
+    std::string type;
+    std::string name;
+    std::string extra;
+    tokens >> type >> name >> extra;
+    MaterialParamType baseType;
+    unsigned int columns;
+    if (name.empty() || !extra.empty() || !parseType(type, baseType, columns)) {
+      error = "unsupported material parameter: " + field;
+      clear();
+      return false;
+    }
+    if (!addParameter(name, baseType, columns)) {
+      error = "duplicated material parameter: " + name;
+      clear();
+      return false;
+    }
+  }
+
+  // Texturas: "Texture2D[<...>] Nombre : register(tN)" con N en los slots del material
+  for (size_t at = findWord(code, "Texture2D", 0); at != std::string::npos; at = findWord(code, "Texture2D", at + 1)) {
+    cursor = at + 9;
+    while (cursor < code.size() && std::isspace(static_cast<unsigned char>(code[cursor]))) {
+      ++cursor;
+    }
+    if (cursor < code.size() && code[cursor] == '<') {
+      cursor = code.find('>', cursor);
+      if (cursor == std::string::npos) {
+        break;
+      }
+      ++cursor;
+    }
+    const std::string name = readIdentifier(code, cursor);
+    const size_t end = code.find(';', cursor);
+    const size_t reg = findWord(code, "register", cursor);
+    if (name.empty() || end == std::string::npos || reg == std::string::npos || reg > end) {
+      continue;
+    }
+    const size_t slotAt = code.find_first_of("tT", reg + 8);
+    if (slotAt == std::string::npos || slotAt > end) {
+      continue;
+    }
+    const unsigned int slot = static_cast<unsigned int>(std::strtoul(code.c_str() + slotAt + 1, nullptr, 10));
+    if (slot < kMaterialTextureSlots) {
+      addTexture(name, slot);
+    }
+  }
+  return true;
+}
+
+bool
+MaterialLayout::reflectFile(const std::string& fileName, const std::string& cbufferName, std::string& error) {
+  std::ifstream file(fileName);
+  if (!file) {
+    error = "cannot open " + fileName;
+    clear();
+    return false;
+  }
+  std::stringstream source;
+  source << file.rdbuf();
+  return reflect(source.str(), cbufferName, error);
+}
+
+bool
+MaterialLayout::addParameter(const std::string& name, MaterialParamType type, unsigned int columns) {
+  if (columns < 1 || columns > 4 || findParameter(name) >= 0) {
+    return false;
+  }
+  // Regla de HLSL: un campo no puede cruzar un límite de 16 bytes
+  const unsigned int size = columns * 4;
+  unsigned int offset = m_end;
+  if ((offset & 15u) + size > 16u) {
+    offset = (offset + 15u) & ~15u;
+  }
+  MaterialParam param;
+  param.name = name;
+  param.type = type;
+  param.columns = columns;
+  param.offset = offset;
+  m_params.push_back(param);
+  m_end = offset + size;
+  return true;
+}
+
+bool
+MaterialLayout::addTexture(const std::string& name, unsigned int slot) {
+  if (slot >= kMaterialTextureSlots || findTexture(name) >= 0) {
+    return false;
+  }
+  for (const MaterialTextureSlot& texture : m_textures) {
+    if (texture.slot == slot) {
+      return false;
+    }
+  }
+  MaterialTextureSlot texture;
+  texture.name = name;
+  texture.slot = slot;
+  m_textures.push_back(texture);
+  return true;
+}
+
+void
+MaterialLayout::clear() {
+  m_params.clear();
+  m_textures.clear();
+  m_end = 0;
+}
+
+int
+MaterialLayout::findParameter(const std::string& name) const {
+  for (size_t i = 0; i < m_params.size(); ++i) {
+    if (m_params[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int
+MaterialLayout::findTexture(const std::string& name) const {
+  for (const MaterialTextureSlot& texture : m_textures) {
+    if (texture.name == name) {
+      return static_cast<int>(texture.slot);
+    }
+  }
+  return -1;
+}
+
+unsigned long long
+MaterialLayout::getHash() const {
+  unsigned long long hash = 14695981039346656037ull;
+  for (const MaterialParam& param : m_params) {
+    hash = hashBytes(hash, param.name.data(), param.name.size() + 1);
+    const unsigned int words[3] = { static_cast<unsigned int>(param.type), param.columns, param.offset };
+    hash = hashBytes(hash, words, sizeof(words));
+  }
+  for (const MaterialTextureSlot& texture : m_textures) {
+    hash = hashBytes(hash, texture.name.data(), texture.name.size() + 1);
+    hash = hashBytes(hash, &texture.slot, sizeof(texture.slot));
+  }
+  return hash;
+}
+
+MaterialLayout
+MaterialLayout::getDefault() {
+  MaterialLayout layout;
+  layout.addParameter("BaseColor", MATERIAL_PARAM_FLOAT, 4);
+  layout.addParameter("Emissive", MATERIAL_PARAM_FLOAT, 3);
+  layout.addParameter("Roughness", MATERIAL_PARAM_FLOAT, 1);
+  layout.addParameter("Metallic", MATERIAL_PARAM_FLOAT, 1);
+  layout.addParameter("UVScale", MATERIAL_PARAM_FLOAT, 2);
+  layout.addTexture("Albedo", 0);
+  layout.addTexture("Normal", 1);
+  layout.addTexture("MetallicMap", 2);
+  layout.addTexture("RoughnessMap", 3);
+  return layout;
+}
+
+// ============================================================================
+// Material
+// ============================================================================
+
+bool
+Material::load(const std::string& fileName) {
+  SetPath(fileName);
+  SetState(ResourceState::Loading);
+  std::ifstream file(fileName);
+  if (!file) {
+    ERROR("Material", "load", "Cannot open " << fileName.c_str());
+    SetState(ResourceState::Failed);
+    return false;
+  }
+
+  setLayout(MaterialLayout::getDefault());
+  std::string line;
+  while (std::getline(file, line)) {
+    std::stringstream tokens(line.substr(0, line.find('#')));
+    std::string command;
+    std::string name;
+    if (!(tokens >> command >> name)) {
+      continue;
+    }
+    if (command == "shader") {
+      std::string cbufferName;
+      tokens >> cbufferName;
+      MaterialLayout layout;
+      std::string error;
+      if (!layout.reflectFile(name, cbufferName, error)) {
+        ERROR("Material", "load", fileName.c_str() << ": " << error.c_str());
+        SetState(ResourceState::Failed);
+        return false;
+      }
+      setLayout(layout);
+    }
+    else if (command == "param") {
+      float values[4] = {};
+      unsigned int count = 0;
+      while (count < 4 && tokens >> values[count]) {
+        ++count;
+      }
+      if (!setFloat(name, values, count)) {
+        ERROR("Material", "load", fileName.c_str() << ": unknown parameter " << name.c_str());
+      }
+    }
+    else if (command == "texture") {
+      std::string path;
+      std::getline(tokens >> std::ws, path);
+      const int slot = m_layout.findTexture(name);
+      if (slot < 0) {
+        ERROR("Material", "load", fileName.c_str() << ": unknown texture " << name.c_str());
+        continue;
+      }
+      m_texturePaths[slot] = path;
+    }
+  }
+  SetState(ResourceState::Loaded);
+  return true;
+}
+
+void
+Material::unload() {
+  m_constants.clear();
+  for (unsigned int slot = 0; slot < kMaterialTextureSlots; ++slot) {
+    m_views[slot] = nullptr;
+    m_texturePaths[slot].clear();
+  }
+  SetState(ResourceState::Unloaded);
+}
+
+size_t
+Material::getSizeInBytes() const {
+  return sizeof(Material) + m_constants.capacity();
+}
+
+void
+Material::setLayout(const MaterialLayout& layout) {
+  m_layout = layout;
+  m_constants.assign(layout.getSize(), 0);
+  for (unsigned int slot = 0; slot < kMaterialTextureSlots; ++slot) {
+    m_views[slot] = nullptr;
+  }
+}
+
+bool
+Material::setFloat(const std::string& name, const float* values, unsigned int count) {
+  const int index = m_layout.findParameter(name);
+  if (index < 0) {
+    return false;
+  }
+  const MaterialParam& param = m_layout.getParameters()[index];
+  for (unsigned int c = 0; c < count && c < param.columns; ++c) {
+    uint8_t* destination = &m_constants[param.offset + c * 4];
+    if (param.type == MATERIAL_PARAM_FLOAT) {
+      std::memcpy(destination, &values[c], 4);
+    }
+    else if (param.type == MATERIAL_PARAM_INT) {
+      const int value = static_cast<int>(values[c]);
+      std::memcpy(destination, &value, 4);
+    }
+    else {
+      const unsigned int value = static_cast<unsigned int>(std::max(values[c], 0.0f));
+      std::memcpy(destination, &value, 4);
+    }
+  }
+  return true;
+}
+
+bool
+Material::setVector(const std::string& name, const XMFLOAT4& value) {
+  return setFloat(name, &value.x, 4);
+}
+
+bool
+Material::setUInt(const std::string& name, unsigned int value) {
+  const int index = m_layout.findParameter(name);
+  if (index < 0 || m_layout.getParameters()[index].type == MATERIAL_PARAM_FLOAT) {
+    return false;
+  }
+  std::memcpy(&m_constants[m_layout.getParameters()[index].offset], &value, 4);
+  return true;
+}
+
+XMFLOAT4
+Material::getVector(const std::string& name, const XMFLOAT4& fallback) const {
+  XMFLOAT4 value = fallback;
+  const int index = m_layout.findParameter(name);
+  if (index < 0 || m_layout.getParameters()[index].type != MATERIAL_PARAM_FLOAT) {
+    return value;
+  }
+  const MaterialParam& param = m_layout.getParameters()[index];
+  std::memcpy(&value.x, &m_constants[param.offset], param.columns * 4);
+  return value;
+}
+
+bool
+Material::setTexture(const std::string& name, ID3D11ShaderResourceView* view) {
+  const int slot = m_layout.findTexture(name);
+  if (slot < 0) {
+    return false;
+  }
+  m_views[slot] = view;
+  return true;
+}
+
+void
+Material::setTexture(unsigned int slot, ID3D11ShaderResourceView* view) {
+  if (slot < kMaterialTextureSlots) {
+    m_views[slot] = view;
+  }
+}
+
+unsigned long long
+Material::getHash() const {
+  unsigned long long hash = m_layout.getHash();
+  if (!m_constants.empty()) {
+    hash = hashBytes(hash, m_constants.data(), m_constants.size());
+  }
+  return hashBytes(hash, m_views, sizeof(m_views));
+}
@@ -0,0 +1,495 @@
+#include "Materials/MaterialSystem.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+HRESULT
+MaterialSystem::init(Device* device, const MaterialLayout& layout) {
+  destroy();
+  if (layout.getSize() == 0 || layout.getSize() > kMaterialCBBytes) {
+    ERROR("MaterialSystem", "init", "Invalid material layout size " << layout.getSize());
+    return E_INVALIDARG;
+  }
+  m_layout = layout;
+  m_layoutHash = layout.getHash();
+  m_stride = layout.getSize();
+  m_capacity = kMaterialCBBytes / m_stride;
+  m_constants.assign(static_cast<size_t>(m_capacity) * m_stride, 0);
+
+  if (device && device->m_device) {
+    HRESULT hr = m_buffer.init(*device, m_capacity * m_stride);
+    if (FAILED(hr)) {
+      ERROR("MaterialSystem", "init", "Failed to create the material constant buffer");
+      destroy();
+      return hr;
+    }
+  }
+  m_ready = true;
+  return S_OK;
+}
+
+void
+MaterialSystem::destroy() {
+  m_buffer.destroy();
+  m_constants.clear();
+  m_entries.clear();
+  m_freeEntries.clear();
+  m_lookup.clear();
+  m_tables.clear();
+  m_freeTables.clear();
+  m_tableLookup.clear();
+  m_layout.clear();
+  m_stride = 0;
+  m_capacity = 0;
+  m_numMaterials = 0;
+  m_numTables = 0;
+  m_requests = 0;
+  m_dedupHits = 0;
+  m_uploads = 0;
+  m_dirty = false;
+  resetBindStats();
+  m_ready = false;
+}
+
+unsigned int
+MaterialSystem::acquire(const Material& material) {
+  if (!m_ready || material.getLayout().getHash() != m_layoutHash) {
+    return kInvalidMaterial;
+  }
+  ++m_requests;
+
+  // Igual a uno que ya existe: los mismos bytes y la misma tabla
+  const unsigned long long hash = material.getHash();
+  auto found = m_lookup.find(hash);
+  if (found != m_lookup.end()) {
+    const unsigned int index = found->second;
+    const TextureTable& table = m_tables[m_entries[index].table];
+    bool sameViews = true;
+    for (unsigned int slot = 0; slot < kMaterialTextureSlots; ++slot) {
+      sameViews = sameViews && table.views[slot] == material.getTexture(slot);
+    }
+    if (sameViews && std::memcmp(getConstants(index), material.getConstants().data(), m_stride) == 0) {
+      ++m_entries[index].refs;
+      ++m_dedupHits;
+      return index;
+    }
+  }
+
+  unsigned int index;
+  if (!m_freeEntries.empty()) {
+    index = m_freeEntries.back();
+    m_freeEntries.pop_back();
+  }
+  else if (m_entries.size() < m_capacity) {
+    index = static_cast<unsigned int>(m_entries.size());
+    m_entries.push_back(Entry());
+  }
+  else {
+    ERROR("MaterialSystem", "acquire", "The material array is full (" << m_capacity << " materials)");
+    return kInvalidMaterial;
+  }
+
+  Entry& entry = m_entries[index];
+  entry.hash = hash;
+  entry.refs = 1;
+  entry.table = acquireTable(material);
+  std::memcpy(&m_constants[index * m_stride], material.getConstants().data(), m_stride);
+  // Si dos materiales distintos chocan en el hash, el segundo no entra al lookup
+  m_lookup.emplace(hash, index);
+  ++m_numMaterials;
+  m_dirty = true;
+  return index;
+}
+
+void
+MaterialSystem::release(unsigned int material) {
+  if (material >= m_entries.size() || m_entries[material].refs == 0) {
+    return;
+  }
+  Entry& entry = m_entries[material];
+  if (--entry.refs > 0) {
+    return;
+  }
+  auto found = m_lookup.find(entry.hash);
+  if (found != m_lookup.end() && found->second == material) {
+    m_lookup.erase(found);
+  }
+  releaseTable(entry.table);
+  m_freeEntries.push_back(material);
+  --m_numMaterials;
+}
+
+unsigned int
+MaterialSystem::acquireTable(const Material& material) {
+  TextureTable table;
+  for (unsigned int slot = 0; slot < kMaterialTextureSlots; ++slot) {
+    table.views[slot] = material.getTexture(slot);
+  }
+  unsigned long long hash = 14695981039346656037ull;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(table.views);
+  for (size_t i = 0; i < sizeof(table.views); ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  table.hash = hash;
+
+  auto found = m_tableLookup.find(hash);
+  if (found != m_tableLookup.end() &&
+      std::memcmp(m_tables[found->second].views, table.views, sizeof(table.views)) == 0) {
+    ++m_tables[found->second].refs;
+    return found->second;
+  }
+
+  unsigned int index;
+  if (!m_freeTables.empty()) {
+    index = m_freeTables.back();
+    m_freeTables.pop_back();
+  }
+  else {
+    index = static_cast<unsigned int>(m_tables.size());
+    m_tables.push_back(TextureTable());
+  }
+  table.refs = 1;
+  m_tables[index] = table;
+  m_tableLookup.emplace(hash, index);
+  ++m_numTables;
+  return index;
+}
+
+void
+MaterialSystem::releaseTable(unsigned int table) {
+  TextureTable& entry = m_tables[table];
+  if (entry.refs == 0 || --entry.refs > 0) {
+    return;
+  }
+  auto found = m_tableLookup.find(entry.hash);
+  if (found != m_tableLookup.end() && found->second == table) {
+    m_tableLookup.erase(found);
+  }
+  m_freeTables.push_back(table);
+  if (m_boundTable == table) {
+    m_boundTable = kInvalidMaterial;
+  }
+  --m_numTables;
+}
+
+unsigned int
+MaterialSystem::getSortKey(unsigned int material) const {
+  if (material >= m_entries.size()) {
+    return 0xFFFFFFFF;
+  }
+  // Caben 4096 materiales en el CB: 12 bits para el material y el resto para la tabla
+  return (m_entries[material].table << 12) | (material & 0xFFF);
+}
+
+XMFLOAT4
+MaterialSystem::getBaseColor(unsigned int material) const {
+  XMFLOAT4 color(1.0f, 1.0f, 1.0f, 1.0f);
+  const int param = m_layout.findParameter("BaseColor");
+  if (material >= m_entries.size() || param < 0 ||
+      m_layout.getParameters()[param].type != MATERIAL_PARAM_FLOAT) {
+    return color;
+  }
+  const MaterialParam& baseColor = m_layout.getParameters()[param];
+  std::memcpy(&color.x, getConstants(material) + baseColor.offset, baseColor.columns * 4);
+  return color;
+}
+
+void
+MaterialSystem::beginPass(DeviceContext& deviceContext) {
+  m_boundTable = kInvalidMaterial;
+  if (!m_buffer.getBuffer() || !deviceContext.m_deviceContext) {
+    return;
+  }
+  if (m_dirty) {
+    m_buffer.update(deviceContext, nullptr, 0, nullptr, m_constants.data(), 0, 0);
+    m_dirty = false;
+    ++m_uploads;
+  }
+  m_buffer.render(deviceContext, kMaterialCBSlot, 1, true);
+}
+
+bool
+MaterialSystem::track(unsigned int material) {
+  if (material >= m_entries.size() || m_entries[material].refs == 0) {
+    return false;
+  }
+  const unsigned int table = m_entries[material].table;
+  if (table == m_boundTable) {
+    ++m_tableBindsSkipped;
+    return false;
+  }
+  m_boundTable = table;
+  ++m_tableBinds;
+  return true;
+}
+
+bool
+MaterialSystem::bind(DeviceContext& deviceContext, unsigned int material) {
+  if (!track(material)) {
+    return false;
+  }
+  deviceContext.PSSetShaderResources(0, kMaterialTextureSlots, m_tables[m_boundTable].views);
+  return true;
+}
+
+void
+MaterialSystem::resetBindStats() {
+  m_boundTable = kInvalidMaterial;
+  m_tableBinds = 0;
+  m_tableBindsSkipped = 0;
+}
+
+MaterialSystemStats
+MaterialSystem::getStats() const {
+  MaterialSystemStats stats;
+  stats.materials = m_numMaterials;
+  stats.textureTables = m_numTables;
+  stats.requests = m_requests;
+  stats.dedupHits = m_dedupHits;
+  for (size_t i = m_entries.size(); i > 0; --i) {
+    if (m_entries[i - 1].refs > 0) {
+      stats.constantBytes = static_cast<unsigned int>(i) * m_stride;
+      break;
+    }
+  }
+  stats.uploads = m_uploads;
+  stats.tableBinds = m_tableBinds;
+  stats.tableBindsSkipped = m_tableBindsSkipped;
+  return stats;
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+namespace {
+
+  /**
+   * @brief Vista falsa para las tablas (headless nunca se desreferencia).
+   */
+  ID3D11ShaderResourceView*
+    fakeView(unsigned int id) {
+    return reinterpret_cast<ID3D11ShaderResourceView*>(static_cast<uintptr_t>(0x10000 + id * 16));
+  }
+
+  /**
+   * @brief El material `k` de la prueba: color propio y una de `numTables` tablas.
+   */
+  void
+    makeTestMaterial(Material& material, unsigned int k, unsigned int numTables) {
+    material.setLayout(MaterialLayout::getDefault());
+    material.setVector("BaseColor", XMFLOAT4((k % 10) * 0.1f, (k / 10 % 10) * 0.1f, (k / 100) * 0.1f, 1.0f));
+    const float roughness = 0.25f + (k % 3) * 0.25f;
+    material.setFloat("Roughness", &roughness, 1);
+    const unsigned int table = k % numTables;
+    material.setTexture("Albedo", fakeView(table * 2));
+    material.setTexture("Normal", fakeView(table * 2 + 1));
+  }
+
+} // namespace
+
+void
+MaterialSystem::runBenchmark(BenchmarkReport& report) {
+  // 1) Reflexión: offsets de HLSL, texturas de material y errores
+  const char* source =
+    "// Shader de prueba\n"
+    "cbuffer cbNeverChanges : register(b0) { matrix View; };\n"
+    "cbuffer cbMaterial : register(b7)\n"
+    "{\n"
+    "  float4 BaseColor;\n"
+    "  float3 Emissive;\n"
+    "  float  Roughness;\n"
+    "  float2 UVScale;\n"
+    "  float  Metallic;\n"
+    "  float3 SheenColor; /* no cabe en 44..56: salta a 48 */\n"
+    "  uint   Flags;\n"
+    "  float2 Offset;\n"
+    "  float  Opacity = 1.0f;\n"
+    "};\n"
+    "Texture2D Albedo : register(t0);\n"
+    "Texture2D<float4> Normal : register( t1 );\n"
+    "Texture2D ShadowMap : register(t7);\n"
+    "SamplerState samLinear : register(s0);\n";
+  const char* names[] = { "BaseColor", "Emissive", "Roughness", "UVScale", "Metallic", "SheenColor", "Flags", "Offset", "Opacity" };
+  const unsigned int offsets[] = { 0, 16, 28, 32, 40, 48, 60, 64, 72 };
+  const unsigned int numParams = sizeof(offsets) / sizeof(offsets[0]);
+
+  MaterialLayout layout;
+  std::string error;
+  Timer timer;
+  if (!layout.reflect(source, "cbMaterial", error)) {
+    report.fail("reflect failed: " + error);
+    return;
+  }
+  const double reflectMs = timer.elapsedMs();
+  if (layout.getParameters().size() != numParams) {
+    report.fail("reflect found " + std::to_string(layout.getParameters().size()) + " parameters, expected " +
+                std::to_string(numParams));
+  }
+  for (unsigned int i = 0; i < numParams && i < layout.getParameters().size(); ++i) {
+    const MaterialParam& param = layout.getParameters()[i];
+    if (param.name != names[i] || param.offset != offsets[i]) {
+      report.fail("parameter " + std::to_string(i) + " is " + param.name + " at " + std::to_string(param.offset) +
+                  ", expected " + names[i] + " at " + std::to_string(offsets[i]));
+    }
+  }
+  if (layout.getSize() != 80) {
+    report.fail("layout size " + std::to_string(layout.getSize()) + ", expected 80");
+  }
+  if (layout.getTextures().size() != 2 || layout.findTexture("Albedo") != 0 || layout.findTexture("Normal") != 1) {
+    report.fail("reflect did not find exactly Albedo (t0) and Normal (t1)");
+  }
+  if (layout.getParameters().size() > 6 && layout.getParameters()[6].type != MATERIAL_PARAM_UINT) {
+    report.fail("Flags should be uint");
+  }
+  report.log("reflect: %u parameters, %u bytes, %u textures in %.3f ms",
+             static_cast<unsigned int>(layout.getParameters().size()), layout.getSize(),
+             static_cast<unsigned int>(layout.getTextures().size()), reflectMs);
+
+  MaterialLayout rejected;
+  if (rejected.reflect("cbuffer cbMaterial { float4 Colors[4]; };", "cbMaterial", error) ||
+      rejected.reflect("cbuffer cbMaterial { float4x4 Uv; };", "cbMaterial", error) ||
+      rejected.reflect(source, "cbMissing", error)) {
+    report.fail("reflect accepted an array, a matrix or a missing cbuffer");
+  }
+
+  // El layout por default es el mismo que reflejar su declaración
+  MaterialLayout declared;
+  declared.reflect("cbuffer cbMaterial { float4 BaseColor; float3 Emissive; float Roughness; float Metallic; float2 UVScale; };\n"
+                   "Texture2D Albedo : register(t0); Texture2D Normal : register(t1);\n"
+                   "Texture2D MetallicMap : register(t2); Texture2D RoughnessMap : register(t3);",
+                   "cbMaterial", error);
+  if (declared.getHash() != MaterialLayout::getDefault().getHash()) {
+    report.fail("the default layout does not match its HLSL declaration");
+  }
+
+  // 2) Empaquetado y deduplicado: 20k pedidos de 1000 materiales con 40 tablas
+  const unsigned int kUnique = 1000;
+  const unsigned int kTables = 40;
+  const unsigned int kRequests = 20000;
+  MaterialSystem system;
+  system.init(nullptr, MaterialLayout::getDefault());
+  std::vector<Material> materials;
+  materials.reserve(kUnique);
+  for (unsigned int k = 0; k < kUnique; ++k) {
+    materials.emplace_back("Material" + std::to_string(k));
+    makeTestMaterial(materials.back(), k, kTables);
+  }
+
+  std::mt19937 rng(74);
+  std::uniform_int_distribution<unsigned int> pick(0, kUnique - 1);
+  std::vector<unsigned int> requested(kRequests);
+  std::vector<unsigned int> handle(kUnique, kInvalidMaterial);
+  std::vector<unsigned int> acquired;
+  acquired.reserve(kRequests + kUnique);
+  unsigned int mismatches = 0;
+  timer.reset();
+  for (unsigned int r = 0; r < kRequests; ++r) {
+    // Los primeros kUnique pedidos cubren todos los materiales
+    const unsigned int k = r < kUnique ? r : pick(rng);
+    const unsigned int index = system.acquire(materials[k]);
+    acquired.push_back(index);
+    requested[r] = k;
+    if (handle[k] == kInvalidMaterial) {
+      handle[k] = index;
+    }
+    else if (handle[k] != index) {
+      ++mismatches;
+    }
+  }
+  const double acquireMs = timer.elapsedMs();
+
+  MaterialSystemStats stats = system.getStats();
+  if (mismatches > 0 || stats.materials != kUnique || stats.textureTables != kTables) {
+    report.fail("dedup: " + std::to_string(stats.materials) + " materials and " + std::to_string(stats.textureTables) +
+                " tables (expected " + std::to_string(kUnique) + " and " + std::to_string(kTables) + "), " +
+                std::to_string(mismatches) + " mismatched handles");
+  }
+  unsigned int badBytes = 0;
+  for (unsigned int k = 0; k < kUnique; ++k) {
+    if (handle[k] == kInvalidMaterial ||
+        std::memcmp(system.getConstants(handle[k]), materials[k].getConstants().data(), system.getLayout().getSize()) != 0) {
+      ++badBytes;
+      continue;
+    }
+    const XMFLOAT4 expected = materials[k].getVector("BaseColor", XMFLOAT4());
+    const XMFLOAT4 color = system.getBaseColor(handle[k]);
+    if (color.x != expected.x || color.y != expected.y || color.z != expected.z || color.w != expected.w) {
+      ++badBytes;
+    }
+  }
+  if (badBytes > 0) {
+    report.fail(std::to_string(badBytes) + " materials packed with the wrong bytes");
+  }
+  report.log("pack: %u requests -> %u materials (%llu dedup hits), %u tables, %u of %u bytes used, %.2f us/request",
+             kRequests, stats.materials, stats.dedupHits, stats.textureTables, stats.constantBytes,
+             system.getCapacity() * system.getLayout().getSize(), acquireMs * 1000.0 / kRequests);
+
+  // Un material con otro layout no entra
+  Material other("Other", layout);
+  if (system.acquire(other) != kInvalidMaterial) {
+    report.fail("accepted a material with a different layout");
+  }
+
+  // 3) Binds de tablas: lista de draws en orden de escena contra ordenada por clave
+  const unsigned int kDraws = 50000;
+  std::vector<unsigned int> draws(kDraws);
+  for (unsigned int& draw : draws) {
+    draw = handle[pick(rng)];
+  }
+  system.resetBindStats();
+  for (unsigned int draw : draws) {
+    system.track(draw);
+  }
+  const MaterialSystemStats unsorted = system.getStats();
+
+  timer.reset();
+  std::sort(draws.begin(), draws.end(), [&system](unsigned int a, unsigned int b) {
+    return system.getSortKey(a) < system.getSortKey(b);
+  });
+  const double sortMs = timer.elapsedMs();
+  system.resetBindStats();
+  for (unsigned int draw : draws) {
+    system.track(draw);
+  }
+  const MaterialSystemStats sorted = system.getStats();
+  if (sorted.tableBinds != kTables) {
+    report.fail("sorted draws bound " + std::to_string(sorted.tableBinds) + " tables, expected " + std::to_string(kTables));
+  }
+  report.log("binds: %u draws, unsorted %llu table binds, sorted %llu (%.1f%% skipped, sort %.2f ms)",
+             kDraws, unsorted.tableBinds, sorted.tableBinds,
+             100.0 * sorted.tableBindsSkipped / kDraws, sortMs);
+
+  // 4) Soltar todo deja el arreglo vacío y un material nuevo reusa un lugar libre
+  for (unsigned int index : acquired) {
+    system.release(index);
+  }
+  stats = system.getStats();
+  if (stats.materials != 0 || stats.textureTables != 0 || stats.constantBytes != 0) {
+    report.fail("release left " + std::to_string(stats.materials) + " materials and " +
+                std::to_string(stats.textureTables) + " tables");
+  }
+  if (system.acquire(materials[0]) >= kUnique) {
+    report.fail("a released slot was not reused");
+  }
+
+  // 5) Capacidad: el CB de 64 KB llena y el siguiente material distinto falla
+  MaterialSystem full;
+  full.init(nullptr, MaterialLayout::getDefault());
+  Material filler("Filler", MaterialLayout::getDefault());
+  unsigned int accepted = 0;
+  for (unsigned int k = 0; k <= full.getCapacity(); ++k) {
+    const float value = static_cast<float>(k);
+    filler.setFloat("Metallic", &value, 1);
+    if (full.acquire(filler) != kInvalidMaterial) {
+      ++accepted;
+    }
+  }
+  if (accepted != full.getCapacity()) {
+    report.fail("capacity: accepted " + std::to_string(accepted) + " of " + std::to_string(full.getCapacity()));
+  }
+}
@@ -0,0 +1,905 @@
+#include "MeshCodec.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <emmintrin.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+  const unsigned char kIndexCodecHeader = 0xE1;
+  const unsigned char kVertexCodecHeader = 0xA1;
+  /// @brief Entradas de las FIFO de aristas y de vértices (potencia de 2).
+  const unsigned int kCodecFifo = 16;
+  /// @brief Vértices por bloque del codec de vértices (uno por byte de un registro SSE).
+  const size_t kVertexBlock = 16;
+
+  /**
+   * @struct MeshCacheHeader
+   * @brief Inicio del archivo de caché; le siguen las texturas y las mallas comprimidas.
+   */
+  struct
+    MeshCacheHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned long long sourceStamp;
+    /// @brief `sizeof(SimpleVertex)` al guardar: si cambia el layout, la caché ya no sirve.
+    unsigned int vertexStride;
+    unsigned int numMeshes;
+    unsigned int numTextures;
+    unsigned int reserved;
+  };
+
+  static_assert(sizeof(MeshCacheHeader) == 32, "MeshCacheHeader layout changed");
+
+  void
+    writeVarint(std::vector<unsigned char>& out, unsigned int value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<unsigned char>(value | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+  }
+
+  bool
+    readVarint(const unsigned char*& cursor, const unsigned char* end, unsigned int& value) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7) {
+      if (cursor == end) {
+        return false;
+      }
+      const unsigned char byte = *cursor++;
+      value |= static_cast<unsigned int>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  unsigned int
+    zigzag(unsigned int value) {
+    return (value << 1) ^ static_cast<unsigned int>(static_cast<int>(value) >> 31);
+  }
+
+  unsigned int
+    unzigzag(unsigned int value) {
+    return (value >> 1) ^ (0u - (value & 1));
+  }
+
+  /**
+   * @struct IndexCoderState
+   * @brief Estado que el codificador y el decodificador de índices actualizan igual.
+   */
+  struct
+    IndexCoderState {
+    unsigned int edges[kCodecFifo][2];
+    unsigned int vertices[kCodecFifo];
+    unsigned int edgeHead = 0;
+    unsigned int vertexHead = 0;
+    /// @brief Siguiente vértice nuevo esperado (vértices en orden de primer uso).
+    unsigned int next = 0;
+    /// @brief Último vértice escrito explícito (los explícitos van como delta contra él).
+    unsigned int last = 0;
+
+    IndexCoderState() {
+      std::memset(edges, 0xFF, sizeof(edges));
+      std::memset(vertices, 0xFF, sizeof(vertices));
+    }
+
+    void
+      pushEdge(unsigned int a, unsigned int b) {
+      edges[edgeHead & (kCodecFifo - 1)][0] = a;
+      edges[edgeHead & (kCodecFifo - 1)][1] = b;
+      ++edgeHead;
+    }
+
+    void
+      pushVertex(unsigned int v) {
+      vertices[vertexHead & (kCodecFifo - 1)] = v;
+      ++vertexHead;
+    }
+
+    /// @brief Arista a `distance` de la más reciente.
+    const unsigned int*
+      edge(unsigned int distance) const { return edges[(edgeHead - 1 - distance) & (kCodecFifo - 1)]; }
+
+    unsigned int
+      vertex(unsigned int distance) const { return vertices[(vertexHead - 1 - distance) & (kCodecFifo - 1)]; }
+  };
+
+  /**
+   * @brief Vértice suelto (triángulos sin arista compartida): 0 = nuevo, 1..16 = FIFO, si no delta.
+   */
+  void
+    encodeLooseVertex(IndexCoderState& state, unsigned int v, std::vector<unsigned char>& data) {
+    if (v == state.next) {
+      writeVarint(data, 0);
+      ++state.next;
+      state.pushVertex(v);
+      return;
+    }
+    for (unsigned int d = 0; d < kCodecFifo; ++d) {
+      if (state.vertex(d) == v) {
+        writeVarint(data, 1 + d);
+        return;
+      }
+    }
+    writeVarint(data, 1 + kCodecFifo + zigzag(v - state.last));
+    state.last = v;
+    state.pushVertex(v);
+  }
+
+  bool
+    decodeLooseVertex(IndexCoderState& state, const unsigned char*& cursor, const unsigned char* end, unsigned int& v) {
+    unsigned int code = 0;
+    if (!readVarint(cursor, end, code)) {
+      return false;
+    }
+    if (code == 0) {
+      v = state.next++;
+      state.pushVertex(v);
+    }
+    else if (code <= kCodecFifo) {
+      v = state.vertex(code - 1);
+    }
+    else {
+      v = state.last + unzigzag(code - 1 - kCodecFifo);
+      state.last = v;
+      state.pushVertex(v);
+    }
+    return true;
+  }
+
+  void
+    storeIndex(void* destination, size_t i, unsigned int indexStride, unsigned int value) {
+    if (indexStride == 2) {
+      static_cast<unsigned short*>(destination)[i] = static_cast<unsigned short>(value);
+    }
+    else {
+      static_cast<unsigned int*>(destination)[i] = value;
+    }
+  }
+
+  /**
+   * @brief Desempaco los 16 bytes de un plano (el ancho lo dice su código de 2 bits).
+   */
+  __m128i
+    decodePlane(unsigned int code, const unsigned char* data) {
+    switch (code) {
+    case 1: {
+      int packed;
+      std::memcpy(&packed, data, sizeof(packed));
+      const __m128i x = _mm_cvtsi32_si128(packed);
+      const __m128i mask = _mm_set1_epi8(0x03);
+      const __m128i a = _mm_and_si128(x, mask);
+      const __m128i b = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+      const __m128i c = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+      const __m128i d = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+      return _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, b), _mm_unpacklo_epi8(c, d));
+    }
+    case 2: {
+      const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+      const __m128i mask = _mm_set1_epi8(0x0F);
+      return _mm_unpacklo_epi8(_mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+    }
+    case 3:
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    default:
+      return _mm_setzero_si128();
+    }
+  }
+
+  /// @brief Bytes empacados de un plano según su código.
+  const size_t kPlaneBytes[4] = { 0, 4, 8, 16 };
+
+  void
+    writeBytes(std::vector<unsigned char>& out, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+  }
+
+  void
+    writeUInt(std::vector<unsigned char>& out, unsigned int value) {
+    writeBytes(out, &value, sizeof(value));
+  }
+
+  bool
+    readBytes(const unsigned char*& cursor, const unsigned char* end, void* data, size_t size) {
+    if (static_cast<size_t>(end - cursor) < size) {
+      return false;
+    }
+    std::memcpy(data, cursor, size);
+    cursor += size;
+    return true;
+  }
+
+  bool
+    readUInt(const unsigned char*& cursor, const unsigned char* end, unsigned int& value) {
+    return readBytes(cursor, end, &value, sizeof(value));
+  }
+
+  /**
+   * @brief ¿Caben `vertexCount` vértices e `indexCount` índices en los bytes comprimidos de la malla?
+   *
+   * @details Cada bloque de 16 vértices lleva al menos un byte de encabezado por palabra y cada
+   *          triángulo al menos su byte de código. Con eso acoto los conteos de una caché corrupta
+   *          antes de reservar los arreglos.
+   */
+  bool
+    cachedCountsFit(unsigned int vertexCount, unsigned int indexCount, unsigned int vertexBytes, unsigned int indexBytes) {
+    const unsigned long long lanes = sizeof(SimpleVertex) / 4;
+    const unsigned long long blocks = (static_cast<unsigned long long>(vertexCount) + kVertexBlock - 1) / kVertexBlock;
+    return indexCount % 3 == 0 &&
+           vertexBytes >= 1 + blocks * lanes &&
+           indexBytes >= 1ull + indexCount / 3;
+  }
+}
+
+void
+MeshCodec::encodeIndices(const unsigned int* indices, size_t indexCount, std::vector<unsigned char>& out) {
+  const size_t triangles = indexCount / 3;
+  std::vector<unsigned char> data;
+  out.clear();
+  out.reserve(1 + triangles + triangles / 4);
+  out.push_back(kIndexCodecHeader);
+
+  IndexCoderState state;
+  for (size_t t = 0; t < triangles; ++t) {
+    const unsigned int* tri = indices + t * 3;
+
+    // Busco una arista reciente en alguna rotación del triángulo (el winding no cambia)
+    unsigned int hit = kCodecFifo;
+    unsigned int x = 0, y = 0, z = 0;
+    for (unsigned int d = 0; d + 1 < kCodecFifo && hit == kCodecFifo; ++d) {
+      const unsigned int* e = state.edge(d);
+      for (unsigned int r = 0; r < 3; ++r) {
+        if (e[0] == tri[r] && e[1] == tri[(r + 1) % 3]) {
+          hit = d;
+          x = tri[r];
+          y = tri[(r + 1) % 3];
+          z = tri[(r + 2) % 3];
+          break;
+        }
+      }
+    }
+
+    if (hit < kCodecFifo) {
+      // Código: arista en el nibble alto; tercer vértice 0 = nuevo, 1..14 = FIFO, 15 = delta
+      unsigned int third = 15;
+      if (z == state.next) {
+        third = 0;
+        ++state.next;
+        state.pushVertex(z);
+      }
+      else {
+        for (unsigned int d = 0; d < 14; ++d) {
+          if (state.vertex(d) == z) {
+            third = 1 + d;
+            break;
+          }
+        }
+        if (third == 15) {
+          writeVarint(data, zigzag(z - state.last));
+          state.last = z;
+          state.pushVertex(z);
+        }
+      }
+      out.push_back(static_cast<unsigned char>((hit << 4) | third));
+      state.pushEdge(z, y);
+      state.pushEdge(x, z);
+    }
+    else {
+      out.push_back(0xF0);
+      for (unsigned int k = 0; k < 3; ++k) {
+        encodeLooseVertex(state, tri[k], data);
+      }
+      state.pushEdge(tri[1], tri[0]);
+      state.pushEdge(tri[2], tri[1]);
+      state.pushEdge(tri[0], tri[2]);
+    }
+  }
+  out.insert(out.end(), data.begin(), data.end());
+}
+
+bool
+MeshCodec::decodeIndices(void* destination,
+                         size_t indexCount,
+                         unsigned int indexStride,
+                         size_t vertexCount,
+                         const unsigned char* data,
+                         size_t size) {
+  const size_t triangles = indexCount / 3;
+  if (indexCount % 3 != 0 || (indexStride != 2 && indexStride != 4) ||
+      size < 1 + triangles || data[0] != kIndexCodecHeader) {
+    return false;
+  }
+  const unsigned char* codes = data + 1;
+  const unsigned char* cursor = codes + triangles;
+  const unsigned char* end = data + size;
+
+  IndexCoderState state;
+  for (size_t t = 0; t < triangles; ++t) {
+    const unsigned int code = codes[t];
+    const unsigned int hit = code >> 4;
+    unsigned int x, y, z;
+    if (hit < kCodecFifo - 1) {
+      const unsigned int* e = state.edge(hit);
+      x = e[0];
+      y = e[1];
+      const unsigned int third = code & 0x0F;
+      if (third == 0) {
+        z = state.next++;
+        state.pushVertex(z);
+      }
+      else if (third < 15) {
+        z = state.vertex(third - 1);
+      }
+      else {
+        unsigned int delta = 0;
+        if (!readVarint(cursor, end, delta)) {
+          return false;
+        }
+        z = state.last + unzigzag(delta);
+        state.last = z;
+        state.pushVertex(z);
+      }
+      state.pushEdge(z, y);
+      state.pushEdge(x, z);
+    }
+    else {
+      if (!decodeLooseVertex(state, cursor, end, x) ||
+          !decodeLooseVertex(state, cursor, end, y) ||
+          !decodeLooseVertex(state, cursor, end, z)) {
+        return false;
+      }
+      state.pushEdge(y, x);
+      state.pushEdge(z, y);
+      state.pushEdge(x, z);
+    }
+    if (x >= vertexCount || y >= vertexCount || z >= vertexCount) {
+      return false;
+    }
+    storeIndex(destination, t * 3 + 0, indexStride, x);
+    storeIndex(destination, t * 3 + 1, indexStride, y);
+    storeIndex(destination, t * 3 + 2, indexStride, z);
+  }
+  return cursor == end;
+}
+
+void
+MeshCodec::encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& out) {
+  out.clear();
+  out.push_back(kVertexCodecHeader);
+  if (stride == 0 || stride % 4 != 0) {
+    ERROR("MeshCodec", "encodeVertices", "The vertex stride must be a multiple of 4 (got " << stride << ")");
+    return;
+  }
+  const unsigned char* source = static_cast<const unsigned char*>(vertices);
+  const size_t lanes = stride / 4;
+  std::vector<unsigned int> previous(lanes, 0);
+  out.reserve(1 + count * stride / 2);
+
+  for (size_t base = 0; base < count; base += kVertexBlock) {
+    const size_t n = std::min(kVertexBlock, count - base);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      // Delta + zigzag y byte-shuffle: planes[p][i] es el byte p del vértice i
+      unsigned char planes[4][kVertexBlock] = {};
+      for (size_t i = 0; i < n; ++i) {
+        unsigned int value;
+        std::memcpy(&value, source + (base + i) * stride + lane * 4, sizeof(value));
+        const unsigned int encoded = zigzag(value - previous[lane]);
+        previous[lane] = value;
+        for (unsigned int p = 0; p < 4; ++p) {
+          planes[p][i] = static_cast<unsigned char>(encoded >> (8 * p));
+        }
+      }
+
+      // Un byte de encabezado con el ancho (2 bits) de cada plano y luego los planos empacados
+      const size_t headerAt = out.size();
+      out.push_back(0);
+      unsigned char header = 0;
+      for (unsigned int p = 0; p < 4; ++p) {
+        unsigned char bits = 0;
+        for (size_t i = 0; i < kVertexBlock; ++i) {
+          bits |= planes[p][i];
+        }
+        const unsigned int code = bits == 0 ? 0 : (bits < 4 ? 1 : (bits < 16 ? 2 : 3));
+        header |= static_cast<unsigned char>(code << (2 * p));
+        const unsigned char* plane = planes[p];
+        if (code == 1) {
+          for (size_t j = 0; j < 4; ++j) {
+            out.push_back(static_cast<unsigned char>(plane[4 * j] | (plane[4 * j + 1] << 2) |
+                                                     (plane[4 * j + 2] << 4) | (plane[4 * j + 3] << 6)));
+          }
+        }
+        else if (code == 2) {
+          for (size_t j = 0; j < 8; ++j) {
+            out.push_back(static_cast<unsigned char>(plane[2 * j] | (plane[2 * j + 1] << 4)));
+          }
+        }
+        else if (code == 3) {
+          out.insert(out.end(), plane, plane + kVertexBlock);
+        }
+      }
+      out[headerAt] = header;
+    }
+  }
+}
+
+bool
+MeshCodec::decodeVertices(void* destination, size_t count, size_t stride, const unsigned char* data, size_t size) {
+  if (size < 1 || data[0] != kVertexCodecHeader || stride == 0 || stride % 4 != 0) {
+    return false;
+  }
+  unsigned char* output = static_cast<unsigned char*>(destination);
+  const unsigned char* cursor = data + 1;
+  const unsigned char* end = data + size;
+  const size_t lanes = stride / 4;
+  std::vector<unsigned int> previous(lanes, 0);
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i zero = _mm_setzero_si128();
+  alignas(16) unsigned int values[kVertexBlock];
+
+  for (size_t base = 0; base < count; base += kVertexBlock) {
+    const size_t n = std::min(kVertexBlock, count - base);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      if (cursor == end) {
+        return false;
+      }
+      const unsigned int header = *cursor++;
+      __m128i planes[4];
+      for (unsigned int p = 0; p < 4; ++p) {
+        const unsigned int code = (header >> (2 * p)) & 3;
+        if (static_cast<size_t>(end - cursor) < kPlaneBytes[code]) {
+          return false;
+        }
+        planes[p] = decodePlane(code, cursor);
+        cursor += kPlaneBytes[code];
+      }
+
+      // Deshago el byte-shuffle: 4 planos de 16 bytes -> 16 palabras de 32 bits
+      const __m128i low01 = _mm_unpacklo_epi8(planes[0], planes[1]);
+      const __m128i low23 = _mm_unpacklo_epi8(planes[2], planes[3]);
+      const __m128i high01 = _mm_unpackhi_epi8(planes[0], planes[1]);
+      const __m128i high23 = _mm_unpackhi_epi8(planes[2], planes[3]);
+      const __m128i words[4] = {
+        _mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23),
+        _mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23)
+      };
+
+      // Zigzag inverso y suma prefija (los deltas de relleno son 0, no mueven el acumulado)
+      __m128i carry = _mm_set1_epi32(static_cast<int>(previous[lane]));
+      for (unsigned int q = 0; q < 4; ++q) {
+        __m128i delta = _mm_xor_si128(_mm_srli_epi32(words[q], 1), _mm_sub_epi32(zero, _mm_and_si128(words[q], one)));
+        delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+        delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+        delta = _mm_add_epi32(delta, carry);
+        carry = _mm_shuffle_epi32(delta, 0xFF);
+        _mm_store_si128(reinterpret_cast<__m128i*>(values) + q, delta);
+      }
+      previous[lane] = static_cast<unsigned int>(_mm_cvtsi128_si32(carry));
+
+      unsigned char* target = output + base * stride + lane * 4;
+      for (size_t i = 0; i < n; ++i) {
+        std::memcpy(target + i * stride, &values[i], sizeof(unsigned int));
+      }
+    }
+  }
+  return cursor == end;
+}
+
+void
+MeshCodec::optimizeVertexFetch(MeshComponent& mesh) {
+  const size_t numVertices = mesh.m_vertex.size();
+  for (unsigned int index : mesh.m_index) {
+    if (index >= numVertices) {
+      ERROR("MeshCodec", "optimizeVertexFetch", "Mesh " << mesh.m_name.c_str() << " has an index out of range");
+      return;
+    }
+  }
+  const bool hasSkin = mesh.m_skin.size() == numVertices;
+  std::vector<unsigned int> remap(numVertices, 0xFFFFFFFF);
+  std::vector<SimpleVertex> vertices;
+  std::vector<SkinInfluence> skin;
+  vertices.reserve(numVertices);
+  for (unsigned int& index : mesh.m_index) {
+    if (remap[index] == 0xFFFFFFFF) {
+      remap[index] = static_cast<unsigned int>(vertices.size());
+      vertices.push_back(mesh.m_vertex[index]);
+      if (hasSkin) {
+        skin.push_back(mesh.m_skin[index]);
+      }
+    }
+    index = remap[index];
+  }
+  mesh.m_vertex.swap(vertices);
+  if (hasSkin) {
+    mesh.m_skin.swap(skin);
+  }
+  mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+}
+
+HRESULT
+MeshCodec::saveCache(const std::string& path,
+                     unsigned long long sourceStamp,
+                     const std::vector<MeshComponent>& meshes,
+                     const std::vector<std::string>& textures) {
+  MeshCacheHeader header = {};
+  std::memcpy(header.magic, kMeshCacheMagic, sizeof(header.magic));
+  header.version = kMeshCacheVersion;
+  header.sourceStamp = sourceStamp;
+  header.vertexStride = sizeof(SimpleVertex);
+  header.numMeshes = static_cast<unsigned int>(meshes.size());
+  header.numTextures = static_cast<unsigned int>(textures.size());
+
+  std::vector<unsigned char> blob;
+  writeBytes(blob, &header, sizeof(header));
+  for (const std::string& texture : textures) {
+    writeUInt(blob, static_cast<unsigned int>(texture.size()));
+    writeBytes(blob, texture.data(), texture.size());
+  }
+  std::vector<unsigned char> vertexData;
+  std::vector<unsigned char> indexData;
+  std::vector<unsigned char> bvhData;
+  for (const MeshComponent& mesh : meshes) {
+    if (!mesh.m_skin.empty()) {
+      ERROR("MeshCodec", "saveCache", "Skinned meshes are not cached (" << mesh.m_name.c_str() << ")");
+      return E_INVALIDARG;
+    }
+    encodeVertices(mesh.m_vertex.data(), mesh.m_vertex.size(), sizeof(SimpleVertex), vertexData);
+    encodeIndices(mesh.m_index.data(), mesh.m_index.size(), indexData);
+    bvhData.clear();
+    if (!mesh.m_bvh.isNull()) {
+      mesh.m_bvh->serialize(bvhData);
+    }
+    writeUInt(blob, static_cast<unsigned int>(mesh.m_name.size()));
+    writeBytes(blob, mesh.m_name.data(), mesh.m_name.size());
+    writeUInt(blob, static_cast<unsigned int>(mesh.m_vertex.size()));
+    writeUInt(blob, static_cast<unsigned int>(mesh.m_index.size()));
+    writeUInt(blob, static_cast<unsigned int>(vertexData.size()));
+    writeUInt(blob, static_cast<unsigned int>(indexData.size()));
+    writeUInt(blob, static_cast<unsigned int>(bvhData.size()));
+    writeBytes(blob, vertexData.data(), vertexData.size());
+    writeBytes(blob, indexData.data(), indexData.size());
+    writeBytes(blob, bvhData.data(), bvhData.size());
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    ERROR("MeshCodec", "saveCache", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+  if (!file) {
+    ERROR("MeshCodec", "saveCache", "Failed to write " << path.c_str());
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+bool
+MeshCodec::loadCache(const std::string& path,
+                     unsigned long long sourceStamp,
+                     std::vector<MeshComponent>& meshes,
+                     std::vector<std::string>& textures) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  const std::streamoff fileSize = file.tellg();
+  if (fileSize < static_cast<std::streamoff>(sizeof(MeshCacheHeader))) {
+    return false;
+  }
+  std::vector<unsigned char> blob(static_cast<size_t>(fileSize));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(blob.data()), blob.size());
+  if (!file) {
+    return false;
+  }
+
+  const unsigned char* cursor = blob.data();
+  const unsigned char* end = blob.data() + blob.size();
+  MeshCacheHeader header;
+  readBytes(cursor, end, &header, sizeof(header));
+  if (std::memcmp(header.magic, kMeshCacheMagic, sizeof(header.magic)) != 0 ||
+      header.version != kMeshCacheVersion || header.sourceStamp != sourceStamp ||
+      header.vertexStride != sizeof(SimpleVertex)) {
+    return false;
+  }
+
+  // Cada textura lleva al menos su longitud y cada malla sus seis enteros: acoto los conteos al archivo
+  const unsigned long long minimumBytes = (static_cast<unsigned long long>(header.numTextures) +
+                                           static_cast<unsigned long long>(header.numMeshes) * 6) * sizeof(unsigned int);
+  if (minimumBytes > static_cast<unsigned long long>(end - cursor)) {
+    return false;
+  }
+  std::vector<std::string> cachedTextures(header.numTextures);
+  for (std::string& texture : cachedTextures) {
+    unsigned int length = 0;
+    if (!readUInt(cursor, end, length) || static_cast<size_t>(end - cursor) < length) {
+      return false;
+    }
+    texture.assign(reinterpret_cast<const char*>(cursor), length);
+    cursor += length;
+  }
+
+  // Cada malla se decodifica directo a sus arreglos finales
+  std::vector<MeshComponent> cachedMeshes(header.numMeshes);
+  for (MeshComponent& mesh : cachedMeshes) {
+    unsigned int nameLength = 0, vertexCount = 0, indexCount = 0, vertexBytes = 0, indexBytes = 0, bvhBytes = 0;
+    if (!readUInt(cursor, end, nameLength) || static_cast<size_t>(end - cursor) < nameLength) {
+      return false;
+    }
+    mesh.m_name.assign(reinterpret_cast<const char*>(cursor), nameLength);
+    cursor += nameLength;
+    if (!readUInt(cursor, end, vertexCount) || !readUInt(cursor, end, indexCount) ||
+        !readUInt(cursor, end, vertexBytes) || !readUInt(cursor, end, indexBytes) || !readUInt(cursor, end, bvhBytes) ||
+        static_cast<unsigned long long>(end - cursor) < static_cast<unsigned long long>(vertexBytes) + indexBytes + bvhBytes ||
+        !cachedCountsFit(vertexCount, indexCount, vertexBytes, indexBytes)) {
+      ERROR("MeshCodec", "loadCache", "Corrupt mesh " << mesh.m_name.c_str() << " in " << path.c_str());
+      return false;
+    }
+    mesh.m_vertex.resize(vertexCount);
+    mesh.m_index.resize(indexCount);
+    if (!decodeVertices(mesh.m_vertex.data(), vertexCount, sizeof(SimpleVertex), cursor, vertexBytes) ||
+        !decodeIndices(mesh.m_index.data(), indexCount, sizeof(unsigned int), vertexCount,
+                       cursor + vertexBytes, indexBytes)) {
+      ERROR("MeshCodec", "loadCache", "Corrupt mesh " << mesh.m_name.c_str() << " in " << path.c_str());
+      return false;
+    }
+    cursor += vertexBytes + indexBytes;
+    // La BVH viene en su sección; si no cuadra con la malla la construye el modelo
+    if (bvhBytes > 0) {
+      mesh.m_bvh = EU::MakeShared<TriangleBVH>();
+      if (!mesh.m_bvh->deserialize(mesh, cursor, bvhBytes)) {
+        mesh.m_bvh.reset();
+      }
+      cursor += bvhBytes;
+    }
+    mesh.m_numVertex = static_cast<int>(vertexCount);
+    mesh.m_numIndex = static_cast<int>(indexCount);
+  }
+
+  meshes.swap(cachedMeshes);
+  textures.swap(cachedTextures);
+  return true;
+}
+
+namespace {
+
+  /**
+   * @brief Rejilla de `side` x `side` con alturas de `height(x, z)`.
+   */
+  template<typename HeightFunc>
+  MeshComponent
+    makeSurface(const std::string& name, unsigned int side, HeightFunc height) {
+    MeshComponent mesh;
+    mesh.m_name = name;
+    for (unsigned int z = 0; z < side; ++z) {
+      for (unsigned int x = 0; x < side; ++x) {
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(x * 0.25f, height(x, z), z * 0.25f);
+        v.Tex = XMFLOAT2(x / static_cast<float>(side - 1), z / static_cast<float>(side - 1));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    for (unsigned int z = 0; z + 1 < side; ++z) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = z * side + x;
+        const unsigned int quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Esfera UV con `rings` x `segments` vértices.
+   */
+  MeshComponent
+    makeSphere(unsigned int rings, unsigned int segments) {
+    MeshComponent mesh;
+    mesh.m_name = "sphere";
+    for (unsigned int r = 0; r < rings; ++r) {
+      const float theta = XM_PI * r / (rings - 1);
+      for (unsigned int s = 0; s < segments; ++s) {
+        const float phi = XM_2PI * s / segments;
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        v.Tex = XMFLOAT2(s / static_cast<float>(segments), r / static_cast<float>(rings - 1));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    for (unsigned int r = 0; r + 1 < rings; ++r) {
+      for (unsigned int s = 0; s < segments; ++s) {
+        const unsigned int a = r * segments + s;
+        const unsigned int b = r * segments + (s + 1) % segments;
+        const unsigned int quad[6] = { a, a + segments, b, b, a + segments, b + segments };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief ¿Mismos triángulos en el mismo orden, permitiendo rotarlos?
+   */
+  bool
+    sameTriangles(const std::vector<unsigned int>& a, const std::vector<unsigned int>& b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t t = 0; t < a.size(); t += 3) {
+      bool found = false;
+      for (unsigned int r = 0; r < 3 && !found; ++r) {
+        found = a[t] == b[t + r] && a[t + 1] == b[t + (r + 1) % 3] && a[t + 2] == b[t + (r + 2) % 3];
+      }
+      if (!found) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Copio la caché cambiando el entero en `fieldOffset` y regreso true si `loadCache` la rechaza.
+   */
+  bool
+    corruptCacheRejected(const std::string& path, size_t fieldOffset, unsigned int value) {
+    std::ifstream source(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    if (bytes.size() < fieldOffset + sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&bytes[fieldOffset], &value, sizeof(value));
+    const std::string corruptPath = path + ".corrupt";
+    std::ofstream(corruptPath, std::ios::binary).write(bytes.data(), bytes.size());
+    std::vector<MeshComponent> meshes;
+    std::vector<std::string> textures;
+    const bool rejected = !MeshCodec::loadCache(corruptPath, 1234, meshes, textures) && meshes.empty();
+    std::remove(corruptPath.c_str());
+    return rejected;
+  }
+}
+
+void
+MeshCodec::runBenchmark(BenchmarkReport& report) {
+  std::vector<MeshComponent> meshes;
+  meshes.push_back(makeSurface("plane", 256, [](unsigned int, unsigned int) { return 0.0f; }));
+  meshes.push_back(makeSurface("terrain", 512, [](unsigned int x, unsigned int z) {
+    return std::sin(x * 0.05f) * 4.0f + std::cos(z * 0.033f) * 6.0f + std::sin((x + z) * 0.31f) * 0.4f;
+  }));
+  meshes.push_back(makeSphere(384, 512));
+
+  size_t totalRaw = 0;
+  size_t totalEncoded = 0;
+  const double mb = 1.0 / (1024.0 * 1024.0);
+  for (MeshComponent& mesh : meshes) {
+    optimizeVertexFetch(mesh);
+    const size_t vertexBytes = mesh.m_vertex.size() * sizeof(SimpleVertex);
+    const size_t indexBytes = mesh.m_index.size() * sizeof(unsigned int);
+
+    std::vector<unsigned char> vertexData;
+    std::vector<unsigned char> indexData;
+    Timer timer;
+    encodeVertices(mesh.m_vertex.data(), mesh.m_vertex.size(), sizeof(SimpleVertex), vertexData);
+    encodeIndices(mesh.m_index.data(), mesh.m_index.size(), indexData);
+    const double encodeMs = timer.elapsedMs();
+
+    // Mejor de 5 decodificaciones a un buffer como el de staging
+    std::vector<SimpleVertex> vertices(mesh.m_vertex.size());
+    std::vector<unsigned int> indices(mesh.m_index.size());
+    double vertexMs = 1.0e9;
+    double indexMs = 1.0e9;
+    bool decoded = true;
+    for (unsigned int run = 0; run < 5; ++run) {
+      timer.reset();
+      decoded = decodeVertices(vertices.data(), vertices.size(), sizeof(SimpleVertex), vertexData.data(), vertexData.size()) && decoded;
+      vertexMs = std::min(vertexMs, timer.elapsedMs());
+      timer.reset();
+      decoded = decodeIndices(indices.data(), indices.size(), sizeof(unsigned int), vertices.size(),
+                              indexData.data(), indexData.size()) && decoded;
+      indexMs = std::min(indexMs, timer.elapsedMs());
+    }
+    if (!decoded) {
+      report.fail("mesh " + mesh.m_name + " failed to decode");
+      continue;
+    }
+    if (std::memcmp(vertices.data(), mesh.m_vertex.data(), vertexBytes) != 0) {
+      report.fail("decoded vertices of " + mesh.m_name + " differ");
+    }
+    if (!sameTriangles(mesh.m_index, indices)) {
+      report.fail("decoded triangles of " + mesh.m_name + " differ");
+    }
+    std::vector<unsigned short> indices16(mesh.m_index.size());
+    if (mesh.m_vertex.size() <= 0xFFFF &&
+        (!decodeIndices(indices16.data(), indices16.size(), 2, vertices.size(), indexData.data(), indexData.size()) ||
+         indices16.back() != indices.back())) {
+      report.fail("16-bit decode of " + mesh.m_name + " differs");
+    }
+
+    report.log("%-8s %7zu verts %8zu tris: vertices %.2f -> %.2f MB (%.2fx), indices %.2f -> %.2f MB (%.2fx, %.2f bytes/tri), encode %.1f ms",
+               mesh.m_name.c_str(), mesh.m_vertex.size(), mesh.m_index.size() / 3,
+               vertexBytes * mb, vertexData.size() * mb, static_cast<double>(vertexBytes) / vertexData.size(),
+               indexBytes * mb, indexData.size() * mb, static_cast<double>(indexBytes) / indexData.size(),
+               static_cast<double>(indexData.size()) / (mesh.m_index.size() / 3), encodeMs);
+    report.log("         decode: vertices %.2f ms (%.2f GB/s), indices %.2f ms (%.2f GB/s)",
+               vertexMs, vertexBytes * mb / 1024.0 / (vertexMs * 1.0e-3),
+               indexMs, indexBytes * mb / 1024.0 / (indexMs * 1.0e-3));
+    totalRaw += vertexBytes + indexBytes;
+    totalEncoded += vertexData.size() + indexData.size();
+  }
+  report.log("total: %.2f MB -> %.2f MB on disk (%.2fx)", totalRaw * mb, totalEncoded * mb,
+             static_cast<double>(totalRaw) / totalEncoded);
+
+  // Datos truncados o corruptos no deben leerse fuera del buffer
+  std::vector<unsigned char> indexData;
+  std::vector<unsigned char> vertexData;
+  encodeIndices(meshes[0].m_index.data(), meshes[0].m_index.size(), indexData);
+  encodeVertices(meshes[0].m_vertex.data(), meshes[0].m_vertex.size(), sizeof(SimpleVertex), vertexData);
+  std::vector<unsigned int> indices(meshes[0].m_index.size());
+  std::vector<SimpleVertex> vertices(meshes[0].m_vertex.size());
+  if (decodeIndices(indices.data(), indices.size(), 4, vertices.size(), indexData.data(), indexData.size() / 2) ||
+      decodeVertices(vertices.data(), vertices.size(), sizeof(SimpleVertex), vertexData.data(), vertexData.size() / 2) ||
+      decodeIndices(indices.data(), indices.size(), 4, 16, indexData.data(), indexData.size())) {
+    report.fail("truncated or out-of-range data was accepted");
+  }
+
+  // Ida y vuelta por la caché en disco
+  const std::string path = "benchmark_mesh_cache.urmesh";
+  const std::vector<std::string> textures = { "terrain_albedo", "sphere_albedo" };
+  std::vector<MeshComponent> loaded;
+  std::vector<std::string> loadedTextures;
+  meshes[0].m_bvh = EU::MakeShared<TriangleBVH>();
+  meshes[0].m_bvh->build(meshes[0].m_vertex, meshes[0].m_index);
+  Timer timer;
+  const bool saved = SUCCEEDED(saveCache(path, 1234, meshes, textures));
+  const double saveMs = timer.elapsedMs();
+  timer.reset();
+  const bool cached = saved && loadCache(path, 1234, loaded, loadedTextures);
+  const double loadMs = timer.elapsedMs();
+  std::vector<MeshComponent> stale;
+  std::vector<std::string> staleTextures;
+  if (!cached || loaded.size() != meshes.size() || loadedTextures != textures) {
+    report.fail("the mesh cache did not round-trip");
+  }
+  else if (loadCache(path, 4321, stale, staleTextures) || !stale.empty()) {
+    report.fail("a cache for another version of the source was accepted");
+  }
+  else {
+    for (size_t i = 0; i < meshes.size(); ++i) {
+      if (loaded[i].m_name != meshes[i].m_name || loaded[i].m_vertex.size() != meshes[i].m_vertex.size() ||
+          !sameTriangles(meshes[i].m_index, loaded[i].m_index)) {
+        report.fail("cached mesh " + meshes[i].m_name + " differs");
+      }
+      if (loaded[i].m_bvh.isNull() != meshes[i].m_bvh.isNull() ||
+          (!loaded[i].m_bvh.isNull() && loaded[i].m_bvh->getNumNodes() != meshes[i].m_bvh->getNumNodes())) {
+        report.fail("the BVH section of " + meshes[i].m_name + " did not round-trip");
+      }
+    }
+    report.log("cache file: save %.1f ms, load + decode %.1f ms", saveMs, loadMs);
+
+    // Conteos corruptos se rechazan antes de reservar (no terminan en bad_alloc)
+    size_t meshOffset = sizeof(MeshCacheHeader);
+    for (const std::string& texture : textures) {
+      meshOffset += sizeof(unsigned int) + texture.size();
+    }
+    const size_t countsOffset = meshOffset + sizeof(unsigned int) + meshes[0].m_name.size();
+    if (!corruptCacheRejected(path, offsetof(MeshCacheHeader, numMeshes), 0x7FFFFFFFu) ||
+        !corruptCacheRejected(path, offsetof(MeshCacheHeader, numTextures), 0xFFFFFFF0u) ||
+        !corruptCacheRejected(path, countsOffset, 0xFFFFFFF0u) ||
+        !corruptCacheRejected(path, countsOffset + sizeof(unsigned int), 0x7FFFFFF8u)) {
+      report.fail("a cache with corrupt mesh or vertex/index counts was accepted");
+    }
+  }
+  std::remove(path.c_str());
+}
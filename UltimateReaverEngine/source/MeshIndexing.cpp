@@ -0,0 +1,302 @@
+#include "MeshIndexing.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <emmintrin.h>
+#include <random>
+
+bool
+MeshIndexing::fitsIn16Bit(const unsigned int* indices, size_t count) {
+  // OR de todo: si ningún índice prende un bit alto, el resultado tampoco
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i* src = reinterpret_cast<const __m128i*>(indices + i);
+    acc0 = _mm_or_si128(acc0, _mm_or_si128(_mm_loadu_si128(src), _mm_loadu_si128(src + 1)));
+    acc1 = _mm_or_si128(acc1, _mm_or_si128(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3)));
+  }
+  alignas(16) unsigned int lanes[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_or_si128(acc0, acc1));
+  unsigned int bits = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+  for (; i < count; ++i) {
+    bits |= indices[i];
+  }
+  return (bits >> 16) == 0;
+}
+
+DXGI_FORMAT
+MeshIndexing::chooseFormat(const MeshComponent& mesh) {
+  return fitsIn16Bit(mesh.m_index.data(), mesh.m_index.size()) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+
+void
+MeshIndexing::narrow(const unsigned int* indices, size_t count, unsigned short* out) {
+  // SSE2 solo empaca con signo: corro el rango a [-32768, 32767] y lo regreso después
+  const __m128i bias32 = _mm_set1_epi32(0x8000);
+  const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i* src = reinterpret_cast<const __m128i*>(indices + i);
+    __m128i lo = _mm_sub_epi32(_mm_loadu_si128(src), bias32);
+    __m128i hi = _mm_sub_epi32(_mm_loadu_si128(src + 1), bias32);
+    __m128i packed = _mm_xor_si128(_mm_packs_epi32(lo, hi), bias16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+  }
+  for (; i < count; ++i) {
+    out[i] = static_cast<unsigned short>(indices[i]);
+  }
+}
+
+unsigned int
+MeshIndexing::split(const MeshComponent& mesh, std::vector<MeshComponent>& chunks) {
+  chunks.clear();
+  const unsigned int numVertices = static_cast<unsigned int>(mesh.m_vertex.size());
+  if (numVertices <= kMaxVertices16) {
+    chunks.push_back(mesh);
+    return 0;
+  }
+  const bool hasSkin = mesh.m_skin.size() == mesh.m_vertex.size();
+
+  // Índice local de cada vértice en el pedazo actual (válido si su marca es la del pedazo)
+  std::vector<unsigned int> local(numVertices, 0);
+  std::vector<unsigned int> stamp(numVertices, 0xFFFFFFFF);
+  std::vector<bool> used(numVertices, false);
+  unsigned int duplicated = 0;
+
+  MeshComponent chunk;
+  unsigned int chunkId = 0;
+  auto finish = [&]() {
+    chunk.m_name = mesh.m_name + "#" + std::to_string(chunkId);
+    chunk.m_numVertex = static_cast<int>(chunk.m_vertex.size());
+    chunk.m_numIndex = static_cast<int>(chunk.m_index.size());
+    chunks.push_back(std::move(chunk));
+    chunk = MeshComponent();
+    ++chunkId;
+  };
+
+  const size_t numIndices = mesh.m_index.size() - mesh.m_index.size() % 3;
+  for (size_t t = 0; t < numIndices; t += 3) {
+    const unsigned int* tri = &mesh.m_index[t];
+    if (tri[0] >= numVertices || tri[1] >= numVertices || tri[2] >= numVertices) {
+      continue;
+    }
+    // Vértices nuevos que metería este triángulo (sin contar repetidos)
+    unsigned int added = 0;
+    for (unsigned int k = 0; k < 3; ++k) {
+      const bool repeated = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+      added += (!repeated && stamp[tri[k]] != chunkId) ? 1 : 0;
+    }
+    if (chunk.m_vertex.size() + added > kMaxVertices16) {
+      finish();
+    }
+    for (unsigned int k = 0; k < 3; ++k) {
+      const unsigned int v = tri[k];
+      if (stamp[v] != chunkId) {
+        stamp[v] = chunkId;
+        local[v] = static_cast<unsigned int>(chunk.m_vertex.size());
+        chunk.m_vertex.push_back(mesh.m_vertex[v]);
+        if (hasSkin) {
+          chunk.m_skin.push_back(mesh.m_skin[v]);
+        }
+        duplicated += used[v] ? 1 : 0;
+        used[v] = true;
+      }
+      chunk.m_index.push_back(local[v]);
+    }
+  }
+  if (!chunk.m_index.empty()) {
+    finish();
+  }
+  return duplicated;
+}
+
+MeshSplitStats
+MeshIndexing::splitLargeMeshes(std::vector<MeshComponent>& meshes) {
+  MeshSplitStats stats;
+  std::vector<MeshComponent> result;
+  result.reserve(meshes.size());
+  std::vector<MeshComponent> chunks;
+  for (MeshComponent& mesh : meshes) {
+    if (mesh.m_vertex.size() <= kMaxVertices16 || fitsIn16Bit(mesh.m_index.data(), mesh.m_index.size())) {
+      result.push_back(std::move(mesh));
+      continue;
+    }
+    // Conviene si los índices que paso a 16 bits pesan más que los vértices duplicados
+    const unsigned int duplicated = split(mesh, chunks);
+    const size_t vertexBytes = sizeof(SimpleVertex) + (mesh.m_skin.empty() ? 0 : sizeof(SkinInfluence));
+    const size_t added = static_cast<size_t>(duplicated) * vertexBytes;
+    const size_t saved = mesh.m_index.size() * (sizeof(unsigned int) - sizeof(unsigned short));
+    if (chunks.size() > 1 && added < saved) {
+      ++stats.splitMeshes;
+      stats.chunks += static_cast<unsigned int>(chunks.size());
+      stats.duplicatedVertices += duplicated;
+      for (MeshComponent& chunk : chunks) {
+        result.push_back(std::move(chunk));
+      }
+    }
+    else {
+      ++stats.keptMeshes;
+      result.push_back(std::move(mesh));
+    }
+  }
+  meshes.swap(result);
+  return stats;
+}
+
+size_t
+MeshIndexing::getIndexBytes(const std::vector<MeshComponent>& meshes, size_t* bytes32) {
+  size_t bytes = 0;
+  size_t wide = 0;
+  for (const MeshComponent& mesh : meshes) {
+    bytes += mesh.m_index.size() * getStride(chooseFormat(mesh));
+    wide += mesh.m_index.size() * sizeof(unsigned int);
+  }
+  if (bytes32) {
+    *bytes32 = wide;
+  }
+  return bytes;
+}
+
+namespace {
+
+  /**
+   * @brief Rejilla de `side` x `side` vértices (triángulos en orden de filas, como vienen de un DCC).
+   */
+  MeshComponent
+    makeGrid(const std::string& name, unsigned int side) {
+    MeshComponent mesh;
+    mesh.m_name = name;
+    mesh.m_vertex.reserve(side * side);
+    for (unsigned int y = 0; y < side; ++y) {
+      for (unsigned int x = 0; x < side; ++x) {
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(static_cast<float>(x), 0.0f, static_cast<float>(y));
+        v.Tex = XMFLOAT2(x / static_cast<float>(side), y / static_cast<float>(side));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    mesh.m_index.reserve((side - 1) * (side - 1) * 6);
+    for (unsigned int y = 0; y + 1 < side; ++y) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = y * side + x;
+        const unsigned int quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Malla con triángulos al azar (sin localidad): partirla duplicaría casi todo.
+   */
+  MeshComponent
+    makeSoup(const std::string& name, unsigned int vertices, unsigned int triangles, std::mt19937& rng) {
+    MeshComponent mesh = makeGrid(name, 2);
+    mesh.m_vertex.assign(vertices, mesh.m_vertex[0]);
+    for (unsigned int i = 0; i < vertices; ++i) {
+      mesh.m_vertex[i].Pos.x = static_cast<float>(i);
+    }
+    std::uniform_int_distribution<unsigned int> pick(0, vertices - 1);
+    mesh.m_index.resize(triangles * 3);
+    for (unsigned int& index : mesh.m_index) {
+      index = pick(rng);
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+}
+
+void
+MeshIndexing::runBenchmark(BenchmarkReport& report) {
+  std::mt19937 rng(11);
+
+  // Detección y conversión sobre 16M índices
+  const size_t count = 16u << 20;
+  std::vector<unsigned int> indices(count);
+  std::uniform_int_distribution<unsigned int> small(0, 65535);
+  for (unsigned int& index : indices) {
+    index = small(rng);
+  }
+  Timer timer;
+  const bool fits = fitsIn16Bit(indices.data(), indices.size());
+  const double simdMs = timer.elapsedMs();
+  timer.reset();
+  unsigned int maxIndex = 0;
+  for (unsigned int index : indices) {
+    maxIndex = std::max(maxIndex, index);
+  }
+  const double scalarMs = timer.elapsedMs();
+  if (!fits || maxIndex > 0xFFFF) {
+    report.fail("16-bit indices were not detected");
+  }
+  indices[count / 2] = 70000;
+  if (fitsIn16Bit(indices.data(), indices.size())) {
+    report.fail("a 32-bit index was missed");
+  }
+  indices[count / 2] = 65535;
+  const double gigabytes = count * sizeof(unsigned int) / (1024.0 * 1024.0 * 1024.0);
+  report.log("detect 16-bit on %zu indices: SSE2 OR %.2f ms (%.1f GB/s), scalar max %.2f ms",
+             count, simdMs, gigabytes / (simdMs * 0.001), scalarMs);
+
+  std::vector<unsigned short> narrowed(count);
+  timer.reset();
+  narrow(indices.data(), indices.size(), narrowed.data());
+  const double narrowMs = timer.elapsedMs();
+  for (size_t i = 0; i < count; ++i) {
+    if (narrowed[i] != indices[i]) {
+      report.fail("narrowed index " + std::to_string(i) + " differs");
+      break;
+    }
+  }
+  report.log("narrow to 16-bit: %.2f ms (%.1f GB/s read)", narrowMs, gigabytes / (narrowMs * 0.001));
+
+  // Escena: 300 mallas chicas, 4 grandes de 160k vértices y una sopa de triángulos
+  std::vector<MeshComponent> scene;
+  std::uniform_int_distribution<unsigned int> side(10, 200);
+  for (unsigned int i = 0; i < 300; ++i) {
+    scene.push_back(makeGrid("small" + std::to_string(i), side(rng)));
+  }
+  for (unsigned int i = 0; i < 4; ++i) {
+    scene.push_back(makeGrid("terrain" + std::to_string(i), 400));
+  }
+  scene.push_back(makeSoup("soup", 100000, 100000, rng));
+
+  size_t bytes32 = 0;
+  const size_t before = getIndexBytes(scene, &bytes32);
+  const size_t meshesBefore = scene.size();
+  timer.reset();
+  const MeshSplitStats stats = splitLargeMeshes(scene);
+  const double splitMs = timer.elapsedMs();
+  const size_t after = getIndexBytes(scene);
+  const double mb = 1.0 / (1024.0 * 1024.0);
+  report.log("scene of %zu meshes: index buffers %.2f MB all 32-bit -> %.2f MB picking 16-bit -> %.2f MB after splitting (%.0f%% saved)",
+             meshesBefore, bytes32 * mb, before * mb, after * mb, 100.0 * (1.0 - static_cast<double>(after) / bytes32));
+  report.log("split: %u meshes into %u chunks in %.2f ms, %u duplicated vertices (%.2f MB), %u kept at 32-bit (not worth it)",
+             stats.splitMeshes, stats.chunks, splitMs, stats.duplicatedVertices,
+             stats.duplicatedVertices * sizeof(SimpleVertex) * mb, stats.keptMeshes);
+  if (stats.splitMeshes != 4 || stats.keptMeshes != 1) {
+    report.fail("expected the 4 terrains to be split and the triangle soup to be kept");
+  }
+
+  // Los pedazos tienen los mismos triángulos, en el mismo orden
+  const MeshComponent terrain = makeGrid("terrain", 400);
+  std::vector<MeshComponent> chunks;
+  split(terrain, chunks);
+  size_t t = 0;
+  bool same = true;
+  for (const MeshComponent& chunk : chunks) {
+    same = same && chunk.m_vertex.size() <= kMaxVertices16 &&
+           fitsIn16Bit(chunk.m_index.data(), chunk.m_index.size());
+    for (size_t i = 0; i < chunk.m_index.size() && same; ++i, ++t) {
+      const XMFLOAT3& a = chunk.m_vertex[chunk.m_index[i]].Pos;
+      const XMFLOAT3& b = terrain.m_vertex[terrain.m_index[t]].Pos;
+      same = a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+  }
+  if (!same || t != terrain.m_index.size()) {
+    report.fail("split chunks do not reproduce the original triangles");
+  }
+}
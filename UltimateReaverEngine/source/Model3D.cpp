@@ -1,13 +1,141 @@
 #include "Model3D.h"
+#include "JobSystem.h"
+#include "MeshIndexing.h"
+#include "MeshCodec.h"
+#include "TangentSpace.h"
+#include "GltfImporter.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+  /**
+   * FBX uses row vectors (translation in the last row); the animation system
+   * uses column vectors, so the matrix is transposed on the way in.
+   */
+  Matrix3x4
+  ToMatrix3x4(const FbxAMatrix& fbx) {
+    Matrix3x4 out;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        out.m[r][c] = (float)fbx.Get(c, r);
+      }
+    }
+    return out;
+  }
+
+  /**
+   * Identifies the version of a source file (size and last write time) so a
+   * stale mesh cache is ignored. Returns 0 if the file can't be queried.
+   */
+  unsigned long long
+  GetSourceStamp(const std::string& path) {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) {
+      return 0;
+    }
+    const unsigned long long time = (static_cast<unsigned long long>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                                    attributes.ftLastWriteTime.dwLowDateTime;
+    const unsigned long long size = (static_cast<unsigned long long>(attributes.nFileSizeHigh) << 32) |
+                                    attributes.nFileSizeLow;
+    return time ^ (size * 0x9E3779B97F4A7C15ull);
+  }
+
+  static_assert(sizeof(GltfVertex) == sizeof(SimpleVertex) &&
+                offsetof(GltfVertex, position) == offsetof(SimpleVertex, Pos) &&
+                offsetof(GltfVertex, texcoord) == offsetof(SimpleVertex, Tex) &&
+                offsetof(GltfVertex, normal) == offsetof(SimpleVertex, Normal) &&
+                offsetof(GltfVertex, tangent) == offsetof(SimpleVertex, Tangent),
+                "GltfVertex must keep the SimpleVertex layout");
+
+  /**
+   * The glTF importer doesn't know the engine types: its vertices have the
+   * SimpleVertex layout, so a primitive becomes a MeshComponent with one copy.
+   */
+  MeshComponent
+  ToMeshComponent(GltfMesh& gltf) {
+    MeshComponent mesh;
+    mesh.m_name = std::move(gltf.name);
+    mesh.m_vertex.resize(gltf.vertices.size());
+    if (!gltf.vertices.empty()) {
+      memcpy(mesh.m_vertex.data(), gltf.vertices.data(), gltf.vertices.size() * sizeof(SimpleVertex));
+    }
+    mesh.m_index = std::move(gltf.indices);
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  GltfMesh
+  ToGltfMesh(const MeshComponent& mesh) {
+    GltfMesh gltf;
+    gltf.name = mesh.m_name;
+    gltf.vertices.resize(mesh.m_vertex.size());
+    if (!mesh.m_vertex.empty()) {
+      memcpy(gltf.vertices.data(), mesh.m_vertex.data(), mesh.m_vertex.size() * sizeof(SimpleVertex));
+    }
+    gltf.indices = mesh.m_index;
+    return gltf;
+  }
+
+  /**
+   * What the engine lends the glTF importer: the JobSystem for its primitives
+   * and TangentSpace for the ones without tangents.
+   */
+  GltfImportSettings
+  GetGltfSettings() {
+    GltfImportSettings settings;
+    settings.parallelFor = [](size_t count, const std::function<void(size_t, size_t)>& body) {
+      JobSystem::getInstance().parallelFor(count, 1, body);
+    };
+    settings.generateTangents = [](GltfMesh& gltf) {
+      MeshComponent mesh = ToMeshComponent(gltf);
+      TangentSpace::generate(mesh);
+      gltf = ToGltfMesh(mesh);
+    };
+    return settings;
+  }
+
+  FbxAMatrix
+  GetGeometryTransform(FbxNode* node) {
+    FbxAMatrix geo;
+    geo.SetT(node->GetGeometricTranslation(FbxNode::eSourcePivot));
+    geo.SetR(node->GetGeometricRotation(FbxNode::eSourcePivot));
+    geo.SetS(node->GetGeometricScaling(FbxNode::eSourcePivot));
+    return geo;
+  }
+
+  FbxSkin*
+  GetSkin(FbxMesh* mesh) {
+    if (!mesh || mesh->GetDeformerCount(FbxDeformer::eSkin) == 0) {
+      return nullptr;
+    }
+    return static_cast<FbxSkin*>(mesh->GetDeformer(0, FbxDeformer::eSkin));
+  }
+
+  void
+  CollectClusterLinks(FbxNode* node, std::unordered_map<FbxNode*, int>& links) {
+    if (FbxSkin* skin = GetSkin(node->GetMesh())) {
+      for (int c = 0; c < skin->GetClusterCount(); ++c) {
+        if (FbxNode* link = skin->GetCluster(c)->GetLink()) {
+          links[link] = 1;
+        }
+      }
+    }
+    for (int i = 0; i < node->GetChildCount(); ++i) {
+      CollectClusterLinks(node->GetChild(i), links);
+    }
+  }
+}
 
 bool
 Model3D::load(const std::string& path) {
   SetPath(path);
   SetState(ResourceState::Loading);
 
-  init();
-
-  bool success = true; // Cambia esto seg?n el resultado real.
+  const bool success = init();
 
   SetState(success ? ResourceState::Loaded : ResourceState::Failed);
   return success;
@@ -16,8 +144,58 @@ Model3D::load(const std::string& path) {
 bool Model3D::init()
 {
   // Inicializar recursos GPU, buffers, etc.
-  LoadFBXModel(m_filePath);
-  return false;
+  // Los modelos estáticos ya importados se leen de su caché comprimida (.urmesh)
+  const std::string cachePath = m_filePath + ".urmesh";
+  const unsigned long long sourceStamp = GetSourceStamp(m_filePath);
+  const bool cached = sourceStamp != 0 && MeshCodec::loadCache(cachePath, sourceStamp, m_meshes, textureFileNames);
+  if (cached) {
+    MESSAGE("Model3D", "init", "Loaded " << m_meshes.size() << " meshes from " << cachePath.c_str());
+  }
+  else if (m_modelType == ModelType::GLTF) {
+    // glTF: importador nativo (ya trae normales y tangentes o las genera por primitiva)
+    GltfImportStats gltf;
+    std::vector<GltfMesh> primitives;
+    if (GltfImporter::load(m_filePath, primitives, textureFileNames, GetGltfSettings(), &gltf)) {
+      m_meshes.reserve(m_meshes.size() + primitives.size());
+      for (GltfMesh& primitive : primitives) {
+        m_meshes.push_back(ToMeshComponent(primitive));
+      }
+      MESSAGE("Model3D", "init", "Imported " << gltf.primitives << " primitives (" << gltf.triangles
+        << " triangles) from " << m_filePath.c_str());
+    }
+    else {
+      ERROR("Model3D", "init", "glTF import failed: " << gltf.error.c_str());
+    }
+  }
+  else {
+    LoadFBXModel(m_filePath);
+    // Normales que falten y tangentes MikkTSpace (antes de partir: puede duplicar vértices)
+    const TangentSpaceStats tangents = TangentSpace::generate(m_meshes);
+    MESSAGE("Model3D", "init", "Tangent space for " << tangents.triangles << " triangles ("
+      << tangents.generatedNormals << " generated normals, " << tangents.splitVertices << " split vertices)");
+  }
+  if (!cached) {
+    // Mallas de más de 64k vértices: en pedazos con índices de 16 bits si ahorra memoria
+    const MeshSplitStats split = MeshIndexing::splitLargeMeshes(m_meshes);
+    if (split.splitMeshes > 0) {
+      MESSAGE("Model3D", "init", "Split " << split.splitMeshes << " meshes into " << split.chunks
+        << " chunks for 16-bit indices (" << split.duplicatedVertices << " duplicated vertices)");
+    }
+    for (MeshComponent& mesh : m_meshes) {
+      MeshCodec::optimizeVertexFetch(mesh);
+    }
+  }
+  // Las BVH que no vinieron en la caché se construyen aquí y se guardan con las mallas
+  const bool builtBVHs = BuildMeshBVHs();
+  if ((!cached || builtBVHs) && sourceStamp != 0 && !HasSkeleton() && !m_meshes.empty()) {
+    MeshCodec::saveCache(cachePath, sourceStamp, m_meshes, textureFileNames);
+  }
+  // Sin mallas no hay nada que dibujar: la importación (o el archivo) falló
+  if (m_meshes.empty()) {
+    ERROR("Model3D", "init", "No meshes imported from " << m_filePath.c_str());
+    return false;
+  }
+  return true;
 }
 
 void Model3D::unload()
@@ -112,9 +290,13 @@ Model3D::LoadFBXModel(const std::string& filePath) {
 
     if (lRootNode) {
       MESSAGE("ModelLoader", "ModelLoader", "Processing model from the scene root node.");
+      ProcessFBXSkeleton(lRootNode);
       for (int i = 0; i < lRootNode->GetChildCount(); i++) {
         ProcessFBXNode(lRootNode->GetChild(i));
       }
+      if (HasSkeleton()) {
+        ProcessFBXAnimations();
+      }
       return m_meshes;
     }
     else {
@@ -170,6 +352,14 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
   vertices.reserve(mesh->GetPolygonCount() * 3);
   indices.reserve(mesh->GetPolygonCount() * 3);
 
+  // Influencias por control point (vacio si la malla no tiene skin)
+  std::vector<SkinInfluence> cpSkin;
+  ProcessFBXSkin(node, mesh, cpSkin);
+  std::vector<SkinInfluence> skin;
+  if (!cpSkin.empty()) {
+    skin.reserve(mesh->GetPolygonCount() * 3);
+  }
+
   // Helpers de lectura (control point vs. polygon-vertex)
   auto readV2 = [](const FbxGeometryElementUV* elem, int cpIdx, int pvIdx) -> FbxVector2 {
     if (!elem) return FbxVector2(0, 0);
@@ -209,11 +399,12 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
       FbxVector4 P = mesh->GetControlPointAt(cpIndex);
       out.Pos = { (float)P[0], (float)P[1], (float)P[2] };
 
-      // Normal por esquina
-      //FbxVector4 N(0, 1, 0, 0);
-      //mesh->GetPolygonVertexNormal(p, v, N);
-      //N.Normalize();
-      //out.Normal = { (float)N[0], (float)N[1], (float)N[2] };
+      // Normal por esquina (si el archivo no trae, queda en cero y la genera TangentSpace)
+      FbxVector4 N(0, 0, 0, 0);
+      if (mesh->GetPolygonVertexNormal(p, v, N)) {
+        N.Normalize();
+        out.Normal = { (float)N[0], (float)N[1], (float)N[2] };
+      }
 
       // UV (invertir V para DX)
       if (uvElem && uvSetName) {
@@ -241,6 +432,9 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
 
       cornerIdx.push_back((unsigned)vertices.size());
       vertices.push_back(out);
+      if (!cpSkin.empty()) {
+        skin.push_back(cpSkin[cpIndex]);
+      }
     }
 
     // Triangula en ?fan? (CW por defecto)
@@ -345,11 +539,197 @@ Model3D::ProcessFBXMesh(FbxNode* node) {
   mc.m_name = node->GetName();
   mc.m_vertex = std::move(vertices);
   mc.m_index = std::move(indices);
+  mc.m_skin = std::move(skin);
   mc.m_numVertex = (int)mc.m_vertex.size();
   mc.m_numIndex = (int)mc.m_index.size();
   m_meshes.push_back(std::move(mc));
 }
 
+void
+Model3D::ProcessFBXSkeleton(FbxNode* rootNode) {
+  m_skeleton.clear();
+  m_boneNodes.clear();
+  m_boneLookup.clear();
+
+  // Some exporters link clusters to null/mesh nodes, so those count as bones too
+  std::unordered_map<FbxNode*, int> clusterLinks;
+  CollectClusterLinks(rootNode, clusterLinks);
+
+  // Depth-first walk: a parent is always added before its children
+  struct Item { FbxNode* node; int parentBone; };
+  std::vector<Item> stack;
+  for (int i = rootNode->GetChildCount() - 1; i >= 0; --i) {
+    stack.push_back({ rootNode->GetChild(i), -1 });
+  }
+
+  while (!stack.empty()) {
+    Item item = stack.back();
+    stack.pop_back();
+
+    FbxNodeAttribute* attribute = item.node->GetNodeAttribute();
+    bool isBone = (attribute && attribute->GetAttributeType() == FbxNodeAttribute::eSkeleton) ||
+                  clusterLinks.count(item.node) > 0;
+
+    int boneIndex = item.parentBone;
+    if (isBone) {
+      FbxAMatrix global = item.node->EvaluateGlobalTransform();
+      FbxAMatrix local = global;
+      if (item.parentBone >= 0) {
+        local = m_boneNodes[item.parentBone]->EvaluateGlobalTransform().Inverse() * global;
+      }
+
+      Bone bone;
+      bone.name = item.node->GetName();
+      bone.parent = item.parentBone;
+      bone.bindLocal = AnimMath::decompose(ToMatrix3x4(local));
+      // Default bind pose; ProcessFBXSkin overwrites it with the cluster data
+      bone.inverseBindPose = ToMatrix3x4(global.Inverse());
+
+      boneIndex = m_skeleton.addBone(bone);
+      m_boneNodes.push_back(item.node);
+      m_boneLookup[item.node] = boneIndex;
+    }
+
+    for (int i = item.node->GetChildCount() - 1; i >= 0; --i) {
+      stack.push_back({ item.node->GetChild(i), boneIndex });
+    }
+  }
+
+  if (HasSkeleton()) {
+    MESSAGE("Model3D", "ProcessFBXSkeleton", "Skeleton with " << m_skeleton.getBoneCount() << " bones");
+  }
+}
+
+void
+Model3D::ProcessFBXSkin(FbxNode* node, FbxMesh* mesh, std::vector<SkinInfluence>& outInfluences) {
+  outInfluences.clear();
+  FbxSkin* skin = GetSkin(mesh);
+  if (!skin || !HasSkeleton()) {
+    return;
+  }
+
+  struct Weight { int bone; float weight; };
+  std::vector<std::vector<Weight>> weights(mesh->GetControlPointsCount());
+  FbxAMatrix geometry = GetGeometryTransform(node);
+
+  for (int c = 0; c < skin->GetClusterCount(); ++c) {
+    FbxCluster* cluster = skin->GetCluster(c);
+    auto it = m_boneLookup.find(cluster->GetLink());
+    if (it == m_boneLookup.end()) {
+      continue;
+    }
+
+    // Mesh space -> bone space at bind time.
+    // If several meshes bind the same bone, they are expected to share the bind pose.
+    FbxAMatrix meshBind, linkBind;
+    cluster->GetTransformMatrix(meshBind);
+    cluster->GetTransformLinkMatrix(linkBind);
+    m_skeleton.getBone(it->second).inverseBindPose = ToMatrix3x4(linkBind.Inverse() * meshBind * geometry);
+
+    const int* cpIndices = cluster->GetControlPointIndices();
+    const double* cpWeights = cluster->GetControlPointWeights();
+    for (int i = 0; i < cluster->GetControlPointIndicesCount(); ++i) {
+      int cp = cpIndices[i];
+      if (cp >= 0 && cp < (int)weights.size() && cpWeights[i] > 0.0) {
+        weights[cp].push_back({ it->second, (float)cpWeights[i] });
+      }
+    }
+  }
+
+  // Top 4 influences per control point, renormalized
+  outInfluences.resize(weights.size());
+  for (size_t cp = 0; cp < weights.size(); ++cp) {
+    std::vector<Weight>& list = weights[cp];
+    std::sort(list.begin(), list.end(),
+              [](const Weight& a, const Weight& b) { return a.weight > b.weight; });
+
+    SkinInfluence& influence = outInfluences[cp];
+    float total = 0.0f;
+    for (int k = 0; k < 4; ++k) {
+      bool used = k < (int)list.size();
+      influence.BoneIndex[k] = used ? (unsigned short)list[k].bone : 0;
+      influence.Weight[k] = used ? list[k].weight : 0.0f;
+      total += influence.Weight[k];
+    }
+
+    if (total > 0.0f) {
+      for (int k = 0; k < 4; ++k) {
+        influence.Weight[k] /= total;
+      }
+    }
+    else {
+      // Unweighted control points follow the root bone
+      influence.Weight[0] = 1.0f;
+    }
+  }
+}
+
+void
+Model3D::ProcessFBXAnimations(float sampleRate) {
+  m_animations.clear();
+  const unsigned int numBones = m_skeleton.getBoneCount();
+  std::vector<FbxAMatrix> globals(numBones);
+
+  for (int s = 0; s < lScene->GetSrcObjectCount<FbxAnimStack>(); ++s) {
+    FbxAnimStack* stack = lScene->GetSrcObject<FbxAnimStack>(s);
+    lScene->SetCurrentAnimationStack(stack);
+
+    FbxTimeSpan span = stack->GetLocalTimeSpan();
+    if (FbxTakeInfo* take = lScene->GetTakeInfo(stack->GetName())) {
+      span = take->mLocalTimeSpan;
+    }
+    double start = span.GetStart().GetSecondDouble();
+    double duration = span.GetDuration().GetSecondDouble();
+    if (duration <= 0.0) {
+      continue;
+    }
+
+    unsigned int numFrames = (unsigned int)std::ceil(duration * sampleRate) + 1;
+    AnimationClip clip;
+    clip.init(stack->GetName(), numBones, numFrames, sampleRate);
+
+    for (unsigned int f = 0; f < numFrames; ++f) {
+      FbxTime time;
+      time.SetSecondDouble(std::min(start + f / (double)sampleRate, start + duration));
+
+      BoneTransform* pose = clip.getFrame(f);
+      for (unsigned int b = 0; b < numBones; ++b) {
+        globals[b] = m_boneNodes[b]->EvaluateGlobalTransform(time);
+        int parent = m_skeleton.getBones()[b].parent;
+        FbxAMatrix local = parent >= 0 ? globals[parent].Inverse() * globals[b] : globals[b];
+        pose[b] = AnimMath::decompose(ToMatrix3x4(local));
+      }
+    }
+
+    CompressedAnimationClip compressed;
+    if (compressed.compress(clip)) {
+      MESSAGE("Model3D", "ProcessFBXAnimations", "Animation " << stack->GetName() << ": " << numFrames
+              << " frames, " << compressed.getRawSizeInBytes() << " -> " << compressed.getSizeInBytes() << " bytes");
+      m_animations.push_back(std::move(compressed));
+    }
+  }
+}
+
+bool
+Model3D::BuildMeshBVHs() {
+  std::vector<MeshComponent*> missing;
+  for (MeshComponent& mesh : m_meshes) {
+    if (mesh.m_bvh.isNull()) {
+      mesh.m_bvh = EU::MakeShared<TriangleBVH>();
+      missing.push_back(&mesh);
+    }
+  }
+  if (missing.empty()) {
+    return false;
+  }
+  JobSystem::getInstance().parallelFor(missing.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      missing[i]->m_bvh->build(missing[i]->m_vertex, missing[i]->m_index);
+    }
+  });
+  return true;
+}
+
 void Model3D::ProcessFBXMaterials(FbxSurfaceMaterial* material)
 {
   if (material) {
@@ -364,4 +744,134 @@ void Model3D::ProcessFBXMaterials(FbxSurfaceMaterial* material)
       }
     }
   }
-}
\ No newline at end of file
+}
+ModelType
+Model3D::GetModelTypeFromPath(const std::string& path) {
+  const size_t dot = path.find_last_of('.');
+  std::string extension = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+  return (extension == "gltf" || extension == "glb") ? ModelType::GLTF : ModelType::FBX;
+}
+
+namespace {
+  /**
+   * Benchmark terrain: a noisy grid with its tangent space, like an imported static mesh.
+   */
+  MeshComponent
+  MakeBenchmarkTerrain(unsigned int side, float seed) {
+    MeshComponent mesh;
+    mesh.m_name = "terrain" + std::to_string(static_cast<int>(seed * 100.0f));
+    for (unsigned int z = 0; z < side; ++z) {
+      for (unsigned int x = 0; x < side; ++x) {
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3((float)x, std::sin(x * 0.21f + seed) * 2.0f + std::cos(z * 0.17f - seed) * 1.5f, (float)z);
+        v.Tex = XMFLOAT2(x / (float)(side - 1), z / (float)(side - 1));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    for (unsigned int z = 0; z + 1 < side; ++z) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = z * side + x;
+        const unsigned int quad[6] = { i, i + 1, i + side, i + 1, i + side + 1, i + side };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = (int)mesh.m_vertex.size();
+    mesh.m_numIndex = (int)mesh.m_index.size();
+    TangentSpace::generate(mesh);
+    return mesh;
+  }
+
+  /**
+   * Writes the meshes as a binary FBX in the file's winding and UV convention, so the
+   * importer's winding flip and V flip give back the engine meshes.
+   */
+  bool
+  ExportBenchmarkFBX(const std::string& path, const std::vector<MeshComponent>& meshes) {
+    FbxManager* manager = FbxManager::Create();
+    if (!manager) {
+      return false;
+    }
+    manager->SetIOSettings(FbxIOSettings::Create(manager, IOSROOT));
+    FbxScene* scene = FbxScene::Create(manager, "benchmark");
+    for (const MeshComponent& mesh : meshes) {
+      FbxMesh* fbxMesh = FbxMesh::Create(scene, mesh.m_name.c_str());
+      fbxMesh->InitControlPoints((int)mesh.m_vertex.size());
+      FbxVector4* points = fbxMesh->GetControlPoints();
+      FbxGeometryElementNormal* normals = fbxMesh->CreateElementNormal();
+      normals->SetMappingMode(FbxGeometryElement::eByControlPoint);
+      normals->SetReferenceMode(FbxGeometryElement::eDirect);
+      FbxGeometryElementUV* uvs = fbxMesh->CreateElementUV("UVSet");
+      uvs->SetMappingMode(FbxGeometryElement::eByControlPoint);
+      uvs->SetReferenceMode(FbxGeometryElement::eDirect);
+      for (size_t v = 0; v < mesh.m_vertex.size(); ++v) {
+        const SimpleVertex& vertex = mesh.m_vertex[v];
+        points[v] = FbxVector4(vertex.Pos.x, vertex.Pos.y, vertex.Pos.z);
+        normals->GetDirectArray().Add(FbxVector4(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, 0.0));
+        uvs->GetDirectArray().Add(FbxVector2(vertex.Tex.x, 1.0 - vertex.Tex.y));
+      }
+      for (size_t i = 0; i + 2 < mesh.m_index.size(); i += 3) {
+        fbxMesh->BeginPolygon();
+        fbxMesh->AddPolygon((int)mesh.m_index[i]);
+        fbxMesh->AddPolygon((int)mesh.m_index[i + 2]);
+        fbxMesh->AddPolygon((int)mesh.m_index[i + 1]);
+        fbxMesh->EndPolygon();
+      }
+      FbxNode* node = FbxNode::Create(scene, mesh.m_name.c_str());
+      node->SetNodeAttribute(fbxMesh);
+      scene->GetRootNode()->AddChild(node);
+    }
+    FbxExporter* exporter = FbxExporter::Create(manager, "");
+    const bool exported = exporter->Initialize(path.c_str(), -1, manager->GetIOSettings()) && exporter->Export(scene);
+    exporter->Destroy();
+    manager->Destroy();
+    return exported;
+  }
+
+  size_t
+  CountTriangles(const std::vector<MeshComponent>& meshes) {
+    size_t triangles = 0;
+    for (const MeshComponent& mesh : meshes) {
+      triangles += mesh.m_index.size() / 3;
+    }
+    return triangles;
+  }
+}
+
+void
+Model3D::runImportBenchmark(BenchmarkReport& report) {
+  std::vector<MeshComponent> meshes;
+  for (unsigned int i = 0; i < 16; ++i) {
+    meshes.push_back(MakeBenchmarkTerrain(160, i * 0.37f));
+  }
+  const std::string glbPath = "benchmark_import.glb";
+  const std::string fbxPath = "benchmark_import.fbx";
+  std::vector<GltfMesh> gltfMeshes;
+  for (const MeshComponent& mesh : meshes) {
+    gltfMeshes.push_back(ToGltfMesh(mesh));
+  }
+  if (!GltfImporter::writeGlb(glbPath, gltfMeshes) || !ExportBenchmarkFBX(fbxPath, meshes)) {
+    report.fail("can't write the benchmark assets");
+    return;
+  }
+  // Sin cachés: los dos caminos importan desde el archivo fuente
+  const std::string paths[2] = { fbxPath, glbPath };
+  double ms[2] = { 0.0, 0.0 };
+  size_t triangles[2] = { 0, 0 };
+  for (unsigned int i = 0; i < 2; ++i) {
+    std::remove((paths[i] + ".urmesh").c_str());
+    Timer timer;
+    Model3D model(paths[i], GetModelTypeFromPath(paths[i]));
+    ms[i] = timer.elapsedMs();
+    triangles[i] = CountTriangles(model.GetMeshes());
+    model.unload();
+    std::remove((paths[i] + ".urmesh").c_str());
+    std::remove(paths[i].c_str());
+  }
+  if (triangles[0] != CountTriangles(meshes) || triangles[1] != CountTriangles(meshes)) {
+    report.fail("FBX and glTF imports don't have the same triangles");
+  }
+  report.log("%zu meshes, %zu tris through Model3D: FBX %.1f ms, glTF %.1f ms (%.1fx faster)",
+             meshes.size(), CountTriangles(meshes), ms[0], ms[1], ms[0] / ms[1]);
+}
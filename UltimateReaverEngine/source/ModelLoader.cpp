@@ -1,4 +1,5 @@
 #include "ModelLoader.h"
+#include "TangentSpace.h"
 #include <fstream>
 #include <sstream>
 #include <map>
@@ -115,7 +116,7 @@ ModelLoader::loadModel(const std::string& fileName, MeshComponent& outMesh) {
           SimpleVertex v{};
           v.Pos = P;
           v.Tex = T;
-          // si agregas normales a tu Vertex/Shader, aqu asignas v.Norm
+          if (nrmIdx >= 0 && nrmIdx < (int)tempNrm.size()) v.Normal = tempNrm[nrmIdx];
 
           outMesh.m_vertex.push_back(v);
           finalIndex = (int)outMesh.m_vertex.size() - 1;
@@ -155,6 +156,9 @@ ModelLoader::loadModel(const std::string& fileName, MeshComponent& outMesh) {
     return false;
   }
 
+  // normales (si el OBJ no trae) y tangentes MikkTSpace
+  TangentSpace::generate(outMesh);
+
   return true;
 }
 
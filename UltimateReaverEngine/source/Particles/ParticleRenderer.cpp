@@ -0,0 +1,159 @@
+#include "Particles/ParticleRenderer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "RenderStateCache.h"
+
+namespace {
+
+  const unsigned int kParticlesCBSlot = 6;
+
+} // namespace
+
+HRESULT
+ParticleRenderer::init(Device& device, unsigned int maxInstances) {
+  if (!device.m_device) {
+    ERROR("ParticleRenderer", "init", "Device is nullptr");
+    return E_POINTER;
+  }
+  if (maxInstances == 0) {
+    ERROR("ParticleRenderer", "init", "maxInstances must be greater than zero");
+    return E_INVALIDARG;
+  }
+  m_maxInstances = maxInstances;
+
+  D3D11_BUFFER_DESC desc = {};
+  desc.Usage = D3D11_USAGE_DYNAMIC;
+  desc.ByteWidth = maxInstances * sizeof(ParticleInstance);
+  desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+  HRESULT hr = device.CreateBuffer(&desc, nullptr, &m_instanceBuffer);
+  if (FAILED(hr)) {
+    ERROR("ParticleRenderer", "init", "Failed to create instance buffer");
+    return hr;
+  }
+
+  // Todo por instancia; el quad sale de SV_VertexID
+  std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+  D3D11_INPUT_ELEMENT_DESC position = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,
+                                        D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+  D3D11_INPUT_ELEMENT_DESC size = { "PSIZE", 0, DXGI_FORMAT_R32_FLOAT, 0, 12,
+                                    D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+  D3D11_INPUT_ELEMENT_DESC color = { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 16,
+                                     D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+  layout.push_back(position);
+  layout.push_back(size);
+  layout.push_back(color);
+  hr = m_shader.init(device, "Particles.fx", layout);
+  if (FAILED(hr)) {
+    ERROR("ParticleRenderer", "init", "Failed to initialize Particles.fx");
+    return hr;
+  }
+
+  D3D11_BLEND_DESC blendDesc = {};
+  blendDesc.RenderTarget[0].BlendEnable = TRUE;
+  blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+  blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+  blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+  blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+  blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+  blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+  blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+  // Estados compartidos por descriptor en la caché
+  RenderStateCache& states = RenderStateCache::getInstance();
+  m_blendState = states.acquireBlend(blendDesc);
+  if (!m_blendState) {
+    ERROR("ParticleRenderer", "init", "Failed to create blend state");
+    return E_FAIL;
+  }
+
+  D3D11_DEPTH_STENCIL_DESC depthDesc = {};
+  depthDesc.DepthEnable = TRUE;
+  depthDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+  depthDesc.DepthFunc = D3D11_COMPARISON_LESS;
+  m_depthState = states.acquireDepthStencil(depthDesc);
+  if (!m_depthState) {
+    ERROR("ParticleRenderer", "init", "Failed to create depth stencil state");
+    return E_FAIL;
+  }
+
+  D3D11_RASTERIZER_DESC rasterDesc = {};
+  rasterDesc.FillMode = D3D11_FILL_SOLID;
+  rasterDesc.CullMode = D3D11_CULL_NONE;
+  rasterDesc.DepthClipEnable = TRUE;
+  m_rasterizer = states.acquireRasterizer(rasterDesc);
+  if (!m_rasterizer) {
+    ERROR("ParticleRenderer", "init", "Failed to create rasterizer state");
+    return E_FAIL;
+  }
+
+  hr = m_cbParticles.init(device, sizeof(CBParticles));
+  if (FAILED(hr)) {
+    ERROR("ParticleRenderer", "init", "Failed to create CBParticles");
+    return hr;
+  }
+  return S_OK;
+}
+
+void
+ParticleRenderer::render(DeviceContext& deviceContext,
+                         const ParticleSystem& particles,
+                         const XMMATRIX& view,
+                         const XMMATRIX& projection) {
+  m_drawnCount = 0;
+  if (!m_instanceBuffer || !deviceContext.m_deviceContext) {
+    return;
+  }
+
+  D3D11_MAPPED_SUBRESOURCE mapped = {};
+  HRESULT hr = deviceContext.m_deviceContext->Map(m_instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+  if (FAILED(hr)) {
+    ERROR("ParticleRenderer", "render", "Map failed");
+    return;
+  }
+  m_drawnCount = particles.writeInstances(static_cast<ParticleInstance*>(mapped.pData), m_maxInstances);
+  deviceContext.m_deviceContext->Unmap(m_instanceBuffer, 0);
+  if (m_drawnCount == 0) {
+    return;
+  }
+
+  // Ejes de la cámara en mundo: filas 0 y 1 de la inversa de la vista
+  XMFLOAT4X4 inverseView;
+  XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+  m_params.mViewProjection = XMMatrixTranspose(XMMatrixMultiply(view, projection));
+  m_params.vCameraRight = XMFLOAT4(inverseView._11, inverseView._12, inverseView._13, 0.0f);
+  m_params.vCameraUp = XMFLOAT4(inverseView._21, inverseView._22, inverseView._23, 0.0f);
+  m_cbParticles.update(deviceContext, nullptr, 0, nullptr, &m_params, 0, 0);
+
+  unsigned int stride = sizeof(ParticleInstance);
+  unsigned int offset = 0;
+  deviceContext.IASetVertexBuffers(0, 1, &m_instanceBuffer, &stride, &offset);
+  deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+  m_shader.render(deviceContext);
+  m_cbParticles.render(deviceContext, kParticlesCBSlot, 1, true);
+
+  float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  deviceContext.OMSetBlendState(m_blendState, blendFactor, 0xFFFFFFFF);
+  deviceContext.m_deviceContext->OMSetDepthStencilState(m_depthState, 0);
+  deviceContext.RSSetState(m_rasterizer);
+
+  deviceContext.m_deviceContext->DrawInstanced(4, m_drawnCount, 0, 0);
+
+  deviceContext.OMSetBlendState(nullptr, blendFactor, 0xFFFFFFFF);
+  deviceContext.m_deviceContext->OMSetDepthStencilState(nullptr, 0);
+  deviceContext.RSSetState(nullptr);
+}
+
+void
+ParticleRenderer::destroy() {
+  SAFE_RELEASE(m_instanceBuffer);
+  RenderStateCache& states = RenderStateCache::getInstance();
+  states.release(m_blendState);
+  states.release(m_depthState);
+  states.release(m_rasterizer);
+  m_blendState = nullptr;
+  m_depthState = nullptr;
+  m_rasterizer = nullptr;
+  m_shader.destroy();
+  m_cbParticles.destroy();
+  m_drawnCount = 0;
+}
@@ -0,0 +1,705 @@
+#include "Particles/ParticleSystem.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include "Simulation/SimulationReplay.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+  /// @brief Bits por pasada del radix sort (2 pasadas cubren la llave de 16 bits).
+  const unsigned int kRadixBits = 8;
+  const unsigned int kRadixBuckets = 1u << kRadixBits;
+
+  /// @brief Partículas por pedazo en el orden (histograma y scatter por pedazo).
+  const size_t kSortChunk = 16384;
+
+  inline float
+    nextRandom(unsigned int& state) {
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) / 16777216.0f;
+  }
+
+  inline __m128i
+    toBytes(__m128 v) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+  }
+
+  inline __m128
+    blend(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+
+} // namespace
+
+unsigned int
+ParticleSystem::addEmitter(const ParticleEmitterSettings& settings) {
+  Emitter emitter;
+  emitter.settings = settings;
+  unsigned int numBlocks = std::max((settings.maxParticles + kParticleBlockSize - 1) / kParticleBlockSize, 1u);
+  size_t capacity = static_cast<size_t>(numBlocks) * kParticleBlockSize;
+  emitter.positionX.assign(capacity, 0.0f);
+  emitter.positionY.assign(capacity, 0.0f);
+  emitter.positionZ.assign(capacity, 0.0f);
+  emitter.velocityX.assign(capacity, 0.0f);
+  emitter.velocityY.assign(capacity, 0.0f);
+  emitter.velocityZ.assign(capacity, 0.0f);
+  emitter.age.assign(capacity, 0.0f);
+  emitter.lifetime.assign(capacity, 0.0f);
+  emitter.blockCount.assign(numBlocks, 0);
+  emitter.random = 0x9E3779B9u * static_cast<unsigned int>(m_emitters.size() + 1);
+  m_emitters.push_back(emitter);
+  return static_cast<unsigned int>(m_emitters.size() - 1);
+}
+
+void
+ParticleSystem::addCollisionPlane(const XMFLOAT4& plane, float restitution) {
+  if (m_numPlanes >= kMaxParticlePlanes) {
+    ERROR("ParticleSystem", "addCollisionPlane", "Too many collision planes");
+    return;
+  }
+  float len = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+  float inv = len > 0.0f ? 1.0f / len : 0.0f;
+  m_planes[m_numPlanes] = XMFLOAT4(plane.x * inv, plane.y * inv, plane.z * inv, plane.w * inv);
+  m_restitution[m_numPlanes] = restitution;
+  ++m_numPlanes;
+}
+
+unsigned int
+ParticleSystem::spawn(Emitter& emitter, unsigned int count) {
+  const ParticleEmitterSettings& s = emitter.settings;
+
+  // Base ortonormal alrededor de la dirección del cono
+  float d[3] = { s.direction.x, s.direction.y, s.direction.z };
+  float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+  if (len < 1e-6f) {
+    d[0] = 0.0f; d[1] = 1.0f; d[2] = 0.0f;
+  }
+  else {
+    d[0] /= len; d[1] /= len; d[2] /= len;
+  }
+  float helper[3] = { std::fabs(d[1]) < 0.9f ? 0.0f : 1.0f, std::fabs(d[1]) < 0.9f ? 1.0f : 0.0f, 0.0f };
+  float u[3] = { helper[1] * d[2] - helper[2] * d[1], helper[2] * d[0] - helper[0] * d[2], helper[0] * d[1] - helper[1] * d[0] };
+  float ul = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  u[0] /= ul; u[1] /= ul; u[2] /= ul;
+  float v[3] = { d[1] * u[2] - d[2] * u[1], d[2] * u[0] - d[0] * u[2], d[0] * u[1] - d[1] * u[0] };
+
+  unsigned int spawned = 0;
+  for (unsigned int b = 0; b < emitter.blockCount.size() && spawned < count; ++b) {
+    unsigned int& blockCount = emitter.blockCount[b];
+    while (blockCount < kParticleBlockSize && spawned < count) {
+      size_t i = static_cast<size_t>(b) * kParticleBlockSize + blockCount;
+      float theta = s.spread * std::sqrt(nextRandom(emitter.random));
+      float phi = 2.0f * XM_PI * nextRandom(emitter.random);
+      float speed = s.speedMin + (s.speedMax - s.speedMin) * nextRandom(emitter.random);
+      float ct = std::cos(theta), st = std::sin(theta);
+      float cp = std::cos(phi), sp = std::sin(phi);
+      emitter.positionX[i] = s.position.x;
+      emitter.positionY[i] = s.position.y;
+      emitter.positionZ[i] = s.position.z;
+      emitter.velocityX[i] = (d[0] * ct + (u[0] * cp + v[0] * sp) * st) * speed;
+      emitter.velocityY[i] = (d[1] * ct + (u[1] * cp + v[1] * sp) * st) * speed;
+      emitter.velocityZ[i] = (d[2] * ct + (u[2] * cp + v[2] * sp) * st) * speed;
+      emitter.age[i] = 0.0f;
+      emitter.lifetime[i] = s.lifetimeMin + (s.lifetimeMax - s.lifetimeMin) * nextRandom(emitter.random);
+      ++blockCount;
+      ++spawned;
+    }
+  }
+  return spawned;
+}
+
+void
+ParticleSystem::burst(unsigned int emitter, unsigned int count) {
+  if (emitter >= m_emitters.size()) {
+    ERROR("ParticleSystem", "burst", "Invalid emitter " << emitter);
+    return;
+  }
+  m_stats.spawned += spawn(m_emitters[emitter], count);
+}
+
+unsigned int
+ParticleSystem::simulateBlock(Emitter& emitter, unsigned int block, float deltaTime) {
+  const size_t base = static_cast<size_t>(block) * kParticleBlockSize;
+  const unsigned int count = emitter.blockCount[block];
+  float* px = &emitter.positionX[base];
+  float* py = &emitter.positionY[base];
+  float* pz = &emitter.positionZ[base];
+  float* vx = &emitter.velocityX[base];
+  float* vy = &emitter.velocityY[base];
+  float* vz = &emitter.velocityZ[base];
+  float* age = &emitter.age[base];
+  float* lifetime = &emitter.lifetime[base];
+
+  const __m128 dt = _mm_set1_ps(deltaTime);
+  const __m128 damp = _mm_set1_ps(std::max(1.0f - m_drag * deltaTime, 0.0f));
+  const __m128 gx = _mm_set1_ps(m_gravity.x * deltaTime);
+  const __m128 gy = _mm_set1_ps(m_gravity.y * deltaTime);
+  const __m128 gz = _mm_set1_ps(m_gravity.z * deltaTime);
+  const __m128 zero = _mm_setzero_ps();
+
+  // El bloque mide múltiplo de 4, así que el último grupo nunca se sale
+  for (unsigned int i = 0; i < count; i += 4) {
+    __m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+    __m128 u = _mm_loadu_ps(vx + i), v = _mm_loadu_ps(vy + i), w = _mm_loadu_ps(vz + i);
+
+    u = _mm_add_ps(_mm_mul_ps(u, damp), gx);
+    v = _mm_add_ps(_mm_mul_ps(v, damp), gy);
+    w = _mm_add_ps(_mm_mul_ps(w, damp), gz);
+    x = _mm_add_ps(x, _mm_mul_ps(u, dt));
+    y = _mm_add_ps(y, _mm_mul_ps(v, dt));
+    z = _mm_add_ps(z, _mm_mul_ps(w, dt));
+
+    for (unsigned int p = 0; p < m_numPlanes; ++p) {
+      const __m128 nx = _mm_set1_ps(m_planes[p].x);
+      const __m128 ny = _mm_set1_ps(m_planes[p].y);
+      const __m128 nz = _mm_set1_ps(m_planes[p].z);
+      const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)),
+                                                    _mm_mul_ps(nz, z)),
+                                         _mm_set1_ps(m_planes[p].w));
+      const __m128 inside = _mm_cmplt_ps(distance, zero);
+      if (_mm_movemask_ps(inside) == 0) {
+        continue;
+      }
+      // Empujo al plano y reflejo la componente normal si va hacia adentro
+      x = blend(inside, _mm_sub_ps(x, _mm_mul_ps(nx, distance)), x);
+      y = blend(inside, _mm_sub_ps(y, _mm_mul_ps(ny, distance)), y);
+      z = blend(inside, _mm_sub_ps(z, _mm_mul_ps(nz, distance)), z);
+      const __m128 normalSpeed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, u), _mm_mul_ps(ny, v)), _mm_mul_ps(nz, w));
+      const __m128 bounce = _mm_and_ps(inside, _mm_cmplt_ps(normalSpeed, zero));
+      const __m128 k = _mm_mul_ps(_mm_set1_ps(1.0f + m_restitution[p]), normalSpeed);
+      u = blend(bounce, _mm_sub_ps(u, _mm_mul_ps(k, nx)), u);
+      v = blend(bounce, _mm_sub_ps(v, _mm_mul_ps(k, ny)), v);
+      w = blend(bounce, _mm_sub_ps(w, _mm_mul_ps(k, nz)), w);
+    }
+
+    _mm_storeu_ps(px + i, x);
+    _mm_storeu_ps(py + i, y);
+    _mm_storeu_ps(pz + i, z);
+    _mm_storeu_ps(vx + i, u);
+    _mm_storeu_ps(vy + i, v);
+    _mm_storeu_ps(vz + i, w);
+    _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt));
+  }
+
+  // Compactado estable dentro del bloque; los grupos de 4 vivos sin hueco previo no se tocan
+  unsigned int write = 0;
+  for (unsigned int i = 0; i < count; i += 4) {
+    int alive = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(lifetime + i)));
+    if (i + 4 > count) {
+      alive &= (1 << (count - i)) - 1;
+    }
+    if (alive == 0xF && write == i) {
+      write += 4;
+      continue;
+    }
+    for (unsigned int lane = 0; lane < 4; ++lane) {
+      if (!(alive & (1 << lane))) {
+        continue;
+      }
+      const unsigned int src = i + lane;
+      if (write != src) {
+        px[write] = px[src];
+        py[write] = py[src];
+        pz[write] = pz[src];
+        vx[write] = vx[src];
+        vy[write] = vy[src];
+        vz[write] = vz[src];
+        age[write] = age[src];
+        lifetime[write] = lifetime[src];
+      }
+      ++write;
+    }
+  }
+  emitter.blockCount[block] = write;
+  return count - write;
+}
+
+unsigned int
+ParticleSystem::simulateBlockReference(Emitter& emitter, unsigned int block, float deltaTime) {
+  const size_t base = static_cast<size_t>(block) * kParticleBlockSize;
+  const unsigned int count = emitter.blockCount[block];
+  const float damp = std::max(1.0f - m_drag * deltaTime, 0.0f);
+  const float gx = m_gravity.x * deltaTime;
+  const float gy = m_gravity.y * deltaTime;
+  const float gz = m_gravity.z * deltaTime;
+
+  unsigned int write = 0;
+  for (unsigned int i = 0; i < count; ++i) {
+    const size_t s = base + i;
+    float x = emitter.positionX[s], y = emitter.positionY[s], z = emitter.positionZ[s];
+    float u = emitter.velocityX[s], v = emitter.velocityY[s], w = emitter.velocityZ[s];
+    u = u * damp + gx;
+    v = v * damp + gy;
+    w = w * damp + gz;
+    x = x + u * deltaTime;
+    y = y + v * deltaTime;
+    z = z + w * deltaTime;
+    for (unsigned int p = 0; p < m_numPlanes; ++p) {
+      const XMFLOAT4& n = m_planes[p];
+      float distance = n.x * x + n.y * y + n.z * z + n.w;
+      if (distance < 0.0f) {
+        x = x - n.x * distance;
+        y = y - n.y * distance;
+        z = z - n.z * distance;
+        float normalSpeed = n.x * u + n.y * v + n.z * w;
+        if (normalSpeed < 0.0f) {
+          float k = (1.0f + m_restitution[p]) * normalSpeed;
+          u = u - k * n.x;
+          v = v - k * n.y;
+          w = w - k * n.z;
+        }
+      }
+    }
+    float age = emitter.age[s] + deltaTime;
+    if (!(age < emitter.lifetime[s])) {
+      continue;
+    }
+    const size_t d = base + write;
+    emitter.positionX[d] = x;
+    emitter.positionY[d] = y;
+    emitter.positionZ[d] = z;
+    emitter.velocityX[d] = u;
+    emitter.velocityY[d] = v;
+    emitter.velocityZ[d] = w;
+    emitter.age[d] = age;
+    emitter.lifetime[d] = emitter.lifetime[s];
+    ++write;
+  }
+  emitter.blockCount[block] = write;
+  return count - write;
+}
+
+void
+ParticleSystem::buildBlockJobs() {
+  m_jobs.clear();
+  m_jobOffset.clear();
+  unsigned int offset = 0;
+  for (unsigned int e = 0; e < m_emitters.size(); ++e) {
+    const Emitter& emitter = m_emitters[e];
+    for (unsigned int b = 0; b < emitter.blockCount.size(); ++b) {
+      if (emitter.blockCount[b] == 0) {
+        continue;
+      }
+      BlockJob job = { e, b };
+      m_jobs.push_back(job);
+      m_jobOffset.push_back(offset);
+      offset += emitter.blockCount[b];
+    }
+  }
+  m_jobOffset.push_back(offset);
+}
+
+void
+ParticleSystem::radixSort() {
+  const size_t count = m_sortKeys.size();
+  const size_t numChunks = (count + kSortChunk - 1) / kSortChunk;
+  m_sortKeysScratch.resize(count);
+  m_sortOrderScratch.resize(count);
+  std::vector<unsigned int> histograms(numChunks * kRadixBuckets);
+
+  for (unsigned int shift = 0; shift < 16; shift += kRadixBits) {
+    const uint16_t* keys = m_sortKeys.data();
+    std::fill(histograms.begin(), histograms.end(), 0u);
+    JobSystem::getInstance().parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+      for (size_t c = begin; c < end; ++c) {
+        unsigned int* histogram = &histograms[c * kRadixBuckets];
+        const size_t last = std::min(count, (c + 1) * kSortChunk);
+        for (size_t i = c * kSortChunk; i < last; ++i) {
+          ++histogram[(keys[i] >> shift) & (kRadixBuckets - 1)];
+        }
+      }
+    });
+
+    // Si todos caen en el mismo dígito la pasada no mueve nada
+    bool trivial = false;
+    for (unsigned int digit = 0; digit < kRadixBuckets && !trivial; ++digit) {
+      size_t total = 0;
+      for (size_t c = 0; c < numChunks; ++c) {
+        total += histograms[c * kRadixBuckets + digit];
+      }
+      trivial = total == count;
+    }
+    if (trivial) {
+      continue;
+    }
+
+    // Offset de cada (dígito, pedazo): primero por dígito y dentro por pedazo, así es estable
+    unsigned int running = 0;
+    for (unsigned int digit = 0; digit < kRadixBuckets; ++digit) {
+      for (size_t c = 0; c < numChunks; ++c) {
+        unsigned int n = histograms[c * kRadixBuckets + digit];
+        histograms[c * kRadixBuckets + digit] = running;
+        running += n;
+      }
+    }
+
+    const unsigned int* order = m_sortOrder.data();
+    uint16_t* outKeys = m_sortKeysScratch.data();
+    unsigned int* outOrder = m_sortOrderScratch.data();
+    JobSystem::getInstance().parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+      for (size_t c = begin; c < end; ++c) {
+        unsigned int* offsets = &histograms[c * kRadixBuckets];
+        const size_t last = std::min(count, (c + 1) * kSortChunk);
+        for (size_t i = c * kSortChunk; i < last; ++i) {
+          unsigned int dst = offsets[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+          outKeys[dst] = keys[i];
+          outOrder[dst] = order[i];
+        }
+      }
+    });
+    m_sortKeys.swap(m_sortKeysScratch);
+    m_sortOrder.swap(m_sortOrderScratch);
+    ++m_stats.radixPasses;
+  }
+}
+
+void
+ParticleSystem::sortByDepth(const XMFLOAT3& eye, const XMFLOAT3& forward) {
+  m_sorted = false;
+  bool needed = false;
+  for (const Emitter& emitter : m_emitters) {
+    if (!emitter.settings.additive) {
+      for (unsigned int count : emitter.blockCount) {
+        needed = needed || count > 0;
+      }
+    }
+  }
+  const unsigned int total = m_jobOffset.back();
+  if (!needed || total < 2) {
+    m_sortInstances.clear();
+    m_sortOrder.clear();
+    return;
+  }
+
+  Timer timer;
+  // Instancias en orden de bloques: el orden final solo mueve estructuras de 20 bytes
+  m_sortInstances.resize(total);
+  std::vector<float> jobMin(m_jobs.size());
+  std::vector<float> jobMax(m_jobs.size());
+  JobSystem::getInstance().parallelFor(m_jobs.size(), 4, [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      const Emitter& emitter = m_emitters[m_jobs[j].emitter];
+      const unsigned int count = emitter.blockCount[m_jobs[j].block];
+      ParticleInstance* instances = &m_sortInstances[m_jobOffset[j]];
+      writeBlock(emitter, m_jobs[j].block, count, instances);
+      float lo = FLT_MAX, hi = -FLT_MAX;
+      for (unsigned int i = 0; i < count; ++i) {
+        const XMFLOAT3& p = instances[i].position;
+        float depth = (p.x - eye.x) * forward.x + (p.y - eye.y) * forward.y + (p.z - eye.z) * forward.z;
+        lo = std::min(lo, depth);
+        hi = std::max(hi, depth);
+      }
+      jobMin[j] = lo;
+      jobMax[j] = hi;
+    }
+  });
+  float minDepth = *std::min_element(jobMin.begin(), jobMin.end());
+  m_sortMaxDepth = *std::max_element(jobMax.begin(), jobMax.end());
+  m_sortScale = m_sortMaxDepth > minDepth ? 65535.0f / (m_sortMaxDepth - minDepth) : 0.0f;
+
+  // Llave de 16 bits: 0 = la más lejana, así que orden ascendente = de atrás hacia adelante
+  m_sortKeys.resize(total);
+  m_sortOrder.resize(total);
+  JobSystem::getInstance().parallelFor(total, 16384, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const XMFLOAT3& p = m_sortInstances[i].position;
+      float depth = (p.x - eye.x) * forward.x + (p.y - eye.y) * forward.y + (p.z - eye.z) * forward.z;
+      m_sortKeys[i] = static_cast<uint16_t>(std::min((m_sortMaxDepth - depth) * m_sortScale, 65535.0f));
+      m_sortOrder[i] = static_cast<unsigned int>(i);
+    }
+  });
+
+  bool alreadySorted = true;
+  for (unsigned int i = 1; i < total && alreadySorted; ++i) {
+    alreadySorted = m_sortKeys[i - 1] <= m_sortKeys[i];
+  }
+  if (!alreadySorted) {
+    radixSort();
+  }
+  m_sorted = true;
+  m_stats.sorted = total;
+  m_stats.sortMs = timer.elapsedMs();
+}
+
+void
+ParticleSystem::update(float deltaTime, const XMFLOAT3& eye, const XMFLOAT3& forward) {
+  simulate(deltaTime);
+  sortByDepth(eye, forward);
+}
+
+void
+ParticleSystem::simulate(float deltaTime) {
+  m_stats = ParticleStats();
+
+  Timer timer;
+  for (Emitter& emitter : m_emitters) {
+    emitter.spawnAccumulator += emitter.settings.spawnRate * deltaTime;
+    unsigned int wanted = static_cast<unsigned int>(emitter.spawnAccumulator);
+    emitter.spawnAccumulator -= static_cast<float>(wanted);
+    m_stats.spawned += spawn(emitter, wanted);
+  }
+  m_stats.spawnMs = timer.elapsedMs();
+
+  timer.reset();
+  buildBlockJobs();
+  std::vector<unsigned int> died(m_jobs.size());
+  JobSystem::getInstance().parallelFor(m_jobs.size(), 2, [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      died[j] = simulateBlock(m_emitters[m_jobs[j].emitter], m_jobs[j].block, deltaTime);
+    }
+  });
+  for (unsigned int d : died) {
+    m_stats.died += d;
+  }
+  // Los offsets de salida cambian con las muertes
+  buildBlockJobs();
+  m_stats.simulateMs = timer.elapsedMs();
+  m_stats.alive = m_jobOffset.back();
+}
+
+void
+ParticleSystem::hashState(StateHasher& hasher) const {
+  for (const Emitter& emitter : m_emitters) {
+    hasher.add(emitter.spawnAccumulator);
+    hasher.add(emitter.random);
+    const unsigned int numBlocks = static_cast<unsigned int>(emitter.blockCount.size());
+    for (unsigned int b = 0; b < numBlocks; ++b) {
+      const unsigned int count = emitter.blockCount[b];
+      const size_t first = static_cast<size_t>(b) * kParticleBlockSize;
+      hasher.add(count);
+      if (count == 0) {
+        continue;
+      }
+      const size_t bytes = count * sizeof(float);
+      hasher.add(&emitter.positionX[first], bytes);
+      hasher.add(&emitter.positionY[first], bytes);
+      hasher.add(&emitter.positionZ[first], bytes);
+      hasher.add(&emitter.velocityX[first], bytes);
+      hasher.add(&emitter.velocityY[first], bytes);
+      hasher.add(&emitter.velocityZ[first], bytes);
+      hasher.add(&emitter.age[first], bytes);
+      hasher.add(&emitter.lifetime[first], bytes);
+    }
+  }
+}
+
+void
+ParticleSystem::writeBlock(const Emitter& emitter,
+                           unsigned int block,
+                           unsigned int count,
+                           ParticleInstance* output) {
+  const ParticleEmitterSettings& s = emitter.settings;
+  const size_t base = static_cast<size_t>(block) * kParticleBlockSize;
+  const __m128 startSize = _mm_set1_ps(s.startSize);
+  const __m128 deltaSize = _mm_set1_ps(s.endSize - s.startSize);
+  const __m128 startR = _mm_set1_ps(s.startColor.x), deltaR = _mm_set1_ps(s.endColor.x - s.startColor.x);
+  const __m128 startG = _mm_set1_ps(s.startColor.y), deltaG = _mm_set1_ps(s.endColor.y - s.startColor.y);
+  const __m128 startB = _mm_set1_ps(s.startColor.z), deltaB = _mm_set1_ps(s.endColor.z - s.startColor.z);
+  const __m128 startA = _mm_set1_ps(s.startColor.w), deltaA = _mm_set1_ps(s.endColor.w - s.startColor.w);
+  const __m128 alphaMask = s.additive ? _mm_setzero_ps() : _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+  alignas(16) float size[4];
+  alignas(16) unsigned int color[4];
+  for (unsigned int i = 0; i < count; i += 4) {
+    const __m128 t = _mm_div_ps(_mm_loadu_ps(&emitter.age[base + i]), _mm_loadu_ps(&emitter.lifetime[base + i]));
+    const __m128 a = _mm_add_ps(startA, _mm_mul_ps(deltaA, t));
+    _mm_store_ps(size, _mm_add_ps(startSize, _mm_mul_ps(deltaSize, t)));
+    __m128i packed = toBytes(_mm_mul_ps(_mm_add_ps(startR, _mm_mul_ps(deltaR, t)), a));
+    packed = _mm_or_si128(packed, _mm_slli_epi32(toBytes(_mm_mul_ps(_mm_add_ps(startG, _mm_mul_ps(deltaG, t)), a)), 8));
+    packed = _mm_or_si128(packed, _mm_slli_epi32(toBytes(_mm_mul_ps(_mm_add_ps(startB, _mm_mul_ps(deltaB, t)), a)), 16));
+    packed = _mm_or_si128(packed, _mm_slli_epi32(toBytes(_mm_and_ps(a, alphaMask)), 24));
+    _mm_store_si128(reinterpret_cast<__m128i*>(color), packed);
+
+    const unsigned int lanes = std::min(4u, count - i);
+    for (unsigned int lane = 0; lane < lanes; ++lane) {
+      ParticleInstance& out = output[i + lane];
+      out.position = XMFLOAT3(emitter.positionX[base + i + lane],
+                              emitter.positionY[base + i + lane],
+                              emitter.positionZ[base + i + lane]);
+      out.size = size[lane];
+      out.color = color[lane];
+    }
+  }
+}
+
+unsigned int
+ParticleSystem::writeInstances(ParticleInstance* output, unsigned int capacity) const {
+  const unsigned int total = std::min(m_jobOffset.empty() ? 0u : m_jobOffset.back(), capacity);
+  if (total == 0) {
+    return 0;
+  }
+
+  if (m_sorted) {
+    JobSystem::getInstance().parallelFor(total, 16384, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        output[i] = m_sortInstances[m_sortOrder[i]];
+      }
+    });
+    return total;
+  }
+
+  JobSystem::getInstance().parallelFor(m_jobs.size(), 4, [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      const unsigned int offset = m_jobOffset[j];
+      if (offset >= total) {
+        continue;
+      }
+      const Emitter& emitter = m_emitters[m_jobs[j].emitter];
+      const unsigned int count = std::min(emitter.blockCount[m_jobs[j].block], total - offset);
+      writeBlock(emitter, m_jobs[j].block, count, output + offset);
+    }
+  });
+  return total;
+}
+
+unsigned int
+ParticleSystem::getAliveCount() const {
+  unsigned int alive = 0;
+  for (const Emitter& emitter : m_emitters) {
+    for (unsigned int count : emitter.blockCount) {
+      alive += count;
+    }
+  }
+  return alive;
+}
+
+void
+ParticleSystem::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numEmitters = 8;
+  const unsigned int perEmitter = 131072;
+  const float dt = 1.0f / 60.0f;
+  const int numFrames = 60;
+  const int verifyFrames = 3;
+  const XMFLOAT3 eye(0.0f, 6.0f, -40.0f);
+  const XMFLOAT3 forward(0.0f, -0.1483f, 0.9889f);
+
+  auto makeSystem = [&](bool withAlpha) {
+    ParticleSystem system;
+    system.addCollisionPlane(XMFLOAT4(0.0f, 1.0f, 0.0f, 0.0f), 0.4f);
+    system.addCollisionPlane(XMFLOAT4(-1.0f, 0.0f, 0.0f, 20.0f), 0.6f);
+    for (unsigned int e = 0; e < numEmitters; ++e) {
+      ParticleEmitterSettings settings;
+      settings.position = XMFLOAT3(-14.0f + 4.0f * e, 1.0f, 0.0f);
+      settings.maxParticles = perEmitter;
+      settings.lifetimeMin = 0.5f;
+      settings.lifetimeMax = 1.5f;
+      settings.speedMin = 4.0f;
+      settings.speedMax = 9.0f;
+      settings.spawnRate = static_cast<float>(perEmitter);
+      settings.additive = !(withAlpha && e % 4 == 3);
+      system.addEmitter(settings);
+      system.burst(e, perEmitter);
+    }
+    return system;
+  };
+
+  std::vector<ParticleInstance> mapped(numEmitters * perEmitter);
+  report.log("%u emitters x %u particles, 2 collision planes, %u threads, %d frames",
+             numEmitters, perEmitter, JobSystem::getInstance().getNumThreads(), numFrames);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    const bool withAlpha = pass == 1;
+    ParticleSystem system = makeSystem(withAlpha);
+    ParticleStats sum;
+    double writeMs = 0.0;
+    unsigned long long alive = 0;
+    unsigned int badOrder = 0;
+    unsigned int badCount = 0;
+    for (int f = 0; f < numFrames; ++f) {
+      system.update(dt, eye, forward);
+      const ParticleStats& stats = system.getStats();
+      sum.spawnMs += stats.spawnMs;
+      sum.simulateMs += stats.simulateMs;
+      sum.sortMs += stats.sortMs;
+      sum.radixPasses += stats.radixPasses;
+      alive += stats.alive;
+
+      Timer timer;
+      unsigned int written = system.writeInstances(mapped.data(), static_cast<unsigned int>(mapped.size()));
+      writeMs += timer.elapsedMs();
+      badCount += written != system.getAliveCount() ? 1 : 0;
+
+      if (system.m_sorted) {
+        // Con la cuantización, dos partículas en el mismo escalón pueden ir en cualquier orden
+        const float step = system.m_sortScale > 0.0f ? 1.0f / system.m_sortScale : 0.0f;
+        float previous = FLT_MAX;
+        for (unsigned int i = 0; i < written; ++i) {
+          const XMFLOAT3& p = mapped[i].position;
+          float depth = (p.x - eye.x) * forward.x + (p.y - eye.y) * forward.y + (p.z - eye.z) * forward.z;
+          badOrder += depth > previous + step ? 1 : 0;
+          previous = std::min(previous, depth);
+        }
+      }
+    }
+
+    const double frames = static_cast<double>(numFrames);
+    report.log("%s: avg %llu alive, spawn %.3f ms, simulate %.3f ms, sort %.3f ms (%.1f radix passes), "
+               "write %.3f ms, total %.3f ms/frame",
+               withAlpha ? "with alpha emitters (sorted)" : "additive only (no sort)",
+               alive / numFrames, sum.spawnMs / frames, sum.simulateMs / frames, sum.sortMs / frames,
+               sum.radixPasses / frames, writeMs / frames,
+               (sum.spawnMs + sum.simulateMs + sum.sortMs + writeMs) / frames);
+    if (badOrder) {
+      report.fail(std::to_string(badOrder) + " sorted instances out of back-to-front order");
+    }
+    if (badCount) {
+      report.fail("writeInstances did not write every alive particle in " + std::to_string(badCount) + " frames");
+    }
+  }
+
+  // SSE contra escalar: mismos datos, mismas muertes, mismos bits
+  ParticleSystem simd = makeSystem(false);
+  ParticleSystem scalar = simd;
+  double scalarMs = 0.0;
+  double simdMs = 0.0;
+  unsigned int mismatches = 0;
+  for (int f = 0; f < verifyFrames; ++f) {
+    float step = dt * 20.0f;
+    Timer timer;
+    for (unsigned int e = 0; e < numEmitters; ++e) {
+      for (unsigned int b = 0; b < simd.m_emitters[e].blockCount.size(); ++b) {
+        simd.simulateBlock(simd.m_emitters[e], b, step);
+      }
+    }
+    simdMs += timer.elapsedMs();
+    timer.reset();
+    for (unsigned int e = 0; e < numEmitters; ++e) {
+      for (unsigned int b = 0; b < scalar.m_emitters[e].blockCount.size(); ++b) {
+        scalar.simulateBlockReference(scalar.m_emitters[e], b, step);
+      }
+    }
+    scalarMs += timer.elapsedMs();
+
+    for (unsigned int e = 0; e < numEmitters; ++e) {
+      const Emitter& a = simd.m_emitters[e];
+      const Emitter& b = scalar.m_emitters[e];
+      if (a.blockCount != b.blockCount) {
+        ++mismatches;
+        continue;
+      }
+      for (unsigned int block = 0; block < a.blockCount.size(); ++block) {
+        const size_t base = static_cast<size_t>(block) * kParticleBlockSize;
+        const size_t bytes = a.blockCount[block] * sizeof(float);
+        const std::vector<float>* fieldsA[] = { &a.positionX, &a.positionY, &a.positionZ, &a.velocityX,
+                                                &a.velocityY, &a.velocityZ, &a.age, &a.lifetime };
+        const std::vector<float>* fieldsB[] = { &b.positionX, &b.positionY, &b.positionZ, &b.velocityX,
+                                                &b.velocityY, &b.velocityZ, &b.age, &b.lifetime };
+        for (int field = 0; field < 8; ++field) {
+          if (bytes && std::memcmp(&(*fieldsA[field])[base], &(*fieldsB[field])[base], bytes) != 0) {
+            ++mismatches;
+          }
+        }
+      }
+    }
+  }
+  report.log("single-thread kernel: SSE %.3f ms vs scalar %.3f ms per 1M-particle step (%u alive after %d steps)",
+             simdMs / verifyFrames, scalarMs / verifyFrames, simd.getAliveCount(), verifyFrames);
+  if (mismatches) {
+    report.fail("SSE particle kernel differs from the scalar reference (" + std::to_string(mismatches) + " arrays)");
+  }
+}
@@ -0,0 +1,521 @@
+#include "RenderStateCache.h"
+#include "Device.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cstring>
+
+namespace {
+
+  inline BOOL
+    normalizeBool(BOOL value) {
+    return value ? TRUE : FALSE;
+  }
+
+  /// @brief Un render target de blend con los valores default de D3D11.
+  void
+    defaultRenderTarget(D3D11_RENDER_TARGET_BLEND_DESC& target) {
+    target.BlendEnable = FALSE;
+    target.SrcBlend = D3D11_BLEND_ONE;
+    target.DestBlend = D3D11_BLEND_ZERO;
+    target.BlendOp = D3D11_BLEND_OP_ADD;
+    target.SrcBlendAlpha = D3D11_BLEND_ONE;
+    target.DestBlendAlpha = D3D11_BLEND_ZERO;
+    target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+  }
+
+  /// @brief Bytes del descriptor de cada tipo (lo que hasheo y comparo).
+  const size_t kDescSize[RENDER_STATE_COUNT] = {
+    sizeof(D3D11_SAMPLER_DESC),
+    sizeof(D3D11_RASTERIZER_DESC),
+    sizeof(D3D11_BLEND_DESC),
+    sizeof(D3D11_DEPTH_STENCIL_DESC)
+  };
+
+  /// @brief Una cara de stencil con los valores default de D3D11.
+  void
+    defaultStencilFace(D3D11_DEPTH_STENCILOP_DESC& face) {
+    face.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+    face.StencilDepthFailOp = D3D11_STENCIL_OP_KEEP;
+    face.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+    face.StencilFunc = D3D11_COMPARISON_ALWAYS;
+  }
+
+} // namespace
+
+HRESULT
+D3D11RenderStateBackend::createState(RenderStateType type, const void* desc, void** state) {
+  if (!m_device || !m_device->m_device) {
+    ERROR("D3D11RenderStateBackend", "createState", "Device is nullptr");
+    return E_POINTER;
+  }
+  ID3D11Device* device = m_device->m_device;
+  switch (type) {
+  case RENDER_STATE_SAMPLER:
+    return device->CreateSamplerState(static_cast<const D3D11_SAMPLER_DESC*>(desc),
+                                      reinterpret_cast<ID3D11SamplerState**>(state));
+  case RENDER_STATE_RASTERIZER:
+    return device->CreateRasterizerState(static_cast<const D3D11_RASTERIZER_DESC*>(desc),
+                                         reinterpret_cast<ID3D11RasterizerState**>(state));
+  case RENDER_STATE_BLEND:
+    return device->CreateBlendState(static_cast<const D3D11_BLEND_DESC*>(desc),
+                                    reinterpret_cast<ID3D11BlendState**>(state));
+  case RENDER_STATE_DEPTH_STENCIL:
+    return device->CreateDepthStencilState(static_cast<const D3D11_DEPTH_STENCIL_DESC*>(desc),
+                                           reinterpret_cast<ID3D11DepthStencilState**>(state));
+  default:
+    return E_INVALIDARG;
+  }
+}
+
+void
+D3D11RenderStateBackend::releaseState(RenderStateType type, void* state) {
+  switch (type) {
+  case RENDER_STATE_SAMPLER:
+    static_cast<ID3D11SamplerState*>(state)->Release();
+    break;
+  case RENDER_STATE_RASTERIZER:
+    static_cast<ID3D11RasterizerState*>(state)->Release();
+    break;
+  case RENDER_STATE_BLEND:
+    static_cast<ID3D11BlendState*>(state)->Release();
+    break;
+  case RENDER_STATE_DEPTH_STENCIL:
+    static_cast<ID3D11DepthStencilState*>(state)->Release();
+    break;
+  default:
+    break;
+  }
+}
+
+HRESULT
+NullRenderStateBackend::createState(RenderStateType type, const void* desc, void** state) {
+  if (!desc || !state) {
+    return E_POINTER;
+  }
+  // Handle falso alineado a 8 (como un puntero real), nunca se desreferencia
+  m_next += 8;
+  *state = reinterpret_cast<void*>(m_next);
+  ++m_live;
+  ++m_created;
+  return S_OK;
+}
+
+void
+NullRenderStateBackend::releaseState(RenderStateType type, void* state) {
+  if (state && m_live > 0) {
+    --m_live;
+  }
+}
+
+void
+RenderStateCache::init(RenderStateBackend* backend) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_backend = backend;
+}
+
+unsigned int
+RenderStateCache::destroy() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  unsigned int leaked = 0;
+  for (Entry& entry : m_entries) {
+    if (!entry.state) {
+      continue;
+    }
+    ++leaked;
+    if (m_backend) {
+      m_backend->releaseState(entry.type, entry.state);
+    }
+    ++m_stats[entry.type].destructions;
+  }
+  for (RenderStateStats& stats : m_stats) {
+    stats.live = 0;
+    stats.references = 0;
+  }
+  m_entries.clear();
+  m_freeEntries.clear();
+  m_byHash.clear();
+  m_byState.clear();
+  m_backend = nullptr;
+  return leaked;
+}
+
+void
+RenderStateCache::normalize(const D3D11_SAMPLER_DESC& in, StateDesc& out) {
+  memset(&out, 0, sizeof(out));
+  D3D11_SAMPLER_DESC& desc = out.sampler;
+  desc.Filter = in.Filter;
+  desc.AddressU = in.AddressU;
+  desc.AddressV = in.AddressV;
+  desc.AddressW = in.AddressW;
+  desc.MipLODBias = in.MipLODBias;
+  desc.MinLOD = in.MinLOD;
+  desc.MaxLOD = in.MaxLOD;
+
+  // La anisotropía solo cuenta con filtro anisotrópico
+  const bool anisotropic = (in.Filter & 0x7F) == D3D11_FILTER_ANISOTROPIC;
+  desc.MaxAnisotropy = anisotropic ? in.MaxAnisotropy : 1;
+  // La función de comparación solo cuenta con filtros de comparación
+  const bool comparison = (in.Filter & 0x180) == 0x80;
+  desc.ComparisonFunc = comparison ? in.ComparisonFunc : D3D11_COMPARISON_NEVER;
+  // El color de borde solo cuenta si algún eje usa BORDER
+  if (in.AddressU == D3D11_TEXTURE_ADDRESS_BORDER ||
+      in.AddressV == D3D11_TEXTURE_ADDRESS_BORDER ||
+      in.AddressW == D3D11_TEXTURE_ADDRESS_BORDER) {
+    memcpy(desc.BorderColor, in.BorderColor, sizeof(desc.BorderColor));
+  }
+}
+
+void
+RenderStateCache::normalize(const D3D11_RASTERIZER_DESC& in, StateDesc& out) {
+  memset(&out, 0, sizeof(out));
+  D3D11_RASTERIZER_DESC& desc = out.rasterizer;
+  desc.FillMode = in.FillMode;
+  desc.CullMode = in.CullMode;
+  desc.FrontCounterClockwise = normalizeBool(in.FrontCounterClockwise);
+  desc.DepthBias = in.DepthBias;
+  desc.DepthBiasClamp = in.DepthBiasClamp;
+  desc.SlopeScaledDepthBias = in.SlopeScaledDepthBias;
+  desc.DepthClipEnable = normalizeBool(in.DepthClipEnable);
+  desc.ScissorEnable = normalizeBool(in.ScissorEnable);
+  desc.MultisampleEnable = normalizeBool(in.MultisampleEnable);
+  desc.AntialiasedLineEnable = normalizeBool(in.AntialiasedLineEnable);
+}
+
+void
+RenderStateCache::normalize(const D3D11_BLEND_DESC& in, StateDesc& out) {
+  memset(&out, 0, sizeof(out));
+  D3D11_BLEND_DESC& desc = out.blend;
+  desc.AlphaToCoverageEnable = normalizeBool(in.AlphaToCoverageEnable);
+  desc.IndependentBlendEnable = normalizeBool(in.IndependentBlendEnable);
+
+  // Sin blend independiente D3D solo lee el render target 0
+  const unsigned int usedTargets = desc.IndependentBlendEnable ? 8 : 1;
+  for (unsigned int i = 0; i < 8; ++i) {
+    D3D11_RENDER_TARGET_BLEND_DESC& target = desc.RenderTarget[i];
+    defaultRenderTarget(target);
+    if (i >= usedTargets) {
+      continue;
+    }
+    const D3D11_RENDER_TARGET_BLEND_DESC& source = in.RenderTarget[i];
+    target.RenderTargetWriteMask = source.RenderTargetWriteMask;
+    if (source.BlendEnable) {
+      target.BlendEnable = TRUE;
+      target.SrcBlend = source.SrcBlend;
+      target.DestBlend = source.DestBlend;
+      target.BlendOp = source.BlendOp;
+      target.SrcBlendAlpha = source.SrcBlendAlpha;
+      target.DestBlendAlpha = source.DestBlendAlpha;
+      target.BlendOpAlpha = source.BlendOpAlpha;
+    }
+  }
+}
+
+void
+RenderStateCache::normalize(const D3D11_DEPTH_STENCIL_DESC& in, StateDesc& out) {
+  memset(&out, 0, sizeof(out));
+  D3D11_DEPTH_STENCIL_DESC& desc = out.depthStencil;
+  desc.DepthEnable = normalizeBool(in.DepthEnable);
+  desc.DepthWriteMask = desc.DepthEnable ? in.DepthWriteMask : D3D11_DEPTH_WRITE_MASK_ALL;
+  desc.DepthFunc = desc.DepthEnable ? in.DepthFunc : D3D11_COMPARISON_LESS;
+  desc.StencilEnable = normalizeBool(in.StencilEnable);
+  if (desc.StencilEnable) {
+    desc.StencilReadMask = in.StencilReadMask;
+    desc.StencilWriteMask = in.StencilWriteMask;
+    desc.FrontFace.StencilFailOp = in.FrontFace.StencilFailOp;
+    desc.FrontFace.StencilDepthFailOp = in.FrontFace.StencilDepthFailOp;
+    desc.FrontFace.StencilPassOp = in.FrontFace.StencilPassOp;
+    desc.FrontFace.StencilFunc = in.FrontFace.StencilFunc;
+    desc.BackFace.StencilFailOp = in.BackFace.StencilFailOp;
+    desc.BackFace.StencilDepthFailOp = in.BackFace.StencilDepthFailOp;
+    desc.BackFace.StencilPassOp = in.BackFace.StencilPassOp;
+    desc.BackFace.StencilFunc = in.BackFace.StencilFunc;
+  }
+  else {
+    desc.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+    desc.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+    defaultStencilFace(desc.FrontFace);
+    defaultStencilFace(desc.BackFace);
+  }
+}
+
+unsigned long long
+RenderStateCache::hashDesc(RenderStateType type, const StateDesc& desc) {
+  // FNV-1a por palabras de 32 bits: todos los descriptores miden múltiplos de 4
+  unsigned long long hash = 14695981039346656037ull;
+  hash = (hash ^ static_cast<unsigned long long>(type)) * 1099511628211ull;
+  const size_t words = kDescSize[type] / sizeof(unsigned int);
+  for (size_t i = 0; i < words; ++i) {
+    unsigned int word;
+    memcpy(&word, reinterpret_cast<const unsigned char*>(&desc) + i * sizeof(word), sizeof(word));
+    hash = (hash ^ word) * 1099511628211ull;
+  }
+  return hash ^ (hash >> 29);
+}
+
+void*
+RenderStateCache::acquire(RenderStateType type, const StateDesc& desc) {
+  const unsigned long long hash = hashDesc(type, desc);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_backend) {
+    ERROR("RenderStateCache", "acquire", "No backend (init the cache after creating the device)");
+    return nullptr;
+  }
+  RenderStateStats& stats = m_stats[type];
+  ++stats.requests;
+
+  auto range = m_byHash.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    Entry& entry = m_entries[it->second];
+    if (entry.type == type && memcmp(&entry.desc, &desc, kDescSize[type]) == 0) {
+      ++entry.references;
+      ++stats.hits;
+      ++stats.references;
+      return entry.state;
+    }
+  }
+
+  void* state = nullptr;
+  HRESULT hr = m_backend->createState(type, &desc, &state);
+  if (FAILED(hr) || !state) {
+    ERROR("RenderStateCache", "acquire", "Failed to create state of type " << type << ". HRESULT: " << hr);
+    return nullptr;
+  }
+  unsigned int index;
+  if (!m_freeEntries.empty()) {
+    index = m_freeEntries.back();
+    m_freeEntries.pop_back();
+  }
+  else {
+    index = static_cast<unsigned int>(m_entries.size());
+    m_entries.push_back(Entry());
+  }
+  Entry& entry = m_entries[index];
+  entry.type = type;
+  entry.desc = desc;
+  entry.hash = hash;
+  entry.state = state;
+  entry.references = 1;
+  m_byHash.emplace(hash, index);
+  m_byState[state] = index;
+  ++stats.creations;
+  ++stats.live;
+  ++stats.references;
+  return state;
+}
+
+ID3D11SamplerState*
+RenderStateCache::acquireSampler(const D3D11_SAMPLER_DESC& desc) {
+  StateDesc normalized;
+  normalize(desc, normalized);
+  return static_cast<ID3D11SamplerState*>(acquire(RENDER_STATE_SAMPLER, normalized));
+}
+
+ID3D11RasterizerState*
+RenderStateCache::acquireRasterizer(const D3D11_RASTERIZER_DESC& desc) {
+  StateDesc normalized;
+  normalize(desc, normalized);
+  return static_cast<ID3D11RasterizerState*>(acquire(RENDER_STATE_RASTERIZER, normalized));
+}
+
+ID3D11BlendState*
+RenderStateCache::acquireBlend(const D3D11_BLEND_DESC& desc) {
+  StateDesc normalized;
+  normalize(desc, normalized);
+  return static_cast<ID3D11BlendState*>(acquire(RENDER_STATE_BLEND, normalized));
+}
+
+ID3D11DepthStencilState*
+RenderStateCache::acquireDepthStencil(const D3D11_DEPTH_STENCIL_DESC& desc) {
+  StateDesc normalized;
+  normalize(desc, normalized);
+  return static_cast<ID3D11DepthStencilState*>(acquire(RENDER_STATE_DEPTH_STENCIL, normalized));
+}
+
+void
+RenderStateCache::release(const void* state) {
+  if (!state) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_backend) {
+    // La caché ya se destruyó y con ella todos sus estados
+    return;
+  }
+  auto found = m_byState.find(state);
+  if (found == m_byState.end()) {
+    ERROR("RenderStateCache", "release", "State isn't owned by the cache");
+    return;
+  }
+  const unsigned int index = found->second;
+  Entry& entry = m_entries[index];
+  RenderStateStats& stats = m_stats[entry.type];
+  --entry.references;
+  --stats.references;
+  if (entry.references > 0) {
+    return;
+  }
+
+  m_backend->releaseState(entry.type, entry.state);
+  auto range = m_byHash.equal_range(entry.hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == index) {
+      m_byHash.erase(it);
+      break;
+    }
+  }
+  m_byState.erase(found);
+  entry.state = nullptr;
+  m_freeEntries.push_back(index);
+  ++stats.destructions;
+  --stats.live;
+}
+
+RenderStateStats
+RenderStateCache::getStats(RenderStateType type) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats[type];
+}
+
+unsigned int
+RenderStateCache::getNumStates() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return static_cast<unsigned int>(m_byState.size());
+}
+
+void
+RenderStateCache::runBenchmark(BenchmarkReport& report) {
+  NullRenderStateBackend backend;
+  RenderStateCache cache;
+  cache.init(&backend);
+
+  // Variantes como las que pediría una escena: 16 samplers, 4 rasterizers, 3 blends, 2 depth
+  std::vector<D3D11_SAMPLER_DESC> samplers(16);
+  for (unsigned int i = 0; i < samplers.size(); ++i) {
+    D3D11_SAMPLER_DESC& desc = samplers[i];
+    memset(&desc, 0, sizeof(desc));
+    desc.Filter = (i & 1) ? D3D11_FILTER_ANISOTROPIC : D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    desc.MaxAnisotropy = (i & 1) ? 8 : 1;
+    desc.AddressU = desc.AddressV = desc.AddressW = (i & 2) ? D3D11_TEXTURE_ADDRESS_CLAMP : D3D11_TEXTURE_ADDRESS_WRAP;
+    desc.MaxLOD = (i & 4) ? 8.0f : D3D11_FLOAT32_MAX;
+    desc.MipLODBias = (i & 8) ? -0.5f : 0.0f;
+  }
+  std::vector<D3D11_RASTERIZER_DESC> rasterizers(4);
+  for (unsigned int i = 0; i < rasterizers.size(); ++i) {
+    D3D11_RASTERIZER_DESC& desc = rasterizers[i];
+    memset(&desc, 0, sizeof(desc));
+    desc.FillMode = (i & 2) ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+    desc.CullMode = (i & 1) ? D3D11_CULL_NONE : D3D11_CULL_BACK;
+    desc.DepthClipEnable = TRUE;
+  }
+  std::vector<D3D11_BLEND_DESC> blends(3);
+  for (unsigned int i = 0; i < blends.size(); ++i) {
+    D3D11_BLEND_DESC& desc = blends[i];
+    memset(&desc, 0, sizeof(desc));
+    defaultRenderTarget(desc.RenderTarget[0]);
+    desc.RenderTarget[0].BlendEnable = i > 0 ? TRUE : FALSE;
+    desc.RenderTarget[0].SrcBlend = i == 2 ? D3D11_BLEND_ONE : D3D11_BLEND_SRC_ALPHA;
+    desc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+  }
+  std::vector<D3D11_DEPTH_STENCIL_DESC> depths(2);
+  for (unsigned int i = 0; i < depths.size(); ++i) {
+    D3D11_DEPTH_STENCIL_DESC& desc = depths[i];
+    memset(&desc, 0, sizeof(desc));
+    desc.DepthEnable = TRUE;
+    desc.DepthWriteMask = i ? D3D11_DEPTH_WRITE_MASK_ZERO : D3D11_DEPTH_WRITE_MASK_ALL;
+    desc.DepthFunc = D3D11_COMPARISON_LESS;
+  }
+
+  // 10k actores, cada uno con sus cuatro estados
+  const unsigned int count = 10000;
+  std::vector<const void*> acquired;
+  acquired.reserve(count * 4);
+  Timer timer;
+  for (unsigned int i = 0; i < count; ++i) {
+    acquired.push_back(cache.acquireSampler(samplers[i % samplers.size()]));
+    acquired.push_back(cache.acquireRasterizer(rasterizers[(i / 7) % rasterizers.size()]));
+    acquired.push_back(cache.acquireBlend(blends[(i / 3) % blends.size()]));
+    acquired.push_back(cache.acquireDepthStencil(depths[(i / 5) % depths.size()]));
+  }
+  const double acquireMs = timer.elapsedMs();
+  const unsigned int unique = static_cast<unsigned int>(samplers.size() + rasterizers.size() + blends.size() + depths.size());
+  if (backend.getNumCreated() != unique || cache.getNumStates() != unique) {
+    report.fail("expected " + std::to_string(unique) + " unique states, created " + std::to_string(backend.getNumCreated()));
+  }
+  const char* names[RENDER_STATE_COUNT] = { "sampler", "rasterizer", "blend", "depth-stencil" };
+  report.log("%u actors x 4 states: %.2f ms (%.0f ns/acquire), %u objects created instead of %u",
+             count, acquireMs, acquireMs * 1.0e6 / acquired.size(), backend.getNumCreated(), count * 4);
+  for (unsigned int t = 0; t < RENDER_STATE_COUNT; ++t) {
+    const RenderStateStats stats = cache.getStats(static_cast<RenderStateType>(t));
+    report.log("  %-13s %6llu requests, %6llu hits (%.2f%%), %3u live, %6u references",
+               names[t], stats.requests, stats.hits, 100.0 * stats.hits / std::max(stats.requests, 1ull),
+               stats.live, stats.references);
+  }
+
+  // Descriptores equivalentes comparten objeto aunque difieran en campos que D3D ignora
+  {
+    D3D11_SAMPLER_DESC desc = samplers[0];
+    desc.BorderColor[2] = 0.25f;
+    desc.ComparisonFunc = D3D11_COMPARISON_LESS;
+    desc.MaxAnisotropy = 16;
+    const void* same = cache.acquireSampler(desc);
+    if (same != acquired[0]) {
+      report.fail("sampler fields ignored by D3D (border, comparison, anisotropy) split the cache");
+    }
+    cache.release(same);
+
+    D3D11_BLEND_DESC blend = blends[1];
+    blend.RenderTarget[3].BlendEnable = TRUE;
+    blend.RenderTarget[3].SrcBlend = D3D11_BLEND_ZERO;
+    D3D11_BLEND_DESC disabled = blends[0];
+    disabled.RenderTarget[0].SrcBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    const void* sameBlend = cache.acquireBlend(blend);
+    const void* sameDisabled = cache.acquireBlend(disabled);
+    if (sameBlend != cache.acquireBlend(blends[1]) || sameDisabled != cache.acquireBlend(blends[0])) {
+      report.fail("blend fields ignored by D3D (other targets, factors with blend off) split the cache");
+    }
+    cache.release(sameBlend);
+    cache.release(sameBlend);
+    cache.release(sameDisabled);
+    cache.release(sameDisabled);
+
+    D3D11_DEPTH_STENCIL_DESC depth = depths[0];
+    depth.StencilReadMask = 0x0F;
+    depth.FrontFace.StencilFunc = D3D11_COMPARISON_EQUAL;
+    const void* sameDepth = cache.acquireDepthStencil(depth);
+    depth.StencilEnable = TRUE;
+    const void* stencil = cache.acquireDepthStencil(depth);
+    if (sameDepth != cache.acquireDepthStencil(depths[0]) || stencil == sameDepth) {
+      report.fail("depth-stencil dedup ignores or mixes up the stencil fields");
+    }
+    cache.release(sameDepth);
+    cache.release(sameDepth);
+    cache.release(stencil);
+
+    D3D11_RASTERIZER_DESC raster = rasterizers[0];
+    raster.DepthBias = 1000;
+    const void* biased = cache.acquireRasterizer(raster);
+    if (biased == acquired[1]) {
+      report.fail("different rasterizer states share an object");
+    }
+    cache.release(biased);
+  }
+  if (backend.getNumLive() != unique) {
+    report.fail("temporary states weren't released with their last reference");
+  }
+
+  // Soltar todo: el objeto se va justo con la última referencia
+  timer.reset();
+  for (const void* state : acquired) {
+    cache.release(state);
+  }
+  const double releaseMs = timer.elapsedMs();
+  if (backend.getNumLive() != 0 || cache.getNumStates() != 0) {
+    report.fail("states left alive after releasing every reference");
+  }
+  report.log("release: %.2f ms (%.0f ns/release), %u states left", releaseMs,
+             releaseMs * 1.0e6 / acquired.size(), cache.getNumStates());
+  if (cache.destroy() != 0) {
+    report.fail("destroy reported leaks after a clean release");
+  }
+}
@@ -1,14 +1,10 @@
 #include "SamplerState.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "RenderStateCache.h"
 
 HRESULT
 SamplerState::init(Device& device) {
-	if(!device.m_device) {
-		ERROR("SamplerState", "init", "Device is nullptr");
-		return E_POINTER;
-	}
-
   D3D11_SAMPLER_DESC sampDesc = {};
   sampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
   sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -17,11 +13,22 @@ SamplerState::init(Device& device) {
   sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
   sampDesc.MinLOD = 0;
   sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
+  return init(device, sampDesc);
+}
 
-	HRESULT hr = device.m_device->CreateSamplerState(&sampDesc, &m_sampler);
-  if(FAILED(hr)) {
+HRESULT
+SamplerState::init(Device& device, const D3D11_SAMPLER_DESC& desc) {
+	if(!device.m_device) {
+		ERROR("SamplerState", "init", "Device is nullptr");
+		return E_POINTER;
+	}
+
+  destroy();
+  // Los samplers idénticos se comparten (un objeto por descriptor)
+  m_sampler = RenderStateCache::getInstance().acquireSampler(desc);
+  if(!m_sampler) {
     ERROR("SamplerState", "init", "Failed to create sampler state");
-    return hr;
+    return E_FAIL;
 	}
 
 	return S_OK;
@@ -46,7 +53,6 @@ SamplerState::render(DeviceContext& deviceContext,
 
 void
 SamplerState::destroy() {
-  if (m_sampler) {
-    SAFE_RELEASE(m_sampler);
-  }
+  RenderStateCache::getInstance().release(m_sampler);
+  m_sampler = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,501 @@
+#include "Scene/SceneFile.h"
+#include "Scene/SceneWriter.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+  /// @brief Escribo un string JSON con sus escapes.
+  void
+    writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+      switch (*c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\r': out << "\\r"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+          out << escaped;
+        }
+        else {
+          out << *c;
+        }
+      }
+    }
+    out << '"';
+  }
+
+  /// @brief Flotantes con todos sus dígitos para que el diff no esconda cambios.
+  void
+    writeJsonFloats(std::ostream& out, const float* values, int count) {
+    char buffer[32];
+    out << '[';
+    for (int i = 0; i < count; ++i) {
+      snprintf(buffer, sizeof(buffer), "%.9g", values[i]);
+      out << (i ? ", " : "") << buffer;
+    }
+    out << ']';
+  }
+
+  /// @brief Índice de recurso o `null`.
+  void
+    writeJsonResource(std::ostream& out, unsigned int index) {
+    if (index == kNoSceneResource) {
+      out << "null";
+    }
+    else {
+      out << index;
+    }
+  }
+
+} // namespace
+
+HRESULT
+SceneFile::load(const std::string& path) {
+  unload();
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    ERROR("SceneFile", "load", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  const std::streamoff size = file.tellg();
+  if (size < static_cast<std::streamoff>(sizeof(SceneHeader))) {
+    ERROR("SceneFile", "load", "File too small " << path.c_str());
+    return E_FAIL;
+  }
+  m_storage.resize((static_cast<size_t>(size) + 7) / 8);
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(m_storage.data()), size);
+  if (!file) {
+    ERROR("SceneFile", "load", "Failed to read " << path.c_str());
+    unload();
+    return E_FAIL;
+  }
+  HRESULT hr = relocate(reinterpret_cast<unsigned char*>(m_storage.data()), static_cast<size_t>(size));
+  if (FAILED(hr)) {
+    ERROR("SceneFile", "load", "Invalid scene file " << path.c_str());
+    unload();
+  }
+  return hr;
+}
+
+HRESULT
+SceneFile::map(const std::string& path) {
+  unload();
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    ERROR("SceneFile", "map", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(SceneHeader))) {
+    ERROR("SceneFile", "map", "File too small " << path.c_str());
+    unload();
+    return E_FAIL;
+  }
+  // Copy-on-write: los fixups ensucian páginas privadas, el archivo queda intacto
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (m_mapping == nullptr) {
+    ERROR("SceneFile", "map", "CreateFileMapping failed for " << path.c_str());
+    unload();
+    return E_FAIL;
+  }
+  m_view = MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+  if (m_view == nullptr) {
+    ERROR("SceneFile", "map", "MapViewOfFile failed for " << path.c_str());
+    unload();
+    return E_FAIL;
+  }
+  HRESULT hr = relocate(static_cast<unsigned char*>(m_view), static_cast<size_t>(size.QuadPart));
+  if (FAILED(hr)) {
+    ERROR("SceneFile", "map", "Invalid scene file " << path.c_str());
+    unload();
+  }
+  return hr;
+}
+
+HRESULT
+SceneFile::loadFromMemory(const std::vector<unsigned char>& blob) {
+  unload();
+  if (blob.size() < sizeof(SceneHeader)) {
+    return E_INVALIDARG;
+  }
+  m_storage.resize((blob.size() + 7) / 8);
+  memcpy(m_storage.data(), blob.data(), blob.size());
+  HRESULT hr = relocate(reinterpret_cast<unsigned char*>(m_storage.data()), blob.size());
+  if (FAILED(hr)) {
+    unload();
+  }
+  return hr;
+}
+
+void
+SceneFile::unload() {
+  if (m_view) {
+    UnmapViewOfFile(m_view);
+    m_view = nullptr;
+  }
+  if (m_mapping) {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+  }
+  std::vector<unsigned long long>().swap(m_storage);
+  m_header = nullptr;
+  m_size = 0;
+}
+
+HRESULT
+SceneFile::relocate(unsigned char* base, size_t size) {
+  SceneHeader* header = reinterpret_cast<SceneHeader*>(base);
+  if (memcmp(header->magic, kSceneMagic, sizeof(kSceneMagic)) != 0 || header->version != kSceneVersion ||
+      header->size != size) {
+    return E_FAIL;
+  }
+  // La tabla de fixups va al final y todo lo demás (strings incluidos) antes
+  const unsigned long long dataEnd = header->fixupOffset;
+  if (dataEnd < sizeof(SceneHeader) || dataEnd % 8 != 0 ||
+      dataEnd + static_cast<unsigned long long>(header->numFixups) * 8 != size ||
+      base[dataEnd - 1] != 0) {
+    return E_FAIL;
+  }
+
+  // Primero valido todos; si uno está mal no toco nada. Marco qué palabras se relocalizan
+  // para luego exigir que cada puntero de la estructura esté en la tabla (y solo una vez)
+  const unsigned long long* fixups = reinterpret_cast<const unsigned long long*>(base + dataEnd);
+  std::vector<unsigned char> relocated(static_cast<size_t>(dataEnd / 8), 0);
+  for (unsigned int i = 0; i < header->numFixups; ++i) {
+    const unsigned long long at = fixups[i];
+    if (at % 8 != 0 || at + 8 > dataEnd || relocated[static_cast<size_t>(at / 8)]) {
+      return E_FAIL;
+    }
+    if (*reinterpret_cast<const unsigned long long*>(base + at) >= dataEnd) {
+      return E_FAIL;
+    }
+    relocated[static_cast<size_t>(at / 8)] = 1;
+  }
+
+  // Un puntero es válido si está en la tabla de fixups, su arreglo cabe antes de `dataEnd`
+  // y está alineado para su tipo. Todo se revisa con offsets, antes de relocalizar
+  auto validRange = [&](const unsigned char* field, unsigned long long count, size_t elementSize,
+                        unsigned long long alignment) {
+    const unsigned long long at = static_cast<unsigned long long>(field - base);
+    const unsigned long long offset = *reinterpret_cast<const unsigned long long*>(field);
+    return relocated[static_cast<size_t>(at / 8)] && offset % alignment == 0 &&
+           offset + count * elementSize <= dataEnd;
+  };
+  if (!validRange(reinterpret_cast<const unsigned char*>(&header->entities), header->numEntities,
+                  sizeof(SceneEntity), 8) ||
+      !validRange(reinterpret_cast<const unsigned char*>(&header->resources), header->numResources,
+                  sizeof(SceneResource), 8)) {
+    return E_FAIL;
+  }
+  const SceneResource* resources = reinterpret_cast<const SceneResource*>(base + header->resources.value);
+  for (unsigned int r = 0; r < header->numResources; ++r) {
+    // Los strings terminan en cero antes de `dataEnd` (el último byte de datos es cero)
+    if (!validRange(reinterpret_cast<const unsigned char*>(&resources[r].path), 1, 1, 1)) {
+      return E_FAIL;
+    }
+  }
+  const SceneEntity* entities = reinterpret_cast<const SceneEntity*>(base + header->entities.value);
+  for (unsigned int e = 0; e < header->numEntities; ++e) {
+    const SceneEntity& entity = entities[e];
+    if (!validRange(reinterpret_cast<const unsigned char*>(&entity.name), 1, 1, 1) ||
+        (entity.model != kNoSceneResource && entity.model >= header->numResources) ||
+        (entity.texture != kNoSceneResource && entity.texture >= header->numResources)) {
+      return E_FAIL;
+    }
+    if (entity.numComponents == 0) {
+      continue;
+    }
+    if (!validRange(reinterpret_cast<const unsigned char*>(&entity.components), entity.numComponents,
+                    sizeof(SceneComponent), 8)) {
+      return E_FAIL;
+    }
+    const SceneComponent* components = reinterpret_cast<const SceneComponent*>(base + entity.components.value);
+    for (unsigned int c = 0; c < entity.numComponents; ++c) {
+      if (!validRange(reinterpret_cast<const unsigned char*>(&components[c].data), components[c].size, 1, 8)) {
+        return E_FAIL;
+      }
+    }
+  }
+
+  const unsigned long long address = reinterpret_cast<uintptr_t>(base);
+  for (unsigned int i = 0; i < header->numFixups; ++i) {
+    *reinterpret_cast<unsigned long long*>(base + fixups[i]) += address;
+  }
+  m_header = header;
+  m_size = size;
+  return S_OK;
+}
+
+const void*
+SceneFile::findComponent(const SceneEntity& entity, SceneComponentType type, unsigned int minSize) const {
+  for (unsigned int i = 0; i < entity.numComponents; ++i) {
+    if (entity.components[i].type == static_cast<unsigned int>(type)) {
+      return entity.components[i].size >= minSize ? entity.components[i].data.get() : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+void
+SceneFile::exportJson(std::ostream& out) const {
+  out << "{\n  \"version\": " << kSceneVersion << ",\n  \"resources\": [";
+  for (unsigned int i = 0; i < getNumResources(); ++i) {
+    const SceneResource& resource = getResource(i);
+    out << (i ? ",\n" : "\n") << "    {\n      \"type\": \""
+        << (resource.type == SCENE_RESOURCE_MODEL ? "model" : "texture") << "\",\n      \"path\": ";
+    writeJsonString(out, resource.path.get());
+    out << ",\n      \"extension\": " << resource.extension << "\n    }";
+  }
+  out << (getNumResources() ? "\n  ],\n" : "],\n") << "  \"entities\": [";
+  for (unsigned int i = 0; i < getNumEntities(); ++i) {
+    const SceneEntity& entity = getEntity(i);
+    out << (i ? ",\n" : "\n") << "    {\n      \"name\": ";
+    writeJsonString(out, entity.name.get());
+    out << ",\n      \"position\": ";
+    writeJsonFloats(out, entity.position, 3);
+    out << ",\n      \"rotation\": ";
+    writeJsonFloats(out, entity.rotation, 3);
+    out << ",\n      \"scale\": ";
+    writeJsonFloats(out, entity.scale, 3);
+    out << ",\n      \"model\": ";
+    writeJsonResource(out, entity.model);
+    out << ",\n      \"texture\": ";
+    writeJsonResource(out, entity.texture);
+    out << ",\n      \"flags\": " << entity.flags << ",\n      \"components\": [";
+    for (unsigned int c = 0; c < entity.numComponents; ++c) {
+      const SceneComponent& component = entity.components[c];
+      out << (c ? ",\n" : "\n");
+      if (component.type == SCENE_COMPONENT_ANIMATOR && component.size >= sizeof(SceneAnimatorData)) {
+        const SceneAnimatorData* animator = reinterpret_cast<const SceneAnimatorData*>(component.data.get());
+        out << "        {\n          \"type\": \"animator\",\n          \"clip\": " << animator->clip
+            << ",\n          \"loop\": " << (animator->loop ? "true" : "false") << ",\n          \"speed\": ";
+        writeJsonFloats(out, &animator->speed, 1);
+        out << "\n        }";
+      }
+      else {
+        out << "        {\n          \"type\": " << component.type << ",\n          \"size\": " << component.size
+            << "\n        }";
+      }
+    }
+    out << (entity.numComponents ? "\n      ]\n    }" : "]\n    }");
+  }
+  out << (getNumEntities() ? "\n  ]\n}\n" : "]\n}\n");
+}
+
+HRESULT
+SceneFile::exportJson(const std::string& path) const {
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  if (!file) {
+    ERROR("SceneFile", "exportJson", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  exportJson(file);
+  if (!file) {
+    ERROR("SceneFile", "exportJson", "Failed to write " << path.c_str());
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+namespace {
+
+  /// @brief Escena sintética: recursos compartidos, Transforms variados y animadores en 1 de cada 4.
+  void
+    buildBenchmarkScene(SceneWriter& writer, unsigned int count) {
+    unsigned int models[8], textures[8];
+    char name[64];
+    for (unsigned int i = 0; i < 8; ++i) {
+      snprintf(name, sizeof(name), "Models/Prop_%02u.fbx", i);
+      models[i] = writer.addResource(SCENE_RESOURCE_MODEL, name);
+      snprintf(name, sizeof(name), "Textures/Prop_%02u_col", i);
+      textures[i] = writer.addResource(SCENE_RESOURCE_TEXTURE, name, 1);
+    }
+    unsigned int seed = 1234567u;
+    auto random = [&seed]() {
+      seed = seed * 1664525u + 1013904223u;
+      return (seed >> 8) / float(1 << 24);
+    };
+    for (unsigned int i = 0; i < count; ++i) {
+      const float position[3] = { random() * 2000.0f - 1000.0f, random() * 50.0f, random() * 2000.0f - 1000.0f };
+      const float rotation[3] = { 0.0f, random() * 360.0f, 0.0f };
+      const float s = 0.5f + random();
+      const float scale[3] = { s, s, s };
+      snprintf(name, sizeof(name), "Entity_%u", i);
+      const unsigned int model = (i % 17 == 0) ? kNoSceneResource : models[i % 8];
+      const unsigned int entity = writer.addEntity(name, position, rotation, scale, model, textures[(i / 8) % 8],
+                                                   SCENE_ENTITY_CAST_SHADOW | ((i & 1) ? SCENE_ENTITY_STATIC_SHADOW : 0));
+      if (i % 4 == 0) {
+        writer.addAnimator(entity, i % 3, (i & 2) != 0, 1.0f + (i % 5) * 0.25f);
+      }
+    }
+  }
+
+  /// @brief ¿Lo cargado es idéntico a lo que generó `buildBenchmarkScene`?
+  bool
+    matchesBenchmarkScene(const SceneFile& scene, unsigned int count) {
+    if (scene.getNumEntities() != count || scene.getNumResources() != 16) {
+      return false;
+    }
+    SceneWriter reference;
+    buildBenchmarkScene(reference, count);
+    std::vector<unsigned char> blob;
+    reference.write(blob);
+    SceneFile expected;
+    if (FAILED(expected.loadFromMemory(blob))) {
+      return false;
+    }
+    for (unsigned int i = 0; i < scene.getNumResources(); ++i) {
+      const SceneResource& a = scene.getResource(i);
+      const SceneResource& b = expected.getResource(i);
+      if (a.type != b.type || a.extension != b.extension || strcmp(a.path.get(), b.path.get()) != 0) {
+        return false;
+      }
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+      const SceneEntity& a = scene.getEntity(i);
+      const SceneEntity& b = expected.getEntity(i);
+      // Todo lo que va después de los dos punteros se compara byte a byte
+      if (memcmp(a.position, b.position, sizeof(SceneEntity) - offsetof(SceneEntity, position)) != 0 ||
+          strcmp(a.name.get(), b.name.get()) != 0) {
+        return false;
+      }
+      const SceneAnimatorData* animatorA = scene.getAnimator(a);
+      const SceneAnimatorData* animatorB = expected.getAnimator(b);
+      if ((animatorA == nullptr) != (animatorB == nullptr) ||
+          (animatorA && memcmp(animatorA, animatorB, sizeof(SceneAnimatorData)) != 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace
+
+void
+SceneFile::runBenchmark(BenchmarkReport& report) {
+  const std::string path = "scene_bench.scene";
+  const unsigned int counts[] = { 1000, 10000, 100000 };
+  for (unsigned int count : counts) {
+    Timer timer;
+    SceneWriter writer;
+    buildBenchmarkScene(writer, count);
+    const double buildMs = timer.elapsedMs();
+    timer.reset();
+    if (FAILED(writer.save(path))) {
+      report.fail("couldn't write the scene file");
+      return;
+    }
+    const double saveMs = timer.elapsedMs();
+
+    SceneFile loaded;
+    timer.reset();
+    const HRESULT loadResult = loaded.load(path);
+    const double loadMs = timer.elapsedMs();
+    SceneFile mapped;
+    timer.reset();
+    const HRESULT mapResult = mapped.map(path);
+    const double mapMs = timer.elapsedMs();
+    if (FAILED(loadResult) || !matchesBenchmarkScene(loaded, count)) {
+      report.fail("loaded scene doesn't match the written one (" + std::to_string(count) + " entities)");
+    }
+    if (FAILED(mapResult) || !matchesBenchmarkScene(mapped, count)) {
+      report.fail("mapped scene doesn't match the written one (" + std::to_string(count) + " entities)");
+    }
+
+    std::ostringstream json;
+    timer.reset();
+    loaded.exportJson(json);
+    const double jsonMs = timer.elapsedMs();
+    report.log("%6u entities: %7.1f KB, %6u fixups | build %6.2f ms, save %6.2f ms, load %6.2f ms (%.0f ns/entity), map %6.2f ms | json %7.2f ms (%.1f KB)",
+               count, loaded.getSize() / 1024.0, loaded.m_header ? loaded.m_header->numFixups : 0, buildMs, saveMs,
+               loadMs, loadMs * 1.0e6 / count, mapMs, jsonMs, json.str().size() / 1024.0);
+  }
+
+  // El mapeo es copy-on-write: relocalizar no debe tocar el archivo
+  {
+    std::ifstream check(path, std::ios::binary);
+    SceneHeader header;
+    check.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!check || header.entities.value != sizeof(SceneHeader)) {
+      report.fail("mapping the scene modified the file on disk");
+    }
+  }
+
+  // Archivos rotos: truncado, fixup fuera del blob y puntero fuera del blob
+  SceneWriter writer;
+  buildBenchmarkScene(writer, 100);
+  std::vector<unsigned char> blob;
+  writer.write(blob);
+  SceneFile broken;
+  std::vector<unsigned char> truncated(blob.begin(), blob.end() - 8);
+  if (SUCCEEDED(broken.loadFromMemory(truncated))) {
+    report.fail("accepted a truncated scene");
+  }
+  std::vector<unsigned char> badFixup(blob);
+  const SceneHeader* header = reinterpret_cast<const SceneHeader*>(badFixup.data());
+  unsigned long long* fixups = reinterpret_cast<unsigned long long*>(&badFixup[static_cast<size_t>(header->fixupOffset)]);
+  fixups[header->numFixups / 2] = blob.size() + 64;
+  if (SUCCEEDED(broken.loadFromMemory(badFixup))) {
+    report.fail("accepted a fixup outside the scene");
+  }
+  std::vector<unsigned char> badPointer(blob);
+  header = reinterpret_cast<const SceneHeader*>(badPointer.data());
+  fixups = reinterpret_cast<unsigned long long*>(&badPointer[static_cast<size_t>(header->fixupOffset)]);
+  *reinterpret_cast<unsigned long long*>(&badPointer[static_cast<size_t>(fixups[header->numFixups / 2])]) = blob.size() * 2;
+  if (SUCCEEDED(broken.loadFromMemory(badPointer))) {
+    report.fail("accepted a pointer outside the scene");
+  }
+
+  // Sin el fixup de `header.entities`: el offset se quedaría como dirección
+  std::vector<unsigned char> missingFixup(blob);
+  SceneHeader* editable = reinterpret_cast<SceneHeader*>(missingFixup.data());
+  const size_t firstFixup = static_cast<size_t>(editable->fixupOffset);
+  if (*reinterpret_cast<const unsigned long long*>(&missingFixup[firstFixup]) != offsetof(SceneHeader, entities)) {
+    report.fail("the first fixup is no longer header.entities");
+  }
+  missingFixup.erase(missingFixup.begin() + firstFixup, missingFixup.begin() + firstFixup + 8);
+  editable = reinterpret_cast<SceneHeader*>(missingFixup.data());
+  --editable->numFixups;
+  editable->size -= 8;
+  if (SUCCEEDED(broken.loadFromMemory(missingFixup))) {
+    report.fail("accepted a pointer missing from the fixup table");
+  }
+
+  // Componentes: uno que se sale del blob se rechaza; uno más chico que su tipo carga
+  // pero el accesor tipado no lo entrega
+  SceneFile reference;
+  reference.loadFromMemory(blob);
+  const SceneEntity& animated = reference.getEntity(0);
+  const size_t componentAt = reinterpret_cast<const unsigned char*>(animated.components.get()) -
+                             reinterpret_cast<const unsigned char*>(reference.m_header);
+  std::vector<unsigned char> badComponent(blob);
+  reinterpret_cast<SceneComponent*>(&badComponent[componentAt])->size = static_cast<unsigned int>(blob.size());
+  if (SUCCEEDED(broken.loadFromMemory(badComponent))) {
+    report.fail("accepted a component running past the scene");
+  }
+  std::vector<unsigned char> shortComponent(blob);
+  reinterpret_cast<SceneComponent*>(&shortComponent[componentAt])->size = 4;
+  if (FAILED(broken.loadFromMemory(shortComponent)) || broken.getAnimator(broken.getEntity(0)) != nullptr ||
+      reference.getAnimator(animated) == nullptr) {
+    report.fail("a component smaller than SceneAnimatorData was returned as one");
+  }
+  std::remove(path.c_str());
+  report.log("corrupt files rejected: truncated, fixup out of range, pointer out of range, missing fixup, "
+             "component out of range; short component hidden from getAnimator");
+}
@@ -0,0 +1,187 @@
+#include "Scene/SceneWriter.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+  inline size_t
+    alignTo8(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+  }
+
+} // namespace
+
+unsigned int
+SceneWriter::addResource(SceneResourceType type, const std::string& path, unsigned int extension) {
+  const std::string key = std::to_string(static_cast<int>(type)) + ":" + path;
+  auto found = m_resourceLookup.find(key);
+  if (found != m_resourceLookup.end()) {
+    return found->second;
+  }
+  const unsigned int index = static_cast<unsigned int>(m_resources.size());
+  SceneResource resource;
+  resource.type = type;
+  resource.extension = extension;
+  m_resources.push_back(resource);
+  m_resourcePaths.push_back(static_cast<unsigned int>(m_strings.size()));
+  m_strings.insert(m_strings.end(), path.c_str(), path.c_str() + path.size() + 1);
+  m_resourceLookup[key] = index;
+  return index;
+}
+
+unsigned int
+SceneWriter::addEntity(const std::string& name,
+                       const float position[3],
+                       const float rotation[3],
+                       const float scale[3],
+                       unsigned int model,
+                       unsigned int texture,
+                       unsigned int flags) {
+  SceneEntity entity;
+  memset(&entity, 0, sizeof(entity));
+  memcpy(entity.position, position, sizeof(entity.position));
+  memcpy(entity.rotation, rotation, sizeof(entity.rotation));
+  memcpy(entity.scale, scale, sizeof(entity.scale));
+  entity.model = model;
+  entity.texture = texture;
+  entity.flags = flags;
+  m_entities.push_back(entity);
+  m_entityNames.push_back(static_cast<unsigned int>(m_strings.size()));
+  m_strings.insert(m_strings.end(), name.c_str(), name.c_str() + name.size() + 1);
+  return static_cast<unsigned int>(m_entities.size() - 1);
+}
+
+void
+SceneWriter::addComponent(unsigned int entity, SceneComponentType type, const void* data, unsigned int size) {
+  if (entity >= m_entities.size()) {
+    ERROR("SceneWriter", "addComponent", "Invalid entity " << entity);
+    return;
+  }
+  PendingComponent component;
+  component.entity = entity;
+  component.type = type;
+  component.offset = static_cast<unsigned int>(m_componentData.size());
+  component.size = size;
+  m_components.push_back(component);
+  // Cada componente alineado a 8 dentro de su sección
+  m_componentData.resize(alignTo8(m_componentData.size() + size));
+  memcpy(&m_componentData[component.offset], data, size);
+  ++m_entities[entity].numComponents;
+}
+
+void
+SceneWriter::addAnimator(unsigned int entity, unsigned int clip, bool loop, float speed) {
+  SceneAnimatorData animator;
+  animator.clip = clip;
+  animator.loop = loop ? 1 : 0;
+  animator.speed = speed;
+  animator.reserved = 0;
+  addComponent(entity, SCENE_COMPONENT_ANIMATOR, &animator, sizeof(animator));
+}
+
+void
+SceneWriter::write(std::vector<unsigned char>& blob) const {
+  // Componentes agrupados por entidad (normalmente ya vienen así)
+  std::vector<PendingComponent> components(m_components);
+  std::stable_sort(components.begin(), components.end(), [](const PendingComponent& a, const PendingComponent& b) {
+    return a.entity < b.entity;
+  });
+
+  const size_t entitiesOffset = sizeof(SceneHeader);
+  const size_t resourcesOffset = entitiesOffset + m_entities.size() * sizeof(SceneEntity);
+  const size_t componentsOffset = resourcesOffset + m_resources.size() * sizeof(SceneResource);
+  const size_t dataOffset = componentsOffset + components.size() * sizeof(SceneComponent);
+  const size_t stringsOffset = dataOffset + alignTo8(m_componentData.size());
+  const size_t fixupOffset = stringsOffset + alignTo8(m_strings.size() + 1);
+
+  std::vector<unsigned long long> fixups;
+  fixups.reserve(2 + m_entities.size() * 2 + m_resources.size() + components.size());
+  blob.assign(fixupOffset, 0);
+
+  SceneHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kSceneMagic, sizeof(kSceneMagic));
+  header.version = kSceneVersion;
+  header.entities.value = entitiesOffset;
+  header.resources.value = resourcesOffset;
+  header.numEntities = static_cast<unsigned int>(m_entities.size());
+  header.numResources = static_cast<unsigned int>(m_resources.size());
+  header.fixupOffset = fixupOffset;
+  fixups.push_back(offsetof(SceneHeader, entities));
+  fixups.push_back(offsetof(SceneHeader, resources));
+
+  size_t nextComponent = 0;
+  for (size_t i = 0; i < m_entities.size(); ++i) {
+    SceneEntity entity = m_entities[i];
+    const size_t at = entitiesOffset + i * sizeof(SceneEntity);
+    entity.name.value = stringsOffset + m_entityNames[i];
+    fixups.push_back(at + offsetof(SceneEntity, name));
+    if (entity.numComponents > 0) {
+      entity.components.value = componentsOffset + nextComponent * sizeof(SceneComponent);
+      fixups.push_back(at + offsetof(SceneEntity, components));
+      nextComponent += entity.numComponents;
+    }
+    memcpy(&blob[at], &entity, sizeof(entity));
+  }
+
+  for (size_t i = 0; i < m_resources.size(); ++i) {
+    SceneResource resource = m_resources[i];
+    const size_t at = resourcesOffset + i * sizeof(SceneResource);
+    resource.path.value = stringsOffset + m_resourcePaths[i];
+    fixups.push_back(at + offsetof(SceneResource, path));
+    memcpy(&blob[at], &resource, sizeof(resource));
+  }
+
+  for (size_t i = 0; i < components.size(); ++i) {
+    SceneComponent component;
+    component.type = components[i].type;
+    component.size = components[i].size;
+    component.data.value = dataOffset + components[i].offset;
+    const size_t at = componentsOffset + i * sizeof(SceneComponent);
+    fixups.push_back(at + offsetof(SceneComponent, data));
+    memcpy(&blob[at], &component, sizeof(component));
+  }
+
+  if (!m_componentData.empty()) {
+    memcpy(&blob[dataOffset], m_componentData.data(), m_componentData.size());
+  }
+  if (!m_strings.empty()) {
+    memcpy(&blob[stringsOffset], m_strings.data(), m_strings.size());
+  }
+
+  header.numFixups = static_cast<unsigned int>(fixups.size());
+  header.size = fixupOffset + fixups.size() * sizeof(unsigned long long);
+  memcpy(&blob[0], &header, sizeof(header));
+  blob.resize(static_cast<size_t>(header.size));
+  memcpy(&blob[fixupOffset], fixups.data(), fixups.size() * sizeof(unsigned long long));
+}
+
+HRESULT
+SceneWriter::save(const std::string& path) const {
+  std::vector<unsigned char> blob;
+  write(blob);
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    ERROR("SceneWriter", "save", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+  if (!file) {
+    ERROR("SceneWriter", "save", "Failed to write " << path.c_str());
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+void
+SceneWriter::clear() {
+  m_entities.clear();
+  m_entityNames.clear();
+  m_resources.clear();
+  m_resourcePaths.clear();
+  m_resourceLookup.clear();
+  m_components.clear();
+  m_componentData.clear();
+  m_strings.clear();
+}
@@ -0,0 +1,731 @@
+#include "Scene/WorldPartition.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+void
+WorldPartition::setSettings(const WorldPartitionSettings& settings) {
+  m_settings = settings;
+  m_settings.cellSize = std::max(m_settings.cellSize, 1.0f);
+  m_settings.unloadRadius = std::max(m_settings.unloadRadius, m_settings.loadRadius);
+  m_settings.maxLoadsInFlight = std::max(m_settings.maxLoadsInFlight, 1u);
+}
+
+void
+WorldPartition::setLoader(const ResourceFunc& load, const ResourceFunc& unload) {
+  m_load = load;
+  m_unload = unload;
+}
+
+unsigned int
+WorldPartition::addResource(unsigned long long bytes) {
+  Resource resource;
+  resource.bytes = bytes;
+  m_resources.push_back(resource);
+  return static_cast<unsigned int>(m_resources.size() - 1);
+}
+
+unsigned int
+WorldPartition::addEntity(const XMFLOAT3& position, const unsigned int* resources, unsigned int numResources) {
+  const int x = static_cast<int>(std::floor(position.x / m_settings.cellSize));
+  const int z = static_cast<int>(std::floor(position.z / m_settings.cellSize));
+  auto found = m_cellLookup.find(cellKey(x, z));
+  unsigned int index;
+  if (found == m_cellLookup.end()) {
+    index = static_cast<unsigned int>(m_cells.size());
+    m_cells.push_back(Cell());
+    m_cells.back().x = x;
+    m_cells.back().z = z;
+    m_cellLookup[cellKey(x, z)] = index;
+  }
+  else {
+    index = found->second;
+  }
+  Cell& cell = m_cells[index];
+  const unsigned int entity = static_cast<unsigned int>(m_entityCell.size());
+  cell.entities.push_back(entity);
+  for (unsigned int i = 0; i < numResources; ++i) {
+    if (resources[i] < m_resources.size() &&
+        std::find(cell.resources.begin(), cell.resources.end(), resources[i]) == cell.resources.end()) {
+      cell.resources.push_back(resources[i]);
+    }
+  }
+  m_entityCell.push_back(index);
+  return entity;
+}
+
+CellState
+WorldPartition::getCellState(const XMFLOAT3& position) const {
+  const int x = static_cast<int>(std::floor(position.x / m_settings.cellSize));
+  const int z = static_cast<int>(std::floor(position.z / m_settings.cellSize));
+  auto found = m_cellLookup.find(cellKey(x, z));
+  return found == m_cellLookup.end() ? CELL_UNLOADED : m_cells[found->second].state;
+}
+
+float
+WorldPartition::cellDistance(const Cell& cell, const XMFLOAT3& camera) const {
+  const float minX = cell.x * m_settings.cellSize;
+  const float minZ = cell.z * m_settings.cellSize;
+  const float dx = std::max(std::max(minX - camera.x, camera.x - (minX + m_settings.cellSize)), 0.0f);
+  const float dz = std::max(std::max(minZ - camera.z, camera.z - (minZ + m_settings.cellSize)), 0.0f);
+  return std::sqrt(dx * dx + dz * dz);
+}
+
+void
+WorldPartition::startThread() {
+  if (!m_thread.joinable()) {
+    m_stop = false;
+    m_thread = std::thread(&WorldPartition::streamLoop, this);
+  }
+}
+
+void
+WorldPartition::streamLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_wakeCondition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+    if (m_stop) {
+      break;
+    }
+    const unsigned int resource = m_queue.front();
+    m_queue.pop_front();
+    ++m_busy;
+    lock.unlock();
+    const bool loaded = m_load ? m_load(resource) : true;
+    lock.lock();
+    (loaded ? m_completed : m_failed).push_back(resource);
+    --m_busy;
+    m_idleCondition.notify_all();
+  }
+}
+
+void
+WorldPartition::collectCompleted() {
+  std::vector<unsigned int> completed;
+  std::vector<unsigned int> failed;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    completed.swap(m_completed);
+    failed.swap(m_failed);
+  }
+  m_stats.failedLoads += static_cast<unsigned int>(failed.size());
+
+  for (unsigned int r : completed) {
+    Resource& resource = m_resources[r];
+    resource.state = RESOURCE_READY;
+    m_stats.inFlightBytes -= resource.bytes;
+    m_stats.residentBytes += resource.bytes;
+    m_stats.totalBytesStreamed += resource.bytes;
+    ++m_stats.completedLoads;
+    // Ya nadie lo quería (su celda se descargó mientras se leía)
+    if (resource.refs == 0) {
+      releaseResource(r);
+    }
+  }
+  // Un recurso que falló no deja a la celda cargando para siempre, pero tampoco cuenta
+  // como memoria residente; se vuelve a intentar cuando una celda lo pida de nuevo
+  for (unsigned int r : failed) {
+    Resource& resource = m_resources[r];
+    resource.state = RESOURCE_FAILED;
+    m_stats.inFlightBytes -= resource.bytes;
+    if (resource.refs == 0) {
+      releaseResource(r);
+    }
+  }
+
+  for (unsigned int c : m_activeCells) {
+    Cell& cell = m_cells[c];
+    if (cell.state != CELL_LOADING) {
+      continue;
+    }
+    bool ready = true;
+    for (unsigned int r : cell.resources) {
+      ready = ready && (m_resources[r].state == RESOURCE_READY || m_resources[r].state == RESOURCE_FAILED);
+    }
+    if (ready) {
+      cell.state = CELL_LOADED;
+      m_activated.insert(m_activated.end(), cell.entities.begin(), cell.entities.end());
+      ++m_stats.totalCellLoads;
+    }
+  }
+}
+
+unsigned long long
+WorldPartition::missingBytes(const Cell& cell) const {
+  unsigned long long bytes = 0;
+  for (unsigned int r : cell.resources) {
+    bytes += m_resources[r].state == RESOURCE_NONE ? m_resources[r].bytes : 0;
+  }
+  return bytes;
+}
+
+void
+WorldPartition::requestCell(unsigned int index) {
+  Cell& cell = m_cells[index];
+  cell.state = CELL_LOADING;
+  cell.activeIndex = static_cast<unsigned int>(m_activeCells.size());
+  m_activeCells.push_back(index);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (unsigned int r : cell.resources) {
+    Resource& resource = m_resources[r];
+    ++resource.refs;
+    if (resource.state == RESOURCE_NONE) {
+      resource.state = RESOURCE_PENDING;
+      m_stats.inFlightBytes += resource.bytes;
+      m_stats.issuedBytes += resource.bytes;
+      ++m_stats.issuedLoads;
+      m_queue.push_back(r);
+    }
+  }
+}
+
+void
+WorldPartition::releaseCell(unsigned int index) {
+  Cell& cell = m_cells[index];
+  if (cell.state == CELL_LOADED) {
+    m_deactivated.insert(m_deactivated.end(), cell.entities.begin(), cell.entities.end());
+    ++m_stats.totalCellUnloads;
+  }
+  cell.state = CELL_UNLOADED;
+  removeActive(index);
+  for (unsigned int r : cell.resources) {
+    if (--m_resources[r].refs == 0) {
+      releaseResource(r);
+    }
+  }
+}
+
+void
+WorldPartition::releaseResource(unsigned int index) {
+  Resource& resource = m_resources[index];
+  if (resource.state == RESOURCE_READY) {
+    if (m_unload) {
+      m_unload(index);
+    }
+    m_stats.residentBytes -= resource.bytes;
+    resource.state = RESOURCE_NONE;
+  }
+  else if (resource.state == RESOURCE_FAILED) {
+    resource.state = RESOURCE_NONE;
+  }
+  else if (resource.state == RESOURCE_PENDING) {
+    // Si el hilo aún no lo toma lo cancelo; si ya lo está leyendo se descarga al terminar
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto queued = std::find(m_queue.begin(), m_queue.end(), index);
+    if (queued != m_queue.end()) {
+      m_queue.erase(queued);
+      m_stats.inFlightBytes -= resource.bytes;
+      resource.state = RESOURCE_NONE;
+    }
+  }
+}
+
+void
+WorldPartition::removeActive(unsigned int index) {
+  const unsigned int slot = m_cells[index].activeIndex;
+  const unsigned int last = m_activeCells.back();
+  m_activeCells[slot] = last;
+  m_cells[last].activeIndex = slot;
+  m_activeCells.pop_back();
+}
+
+void
+WorldPartition::update(const XMFLOAT3& camera) {
+  Timer timer;
+  m_activated.clear();
+  m_deactivated.clear();
+  m_stats.issuedBytes = 0;
+  m_stats.issuedLoads = 0;
+  m_stats.completedLoads = 0;
+  m_stats.evictions = 0;
+  m_stats.budgetDeferrals = 0;
+  startThread();
+
+  collectCompleted();
+
+  // Descarga: solo fuera de unloadRadius (histéresis). Voy de atrás para adelante porque
+  // quitar una celda mueve la última a su lugar
+  for (size_t i = m_activeCells.size(); i-- > 0;) {
+    const unsigned int c = m_activeCells[i];
+    if (cellDistance(m_cells[c], camera) > m_settings.unloadRadius) {
+      releaseCell(c);
+    }
+  }
+
+  // Candidatas: celdas descargadas dentro de loadRadius, la más cercana primero
+  std::vector<std::pair<float, unsigned int>> candidates;
+  const int reach = static_cast<int>(std::ceil(m_settings.loadRadius / m_settings.cellSize));
+  const int centerX = static_cast<int>(std::floor(camera.x / m_settings.cellSize));
+  const int centerZ = static_cast<int>(std::floor(camera.z / m_settings.cellSize));
+  for (int z = centerZ - reach; z <= centerZ + reach; ++z) {
+    for (int x = centerX - reach; x <= centerX + reach; ++x) {
+      auto found = m_cellLookup.find(cellKey(x, z));
+      if (found == m_cellLookup.end() || m_cells[found->second].state != CELL_UNLOADED) {
+        continue;
+      }
+      const float distance = cellDistance(m_cells[found->second], camera);
+      if (distance <= m_settings.loadRadius) {
+        candidates.push_back(std::make_pair(distance, found->second));
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  size_t queued;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    queued = m_queue.size();
+  }
+  for (const auto& candidate : candidates) {
+    if (queued >= m_settings.maxLoadsInFlight) {
+      break;
+    }
+    const Cell& cell = m_cells[candidate.second];
+    unsigned long long needed = missingBytes(cell);
+    if (m_stats.issuedBytes > 0 && m_stats.issuedBytes + needed > m_settings.ioBudgetPerFrame) {
+      break;
+    }
+    if (m_stats.residentBytes + m_stats.inFlightBytes + needed > m_settings.memoryBudget) {
+      // Hago espacio con las celdas cargadas que ya salieron de loadRadius, las más lejanas primero
+      std::vector<std::pair<float, unsigned int>> evictable;
+      for (unsigned int c : m_activeCells) {
+        const float distance = cellDistance(m_cells[c], camera);
+        if (m_cells[c].state == CELL_LOADED && distance > m_settings.loadRadius) {
+          evictable.push_back(std::make_pair(distance, c));
+        }
+      }
+      std::sort(evictable.rbegin(), evictable.rend());
+      for (const auto& victim : evictable) {
+        if (m_stats.residentBytes + m_stats.inFlightBytes + needed <= m_settings.memoryBudget) {
+          break;
+        }
+        releaseCell(victim.second);
+        ++m_stats.evictions;
+        needed = missingBytes(cell);
+      }
+      if (m_stats.residentBytes + m_stats.inFlightBytes + needed > m_settings.memoryBudget) {
+        ++m_stats.budgetDeferrals;
+        break;
+      }
+    }
+    const unsigned int issuedBefore = m_stats.issuedLoads;
+    requestCell(candidate.second);
+    queued += m_stats.issuedLoads - issuedBefore;
+  }
+  if (m_stats.issuedLoads > 0) {
+    m_wakeCondition.notify_one();
+  }
+
+  m_stats.numCells = static_cast<unsigned int>(m_cells.size());
+  m_stats.loadedCells = 0;
+  m_stats.loadingCells = 0;
+  for (unsigned int c : m_activeCells) {
+    m_stats.loadedCells += m_cells[c].state == CELL_LOADED ? 1 : 0;
+    m_stats.loadingCells += m_cells[c].state == CELL_LOADING ? 1 : 0;
+  }
+  m_stats.updateMs = timer.elapsedMs();
+}
+
+void
+WorldPartition::flush() {
+  if (m_thread.joinable()) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_queue.empty() && m_busy == 0; });
+  }
+  collectCompleted();
+  m_stats.loadedCells = 0;
+  m_stats.loadingCells = 0;
+  for (unsigned int c : m_activeCells) {
+    m_stats.loadedCells += m_cells[c].state == CELL_LOADED ? 1 : 0;
+    m_stats.loadingCells += m_cells[c].state == CELL_LOADING ? 1 : 0;
+  }
+}
+
+void
+WorldPartition::shutdown() {
+  std::deque<unsigned int> dropped;
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      dropped.swap(m_queue);
+      m_stop = true;
+    }
+    m_wakeCondition.notify_all();
+    m_thread.join();
+  }
+  for (unsigned int r : dropped) {
+    m_stats.inFlightBytes -= m_resources[r].bytes;
+    m_resources[r].state = RESOURCE_NONE;
+  }
+  collectCompleted();
+  while (!m_activeCells.empty()) {
+    releaseCell(m_activeCells.back());
+  }
+  m_stop = false;
+}
+
+namespace {
+
+  /**
+   * @struct StreamingWorld
+   * @brief Mundo sintético del benchmark y la "memoria" de sus recursos.
+   */
+  struct
+    StreamingWorld {
+    std::vector<unsigned long long> bytes;
+    std::vector<std::vector<unsigned char>> data;
+    std::atomic<unsigned long long> liveBytes{ 0 };
+    std::atomic<unsigned long long> peakBytes{ 0 };
+    std::atomic<unsigned int> corrupted{ 0 };
+    /// @brief Ancho de banda simulado del disco (bytes por microsegundo).
+    double bytesPerMicrosecond = 1000.0;
+  };
+
+  const float kWorldSize = 10000.0f;
+  const float kCellSize = 250.0f;
+  const unsigned int kPropsPerCell = 40;
+
+  /**
+   * @brief 40x40 celdas de 250 m; cada una con su terreno y 40 props de un catálogo compartido.
+   */
+  void
+    buildStreamingWorld(WorldPartition& partition, StreamingWorld& world) {
+    const unsigned int cellsPerSide = static_cast<unsigned int>(kWorldSize / kCellSize);
+    const unsigned int numProps = 128;
+    const unsigned int numTextures = 64;
+    unsigned int seed = 2024u;
+    auto random = [&seed]() {
+      seed = seed * 1664525u + 1013904223u;
+      return (seed >> 8) / float(1 << 24);
+    };
+    auto addResource = [&](unsigned long long size) {
+      world.bytes.push_back(size);
+      return partition.addResource(size);
+    };
+    std::vector<unsigned int> props(numProps), textures(numTextures), tiles(cellsPerSide * cellsPerSide);
+    for (unsigned int& prop : props) {
+      prop = addResource(static_cast<unsigned long long>((32 + random() * 224) * 1024));
+    }
+    for (unsigned int& texture : textures) {
+      texture = addResource(static_cast<unsigned long long>((128 + random() * 896) * 1024));
+    }
+    for (unsigned int& tile : tiles) {
+      tile = addResource(512 * 1024);
+    }
+    world.data.resize(world.bytes.size());
+
+    for (unsigned int cz = 0; cz < cellsPerSide; ++cz) {
+      for (unsigned int cx = 0; cx < cellsPerSide; ++cx) {
+        const float x0 = cx * kCellSize - kWorldSize * 0.5f;
+        const float z0 = cz * kCellSize - kWorldSize * 0.5f;
+        const unsigned int terrain[2] = { tiles[cz * cellsPerSide + cx], textures[(cz * 7 + cx) % numTextures] };
+        partition.addEntity(XMFLOAT3(x0 + kCellSize * 0.5f, 0.0f, z0 + kCellSize * 0.5f), terrain, 2);
+        for (unsigned int p = 0; p < kPropsPerCell; ++p) {
+          const unsigned int resources[2] = { props[static_cast<unsigned int>(random() * numProps) % numProps],
+                                              textures[static_cast<unsigned int>(random() * numTextures) % numTextures] };
+          partition.addEntity(XMFLOAT3(x0 + random() * kCellSize, 0.0f, z0 + random() * kCellSize), resources, 2);
+        }
+      }
+    }
+
+    // Cargar = reservar, "decodificar" (llenar) y esperar lo que tardaría el disco
+    partition.setLoader(
+      [&world](unsigned int r) {
+        const unsigned long long size = world.bytes[r];
+        std::vector<unsigned char>& data = world.data[r];
+        data.assign(static_cast<size_t>(size), static_cast<unsigned char>(r));
+        const unsigned long long live = world.liveBytes.fetch_add(size) + size;
+        unsigned long long peak = world.peakBytes.load();
+        while (live > peak && !world.peakBytes.compare_exchange_weak(peak, live)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(size / world.bytesPerMicrosecond)));
+        return true;
+      },
+      [&world](unsigned int r) {
+        std::vector<unsigned char>& data = world.data[r];
+        if (data.size() != world.bytes[r] || data[0] != static_cast<unsigned char>(r)) {
+          ++world.corrupted;
+        }
+        world.liveBytes -= data.size();
+        std::vector<unsigned char>().swap(data);
+        return true;
+      });
+  }
+
+  /**
+   * @brief Ruta grabada de la cámara: una curva Catmull-Rom que cruza el mundo, muestreada
+   *        a velocidad constante (una posición por frame).
+   */
+  std::vector<XMFLOAT3>
+    recordCameraPath(unsigned int frames) {
+    std::vector<XMFLOAT3> points;
+    unsigned int seed = 77u;
+    for (int i = 0; i <= 10; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      const float z = ((seed >> 8) / float(1 << 24) - 0.5f) * 7000.0f;
+      points.push_back(XMFLOAT3(-4500.0f + i * 900.0f, 120.0f, z));
+    }
+    points.insert(points.begin(), points.front());
+    points.push_back(points.back());
+
+    // Curva densa y luego re-muestreo por longitud de arco
+    std::vector<XMFLOAT3> dense;
+    for (size_t s = 1; s + 2 < points.size(); ++s) {
+      const XMFLOAT3& p0 = points[s - 1];
+      const XMFLOAT3& p1 = points[s];
+      const XMFLOAT3& p2 = points[s + 1];
+      const XMFLOAT3& p3 = points[s + 2];
+      auto catmullRom = [](float a, float b, float c, float d, float t) {
+        return 0.5f * (2.0f * b + (c - a) * t + (2.0f * a - 5.0f * b + 4.0f * c - d) * t * t +
+                       (3.0f * b - a - 3.0f * c + d) * t * t * t);
+      };
+      for (int k = 0; k < 256; ++k) {
+        const float t = k / 256.0f;
+        dense.push_back(XMFLOAT3(catmullRom(p0.x, p1.x, p2.x, p3.x, t), p1.y, catmullRom(p0.z, p1.z, p2.z, p3.z, t)));
+      }
+    }
+    dense.push_back(points[points.size() - 2]);
+    std::vector<float> length(dense.size(), 0.0f);
+    for (size_t i = 1; i < dense.size(); ++i) {
+      const float dx = dense[i].x - dense[i - 1].x;
+      const float dz = dense[i].z - dense[i - 1].z;
+      length[i] = length[i - 1] + std::sqrt(dx * dx + dz * dz);
+    }
+    std::vector<XMFLOAT3> path(frames);
+    size_t segment = 1;
+    for (unsigned int f = 0; f < frames; ++f) {
+      const float target = length.back() * f / float(frames - 1);
+      while (segment + 1 < dense.size() && length[segment] < target) {
+        ++segment;
+      }
+      const float span = std::max(length[segment] - length[segment - 1], 1e-6f);
+      const float t = std::min(std::max((target - length[segment - 1]) / span, 0.0f), 1.0f);
+      path[f] = XMFLOAT3(dense[segment - 1].x + (dense[segment].x - dense[segment - 1].x) * t,
+                         dense[segment - 1].y,
+                         dense[segment - 1].z + (dense[segment].z - dense[segment - 1].z) * t);
+    }
+    return path;
+  }
+
+  /// @brief ¿Está cargado todo lo que rodea a la cámara hasta `radius`?
+  bool
+    surroundingsLoaded(const WorldPartition& partition, const XMFLOAT3& camera, float radius) {
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        const XMFLOAT3 probe(camera.x + dx * radius, camera.y, camera.z + dz * radius);
+        if (std::fabs(probe.x) < kWorldSize * 0.5f && std::fabs(probe.z) < kWorldSize * 0.5f &&
+            partition.getCellState(probe) != CELL_LOADED) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /// @brief Pantalla de carga: repito hasta que no quede nada por pedir alrededor de la cámara.
+  void
+    settle(WorldPartition& partition, const XMFLOAT3& camera) {
+    do {
+      partition.update(camera);
+      partition.flush();
+    } while (partition.getStats().issuedLoads > 0 || partition.getStats().loadingCells > 0);
+  }
+
+  /// @brief Celdas cargadas de más al oscilar la cámara alrededor del borde de `loadRadius`.
+  unsigned int
+    countThrash(const WorldPartitionSettings& settings) {
+    WorldPartition partition;
+    partition.setSettings(settings);
+    StreamingWorld world;
+    buildStreamingWorld(partition, world);
+    // La celda que empieza en x = 1000 queda justo en loadRadius cuando la cámara está en 250
+    const float edge = 1000.0f - settings.loadRadius;
+    // Primero visito los dos extremos: lo que se cargue después ya es una recarga
+    settle(partition, XMFLOAT3(edge + 40.0f, 120.0f, 125.0f));
+    settle(partition, XMFLOAT3(edge - 40.0f, 120.0f, 125.0f));
+    const unsigned int initialLoads = partition.getStats().totalCellLoads;
+    for (int f = 0; f < 120; ++f) {
+      partition.update(XMFLOAT3(edge - 40.0f * std::sin(f * 0.4f), 120.0f, 125.0f));
+      partition.flush();
+    }
+    const unsigned int extraLoads = partition.getStats().totalCellLoads - initialLoads;
+    partition.shutdown();
+    return extraLoads;
+  }
+
+} // namespace
+
+void
+WorldPartition::runBenchmark(BenchmarkReport& report) {
+  WorldPartitionSettings settings;
+  settings.cellSize = kCellSize;
+  settings.loadRadius = 750.0f;
+  settings.unloadRadius = 1000.0f;
+  settings.memoryBudget = 128ull << 20;
+  settings.ioBudgetPerFrame = 8ull << 20;
+  settings.maxLoadsInFlight = 32;
+
+  WorldPartition partition;
+  partition.setSettings(settings);
+  StreamingWorld world;
+  Timer timer;
+  buildStreamingWorld(partition, world);
+  report.log("world: %.0f km x %.0f km, %u cells, %u entities, %u resources (setup %.1f ms)",
+             kWorldSize / 1000.0f, kWorldSize / 1000.0f, static_cast<unsigned int>(partition.m_cells.size()),
+             partition.getNumEntities(), static_cast<unsigned int>(world.bytes.size()), timer.elapsedMs());
+
+  // Vuelo: cada frame dura 4 ms reales (la ruta va a ~8 m por frame)
+  const unsigned int frames = 1500;
+  const std::chrono::microseconds framePeriod(4000);
+  const std::vector<XMFLOAT3> path = recordCameraPath(frames);
+  const float hitchRadius = 300.0f;
+  const double updateHitchMs = 1.0;
+
+  std::vector<unsigned char> active(partition.getNumEntities(), 0);
+  timer.reset();
+  do {
+    partition.update(path[0]);
+    partition.flush();
+    for (unsigned int e : partition.getActivatedEntities()) {
+      active[e] = 1;
+    }
+  } while (partition.getStats().issuedLoads > 0 || partition.getStats().loadingCells > 0);
+  const double startupMs = timer.elapsedMs();
+
+  unsigned int streamingHitches = 0, longestHitch = 0, currentHitch = 0, updateHitches = 0;
+  double totalUpdateMs = 0.0, maxUpdateMs = 0.0;
+  unsigned long long peakResident = 0;
+  unsigned int evictions = 0, deferrals = 0;
+  for (unsigned int f = 1; f < frames; ++f) {
+    const auto frameStart = std::chrono::steady_clock::now();
+    partition.update(path[f]);
+    const WorldPartitionStats& stats = partition.getStats();
+    for (unsigned int e : partition.getDeactivatedEntities()) {
+      active[e] = 0;
+    }
+    for (unsigned int e : partition.getActivatedEntities()) {
+      active[e] = 1;
+    }
+    totalUpdateMs += stats.updateMs;
+    maxUpdateMs = std::max(maxUpdateMs, stats.updateMs);
+    updateHitches += stats.updateMs > updateHitchMs ? 1 : 0;
+    peakResident = std::max(peakResident, stats.residentBytes + stats.inFlightBytes);
+    evictions += stats.evictions;
+    deferrals += stats.budgetDeferrals;
+    if (!surroundingsLoaded(partition, path[f], hitchRadius)) {
+      ++streamingHitches;
+      longestHitch = std::max(longestHitch, ++currentHitch);
+    }
+    else {
+      currentHitch = 0;
+    }
+    std::this_thread::sleep_until(frameStart + framePeriod);
+  }
+  float pathLength = 0.0f;
+  for (unsigned int f = 1; f < frames; ++f) {
+    const float dx = path[f].x - path[f - 1].x;
+    const float dz = path[f].z - path[f - 1].z;
+    pathLength += std::sqrt(dx * dx + dz * dz);
+  }
+  const WorldPartitionStats& totals = partition.getStats();
+  report.log("flythrough: %.1f km in %u frames, startup %.1f ms, %u cell loads, %u unloads, %.0f MB streamed",
+             pathLength / 1000.0f, frames, startupMs, totals.totalCellLoads, totals.totalCellUnloads,
+             totals.totalBytesStreamed / double(1 << 20));
+  report.log("update: avg %.3f ms, max %.3f ms, %u frames over %.1f ms | peak memory %.1f / %.0f MB, %u evictions, %u deferrals",
+             totalUpdateMs / (frames - 1), maxUpdateMs, updateHitches, updateHitchMs,
+             peakResident / double(1 << 20), settings.memoryBudget / double(1 << 20), evictions, deferrals);
+  report.log("hitches: %u frames (%.2f%%) with cells within %.0f m not loaded, longest %u frames",
+             streamingHitches, 100.0 * streamingHitches / (frames - 1), hitchRadius, longestHitch);
+
+  partition.flush();
+  for (unsigned int e : partition.getActivatedEntities()) {
+    active[e] = 1;
+  }
+  unsigned int mismatched = 0;
+  for (unsigned int e = 0; e < partition.getNumEntities(); ++e) {
+    mismatched += (active[e] != 0) != partition.isEntityLoaded(e) ? 1 : 0;
+  }
+  if (mismatched > 0) {
+    report.fail("activated/deactivated entities don't match the loaded cells (" + std::to_string(mismatched) + ")");
+  }
+  if (world.peakBytes.load() > settings.memoryBudget) {
+    report.fail("streaming went over the memory budget");
+  }
+  partition.shutdown();
+  if (world.liveBytes.load() != 0 || world.corrupted.load() != 0) {
+    report.fail("resources leaked or unloaded in a bad state");
+  }
+
+  // Histéresis: la cámara va y viene sobre el borde de loadRadius
+  const unsigned int thrash = countThrash(settings);
+  WorldPartitionSettings noHysteresis = settings;
+  noHysteresis.unloadRadius = noHysteresis.loadRadius;
+  const unsigned int thrashWithout = countThrash(noHysteresis);
+  report.log("camera oscillating on the load edge: %u extra cell loads with hysteresis, %u without",
+             thrash, thrashWithout);
+  if (thrash != 0) {
+    report.fail("hysteresis didn't stop cells from reloading");
+  }
+
+  // Presupuesto chico: nunca se pasa aunque haya que dejar celdas sin cargar
+  WorldPartitionSettings tight = settings;
+  tight.memoryBudget = 48ull << 20;
+  WorldPartition limited;
+  limited.setSettings(tight);
+  StreamingWorld limitedWorld;
+  buildStreamingWorld(limited, limitedWorld);
+  unsigned int limitedEvictions = 0, limitedDeferrals = 0;
+  for (unsigned int f = 0; f < frames; f += 5) {
+    limited.update(path[f]);
+    limited.flush();
+    limitedEvictions += limited.getStats().evictions;
+    limitedDeferrals += limited.getStats().budgetDeferrals;
+  }
+  report.log("%.0f MB budget: peak %.1f MB, %u evictions, %u deferrals",
+             tight.memoryBudget / double(1 << 20), limitedWorld.peakBytes.load() / double(1 << 20),
+             limitedEvictions, limitedDeferrals);
+  if (limitedWorld.peakBytes.load() > tight.memoryBudget) {
+    report.fail("streaming went over a tight memory budget");
+  }
+  limited.shutdown();
+
+  // Cargas que fallan (1 de cada 5 recursos): las celdas se asientan, pero esos recursos
+  // no cuentan como residentes ni se mandan a descargar
+  WorldPartition failing;
+  failing.setSettings(settings);
+  StreamingWorld failingWorld;
+  buildStreamingWorld(failing, failingWorld);
+  failing.setLoader(
+    [&failingWorld](unsigned int r) {
+      if (r % 5 == 0) {
+        return false;
+      }
+      failingWorld.liveBytes += failingWorld.bytes[r];
+      return true;
+    },
+    [&failingWorld](unsigned int r) {
+      if (r % 5 == 0) {
+        ++failingWorld.corrupted;
+      }
+      failingWorld.liveBytes -= failingWorld.bytes[r];
+      return true;
+    });
+  settle(failing, path[0]);
+  const WorldPartitionStats& failingStats = failing.getStats();
+  const bool settled = surroundingsLoaded(failing, path[0], hitchRadius);
+  const bool accounted = failingStats.residentBytes == failingWorld.liveBytes.load();
+  report.log("failing loads: %u failed, %.1f MB resident, %.1f MB streamed, surroundings %s",
+             failingStats.failedLoads, failingStats.residentBytes / double(1 << 20),
+             failingStats.totalBytesStreamed / double(1 << 20), settled ? "loaded" : "stuck");
+  failing.shutdown();
+  if (failingStats.failedLoads == 0 || !settled) {
+    report.fail("cells with failed resources did not settle");
+  }
+  if (!accounted || failingWorld.corrupted.load() != 0 || failingWorld.liveBytes.load() != 0 ||
+      failing.getStats().residentBytes != 0) {
+    report.fail("failed loads were counted as resident or unloaded");
+  }
+}
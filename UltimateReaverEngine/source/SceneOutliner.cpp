@@ -0,0 +1,404 @@
+#include "SceneOutliner.h"
+#include "ECS/Transform.h"
+#include "ECS/Prefab.h"
+#include "JobSystem.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cctype>
+#include <numeric>
+#include <random>
+#include <string_view>
+
+namespace {
+
+  /// @brief Candidatos que reviso entre cada consulta al reloj.
+  const size_t kFilterChunk = 1024;
+
+  std::string
+  toLower(const std::string& text) {
+    std::string lower(text);
+    for (char& c : lower) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+  }
+
+} // namespace
+
+void
+SceneOutliner::build(const std::vector<EU::TSharedPointer<Actor>>& actors) {
+  std::vector<std::string> names;
+  names.reserve(actors.size());
+  for (const EU::TSharedPointer<Actor>& actor : actors) {
+    names.push_back(actor.isNull() ? std::string() : actor->getName());
+  }
+  build(names);
+}
+
+void
+SceneOutliner::build(const std::vector<std::string>& names) {
+  size_t totalChars = 0;
+  for (const std::string& name : names) {
+    totalChars += name.size();
+  }
+  m_names.clear();
+  m_names.reserve(totalChars);
+  m_offsets.resize(names.size() + 1);
+  for (size_t i = 0; i < names.size(); ++i) {
+    m_offsets[i] = static_cast<unsigned int>(m_names.size());
+    for (char c : names[i]) {
+      m_names.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+  }
+  m_offsets[names.size()] = static_cast<unsigned int>(m_names.size());
+
+  m_selected.assign(names.size(), 0);
+  m_selection.clear();
+  m_anchor = kInvalid;
+  m_primary = kInvalid;
+
+  // Sin búsqueda todo coincide
+  m_query.clear();
+  m_results.resize(names.size());
+  std::iota(m_results.begin(), m_results.end(), 0u);
+  m_candidates = m_results;
+  m_cursor = m_candidates.size();
+  ++m_version;
+}
+
+void
+SceneOutliner::setQuery(const std::string& query) {
+  std::string lower = toLower(query);
+  if (lower == m_query) {
+    return;
+  }
+
+  if (lower.empty()) {
+    m_results.resize(getNumEntries());
+    std::iota(m_results.begin(), m_results.end(), 0u);
+    m_candidates = m_results;
+    m_cursor = m_candidates.size();
+  }
+  else if (lower.find(m_query) != std::string::npos) {
+    // Más específico que el anterior: solo puede coincidir lo que ya coincidía o lo que
+    // faltaba revisar. El orden de escena se conserva.
+    std::vector<unsigned int> candidates;
+    candidates.reserve(m_results.size() + (m_candidates.size() - m_cursor));
+    candidates.insert(candidates.end(), m_results.begin(), m_results.end());
+    candidates.insert(candidates.end(), m_candidates.begin() + m_cursor, m_candidates.end());
+    m_candidates.swap(candidates);
+    m_results.clear();
+    m_cursor = 0;
+  }
+  else {
+    m_candidates.resize(getNumEntries());
+    std::iota(m_candidates.begin(), m_candidates.end(), 0u);
+    m_results.clear();
+    m_cursor = 0;
+  }
+  m_query = lower;
+  ++m_version;
+}
+
+bool
+SceneOutliner::updateFilter(double budgetMs) {
+  if (isFilterComplete()) {
+    return true;
+  }
+  ++m_version;
+  Timer timer;
+  while (m_cursor < m_candidates.size()) {
+    const size_t end = std::min(m_cursor + kFilterChunk, m_candidates.size());
+    for (; m_cursor < end; ++m_cursor) {
+      if (matches(m_candidates[m_cursor])) {
+        m_results.push_back(m_candidates[m_cursor]);
+      }
+    }
+    if (timer.elapsedMs() >= budgetMs) {
+      break;
+    }
+  }
+  return isFilterComplete();
+}
+
+float
+SceneOutliner::getFilterProgress() const {
+  if (m_candidates.empty()) {
+    return 1.0f;
+  }
+  return static_cast<float>(m_cursor) / static_cast<float>(m_candidates.size());
+}
+
+bool
+SceneOutliner::matches(unsigned int entity) const {
+  const std::string_view name(m_names.data() + m_offsets[entity], m_offsets[entity + 1] - m_offsets[entity]);
+  return name.find(m_query) != std::string_view::npos;
+}
+
+void
+SceneOutliner::click(unsigned int entity, bool ctrl, bool shift) {
+  if (entity >= getNumEntries()) {
+    return;
+  }
+
+  if (shift && m_anchor != kInvalid) {
+    // El rango es sobre la lista filtrada (en orden de escena); si el ancla ya no está en
+    // ella, empiezo desde donde habría quedado
+    if (!ctrl) {
+      clearSelection();
+    }
+    auto from = std::lower_bound(m_results.begin(), m_results.end(), m_anchor);
+    auto to = std::lower_bound(m_results.begin(), m_results.end(), entity);
+    if (from > to) {
+      std::swap(from, to);
+    }
+    for (auto it = from; it != m_results.end() && it <= to; ++it) {
+      if (!m_selected[*it]) {
+        m_selected[*it] = 1;
+        m_selection.push_back(*it);
+      }
+    }
+    if (!m_selected[entity]) {
+      m_selected[entity] = 1;
+      m_selection.push_back(entity);
+    }
+    m_primary = entity;
+    ++m_version;
+    return;
+  }
+
+  if (ctrl) {
+    if (m_selected[entity]) {
+      m_selected[entity] = 0;
+      m_selection.erase(std::find(m_selection.begin(), m_selection.end(), entity));
+      setPrimaryFromSelection();
+    }
+    else {
+      m_selected[entity] = 1;
+      m_selection.push_back(entity);
+      m_primary = entity;
+    }
+    m_anchor = entity;
+    ++m_version;
+    return;
+  }
+
+  select(entity);
+}
+
+void
+SceneOutliner::select(unsigned int entity) {
+  clearSelection();
+  if (entity >= getNumEntries()) {
+    return;
+  }
+  m_selected[entity] = 1;
+  m_selection.push_back(entity);
+  m_anchor = entity;
+  m_primary = entity;
+  ++m_version;
+}
+
+void
+SceneOutliner::selectResults() {
+  for (unsigned int entity : m_results) {
+    if (!m_selected[entity]) {
+      m_selected[entity] = 1;
+      m_selection.push_back(entity);
+    }
+  }
+  setPrimaryFromSelection();
+  ++m_version;
+}
+
+void
+SceneOutliner::clearSelection() {
+  // Solo limpio las banderas que están puestas
+  for (unsigned int entity : m_selection) {
+    m_selected[entity] = 0;
+  }
+  m_selection.clear();
+  m_primary = kInvalid;
+  ++m_version;
+}
+
+void
+SceneOutliner::setPrimaryFromSelection() {
+  m_primary = m_selection.empty() ? kInvalid : m_selection.back();
+}
+
+void
+SceneOutliner::applyEdit(const std::vector<EU::TSharedPointer<Actor>>& actors, const TransformEdit& edit) const {
+  // Cada actor aparece una sola vez en la selección, así que los jobs no se pisan
+  JobSystem::getInstance().parallelFor(m_selection.size(), 256,
+    [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const unsigned int entity = m_selection[i];
+        if (entity >= actors.size() || actors[entity].isNull()) {
+          continue;
+        }
+        EU::TSharedPointer<Transform> transform = actors[entity]->getComponent<Transform>();
+        if (transform.isNull()) {
+          continue;
+        }
+        const EU::Vector3 scale = transform->getScale();
+        transform->setPosition(transform->getPosition() + edit.translation);
+        transform->setRotation(transform->getRotation() + edit.rotation);
+        transform->setScale(EU::Vector3(scale.x * edit.scale.x, scale.y * edit.scale.y, scale.z * edit.scale.z));
+      }
+    });
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void
+SceneOutliner::runBenchmark(BenchmarkReport& report) {
+  const unsigned int kEntities = 100000;
+  const char* kKinds[] = { "Rock", "Tree_Oak", "Tree_Pine", "Crate", "Barrel", "Lamp", "Fence",
+                           "Wall", "Door", "Bush", "Grass", "Cliff", "House", "Car", "Sign", "Light" };
+
+  std::mt19937 rng(71);
+  std::vector<std::string> names(kEntities);
+  for (unsigned int i = 0; i < kEntities; ++i) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s_%05u", kKinds[rng() % 16], i);
+    names[i] = buffer;
+  }
+
+  SceneOutliner outliner;
+  Timer timer;
+  outliner.build(names);
+  report.log("outliner: %u names, table %zu KB, build %.3f ms",
+             kEntities, outliner.m_names.size() / 1024, timer.elapsedMs());
+
+  auto bruteForce = [&](const std::string& query) {
+    const std::string lower = toLower(query);
+    std::vector<unsigned int> expected;
+    for (unsigned int i = 0; i < kEntities; ++i) {
+      if (toLower(names[i]).find(lower) != std::string::npos) {
+        expected.push_back(i);
+      }
+    }
+    return expected;
+  };
+
+  // Tecleo letra por letra (refina), luego borro (vuelve a escanear)
+  const std::string typed = "Tree_Oak_0123";
+  double worstKeyMs = 0.0;
+  for (size_t length = 1; length <= typed.size(); ++length) {
+    const std::string query = typed.substr(0, length);
+    timer.reset();
+    outliner.setQuery(query);
+    outliner.updateFilter(1e9);
+    const double ms = timer.elapsedMs();
+    worstKeyMs = std::max(worstKeyMs, ms);
+    if (outliner.getResults() != bruteForce(query)) {
+      report.fail("outliner: results for '" + query + "' differ from brute force");
+    }
+  }
+  report.log("outliner: typing '%s', worst keystroke %.3f ms, %zu matches",
+             typed.c_str(), worstKeyMs, outliner.getResults().size());
+
+  timer.reset();
+  outliner.setQuery("TREE");
+  outliner.updateFilter(1e9);
+  const double rescanMs = timer.elapsedMs();
+  if (outliner.getResults() != bruteForce("tree")) {
+    report.fail("outliner: rescan after erasing differs from brute force");
+  }
+  report.log("outliner: rescan 'TREE' %.3f ms, %zu matches", rescanMs, outliner.getResults().size());
+
+  // Cambiar la búsqueda a mitad del filtro tampoco puede perder resultados
+  outliner.setQuery("5");
+  outliner.updateFilter(0.0);
+  outliner.setQuery("_5");
+  outliner.updateFilter(0.0);
+  outliner.setQuery("_59");
+  outliner.updateFilter(1e9);
+  if (outliner.getResults() != bruteForce("_59")) {
+    report.fail("outliner: refining an unfinished filter lost results");
+  }
+
+  // Presupuesto por frame: el filtro se reparte en varios frames
+  const double budgetMs = 0.05;
+  outliner.setQuery("");
+  outliner.setQuery("a");
+  unsigned int frames = 0;
+  double worstFrameMs = 0.0;
+  bool done = false;
+  while (!done) {
+    timer.reset();
+    done = outliner.updateFilter(budgetMs);
+    worstFrameMs = std::max(worstFrameMs, timer.elapsedMs());
+    ++frames;
+  }
+  if (outliner.getResults() != bruteForce("a")) {
+    report.fail("outliner: time-sliced filter differs from brute force");
+  }
+  if (frames < 2) {
+    report.fail("outliner: filter over 100k names did not split across frames");
+  }
+  report.log("outliner: budget %.2f ms/frame, %u frames, worst frame %.3f ms",
+             budgetMs, frames, worstFrameMs);
+
+  // Selección: rango con shift sobre la lista filtrada y ctrl para quitar
+  outliner.setQuery("crate");
+  outliner.updateFilter(1e9);
+  const std::vector<unsigned int> crates = outliner.getResults();
+  if (crates.size() < 64) {
+    report.fail("outliner: not enough matches to test selection");
+    return;
+  }
+  outliner.click(crates[10], false, false);
+  outliner.click(crates[40], false, true);
+  bool rangeOk = outliner.getSelection().size() == 31;
+  for (unsigned int i = 10; i <= 40; ++i) {
+    rangeOk = rangeOk && outliner.isSelected(crates[i]);
+  }
+  rangeOk = rangeOk && !outliner.isSelected(crates[9]) && !outliner.isSelected(crates[41]);
+  outliner.click(crates[20], true, false);
+  rangeOk = rangeOk && !outliner.isSelected(crates[20]) && outliner.getSelection().size() == 30;
+  outliner.click(crates[5], true, true);
+  rangeOk = rangeOk && outliner.getSelection().size() == 36 && outliner.getPrimary() == crates[5];
+  if (!rangeOk) {
+    report.fail("outliner: shift/ctrl selection is wrong");
+  }
+
+  // Edición en lote de Transform sobre actores headless
+  const unsigned int kActors = 20000;
+  std::vector<EU::TSharedPointer<Actor>> actors(kActors);
+  for (unsigned int i = 0; i < kActors; ++i) {
+    actors[i] = EU::MakeShared<Actor>(EU::TSharedPointer<Prefab>());
+    actors[i]->setName(names[i]);
+    actors[i]->getComponent<Transform>()->setTransform(EU::Vector3(float(i), 0.0f, 0.0f),
+                                                        EU::Vector3(0.0f, 0.0f, 0.0f),
+                                                        EU::Vector3(1.0f, 1.0f, 1.0f));
+  }
+  outliner.build(actors);
+  outliner.setQuery("tree");
+  outliner.updateFilter(1e9);
+  outliner.selectResults();
+  TransformEdit edit;
+  edit.translation = EU::Vector3(0.0f, 2.0f, 0.0f);
+  edit.scale = EU::Vector3(2.0f, 2.0f, 2.0f);
+  timer.reset();
+  outliner.applyEdit(actors, edit);
+  const double editMs = timer.elapsedMs();
+  std::vector<unsigned int> expectedTrees = bruteForce("tree");
+  expectedTrees.erase(std::lower_bound(expectedTrees.begin(), expectedTrees.end(), kActors), expectedTrees.end());
+  bool editOk = !expectedTrees.empty() && outliner.getSelection() == expectedTrees;
+  for (unsigned int i = 0; i < kActors; ++i) {
+    EU::TSharedPointer<Transform> transform = actors[i]->getComponent<Transform>();
+    const float expectedY = outliner.isSelected(i) ? 2.0f : 0.0f;
+    const float expectedScale = outliner.isSelected(i) ? 2.0f : 1.0f;
+    editOk = editOk && transform->getPosition().x == float(i) && transform->getPosition().y == expectedY &&
+             transform->getScale().z == expectedScale;
+  }
+  if (!editOk) {
+    report.fail("outliner: batched Transform edit touched the wrong actors");
+  }
+  report.log("outliner: batched edit of %zu/%u actors %.3f ms (%u threads)",
+             outliner.getSelection().size(), kActors, editMs, JobSystem::getInstance().getNumThreads());
+}
@@ -0,0 +1,542 @@
+#include "Shadows/CascadedShadows.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+  inline float
+    dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+  inline void
+    normalize3(float v[3]) {
+    float len = std::sqrt(dot3(v, v));
+    float inv = len > 1e-12f ? 1.0f / len : 0.0f;
+    v[0] *= inv;
+    v[1] *= inv;
+    v[2] *= inv;
+  }
+
+  inline void
+    cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  /// Producto de matrices 4x4 con vectores fila (a aplica primero)
+  XMFLOAT4X4
+    multiply(const XMFLOAT4X4& a, const XMFLOAT4X4& b) {
+    XMFLOAT4X4 r;
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] +
+                    a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+      }
+    }
+    return r;
+  }
+
+  inline uint64_t
+    hashWords(uint64_t hash, const void* data, size_t bytes) {
+    const uint32_t* words = static_cast<const uint32_t*>(data);
+    for (size_t i = 0; i < bytes / 4; ++i) {
+      hash = (hash ^ words[i]) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+} // namespace
+
+void
+CascadedShadows::setSettings(const CascadedShadowSettings& settings) {
+  m_settings = settings;
+  m_settings.numCascades = std::min(std::max(m_settings.numCascades, 1u), kMaxShadowCascades);
+  m_settings.resolution = std::max(m_settings.resolution, 16u);
+  m_settings.cacheMargin = std::max(m_settings.cacheMargin, 0.0f);
+  for (ShadowCascade& cascade : m_cascades) {
+    cascade.anchored = false;
+    cascade.staticDirty = true;
+  }
+}
+
+void
+CascadedShadows::setLightDirection(const XMFLOAT3& direction) {
+  float dir[3] = { direction.x, direction.y, direction.z };
+  normalize3(dir);
+  if (dir[0] == m_lightDir[0] && dir[1] == m_lightDir[1] && dir[2] == m_lightDir[2] && !m_lightChanged) {
+    return;
+  }
+  std::memcpy(m_lightDir, dir, sizeof(dir));
+  m_lightChanged = true;
+}
+
+void
+CascadedShadows::invalidateStatic() {
+  for (ShadowCascade& cascade : m_cascades) {
+    cascade.staticDirty = true;
+  }
+}
+
+void
+CascadedShadows::fitSlice(float nearZ,
+                          float farZ,
+                          float tanX,
+                          float tanY,
+                          float& centerZ,
+                          float& radius) const {
+  // Esfera por las 8 esquinas: solo depende de las distancias, no de la orientación
+  float k2 = tanX * tanX + tanY * tanY;
+  float z = 0.5f * (farZ + nearZ) * (1.0f + k2);
+  if (z >= farZ) {
+    centerZ = farZ;
+    radius = farZ * std::sqrt(k2);
+    return;
+  }
+  centerZ = z;
+  radius = std::sqrt((farZ - z) * (farZ - z) + farZ * farZ * k2);
+}
+
+void
+CascadedShadows::prepareCasters(const std::vector<ShadowCaster>& casters) {
+  CasterLayer* layers[2] = { &m_dynamicLayer, &m_staticLayer };
+  for (CasterLayer* layer : layers) {
+    layer->index.clear();
+  }
+  for (unsigned int i = 0; i < casters.size(); ++i) {
+    layers[casters[i].isStatic ? 1 : 0]->index.push_back(i);
+  }
+
+  for (CasterLayer* layer : layers) {
+    size_t count = layer->index.size();
+    size_t padded = (count + 3) & ~size_t(3);
+    layer->x.assign(padded, FLT_MAX);
+    layer->y.assign(padded, 0.0f);
+    layer->z.assign(padded, 0.0f);
+    layer->radius.assign(padded, 0.0f);
+
+    JobSystem::getInstance().parallelFor(count, 2048, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const ShadowCaster& caster = casters[layer->index[i]];
+        float c[3] = { caster.center.x, caster.center.y, caster.center.z };
+        layer->x[i] = dot3(c, m_lightRight);
+        layer->y[i] = dot3(c, m_lightUp);
+        layer->z[i] = dot3(c, m_lightDir);
+        layer->radius[i] = caster.radius;
+      }
+    });
+  }
+}
+
+void
+CascadedShadows::cullLayer(const ShadowCascade& cascade,
+                           const CasterLayer& layer,
+                           std::vector<unsigned int>& output) const {
+  output.clear();
+  const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 cx = _mm_set1_ps(cascade.anchor[0]);
+  const __m128 cy = _mm_set1_ps(cascade.anchor[1]);
+  const __m128 extent = _mm_set1_ps(cascade.radius);
+  const __m128 zMax = _mm_set1_ps(cascade.anchor[2] + cascade.radius);
+
+  for (size_t i = 0; i < layer.x.size(); i += 4) {
+    __m128 r = _mm_loadu_ps(&layer.radius[i]);
+    __m128 reach = _mm_add_ps(extent, r);
+    __m128 dx = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&layer.x[i]), cx), signMask);
+    __m128 dy = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&layer.y[i]), cy), signMask);
+    // Sin límite hacia la luz: lo que está antes del plano cercano se aplasta en el renderer
+    __m128 front = _mm_cmple_ps(_mm_sub_ps(_mm_loadu_ps(&layer.z[i]), r), zMax);
+    int mask = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(_mm_cmple_ps(dx, reach),
+                                                     _mm_cmple_ps(dy, reach)), front));
+    while (mask) {
+      unsigned int bit = 0;
+      while (!(mask & (1 << bit))) {
+        ++bit;
+      }
+      mask &= mask - 1;
+      output.push_back(layer.index[i + bit]);
+    }
+  }
+}
+
+void
+CascadedShadows::buildBatches(const std::vector<ShadowCaster>& casters,
+                              std::vector<unsigned int>& list,
+                              std::vector<ShadowDrawBatch>& batches) {
+  std::sort(list.begin(), list.end(), [&casters](unsigned int a, unsigned int b) {
+    if (casters[a].geometry != casters[b].geometry) {
+      return casters[a].geometry < casters[b].geometry;
+    }
+    return a < b;
+  });
+
+  batches.clear();
+  for (unsigned int i = 0; i < list.size(); ++i) {
+    const ShadowGeometry* geometry = casters[list[i]].geometry;
+    if (batches.empty() ||
+        batches.back().geometry != geometry ||
+        batches.back().count == kMaxShadowInstances) {
+      batches.push_back(ShadowDrawBatch{ geometry, i, 0 });
+    }
+    ++batches.back().count;
+  }
+}
+
+void
+CascadedShadows::update(const XMFLOAT4X4& view,
+                        float fovY,
+                        float aspect,
+                        float nearZ,
+                        float farZ,
+                        const std::vector<ShadowCaster>& casters) {
+  Timer total;
+  const unsigned int numCascades = m_settings.numCascades;
+
+  // Base de la luz (misma convención que XMMatrixLookToLH con origen en el mundo)
+  if (m_lightChanged) {
+    float reference[3] = { 0.0f, 1.0f, 0.0f };
+    if (std::fabs(m_lightDir[1]) > 0.99f) {
+      reference[1] = 0.0f;
+      reference[2] = 1.0f;
+    }
+    cross3(reference, m_lightDir, m_lightRight);
+    normalize3(m_lightRight);
+    cross3(m_lightDir, m_lightRight, m_lightUp);
+
+    for (int i = 0; i < 3; ++i) {
+      m_lightView.m[i][0] = m_lightRight[i];
+      m_lightView.m[i][1] = m_lightUp[i];
+      m_lightView.m[i][2] = m_lightDir[i];
+      m_lightView.m[i][3] = 0.0f;
+    }
+    m_lightView._41 = m_lightView._42 = m_lightView._43 = 0.0f;
+    m_lightView._44 = 1.0f;
+  }
+
+  // Hash de los estáticos: si cambia cualquiera, todas las capas estáticas se invalidan
+  uint64_t staticHash = 14695981039346656037ull;
+  for (const ShadowCaster& caster : casters) {
+    if (caster.isStatic) {
+      staticHash = hashWords(staticHash, &caster.world, sizeof(caster.world));
+      staticHash = hashWords(staticHash, &caster.radius, sizeof(caster.radius));
+      staticHash = hashWords(staticHash, &caster.geometry, sizeof(caster.geometry));
+    }
+  }
+  bool staticChanged = staticHash != m_staticHash;
+  m_staticHash = staticHash;
+
+  prepareCasters(casters);
+
+  // Cámara: posición y ejes a partir de la matriz de vista
+  float forward[3] = { view._13, view._23, view._33 };
+  float eye[3];
+  for (int i = 0; i < 3; ++i) {
+    eye[i] = -(view._41 * view.m[i][0] + view._42 * view.m[i][1] + view._43 * view.m[i][2]);
+  }
+
+  const float tanY = std::tan(fovY * 0.5f);
+  const float tanX = tanY * aspect;
+  const float shadowFar = std::max(std::min(farZ, m_settings.shadowDistance), nearZ * 1.01f);
+  const float ratio = shadowFar / nearZ;
+
+  float splits[kMaxShadowCascades + 1];
+  for (unsigned int i = 0; i <= numCascades; ++i) {
+    float t = static_cast<float>(i) / numCascades;
+    float logSplit = nearZ * std::pow(ratio, t);
+    float uniformSplit = nearZ + (shadowFar - nearZ) * t;
+    splits[i] = m_settings.splitLambda * logSplit + (1.0f - m_settings.splitLambda) * uniformSplit;
+  }
+
+  for (unsigned int c = 0; c < numCascades; ++c) {
+    ShadowCascade& cascade = m_cascades[c];
+    cascade.splitNear = splits[c];
+    cascade.splitFar = splits[c + 1];
+
+    float centerZ, sliceRadius;
+    fitSlice(cascade.splitNear, cascade.splitFar, tanX, tanY, centerZ, sliceRadius);
+    float center[3] = { eye[0] + forward[0] * centerZ,
+                        eye[1] + forward[1] * centerZ,
+                        eye[2] + forward[2] * centerZ };
+    float lightCenter[3] = { dot3(center, m_lightRight), dot3(center, m_lightUp), dot3(center, m_lightDir) };
+
+    // Radio con margen, redondeado para que el ruido de punto flotante no lo cambie
+    float radius = std::ceil(sliceRadius * (1.0f + m_settings.cacheMargin) * 16.0f) / 16.0f;
+
+    float dx = lightCenter[0] - cascade.anchor[0];
+    float dy = lightCenter[1] - cascade.anchor[1];
+    float dz = lightCenter[2] - cascade.anchor[2];
+    bool outside = std::sqrt(dx * dx + dy * dy + dz * dz) + sliceRadius > cascade.radius;
+
+    if (!cascade.anchored || m_lightChanged || radius != cascade.radius || outside) {
+      cascade.radius = radius;
+      cascade.texelSize = 2.0f * radius / m_settings.resolution;
+      for (int i = 0; i < 3; ++i) {
+        cascade.anchor[i] = std::floor(lightCenter[i] / cascade.texelSize + 0.5f) * cascade.texelSize;
+      }
+      cascade.anchored = true;
+      cascade.staticDirty = true;
+
+      float l = cascade.anchor[0] - radius, r = cascade.anchor[0] + radius;
+      float b = cascade.anchor[1] - radius, t = cascade.anchor[1] + radius;
+      float zn = cascade.anchor[2] - radius, zf = cascade.anchor[2] + radius;
+      XMFLOAT4X4& p = cascade.projection;
+      std::memset(&p, 0, sizeof(p));
+      p._11 = 2.0f / (r - l);
+      p._22 = 2.0f / (t - b);
+      p._33 = 1.0f / (zf - zn);
+      p._41 = (l + r) / (l - r);
+      p._42 = (t + b) / (b - t);
+      p._43 = zn / (zn - zf);
+      p._44 = 1.0f;
+      cascade.viewProjection = multiply(m_lightView, cascade.projection);
+    }
+    if (staticChanged || !m_settings.cacheStatic) {
+      cascade.staticDirty = true;
+    }
+  }
+  m_lightChanged = false;
+
+  // Culling y batches por cascada en paralelo
+  JobSystem::getInstance().parallelFor(numCascades, 1, [&](size_t begin, size_t end) {
+    for (size_t c = begin; c < end; ++c) {
+      ShadowCascade& cascade = m_cascades[c];
+      Timer timer;
+      if (cascade.staticDirty) {
+        cullLayer(cascade, m_staticLayer, cascade.staticCasters);
+        buildBatches(casters, cascade.staticCasters, cascade.staticBatches);
+      }
+      cullLayer(cascade, m_dynamicLayer, cascade.dynamicCasters);
+      buildBatches(casters, cascade.dynamicCasters, cascade.dynamicBatches);
+
+      ShadowCascadeStats& stats = cascade.stats;
+      stats.staticCasters = static_cast<unsigned int>(cascade.staticCasters.size());
+      stats.dynamicCasters = static_cast<unsigned int>(cascade.dynamicCasters.size());
+      stats.staticRedrawn = cascade.staticDirty;
+      stats.staticDraws = cascade.staticDirty ? static_cast<unsigned int>(cascade.staticBatches.size()) : 0;
+      stats.dynamicDraws = static_cast<unsigned int>(cascade.dynamicBatches.size());
+      stats.cullMs = timer.elapsedMs();
+      stats.submitMs = 0.0;
+    }
+  });
+
+  m_updateMs = total.elapsedMs();
+}
+
+void
+CascadedShadows::runBenchmark(BenchmarkReport& report) {
+  const unsigned int gridSize = 128;
+  const unsigned int numGeometries = 32;
+  const unsigned int numCars = 4000;
+  const float spacing = 8.0f;
+  const float fovY = XM_PIDIV4;
+  const float aspect = 16.0f / 9.0f;
+  const int numFrames = 300;
+
+  // Edificios estáticos en una rejilla y coches dinámicos sobre las calles
+  std::vector<ShadowGeometry> geometries(numGeometries);
+  std::vector<ShadowCaster> casters;
+  unsigned int seed = 777u;
+  auto random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / 16777216.0f;
+  };
+  auto makeCaster = [](float x, float y, float z, float radius, const ShadowGeometry* geometry, bool isStatic) {
+    ShadowCaster caster;
+    caster.center = XMFLOAT3(x, y, z);
+    caster.radius = radius;
+    std::memset(&caster.world, 0, sizeof(caster.world));
+    caster.world._11 = caster.world._22 = caster.world._33 = caster.world._44 = 1.0f;
+    caster.world._41 = x;
+    caster.world._42 = y;
+    caster.world._43 = z;
+    caster.geometry = geometry;
+    caster.isStatic = isStatic;
+    return caster;
+  };
+
+  const float half = gridSize * spacing * 0.5f;
+  for (unsigned int z = 0; z < gridSize; ++z) {
+    for (unsigned int x = 0; x < gridSize; ++x) {
+      float height = 4.0f + random() * 20.0f;
+      casters.push_back(makeCaster(x * spacing - half, height * 0.5f, z * spacing - half,
+                                   std::sqrt(8.0f + height * height * 0.25f),
+                                   &geometries[(x * 7 + z * 13) % numGeometries], true));
+    }
+  }
+  const size_t firstCar = casters.size();
+  std::vector<float> carSpeed(numCars);
+  for (unsigned int i = 0; i < numCars; ++i) {
+    float lane = std::floor(random() * gridSize) * spacing - half + spacing * 0.5f;
+    casters.push_back(makeCaster(lane, 0.8f, random() * 2.0f * half - half, 2.5f,
+                                 &geometries[i % 4], false));
+    carSpeed[i] = 5.0f + random() * 10.0f;
+  }
+
+  auto cameraView = [](float x, float z, float yaw) {
+    XMFLOAT4X4 view;
+    XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(x, 12.0f, z, 0.0f),
+                                            XMVectorSet(std::sin(yaw), -0.15f, std::cos(yaw), 0.0f),
+                                            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+    return view;
+  };
+
+  report.log("%u static + %u dynamic casters, %u geometries, %d frames, %u threads",
+             gridSize * gridSize, numCars, numGeometries, numFrames,
+             JobSystem::getInstance().getNumThreads());
+
+  for (int pass = 0; pass < 2; ++pass) {
+    CascadedShadows shadows;
+    CascadedShadowSettings settings;
+    settings.cacheStatic = pass == 1;
+    shadows.setSettings(settings);
+    shadows.setLightDirection(XMFLOAT3(0.4f, -0.8f, 0.45f));
+
+    std::vector<ShadowCaster> frameCasters = casters;
+    ShadowCascadeStats sum[kMaxShadowCascades];
+    unsigned int redraws[kMaxShadowCascades] = {};
+    unsigned int unbatched[kMaxShadowCascades] = {};
+    double updateMs = 0.0;
+    for (int f = 0; f < numFrames; ++f) {
+      float dt = 1.0f / 60.0f;
+      for (unsigned int i = 0; i < numCars; ++i) {
+        ShadowCaster& car = frameCasters[firstCar + i];
+        car.center.z += carSpeed[i] * dt;
+        if (car.center.z > half) {
+          car.center.z -= 2.0f * half;
+        }
+        car.world._43 = car.center.z;
+      }
+
+      // Avanza por una calle a 15 m/s mirando un poco a los lados
+      float time = f * dt;
+      XMFLOAT4X4 view = cameraView(4.0f, -300.0f + time * 15.0f, std::sin(time * 0.7f) * 0.6f);
+      shadows.update(view, fovY, aspect, 0.1f, 1000.0f, frameCasters);
+      updateMs += shadows.getUpdateMs();
+
+      for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+        const ShadowCascadeStats& stats = shadows.getCascade(c).stats;
+        sum[c].staticCasters += stats.staticCasters;
+        sum[c].dynamicCasters += stats.dynamicCasters;
+        sum[c].staticDraws += stats.staticDraws;
+        sum[c].dynamicDraws += stats.dynamicDraws;
+        sum[c].cullMs += stats.cullMs;
+        redraws[c] += stats.staticRedrawn ? 1 : 0;
+        unbatched[c] += stats.dynamicCasters + (stats.staticRedrawn ? stats.staticCasters : 0);
+        // Aquí el renderer dibujaría la capa estática
+        shadows.markStaticDrawn(c);
+      }
+    }
+
+    report.log("%s: update avg %.3f ms/frame", settings.cacheStatic ? "cached static" : "no cache",
+               updateMs / numFrames);
+    unsigned int totalDraws = 0;
+    unsigned int totalCasters = 0;
+    for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+      const ShadowCascade& cascade = shadows.getCascade(c);
+      unsigned int drawn = (sum[c].staticDraws + sum[c].dynamicDraws) / numFrames;
+      unsigned int casterDraws = unbatched[c] / numFrames;
+      totalDraws += drawn;
+      totalCasters += casterDraws;
+      report.log("  cascade %u [%6.1f, %6.1f] r %6.1f: %5u static, %4u dynamic casters, "
+                 "%3u draws/frame (%5u unbatched), static redrawn %3u/%d, cull %.3f ms",
+                 c, cascade.splitNear, cascade.splitFar, cascade.radius,
+                 sum[c].staticCasters / numFrames, sum[c].dynamicCasters / numFrames,
+                 drawn, casterDraws, redraws[c], numFrames, sum[c].cullMs / numFrames);
+    }
+    report.log("  total %u draws/frame vs %u one-draw-per-caster", totalDraws, totalCasters);
+  }
+
+  // Verificación 1: con un temblor pequeño de la cámara ninguna matriz cambia (la caché sirve),
+  // y con una vuelta completa el tamaño de las cascadas (y del texel) se mantiene
+  {
+    CascadedShadows shadows;
+    shadows.setSettings(CascadedShadowSettings());
+    shadows.setLightDirection(XMFLOAT3(0.4f, -0.8f, 0.45f));
+    shadows.update(cameraView(0.0f, 0.0f, 0.0f), fovY, aspect, 0.1f, 1000.0f, casters);
+    XMFLOAT4X4 first[kMaxShadowCascades];
+    float radius[kMaxShadowCascades];
+    for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+      first[c] = shadows.getCascade(c).viewProjection;
+      radius[c] = shadows.getCascade(c).radius;
+      shadows.markStaticDrawn(c);
+    }
+    bool cached = true;
+    for (int f = 1; f < 60; ++f) {
+      shadows.update(cameraView(0.05f * std::sin(f * 0.9f), 0.0f, 0.02f * std::sin(f * 0.5f)),
+                     fovY, aspect, 0.1f, 1000.0f, casters);
+      for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+        const ShadowCascade& cascade = shadows.getCascade(c);
+        cached = cached && !cascade.stats.staticRedrawn &&
+                 std::memcmp(&cascade.viewProjection, &first[c], sizeof(XMFLOAT4X4)) == 0;
+      }
+    }
+    bool sameSize = true;
+    unsigned int reanchors = 0;
+    for (int f = 0; f < 126; ++f) {
+      shadows.update(cameraView(0.0f, 0.0f, f * 0.05f), fovY, aspect, 0.1f, 1000.0f, casters);
+      for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+        sameSize = sameSize && shadows.getCascade(c).radius == radius[c];
+        reanchors += shadows.getCascade(c).stats.staticRedrawn ? 1 : 0;
+        shadows.markStaticDrawn(c);
+      }
+    }
+    report.log("camera jitter: cascades %s; full turn: size %s, %u re-anchors in 126 frames",
+               cached ? "unchanged" : "CHANGED", sameSize ? "constant" : "CHANGED", reanchors);
+    if (!cached) {
+      report.fail("cascade matrices changed under small camera jitter");
+    }
+    if (!sameSize) {
+      report.fail("cascade size changed while rotating the camera");
+    }
+  }
+
+  // Verificación 2: anclas en múltiplos del texel y culling igual a la prueba escalar
+  {
+    CascadedShadows shadows;
+    shadows.setSettings(CascadedShadowSettings());
+    shadows.setLightDirection(XMFLOAT3(0.4f, -0.8f, 0.45f));
+    shadows.update(cameraView(37.3f, -120.9f, 0.3f), fovY, aspect, 0.1f, 1000.0f, casters);
+
+    const XMFLOAT4X4& lightView = shadows.getLightView();
+    bool snapped = true;
+    bool culled = true;
+    for (unsigned int c = 0; c < shadows.getNumCascades(); ++c) {
+      const ShadowCascade& cascade = shadows.getCascade(c);
+      for (int i = 0; i < 2; ++i) {
+        float texels = cascade.anchor[i] / cascade.texelSize;
+        snapped = snapped && std::fabs(texels - std::floor(texels + 0.5f)) < 1e-2f;
+      }
+
+      std::vector<unsigned int> expected[2];
+      for (unsigned int i = 0; i < casters.size(); ++i) {
+        const ShadowCaster& caster = casters[i];
+        float x = caster.center.x * lightView._11 + caster.center.y * lightView._21 + caster.center.z * lightView._31;
+        float y = caster.center.x * lightView._12 + caster.center.y * lightView._22 + caster.center.z * lightView._32;
+        float z = caster.center.x * lightView._13 + caster.center.y * lightView._23 + caster.center.z * lightView._33;
+        if (std::fabs(x - cascade.anchor[0]) <= cascade.radius + caster.radius &&
+            std::fabs(y - cascade.anchor[1]) <= cascade.radius + caster.radius &&
+            z - caster.radius <= cascade.anchor[2] + cascade.radius) {
+          expected[caster.isStatic ? 1 : 0].push_back(i);
+        }
+      }
+      std::vector<unsigned int> got[2] = { cascade.dynamicCasters, cascade.staticCasters };
+      for (int layer = 0; layer < 2; ++layer) {
+        std::sort(got[layer].begin(), got[layer].end());
+        culled = culled && got[layer] == expected[layer];
+      }
+    }
+    report.log("texel snapping %s, SIMD culling %s", snapped ? "ok" : "WRONG", culled ? "matches scalar" : "DIFFERS");
+    if (!snapped) {
+      report.fail("cascade anchors are not texel aligned");
+    }
+    if (!culled) {
+      report.fail("SIMD shadow caster culling differs from scalar reference");
+    }
+  }
+}
@@ -0,0 +1,257 @@
+#include "Shadows/ShadowRenderer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "RenderStateCache.h"
+#include "Timer.h"
+
+namespace {
+
+  const unsigned int kShadowMapSlot = 7;
+  const unsigned int kShadowSamplerSlot = 1;
+  const unsigned int kShadowCascadesCBSlot = 4;
+  const unsigned int kShadowInstancesCBSlot = 5;
+
+} // namespace
+
+HRESULT
+ShadowRenderer::init(Device& device,
+                     const CascadedShadowSettings& settings,
+                     std::vector<D3D11_INPUT_ELEMENT_DESC> layout) {
+  if (!device.m_device) {
+    ERROR("ShadowRenderer", "init", "Device is nullptr");
+    return E_POINTER;
+  }
+  m_numCascades = std::min(std::max(settings.numCascades, 1u), kMaxShadowCascades);
+  m_resolution = settings.resolution;
+
+  // Capas [0, N) = mapa final, [N, 2N) = caché de estáticos
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.Width = m_resolution;
+  desc.Height = m_resolution;
+  desc.MipLevels = 1;
+  desc.ArraySize = m_numCascades * 2;
+  desc.Format = DXGI_FORMAT_R32_TYPELESS;
+  desc.SampleDesc.Count = 1;
+  desc.SampleDesc.Quality = 0;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+  desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+  HRESULT hr = device.CreateTexture2D(&desc, nullptr, &m_depthArray);
+  if (FAILED(hr)) {
+    ERROR("ShadowRenderer", "init", "Failed to create shadow map array");
+    return hr;
+  }
+
+  m_sliceViews.assign(m_numCascades * 2, nullptr);
+  for (unsigned int i = 0; i < m_numCascades * 2; ++i) {
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+    dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+    dsvDesc.Texture2DArray.MipSlice = 0;
+    dsvDesc.Texture2DArray.FirstArraySlice = i;
+    dsvDesc.Texture2DArray.ArraySize = 1;
+    hr = device.CreateDepthStencilView(m_depthArray, &dsvDesc, &m_sliceViews[i]);
+    if (FAILED(hr)) {
+      ERROR("ShadowRenderer", "init", "Failed to create shadow map slice view " << i);
+      return hr;
+    }
+  }
+
+  D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+  srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+  srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+  srvDesc.Texture2DArray.MostDetailedMip = 0;
+  srvDesc.Texture2DArray.MipLevels = 1;
+  srvDesc.Texture2DArray.FirstArraySlice = 0;
+  srvDesc.Texture2DArray.ArraySize = m_numCascades;
+  hr = device.m_device->CreateShaderResourceView(m_depthArray, &srvDesc, &m_shadowView);
+  if (FAILED(hr)) {
+    ERROR("ShadowRenderer", "init", "Failed to create shadow map shader resource view");
+    return hr;
+  }
+
+  D3D11_RASTERIZER_DESC rasterDesc = {};
+  rasterDesc.FillMode = D3D11_FILL_SOLID;
+  rasterDesc.CullMode = D3D11_CULL_BACK;
+  rasterDesc.DepthBias = 1000;
+  rasterDesc.SlopeScaledDepthBias = 1.5f;
+  rasterDesc.DepthBiasClamp = 0.0f;
+  rasterDesc.DepthClipEnable = FALSE;
+  m_rasterizer = RenderStateCache::getInstance().acquireRasterizer(rasterDesc);
+  if (!m_rasterizer) {
+    ERROR("ShadowRenderer", "init", "Failed to create shadow rasterizer state");
+    return E_FAIL;
+  }
+
+  D3D11_SAMPLER_DESC samplerDesc = {};
+  samplerDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+  samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+  samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+  samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+  samplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+  samplerDesc.BorderColor[0] = samplerDesc.BorderColor[1] = 1.0f;
+  samplerDesc.BorderColor[2] = samplerDesc.BorderColor[3] = 1.0f;
+  samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+  m_comparisonSampler = RenderStateCache::getInstance().acquireSampler(samplerDesc);
+  if (!m_comparisonSampler) {
+    ERROR("ShadowRenderer", "init", "Failed to create shadow comparison sampler");
+    return E_FAIL;
+  }
+
+  hr = m_shaderShadow.init(device, "ShadowMap.fx", layout);
+  if (FAILED(hr)) {
+    ERROR("ShadowRenderer", "init", "Failed to initialize ShadowMap.fx");
+    return hr;
+  }
+  hr = m_cbInstances.init(device, sizeof(CBShadowInstances));
+  if (FAILED(hr)) {
+    ERROR("ShadowRenderer", "init", "Failed to create CBShadowInstances");
+    return hr;
+  }
+  hr = m_cbCascades.init(device, sizeof(CBShadowCascades));
+  if (FAILED(hr)) {
+    ERROR("ShadowRenderer", "init", "Failed to create CBShadowCascades");
+    return hr;
+  }
+  return S_OK;
+}
+
+unsigned int
+ShadowRenderer::drawBatches(DeviceContext& deviceContext,
+                            const std::vector<ShadowDrawBatch>& batches,
+                            const std::vector<unsigned int>& list,
+                            const std::vector<ShadowCaster>& casters) {
+  unsigned int draws = 0;
+  for (const ShadowDrawBatch& batch : batches) {
+    const ShadowGeometry* geometry = batch.geometry;
+    if (!geometry) {
+      continue;
+    }
+    GeometryRange range;
+    range.vertexBuffer = geometry->vertexBuffer;
+    range.indexBuffer = geometry->indexBuffer;
+    range.indexFormat = geometry->indexFormat;
+    if (geometry->pooled.isValid() && !GeometryPool::getInstance().resolve(geometry->pooled, range)) {
+      continue;
+    }
+    if (!range.vertexBuffer || !range.indexBuffer) {
+      continue;
+    }
+    for (unsigned int i = 0; i < batch.count; ++i) {
+      XMFLOAT4X4 world = casters[list[batch.first + i]].world;
+      m_instances.mWorld[i] = XMMatrixTranspose(XMLoadFloat4x4(&world));
+    }
+    m_cbInstances.update(deviceContext, nullptr, 0, nullptr, &m_instances, 0, 0);
+
+    range.vertexBuffer->render(deviceContext, 0, 1);
+    range.indexBuffer->render(deviceContext, 0, 1, false, range.indexFormat);
+    deviceContext.m_deviceContext->DrawIndexedInstanced(geometry->indexCount, batch.count,
+                                                        range.startIndex, range.baseVertex, 0);
+    ++draws;
+  }
+  return draws;
+}
+
+void
+ShadowRenderer::render(DeviceContext& deviceContext,
+                       CascadedShadows& shadows,
+                       const std::vector<ShadowCaster>& casters) {
+  if (!m_depthArray || !deviceContext.m_deviceContext) {
+    return;
+  }
+
+  // El mapa no puede estar vinculado como SRV mientras escribo en él
+  ID3D11ShaderResourceView* nullView = nullptr;
+  deviceContext.m_deviceContext->PSSetShaderResources(kShadowMapSlot, 1, &nullView);
+
+  D3D11_VIEWPORT viewport = {};
+  viewport.Width = static_cast<float>(m_resolution);
+  viewport.Height = static_cast<float>(m_resolution);
+  viewport.MaxDepth = 1.0f;
+  deviceContext.RSSetViewports(1, &viewport);
+  deviceContext.RSSetState(m_rasterizer);
+  deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+  m_shaderShadow.render(deviceContext);
+  // Sin pixel shader: solo escribo profundidad
+  deviceContext.m_deviceContext->PSSetShader(nullptr, nullptr, 0);
+  m_cbInstances.render(deviceContext, kShadowInstancesCBSlot, 1);
+
+  const unsigned int numCascades = std::min(m_numCascades, shadows.getNumCascades());
+  for (unsigned int c = 0; c < numCascades; ++c) {
+    ShadowCascade& cascade = shadows.getCascade(c);
+    Timer timer;
+    m_instances.mLightViewProj = XMMatrixTranspose(XMLoadFloat4x4(&cascade.viewProjection));
+
+    ID3D11DepthStencilView* staticView = m_sliceViews[m_numCascades + c];
+    ID3D11DepthStencilView* finalView = m_sliceViews[c];
+
+    unsigned int staticDraws = 0;
+    if (cascade.staticDirty) {
+      deviceContext.m_deviceContext->OMSetRenderTargets(0, nullptr, staticView);
+      deviceContext.m_deviceContext->ClearDepthStencilView(staticView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+      staticDraws = drawBatches(deviceContext, cascade.staticBatches, cascade.staticCasters, casters);
+      shadows.markStaticDrawn(c);
+    }
+
+    // La copia de la caché es el fondo sobre el que van los dinámicos
+    deviceContext.m_deviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+    deviceContext.m_deviceContext->CopySubresourceRegion(m_depthArray, c, 0, 0, 0,
+                                                         m_depthArray, m_numCascades + c, nullptr);
+    deviceContext.m_deviceContext->OMSetRenderTargets(0, nullptr, finalView);
+    unsigned int dynamicDraws = drawBatches(deviceContext, cascade.dynamicBatches, cascade.dynamicCasters, casters);
+
+    cascade.stats.staticDraws = staticDraws;
+    cascade.stats.dynamicDraws = dynamicDraws;
+    cascade.stats.submitMs = timer.elapsedMs();
+
+    m_cascadeData.mCascadeViewProj[c] = m_instances.mLightViewProj;
+    (&m_cascadeData.vSplitFar.x)[c] = cascade.splitFar;
+    (&m_cascadeData.vTexelSize.x)[c] = cascade.texelSize;
+  }
+
+  deviceContext.m_deviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+  deviceContext.m_deviceContext->RSSetState(nullptr);
+  m_cbCascades.update(deviceContext, nullptr, 0, nullptr, &m_cascadeData, 0, 0);
+  m_cascadesRelative = false;
+}
+
+void
+ShadowRenderer::bind(DeviceContext& deviceContext, const XMFLOAT3* cameraOrigin) {
+  if (!m_shadowView) {
+    return;
+  }
+  if (cameraOrigin) {
+    // La posición que llega es relativa: mundo = relativa + origen, así que antepongo la traslación
+    CBShadowCascades relative = m_cascadeData;
+    const XMMATRIX toWorld = XMMatrixTranslation(cameraOrigin->x, cameraOrigin->y, cameraOrigin->z);
+    for (unsigned int c = 0; c < m_numCascades; ++c) {
+      relative.mCascadeViewProj[c] =
+        XMMatrixTranspose(XMMatrixMultiply(toWorld, XMMatrixTranspose(m_cascadeData.mCascadeViewProj[c])));
+    }
+    m_cbCascades.update(deviceContext, nullptr, 0, nullptr, &relative, 0, 0);
+    m_cascadesRelative = true;
+  }
+  else if (m_cascadesRelative) {
+    m_cbCascades.update(deviceContext, nullptr, 0, nullptr, &m_cascadeData, 0, 0);
+    m_cascadesRelative = false;
+  }
+  deviceContext.PSSetShaderResources(kShadowMapSlot, 1, &m_shadowView);
+  deviceContext.PSSetSamplers(kShadowSamplerSlot, 1, &m_comparisonSampler);
+  m_cbCascades.render(deviceContext, kShadowCascadesCBSlot, 1, true);
+}
+
+void
+ShadowRenderer::destroy() {
+  for (ID3D11DepthStencilView*& view : m_sliceViews) {
+    SAFE_RELEASE(view);
+  }
+  m_sliceViews.clear();
+  SAFE_RELEASE(m_shadowView);
+  SAFE_RELEASE(m_depthArray);
+  RenderStateCache::getInstance().release(m_rasterizer);
+  RenderStateCache::getInstance().release(m_comparisonSampler);
+  m_rasterizer = nullptr;
+  m_comparisonSampler = nullptr;
+  m_shaderShadow.destroy();
+  m_cbInstances.destroy();
+  m_cbCascades.destroy();
+}
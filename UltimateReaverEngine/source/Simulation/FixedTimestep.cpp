@@ -0,0 +1,271 @@
+#include "Simulation/FixedTimestep.h"
+#include "Simulation/SimulationReplay.h"
+#include "Particles/ParticleSystem.h"
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Timer.h"
+#include <cstdio>
+
+namespace {
+
+  /**
+   * @brief Mundo de prueba del benchmark: partículas más cuerpos empujados por el input.
+   */
+  struct
+    BenchWorld {
+    ParticleSystem particles;
+    std::vector<XMFLOAT3> bodyPosition;
+    std::vector<XMFLOAT3> bodyVelocity;
+
+    void
+      init(unsigned int numBodies) {
+      particles.addCollisionPlane(XMFLOAT4(0.0f, 1.0f, 0.0f, 0.0f), 0.5f);
+      for (unsigned int e = 0; e < 4; ++e) {
+        ParticleEmitterSettings settings;
+        settings.position = XMFLOAT3(-6.0f + 4.0f * e, 1.0f, 0.0f);
+        settings.maxParticles = 32768;
+        settings.spawnRate = 8000.0f;
+        settings.lifetimeMin = 1.0f;
+        settings.lifetimeMax = 2.5f;
+        particles.addEmitter(settings);
+      }
+      bodyPosition.resize(numBodies);
+      bodyVelocity.assign(numBodies, XMFLOAT3(0.0f, 0.0f, 0.0f));
+      for (unsigned int i = 0; i < numBodies; ++i) {
+        bodyPosition[i] = XMFLOAT3(static_cast<float>(i % 64) - 32.0f, 1.0f,
+                                   static_cast<float>(i / 64) - 32.0f);
+      }
+    }
+
+    void
+      step(const SimulationInput& input, float dt) {
+      if (input.buttons & SIM_BUTTON_PRIMARY) {
+        particles.burst(0, 2048);
+      }
+      if (input.buttons & SIM_BUTTON_SECONDARY) {
+        particles.burst(3, 2048);
+      }
+      particles.simulate(dt);
+
+      const float accelX = input.axisX * 20.0f;
+      const float accelZ = input.axisY * 20.0f;
+      const float damping = 1.0f - 0.5f * dt;
+      JobSystem::getInstance().parallelFor(bodyPosition.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          XMFLOAT3& p = bodyPosition[i];
+          XMFLOAT3& v = bodyVelocity[i];
+          v.x = (v.x + accelX * dt) * damping;
+          v.y = (v.y - 9.8f * dt) * damping;
+          v.z = (v.z + accelZ * dt) * damping;
+          p.x += v.x * dt;
+          p.y += v.y * dt;
+          p.z += v.z * dt;
+          if (p.y < 0.0f) { p.y = 0.0f; v.y = -v.y * 0.6f; }
+          if (p.x < -50.0f || p.x > 50.0f) { p.x = p.x < 0.0f ? -50.0f : 50.0f; v.x = -v.x * 0.5f; }
+          if (p.z < -50.0f || p.z > 50.0f) { p.z = p.z < 0.0f ? -50.0f : 50.0f; v.z = -v.z * 0.5f; }
+        }
+      });
+    }
+
+    unsigned long long
+      hash() const {
+      StateHasher hasher;
+      particles.hashState(hasher);
+      hasher.add(bodyPosition.data(), bodyPosition.size() * sizeof(XMFLOAT3));
+      hasher.add(bodyVelocity.data(), bodyVelocity.size() * sizeof(XMFLOAT3));
+      return hasher.getHash();
+    }
+  };
+
+  /// @brief Input "en vivo" del benchmark: pseudoaleatorio pero fijo por tick.
+  SimulationInput
+    benchInput(unsigned int tick) {
+    unsigned int h = tick * 2654435761u;
+    h ^= h >> 15;
+    SimulationInput input;
+    input.buttons = (h & 0x70) == 0 ? SIM_BUTTON_PRIMARY : 0;
+    input.buttons |= (h & 0x380) == 0 ? SIM_BUTTON_SECONDARY : 0;
+    input.axisX = static_cast<float>((h >> 10) & 0xFF) / 127.5f - 1.0f;
+    input.axisY = static_cast<float>((h >> 18) & 0xFF) / 127.5f - 1.0f;
+    return input;
+  }
+
+  /**
+   * @brief Corro `numTicks` pasos con el ritmo de frames dado por `frameTime(frame)`.
+   */
+  template<typename FrameTimeFunc>
+  void
+    runSession(FixedTimestep& clock, SimulationReplay& replay, BenchWorld& world,
+               unsigned int numTicks, FrameTimeFunc frameTime,
+               double& stepMs, double& hashMs, unsigned int& frames,
+               unsigned int& maxSteps, unsigned int& badAlpha) {
+    clock.reset();
+    unsigned int tick = 0;
+    while (tick < numTicks) {
+      const unsigned int steps = clock.advance(frameTime(frames));
+      ++frames;
+      maxSteps = std::max(maxSteps, steps);
+      const float alpha = clock.getAlpha();
+      badAlpha += (alpha < 0.0f || alpha > 1.0f) ? 1 : 0;
+      for (unsigned int s = 0; s < steps && tick < numTicks; ++s, ++tick) {
+        SimulationInput input = replay.beginTick(benchInput(tick));
+        Timer timer;
+        world.step(input, clock.getStepSeconds());
+        stepMs += timer.elapsedMs();
+        timer.reset();
+        unsigned long long hash = world.hash();
+        hashMs += timer.elapsedMs();
+        replay.endTick(hash);
+      }
+    }
+  }
+
+} // namespace
+
+void
+FixedTimestep::setSettings(const FixedTimestepSettings& settings) {
+  m_settings = settings;
+  if (m_settings.stepSeconds <= 0.0) {
+    ERROR("FixedTimestep", "setSettings", "stepSeconds must be positive, using 1/60");
+    m_settings.stepSeconds = 1.0 / 60.0;
+  }
+  if (m_settings.maxStepsPerFrame == 0) {
+    m_settings.maxStepsPerFrame = 1;
+  }
+  reset();
+}
+
+void
+FixedTimestep::reset() {
+  m_accumulator = 0.0;
+  m_tick = 0;
+  m_stats = FixedTimestepStats();
+}
+
+unsigned int
+FixedTimestep::advance(double frameSeconds) {
+  bool dropped = false;
+  double frame = std::max(frameSeconds, 0.0);
+  if (frame > m_settings.maxFrameSeconds) {
+    m_stats.droppedSeconds += frame - m_settings.maxFrameSeconds;
+    frame = m_settings.maxFrameSeconds;
+    dropped = true;
+  }
+  m_accumulator += frame;
+
+  unsigned int steps = static_cast<unsigned int>(m_accumulator / m_settings.stepSeconds);
+  if (steps > m_settings.maxStepsPerFrame) {
+    // Espiral de la muerte: tiro lo que no alcanzo y me quedo con la fracción
+    const double excess = (steps - m_settings.maxStepsPerFrame) * m_settings.stepSeconds;
+    m_accumulator -= excess;
+    m_stats.droppedSeconds += excess;
+    steps = m_settings.maxStepsPerFrame;
+    dropped = true;
+  }
+  m_accumulator = std::max(m_accumulator - steps * m_settings.stepSeconds, 0.0);
+
+  m_tick += steps;
+  m_stats.steps = steps;
+  m_stats.droppedFrames += dropped ? 1 : 0;
+  return steps;
+}
+
+float
+FixedTimestep::getAlpha() const {
+  return std::min(static_cast<float>(m_accumulator / m_settings.stepSeconds), 1.0f);
+}
+
+void
+FixedTimestep::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numTicks = 1200;
+  const unsigned int numBodies = 16384;
+  const char* replayPath = "benchmark_replay.bin";
+
+  FixedTimestep clock;
+  clock.setSettings(FixedTimestepSettings());
+  report.log("%u ticks at %.0f Hz, 4 emitters + %u bodies, %u threads",
+             numTicks, 1.0 / clock.getSettings().stepSeconds, numBodies,
+             JobSystem::getInstance().getNumThreads());
+
+  // 1) Grabo con frames irregulares y un tirón de medio segundo cada 97 frames
+  BenchWorld recorded;
+  recorded.init(numBodies);
+  SimulationReplay replay;
+  replay.startRecording();
+  unsigned int random = 12345u;
+  auto jitteryFrame = [&](unsigned int frame) {
+    random = random * 1664525u + 1013904223u;
+    if (frame % 97 == 96) {
+      return 0.5;
+    }
+    return 0.005 + 0.030 * static_cast<double>(random >> 8) / 16777216.0;
+  };
+  double stepMs = 0.0;
+  double hashMs = 0.0;
+  unsigned int frames = 0;
+  unsigned int maxSteps = 0;
+  unsigned int badAlpha = 0;
+  runSession(clock, replay, recorded, numTicks, jitteryFrame, stepMs, hashMs, frames, maxSteps, badAlpha);
+  report.log("record: %u frames, max %u steps/frame, %u frames clamped, %.3f s dropped by the guard",
+             frames, maxSteps, clock.getStats().droppedFrames, clock.getStats().droppedSeconds);
+  report.log("simulation %.3f ms/tick, state hash %.3f ms/tick",
+             stepMs / numTicks, hashMs / numTicks);
+  if (maxSteps > clock.getSettings().maxStepsPerFrame) {
+    report.fail("a frame ran more steps than maxStepsPerFrame");
+  }
+  if (clock.getStats().droppedFrames == 0) {
+    report.fail("the spiral-of-death guard never triggered on the hitches");
+  }
+
+  if (FAILED(replay.saveToFile(replayPath))) {
+    report.fail("could not save the replay");
+    return;
+  }
+
+  // 2) Reproduzco desde archivo a 144 Hz (muchos frames sin pasos) con input vivo vacío
+  SimulationReplay playback;
+  if (FAILED(playback.loadFromFile(replayPath)) || !playback.startPlayback()) {
+    report.fail("could not load the replay");
+    return;
+  }
+  std::remove(replayPath);
+  BenchWorld replayed;
+  replayed.init(numBodies);
+  double replayStepMs = 0.0;
+  double replayHashMs = 0.0;
+  unsigned int replayFrames = 0;
+  unsigned int replayMaxSteps = 0;
+  auto fastFrame = [](unsigned int) { return 1.0 / 144.0; };
+  // El input vivo se ignora: el replay manda el grabado
+  runSession(clock, playback, replayed, numTicks, fastFrame,
+             replayStepMs, replayHashMs, replayFrames, replayMaxSteps, badAlpha);
+  report.log("playback: %u frames at 144 Hz, %u/%u ticks matched, simulation %.3f ms/tick",
+             replayFrames, playback.getTick() - playback.getMismatches(), playback.getNumTicks(),
+             replayStepMs / numTicks);
+  if (playback.getMismatches() != 0) {
+    report.fail("replay diverged at tick " + std::to_string(playback.getFirstMismatch()) +
+                " (" + std::to_string(playback.getMismatches()) + " ticks differ)");
+  }
+  if (replayed.hash() != recorded.hash()) {
+    report.fail("final state differs between record and playback");
+  }
+  if (badAlpha) {
+    report.fail(std::to_string(badAlpha) + " frames with interpolation alpha outside [0, 1]");
+  }
+
+  // 3) Un solo input cambiado tiene que aparecer en el hash justo en ese tick
+  const unsigned int tamperTick = numTicks / 2;
+  SimulationInput tampered = benchInput(tamperTick);
+  tampered.buttons ^= SIM_BUTTON_PRIMARY;
+  replay.setInput(tamperTick, tampered);
+  replay.startPlayback();
+  BenchWorld diverged;
+  diverged.init(numBodies);
+  frames = 0;
+  runSession(clock, replay, diverged, numTicks, fastFrame, stepMs, hashMs, frames, maxSteps, badAlpha);
+  report.log("tampered input at tick %u: first mismatch at tick %u",
+             tamperTick, replay.getFirstMismatch());
+  if (replay.getFirstMismatch() != tamperTick) {
+    report.fail("state hash did not catch the tampered input at tick " + std::to_string(tamperTick));
+  }
+}
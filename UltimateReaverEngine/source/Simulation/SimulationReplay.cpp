@@ -0,0 +1,126 @@
+#include "Simulation/SimulationReplay.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+  /// @brief Encabezado del archivo de replay.
+  struct
+    ReplayHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int numTicks;
+  };
+
+  const char kReplayMagic[4] = { 'U', 'R', 'R', 'P' };
+  const unsigned int kReplayVersion = 1;
+
+} // namespace
+
+void
+SimulationReplay::startRecording() {
+  m_inputs.clear();
+  m_hashes.clear();
+  m_tick = 0;
+  m_mismatches = 0;
+  m_firstMismatch = 0;
+  m_mode = REPLAY_RECORD;
+}
+
+bool
+SimulationReplay::startPlayback() {
+  if (m_inputs.empty()) {
+    ERROR("SimulationReplay", "startPlayback", "Nothing recorded");
+    return false;
+  }
+  m_tick = 0;
+  m_mismatches = 0;
+  m_firstMismatch = getNumTicks();
+  m_mode = REPLAY_PLAYBACK;
+  return true;
+}
+
+SimulationInput
+SimulationReplay::beginTick(const SimulationInput& live) {
+  if (m_mode == REPLAY_RECORD) {
+    m_inputs.push_back(live);
+    return live;
+  }
+  if (m_mode == REPLAY_PLAYBACK) {
+    if (m_tick < m_inputs.size()) {
+      return m_inputs[m_tick];
+    }
+    m_mode = REPLAY_OFF;
+  }
+  return live;
+}
+
+void
+SimulationReplay::endTick(unsigned long long stateHash) {
+  if (m_mode == REPLAY_RECORD) {
+    m_hashes.push_back(stateHash);
+  }
+  else if (m_mode == REPLAY_PLAYBACK) {
+    if (m_hashes[m_tick] != stateHash) {
+      if (m_mismatches == 0) {
+        m_firstMismatch = m_tick;
+        ERROR("SimulationReplay", "endTick", "Simulation diverged from the recording at tick " << m_tick);
+      }
+      ++m_mismatches;
+    }
+  }
+  else {
+    return;
+  }
+  ++m_tick;
+}
+
+HRESULT
+SimulationReplay::saveToFile(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    ERROR("SimulationReplay", "saveToFile", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  ReplayHeader header;
+  memcpy(header.magic, kReplayMagic, sizeof(kReplayMagic));
+  header.version = kReplayVersion;
+  header.numTicks = static_cast<unsigned int>(m_hashes.size());
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(m_inputs.data()), header.numTicks * sizeof(SimulationInput));
+  file.write(reinterpret_cast<const char*>(m_hashes.data()), header.numTicks * sizeof(unsigned long long));
+  if (!file) {
+    ERROR("SimulationReplay", "saveToFile", "Failed to write " << path.c_str());
+    return E_FAIL;
+  }
+  return S_OK;
+}
+
+HRESULT
+SimulationReplay::loadFromFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ERROR("SimulationReplay", "loadFromFile", "Can't open " << path.c_str());
+    return E_FAIL;
+  }
+  ReplayHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || memcmp(header.magic, kReplayMagic, sizeof(kReplayMagic)) != 0 ||
+      header.version != kReplayVersion) {
+    ERROR("SimulationReplay", "loadFromFile", path.c_str() << " is not a replay file");
+    return E_INVALIDARG;
+  }
+  std::vector<SimulationInput> inputs(header.numTicks);
+  std::vector<unsigned long long> hashes(header.numTicks);
+  file.read(reinterpret_cast<char*>(inputs.data()), header.numTicks * sizeof(SimulationInput));
+  file.read(reinterpret_cast<char*>(hashes.data()), header.numTicks * sizeof(unsigned long long));
+  if (!file) {
+    ERROR("SimulationReplay", "loadFromFile", path.c_str() << " is truncated");
+    return E_FAIL;
+  }
+  m_inputs.swap(inputs);
+  m_hashes.swap(hashes);
+  m_mode = REPLAY_OFF;
+  m_tick = 0;
+  return S_OK;
+}
@@ -0,0 +1,216 @@
+#include "EngineUtilities/Memory/TLSFAllocator.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+  /**
+   * @brief Una operación de la carga de memoria: asignar `size` bytes en `slot` o liberar lo que tenga.
+   */
+  struct
+    MemoryOp {
+    unsigned int slot;
+    unsigned int size;
+  };
+
+  /**
+   * @brief Carga mezclada: 70% de 16-256 B, 25% de 256 B-4 KB y 5% de 4-64 KB.
+   *
+   * @details `size` 0 = liberar. Cada slot alterna entre asignar y liberar.
+   */
+  std::vector<MemoryOp>
+    makeMemoryOps(unsigned int count, unsigned int slots, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<unsigned int> pickSlot(0, slots - 1);
+    std::uniform_int_distribution<unsigned int> bucket(0, 99);
+    std::vector<bool> live(slots, false);
+    std::vector<MemoryOp> ops;
+    ops.reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+      MemoryOp op = { pickSlot(rng), 0 };
+      if (!live[op.slot]) {
+        const unsigned int b = bucket(rng);
+        const unsigned int lo = b < 70 ? 16 : (b < 95 ? 256 : 4096);
+        const unsigned int hi = b < 70 ? 256 : (b < 95 ? 4096 : 65536);
+        op.size = std::uniform_int_distribution<unsigned int>(lo, hi)(rng);
+      }
+      live[op.slot] = !live[op.slot];
+      ops.push_back(op);
+    }
+    return ops;
+  }
+
+  /**
+   * @brief Corro la carga con `allocate(size)` / `release(pointer)` y escribo en cada bloque
+   *        para verificar que nadie pise a nadie.
+   *
+   * @return Bloques corruptos o asignaciones que fallaron.
+   */
+  template<typename Allocate, typename Release>
+  unsigned int
+    runMemoryOps(const std::vector<MemoryOp>& ops, unsigned int slots, Allocate allocate, Release release) {
+    std::vector<unsigned char*> pointers(slots, nullptr);
+    std::vector<unsigned int> sizes(slots, 0);
+    unsigned int errors = 0;
+    for (const MemoryOp& op : ops) {
+      unsigned char*& pointer = pointers[op.slot];
+      if (op.size > 0) {
+        pointer = static_cast<unsigned char*>(allocate(op.size));
+        sizes[op.slot] = op.size;
+        if (!pointer) {
+          ++errors;
+          continue;
+        }
+        pointer[0] = static_cast<unsigned char>(op.slot);
+        pointer[op.size - 1] = static_cast<unsigned char>(op.slot >> 8);
+      }
+      else if (pointer) {
+        if (pointer[0] != static_cast<unsigned char>(op.slot) ||
+            pointer[sizes[op.slot] - 1] != static_cast<unsigned char>(op.slot >> 8)) {
+          ++errors;
+        }
+        release(pointer);
+        pointer = nullptr;
+      }
+    }
+    for (unsigned char* pointer : pointers) {
+      if (pointer) {
+        release(pointer);
+      }
+    }
+    return errors;
+  }
+} // namespace
+
+/**
+ * @brief TLSF contra malloc con tamaños mezclados.
+ *
+ * @details
+ *  Mido la variante de un solo hilo y la de candado sobre la misma carga, la
+ *  fragmentación de los rangos de offsets a media carga y varios hilos sobre un
+ *  asignador compartido.
+ */
+template<>
+void
+EU::TLSFAllocator<EU::NullMutex>::runBenchmark(BenchmarkReport& report) {
+  const unsigned int numOps = 1000000;
+  const unsigned int slots = 16384;
+  const size_t arenaBytes = 128ull << 20;
+  const std::vector<MemoryOp> ops = makeMemoryOps(numOps, slots, 7);
+
+  Timer timer;
+  unsigned int errors = runMemoryOps(ops, slots,
+    [](size_t size) { return std::malloc(size); },
+    [](void* pointer) { std::free(pointer); });
+  const double mallocMs = timer.elapsedMs();
+  if (errors) {
+    report.fail("malloc run had " + std::to_string(errors) + " errors");
+  }
+
+  std::vector<unsigned char> arena(arenaBytes);
+  EU::TLSFAllocatorST single;
+  single.init(arena.data(), arena.size());
+  timer.reset();
+  errors = runMemoryOps(ops, slots,
+    [&](size_t size) { return single.allocateMemory(size); },
+    [&](void* pointer) { single.freeMemory(pointer); });
+  const double singleMs = timer.elapsedMs();
+  if (errors) {
+    report.fail("TLSF single-thread run had " + std::to_string(errors) + " errors");
+  }
+  const EU::TLSFStats after = single.getStats();
+  if (after.used != 0 || after.freeBlocks != 1 || after.allocations != 0) {
+    report.fail("TLSF did not merge back into a single free block");
+  }
+
+  EU::TLSFAllocatorMT shared;
+  shared.init(arena.data(), arena.size());
+  timer.reset();
+  errors = runMemoryOps(ops, slots,
+    [&](size_t size) { return shared.allocateMemory(size); },
+    [&](void* pointer) { shared.freeMemory(pointer); });
+  const double sharedMs = timer.elapsedMs();
+  if (errors) {
+    report.fail("TLSF thread-safe run had " + std::to_string(errors) + " errors");
+  }
+
+  report.log("%u mixed-size ops (16 B - 64 KB, %u slots):", numOps, slots);
+  report.log("  malloc/free        %7.2f ms (%5.1f ns/op)", mallocMs, mallocMs * 1.0e6 / numOps);
+  report.log("  TLSF single-thread %7.2f ms (%5.1f ns/op, %.2fx malloc)", singleMs, singleMs * 1.0e6 / numOps, mallocMs / singleMs);
+  report.log("  TLSF thread-safe   %7.2f ms (%5.1f ns/op, %.2fx malloc)", sharedMs, sharedMs * 1.0e6 / numOps, mallocMs / sharedMs);
+
+  // Fragmentación a media carga: dejo vivos los slots de la primera mitad de las operaciones
+  std::vector<EU::TLSFAllocation> live(slots);
+  EU::TLSFAllocatorST ranges;
+  ranges.init(arenaBytes, 256);
+  unsigned int failed = 0;
+  timer.reset();
+  for (unsigned int i = 0; i < numOps / 2; ++i) {
+    const MemoryOp& op = ops[i];
+    if (op.size > 0) {
+      live[op.slot] = ranges.allocate(op.size);
+      failed += live[op.slot].isValid() ? 0 : 1;
+    }
+    else {
+      ranges.free(live[op.slot]);
+      live[op.slot] = EU::TLSFAllocation();
+    }
+  }
+  const double rangesMs = timer.elapsedMs();
+  const EU::TLSFStats half = ranges.getStats();
+  report.log("  offset ranges (GPU heap, 256 B units) %.2f ms (%.1f ns/op): %u live, %.1f MB used, fragmentation %.2f (%u free blocks)",
+             rangesMs, rangesMs * 1.0e6 / (numOps / 2), half.allocations, half.used / (1024.0 * 1024.0),
+             half.fragmentation, half.freeBlocks);
+  if (failed) {
+    report.fail("offset-range allocations failed: " + std::to_string(failed));
+  }
+  // Alineación: el offset respeta lo pedido
+  EU::TLSFAllocation aligned = ranges.allocate(1000, 65536);
+  if (!aligned.isValid() || aligned.offset % 65536 != 0) {
+    report.fail("aligned allocation is not aligned");
+  }
+  ranges.free(aligned);
+
+  // Varios hilos sobre el mismo asignador (con candado) contra malloc
+  const unsigned int numThreads = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+  const unsigned int threadSlots = slots / numThreads;
+  std::vector<std::vector<MemoryOp>> threadOps;
+  for (unsigned int t = 0; t < numThreads; ++t) {
+    threadOps.push_back(makeMemoryOps(numOps / numThreads, threadSlots, 100 + t));
+  }
+  auto runThreads = [&](auto allocate, auto release) {
+    std::vector<std::thread> threads;
+    std::vector<unsigned int> threadErrors(numThreads, 0);
+    Timer threadTimer;
+    for (unsigned int t = 0; t < numThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        threadErrors[t] = runMemoryOps(threadOps[t], threadSlots, allocate, release);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    unsigned int total = 0;
+    for (unsigned int e : threadErrors) {
+      total += e;
+    }
+    if (total) {
+      report.fail("multithreaded run had " + std::to_string(total) + " errors");
+    }
+    return threadTimer.elapsedMs();
+  };
+  shared.init(arena.data(), arena.size());
+  const double mallocThreadsMs = runThreads([](size_t size) { return std::malloc(size); },
+                                            [](void* pointer) { std::free(pointer); });
+  const double sharedThreadsMs = runThreads([&](size_t size) { return shared.allocateMemory(size); },
+                                            [&](void* pointer) { shared.freeMemory(pointer); });
+  report.log("  %u threads: malloc %.2f ms, TLSF thread-safe %.2f ms (%.2fx)",
+             numThreads, mallocThreadsMs, sharedThreadsMs, mallocThreadsMs / sharedThreadsMs);
+  if (shared.getStats().used != 0) {
+    report.fail("thread-safe TLSF leaked after the multithreaded run");
+  }
+}
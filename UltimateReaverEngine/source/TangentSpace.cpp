@@ -0,0 +1,565 @@
+#include "TangentSpace.h"
+#include "JobSystem.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+  XMFLOAT3
+    add(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x + b.x, a.y + b.y, a.z + b.z); }
+
+  XMFLOAT3
+    sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+
+  XMFLOAT3
+    scale(const XMFLOAT3& a, float s) { return XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+
+  float
+    dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+  XMFLOAT3
+    cross(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+  }
+
+  /// @brief Normalizo; un vector (casi) nulo se queda en cero.
+  XMFLOAT3
+    normalize(const XMFLOAT3& a) {
+    const float length = std::sqrt(dot(a, a));
+    return length > FLT_MIN ? scale(a, 1.0f / length) : XMFLOAT3(0.0f, 0.0f, 0.0f);
+  }
+
+  /// @brief Quito la componente sobre `n` (unitaria).
+  XMFLOAT3
+    project(const XMFLOAT3& a, const XMFLOAT3& n) { return sub(a, scale(n, dot(n, a))); }
+
+  /// @brief Ángulo entre dos vectores ya normalizados (0 si alguno es nulo).
+  float
+    angleBetween(const XMFLOAT3& a, const XMFLOAT3& b) {
+    return std::acos(std::max(-1.0f, std::min(1.0f, dot(a, b))));
+  }
+
+  /// @brief Cualquier tangente unitaria perpendicular a `n` (vértices sin UV útil).
+  XMFLOAT3
+    anyTangent(const XMFLOAT3& n) {
+    const XMFLOAT3 axis = std::fabs(n.x) < 0.9f ? XMFLOAT3(1.0f, 0.0f, 0.0f) : XMFLOAT3(0.0f, 1.0f, 0.0f);
+    return normalize(project(axis, n));
+  }
+
+  struct
+    PositionKey {
+    XMFLOAT3 position;
+  };
+
+  /// @brief Lo que MikkTSpace compara para soldar vértices.
+  struct
+    VertexKey {
+    XMFLOAT3 position;
+    XMFLOAT3 normal;
+    XMFLOAT2 uv;
+  };
+
+  unsigned long long
+    hashBytes(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+      unsigned int word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+      hash ^= hash >> 29;
+    }
+    return hash ^ (hash >> 32);
+  }
+
+  /**
+   * @brief Soldo llaves idénticas (bit a bit) con una tabla de direccionamiento abierto.
+   *
+   * @return Número de clases; `classOf[i]` es la clase de la llave `i` (en orden de aparición).
+   */
+  template<typename Key>
+  unsigned int
+    weld(const std::vector<Key>& keys, std::vector<unsigned int>& classOf) {
+    size_t capacity = 16;
+    while (capacity < keys.size() * 2) {
+      capacity <<= 1;
+    }
+    const size_t mask = capacity - 1;
+    std::vector<unsigned int> table(capacity, 0xFFFFFFFF);
+    classOf.resize(keys.size());
+    unsigned int classes = 0;
+    for (unsigned int i = 0; i < keys.size(); ++i) {
+      size_t slot = static_cast<size_t>(hashBytes(&keys[i], sizeof(Key))) & mask;
+      for (;;) {
+        const unsigned int other = table[slot];
+        if (other == 0xFFFFFFFF) {
+          table[slot] = i;
+          classOf[i] = classes++;
+          break;
+        }
+        if (std::memcmp(&keys[other], &keys[i], sizeof(Key)) == 0) {
+          classOf[i] = classOf[other];
+          break;
+        }
+        slot = (slot + 1) & mask;
+      }
+    }
+    return classes;
+  }
+
+  /**
+   * @brief Agrupo las esquinas por grupo (counting sort estable: orden fijo para sumar).
+   */
+  void
+    groupCorners(const std::vector<unsigned int>& cornerGroup,
+                 unsigned int groups,
+                 std::vector<unsigned int>& offsets,
+                 std::vector<unsigned int>& corners) {
+    offsets.assign(groups + 1, 0);
+    for (unsigned int group : cornerGroup) {
+      ++offsets[group + 1];
+    }
+    for (unsigned int g = 0; g < groups; ++g) {
+      offsets[g + 1] += offsets[g];
+    }
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    corners.resize(cornerGroup.size());
+    for (unsigned int c = 0; c < cornerGroup.size(); ++c) {
+      corners[cursor[cornerGroup[c]]++] = c;
+    }
+  }
+
+  /**
+   * @brief Sumo (en orden) las contribuciones de las esquinas de cada grupo y normalizo.
+   */
+  void
+    sumGroups(const std::vector<XMFLOAT3>& contribution,
+              const std::vector<unsigned int>& offsets,
+              const std::vector<unsigned int>& corners,
+              std::vector<XMFLOAT3>& result) {
+    const size_t groups = offsets.size() - 1;
+    result.resize(groups);
+    JobSystem::getInstance().parallelFor(groups, 4096, [&](size_t begin, size_t end) {
+      for (size_t g = begin; g < end; ++g) {
+        XMFLOAT3 sum(0.0f, 0.0f, 0.0f);
+        for (unsigned int i = offsets[g]; i < offsets[g + 1]; ++i) {
+          sum = add(sum, contribution[corners[i]]);
+        }
+        result[g] = normalize(sum);
+      }
+    });
+  }
+
+  /// @brief ¿La normal importada sirve? (las mallas sin normales la traen en cero).
+  bool
+    hasNormal(const SimpleVertex& v) {
+    return dot(v.Normal, v.Normal) > 1.0e-12f;
+  }
+}
+
+TangentSpaceStats
+TangentSpace::generate(std::vector<MeshComponent>& meshes, const TangentSpaceSettings& settings) {
+  // Una malla por job; dentro de cada una los rangos de triángulos corren en línea
+  std::vector<TangentSpaceStats> perMesh(meshes.size());
+  JobSystem::getInstance().parallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      perMesh[i] = generate(meshes[i], settings);
+    }
+  });
+  TangentSpaceStats stats;
+  for (const TangentSpaceStats& mesh : perMesh) {
+    stats.meshes += mesh.meshes;
+    stats.triangles += mesh.triangles;
+    stats.generatedNormals += mesh.generatedNormals;
+    stats.splitVertices += mesh.splitVertices;
+    stats.degenerateTriangles += mesh.degenerateTriangles;
+  }
+  return stats;
+}
+
+TangentSpaceStats
+TangentSpace::generate(MeshComponent& mesh, const TangentSpaceSettings& settings) {
+  TangentSpaceStats stats;
+  stats.meshes = 1;
+  const size_t numVertices = mesh.m_vertex.size();
+  const size_t triangles = mesh.m_index.size() / 3;
+  const size_t numCorners = triangles * 3;
+  stats.triangles = static_cast<unsigned int>(triangles);
+  if (triangles == 0) {
+    return stats;
+  }
+  for (size_t c = 0; c < numCorners; ++c) {
+    if (mesh.m_index[c] >= numVertices) {
+      ERROR("TangentSpace", "generate", "Mesh " << mesh.m_name.c_str() << " has an index out of range");
+      return stats;
+    }
+  }
+  JobSystem& jobs = JobSystem::getInstance();
+  // Acotado a la malla: un grano enorme (todo en un bloque) desbordaría el número de bloques
+  const size_t grain = std::min(std::max<size_t>(settings.grainSize, 1), triangles);
+  std::vector<SimpleVertex>& vertices = mesh.m_vertex;
+  const std::vector<unsigned int>& indices = mesh.m_index;
+  std::vector<XMFLOAT3> contribution(numCorners);
+  std::vector<unsigned int> cornerGroup(numCorners);
+  std::vector<unsigned int> offsets;
+  std::vector<unsigned int> corners;
+  std::vector<XMFLOAT3> sums;
+
+  // 1) Normales: suavizo entre vértices con la misma posición
+  std::vector<unsigned char> needsNormal(numVertices, 0);
+  for (size_t v = 0; v < numVertices; ++v) {
+    needsNormal[v] = (settings.recomputeNormals || !hasNormal(vertices[v])) ? 1 : 0;
+    stats.generatedNormals += needsNormal[v];
+  }
+  if (stats.generatedNormals > 0) {
+    std::vector<PositionKey> keys(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+      keys[v].position = vertices[v].Pos;
+    }
+    std::vector<unsigned int> positionClass;
+    const unsigned int classes = weld(keys, positionClass);
+
+    jobs.parallelFor(triangles, grain, [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; ++t) {
+        const XMFLOAT3* p[3] = { &vertices[indices[t * 3]].Pos, &vertices[indices[t * 3 + 1]].Pos,
+                                 &vertices[indices[t * 3 + 2]].Pos };
+        // |cross| = 2 * área
+        const XMFLOAT3 face = cross(sub(*p[1], *p[0]), sub(*p[2], *p[0]));
+        for (unsigned int k = 0; k < 3; ++k) {
+          float weight = 1.0f;
+          XMFLOAT3 direction = face;
+          if (settings.weighting != NORMAL_WEIGHT_AREA) {
+            weight = angleBetween(normalize(sub(*p[(k + 1) % 3], *p[k])), normalize(sub(*p[(k + 2) % 3], *p[k])));
+          }
+          if (settings.weighting == NORMAL_WEIGHT_ANGLE) {
+            direction = normalize(face);
+          }
+          contribution[t * 3 + k] = scale(direction, weight);
+        }
+      }
+    });
+    for (size_t c = 0; c < numCorners; ++c) {
+      cornerGroup[c] = positionClass[indices[c]];
+    }
+    groupCorners(cornerGroup, classes, offsets, corners);
+    sumGroups(contribution, offsets, corners, sums);
+    for (size_t v = 0; v < numVertices; ++v) {
+      if (needsNormal[v]) {
+        const XMFLOAT3& normal = sums[positionClass[v]];
+        vertices[v].Normal = dot(normal, normal) > 0.0f ? normal : XMFLOAT3(0.0f, 1.0f, 0.0f);
+      }
+    }
+  }
+  else {
+    for (SimpleVertex& v : vertices) {
+      v.Normal = normalize(v.Normal);
+    }
+  }
+
+  // 2) Tangente por esquina (MikkTSpace): +u del triángulo proyectada y pesada por el ángulo
+  std::vector<unsigned char> orientation(triangles);
+  std::vector<unsigned char> degenerate(triangles);
+  jobs.parallelFor(triangles, grain, [&](size_t begin, size_t end) {
+    for (size_t t = begin; t < end; ++t) {
+      const SimpleVertex* v[3] = { &vertices[indices[t * 3]], &vertices[indices[t * 3 + 1]],
+                                   &vertices[indices[t * 3 + 2]] };
+      const XMFLOAT3 d1 = sub(v[1]->Pos, v[0]->Pos);
+      const XMFLOAT3 d2 = sub(v[2]->Pos, v[0]->Pos);
+      const float t21x = v[1]->Tex.x - v[0]->Tex.x, t21y = v[1]->Tex.y - v[0]->Tex.y;
+      const float t31x = v[2]->Tex.x - v[0]->Tex.x, t31y = v[2]->Tex.y - v[0]->Tex.y;
+      const float signedAreaUV = t21x * t31y - t21y * t31x;
+      const XMFLOAT3 os = sub(scale(d1, t31y), scale(d2, t21y));
+      degenerate[t] = (std::fabs(signedAreaUV) <= FLT_MIN || dot(os, os) <= FLT_MIN) ? 1 : 0;
+      // Sin dividir entre el área, el signo de esta lo da la orientación
+      const XMFLOAT3 tangent = scale(normalize(os), signedAreaUV > 0.0f ? 1.0f : -1.0f);
+      // La orientación es relativa al winding; si el winding se invirtió al importar (las
+      // normales apuntan contra la cara) la corrijo para que la handedness sea la del archivo
+      const XMFLOAT3 vertexNormals = add(add(v[0]->Normal, v[1]->Normal), v[2]->Normal);
+      const bool againstNormals = dot(cross(d1, d2), vertexNormals) < 0.0f;
+      orientation[t] = ((signedAreaUV > 0.0f) != againstNormals) ? 1 : 0;
+      for (unsigned int k = 0; k < 3; ++k) {
+        if (degenerate[t]) {
+          contribution[t * 3 + k] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+          continue;
+        }
+        const XMFLOAT3& n = v[k]->Normal;
+        const XMFLOAT3 previous = normalize(project(sub(v[(k + 2) % 3]->Pos, v[k]->Pos), n));
+        const XMFLOAT3 next = normalize(project(sub(v[(k + 1) % 3]->Pos, v[k]->Pos), n));
+        contribution[t * 3 + k] = scale(normalize(project(tangent, n)), angleBetween(previous, next));
+      }
+    }
+  });
+
+  // 3) Sumo por vértice soldado (posición, normal y UV) y orientación
+  std::vector<VertexKey> keys(numVertices);
+  for (size_t v = 0; v < numVertices; ++v) {
+    keys[v].position = vertices[v].Pos;
+    keys[v].normal = vertices[v].Normal;
+    keys[v].uv = vertices[v].Tex;
+  }
+  std::vector<unsigned int> vertexClass;
+  const unsigned int classes = weld(keys, vertexClass);
+  for (size_t c = 0; c < numCorners; ++c) {
+    cornerGroup[c] = vertexClass[indices[c]] * 2 + orientation[c / 3];
+  }
+  groupCorners(cornerGroup, classes * 2, offsets, corners);
+  sumGroups(contribution, offsets, corners, sums);
+
+  // 4) Cada vértice toma el grupo de sus esquinas; si tiene de las dos orientaciones, lo duplico
+  const bool hasSkin = mesh.m_skin.size() == numVertices;
+  std::vector<unsigned int> vertexGroup(numVertices, 0xFFFFFFFF);
+  std::vector<unsigned int> mirrorOf(numVertices, 0xFFFFFFFF);
+  for (unsigned int pass = 0; pass < 2; ++pass) {
+    // Primero los triángulos con área en UV; los degenerados se quedan con lo que haya
+    for (size_t c = 0; c < numCorners; ++c) {
+      if (degenerate[c / 3] != pass) {
+        continue;
+      }
+      const unsigned int v = mesh.m_index[c];
+      const unsigned int group = cornerGroup[c];
+      if (vertexGroup[v] == 0xFFFFFFFF) {
+        vertexGroup[v] = group;
+      }
+      else if (vertexGroup[v] != group && !pass) {
+        if (mirrorOf[v] == 0xFFFFFFFF) {
+          mirrorOf[v] = static_cast<unsigned int>(vertices.size());
+          vertices.push_back(vertices[v]);
+          if (hasSkin) {
+            mesh.m_skin.push_back(mesh.m_skin[v]);
+          }
+          vertexGroup.push_back(group);
+          ++stats.splitVertices;
+        }
+        mesh.m_index[c] = mirrorOf[v];
+      }
+    }
+  }
+  for (size_t v = 0; v < vertices.size(); ++v) {
+    SimpleVertex& vertex = vertices[v];
+    const unsigned int group = vertexGroup[v];
+    XMFLOAT3 tangent = group != 0xFFFFFFFF ? sums[group] : XMFLOAT3(0.0f, 0.0f, 0.0f);
+    if (dot(tangent, tangent) == 0.0f) {
+      tangent = anyTangent(vertex.Normal);
+    }
+    const float handedness = (group != 0xFFFFFFFF && (group & 1)) ? 1.0f : -1.0f;
+    vertex.Tangent = XMFLOAT4(tangent.x, tangent.y, tangent.z, handedness);
+  }
+  for (size_t t = 0; t < triangles; ++t) {
+    stats.degenerateTriangles += degenerate[t];
+  }
+  mesh.m_numVertex = static_cast<int>(vertices.size());
+  return stats;
+}
+
+namespace {
+
+  /**
+   * @brief Rejilla en XZ; `u(x)` deja probar UVs en espejo.
+   */
+  template<typename UFunc>
+  MeshComponent
+    makeGrid(unsigned int side, UFunc u) {
+    MeshComponent mesh;
+    mesh.m_name = "grid";
+    for (unsigned int z = 0; z < side; ++z) {
+      for (unsigned int x = 0; x < side; ++x) {
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+        v.Tex = XMFLOAT2(u(x), z / static_cast<float>(side - 1));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    for (unsigned int z = 0; z + 1 < side; ++z) {
+      for (unsigned int x = 0; x + 1 < side; ++x) {
+        const unsigned int i = z * side + x;
+        const unsigned int quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Esfera UV con la costura duplicada (columna `segments` = columna 0 con u = 1).
+   */
+  MeshComponent
+    makeSphere(unsigned int rings, unsigned int segments) {
+    MeshComponent mesh;
+    mesh.m_name = "sphere";
+    for (unsigned int r = 0; r < rings; ++r) {
+      const float theta = XM_PI * r / (rings - 1);
+      // Los polos exactos: sin(pi) en float no es 0 y cada esquina del polo quedaría en otra posición
+      const float ringRadius = (r == 0 || r == rings - 1) ? 0.0f : std::sin(theta);
+      const float ringHeight = (r == 0) ? 1.0f : (r == rings - 1) ? -1.0f : std::cos(theta);
+      for (unsigned int s = 0; s <= segments; ++s) {
+        const float phi = XM_2PI * (s % segments) / segments;
+        SimpleVertex v = {};
+        v.Pos = XMFLOAT3(ringRadius * std::cos(phi), ringHeight, ringRadius * std::sin(phi));
+        v.Tex = XMFLOAT2(s / static_cast<float>(segments), r / static_cast<float>(rings - 1));
+        mesh.m_vertex.push_back(v);
+      }
+    }
+    const unsigned int columns = segments + 1;
+    for (unsigned int r = 0; r + 1 < rings; ++r) {
+      for (unsigned int s = 0; s < segments; ++s) {
+        const unsigned int a = r * columns + s;
+        const unsigned int quad[6] = { a, a + 1, a + columns, a + 1, a + columns + 1, a + columns };
+        mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+      }
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  /**
+   * @brief Terreno con ruido y una esquina por vértice (como sale del importador de FBX).
+   */
+  MeshComponent
+    makeFacetedTerrain(unsigned int side, float seed) {
+    MeshComponent grid = makeGrid(side, [side](unsigned int x) { return x / static_cast<float>(side - 1); });
+    for (SimpleVertex& v : grid.m_vertex) {
+      v.Pos.y = std::sin(v.Pos.x * 0.21f + seed) * 2.0f + std::cos(v.Pos.z * 0.17f - seed) * 1.5f;
+    }
+    MeshComponent mesh;
+    mesh.m_name = "terrain";
+    for (unsigned int index : grid.m_index) {
+      mesh.m_index.push_back(static_cast<unsigned int>(mesh.m_vertex.size()));
+      mesh.m_vertex.push_back(grid.m_vertex[index]);
+    }
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    return mesh;
+  }
+
+  bool
+    near(const XMFLOAT3& a, const XMFLOAT3& b, float tolerance) {
+    return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+  }
+}
+
+void
+TangentSpace::runBenchmark(BenchmarkReport& report) {
+  JobSystem& jobs = JobSystem::getInstance();
+  TangentSpaceSettings serial;
+  serial.grainSize = static_cast<size_t>(-1);
+
+  // Referencia 1: plano con u = x, v = z -> N = +Y, T = +X, bitangente = +Z
+  MeshComponent plane = makeGrid(512, [](unsigned int x) { return x / 511.0f; });
+  Timer timer;
+  const TangentSpaceStats planeStats = generate(plane);
+  const double planeMs = timer.elapsedMs();
+  unsigned int planeErrors = 0;
+  for (const SimpleVertex& v : plane.m_vertex) {
+    const XMFLOAT3 tangent(v.Tangent.x, v.Tangent.y, v.Tangent.z);
+    const XMFLOAT3 bitangent = scale(cross(v.Normal, tangent), v.Tangent.w);
+    if (!near(v.Normal, XMFLOAT3(0.0f, 1.0f, 0.0f), 1.0e-5f) || !near(tangent, XMFLOAT3(1.0f, 0.0f, 0.0f), 1.0e-5f) ||
+        !near(bitangent, XMFLOAT3(0.0f, 0.0f, 1.0f), 1.0e-5f)) {
+      ++planeErrors;
+    }
+  }
+  if (planeErrors > 0 || planeStats.splitVertices != 0) {
+    report.fail("plane: " + std::to_string(planeErrors) + " vertices differ from N=+Y, T=+X, B=+Z");
+  }
+  report.log("plane %u tris (one mesh split in triangle ranges): %.2f ms, %.1f Mtris/s",
+             planeStats.triangles, planeMs, planeStats.triangles / (planeMs * 1000.0));
+
+  // El mismo plano con el winding invertido (como al importar) y sus normales: misma base
+  MeshComponent flipped = makeGrid(64, [](unsigned int x) { return x / 63.0f; });
+  for (size_t i = 0; i < flipped.m_index.size(); i += 3) {
+    std::swap(flipped.m_index[i + 1], flipped.m_index[i + 2]);
+  }
+  for (SimpleVertex& v : flipped.m_vertex) {
+    v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+  }
+  generate(flipped);
+  for (const SimpleVertex& v : flipped.m_vertex) {
+    if (!near(XMFLOAT3(v.Tangent.x, v.Tangent.y, v.Tangent.z), XMFLOAT3(1.0f, 0.0f, 0.0f), 1.0e-5f) ||
+        v.Tangent.w != plane.m_vertex[0].Tangent.w) {
+      report.fail("flipped winding: tangent frame differs from the original winding");
+      break;
+    }
+  }
+
+  // Referencia 2: esfera -> N = posición, T = dP/du (dirección de -sin(phi), 0, cos(phi))
+  MeshComponent sphere = makeSphere(256, 256);
+  const TangentSpaceStats sphereStats = generate(sphere);
+  float worstNormal = 0.0f;
+  float worstTangent = 0.0f;
+  bool sameHandedness = true;
+  const float handedness = sphere.m_vertex[sphere.m_vertex.size() / 2].Tangent.w;
+  for (const SimpleVertex& v : sphere.m_vertex) {
+    const float radial = std::sqrt(v.Pos.x * v.Pos.x + v.Pos.z * v.Pos.z);
+    worstNormal = std::max(worstNormal, 1.0f - std::fabs(dot(v.Normal, normalize(v.Pos))));
+    if (radial > 0.05f) {
+      const XMFLOAT3 expected(-v.Pos.z / radial, 0.0f, v.Pos.x / radial);
+      worstTangent = std::max(worstTangent, 1.0f - dot(XMFLOAT3(v.Tangent.x, v.Tangent.y, v.Tangent.z), expected));
+      sameHandedness = sameHandedness && v.Tangent.w == handedness;
+    }
+  }
+  if (worstNormal > 1.0e-4f || worstTangent > 1.0e-3f || !sameHandedness || sphereStats.splitVertices != 0) {
+    report.fail("sphere tangent frames differ from the analytic reference");
+  }
+  report.log("sphere %u tris: worst normal error %.2e, worst tangent error %.2e (1 - cos)",
+             sphereStats.triangles, worstNormal, worstTangent);
+
+  // Referencia 3: UVs en espejo en x = 32 -> handedness opuesta y la costura duplicada
+  MeshComponent mirrored = makeGrid(64, [](unsigned int x) { return std::fabs(static_cast<float>(x) - 32.0f) / 32.0f; });
+  const TangentSpaceStats mirroredStats = generate(mirrored);
+  bool mirrorOk = mirroredStats.splitVertices == 64;
+  for (size_t t = 0; t < mirrored.m_index.size() && mirrorOk; t += 3) {
+    float centerX = 0.0f;
+    for (unsigned int k = 0; k < 3; ++k) {
+      centerX += mirrored.m_vertex[mirrored.m_index[t + k]].Pos.x / 3.0f;
+    }
+    const float expectedX = centerX < 32.0f ? -1.0f : 1.0f;
+    for (unsigned int k = 0; k < 3; ++k) {
+      const XMFLOAT4& tangent = mirrored.m_vertex[mirrored.m_index[t + k]].Tangent;
+      mirrorOk = mirrorOk && std::fabs(tangent.x - expectedX) < 1.0e-5f && tangent.w == -expectedX;
+    }
+  }
+  if (!mirrorOk) {
+    report.fail("mirrored UVs: expected opposite handedness on each side and 64 split seam vertices");
+  }
+  report.log("mirrored UV grid: %u seam vertices split", mirroredStats.splitVertices);
+
+  // Escena: 96 terrenos con una esquina por vértice; un hilo contra todos
+  std::vector<MeshComponent> scene;
+  for (unsigned int i = 0; i < 96; ++i) {
+    scene.push_back(makeFacetedTerrain(96, i * 0.37f));
+  }
+  std::vector<MeshComponent> serialScene = scene;
+  timer.reset();
+  TangentSpaceStats serialStats;
+  for (MeshComponent& mesh : serialScene) {
+    serialStats.triangles += generate(mesh, serial).triangles;
+  }
+  const double serialMs = timer.elapsedMs();
+  timer.reset();
+  const TangentSpaceStats sceneStats = generate(scene);
+  const double parallelMs = timer.elapsedMs();
+  report.log("%u meshes, %u tris, %u normals generated: 1 thread %.1f ms, %u threads %.1f ms (%.2fx, %.1f Mtris/s)",
+             sceneStats.meshes, sceneStats.triangles, sceneStats.generatedNormals, serialMs, jobs.getNumThreads(),
+             parallelMs, serialMs / parallelMs, sceneStats.triangles / (parallelMs * 1000.0));
+
+  // El resultado no depende de cómo se repartió el trabajo
+  bool identical = true;
+  for (size_t i = 0; i < scene.size() && identical; ++i) {
+    identical = scene[i].m_vertex.size() == serialScene[i].m_vertex.size() &&
+                scene[i].m_index == serialScene[i].m_index &&
+                std::memcmp(scene[i].m_vertex.data(), serialScene[i].m_vertex.data(),
+                            scene[i].m_vertex.size() * sizeof(SimpleVertex)) == 0;
+  }
+  MeshComponent planeSerial = makeGrid(512, [](unsigned int x) { return x / 511.0f; });
+  generate(planeSerial, serial);
+  identical = identical && std::memcmp(plane.m_vertex.data(), planeSerial.m_vertex.data(),
+                                       plane.m_vertex.size() * sizeof(SimpleVertex)) == 0;
+  if (!identical) {
+    report.fail("parallel and single-threaded tangent spaces differ");
+  }
+}
@@ -0,0 +1,163 @@
+#include "UIFrameCache.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+
+bool
+UIFrameCache::beginFrame(double nowSeconds, bool inputPending, unsigned long long dataVersion, bool workPending) {
+  ++m_stats.frames;
+
+  bool rebuild = false;
+  if (!m_settings.retained || !m_valid) {
+    rebuild = true;
+  }
+  else if (inputPending) {
+    // Sin al menos un frame extra, el clic del frame anterior seguiría "activo" en ImGui
+    m_settleLeft = std::max(m_settings.settleFrames, 1u);
+    ++m_stats.inputRebuilds;
+    rebuild = true;
+  }
+  else if (m_settleLeft > 0) {
+    --m_settleLeft;
+    ++m_stats.inputRebuilds;
+    rebuild = true;
+  }
+  else if (workPending) {
+    // El trabajo incremental corre dentro del frame: si no lo armo, nunca termina
+    ++m_stats.workRebuilds;
+    rebuild = true;
+  }
+  else if (dataVersion != m_builtVersion &&
+           (m_settings.dataRateHz <= 0.0f || nowSeconds - m_lastBuild >= 1.0 / m_settings.dataRateHz)) {
+    ++m_stats.dataRebuilds;
+    rebuild = true;
+  }
+  else if (m_settings.idleRefreshHz > 0.0f && nowSeconds - m_lastBuild >= 1.0 / m_settings.idleRefreshHz) {
+    ++m_stats.idleRebuilds;
+    rebuild = true;
+  }
+
+  if (rebuild) {
+    ++m_stats.rebuilds;
+    m_valid = true;
+    m_builtVersion = dataVersion;
+    m_lastBuild = nowSeconds;
+  }
+  return rebuild;
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void
+UIFrameCache::runBenchmark(BenchmarkReport& report) {
+  // 10 s a 144 Hz: 3 s sin cambios, 3 s con un panel que cambia cada frame, 2 s de
+  // interacción (input cada 4 frames) y 2 s con un solo clic seguido de nada
+  const double kFrameSeconds = 1.0 / 144.0;
+  const unsigned int kFrames = 1440;
+  struct
+    Frame {
+    bool input;
+    unsigned long long version;
+  };
+  std::vector<Frame> frames(kFrames);
+  unsigned long long version = 1;
+  for (unsigned int i = 0; i < kFrames; ++i) {
+    const double t = i * kFrameSeconds;
+    if (t >= 3.0 && t < 8.0) {
+      ++version;
+    }
+    frames[i].input = (t >= 6.0 && t < 8.0 && i % 4 == 0) || i == 1200;
+    frames[i].version = version;
+  }
+
+  UIFrameCacheSettings settings;
+  UIFrameCache cache;
+  cache.setSettings(settings);
+
+  unsigned int phaseRebuilds[4] = {};
+  bool inputMissed = false;
+  bool settleMissed = false;
+  unsigned int lastInput = kFrames;
+  Timer timer;
+  for (unsigned int i = 0; i < kFrames; ++i) {
+    const double t = i * kFrameSeconds;
+    const bool rebuilt = cache.beginFrame(t, frames[i].input, frames[i].version);
+    if (frames[i].input) {
+      lastInput = i;
+      inputMissed = inputMissed || !rebuilt;
+    }
+    else if (lastInput < i && i - lastInput <= settings.settleFrames) {
+      settleMissed = settleMissed || !rebuilt;
+    }
+    const unsigned int phase = t < 3.0 ? 0 : (t < 6.0 ? 1 : (t < 8.0 ? 2 : 3));
+    phaseRebuilds[phase] += rebuilt ? 1 : 0;
+  }
+  const double decideMs = timer.elapsedMs();
+
+  const UIFrameCacheStats& stats = cache.getStats();
+  report.log("ui-cache: %u frames, %llu rebuilt (%.1f%% skipped), policy %.4f ms total",
+             kFrames, stats.rebuilds, 100.0 * (kFrames - stats.rebuilds) / kFrames, decideMs);
+  report.log("ui-cache: rebuilds by reason: input %llu, data %llu, idle %llu, pending work %llu",
+             stats.inputRebuilds, stats.dataRebuilds, stats.idleRebuilds, stats.workRebuilds);
+  report.log("ui-cache: per phase: idle %u, live data %u, interaction %u, single click %u",
+             phaseRebuilds[0], phaseRebuilds[1], phaseRebuilds[2], phaseRebuilds[3]);
+
+  if (inputMissed) {
+    report.fail("ui-cache: a frame with input reused the cached UI");
+  }
+  if (settleMissed) {
+    report.fail("ui-cache: a settle frame after input reused the cached UI");
+  }
+  // Primer frame + refresco de 1 Hz
+  if (phaseRebuilds[0] > 1 + static_cast<unsigned int>(3.0 * settings.idleRefreshHz) + 1) {
+    report.fail("ui-cache: idle UI was rebuilt more often than the refresh rate");
+  }
+  if (phaseRebuilds[1] > static_cast<unsigned int>(3.0 * settings.dataRateHz) + 1 || phaseRebuilds[1] < 3) {
+    report.fail("ui-cache: live data did not respect the data rate");
+  }
+  if (phaseRebuilds[3] > 1 + settings.settleFrames + static_cast<unsigned int>(2.0 * settings.idleRefreshHz) + 1) {
+    report.fail("ui-cache: UI kept rebuilding after the input settled");
+  }
+
+  // Filtro incremental: un clic lanza un filtro que necesita 60 frames armados para
+  // terminar y solo avanza cuando se arma la UI; sin más input ni datos nuevos
+  const unsigned int kFilterFrames = 60;
+  UIFrameCache filterCache;
+  filterCache.setSettings(settings);
+  unsigned int filterLeft = 0;
+  unsigned int filterDoneAt = kFrames;
+  unsigned int rebuildsAfterFilter = 0;
+  for (unsigned int i = 0; i < kFrames / 2; ++i) {
+    const bool input = i == 10;
+    if (input) {
+      filterLeft = kFilterFrames;
+    }
+    const bool rebuilt = filterCache.beginFrame(i * kFrameSeconds, input, 1, filterLeft > 0);
+    if (rebuilt && filterLeft > 0 && --filterLeft == 0) {
+      filterDoneAt = i;
+    }
+    else if (rebuilt && filterDoneAt < i) {
+      ++rebuildsAfterFilter;
+    }
+  }
+  report.log("ui-cache: incremental filter of %u frames finished %u frames after the click",
+             kFilterFrames, filterDoneAt - 10);
+  if (filterDoneAt != 10 + kFilterFrames - 1) {
+    report.fail("ui-cache: a pending outliner filter was not rebuilt every frame until it finished");
+  }
+  if (rebuildsAfterFilter > static_cast<unsigned int>(kFrames / 2 * kFrameSeconds * settings.idleRefreshHz) + 1) {
+    report.fail("ui-cache: UI kept rebuilding after the filter finished");
+  }
+
+  // Modo inmediato: todos los frames se arman
+  settings.retained = false;
+  UIFrameCache immediate;
+  immediate.setSettings(settings);
+  for (unsigned int i = 0; i < kFrames; ++i) {
+    immediate.beginFrame(i * kFrameSeconds, false, 1);
+  }
+  if (immediate.getStats().rebuilds != kFrames) {
+    report.fail("ui-cache: immediate mode skipped frames");
+  }
+}
@@ -25,24 +25,345 @@ UserInterface::init(void* window,
 	// Setup Platform/Renderer backends
 	ImGui_ImplWin32_Init((HWND)window);
 	ImGui_ImplDX11_Init(device, deviceContext);
+
+	m_window = (HWND)window;
+	m_frameCache.invalidate();
+	m_clock.reset();
 }
 
 void
 UserInterface::update() {
+	// Modo retenido: sin input ni datos nuevos no empiezo frame y reuso el anterior.
+	// El filtro del outliner avanza dentro del frame: mientras no acabe, se arma cada frame
+	m_frameBuilt = m_frameCache.beginFrame(m_clock.elapsedSeconds(), hasPendingInput(), computeDataVersion(),
+	                                       !m_outliner.isFilterComplete());
+	if (!m_frameBuilt) {
+		return;
+	}
+
 	// Start the Dear ImGui frame
 	ImGui_ImplDX11_NewFrame();
 	ImGui_ImplWin32_NewFrame();
 	ImGui::NewFrame();
 }
 
+bool
+UserInterface::hasPendingInput() const {
+  const ImGuiContext& g = *ImGui::GetCurrentContext();
+  // Arrastrando un control o escribiendo: cada frame cuenta
+  if (g.ActiveId != 0) {
+    return true;
+  }
+  for (const ImGuiInputEvent& e : g.InputEventsQueue) {
+    if (e.Type != ImGuiInputEventType_MousePos || g.HoveredWindow) {
+      return true;
+    }
+    const ImVec2 pos(e.MousePos.PosX, e.MousePos.PosY);
+    for (const ImGuiWindow* window : g.Windows) {
+      if (window->WasActive && window->Rect().Contains(pos)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+unsigned long long
+UserInterface::computeDataVersion() const {
+  unsigned long long version = 1469598103934665603ull;
+  auto mix = [&version](unsigned long long value) {
+    version = (version ^ value) * 1099511628211ull;
+  };
+  auto mixFloat = [&mix](float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    mix(bits);
+  };
+
+  RECT client = {};
+  if (m_window) {
+    GetClientRect(m_window, &client);
+  }
+  mix(static_cast<unsigned long long>(client.right - client.left) << 32 | (client.bottom - client.top));
+  // Los tiempos cambian cada frame: solo cuentan si la ventana del profiler se ve
+  if (m_profilerVisible) {
+    mix(FrameProfiler::getInstance().getFrameCount());
+  }
+  mix(m_outliner.getVersion());
+  mix(m_scene ? m_scene->size() : 0);
+  mix(reinterpret_cast<uintptr_t>(m_selectedActor));
+  mix(static_cast<unsigned long long>(m_selectedMesh));
+
+  // El panel del lightmap avanza mientras hornea y cambia de imagen en cada pasada
+  if (m_lightmapBaker) {
+    mixFloat(m_lightmapBaker->getProgress());
+    mix(m_lightmapBaker->getPreviewVersion());
+    mix(reinterpret_cast<uintptr_t>(m_lightmapPreview));
+  }
+
+  // El actor puede moverse solo (animacin, simulacin) y el inspector muestra su Transform
+  if (m_selectedActor) {
+    EU::TSharedPointer<Transform> transform = m_selectedActor->getComponent<Transform>();
+    if (transform) {
+      const EU::Vector3 values[3] = { transform->getPosition(), transform->getRotation(), transform->getScale() };
+      for (const EU::Vector3& value : values) {
+        mixFloat(value.x);
+        mixFloat(value.y);
+        mixFloat(value.z);
+      }
+    }
+  }
+  return version;
+}
+
 
 void 
 UserInterface::render() {
+  FrameProfiler::Scope scope("UI");
+  if (m_frameBuilt) {
+    drawOutliner();
+    drawInspector();
+    drawProfiler();
+    drawLightmaps();
+
+    // Renderizado final de ImGui
+    ImGui::Render();
+  }
+
+  // Sin `NewFrame` el draw data del ltimo `Render` sigue siendo vlido
+  ImDrawData* drawData = ImGui::GetDrawData();
+  if (drawData) {
+    ImGui_ImplDX11_RenderDrawData(drawData);
+  }
+}
+
+void
+UserInterface::setSelectedActor(Actor* actor, int mesh) {
+  m_selectedActor = actor;
+  m_selectedMesh = mesh;
+
+  if (!m_scene || m_outliner.getNumEntries() != m_scene->size()) {
+    return;
+  }
+  m_outliner.clearSelection();
+  for (unsigned int i = 0; actor && i < m_scene->size(); ++i) {
+    if ((*m_scene)[i].get() == actor) {
+      m_outliner.select(i);
+      break;
+    }
+  }
+}
+
+void
+UserInterface::setScene(std::vector<EU::TSharedPointer<Actor>>* actors) {
+  m_scene = actors;
+  m_search[0] = '\0';
+  rebuildOutliner();
+  m_frameCache.invalidate();
+}
+
+void
+UserInterface::rebuildOutliner() {
+  if (!m_scene) {
+    m_outliner.build(std::vector<std::string>());
+    return;
+  }
+  m_outliner.build(*m_scene);
+  m_outliner.setQuery(m_search);
+  setSelectedActor(m_selectedActor, m_selectedMesh);
+}
+
+void
+UserInterface::syncInspectorWithOutliner() {
+  const unsigned int primary = m_outliner.getPrimary();
+  m_selectedActor = primary != SceneOutliner::kInvalid ? (*m_scene)[primary].get() : nullptr;
+  m_selectedMesh = -1;
+}
+
+bool
+UserInterface::isEditingSelection() const {
+  const unsigned int primary = m_outliner.getPrimary();
+  return m_scene && m_outliner.getSelection().size() > 1 && primary < m_scene->size() &&
+         (*m_scene)[primary].get() == m_selectedActor;
+}
+
+void
+UserInterface::drawOutliner() {
+  ImGui::Begin("Outliner");
+
+  if (!m_scene) {
+    ImGui::Text("No hay escena.");
+    ImGui::End();
+    return;
+  }
+  // Con streaming los actores se quedan en el arreglo; solo reconstruyo si cambia el nmero
+  if (m_outliner.getNumEntries() != m_scene->size()) {
+    rebuildOutliner();
+  }
+
+  if (ImGui::InputTextWithHint("##Buscar", "Buscar...", m_search, sizeof(m_search))) {
+    m_outliner.setQuery(m_search);
+  }
+  // El filtro se lleva a lo ms la mitad del presupuesto; si no acaba, sigue el siguiente frame
+  const bool filtered = m_outliner.updateFilter(m_budgetMs * 0.5);
+
+  const std::vector<unsigned int>& results = m_outliner.getResults();
+  ImGui::Text("%u / %u actores", static_cast<unsigned int>(results.size()), m_outliner.getNumEntries());
+  if (!filtered) {
+    ImGui::SameLine();
+    ImGui::Text("(buscando %.0f%%)", m_outliner.getFilterProgress() * 100.0f);
+  }
+  ImGui::SameLine();
+  if (ImGui::SmallButton("Seleccionar todo")) {
+    m_outliner.selectResults();
+    syncInspectorWithOutliner();
+  }
+  ImGui::SameLine();
+  if (ImGui::SmallButton("Limpiar")) {
+    m_outliner.clearSelection();
+    syncInspectorWithOutliner();
+  }
+
+  // Solo se dibujan (y se les pide el nombre a) las filas que caben en la ventana
+  ImGui::BeginChild("##Actores", ImVec2(0.0f, 0.0f), ImGuiChildFlags_Borders);
+  const ImGuiIO& io = ImGui::GetIO();
+  ImGuiListClipper clipper;
+  clipper.Begin(static_cast<int>(results.size()));
+  while (clipper.Step()) {
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+      const unsigned int entity = results[row];
+      ImGui::PushID(static_cast<int>(entity));
+      const std::string name = (*m_scene)[entity]->getName();
+      if (ImGui::Selectable(name.c_str(), m_outliner.isSelected(entity))) {
+        m_outliner.click(entity, io.KeyCtrl, io.KeyShift);
+        syncInspectorWithOutliner();
+      }
+      ImGui::PopID();
+    }
+  }
+  ImGui::EndChild();
+
+  ImGui::End();
+}
+
+void
+UserInterface::drawProfiler() {
+  // Colapsada (o fuera de la pantalla) no dibujo nada y deja de pedir frames
+  m_profilerVisible = ImGui::Begin("Profiler");
+  if (!m_profilerVisible) {
+    ImGui::End();
+    return;
+  }
+
+  const FrameProfiler& profiler = FrameProfiler::getInstance();
+  for (const ProfilerSection& section : profiler.getSections()) {
+    ImGui::Text("%-8s %6.2f ms  (prom %.2f, max %.2f)",
+                section.name.c_str(), section.lastMs, section.averageMs, section.maxMs);
+  }
+
+  // La UI contra su presupuesto (el frame anterior: el actual todava se est midiendo)
+  const ProfilerSection* ui = profiler.getSection("UI");
+  if (ui && m_budgetMs > 0.0) {
+    const float fraction = static_cast<float>(ui->lastMs / m_budgetMs);
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "UI %.2f / %.2f ms", ui->lastMs, m_budgetMs);
+    ImGui::PushStyleColor(ImGuiCol_PlotHistogram,
+                          fraction > 1.0f ? ImVec4{ 0.8f, 0.1f, 0.15f, 1.0f } : ImVec4{ 0.2f, 0.7f, 0.2f, 1.0f });
+    ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(-1.0f, 0.0f), overlay);
+    ImGui::PopStyleColor();
+  }
+
+  // Modo retenido: la UI solo se arma con input, datos nuevos o el refresco peridico
+  if (ImGui::CollapsingHeader("UI retenida")) {
+    UIFrameCacheSettings settings = m_frameCache.getSettings();
+    bool changed = ImGui::Checkbox("Activa", &settings.retained);
+    changed |= ImGui::SliderFloat("Datos (Hz)", &settings.dataRateHz, 0.0f, 60.0f, "%.0f");
+    changed |= ImGui::SliderFloat("Refresco (Hz)", &settings.idleRefreshHz, 0.0f, 10.0f, "%.1f");
+    if (changed) {
+      m_frameCache.setSettings(settings);
+    }
+    const UIFrameCacheStats& stats = m_frameCache.getStats();
+    ImGui::Text("Armados %llu de %llu frames (input %llu, datos %llu, refresco %llu)",
+                stats.rebuilds, stats.frames, stats.inputRebuilds, stats.dataRebuilds, stats.idleRebuilds);
+  }
+
+  ImGui::End();
+}
+
+void
+UserInterface::drawLightmaps() {
+  if (!m_lightmapBaker) {
+    return;
+  }
+  ImGui::Begin("Lightmap");
+
+  // Los ajustes valen para el siguiente horneado; el que corre sigue con los suyos
+  LightmapBakeSettings& settings = m_lightmapSettings;
+  int atlasSize = static_cast<int>(settings.pack.atlasSize);
+  if (ImGui::SliderInt("Atlas", &atlasSize, 128, 4096)) {
+    settings.pack.atlasSize = static_cast<unsigned int>(atlasSize);
+  }
+  ImGui::SliderFloat("Texels/unidad", &settings.pack.texelsPerUnit, 0.5f, 64.0f, "%.1f");
+  int passes = static_cast<int>(settings.passes);
+  if (ImGui::SliderInt("Pasadas", &passes, 1, 256)) {
+    settings.passes = static_cast<unsigned int>(passes);
+  }
+  int bounces = static_cast<int>(settings.maxBounces);
+  if (ImGui::SliderInt("Rebotes", &bounces, 1, 8)) {
+    settings.maxBounces = static_cast<unsigned int>(bounces);
+  }
+  ImGui::ColorEdit3("Cielo", &settings.skyColor.x, ImGuiColorEditFlags_Float | ImGuiColorEditFlags_HDR);
+  ImGui::ColorEdit3("Sol", &settings.sunColor.x, ImGuiColorEditFlags_Float | ImGuiColorEditFlags_HDR);
+  ImGui::DragFloat3("Direccin del sol", &settings.sunDirection.x, 0.01f, -1.0f, 1.0f);
+  ImGui::Checkbox("Denoise", &settings.denoise);
+
+  if (m_lightmapBaker->isBaking()) {
+    if (ImGui::Button("Cancelar")) {
+      m_lightmapBaker->cancel();
+    }
+  }
+  else if (ImGui::Button("Hornear")) {
+    m_lightmapBaker->requestBake(settings);
+  }
+
+  const LightmapBakeStats& stats = m_lightmapBaker->getStats();
+  if (m_lightmapBaker->isBaking() || m_lightmapBaker->isFinished()) {
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "Pasada %u / %u", stats.passes, m_lightmapBaker->getSettings().passes);
+    ImGui::ProgressBar(m_lightmapBaker->getProgress(), ImVec2(-1.0f, 0.0f), overlay);
+    ImGui::Text("%u instancias (%u mallas, %u charts), %u texels a %.2f texels/unidad",
+                stats.instances, stats.meshes, stats.charts, stats.texels, stats.texelsPerUnit);
+    ImGui::Text("%.2f Mrayos/s, %llu rayos; preparar %.0f ms, trazar %.0f ms, denoise %.0f ms",
+                stats.getRaysPerSecond() * 1e-6, stats.rays, stats.setupMs, stats.traceMs, stats.denoiseMs);
+  }
+
+  // La vista previa cubre el ancho de la ventana manteniendo la proporcin del atlas
+  const LightmapAtlas& atlas = m_lightmapBaker->getAtlas();
+  if (m_lightmapPreview && atlas.width > 0) {
+    const float width = ImGui::GetContentRegionAvail().x;
+    ImGui::Image(static_cast<ImTextureID>(reinterpret_cast<uintptr_t>(m_lightmapPreview)),
+                 ImVec2(width, width * atlas.height / atlas.width));
+  }
+
+  ImGui::End();
+}
+
+void
+UserInterface::drawInspector() {
   // Crear la ventana de Propiedades
   ImGui::Begin("Inspector de Propiedades");
 
   if (m_selectedActor) {
     ImGui::Text("Actor: %s", m_selectedActor->getName().c_str());
+    if (m_selectedMesh >= 0) {
+      ImGui::Text("Mesh: %s", m_selectedActor->getMeshName(m_selectedMesh).c_str());
+    }
+    // Con varios seleccionados, el cambio de este actor se aplica como delta a todos
+    const bool batch = isEditingSelection();
+    if (batch) {
+      ImGui::Text("%u actores seleccionados: los cambios se aplican a todos.",
+                  static_cast<unsigned int>(m_outliner.getSelection().size()));
+    }
     ImGui::Separator();
 
     // Obtener el componente Transform
@@ -57,7 +378,14 @@ UserInterface::render() {
 
         // Dibujamos el control y si devuelve true (hubo cambios), actualizamos
         if (vec3Control("Position", p)) {
-          transformComponent->setPosition(EU::Vector3(p[0], p[1], p[2]));
+          if (batch) {
+            TransformEdit edit;
+            edit.translation = EU::Vector3(p[0], p[1], p[2]) - pos;
+            m_outliner.applyEdit(*m_scene, edit);
+          }
+          else {
+            transformComponent->setPosition(EU::Vector3(p[0], p[1], p[2]));
+          }
         }
 
         // --- ROTACIN ---
@@ -69,9 +397,17 @@ UserInterface::render() {
 
         if (vec3Control("Rotation", r)) {
           // Convertimos grados a radianes para guardarlo
-          transformComponent->setRotation(EU::Vector3(XMConvertToRadians(r[0]), 
-                                                      XMConvertToRadians(r[1]), 
-                                                      XMConvertToRadians(r[2])));
+          EU::Vector3 newRot(XMConvertToRadians(r[0]), 
+                             XMConvertToRadians(r[1]), 
+                             XMConvertToRadians(r[2]));
+          if (batch) {
+            TransformEdit edit;
+            edit.rotation = newRot - rot;
+            m_outliner.applyEdit(*m_scene, edit);
+          }
+          else {
+            transformComponent->setRotation(newRot);
+          }
         }
 
         // --- ESCALA ---
@@ -79,7 +415,17 @@ UserInterface::render() {
         float s[3] = { scale.x, scale.y, scale.z };
 
         if (vec3Control("Scale", s, 1.0f)) { // Reset value es 1.0 para escala
-          transformComponent->setScale(EU::Vector3(s[0], s[1], s[2]));
+          if (batch) {
+            // Factor por eje respecto a la escala de este actor (un eje en cero no escala)
+            TransformEdit edit;
+            edit.scale = EU::Vector3(scale.x != 0.0f ? s[0] / scale.x : 1.0f,
+                                     scale.y != 0.0f ? s[1] / scale.y : 1.0f,
+                                     scale.z != 0.0f ? s[2] / scale.z : 1.0f);
+            m_outliner.applyEdit(*m_scene, edit);
+          }
+          else {
+            transformComponent->setScale(EU::Vector3(s[0], s[1], s[2]));
+          }
         }
       }
     }
@@ -89,10 +435,6 @@ UserInterface::render() {
   }
 
   ImGui::End();
-
-  // Renderizado final de ImGui
-  ImGui::Render();
-  ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 }
 
 void
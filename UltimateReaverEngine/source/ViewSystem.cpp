@@ -0,0 +1,447 @@
+#include "ViewSystem.h"
+#include "JobSystem.h"
+#include "Benchmarks.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+  /**
+   * @brief Caja en mundo de una caja local transformada (centro y extensión con |M|).
+   */
+  OcclusionBounds
+  transformBounds(const OcclusionBounds& local, const XMFLOAT4X4& world) {
+    const float center[3] = { (local.minPoint.x + local.maxPoint.x) * 0.5f,
+                              (local.minPoint.y + local.maxPoint.y) * 0.5f,
+                              (local.minPoint.z + local.maxPoint.z) * 0.5f };
+    const float extent[3] = { (local.maxPoint.x - local.minPoint.x) * 0.5f,
+                              (local.maxPoint.y - local.minPoint.y) * 0.5f,
+                              (local.maxPoint.z - local.minPoint.z) * 0.5f };
+    float worldCenter[3];
+    float worldExtent[3];
+    for (int c = 0; c < 3; ++c) {
+      worldCenter[c] = world.m[3][c];
+      worldExtent[c] = 0.0f;
+      for (int r = 0; r < 3; ++r) {
+        worldCenter[c] += center[r] * world.m[r][c];
+        worldExtent[c] += extent[r] * std::fabs(world.m[r][c]);
+      }
+    }
+    OcclusionBounds bounds;
+    bounds.minPoint = XMFLOAT3(worldCenter[0] - worldExtent[0], worldCenter[1] - worldExtent[1], worldCenter[2] - worldExtent[2]);
+    bounds.maxPoint = XMFLOAT3(worldCenter[0] + worldExtent[0], worldCenter[1] + worldExtent[1], worldCenter[2] + worldExtent[2]);
+    return bounds;
+  }
+
+  bool
+  testBounds(const Frustum& frustum, const OcclusionBounds& bounds) {
+    const float minPoint[3] = { bounds.minPoint.x, bounds.minPoint.y, bounds.minPoint.z };
+    const float maxPoint[3] = { bounds.maxPoint.x, bounds.maxPoint.y, bounds.maxPoint.z };
+    return frustum.intersectsAabb(minPoint, maxPoint);
+  }
+
+  unsigned int
+  countBits(unsigned int mask) {
+    unsigned int count = 0;
+    for (; mask; mask &= mask - 1) {
+      ++count;
+    }
+    return count;
+  }
+
+} // namespace
+
+XMMATRIX
+RenderView::getShaderView() const {
+  XMFLOAT4X4 shaderView = view;
+  if (cameraRelative) {
+    // view = T(-eye) * R: sin la fila de traslación queda solo la rotación
+    shaderView._41 = 0.0f;
+    shaderView._42 = 0.0f;
+    shaderView._43 = 0.0f;
+  }
+  return XMLoadFloat4x4(&shaderView);
+}
+
+RenderView
+ViewSystem::makeView(const XMFLOAT4X4& view,
+                     const XMFLOAT4X4& projection,
+                     float x, float y, float width, float height,
+                     bool cameraRelative) {
+  RenderView result;
+  result.view = view;
+  result.projection = projection;
+  XMMATRIX viewMatrix = XMLoadFloat4x4(&view);
+  XMStoreFloat4x4(&result.viewProjection, XMMatrixMultiply(viewMatrix, XMLoadFloat4x4(&projection)));
+  XMFLOAT4X4 inverseView;
+  XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, viewMatrix));
+  result.eye = XMFLOAT3(inverseView._41, inverseView._42, inverseView._43);
+  result.x = x;
+  result.y = y;
+  result.width = width;
+  result.height = height;
+  result.cameraRelative = cameraRelative;
+  return result;
+}
+
+void
+ViewSystem::makeCameraRelative(const XMFLOAT4X4& world, const XMFLOAT3& eye, XMFLOAT4X4& relative) {
+  relative = world;
+  relative._41 -= eye.x;
+  relative._42 -= eye.y;
+  relative._43 -= eye.z;
+}
+
+int
+ViewSystem::addView(const RenderView& view) {
+  if (m_views.size() >= kMaxViews) {
+    ERROR("ViewSystem", "addView", "Too many views (max " << kMaxViews << ")");
+    return -1;
+  }
+  m_views.push_back(view);
+  return static_cast<int>(m_views.size() - 1);
+}
+
+void
+ViewSystem::beginFrame() {
+  m_bounds.clear();
+  m_unbounded.clear();
+  m_keys.clear();
+  m_masks.clear();
+  m_drawList.clear();
+}
+
+unsigned int
+ViewSystem::addItem(const OcclusionBounds* bounds, unsigned int sortKey) {
+  m_bounds.push_back(bounds ? *bounds : OcclusionBounds());
+  m_unbounded.push_back(bounds ? 0 : 1);
+  m_keys.push_back(sortKey);
+  return static_cast<unsigned int>(m_keys.size() - 1);
+}
+
+void
+ViewSystem::cull() {
+  Timer timer;
+  m_frustums.resize(m_views.size());
+  for (size_t v = 0; v < m_views.size(); ++v) {
+    m_frustums[v].setViewProjection(m_views[v].viewProjection);
+  }
+  const unsigned int numViews = static_cast<unsigned int>(m_views.size());
+  const unsigned int allViews = numViews >= 32 ? 0xFFFFFFFFu : (1u << numViews) - 1;
+
+  // Cada caja se lee una vez y se prueba contra todas las vistas mientras está en cache
+  m_masks.resize(m_keys.size());
+  JobSystem::getInstance().parallelFor(m_keys.size(), 1024, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (m_unbounded[i]) {
+        m_masks[i] = allViews;
+        continue;
+      }
+      unsigned int mask = 0;
+      for (unsigned int v = 0; v < numViews; ++v) {
+        mask |= testBounds(m_frustums[v], m_bounds[i]) ? (1u << v) : 0u;
+      }
+      m_masks[i] = mask;
+    }
+  });
+
+  m_stats = ViewSystemStats();
+  m_stats.views = numViews;
+  m_stats.items = getNumItems();
+  m_stats.cullMs = timer.elapsedMs();
+  merge();
+}
+
+void
+ViewSystem::applyVisibility(unsigned int view, const std::vector<uint8_t>& visible) {
+  if (view >= m_views.size()) {
+    return;
+  }
+  const size_t count = std::min(visible.size(), m_masks.size());
+  for (size_t i = 0; i < count; ++i) {
+    if (!visible[i]) {
+      m_masks[i] &= ~(1u << view);
+    }
+  }
+  merge();
+}
+
+void
+ViewSystem::merge() {
+  Timer timer;
+  // Clave de 64 bits: estado arriba, item abajo (orden estable sin comparador propio)
+  std::vector<unsigned long long> order;
+  order.reserve(m_masks.size());
+  unsigned int viewDraws = 0;
+  for (unsigned int i = 0; i < m_masks.size(); ++i) {
+    if (m_masks[i]) {
+      order.push_back(static_cast<unsigned long long>(m_keys[i]) << 32 | i);
+      viewDraws += countBits(m_masks[i]);
+    }
+  }
+  std::sort(order.begin(), order.end());
+
+  m_drawList.resize(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const unsigned int item = static_cast<unsigned int>(order[i] & 0xFFFFFFFFu);
+    m_drawList[i].item = item;
+    m_drawList[i].viewMask = m_masks[item];
+  }
+  m_stats.drawnItems = static_cast<unsigned int>(m_drawList.size());
+  m_stats.viewDraws = viewDraws;
+  m_stats.mergeMs = timer.elapsedMs();
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+namespace {
+
+  /**
+   * @brief Error en pixeles al proyectar un punto lejos del origen, emulando la GPU en float.
+   *
+   * @details La referencia es en double con la posición exacta de la cámara.
+   */
+  void
+  measureProjectionError(double worldOffset, double& absoluteError, double& relativeError) {
+    const XMFLOAT3 eye(static_cast<float>(worldOffset) + 0.37f, 2.0f, static_cast<float>(worldOffset) + 0.81f);
+    const XMFLOAT3 objectPosition(eye.x + 3.1f, eye.y - 1.2f, eye.z + 10.7f);
+    XMFLOAT4X4 view;
+    XMFLOAT4X4 projection;
+    XMStoreFloat4x4(&view, XMMatrixLookAtLH(XMVectorSet(eye.x, eye.y, eye.z, 1.0f),
+                                            XMVectorSet(eye.x + 1.0f, eye.y - 0.5f, eye.z + 4.0f, 1.0f),
+                                            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+    XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.1f, 1000.0f));
+    XMFLOAT4X4 world;
+    XMStoreFloat4x4(&world, XMMatrixTranslation(objectPosition.x, objectPosition.y, objectPosition.z));
+
+    const RenderView relativeView = ViewSystem::makeView(view, projection, 0.0f, 0.0f, 1920.0f, 1080.0f, true);
+    XMFLOAT4X4 shaderView;
+    XMStoreFloat4x4(&shaderView, relativeView.getShaderView());
+    XMFLOAT4X4 relativeWorld;
+    ViewSystem::makeCameraRelative(world, eye, relativeWorld);
+
+    // Como el vertex shader: local * world * view * projection en float
+    auto project = [&](const float local[3], const XMFLOAT4X4& w, const XMFLOAT4X4& v, float out[2]) {
+      float p[4] = { local[0], local[1], local[2], 1.0f };
+      const XMFLOAT4X4* matrices[3] = { &w, &v, &projection };
+      for (const XMFLOAT4X4* m : matrices) {
+        float r[4];
+        for (int c = 0; c < 4; ++c) {
+          r[c] = p[0] * m->m[0][c] + p[1] * m->m[1][c] + p[2] * m->m[2][c] + p[3] * m->m[3][c];
+        }
+        std::copy(r, r + 4, p);
+      }
+      out[0] = (p[0] / p[3] * 0.5f + 0.5f) * 1920.0f;
+      out[1] = (0.5f - p[1] / p[3] * 0.5f) * 1080.0f;
+    };
+
+    absoluteError = 0.0;
+    relativeError = 0.0;
+    for (int corner = 0; corner < 8; ++corner) {
+      const float local[3] = { (corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f };
+
+      // Referencia: (p - eye) exacto en double, rotación de la vista y proyección en double
+      const double d[3] = { static_cast<double>(objectPosition.x) + local[0] - eye.x,
+                            static_cast<double>(objectPosition.y) + local[1] - eye.y,
+                            static_cast<double>(objectPosition.z) + local[2] - eye.z };
+      double viewPos[3];
+      for (int c = 0; c < 3; ++c) {
+        viewPos[c] = d[0] * view.m[0][c] + d[1] * view.m[1][c] + d[2] * view.m[2][c];
+      }
+      double clip[4];
+      for (int c = 0; c < 4; ++c) {
+        clip[c] = viewPos[0] * projection.m[0][c] + viewPos[1] * projection.m[1][c] +
+                  viewPos[2] * projection.m[2][c] + projection.m[3][c];
+      }
+      const double reference[2] = { (clip[0] / clip[3] * 0.5 + 0.5) * 1920.0, (0.5 - clip[1] / clip[3] * 0.5) * 1080.0 };
+
+      float absolute[2];
+      float relative[2];
+      project(local, world, view, absolute);
+      project(local, relativeWorld, shaderView, relative);
+      absoluteError = std::max(absoluteError, std::hypot(absolute[0] - reference[0], absolute[1] - reference[1]));
+      relativeError = std::max(relativeError, std::hypot(relative[0] - reference[0], relative[1] - reference[1]));
+    }
+  }
+
+} // namespace
+
+void
+ViewSystem::runBenchmark(BenchmarkReport& report) {
+  const unsigned int kItems = 100000;
+  const unsigned int kStates = 64;
+  const int kRepeats = 3;
+
+  // Escena: cajas locales con su matriz de mundo (el recorrido las pasa a mundo cada frame)
+  std::mt19937 rng(73);
+  std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+  std::uniform_real_distribution<float> size(0.25f, 3.0f);
+  std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+  std::vector<OcclusionBounds> localBounds(kItems);
+  std::vector<XMFLOAT4X4> worlds(kItems);
+  std::vector<unsigned int> keys(kItems);
+  for (unsigned int i = 0; i < kItems; ++i) {
+    const float s = size(rng);
+    localBounds[i].minPoint = XMFLOAT3(-s, 0.0f, -s * 0.5f);
+    localBounds[i].maxPoint = XMFLOAT3(s, 2.0f * s, s * 0.5f);
+    XMStoreFloat4x4(&worlds[i], XMMatrixMultiply(XMMatrixRotationY(angle(rng)),
+                                                 XMMatrixTranslation(position(rng), 0.0f, position(rng))));
+    keys[i] = static_cast<unsigned int>(rng() % kStates);
+  }
+
+  XMFLOAT4X4 projection;
+  XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.1f, 300.0f));
+  std::vector<RenderView> cameras;
+  for (unsigned int v = 0; v < 8; ++v) {
+    const float a = v * XM_2PI / 8.0f;
+    const XMVECTOR eye = XMVectorSet(std::cos(a) * 60.0f, 12.0f, std::sin(a) * 60.0f, 1.0f);
+    const XMVECTOR at = XMVectorSet(std::cos(a + 2.0f) * 30.0f, 0.0f, std::sin(a + 2.0f) * 30.0f, 1.0f);
+    XMFLOAT4X4 view;
+    XMStoreFloat4x4(&view, XMMatrixLookAtLH(eye, at, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+    cameras.push_back(makeView(view, projection, 0.0f, 0.0f, 960.0f, 540.0f));
+  }
+
+  const unsigned int kViewCounts[] = { 1, 2, 4, 8 };
+  double sharedSingle = 0.0;
+  for (unsigned int numViews : kViewCounts) {
+    // N pasadas independientes: cada vista recorre la escena, hace su culling y su lista
+    std::vector<std::vector<unsigned int>> independent(numViews);
+    double independentMs = 1e30;
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+      Timer timer;
+      for (unsigned int v = 0; v < numViews; ++v) {
+        Frustum frustum(cameras[v].viewProjection);
+        std::vector<OcclusionBounds> bounds(kItems);
+        JobSystem::getInstance().parallelFor(kItems, 1024, [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            bounds[i] = transformBounds(localBounds[i], worlds[i]);
+          }
+        });
+        std::vector<uint8_t> visible(kItems);
+        JobSystem::getInstance().parallelFor(kItems, 1024, [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            visible[i] = testBounds(frustum, bounds[i]) ? 1 : 0;
+          }
+        });
+        std::vector<unsigned long long> order;
+        for (unsigned int i = 0; i < kItems; ++i) {
+          if (visible[i]) {
+            order.push_back(static_cast<unsigned long long>(keys[i]) << 32 | i);
+          }
+        }
+        std::sort(order.begin(), order.end());
+        independent[v].clear();
+        for (unsigned long long entry : order) {
+          independent[v].push_back(static_cast<unsigned int>(entry & 0xFFFFFFFFu));
+        }
+      }
+      independentMs = std::min(independentMs, timer.elapsedMs());
+    }
+
+    // Un recorrido y culling de todas las vistas a la vez
+    ViewSystem system;
+    for (unsigned int v = 0; v < numViews; ++v) {
+      system.addView(cameras[v]);
+    }
+    double sharedMs = 1e30;
+    double traversalMs = 0.0;
+    std::vector<OcclusionBounds> bounds(kItems);
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+      Timer timer;
+      JobSystem::getInstance().parallelFor(kItems, 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          bounds[i] = transformBounds(localBounds[i], worlds[i]);
+        }
+      });
+      const double traversed = timer.elapsedMs();
+      system.beginFrame();
+      for (unsigned int i = 0; i < kItems; ++i) {
+        system.addItem(&bounds[i], keys[i]);
+      }
+      system.cull();
+      const double ms = timer.elapsedMs();
+      if (ms < sharedMs) {
+        sharedMs = ms;
+        traversalMs = traversed;
+      }
+    }
+    if (numViews == 1) {
+      sharedSingle = sharedMs;
+    }
+
+    bool same = true;
+    for (unsigned int v = 0; v < numViews && same; ++v) {
+      std::vector<unsigned int> fromShared;
+      for (const ViewDraw& draw : system.getDrawList()) {
+        if (draw.viewMask & (1u << v)) {
+          fromShared.push_back(draw.item);
+        }
+      }
+      same = fromShared == independent[v];
+    }
+    if (!same) {
+      report.fail("views: shared culling differs from independent passes with " + std::to_string(numViews) + " views");
+    }
+
+    const ViewSystemStats& stats = system.getStats();
+    report.log("views: %u view(s): independent %.3f ms, shared %.3f ms (traversal %.3f, cull %.3f, merge %.3f), "
+               "%u items drawn, %u view draws",
+               numViews, independentMs, sharedMs, traversalMs, stats.cullMs, stats.mergeMs,
+               stats.drawnItems, stats.viewDraws);
+    if (numViews > 1) {
+      report.log("views:   overhead per extra view: shared %.3f ms, independent %.3f ms",
+                 (sharedMs - sharedSingle) / (numViews - 1), independentMs / numViews);
+    }
+  }
+
+  // Oclusión de una vista: solo quita bits de esa vista
+  {
+    ViewSystem system;
+    system.addView(cameras[0]);
+    system.addView(cameras[1]);
+    system.beginFrame();
+    for (unsigned int i = 0; i < kItems; ++i) {
+      const OcclusionBounds bounds = transformBounds(localBounds[i], worlds[i]);
+      system.addItem(&bounds, keys[i]);
+    }
+    system.addItem(nullptr, 0);
+    system.cull();
+    std::vector<unsigned int> before(kItems + 1);
+    for (unsigned int i = 0; i <= kItems; ++i) {
+      before[i] = system.getViewMask(i);
+    }
+    std::vector<uint8_t> visible(kItems + 1, 1);
+    for (unsigned int i = 0; i < kItems; i += 2) {
+      visible[i] = 0;
+    }
+    system.applyVisibility(0, visible);
+    bool ok = system.getViewMask(kItems) == 3u;
+    for (unsigned int i = 0; i < kItems && ok; ++i) {
+      const unsigned int expected = (i % 2 == 0) ? (before[i] & ~1u) : before[i];
+      ok = system.getViewMask(i) == expected;
+    }
+    if (!ok) {
+      report.fail("views: applyVisibility touched the wrong bits");
+    }
+  }
+
+  // Render relativo a la cámara lejos del origen
+  const double kOffsets[] = { 1.0e4, 1.0e6 };
+  for (double offset : kOffsets) {
+    double absoluteError;
+    double relativeError;
+    measureProjectionError(offset, absoluteError, relativeError);
+    report.log("views: world offset %.0e: projection error absolute %.3f px, camera-relative %.5f px",
+               offset, absoluteError, relativeError);
+    if (relativeError > 0.01) {
+      report.fail("views: camera-relative projection is not precise");
+    }
+    if (offset >= 1.0e6 && absoluteError <= relativeError) {
+      report.fail("views: expected absolute coordinates to lose precision far from the origin");
+    }
+  }
+}
@@ -38,6 +38,19 @@ HRESULT Viewport::init(unsigned int width, unsigned int height)
   return S_OK;
 }
 
+HRESULT Viewport::init(float x, float y, float width, float height)
+{
+  if (width <= 0.0f || height <= 0.0f) return E_INVALIDARG;
+
+  m_viewport.TopLeftX = x;
+  m_viewport.TopLeftY = y;
+  m_viewport.Width = width;
+  m_viewport.Height = height;
+  m_viewport.MinDepth = 0.0f;
+  m_viewport.MaxDepth = 1.0f;
+  return S_OK;
+}
+
 void Viewport::update()
 {
   // Si luego manejas WM_SIZE, puedes recalcular aqu con el HWND actual